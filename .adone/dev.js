@@ -257,7 +257,15 @@ export default {
                     src: "src/glosses/crypto/**/*.js",
                     dst: "lib/glosses/crypto",
                     task: "transpile",
-                    predecessor: "https://github.com/digitalbazaar/forge"
+                    predecessor: "https://github.com/digitalbazaar/forge",
+                    units: {
+                        native: {
+                            description: "Native implementations of hash functions and ciphers",
+                            task: "cmake",
+                            src: "src/glosses/crypto/native",
+                            dst: "lib/glosses/crypto/native"
+                        }
+                    }
                 },
                 data: {
                     description: "Data generic manipulation utilites and serializers",
@@ -337,6 +345,18 @@ export default {
                             task: "transpile",
                             src: "src/glosses/data/utf8.js",
                             dst: "lib/glosses/data"
+                        },
+                        addon: {
+                            description: "Loader of the native codecs",
+                            task: "transpile",
+                            src: "src/glosses/data/addon.js",
+                            dst: "lib/glosses/data"
+                        },
+                        native: {
+                            description: "Native implementations of the codecs",
+                            task: "cmake",
+                            src: "src/glosses/data/native",
+                            dst: "lib/glosses/data/native"
                         }
                     }
                 },
@@ -404,13 +424,13 @@ export default {
                             task: "transpile",
                             units: {
                                 fsevents: {
-                                    platform: "darwin",
+                                    platform: "darwin,linux",
                                     task: "transpile",
                                     src: "src/glosses/fs/extra/watcher/fsevents.js",
                                     dst: "lib/glosses/fs/extra/watcher"
                                 },
                                 native: {
-                                    platform: "darwin",
+                                    platform: "darwin,linux",
                                     task: "cmake",
                                     src: "src/glosses/fs/extra/watcher/native",
                                     dst: "lib/glosses/fs/extra/watcher/native"
@@ -4,11 +4,6 @@ const {
     error
 } = adone;
 
-const stringSource = (s) => {
-    let i = 0;
-    return () => i < s.length ? s.charCodeAt(i++) : null;
-};
-
 const stringDestination = () => {
     const cs = [];
     const ps = [];
@@ -616,6 +611,138 @@ export default class SmartBuffer {
         return this.buffer.readDoubleBE(offset, true);
     }
 
+    /**
+     * Reads an array of 16bit signed le values
+     *
+     * @param {number} count Number of values to read
+     * @param {number} [offset] Offset to read from
+     * @returns {Int16Array}
+     */
+    readInt16ArrayLE(count, offset) {
+        return this._readArray(count, Int16Array, true, offset);
+    }
+
+    /**
+     * Reads an array of 16bit signed be values
+     *
+     * @param {number} count Number of values to read
+     * @param {number} [offset] Offset to read from
+     * @returns {Int16Array}
+     */
+    readInt16ArrayBE(count, offset) {
+        return this._readArray(count, Int16Array, false, offset);
+    }
+
+    /**
+     * Reads an array of 16bit unsigned le values
+     *
+     * @param {number} count Number of values to read
+     * @param {number} [offset] Offset to read from
+     * @returns {Uint16Array}
+     */
+    readUint16ArrayLE(count, offset) {
+        return this._readArray(count, Uint16Array, true, offset);
+    }
+
+    /**
+     * Reads an array of 16bit unsigned be values
+     *
+     * @param {number} count Number of values to read
+     * @param {number} [offset] Offset to read from
+     * @returns {Uint16Array}
+     */
+    readUint16ArrayBE(count, offset) {
+        return this._readArray(count, Uint16Array, false, offset);
+    }
+
+    /**
+     * Reads an array of 32bit signed le values
+     *
+     * @param {number} count Number of values to read
+     * @param {number} [offset] Offset to read from
+     * @returns {Int32Array}
+     */
+    readInt32ArrayLE(count, offset) {
+        return this._readArray(count, Int32Array, true, offset);
+    }
+
+    /**
+     * Reads an array of 32bit signed be values
+     *
+     * @param {number} count Number of values to read
+     * @param {number} [offset] Offset to read from
+     * @returns {Int32Array}
+     */
+    readInt32ArrayBE(count, offset) {
+        return this._readArray(count, Int32Array, false, offset);
+    }
+
+    /**
+     * Reads an array of 32bit unsigned le values
+     *
+     * @param {number} count Number of values to read
+     * @param {number} [offset] Offset to read from
+     * @returns {Uint32Array}
+     */
+    readUint32ArrayLE(count, offset) {
+        return this._readArray(count, Uint32Array, true, offset);
+    }
+
+    /**
+     * Reads an array of 32bit unsigned be values
+     *
+     * @param {number} count Number of values to read
+     * @param {number} [offset] Offset to read from
+     * @returns {Uint32Array}
+     */
+    readUint32ArrayBE(count, offset) {
+        return this._readArray(count, Uint32Array, false, offset);
+    }
+
+    /**
+     * Reads an array of 32bit float le values
+     *
+     * @param {number} count Number of values to read
+     * @param {number} [offset] Offset to read from
+     * @returns {Float32Array}
+     */
+    readFloat32ArrayLE(count, offset) {
+        return this._readArray(count, Float32Array, true, offset);
+    }
+
+    /**
+     * Reads an array of 32bit float be values
+     *
+     * @param {number} count Number of values to read
+     * @param {number} [offset] Offset to read from
+     * @returns {Float32Array}
+     */
+    readFloat32ArrayBE(count, offset) {
+        return this._readArray(count, Float32Array, false, offset);
+    }
+
+    /**
+     * Reads an array of 64bit float le values
+     *
+     * @param {number} count Number of values to read
+     * @param {number} [offset] Offset to read from
+     * @returns {Float64Array}
+     */
+    readFloat64ArrayLE(count, offset) {
+        return this._readArray(count, Float64Array, true, offset);
+    }
+
+    /**
+     * Reads an array of 64bit float be values
+     *
+     * @param {number} count Number of values to read
+     * @param {number} [offset] Offset to read from
+     * @returns {Float64Array}
+     */
+    readFloat64ArrayBE(count, offset) {
+        return this._readArray(count, Float64Array, false, offset);
+    }
+
     /**
      * Appends some data to this SmartBuffer.
      * This will overwrite any contents behind the specified offset up to the appended data's length.
@@ -1074,6 +1201,173 @@ export default class SmartBuffer {
         return this;
     }
 
+    /**
+     * Writes an array of 16bit signed le values
+     *
+     * @param {Int16Array|number[]} values
+     * @param {number} [offset] Offset to write to
+     * @returns {this}
+     */
+    writeInt16ArrayLE(values, offset) {
+        return this._writeArray(values, Int16Array, true, offset);
+    }
+
+    /**
+     * Writes an array of 16bit signed be values
+     *
+     * @param {Int16Array|number[]} values
+     * @param {number} [offset] Offset to write to
+     * @returns {this}
+     */
+    writeInt16ArrayBE(values, offset) {
+        return this._writeArray(values, Int16Array, false, offset);
+    }
+
+    /**
+     * Writes an array of 16bit unsigned le values
+     *
+     * @param {Uint16Array|number[]} values
+     * @param {number} [offset] Offset to write to
+     * @returns {this}
+     */
+    writeUint16ArrayLE(values, offset) {
+        return this._writeArray(values, Uint16Array, true, offset);
+    }
+
+    /**
+     * Writes an array of 16bit unsigned be values
+     *
+     * @param {Uint16Array|number[]} values
+     * @param {number} [offset] Offset to write to
+     * @returns {this}
+     */
+    writeUint16ArrayBE(values, offset) {
+        return this._writeArray(values, Uint16Array, false, offset);
+    }
+
+    /**
+     * Writes an array of 32bit signed le values
+     *
+     * @param {Int32Array|number[]} values
+     * @param {number} [offset] Offset to write to
+     * @returns {this}
+     */
+    writeInt32ArrayLE(values, offset) {
+        return this._writeArray(values, Int32Array, true, offset);
+    }
+
+    /**
+     * Writes an array of 32bit signed be values
+     *
+     * @param {Int32Array|number[]} values
+     * @param {number} [offset] Offset to write to
+     * @returns {this}
+     */
+    writeInt32ArrayBE(values, offset) {
+        return this._writeArray(values, Int32Array, false, offset);
+    }
+
+    /**
+     * Writes an array of 32bit unsigned le values
+     *
+     * @param {Uint32Array|number[]} values
+     * @param {number} [offset] Offset to write to
+     * @returns {this}
+     */
+    writeUint32ArrayLE(values, offset) {
+        return this._writeArray(values, Uint32Array, true, offset);
+    }
+
+    /**
+     * Writes an array of 32bit unsigned be values
+     *
+     * @param {Uint32Array|number[]} values
+     * @param {number} [offset] Offset to write to
+     * @returns {this}
+     */
+    writeUint32ArrayBE(values, offset) {
+        return this._writeArray(values, Uint32Array, false, offset);
+    }
+
+    /**
+     * Writes an array of 32bit float le values
+     *
+     * @param {Float32Array|number[]} values
+     * @param {number} [offset] Offset to write to
+     * @returns {this}
+     */
+    writeFloat32ArrayLE(values, offset) {
+        return this._writeArray(values, Float32Array, true, offset);
+    }
+
+    /**
+     * Writes an array of 32bit float be values
+     *
+     * @param {Float32Array|number[]} values
+     * @param {number} [offset] Offset to write to
+     * @returns {this}
+     */
+    writeFloat32ArrayBE(values, offset) {
+        return this._writeArray(values, Float32Array, false, offset);
+    }
+
+    /**
+     * Writes an array of 64bit float le values
+     *
+     * @param {Float64Array|number[]} values
+     * @param {number} [offset] Offset to write to
+     * @returns {this}
+     */
+    writeFloat64ArrayLE(values, offset) {
+        return this._writeArray(values, Float64Array, true, offset);
+    }
+
+    /**
+     * Writes an array of 64bit float be values
+     *
+     * @param {Float64Array|number[]} values
+     * @param {number} [offset] Offset to write to
+     * @returns {this}
+     */
+    writeFloat64ArrayBE(values, offset) {
+        return this._writeArray(values, Float64Array, false, offset);
+    }
+
+    // The values are copied as they are in the byte order of the host, and with the bytes of every
+    // value reversed in the other one
+    _readArray(count, ArrayType, littleEndian, offset) {
+        if (!this.noAssert && (!is.number(count) || count % 1 !== 0 || count < 0)) {
+            throw new error.InvalidArgumentException(`Illegal count: ${count} (not a non-negative integer)`);
+        }
+        const bytes = count * ArrayType.BYTES_PER_ELEMENT;
+        offset = this._checkRead(offset, bytes);
+        const values = new ArrayType(count);
+        if (littleEndian === adone.data.byteOrder.isLittleEndian) {
+            this.buffer.copy(Buffer.from(values.buffer), 0, offset, offset + bytes);
+        } else {
+            adone.data.byteOrder.copySwapped(this.buffer, offset, values, 0, bytes, ArrayType.BYTES_PER_ELEMENT);
+        }
+        return values;
+    }
+
+    _writeArray(values, ArrayType, littleEndian, offset) {
+        if (!(values instanceof ArrayType)) {
+            if (!this.noAssert && !is.array(values) && !ArrayBuffer.isView(values)) {
+                throw new error.InvalidArgumentException(`Illegal values: ${values} (not an array)`);
+            }
+            values = ArrayType.from(values);
+        }
+        const bytes = values.byteLength;
+        // the count is checked as the value, the elements of typed arrays need no check
+        offset = this._checkWrite(values.length, offset, bytes);
+        if (littleEndian === adone.data.byteOrder.isLittleEndian) {
+            Buffer.from(values.buffer, values.byteOffset, bytes).copy(this.buffer, offset);
+        } else {
+            adone.data.byteOrder.copySwapped(values, 0, this.buffer, offset, bytes, ArrayType.BYTES_PER_ELEMENT);
+        }
+        return this;
+    }
+
     _checkRead(offset, bytes) {
         if (is.undefined(offset)) {
             offset = this.roffset;
@@ -1470,16 +1764,13 @@ export default class SmartBuffer {
         if (relative) {
             offset = this.woffset;
         }
-        let i;
-        let k = str.length;
+        let k;
         if (!this.noAssert) {
             if (!is.string(str)) {
                 throw new error.InvalidArgumentException("Illegal str: Not a string");
             }
-            for (i = 0; i < k; ++i) {
-                if (str.charCodeAt(i) === 0) {
-                    throw new error.InvalidArgumentException("Illegal str: Contains NULL-characters");
-                }
+            if (str.includes("\u0000")) {
+                throw new error.InvalidArgumentException("Illegal str: Contains NULL-characters");
             }
             if (!is.number(offset) || offset % 1 !== 0) {
                 throw new error.InvalidArgumentException(`Illegal offset: ${offset} (not an integer)`);
@@ -1529,15 +1820,12 @@ export default class SmartBuffer {
             }
         }
         const start = offset;
-        let temp;
         // UTF8 strings do not contain zero bytes in between except for the zero character itself, so:
-        do {
-            if (offset >= this.buffer.length) {
-                throw new error.NotValidException(`Index out of range: ${offset} <= ${this.buffer.length}`);
-            }
-            temp = this.buffer[offset++];
-        } while (temp !== 0);
-        const str = this.buffer.toString("utf8", start, offset - 1);
+        offset = this.buffer.indexOf(0, start);
+        if (offset === -1) {
+            throw new error.NotValidException(`Index out of range: ${this.buffer.length} <= ${this.buffer.length}`);
+        }
+        const str = this.buffer.toString("utf8", start, offset++);
         if (relative) {
             this.roffset = offset;
             return str;
@@ -1621,6 +1909,22 @@ export default class SmartBuffer {
         let temp;
         let sd;
         if (metrics === SmartBuffer.METRICS_CHARS) {
+            // The bytes of the characters are found from their lead bytes, well-formed UTF-8 is decoded by the buffer
+            let end = offset;
+            for (; i < length && end < this.buffer.length; ++i) {
+                temp = this.buffer[end];
+                end += temp < 0x80 ? 1 : temp < 0xE0 ? 2 : temp < 0xF0 ? 3 : 4;
+            }
+            if (i === length && end <= this.buffer.length && adone.data.utf8.validate(this.buffer, offset, end)) {
+                temp = this.buffer.toString("utf8", offset, end);
+                if (relative) {
+                    this.roffset = end;
+                    return temp;
+                }
+                return { string: temp, length: end - start };
+            }
+            // malformed or truncated data is decoded by code points, as it always was
+            i = 0;
             sd = stringDestination();
             utfx.decodeUTF8(() => i < length && offset < this.buffer.length ? this.buffer[offset++] : null, (cp) => {
                 ++i;
@@ -2510,8 +2814,10 @@ export default class SmartBuffer {
 
         let b;
 
-        if (buffer instanceof Uint8Array) { // Extract bytes from Uint8Array
-            b = Buffer.from(buffer);
+        if (buffer instanceof Buffer) {
+            // Buffers are wrapped without a copy
+        } else if (buffer instanceof Uint8Array) { // View the memory of the Uint8Array
+            b = Buffer.from(buffer.buffer, buffer.byteOffset, buffer.byteLength);
             buffer = b;
         } else if (buffer instanceof ArrayBuffer) { // Convert ArrayBuffer to Buffer
             b = Buffer.from(buffer);
@@ -2648,7 +2954,19 @@ export default class SmartBuffer {
      * @returns {number}
      */
     static calculateUTF8Chars(str) {
-        return utfx.calculateUTF16asUTF8(stringSource(str))[0];
+        // a surrogate pair is one code point, a lone surrogate is one too
+        let n = str.length;
+        for (let i = 0; i < str.length - 1; ++i) {
+            const c = str.charCodeAt(i);
+            if (c >= 0xD800 && c <= 0xDBFF) {
+                const d = str.charCodeAt(i + 1);
+                if (d >= 0xDC00 && d <= 0xDFFF) {
+                    --n;
+                    ++i;
+                }
+            }
+        }
+        return n;
     }
 
     /**
@@ -13,11 +13,13 @@ function BufferList(buf) {
     BufferList._init.call(this, buf);
 }
 
+// The buffers are kept with a prefix-sum index: _ends[i] is the end offset of _bufs[i] counted from
+// the first byte ever appended, and _origin is the number of consumed bytes. Offsets are located by
+// binary search, and consumed buffers are skipped by moving _head, the array is compacted lazily.
 BufferList._init = function _init(buf) {
     Object.defineProperty(this, symbol, { value: true });
 
-    this._bufs = [];
-    this.length = 0;
+    this._clear();
 
     if (buf) {
         this.append(buf);
@@ -28,35 +30,51 @@ BufferList.prototype._new = function _new(buf) {
     return new BufferList(buf);
 };
 
-BufferList.prototype._offset = function _offset(offset) {
-    if (offset === 0) {
-        return [0, 0];
+BufferList.prototype._clear = function _clear() {
+    this._bufs = [];
+    this._ends = [];
+    this._head = 0;
+    this._origin = 0;
+    this.length = 0;
+};
+
+// Returns the index of the first buffer ending after the given offset (the last one if there is none)
+BufferList.prototype._search = function _search(offset) {
+    const ends = this._ends;
+    const target = this._origin + offset;
+    let lo = this._head;
+    let hi = ends.length - 1;
+
+    while (lo < hi) {
+        const mid = (lo + hi) >>> 1;
+        if (ends[mid] > target) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
     }
 
-    let tot = 0;
+    return lo;
+};
 
-    for (let i = 0; i < this._bufs.length; i++) {
-        const _t = tot + this._bufs[i].length;
-        if (offset < _t || i === this._bufs.length - 1) {
-            return [i, offset - tot];
-        }
-        tot = _t;
+BufferList.prototype._offset = function _offset(offset) {
+    if (offset === 0 || this._head === this._bufs.length) {
+        return [this._head, 0];
     }
+
+    const i = this._search(offset);
+
+    return [i, offset - this._reverseOffset([i, 0])];
 };
 
 BufferList.prototype._reverseOffset = function (blOffset) {
     const bufferId = blOffset[0];
-    let offset = blOffset[1];
-
-    for (let i = 0; i < bufferId; i++) {
-        offset += this._bufs[i].length;
-    }
 
-    return offset;
+    return this._ends[bufferId] - this._bufs[bufferId].length - this._origin + blOffset[1];
 };
 
 BufferList.prototype.get = function get(index) {
-    if (index > this.length || index < 0) {
+    if (index >= this.length || index < 0) {
         return undefined;
     }
 
@@ -105,13 +123,15 @@ BufferList.prototype.copy = function copy(dst, dstStart, srcStart, srcEnd) {
     if (srcStart === 0 && srcEnd === this.length) {
         if (!copy) {
             // slice, but full concat if multiple buffers
-            return this._bufs.length === 1
-                ? this._bufs[0]
-                : Buffer.concat(this._bufs, this.length);
+            if (this._bufs.length - this._head === 1) {
+                return this._bufs[this._head];
+            }
+            this._compact();
+            return Buffer.concat(this._bufs, this.length);
         }
 
         // copy, need to copy individual buffers
-        for (let i = 0; i < this._bufs.length; i++) {
+        for (let i = this._head; i < this._bufs.length; i++) {
             this._bufs[i].copy(dst, bufoff);
             bufoff += this._bufs[i].length;
         }
@@ -190,25 +210,41 @@ BufferList.prototype.toString = function toString(encoding, start, end) {
 };
 
 BufferList.prototype.consume = function consume(bytes) {
-    while (this._bufs.length) {
-        if (bytes >= this._bufs[0].length) {
-            bytes -= this._bufs[0].length;
-            this.length -= this._bufs[0].length;
-            this._bufs.shift();
-        } else {
-            this._bufs[0] = this._bufs[0].slice(bytes);
-            this.length -= bytes;
-            break;
-        }
+    if (!(bytes > 0)) {
+        return this;
+    }
+
+    if (bytes >= this.length) {
+        this._clear();
+        return this;
+    }
+
+    // drop the consumed buffers by moving the head and slice the first remaining one, nothing is copied
+    const i = this._search(bytes);
+    this._bufs[i] = this._bufs[i].slice(bytes - this._reverseOffset([i, 0]));
+    this._head = i;
+    this._origin += bytes;
+    this.length -= bytes;
+
+    if (i >= 64 && i * 2 >= this._bufs.length) {
+        this._compact();
     }
 
     return this;
 };
 
+BufferList.prototype._compact = function _compact() {
+    if (this._head !== 0) {
+        this._bufs.splice(0, this._head);
+        this._ends.splice(0, this._head);
+        this._head = 0;
+    }
+};
+
 BufferList.prototype.duplicate = function duplicate() {
     const copy = this._new();
 
-    for (let i = 0; i < this._bufs.length; i++) {
+    for (let i = this._head; i < this._bufs.length; i++) {
         copy.append(this._bufs[i]);
     }
 
@@ -229,7 +265,7 @@ BufferList.prototype.append = function append(buf) {
         }
     } else if (this._isBufferList(buf)) {
         // unwrap argument into individual BufferLists
-        for (let i = 0; i < buf._bufs.length; i++) {
+        for (let i = buf._head || 0; i < buf._bufs.length; i++) {
             this.append(buf._bufs[i]);
         }
     } else {
@@ -247,6 +283,7 @@ BufferList.prototype.append = function append(buf) {
 
 BufferList.prototype._appendBuffer = function appendBuffer(buf) {
     this._bufs.push(buf);
+    this._ends.push(this._origin + this.length + buf.length);
     this.length += buf.length;
 };
 
@@ -288,6 +325,10 @@ BufferList.prototype.indexOf = function (search, offset, encoding) {
         return offset > this.length ? this.length : offset;
     }
 
+    if (offset + search.length > this.length) {
+        return -1;
+    }
+
     const blOffset = this._offset(offset);
     let blIndex = blOffset[0]; // index of which internal buffer we're working on
     let buffOffset = blOffset[1]; // offset of the internal buffer we're working on
@@ -296,25 +337,20 @@ BufferList.prototype.indexOf = function (search, offset, encoding) {
     for (; blIndex < this._bufs.length; blIndex++) {
         const buff = this._bufs[blIndex];
 
-        while (buffOffset < buff.length) {
-            const availableWindow = buff.length - buffOffset;
+        if (buff.length - buffOffset >= search.length) {
+            const nativeSearchResult = buff.indexOf(search, buffOffset);
 
-            if (availableWindow >= search.length) {
-                const nativeSearchResult = buff.indexOf(search, buffOffset);
-
-                if (nativeSearchResult !== -1) {
-                    return this._reverseOffset([blIndex, nativeSearchResult]);
-                }
-
-                buffOffset = buff.length - search.length + 1; // end of native search window
-            } else {
-                const revOffset = this._reverseOffset([blIndex, buffOffset]);
+            if (nativeSearchResult !== -1) {
+                return this._reverseOffset([blIndex, nativeSearchResult]);
+            }
 
-                if (this._match(revOffset, search)) {
-                    return revOffset;
-                }
+            buffOffset = buff.length - search.length + 1; // end of native search window
+        }
 
-                buffOffset++;
+        // the rest of the candidates cross into the next buffers
+        for (; buffOffset < buff.length; buffOffset++) {
+            if (buff[buffOffset] === search[0] && this._matchAt(blIndex, buffOffset, search)) {
+                return this._reverseOffset([blIndex, buffOffset]);
             }
         }
 
@@ -325,12 +361,29 @@ BufferList.prototype.indexOf = function (search, offset, encoding) {
 };
 
 BufferList.prototype._match = function (offset, search) {
-    if (this.length - offset < search.length) {
+    if (offset < 0 || this.length - offset < search.length) {
         return false;
     }
 
-    for (let searchOffset = 0; searchOffset < search.length; searchOffset++) {
-        if (this.get(offset + searchOffset) !== search[searchOffset]) {
+    const blOffset = this._offset(offset);
+
+    return this._matchAt(blOffset[0], blOffset[1], search);
+};
+
+// Compares the search bytes with the bytes starting at the given position, walking over the buffers
+BufferList.prototype._matchAt = function (blIndex, buffOffset, search) {
+    let buff = this._bufs[blIndex];
+
+    for (let searchOffset = 0; searchOffset < search.length; searchOffset++, buffOffset++) {
+        while (buffOffset >= buff.length) {
+            if (++blIndex === this._bufs.length) {
+                return false;
+            }
+            buff = this._bufs[blIndex];
+            buffOffset = 0;
+        }
+
+        if (buff[buffOffset] !== search[searchOffset]) {
             return false;
         }
     }
@@ -449,8 +502,7 @@ BufferListStream.prototype.end = function end(chunk) {
 };
 
 BufferListStream.prototype._destroy = function _destroy(err, cb) {
-    this._bufs.length = 0;
-    this.length = 0;
+    this._clear();
     cb(err);
 };
 
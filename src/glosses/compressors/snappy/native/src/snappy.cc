@@ -1,20 +1,96 @@
 #include <adone.h>
+#include <adone_pool.h>
+#define ADONE_TRACE_IMPLEMENTATION
+#include <adone_trace.h>
 #include <node_buffer.h>
 #include <node_version.h>
 #include <snappy.h>
 
 #include <string.h> // memcpy
 
-#include <string>
 
 namespace nodesnappy
 {
 
-class CompressWorker : public Nan::AsyncWorker
+// Copies the input (a Buffer or a string) into a pooled block, so it can be used off the JS thread.
+// Returns NULL if out of memory.
+static adone::PooledBuffer *CopyInput(adone::BufferPool *pool, v8::Local<v8::Value> value)
+{
+  adone::PooledBuffer *input;
+  if (node::Buffer::HasInstance(value))
+  {
+    v8::Local<v8::Object> object = value.As<v8::Object>();
+    size_t length = node::Buffer::Length(object);
+    input = new adone::PooledBuffer(pool, length);
+    if (input->Data() != NULL)
+    {
+      memcpy(input->Data(), node::Buffer::Data(object), length);
+    }
+  }
+  else
+  {
+    Nan::Utf8String param1(value.As<v8::String>());
+    input = new adone::PooledBuffer(pool, param1.length());
+    if (input->Data() != NULL)
+    {
+      memcpy(input->Data(), *param1, param1.length());
+    }
+  }
+  if (input->Data() == NULL)
+  {
+    delete input;
+    return NULL;
+  }
+  return input;
+}
+
+static void CompressInto(adone::PooledBuffer *dst, const char *data, size_t length)
+{
+  size_t compressedLength;
+  snappy::RawCompress(data, length, dst->Data(), &compressedLength);
+  dst->SetLength(compressedLength);
+}
+
+// Returns NULL and sets `error` if the input is not valid or the output could not be allocated
+static adone::PooledBuffer *UncompressInto(adone::BufferPool *pool, const char *data, size_t length, const char **error)
+{
+  size_t uncompressedLength;
+  if (!snappy::GetUncompressedLength(data, length, &uncompressedLength))
+  {
+    *error = "Invalid input";
+    return NULL;
+  }
+  adone::PooledBuffer *dst = new adone::PooledBuffer(pool, uncompressedLength);
+  if (dst->Data() == NULL)
+  {
+    delete dst;
+    *error = "Out of memory";
+    return NULL;
+  }
+  if (!snappy::RawUncompress(data, length, dst->Data()))
+  {
+    delete dst;
+    *error = "Invalid input";
+    return NULL;
+  }
+  return dst;
+}
+
+static v8::Local<v8::Value> UncompressedResult(adone::PooledBuffer *dst, bool asBuffer)
+{
+  if (asBuffer)
+  {
+    return dst->ToBuffer();
+  }
+  return Nan::New<v8::String>(dst->Data(), dst->Length()).ToLocalChecked();
+}
+
+class CompressWorker : public adone::PoolWorker
 {
 public:
-  CompressWorker(std::string *input, Nan::Callback *callback)
-      : Nan::AsyncWorker(callback), input(input) {}
+  CompressWorker(adone::BufferPool *pool, adone::PooledBuffer *input, Nan::Callback *callback)
+      : adone::PoolWorker(callback, "snappy"), input(input),
+        dst(pool, snappy::MaxCompressedLength(input->Length())) {}
 
   ~CompressWorker()
   {
@@ -23,32 +99,36 @@ public:
 
   void Execute()
   {
-    snappy::Compress(input->data(), input->length(), &dst);
+    ADONE_TRACE_SPAN("snappy", "compress:queued", queued_at);
+    ADONE_TRACE_SCOPE("snappy", "compress");
+    if (dst.Data() == NULL)
+    {
+      SetErrorMessage("Out of memory");
+      return;
+    }
+    CompressInto(&dst, input->Data(), input->Length());
   }
 
   void HandleOKCallback()
   {
     Nan::HandleScope scope;
 
-    v8::Local<v8::Object> res = Nan::NewBuffer(dst.length()).ToLocalChecked();
-    memcpy(node::Buffer::Data(res), dst.c_str(), dst.length());
-
     v8::Local<v8::Value> argv[] = {
-        Nan::Null(), res};
+        Nan::Null(), dst.ToBuffer()};
 
     callback->Call(2, argv, async_resource);
   }
 
 private:
-  std::string *input;
-  std::string dst;
+  adone::PooledBuffer *input;
+  adone::PooledBuffer dst;
 };
 
-class IsValidCompressedWorker : public Nan::AsyncWorker
+class IsValidCompressedWorker : public adone::PoolWorker
 {
 public:
-  IsValidCompressedWorker(std::string *input, Nan::Callback *callback)
-      : Nan::AsyncWorker(callback), input(input) {}
+  IsValidCompressedWorker(adone::PooledBuffer *input, Nan::Callback *callback)
+      : adone::PoolWorker(callback, "snappy"), input(input) {}
 
   ~IsValidCompressedWorker()
   {
@@ -57,7 +137,9 @@ public:
 
   void Execute()
   {
-    res = snappy::IsValidCompressedBuffer(input->data(), input->length());
+    ADONE_TRACE_SPAN("snappy", "isValidCompressed:queued", queued_at);
+    ADONE_TRACE_SCOPE("snappy", "isValidCompressed");
+    res = snappy::IsValidCompressedBuffer(input->Data(), input->Length());
   }
 
   void HandleOKCallback()
@@ -71,114 +153,107 @@ public:
   }
 
 private:
-  std::string *input;
+  adone::PooledBuffer *input;
   bool res;
 };
 
-class UncompressWorker : public Nan::AsyncWorker
+class UncompressWorker : public adone::PoolWorker
 {
 public:
-  UncompressWorker(std::string *input, bool asBuffer, Nan::Callback *callback)
-      : Nan::AsyncWorker(callback), input(input), asBuffer(asBuffer) {}
+  UncompressWorker(adone::BufferPool *pool, adone::PooledBuffer *input, bool asBuffer, Nan::Callback *callback)
+      : adone::PoolWorker(callback, "snappy"), pool(pool), input(input), dst(NULL), asBuffer(asBuffer) {}
 
   ~UncompressWorker()
   {
     delete input;
+    delete dst;
   }
 
   void Execute()
   {
-    if (!snappy::Uncompress(input->data(), input->length(), &dst))
-      SetErrorMessage("Invalid input");
+    ADONE_TRACE_SPAN("snappy", "uncompress:queued", queued_at);
+    ADONE_TRACE_SCOPE("snappy", "uncompress");
+    const char *error;
+    dst = UncompressInto(pool, input->Data(), input->Length(), &error);
+    if (dst == NULL)
+      SetErrorMessage(error);
   }
 
   void HandleOKCallback()
   {
     Nan::HandleScope scope;
 
-    v8::Local<v8::Value> res;
-    if (asBuffer)
-    {
-      res = Nan::NewBuffer(dst.length()).ToLocalChecked();
-      memcpy(node::Buffer::Data(res.As<v8::Object>()), dst.c_str(), dst.length());
-    }
-    else
-    {
-      res = Nan::New<v8::String>(dst.c_str(), dst.length()).ToLocalChecked();
-    }
-
     v8::Local<v8::Value> argv[] = {
-        Nan::Null(), res};
+        Nan::Null(), UncompressedResult(dst, asBuffer)};
 
     callback->Call(2, argv, async_resource);
   }
 
 private:
-  std::string *input;
-  std::string dst;
+  adone::BufferPool *pool;
+  adone::PooledBuffer *input;
+  adone::PooledBuffer *dst;
   bool asBuffer;
 };
 
 NAN_METHOD(Compress)
 {
-  std::string *input;
-
-  if (node::Buffer::HasInstance(info[0].As<v8::Object>()))
+  adone::BufferPool *pool = adone::GetBufferPool();
+  adone::PooledBuffer *input = CopyInput(pool, info[0]);
+  if (input == NULL)
   {
-    v8::Local<v8::Object> object = info[0].As<v8::Object>();
-    size_t length = node::Buffer::Length(object);
-    const char *data = node::Buffer::Data(object);
-    input = new std::string(data, length);
-  }
-  else
-  {
-    Nan::Utf8String param1(info[0].As<v8::String>());
-    input = new std::string(*param1);
+    return Nan::ThrowError("Out of memory");
   }
 
   Nan::Callback *callback = new Nan::Callback(
       v8::Local<v8::Function>::Cast(info[1]));
 
   CompressWorker *worker = new CompressWorker(
-      input, callback);
+      pool, input, callback);
 
-  Nan::AsyncQueueWorker(worker);
+  adone::QueueWorker(worker);
 
   return;
 }
 
 NAN_METHOD(CompressSync)
 {
-  std::string input;
-  std::string dst;
+  ADONE_TRACE_SCOPE("snappy", "compressSync");
+  adone::BufferPool *pool = adone::GetBufferPool();
 
-  if (node::Buffer::HasInstance(info[0].As<v8::Object>()))
+  if (node::Buffer::HasInstance(info[0]))
   {
     v8::Local<v8::Object> object = info[0].As<v8::Object>();
     size_t length = node::Buffer::Length(object);
     const char *data = node::Buffer::Data(object);
-    input.assign(data, length);
+    adone::PooledBuffer dst(pool, snappy::MaxCompressedLength(length));
+    if (dst.Data() == NULL)
+    {
+      return Nan::ThrowError("Out of memory");
+    }
+    CompressInto(&dst, data, length);
+    info.GetReturnValue().Set(dst.ToBuffer());
   }
   else
   {
     Nan::Utf8String param1(info[0].As<v8::String>());
-    input.assign(*param1);
+    adone::PooledBuffer dst(pool, snappy::MaxCompressedLength(param1.length()));
+    if (dst.Data() == NULL)
+    {
+      return Nan::ThrowError("Out of memory");
+    }
+    CompressInto(&dst, *param1, param1.length());
+    info.GetReturnValue().Set(dst.ToBuffer());
   }
-
-  snappy::Compress(input.data(), input.length(), &dst);
-
-  v8::Local<v8::Object> res = Nan::NewBuffer(dst.length()).ToLocalChecked();
-  memcpy(node::Buffer::Data(res), dst.c_str(), dst.length());
-
-  info.GetReturnValue().Set(res);
 }
 
 NAN_METHOD(IsValidCompressed)
 {
-  v8::Local<v8::Object> object = info[0].As<v8::Object>();
-  size_t length = node::Buffer::Length(object);
-  const char *data = node::Buffer::Data(object);
-  std::string *input = new std::string(data, length);
+  adone::PooledBuffer *input = CopyInput(adone::GetBufferPool(), info[0]);
+  if (input == NULL)
+  {
+    return Nan::ThrowError("Out of memory");
+  }
 
   Nan::Callback *callback = new Nan::Callback(
       v8::Local<v8::Function>::Cast(info[1]));
@@ -186,14 +261,14 @@ NAN_METHOD(IsValidCompressed)
   IsValidCompressedWorker *worker = new IsValidCompressedWorker(
       input, callback);
 
-  Nan::AsyncQueueWorker(worker);
+  adone::QueueWorker(worker);
 
   return;
 }
 
 NAN_METHOD(IsValidCompressedSync)
 {
-
+  ADONE_TRACE_SCOPE("snappy", "isValidCompressedSync");
   v8::Local<v8::Object> object = info[0].As<v8::Object>();
   size_t length = node::Buffer::Length(object);
   const char *data = node::Buffer::Data(object);
@@ -205,12 +280,14 @@ NAN_METHOD(IsValidCompressedSync)
 
 NAN_METHOD(Uncompress)
 {
+  adone::BufferPool *pool = adone::GetBufferPool();
+  adone::PooledBuffer *input = CopyInput(pool, info[0]);
+  if (input == NULL)
+  {
+    return Nan::ThrowError("Out of memory");
+  }
 
-  v8::Local<v8::Object> object = info[0].As<v8::Object>();
   v8::Local<v8::Object> optionsObj = info[1].As<v8::Object>();
-  size_t length = node::Buffer::Length(object);
-  const char *data = node::Buffer::Data(object);
-  std::string *input = new std::string(data, length);
   bool asBuffer = Nan::To<bool>(
                       Nan::Get(optionsObj, Nan::New("asBuffer").ToLocalChecked())
                           .ToLocalChecked())
@@ -220,17 +297,16 @@ NAN_METHOD(Uncompress)
       v8::Local<v8::Function>::Cast(info[2]));
 
   UncompressWorker *worker = new UncompressWorker(
-      input, asBuffer, callback);
+      pool, input, asBuffer, callback);
 
-  Nan::AsyncQueueWorker(worker);
+  adone::QueueWorker(worker);
 
   return;
 }
 
 NAN_METHOD(UncompressSync)
 {
-  std::string dst;
-
+  ADONE_TRACE_SCOPE("snappy", "uncompressSync");
   v8::Local<v8::Object> object = info[0].As<v8::Object>();
   size_t length = node::Buffer::Length(object);
   const char *data = node::Buffer::Data(object);
@@ -241,23 +317,15 @@ NAN_METHOD(UncompressSync)
                           .ToLocalChecked())
                       .FromJust();
 
-  if (!snappy::Uncompress(data, length, &dst))
-  {
-    return Nan::ThrowError("Invalid input");
-  }
-
-  v8::Local<v8::Value> res;
-  if (asBuffer)
-  {
-    res = Nan::NewBuffer(dst.length()).ToLocalChecked();
-    memcpy(node::Buffer::Data(res.As<v8::Object>()), dst.c_str(), dst.length());
-  }
-  else
+  const char *error;
+  adone::PooledBuffer *dst = UncompressInto(adone::GetBufferPool(), data, length, &error);
+  if (dst == NULL)
   {
-    res = Nan::New<v8::String>(dst.c_str(), dst.length()).ToLocalChecked();
+    return Nan::ThrowError(error);
   }
 
-  info.GetReturnValue().Set(res);
+  info.GetReturnValue().Set(UncompressedResult(dst, asBuffer));
+  delete dst;
 }
 
 extern "C" NAN_MODULE_INIT(init)
@@ -268,6 +336,7 @@ extern "C" NAN_MODULE_INIT(init)
   Nan::SetMethod(target, "isValidCompressedSync", IsValidCompressedSync);
   Nan::SetMethod(target, "uncompress", Uncompress);
   Nan::SetMethod(target, "uncompressSync", UncompressSync);
+  adone::trace::Export(target);
 }
 
 NODE_MODULE(binding, init)
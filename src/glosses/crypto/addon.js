@@ -0,0 +1,11 @@
+// The native crypto addon (./native), null if it is not built for this platform.
+// Modules that have a native backend check it together with crypto.options.usePureJavaScript.
+
+let addon = null;
+try {
+    addon = adone.nodejs.trace.register("crypto", adone.requireAddon(adone.path.join(__dirname, "native", "crypto.node")));
+} catch (err) {
+    // the pure JavaScript implementations are used
+}
+
+module.exports = addon;
@@ -20,6 +20,9 @@ const {
     crypto
 } = adone;
 
+const addon = crypto.options.usePureJavaScript ? null : require("./addon");
+const { NativeMode } = require("./native_aes");
+
 // require("./cipherModes");
 
 /**
@@ -133,6 +136,9 @@ export const createDecryptionCipher = function (key, mode) {
 /**
  * Creates a new AES cipher algorithm object.
  *
+ * The modes of cipher_modes.js are run by the native AES (native_aes.js) when the crypto addon
+ * is available.
+ *
  * @param name the name of the algorithm.
  * @param mode the mode factory function.
  *
@@ -144,6 +150,12 @@ export const Algorithm = function (name, mode) {
     }
     const self = this;
     self.name = name;
+    const nativeName = addon ? getNativeModeName(mode) : null;
+    if (nativeName) {
+        self.mode = new NativeMode(addon.Aes, nativeName);
+        self._init = false;
+        return;
+    }
     self.mode = new mode({
         blockSize: 16,
         cipher: {
@@ -219,10 +231,30 @@ Algorithm.prototype.initialize = function (options) {
     const encryptOp = (["CFB", "OFB", "CTR", "GCM"].indexOf(mode) !== -1);
 
     // do key expansion
-    this._w = __expandKey(key, options.decrypt && !encryptOp);
+    if (this.mode instanceof NativeMode) {
+        this.mode.setKey(key, options.decrypt);
+    } else {
+        this._w = __expandKey(key, options.decrypt && !encryptOp);
+    }
     this._init = true;
 };
 
+/**
+ * Gets the native AES kernel in use and the best one supported by the CPU.
+ *
+ * @return {active, best}, "aes-ni" or "bitsliced", "js" without the native addon.
+ */
+export const getKernel = () => addon ? addon.aesGetKernel() : { active: "js", best: "js" };
+
+/**
+ * Forces a native AES kernel, typically only used for testing.
+ *
+ * @param name the name of the kernel.
+ *
+ * @return false if the kernel is unknown or not supported by the CPU.
+ */
+export const setKernel = (name) => addon ? addon.aesSetKernel(name) : name === "js";
+
 /**
  * Expands a key. Typically only used for testing.
  *
@@ -259,6 +291,16 @@ registerAlgorithm("AES-OFB", crypto.cipher.modes.ofb);
 registerAlgorithm("AES-CTR", crypto.cipher.modes.ctr);
 registerAlgorithm("AES-GCM", crypto.cipher.modes.gcm);
 
+// the modes of cipher_modes.js that the native AES implements
+function getNativeModeName(mode) {
+    for (const name of ["ecb", "cbc", "cfb", "ofb", "ctr", "gcm"]) {
+        if (crypto.cipher.modes[name] === mode) {
+            return name.toUpperCase();
+        }
+    }
+    return null;
+}
+
 function registerAlgorithm(name, mode) {
     const factory = function () {
         return new Algorithm(name, mode);
@@ -1,15 +1,87 @@
+const {
+    is,
+    crypto
+} = adone;
+
 const b2b = require("./blake2b");
 const b2s = require("./blake2s");
+const util = require("./util");
+const addon = crypto.options.usePureJavaScript ? null : require("../addon");
 
-module.exports = {
-    blake2b: b2b.blake2b,
-    blake2bHex: b2b.blake2bHex,
-    blake2bInit: b2b.blake2bInit,
-    blake2bUpdate: b2b.blake2bUpdate,
-    blake2bFinal: b2b.blake2bFinal,
-    blake2s: b2s.blake2s,
-    blake2sHex: b2s.blake2sHex,
-    blake2sInit: b2s.blake2sInit,
-    blake2sUpdate: b2s.blake2sUpdate,
-    blake2sFinal: b2s.blake2sFinal
+// The native implementation hashes Buffers and Uint8Arrays in place, only strings are converted
+const toBytes = (input) => {
+    if (is.string(input)) {
+        return Buffer.from(input, "utf8");
+    }
+    if (input instanceof Uint8Array) {
+        return input;
+    }
+    return util.normalizeInput(input);
 };
+
+const toKey = (key) => key ? toBytes(key) : undefined;
+
+// digests of a batch are returned by the addon as a single buffer
+const splitDigests = (buf, count) => {
+    const outlen = count > 0 ? buf.length / count : 0;
+    const result = new Array(count);
+    for (let i = 0; i < count; i++) {
+        result[i] = buf.subarray(i * outlen, (i + 1) * outlen);
+    }
+    return result;
+};
+
+const createNative = (name, Hash, js) => {
+    const hash = (input, key, outlen) => addon[name](toBytes(input), toKey(key), outlen ? Number(outlen) : undefined);
+
+    return {
+        [name]: hash,
+        [`${name}Hex`]: (input, key, outlen) => hash(input, key, outlen).toString("hex"),
+        [`${name}Init`]: (outlen, key) => new Hash(is.undefined(outlen) ? undefined : Number(outlen), toKey(key)),
+        [`${name}Update`]: (ctx, input) => {
+            if (ctx instanceof Hash) {
+                ctx.update(toBytes(input));
+            } else {
+                js[`${name}Update`](ctx, input);
+            }
+        },
+        [`${name}Final`]: (ctx) => ctx instanceof Hash ? ctx.final() : js[`${name}Final`](ctx),
+        [`${name}Batch`]: (inputs, key, outlen) => new Promise((resolve, reject) => {
+            inputs = inputs.map(toBytes);
+            addon[`${name}Batch`](inputs, toKey(key), outlen ? Number(outlen) : undefined, (err, result) => {
+                if (err) {
+                    return reject(err);
+                }
+                resolve(splitDigests(result, inputs.length));
+            });
+        }),
+        [`${name}BatchSync`]: (inputs, key, outlen) => {
+            inputs = inputs.map(toBytes);
+            return splitDigests(addon[`${name}BatchSync`](inputs, toKey(key), outlen ? Number(outlen) : undefined), inputs.length);
+        }
+    };
+};
+
+const createJs = (name, js) => ({
+    [name]: js[name],
+    [`${name}Hex`]: js[`${name}Hex`],
+    [`${name}Init`]: js[`${name}Init`],
+    [`${name}Update`]: js[`${name}Update`],
+    [`${name}Final`]: js[`${name}Final`],
+    [`${name}Batch`]: async (inputs, key, outlen) => inputs.map((input) => js[name](input, key, outlen)),
+    [`${name}BatchSync`]: (inputs, key, outlen) => inputs.map((input) => js[name](input, key, outlen))
+});
+
+module.exports = addon
+    ? {
+        ...createNative("blake2b", addon.Blake2b, b2b),
+        ...createNative("blake2s", addon.Blake2s, b2s),
+        getKernel: () => addon.blake2GetKernel(),
+        setKernel: (name) => addon.blake2SetKernel(name)
+    }
+    : {
+        ...createJs("blake2b", b2b),
+        ...createJs("blake2s", b2s),
+        getKernel: () => ({ active: "js", best: "js" }),
+        setKernel: (name) => name === "js"
+    };
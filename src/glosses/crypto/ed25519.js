@@ -21,6 +21,8 @@ if (is.undefined(BigInteger)) {
 const ByteBuffer = crypto.util.ByteBuffer;
 const NativeBuffer = is.undefined(Buffer) ? Uint8Array : Buffer;
 
+const addon = crypto.options.usePureJavaScript ? null : require("./addon");
+
 /**
  * Ed25519 algorithms, see RFC 8032:
  * https://tools.ietf.org/html/rfc8032
@@ -57,7 +59,12 @@ export const generateKeyPair = function (options) {
     for (let i = 0; i < 32; ++i) {
         sk[i] = seed[i];
     }
-    crypto_sign_keypair(pk, sk);
+    if (addon) {
+        pk.set(addon.ed25519PublicKey(seed));
+        sk.set(pk, 32);
+    } else {
+        crypto_sign_keypair(pk, sk);
+    }
     return { publicKey: pk, privateKey: sk };
 };
 
@@ -88,6 +95,9 @@ export const sign = function (options) {
     if (privateKey.length !== constants.PRIVATE_KEY_BYTE_LENGTH) {
         throw new TypeError(`"options.privateKey" must have a byte length of ${constants.PRIVATE_KEY_BYTE_LENGTH}`);
     }
+    if (addon) {
+        return addon.ed25519Sign(msg, privateKey);
+    }
 
     const signedMsg = new NativeBuffer(
         constants.SIGN_BYTE_LENGTH + msg.length);
@@ -100,7 +110,8 @@ export const sign = function (options) {
     return sig;
 };
 
-export const verify = function (options) {
+// Converts and checks the message, the signature and the public key given to verify()
+const verifyArgs = function (options) {
     options = options || {};
     const msg = messageToNativeBuffer(options);
     if (is.undefined(options.signature)) {
@@ -122,6 +133,14 @@ export const verify = function (options) {
     if (publicKey.length !== constants.PUBLIC_KEY_BYTE_LENGTH) {
         throw new TypeError(`"options.publicKey" must have a byte length of ${constants.PUBLIC_KEY_BYTE_LENGTH}`);
     }
+    return { msg, sig, publicKey };
+};
+
+export const verify = function (options) {
+    const { msg, sig, publicKey } = verifyArgs(options);
+    if (addon) {
+        return addon.ed25519Verify(msg, sig, publicKey);
+    }
 
     const sm = new NativeBuffer(constants.SIGN_BYTE_LENGTH + msg.length);
     const m = new NativeBuffer(constants.SIGN_BYTE_LENGTH + msg.length);
@@ -135,6 +154,33 @@ export const verify = function (options) {
     return (crypto_sign_open(m, sm, sm.length, publicKey) >= 0);
 };
 
+/**
+ * Verifies many signatures at once. The native implementation checks them with a single
+ * multi-scalar multiplication on the worker pool, which is much faster than verifying them one by
+ * one; if the combined check fails the signatures are verified separately. Both use the cofactored
+ * equation, so the results are always the ones of verify().
+ *
+ * @param items an array of the options of verify(): {message, encoding, signature, publicKey}.
+ *
+ * @return a promise of an array of booleans, true for the valid signatures.
+ */
+export const verifyBatch = function (items) {
+    const args = items.map(verifyArgs);
+    if (!addon) {
+        return Promise.resolve(args.map(({ msg, sig, publicKey }) => verify({ message: msg, signature: sig, publicKey })));
+    }
+    return new Promise((resolve, reject) => {
+        // the coefficients of the combined check must not be predictable
+        const seed = crypto.random.getBytesSync(32);
+        addon.ed25519VerifyBatch(
+            args.map((arg) => arg.msg),
+            args.map((arg) => arg.sig),
+            args.map((arg) => arg.publicKey),
+            Buffer.from(seed, "binary"),
+            (err, results) => err ? reject(err) : resolve(results));
+    });
+};
+
 function messageToNativeBuffer(options) {
     let message = options.message;
     if (message instanceof Uint8Array) {
@@ -197,6 +243,9 @@ const L = new Float64Array([
 const I = gf([
     0xa0b0, 0x4a0e, 0x1b27, 0xc4ee, 0xe478, 0xad2f, 0x1806, 0x2f43,
     0xd7a7, 0x3dfb, 0x0099, 0x2b4d, 0xdf0b, 0x4fc1, 0x2480, 0x2b83]);
+// the encoding of the neutral point
+const IDENTITY = new NativeBuffer(32).fill(0);
+IDENTITY[0] = 1;
 
 // TODO: update forge buffer implementation to use `Buffer` or `Uint8Array`,
 // whichever is available, to improve performance
@@ -279,14 +328,25 @@ function crypto_sign(sm, m, n, sk) {
     return smlen;
 }
 
+// S must be below L, S + L would verify as well
+function isCanonicalScalar(s) {
+    for (let i = 31; i >= 0; i--) {
+        if (s[i] !== L[i]) {
+            return s[i] < L[i];
+        }
+    }
+    return false;
+}
+
 function crypto_sign_open(m, sm, n, pk) {
     let i; let mlen;
     const t = new NativeBuffer(32);
     const p = [gf(), gf(), gf(), gf()];
     const q = [gf(), gf(), gf(), gf()];
+    const r = [gf(), gf(), gf(), gf()];
 
     mlen = -1;
-    if (n < 64) {
+    if (n < 64 || !isCanonicalScalar(sm.subarray(32, 64))) {
         return -1;
     }
 
@@ -294,6 +354,19 @@ function crypto_sign_open(m, sm, n, pk) {
         return -1;
     }
 
+    // R must be the canonical encoding of a point
+    if (unpackneg(r, sm)) {
+        return -1;
+    }
+    Z(p[0], gf0, r[0]);
+    set25519(p[1], r[1]);
+    set25519(p[2], r[2]);
+    Z(p[3], gf0, r[3]);
+    pack(t, p);
+    if (crypto_verify_32(sm, 0, t, 0)) {
+        return -1;
+    }
+
     for (i = 0; i < n; ++i) {
         m[i] = sm[i];
     }
@@ -306,10 +379,16 @@ function crypto_sign_open(m, sm, n, pk) {
 
     scalarbase(q, sm.subarray(32));
     add(p, q);
+
+    // the cofactored equation of the native implementation, 8 (S B - h A - R) = 0
+    add(p, r);
+    for (i = 0; i < 3; ++i) {
+        add(p, p);
+    }
     pack(t, p);
 
     n -= 64;
-    if (crypto_verify_32(sm, 0, t, 0)) {
+    if (crypto_verify_32(IDENTITY, 0, t, 0)) {
         for (i = 0; i < n; ++i) {
             m[i] = 0;
         }
@@ -0,0 +1,76 @@
+const {
+    is,
+    crypto
+} = adone;
+
+const addon = crypto.options.usePureJavaScript ? null : require("./addon");
+
+// See http://www.isthe.com/chongo/tech/comp/fnv/#FNV-param for the definition of these parameters
+const FNV_PRIME = 16777619;
+const OFFSET_BASIS = 2166136261;
+
+const toBytes = (input, encoding) => is.string(input) ? Buffer.from(input, encoding || "utf8") : input;
+
+// xor-folding of a 32-bit hash to 24 bits, see http://www.isthe.com/chongo/tech/comp/fnv/#xor-fold
+const fold24 = (hash) => ((hash & 0xffffff) ^ (hash >>> 24)) >>> 0;
+
+/**
+ * Computes the 32-bit FNV-1a hash (http://www.isthe.com/chongo/tech/comp/fnv/#FNV-1a).
+ *
+ * @param input a string or a Buffer/Uint8Array.
+ * @param encoding the encoding of a string input, utf8 by default.
+ *
+ * @return the hash as an unsigned int.
+ */
+export const hash32 = function (input, encoding) {
+    const bytes = toBytes(input, encoding);
+    if (addon) {
+        return addon.fnv1a32(bytes);
+    }
+    let hash = OFFSET_BASIS;
+    for (let i = 0; i < bytes.length; i++) {
+        hash = Math.imul(hash ^ bytes[i], FNV_PRIME);
+    }
+    return hash >>> 0;
+};
+
+/**
+ * Computes the 32-bit FNV-1a hash xor-folded to 24 bits.
+ */
+export const hash24 = function (input, encoding) {
+    return fold24(hash32(input, encoding));
+};
+
+const batch = function (keys, offsets, fold) {
+    if (addon) {
+        return addon.fnv1aBatch(keys, offsets, fold);
+    }
+    const packed = !is.array(keys);
+    const count = packed ? offsets.length - 1 : keys.length;
+    const result = new Uint32Array(count);
+    for (let i = 0; i < count; i++) {
+        const hash = hash32(packed ? keys.subarray(offsets[i], offsets[i + 1]) : keys[i]);
+        result[i] = fold ? fold24(hash) : hash;
+    }
+    return result;
+};
+
+/**
+ * Computes the 32-bit FNV-1a hashes of many keys at once.
+ *
+ * @param keys an array of strings (hashed as UTF-8) and Buffers/Uint8Arrays, or a single
+ *   Buffer/Uint8Array of packed keys.
+ * @param offsets for packed keys, an Uint32Array of the count + 1 offsets that delimit them.
+ *
+ * @return an Uint32Array of the hashes.
+ */
+export const hash32Batch = function (keys, offsets) {
+    return batch(keys, offsets, false);
+};
+
+/**
+ * Computes the 24-bit folded FNV-1a hashes of many keys at once, the same arguments as hash32Batch().
+ */
+export const hash24Batch = function (keys, offsets) {
+    return batch(keys, offsets, true);
+};
@@ -54,6 +54,7 @@ lazify({
     // extra
     blake: "./blake",
     crc: "./crc",
+    fnv1a: "./fnv1a",
     murmurHash3: "./murmur_hash3",
     sha3: "./sha3"
 }, adone.asNamespace(exports), require);
@@ -10,6 +10,9 @@ const {
     crypto
 } = adone;
 
+const addon = crypto.options.usePureJavaScript ? null : require("./addon");
+const nativeMd = require("./native_md");
+
 // const md5 = module.exports = forge.md5 = forge.md5 || {};
 // forge.md.md5 = forge.md.algorithms.md5 = md5;
 
@@ -19,6 +22,17 @@ const {
  * @return a message digest object.
  */
 export const create = function () {
+    if (addon) {
+        return nativeMd.create(addon.Md5, {
+            algorithm: "md5",
+            blockLength: 64,
+            digestLength: 16,
+            messageLength: 0,
+            fullMessageLength: null,
+            messageLengthSize: 8
+        });
+    }
+
     // do initialization as necessary
     if (!_initialized) {
         _init();
@@ -86,6 +100,8 @@ export const create = function () {
     md.update = function (msg, encoding) {
         if (encoding === "utf8") {
             msg = crypto.util.encodeUtf8(msg);
+        } else {
+            msg = nativeMd.toBinaryString(msg);
         }
 
         // update message length
@@ -113,6 +129,15 @@ export const create = function () {
         return md;
     };
 
+    /**
+     * The same as update(), for parity with the native digest that hashes on the worker pool.
+     *
+     * @return a promise of this digest object.
+     */
+    md.updateAsync = async function (msg, encoding) {
+        return md.update(msg, encoding);
+    };
+
     /**
      * Produces the digest.
      *
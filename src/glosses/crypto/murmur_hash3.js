@@ -1,7 +1,15 @@
 const {
-    is
+    is,
+    crypto
 } = adone;
 
+const addon = crypto.options.usePureJavaScript ? null : require("./addon");
+
+// variants of the addon's murmur3() and murmur3Batch()
+const X86_32 = 0;
+const X86_128 = 1;
+const X64_128 = 2;
+
 // Create a local object that'll be exported or referenced globally.
 const library = {
     x86: {},
@@ -197,6 +205,9 @@ library.x86.hash32 = function (bytes, seed) {
     // Given a string and an optional seed as an int, returns a 32 bit hash
     // using the x86 flavor of MurmurHash3, as an unsigned int.
     //
+    if (addon && bytes instanceof Uint8Array) {
+        return addon.murmur3(X86_32, bytes, seed);
+    }
     if (library.inputValidation && !_validBytes(bytes)) {
         return undefined;
     }
@@ -252,6 +263,9 @@ library.x86.hash128 = function (bytes, seed) {
     // Given a string and an optional seed as an int, returns a 128 bit
     // hash using the x86 flavor of MurmurHash3, as an unsigned hex.
     //
+    if (addon && bytes instanceof Uint8Array) {
+        return addon.murmur3(X86_128, bytes, seed);
+    }
     if (library.inputValidation && !_validBytes(bytes)) {
         return undefined;
     }
@@ -418,6 +432,9 @@ library.x64.hash128 = function (bytes, seed) {
     // Given a string and an optional seed as an int, returns a 128 bit
     // hash using the x64 flavor of MurmurHash3, as an unsigned hex.
     //
+    if (addon && bytes instanceof Uint8Array) {
+        return addon.murmur3(X64_128, bytes, seed);
+    }
     if (library.inputValidation && !_validBytes(bytes)) {
         return undefined;
     }
@@ -533,5 +550,53 @@ library.x64.hash128 = function (bytes, seed) {
     return (`00000000${(h1[0] >>> 0).toString(16)}`).slice(-8) + (`00000000${(h1[1] >>> 0).toString(16)}`).slice(-8) + (`00000000${(h2[0] >>> 0).toString(16)}`).slice(-8) + (`00000000${(h2[1] >>> 0).toString(16)}`).slice(-8);
 };
 
+// BATCH FUNCTIONS
+// ---------------
+
+function _batch(variant, hash, keys, seed, offsets) {
+    //
+    // Hashes all the keys, an array of strings (hashed as UTF-8) and byte
+    // arrays or a single byte array of packed keys split by count + 1
+    // offsets, into an Uint32Array of 1 word per key for the 32 bit hash
+    // and 4 words per key for the 128 bit hashes, in the order of the hex.
+    //
+    if (addon) {
+        return addon.murmur3Batch(variant, keys, offsets, seed);
+    }
+    const packed = !is.array(keys);
+    const count = packed ? offsets.length - 1 : keys.length;
+    const words = variant === X86_32 ? 1 : 4;
+    const result = new Uint32Array(count * words);
+    for (let i = 0; i < count; i++) {
+        let key = packed ? keys.subarray(offsets[i], offsets[i + 1]) : keys[i];
+        if (is.string(key)) {
+            key = Buffer.from(key);
+        }
+        const h = key instanceof Uint8Array ? hash(key, seed) : undefined;
+        if (is.undefined(h)) {
+            throw new TypeError("Keys must be strings, Buffers or Uint8Arrays");
+        }
+        if (words === 1) {
+            result[i] = h;
+        } else {
+            for (let j = 0; j < 4; j++) {
+                result[i * 4 + j] = parseInt(h.slice(j * 8, j * 8 + 8), 16);
+            }
+        }
+    }
+    return result;
+}
+
+library.x86.hash32Batch = function (keys, seed, offsets) {
+    return _batch(X86_32, library.x86.hash32, keys, seed, offsets);
+};
+
+library.x86.hash128Batch = function (keys, seed, offsets) {
+    return _batch(X86_128, library.x86.hash128, keys, seed, offsets);
+};
+
+library.x64.hash128Batch = function (keys, seed, offsets) {
+    return _batch(X64_128, library.x64.hash128, keys, seed, offsets);
+};
 
 export default library;
@@ -0,0 +1,177 @@
+#include "crypto.h"
+#include "aes/aes.h"
+
+#include <adone_trace.h>
+
+#include <string.h> // strcmp
+
+namespace nodecrypto
+{
+
+static const char *const kModeNames[] = {"ECB", "CBC", "CFB", "OFB", "CTR", "GCM"};
+
+// AES cipher exported as the Aes class.
+//
+// new Aes(mode, key, decrypt) expands the key, start(iv, additionalData) begins a message,
+// update(input) returns the ciphered bytes and final() ends a GCM message returning its tag.
+class Aes : public Nan::ObjectWrap
+{
+public:
+  static void Init(v8::Local<v8::Object> target)
+  {
+    v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+    tpl->SetClassName(NanStr("Aes"));
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+    Nan::SetPrototypeMethod(tpl, "start", Start);
+    Nan::SetPrototypeMethod(tpl, "update", Update);
+    Nan::SetPrototypeMethod(tpl, "final", Final);
+    Nan::Set(target, NanStr("Aes"), Nan::GetFunction(tpl).ToLocalChecked());
+  }
+
+private:
+  ~Aes()
+  {
+    // the expanded key must not outlive the cipher
+    memset(&ctx, 0, sizeof(ctx));
+  }
+
+  // new Aes(mode, key, decrypt)
+  static NAN_METHOD(New)
+  {
+    if (!info.IsConstructCall())
+    {
+      return Nan::ThrowTypeError("Class constructor cannot be invoked without 'new'");
+    }
+    Nan::Utf8String name(info[0]);
+    int mode = -1;
+    for (int i = 0; i < static_cast<int>(sizeof(kModeNames) / sizeof(kModeNames[0])); i++)
+    {
+      if (*name != NULL && strcmp(*name, kModeNames[i]) == 0)
+      {
+        mode = i;
+      }
+    }
+    if (mode < 0)
+    {
+      return Nan::ThrowError("Unsupported mode");
+    }
+    const uint8_t *key;
+    size_t keyLength;
+    if (!GetBytes(info[1], &key, &keyLength))
+    {
+      return Nan::ThrowTypeError("Key must be a Buffer or an Uint8Array");
+    }
+    Aes *aes = new Aes();
+    if (!aes::Init(&aes->ctx, static_cast<aes::Mode>(mode), key, keyLength, Nan::To<bool>(info[2]).FromJust()))
+    {
+      delete aes;
+      return Nan::ThrowError("Invalid key length, expected 16, 24 or 32 bytes");
+    }
+    aes->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  }
+
+  // start(iv, additionalData), a missing IV continues a CBC chain
+  static NAN_METHOD(Start)
+  {
+    Aes *aes = Nan::ObjectWrap::Unwrap<Aes>(info.Holder());
+    const uint8_t *iv = NULL;
+    size_t ivLength = 0;
+    if (!info[0]->IsUndefined() && !info[0]->IsNull() && !GetBytes(info[0], &iv, &ivLength))
+    {
+      return Nan::ThrowTypeError("IV must be a Buffer or an Uint8Array");
+    }
+    if (!aes::Start(&aes->ctx, iv, ivLength))
+    {
+      return Nan::ThrowError("Invalid IV parameter.");
+    }
+    if (aes->ctx.mode == aes::kModeGCM)
+    {
+      const uint8_t *aad = NULL;
+      size_t aadLength = 0;
+      if (!info[1]->IsUndefined() && !GetBytes(info[1], &aad, &aadLength))
+      {
+        return Nan::ThrowTypeError("Additional data must be a Buffer or an Uint8Array");
+      }
+      aes::UpdateAad(&aes->ctx, aad, aadLength);
+    }
+    info.GetReturnValue().Set(info.Holder());
+  }
+
+  static NAN_METHOD(Update)
+  {
+    Aes *aes = Nan::ObjectWrap::Unwrap<Aes>(info.Holder());
+    const uint8_t *data;
+    size_t length;
+    if (!GetBytes(info[0], &data, &length))
+    {
+      return Nan::ThrowTypeError("Input must be a Buffer or an Uint8Array");
+    }
+    if (!aes->ctx.started)
+    {
+      return Nan::ThrowError("Cipher is not started");
+    }
+    if ((aes->ctx.mode == aes::kModeECB || aes->ctx.mode == aes::kModeCBC) && length % aes::kBlockBytes != 0)
+    {
+      return Nan::ThrowError("Input length must be a multiple of the block size");
+    }
+    v8::Local<v8::Object> output = Nan::NewBuffer(static_cast<uint32_t>(length)).ToLocalChecked();
+    {
+      ADONE_TRACE_SCOPE("crypto", "aes:update");
+      aes::Update(&aes->ctx, data, reinterpret_cast<uint8_t *>(node::Buffer::Data(output)), length);
+    }
+    info.GetReturnValue().Set(output);
+  }
+
+  static NAN_METHOD(Final)
+  {
+    Aes *aes = Nan::ObjectWrap::Unwrap<Aes>(info.Holder());
+    if (aes->ctx.mode != aes::kModeGCM)
+    {
+      info.GetReturnValue().Set(Nan::NewBuffer(0).ToLocalChecked());
+      return;
+    }
+    if (!aes->ctx.started)
+    {
+      return Nan::ThrowError("Cipher is not started");
+    }
+    uint8_t tag[aes::kBlockBytes];
+    aes::Final(&aes->ctx, tag);
+    info.GetReturnValue().Set(Nan::CopyBuffer(reinterpret_cast<char *>(tag), aes::kBlockBytes).ToLocalChecked());
+  }
+
+  aes::Context ctx;
+};
+
+NAN_METHOD(GetAesKernel)
+{
+  v8::Local<v8::Object> result = Nan::New<v8::Object>();
+  Nan::Set(result, NanStr("active"), NanStr(aes::KernelName(aes::GetKernel())));
+  Nan::Set(result, NanStr("best"), NanStr(aes::KernelName(aes::GetBestKernel())));
+  info.GetReturnValue().Set(result);
+}
+
+// setKernel(name), returns false if the kernel is unknown or the CPU does not support it
+NAN_METHOD(SetAesKernel)
+{
+  Nan::Utf8String name(info[0]);
+  static const aes::Kernel kernels[] = {aes::kKernelBitsliced, aes::kKernelAESNI};
+  for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+  {
+    if (*name != NULL && strcmp(*name, aes::KernelName(kernels[i])) == 0)
+    {
+      info.GetReturnValue().Set(aes::SetKernel(kernels[i]));
+      return;
+    }
+  }
+  info.GetReturnValue().Set(false);
+}
+
+NAN_MODULE_INIT(InitAes)
+{
+  Aes::Init(target);
+  Nan::SetMethod(target, "aesGetKernel", GetAesKernel);
+  Nan::SetMethod(target, "aesSetKernel", SetAesKernel);
+}
+
+} // namespace nodecrypto
@@ -0,0 +1,387 @@
+#include "aes_impl.h"
+
+#include <atomic>
+#include <string.h>
+
+namespace nodecrypto
+{
+namespace aes
+{
+
+// GCM hashes the ciphertext right after ciphering it, in chunks that stay in the L1 cache
+static const size_t kGcmChunkBytes = 4096;
+
+bool ExpandKey(Key *key, const uint8_t *bytes, size_t length)
+{
+  if (length != 16 && length != 24 && length != 32)
+  {
+    return false;
+  }
+  size_t nk = length / 4;
+  int rounds = static_cast<int>(nk) + 6;
+  size_t total = 4 * (rounds + 1);
+  uint32_t w[4 * (kMaxRounds + 1)];
+
+  for (size_t i = 0; i < nk; i++)
+  {
+    w[i] = LoadLE32(bytes + 4 * i);
+  }
+  uint32_t rcon = 1;
+  for (size_t i = nk; i < total; i++)
+  {
+    uint32_t t = w[i - 1];
+    if (i % nk == 0)
+    {
+      // RotWord() moves the byte 1 into the byte 0, that is the low byte of a little-endian word
+      t = SubWord((t >> 8) | (t << 24)) ^ rcon;
+      rcon = ((rcon << 1) ^ ((rcon >> 7) * 0x1B)) & 0xFF;
+    }
+    else if (nk > 6 && i % nk == 4)
+    {
+      t = SubWord(t);
+    }
+    w[i] = w[i - nk] ^ t;
+  }
+
+  key->rounds = rounds;
+  for (size_t i = 0; i < total; i++)
+  {
+    StoreLE32(key->enc + 4 * i, w[i]);
+  }
+  for (int round = 0; round <= rounds; round++)
+  {
+    const uint32_t *src = w + 4 * (rounds - round);
+    for (int c = 0; c < 4; c++)
+    {
+      uint32_t column = round == 0 || round == rounds ? src[c] : InvMixColumn(src[c]);
+      StoreLE32(key->dec + round * kBlockBytes + 4 * c, column);
+    }
+  }
+  memset(w, 0, sizeof(w));
+  return true;
+}
+
+Kernel GetBestKernel()
+{
+  const CpuFeatures &cpu = GetCpuFeatures();
+  return cpu.aesni && cpu.pclmul && cpu.ssse3 && cpu.sse41 ? kKernelAESNI : kKernelBitsliced;
+}
+
+static std::atomic<int> kernel(-1);
+
+Kernel GetKernel()
+{
+  int current = kernel.load(std::memory_order_relaxed);
+  if (current < 0)
+  {
+    current = GetBestKernel();
+    kernel.store(current, std::memory_order_relaxed);
+  }
+  return static_cast<Kernel>(current);
+}
+
+bool SetKernel(Kernel value)
+{
+  if (value == kKernelAESNI && GetBestKernel() != kKernelAESNI)
+  {
+    return false;
+  }
+  kernel.store(value, std::memory_order_relaxed);
+  return true;
+}
+
+const char *KernelName(Kernel value)
+{
+  return value == kKernelAESNI ? "aes-ni" : "bitsliced";
+}
+
+static const KernelFunctions &Functions()
+{
+#if defined(CRYPTO_X86)
+  if (GetKernel() == kKernelAESNI)
+  {
+    return kAesNiFunctions;
+  }
+#endif
+  return kBitslicedFunctions;
+}
+
+void EncryptBlocks(const Key *key, const uint8_t *in, uint8_t *out, size_t blocks)
+{
+  Functions().encrypt(key, in, out, blocks);
+}
+
+void DecryptBlocks(const Key *key, const uint8_t *in, uint8_t *out, size_t blocks)
+{
+  Functions().decrypt(key, in, out, blocks);
+}
+
+static inline void Inc32(uint8_t block[kBlockBytes])
+{
+  StoreBE32(block + 12, LoadBE32(block + 12) + 1);
+}
+
+static inline void StoreBE64(uint8_t *p, uint64_t w)
+{
+  StoreBE32(p, static_cast<uint32_t>(w >> 32));
+  StoreBE32(p + 4, static_cast<uint32_t>(w));
+}
+
+// Hashes the data, keeping the bytes of an incomplete block for the next call
+static void GhashBytes(Context *ctx, const KernelFunctions &fn, const uint8_t *data, size_t length)
+{
+  if (ctx->pendingLength > 0)
+  {
+    size_t fill = kBlockBytes - ctx->pendingLength;
+    if (fill > length)
+    {
+      fill = length;
+    }
+    memcpy(ctx->pending + ctx->pendingLength, data, fill);
+    ctx->pendingLength += fill;
+    data += fill;
+    length -= fill;
+    if (ctx->pendingLength < kBlockBytes)
+    {
+      return;
+    }
+    fn.ghash(ctx->h, ctx->s, ctx->pending, 1);
+    ctx->pendingLength = 0;
+  }
+  size_t blocks = length / kBlockBytes;
+  if (blocks > 0)
+  {
+    fn.ghash(ctx->h, ctx->s, data, blocks);
+    data += blocks * kBlockBytes;
+    length -= blocks * kBlockBytes;
+  }
+  memcpy(ctx->pending, data, length);
+  ctx->pendingLength = length;
+}
+
+// Pads the last incomplete block with zeros
+static void GhashFlush(Context *ctx, const KernelFunctions &fn)
+{
+  if (ctx->pendingLength > 0)
+  {
+    memset(ctx->pending + ctx->pendingLength, 0, kBlockBytes - ctx->pendingLength);
+    fn.ghash(ctx->h, ctx->s, ctx->pending, 1);
+    ctx->pendingLength = 0;
+  }
+}
+
+bool Init(Context *ctx, Mode mode, const uint8_t *key, size_t keyLength, bool decrypt)
+{
+  if (!ExpandKey(&ctx->key, key, keyLength))
+  {
+    return false;
+  }
+  ctx->mode = mode;
+  ctx->decrypt = decrypt;
+  ctx->started = false;
+  ctx->used = kBlockBytes;
+  memset(ctx->iv, 0, kBlockBytes);
+  if (mode == kModeGCM)
+  {
+    // the hash subkey is the encrypted zero block
+    memset(ctx->h, 0, kBlockBytes);
+    EncryptBlocks(&ctx->key, ctx->h, ctx->h, 1);
+  }
+  return true;
+}
+
+bool Start(Context *ctx, const uint8_t *iv, size_t ivLength)
+{
+  const KernelFunctions &fn = Functions();
+  ctx->used = kBlockBytes;
+  switch (ctx->mode)
+  {
+  case kModeECB:
+    break;
+  case kModeGCM:
+    if (iv == NULL || ivLength == 0)
+    {
+      return false;
+    }
+    if (ivLength == 12)
+    {
+      memcpy(ctx->j0, iv, 12);
+      StoreBE32(ctx->j0 + 12, 1);
+    }
+    else
+    {
+      // J0 = GHASH(IV || 0-padding || 64-bit length of the IV in bits)
+      uint8_t lengths[kBlockBytes] = {0};
+      StoreBE64(lengths + 8, static_cast<uint64_t>(ivLength) * 8);
+      memset(ctx->j0, 0, kBlockBytes);
+      memset(ctx->s, 0, kBlockBytes);
+      ctx->pendingLength = 0;
+      GhashBytes(ctx, fn, iv, ivLength);
+      GhashFlush(ctx, fn);
+      fn.ghash(ctx->h, ctx->s, lengths, 1);
+      memcpy(ctx->j0, ctx->s, kBlockBytes);
+    }
+    memcpy(ctx->iv, ctx->j0, kBlockBytes);
+    Inc32(ctx->iv);
+    memset(ctx->s, 0, kBlockBytes);
+    ctx->pendingLength = 0;
+    ctx->aadLength = 0;
+    ctx->textLength = 0;
+    break;
+  case kModeCBC:
+    // the IV residue of the previous message is reused
+    if (iv == NULL && ctx->started)
+    {
+      break;
+    }
+    // fall through
+  default:
+    if (iv == NULL || ivLength != kBlockBytes)
+    {
+      return false;
+    }
+    memcpy(ctx->iv, iv, kBlockBytes);
+    break;
+  }
+  ctx->started = true;
+  return true;
+}
+
+void UpdateAad(Context *ctx, const uint8_t *data, size_t length)
+{
+  const KernelFunctions &fn = Functions();
+  ctx->aadLength += length;
+  GhashBytes(ctx, fn, data, length);
+  GhashFlush(ctx, fn);
+}
+
+static void CtrStream(Context *ctx, const KernelFunctions &fn, const uint8_t *in, uint8_t *out, size_t length)
+{
+  for (; length > 0 && ctx->used < kBlockBytes; length--)
+  {
+    *out++ = *in++ ^ ctx->stream[ctx->used++];
+  }
+  size_t blocks = length / kBlockBytes;
+  if (blocks > 0)
+  {
+    fn.ctr32(&ctx->key, ctx->iv, in, out, blocks);
+    in += blocks * kBlockBytes;
+    out += blocks * kBlockBytes;
+    length -= blocks * kBlockBytes;
+  }
+  if (length > 0)
+  {
+    fn.encrypt(&ctx->key, ctx->iv, ctx->stream, 1);
+    Inc32(ctx->iv);
+    for (ctx->used = 0; ctx->used < length; ctx->used++)
+    {
+      out[ctx->used] = in[ctx->used] ^ ctx->stream[ctx->used];
+    }
+  }
+}
+
+// CFB and OFB, every block depends on the previous one
+static void FeedbackStream(Context *ctx, const KernelFunctions &fn, const uint8_t *in, uint8_t *out, size_t length)
+{
+  bool cfb = ctx->mode == kModeCFB;
+  while (length > 0)
+  {
+    if (ctx->used == kBlockBytes)
+    {
+      fn.encrypt(&ctx->key, ctx->iv, ctx->stream, 1);
+      ctx->used = 0;
+      if (!cfb)
+      {
+        memcpy(ctx->iv, ctx->stream, kBlockBytes);
+      }
+    }
+    if (ctx->used == 0 && length >= kBlockBytes)
+    {
+      if (cfb && ctx->decrypt)
+      {
+        memcpy(ctx->iv, in, kBlockBytes);
+      }
+      Xor(out, in, ctx->stream, kBlockBytes);
+      if (cfb && !ctx->decrypt)
+      {
+        memcpy(ctx->iv, out, kBlockBytes);
+      }
+      ctx->used = kBlockBytes;
+      in += kBlockBytes;
+      out += kBlockBytes;
+      length -= kBlockBytes;
+      continue;
+    }
+    for (; length > 0 && ctx->used < kBlockBytes; length--)
+    {
+      uint8_t x = *in++;
+      uint8_t y = x ^ ctx->stream[ctx->used];
+      if (cfb)
+      {
+        ctx->iv[ctx->used] = ctx->decrypt ? x : y;
+      }
+      *out++ = y;
+      ctx->used++;
+    }
+  }
+}
+
+void Update(Context *ctx, const uint8_t *in, uint8_t *out, size_t length)
+{
+  const KernelFunctions &fn = Functions();
+  switch (ctx->mode)
+  {
+  case kModeECB:
+    (ctx->decrypt ? fn.decrypt : fn.encrypt)(&ctx->key, in, out, length / kBlockBytes);
+    break;
+  case kModeCBC:
+    (ctx->decrypt ? fn.cbcDecrypt : fn.cbcEncrypt)(&ctx->key, ctx->iv, in, out, length / kBlockBytes);
+    break;
+  case kModeCTR:
+    CtrStream(ctx, fn, in, out, length);
+    break;
+  case kModeGCM:
+    ctx->textLength += length;
+    while (length > 0)
+    {
+      size_t n = length < kGcmChunkBytes ? length : kGcmChunkBytes;
+      if (ctx->decrypt)
+      {
+        GhashBytes(ctx, fn, in, n);
+      }
+      CtrStream(ctx, fn, in, out, n);
+      if (!ctx->decrypt)
+      {
+        GhashBytes(ctx, fn, out, n);
+      }
+      in += n;
+      out += n;
+      length -= n;
+    }
+    break;
+  default:
+    FeedbackStream(ctx, fn, in, out, length);
+    break;
+  }
+}
+
+void Final(Context *ctx, uint8_t tag[kBlockBytes])
+{
+  if (ctx->mode != kModeGCM)
+  {
+    memset(tag, 0, kBlockBytes);
+    return;
+  }
+  const KernelFunctions &fn = Functions();
+  uint8_t lengths[kBlockBytes];
+  StoreBE64(lengths, ctx->aadLength * 8);
+  StoreBE64(lengths + 8, ctx->textLength * 8);
+  GhashFlush(ctx, fn);
+  fn.ghash(ctx->h, ctx->s, lengths, 1);
+  fn.encrypt(&ctx->key, ctx->j0, tag, 1);
+  Xor(tag, tag, ctx->s, kBlockBytes);
+  ctx->started = false;
+}
+
+} // namespace aes
+} // namespace nodecrypto
@@ -0,0 +1,99 @@
+#ifndef __CRYPTO_AES_H_
+#define __CRYPTO_AES_H_
+
+// AES (FIPS 197) in the ECB, CBC, CFB, OFB, CTR and GCM modes.
+//
+// The block cipher and GHASH use AES-NI and PCLMULQDQ when the CPU has them. The portable kernel
+// is constant-time: SubBytes runs a bitsliced S-box circuit over four blocks at once and GHASH
+// multiplies with integer multiplications, so there are no secret-dependent table lookups.
+//
+// The modes follow the JS implementation in cipher_modes.js, in particular CTR increments only the
+// last 32 bits of the counter block.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace nodecrypto
+{
+namespace aes
+{
+
+enum Kernel
+{
+  kKernelBitsliced = 0,
+  kKernelAESNI = 1
+};
+
+enum Mode
+{
+  kModeECB = 0,
+  kModeCBC = 1,
+  kModeCFB = 2,
+  kModeOFB = 3,
+  kModeCTR = 4,
+  kModeGCM = 5
+};
+
+static const size_t kBlockBytes = 16;
+static const int kMaxRounds = 14;
+
+// Round keys are kept as bytes, in the order they are added to the state. Decryption uses the
+// equivalent inverse cipher, its round keys already went through InvMixColumns.
+struct Key
+{
+  int rounds;
+  uint8_t enc[(kMaxRounds + 1) * kBlockBytes];
+  uint8_t dec[(kMaxRounds + 1) * kBlockBytes];
+};
+
+struct Context
+{
+  Mode mode;
+  bool decrypt;
+  bool started;
+  Key key;
+  // chaining value, feedback register or counter block
+  uint8_t iv[kBlockBytes];
+  // keystream of the current block of the stream modes, used bytes are counted in `used`
+  uint8_t stream[kBlockBytes];
+  size_t used;
+  // GCM state
+  uint8_t h[kBlockBytes];
+  uint8_t j0[kBlockBytes];
+  uint8_t s[kBlockBytes];
+  uint8_t pending[kBlockBytes];
+  size_t pendingLength;
+  uint64_t aadLength;
+  uint64_t textLength;
+};
+
+// Returns false if the key is not 16, 24 or 32 bytes long
+bool ExpandKey(Key *key, const uint8_t *bytes, size_t length);
+
+// Returns false if the key is invalid
+bool Init(Context *ctx, Mode mode, const uint8_t *key, size_t keyLength, bool decrypt);
+// The IV is required except in ECB mode and must be 16 bytes, GCM accepts any non-empty IV.
+// A NULL IV in CBC mode continues from the last ciphered block. Returns false if the IV is invalid.
+bool Start(Context *ctx, const uint8_t *iv, size_t ivLength);
+// GCM additional authenticated data, all of it at once right after Start()
+void UpdateAad(Context *ctx, const uint8_t *data, size_t length);
+// ECB and CBC process whole blocks only, the length must be a multiple of kBlockBytes.
+// The output may be the input.
+void Update(Context *ctx, const uint8_t *in, uint8_t *out, size_t length);
+// Computes the GCM authentication tag, the message ends and Start() must be called again
+void Final(Context *ctx, uint8_t tag[kBlockBytes]);
+
+// Single-block primitives over runs of blocks
+void EncryptBlocks(const Key *key, const uint8_t *in, uint8_t *out, size_t blocks);
+void DecryptBlocks(const Key *key, const uint8_t *in, uint8_t *out, size_t blocks);
+
+// The kernel in use, the same conventions as blake2::SetKernel()
+Kernel GetKernel();
+Kernel GetBestKernel();
+bool SetKernel(Kernel kernel);
+const char *KernelName(Kernel kernel);
+
+} // namespace aes
+} // namespace nodecrypto
+
+#endif // __CRYPTO_AES_H_
@@ -0,0 +1,510 @@
+#include "aes_impl.h"
+
+#include <string.h>
+
+namespace nodecrypto
+{
+namespace aes
+{
+
+// The bitsliced S-box evaluates 64 bytes at once, that is four blocks
+static const size_t kLanes = 4;
+static const size_t kLaneBytes = kLanes * kBlockBytes;
+
+// Transposes the 8x8 bit matrix whose rows are the bytes of x
+static inline uint64_t Transpose8x8(uint64_t x)
+{
+  uint64_t t;
+  t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+  x = x ^ t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+  x = x ^ t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+  x = x ^ t ^ (t << 28);
+  return x;
+}
+
+// Boyar-Peralta circuit of the S-box (113 gates), q[i] holds the bit i of 64 bytes
+static void Sbox(uint64_t *q)
+{
+  uint64_t x0 = q[7], x1 = q[6], x2 = q[5], x3 = q[4], x4 = q[3], x5 = q[2], x6 = q[1], x7 = q[0];
+
+  // top linear transformation
+  uint64_t y14 = x3 ^ x5;
+  uint64_t y13 = x0 ^ x6;
+  uint64_t y9 = x0 ^ x3;
+  uint64_t y8 = x0 ^ x5;
+  uint64_t t0 = x1 ^ x2;
+  uint64_t y1 = t0 ^ x7;
+  uint64_t y4 = y1 ^ x3;
+  uint64_t y12 = y13 ^ y14;
+  uint64_t y2 = y1 ^ x0;
+  uint64_t y5 = y1 ^ x6;
+  uint64_t y3 = y5 ^ y8;
+  uint64_t t1 = x4 ^ y12;
+  uint64_t y15 = t1 ^ x5;
+  uint64_t y20 = t1 ^ x1;
+  uint64_t y6 = y15 ^ x7;
+  uint64_t y10 = y15 ^ t0;
+  uint64_t y11 = y20 ^ y9;
+  uint64_t y7 = x7 ^ y11;
+  uint64_t y17 = y10 ^ y11;
+  uint64_t y19 = y10 ^ y8;
+  uint64_t y16 = t0 ^ y11;
+  uint64_t y21 = y13 ^ y16;
+  uint64_t y18 = x0 ^ y16;
+
+  // non-linear section
+  uint64_t t2 = y12 & y15;
+  uint64_t t3 = y3 & y6;
+  uint64_t t4 = t3 ^ t2;
+  uint64_t t5 = y4 & x7;
+  uint64_t t6 = t5 ^ t2;
+  uint64_t t7 = y13 & y16;
+  uint64_t t8 = y5 & y1;
+  uint64_t t9 = t8 ^ t7;
+  uint64_t t10 = y2 & y7;
+  uint64_t t11 = t10 ^ t7;
+  uint64_t t12 = y9 & y11;
+  uint64_t t13 = y14 & y17;
+  uint64_t t14 = t13 ^ t12;
+  uint64_t t15 = y8 & y10;
+  uint64_t t16 = t15 ^ t12;
+  uint64_t t17 = t4 ^ t14;
+  uint64_t t18 = t6 ^ t16;
+  uint64_t t19 = t9 ^ t14;
+  uint64_t t20 = t11 ^ t16;
+  uint64_t t21 = t17 ^ y20;
+  uint64_t t22 = t18 ^ y19;
+  uint64_t t23 = t19 ^ y21;
+  uint64_t t24 = t20 ^ y18;
+
+  uint64_t t25 = t21 ^ t22;
+  uint64_t t26 = t21 & t23;
+  uint64_t t27 = t24 ^ t26;
+  uint64_t t28 = t25 & t27;
+  uint64_t t29 = t28 ^ t22;
+  uint64_t t30 = t23 ^ t24;
+  uint64_t t31 = t22 ^ t26;
+  uint64_t t32 = t31 & t30;
+  uint64_t t33 = t32 ^ t24;
+  uint64_t t34 = t23 ^ t33;
+  uint64_t t35 = t27 ^ t33;
+  uint64_t t36 = t24 & t35;
+  uint64_t t37 = t36 ^ t34;
+  uint64_t t38 = t27 ^ t36;
+  uint64_t t39 = t29 & t38;
+  uint64_t t40 = t25 ^ t39;
+
+  uint64_t t41 = t40 ^ t37;
+  uint64_t t42 = t29 ^ t33;
+  uint64_t t43 = t29 ^ t40;
+  uint64_t t44 = t33 ^ t37;
+  uint64_t t45 = t42 ^ t41;
+  uint64_t z0 = t44 & y15;
+  uint64_t z1 = t37 & y6;
+  uint64_t z2 = t33 & x7;
+  uint64_t z3 = t43 & y16;
+  uint64_t z4 = t40 & y1;
+  uint64_t z5 = t29 & y7;
+  uint64_t z6 = t42 & y11;
+  uint64_t z7 = t45 & y17;
+  uint64_t z8 = t41 & y10;
+  uint64_t z9 = t44 & y12;
+  uint64_t z10 = t37 & y3;
+  uint64_t z11 = t33 & y4;
+  uint64_t z12 = t43 & y13;
+  uint64_t z13 = t40 & y5;
+  uint64_t z14 = t29 & y2;
+  uint64_t z15 = t42 & y9;
+  uint64_t z16 = t45 & y14;
+  uint64_t z17 = t41 & y8;
+
+  // bottom linear transformation
+  uint64_t t46 = z15 ^ z16;
+  uint64_t t47 = z10 ^ z11;
+  uint64_t t48 = z5 ^ z13;
+  uint64_t t49 = z9 ^ z10;
+  uint64_t t50 = z2 ^ z12;
+  uint64_t t51 = z2 ^ z5;
+  uint64_t t52 = z7 ^ z8;
+  uint64_t t53 = z0 ^ z3;
+  uint64_t t54 = z6 ^ z7;
+  uint64_t t55 = z16 ^ z17;
+  uint64_t t56 = z12 ^ t48;
+  uint64_t t57 = t50 ^ t53;
+  uint64_t t58 = z4 ^ t46;
+  uint64_t t59 = z3 ^ t54;
+  uint64_t t60 = t46 ^ t57;
+  uint64_t t61 = z14 ^ t57;
+  uint64_t t62 = t52 ^ t58;
+  uint64_t t63 = t49 ^ t58;
+  uint64_t t64 = z4 ^ t59;
+  uint64_t t65 = t61 ^ t62;
+  uint64_t t66 = z1 ^ t63;
+  uint64_t s0 = t59 ^ t63;
+  uint64_t s6 = t56 ^ ~t62;
+  uint64_t s7 = t48 ^ ~t60;
+  uint64_t t67 = t64 ^ t65;
+  uint64_t s3 = t53 ^ t66;
+  uint64_t s4 = t51 ^ t66;
+  uint64_t s5 = t47 ^ t65;
+  uint64_t s1 = t64 ^ ~s3;
+  uint64_t s2 = t55 ^ ~t67;
+
+  q[7] = s0;
+  q[6] = s1;
+  q[5] = s2;
+  q[4] = s3;
+  q[3] = s4;
+  q[2] = s5;
+  q[1] = s6;
+  q[0] = s7;
+}
+
+// SubBytes of 64 bytes, the bytes are transposed into bit planes and back
+static void SubBytes(uint8_t *bytes)
+{
+  uint64_t w[8], q[8];
+  memcpy(w, bytes, sizeof(w));
+  for (int k = 0; k < 8; k++)
+  {
+    w[k] = Transpose8x8(w[k]);
+  }
+  for (int b = 0; b < 8; b++)
+  {
+    q[b] = 0;
+    for (int k = 0; k < 8; k++)
+    {
+      q[b] |= ((w[k] >> (8 * b)) & 0xFF) << (8 * k);
+    }
+  }
+  Sbox(q);
+  for (int k = 0; k < 8; k++)
+  {
+    w[k] = 0;
+    for (int b = 0; b < 8; b++)
+    {
+      w[k] |= ((q[b] >> (8 * k)) & 0xFF) << (8 * b);
+    }
+    w[k] = Transpose8x8(w[k]);
+  }
+  memcpy(bytes, w, sizeof(w));
+}
+
+// Linear part of the inverse affine transformation on every byte, x <<< 1 ^ x <<< 3 ^ x <<< 6
+static inline uint64_t InvAffineLinear(uint64_t x)
+{
+  uint64_t r1 = ((x << 1) & 0xFEFEFEFEFEFEFEFEULL) | ((x >> 7) & 0x0101010101010101ULL);
+  uint64_t r3 = ((x << 3) & 0xF8F8F8F8F8F8F8F8ULL) | ((x >> 5) & 0x0707070707070707ULL);
+  uint64_t r6 = ((x << 6) & 0xC0C0C0C0C0C0C0C0ULL) | ((x >> 2) & 0x3F3F3F3F3F3F3F3FULL);
+  return r1 ^ r3 ^ r6;
+}
+
+// S^-1(x) = A^-1(S(A^-1(x))): the inverse affine transformation undoes the one of the S-box and
+// the inversion in GF(2^8) is its own inverse
+static void InvSubBytes(uint8_t *bytes)
+{
+  static const uint64_t kAffine = 0x6363636363636363ULL;
+  uint64_t w[8];
+  memcpy(w, bytes, sizeof(w));
+  for (int k = 0; k < 8; k++)
+  {
+    w[k] = InvAffineLinear(w[k] ^ kAffine);
+  }
+  memcpy(bytes, w, sizeof(w));
+  SubBytes(bytes);
+  memcpy(w, bytes, sizeof(w));
+  for (int k = 0; k < 8; k++)
+  {
+    w[k] = InvAffineLinear(w[k] ^ kAffine);
+  }
+  memcpy(bytes, w, sizeof(w));
+}
+
+// The state is column-major, the byte 4 * c + r is at the column c and the row r
+static void ShiftRows(uint8_t *s)
+{
+  uint8_t t[kBlockBytes];
+  for (int c = 0; c < 4; c++)
+  {
+    for (int r = 0; r < 4; r++)
+    {
+      t[4 * c + r] = s[4 * ((c + r) & 3) + r];
+    }
+  }
+  memcpy(s, t, kBlockBytes);
+}
+
+static void InvShiftRows(uint8_t *s)
+{
+  uint8_t t[kBlockBytes];
+  for (int c = 0; c < 4; c++)
+  {
+    for (int r = 0; r < 4; r++)
+    {
+      t[4 * ((c + r) & 3) + r] = s[4 * c + r];
+    }
+  }
+  memcpy(s, t, kBlockBytes);
+}
+
+// Columns are little-endian words, the row r is in the byte r
+static inline uint32_t XTime(uint32_t w)
+{
+  return ((w & 0x7F7F7F7FUL) << 1) ^ (((w >> 7) & 0x01010101UL) * 0x1B);
+}
+
+static inline uint32_t RotateRight(uint32_t w, unsigned bits)
+{
+  return (w >> bits) | (w << (32 - bits));
+}
+
+static inline uint32_t MixColumn(uint32_t a)
+{
+  uint32_t b = XTime(a);
+  return b ^ RotateRight(a ^ b, 8) ^ RotateRight(a, 16) ^ RotateRight(a, 24);
+}
+
+uint32_t InvMixColumn(uint32_t a)
+{
+  return MixColumn(a ^ XTime(XTime(a ^ RotateRight(a, 16))));
+}
+
+static void MixColumns(uint8_t *s, uint32_t (*mix)(uint32_t))
+{
+  for (int c = 0; c < 4; c++)
+  {
+    StoreLE32(s + 4 * c, mix(LoadLE32(s + 4 * c)));
+  }
+}
+
+uint32_t SubWord(uint32_t word)
+{
+  uint8_t bytes[kLaneBytes] = {0};
+  StoreLE32(bytes, word);
+  SubBytes(bytes);
+  return LoadLE32(bytes);
+}
+
+// Encrypts up to kLanes blocks in place
+static void EncryptLanes(const Key *key, uint8_t *state, size_t blocks)
+{
+  for (size_t b = 0; b < blocks; b++)
+  {
+    Xor(state + b * kBlockBytes, state + b * kBlockBytes, key->enc, kBlockBytes);
+  }
+  for (int round = 1; round <= key->rounds; round++)
+  {
+    SubBytes(state);
+    for (size_t b = 0; b < blocks; b++)
+    {
+      uint8_t *s = state + b * kBlockBytes;
+      ShiftRows(s);
+      if (round != key->rounds)
+      {
+        MixColumns(s, MixColumn);
+      }
+      Xor(s, s, key->enc + round * kBlockBytes, kBlockBytes);
+    }
+  }
+}
+
+static void DecryptLanes(const Key *key, uint8_t *state, size_t blocks)
+{
+  for (size_t b = 0; b < blocks; b++)
+  {
+    Xor(state + b * kBlockBytes, state + b * kBlockBytes, key->dec, kBlockBytes);
+  }
+  for (int round = 1; round <= key->rounds; round++)
+  {
+    InvSubBytes(state);
+    for (size_t b = 0; b < blocks; b++)
+    {
+      uint8_t *s = state + b * kBlockBytes;
+      InvShiftRows(s);
+      if (round != key->rounds)
+      {
+        MixColumns(s, InvMixColumn);
+      }
+      Xor(s, s, key->dec + round * kBlockBytes, kBlockBytes);
+    }
+  }
+}
+
+static void Encrypt(const Key *key, const uint8_t *in, uint8_t *out, size_t blocks)
+{
+  uint8_t state[kLaneBytes] = {0};
+  while (blocks > 0)
+  {
+    size_t n = blocks < kLanes ? blocks : kLanes;
+    memcpy(state, in, n * kBlockBytes);
+    EncryptLanes(key, state, n);
+    memcpy(out, state, n * kBlockBytes);
+    in += n * kBlockBytes;
+    out += n * kBlockBytes;
+    blocks -= n;
+  }
+}
+
+static void Decrypt(const Key *key, const uint8_t *in, uint8_t *out, size_t blocks)
+{
+  uint8_t state[kLaneBytes] = {0};
+  while (blocks > 0)
+  {
+    size_t n = blocks < kLanes ? blocks : kLanes;
+    memcpy(state, in, n * kBlockBytes);
+    DecryptLanes(key, state, n);
+    memcpy(out, state, n * kBlockBytes);
+    in += n * kBlockBytes;
+    out += n * kBlockBytes;
+    blocks -= n;
+  }
+}
+
+static void CbcEncrypt(const Key *key, uint8_t iv[kBlockBytes], const uint8_t *in, uint8_t *out, size_t blocks)
+{
+  uint8_t state[kLaneBytes] = {0};
+  for (; blocks > 0; blocks--, in += kBlockBytes, out += kBlockBytes)
+  {
+    Xor(state, iv, in, kBlockBytes);
+    EncryptLanes(key, state, 1);
+    memcpy(iv, state, kBlockBytes);
+    memcpy(out, state, kBlockBytes);
+  }
+}
+
+static void CbcDecrypt(const Key *key, uint8_t iv[kBlockBytes], const uint8_t *in, uint8_t *out, size_t blocks)
+{
+  uint8_t state[kLaneBytes] = {0};
+  uint8_t prev[kLaneBytes + kBlockBytes];
+  while (blocks > 0)
+  {
+    size_t n = blocks < kLanes ? blocks : kLanes;
+    // the output may overwrite the ciphertext that the next blocks are chained with
+    memcpy(prev, iv, kBlockBytes);
+    memcpy(prev + kBlockBytes, in, n * kBlockBytes);
+    memcpy(state, in, n * kBlockBytes);
+    DecryptLanes(key, state, n);
+    Xor(out, state, prev, n * kBlockBytes);
+    memcpy(iv, prev + n * kBlockBytes, kBlockBytes);
+    in += n * kBlockBytes;
+    out += n * kBlockBytes;
+    blocks -= n;
+  }
+}
+
+static void Ctr32(const Key *key, uint8_t counter[kBlockBytes], const uint8_t *in, uint8_t *out, size_t blocks)
+{
+  uint8_t state[kLaneBytes] = {0};
+  uint32_t ctr = LoadBE32(counter + 12);
+  while (blocks > 0)
+  {
+    size_t n = blocks < kLanes ? blocks : kLanes;
+    for (size_t b = 0; b < n; b++)
+    {
+      memcpy(state + b * kBlockBytes, counter, 12);
+      StoreBE32(state + b * kBlockBytes + 12, ctr++);
+    }
+    EncryptLanes(key, state, n);
+    Xor(out, in, state, n * kBlockBytes);
+    in += n * kBlockBytes;
+    out += n * kBlockBytes;
+    blocks -= n;
+  }
+  StoreBE32(counter + 12, ctr);
+}
+
+static inline uint64_t LoadBE64(const uint8_t *p)
+{
+  return (static_cast<uint64_t>(LoadBE32(p)) << 32) | LoadBE32(p + 4);
+}
+
+static inline void StoreBE64(uint8_t *p, uint64_t w)
+{
+  StoreBE32(p, static_cast<uint32_t>(w >> 32));
+  StoreBE32(p + 4, static_cast<uint32_t>(w));
+}
+
+// Carry-less multiplication with integer multiplications: the operands are split in four
+// interleaved parts with holes, so the carries never reach the bits that are kept
+static inline uint64_t ClMulLow(uint64_t x, uint64_t y)
+{
+  uint64_t x0 = x & 0x1111111111111111ULL;
+  uint64_t x1 = x & 0x2222222222222222ULL;
+  uint64_t x2 = x & 0x4444444444444444ULL;
+  uint64_t x3 = x & 0x8888888888888888ULL;
+  uint64_t y0 = y & 0x1111111111111111ULL;
+  uint64_t y1 = y & 0x2222222222222222ULL;
+  uint64_t y2 = y & 0x4444444444444444ULL;
+  uint64_t y3 = y & 0x8888888888888888ULL;
+  uint64_t z0 = (x0 * y0) ^ (x1 * y3) ^ (x2 * y2) ^ (x3 * y1);
+  uint64_t z1 = (x0 * y1) ^ (x1 * y0) ^ (x2 * y3) ^ (x3 * y2);
+  uint64_t z2 = (x0 * y2) ^ (x1 * y1) ^ (x2 * y0) ^ (x3 * y3);
+  uint64_t z3 = (x0 * y3) ^ (x1 * y2) ^ (x2 * y1) ^ (x3 * y0);
+  return (z0 & 0x1111111111111111ULL) | (z1 & 0x2222222222222222ULL) |
+         (z2 & 0x4444444444444444ULL) | (z3 & 0x8888888888888888ULL);
+}
+
+static inline uint64_t Reverse64(uint64_t x)
+{
+  x = ((x & 0x5555555555555555ULL) << 1) | ((x >> 1) & 0x5555555555555555ULL);
+  x = ((x & 0x3333333333333333ULL) << 2) | ((x >> 2) & 0x3333333333333333ULL);
+  x = ((x & 0x0F0F0F0F0F0F0F0FULL) << 4) | ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL);
+  x = ((x & 0x00FF00FF00FF00FFULL) << 8) | ((x >> 8) & 0x00FF00FF00FF00FFULL);
+  x = ((x & 0x0000FFFF0000FFFFULL) << 16) | ((x >> 16) & 0x0000FFFF0000FFFFULL);
+  return (x << 32) | (x >> 32);
+}
+
+// GHASH works on bit-reflected values: the high halves of the products are the low halves of the
+// products of the reversed operands, Karatsuba saves one multiplication of three
+static void Ghash(const uint8_t h[kBlockBytes], uint8_t s[kBlockBytes], const uint8_t *blocks, size_t count)
+{
+  uint64_t h1 = LoadBE64(h), h0 = LoadBE64(h + 8);
+  uint64_t h0r = Reverse64(h0), h1r = Reverse64(h1);
+  uint64_t h2 = h0 ^ h1, h2r = h0r ^ h1r;
+  uint64_t y1 = LoadBE64(s), y0 = LoadBE64(s + 8);
+
+  for (; count > 0; count--, blocks += kBlockBytes)
+  {
+    y1 ^= LoadBE64(blocks);
+    y0 ^= LoadBE64(blocks + 8);
+    uint64_t y0r = Reverse64(y0), y1r = Reverse64(y1);
+    uint64_t y2 = y0 ^ y1, y2r = y0r ^ y1r;
+
+    uint64_t z0 = ClMulLow(y0, h0);
+    uint64_t z1 = ClMulLow(y1, h1);
+    uint64_t z2 = ClMulLow(y2, h2);
+    uint64_t z0h = ClMulLow(y0r, h0r);
+    uint64_t z1h = ClMulLow(y1r, h1r);
+    uint64_t z2h = ClMulLow(y2r, h2r);
+    z2 ^= z0 ^ z1;
+    z2h ^= z0h ^ z1h;
+    z0h = Reverse64(z0h) >> 1;
+    z1h = Reverse64(z1h) >> 1;
+    z2h = Reverse64(z2h) >> 1;
+
+    uint64_t v0 = z0, v1 = z0h ^ z2, v2 = z1 ^ z2h, v3 = z1h;
+    // the product of reflected values is one bit short
+    v3 = (v3 << 1) | (v2 >> 63);
+    v2 = (v2 << 1) | (v1 >> 63);
+    v1 = (v1 << 1) | (v0 >> 63);
+    v0 = (v0 << 1);
+
+    // reduction modulo x^128 + x^7 + x^2 + x + 1
+    v2 ^= v0 ^ (v0 >> 1) ^ (v0 >> 2) ^ (v0 >> 7);
+    v1 ^= (v0 << 63) ^ (v0 << 62) ^ (v0 << 57);
+    v3 ^= v1 ^ (v1 >> 1) ^ (v1 >> 2) ^ (v1 >> 7);
+    v2 ^= (v1 << 63) ^ (v1 << 62) ^ (v1 << 57);
+    y0 = v2;
+    y1 = v3;
+  }
+
+  StoreBE64(s, y1);
+  StoreBE64(s + 8, y0);
+}
+
+const KernelFunctions kBitslicedFunctions = {Encrypt, Decrypt, CbcEncrypt, CbcDecrypt, Ctr32, Ghash};
+
+} // namespace aes
+} // namespace nodecrypto
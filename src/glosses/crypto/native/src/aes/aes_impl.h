@@ -0,0 +1,76 @@
+#ifndef __CRYPTO_AES_IMPL_H_
+#define __CRYPTO_AES_IMPL_H_
+
+// Kernel entry points used by aes.cc. Both kernels implement the same functions over runs of whole
+// blocks, the stream modes handle partial blocks on top of them.
+
+#include "aes.h"
+#include "cpu.h"
+
+namespace nodecrypto
+{
+namespace aes
+{
+
+struct KernelFunctions
+{
+  void (*encrypt)(const Key *key, const uint8_t *in, uint8_t *out, size_t blocks);
+  void (*decrypt)(const Key *key, const uint8_t *in, uint8_t *out, size_t blocks);
+  void (*cbcEncrypt)(const Key *key, uint8_t iv[kBlockBytes], const uint8_t *in, uint8_t *out, size_t blocks);
+  void (*cbcDecrypt)(const Key *key, uint8_t iv[kBlockBytes], const uint8_t *in, uint8_t *out, size_t blocks);
+  // XORs the keystream of the counter blocks starting at `counter`, which is advanced past them
+  void (*ctr32)(const Key *key, uint8_t counter[kBlockBytes], const uint8_t *in, uint8_t *out, size_t blocks);
+  // s = (s ^ block) * h for every block
+  void (*ghash)(const uint8_t h[kBlockBytes], uint8_t s[kBlockBytes], const uint8_t *blocks, size_t count);
+};
+
+extern const KernelFunctions kBitslicedFunctions;
+#if defined(CRYPTO_X86)
+extern const KernelFunctions kAesNiFunctions;
+#endif
+
+// S-box applied to four bytes, used by the key expansion
+uint32_t SubWord(uint32_t word);
+// InvMixColumns of one column, turns encryption round keys into the equivalent inverse cipher ones
+uint32_t InvMixColumn(uint32_t column);
+
+inline uint32_t LoadLE32(const uint8_t *p)
+{
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline void StoreLE32(uint8_t *p, uint32_t w)
+{
+  p[0] = static_cast<uint8_t>(w);
+  p[1] = static_cast<uint8_t>(w >> 8);
+  p[2] = static_cast<uint8_t>(w >> 16);
+  p[3] = static_cast<uint8_t>(w >> 24);
+}
+
+inline uint32_t LoadBE32(const uint8_t *p)
+{
+  return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+inline void StoreBE32(uint8_t *p, uint32_t w)
+{
+  p[0] = static_cast<uint8_t>(w >> 24);
+  p[1] = static_cast<uint8_t>(w >> 16);
+  p[2] = static_cast<uint8_t>(w >> 8);
+  p[3] = static_cast<uint8_t>(w);
+}
+
+inline void Xor(uint8_t *out, const uint8_t *a, const uint8_t *b, size_t length)
+{
+  for (size_t i = 0; i < length; i++)
+  {
+    out[i] = a[i] ^ b[i];
+  }
+}
+
+} // namespace aes
+} // namespace nodecrypto
+
+#endif // __CRYPTO_AES_IMPL_H_
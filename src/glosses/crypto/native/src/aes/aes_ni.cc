@@ -0,0 +1,289 @@
+#include "aes_impl.h"
+
+#if defined(CRYPTO_X86)
+
+#include <string.h>
+
+namespace nodecrypto
+{
+namespace aes
+{
+
+#define AESNI_TARGET CRYPTO_TARGET("aes,pclmul,ssse3,sse4.1")
+
+// Independent blocks are interleaved so that the latency of AESENC is hidden
+static const size_t kParallel = 8;
+
+static inline uint32_t ByteSwap32(uint32_t w)
+{
+  return (w >> 24) | ((w >> 8) & 0xFF00) | ((w << 8) & 0xFF0000) | (w << 24);
+}
+
+AESNI_TARGET static inline void LoadKeys(const uint8_t *bytes, int rounds, __m128i *keys)
+{
+  for (int i = 0; i <= rounds; i++)
+  {
+    keys[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + i * kBlockBytes));
+  }
+}
+
+AESNI_TARGET static inline __m128i EncryptBlock(const __m128i *keys, int rounds, __m128i block)
+{
+  block = _mm_xor_si128(block, keys[0]);
+  for (int i = 1; i < rounds; i++)
+  {
+    block = _mm_aesenc_si128(block, keys[i]);
+  }
+  return _mm_aesenclast_si128(block, keys[rounds]);
+}
+
+AESNI_TARGET static inline __m128i DecryptBlock(const __m128i *keys, int rounds, __m128i block)
+{
+  block = _mm_xor_si128(block, keys[0]);
+  for (int i = 1; i < rounds; i++)
+  {
+    block = _mm_aesdec_si128(block, keys[i]);
+  }
+  return _mm_aesdeclast_si128(block, keys[rounds]);
+}
+
+AESNI_TARGET static inline void EncryptParallel(const __m128i *keys, int rounds, __m128i *blocks)
+{
+  for (size_t j = 0; j < kParallel; j++)
+  {
+    blocks[j] = _mm_xor_si128(blocks[j], keys[0]);
+  }
+  for (int i = 1; i < rounds; i++)
+  {
+    for (size_t j = 0; j < kParallel; j++)
+    {
+      blocks[j] = _mm_aesenc_si128(blocks[j], keys[i]);
+    }
+  }
+  for (size_t j = 0; j < kParallel; j++)
+  {
+    blocks[j] = _mm_aesenclast_si128(blocks[j], keys[rounds]);
+  }
+}
+
+AESNI_TARGET static inline void DecryptParallel(const __m128i *keys, int rounds, __m128i *blocks)
+{
+  for (size_t j = 0; j < kParallel; j++)
+  {
+    blocks[j] = _mm_xor_si128(blocks[j], keys[0]);
+  }
+  for (int i = 1; i < rounds; i++)
+  {
+    for (size_t j = 0; j < kParallel; j++)
+    {
+      blocks[j] = _mm_aesdec_si128(blocks[j], keys[i]);
+    }
+  }
+  for (size_t j = 0; j < kParallel; j++)
+  {
+    blocks[j] = _mm_aesdeclast_si128(blocks[j], keys[rounds]);
+  }
+}
+
+AESNI_TARGET static inline __m128i Load(const uint8_t *p)
+{
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+}
+
+AESNI_TARGET static inline void Store(uint8_t *p, __m128i v)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(p), v);
+}
+
+AESNI_TARGET static void Encrypt(const Key *key, const uint8_t *in, uint8_t *out, size_t blocks)
+{
+  __m128i keys[kMaxRounds + 1];
+  __m128i b[kParallel];
+  LoadKeys(key->enc, key->rounds, keys);
+  for (; blocks >= kParallel; blocks -= kParallel, in += kParallel * kBlockBytes, out += kParallel * kBlockBytes)
+  {
+    for (size_t j = 0; j < kParallel; j++)
+    {
+      b[j] = Load(in + j * kBlockBytes);
+    }
+    EncryptParallel(keys, key->rounds, b);
+    for (size_t j = 0; j < kParallel; j++)
+    {
+      Store(out + j * kBlockBytes, b[j]);
+    }
+  }
+  for (; blocks > 0; blocks--, in += kBlockBytes, out += kBlockBytes)
+  {
+    Store(out, EncryptBlock(keys, key->rounds, Load(in)));
+  }
+}
+
+AESNI_TARGET static void Decrypt(const Key *key, const uint8_t *in, uint8_t *out, size_t blocks)
+{
+  __m128i keys[kMaxRounds + 1];
+  __m128i b[kParallel];
+  LoadKeys(key->dec, key->rounds, keys);
+  for (; blocks >= kParallel; blocks -= kParallel, in += kParallel * kBlockBytes, out += kParallel * kBlockBytes)
+  {
+    for (size_t j = 0; j < kParallel; j++)
+    {
+      b[j] = Load(in + j * kBlockBytes);
+    }
+    DecryptParallel(keys, key->rounds, b);
+    for (size_t j = 0; j < kParallel; j++)
+    {
+      Store(out + j * kBlockBytes, b[j]);
+    }
+  }
+  for (; blocks > 0; blocks--, in += kBlockBytes, out += kBlockBytes)
+  {
+    Store(out, DecryptBlock(keys, key->rounds, Load(in)));
+  }
+}
+
+AESNI_TARGET static void CbcEncrypt(const Key *key, uint8_t iv[kBlockBytes], const uint8_t *in, uint8_t *out, size_t blocks)
+{
+  __m128i keys[kMaxRounds + 1];
+  LoadKeys(key->enc, key->rounds, keys);
+  __m128i prev = Load(iv);
+  for (; blocks > 0; blocks--, in += kBlockBytes, out += kBlockBytes)
+  {
+    prev = EncryptBlock(keys, key->rounds, _mm_xor_si128(prev, Load(in)));
+    Store(out, prev);
+  }
+  Store(iv, prev);
+}
+
+AESNI_TARGET static void CbcDecrypt(const Key *key, uint8_t iv[kBlockBytes], const uint8_t *in, uint8_t *out, size_t blocks)
+{
+  __m128i keys[kMaxRounds + 1];
+  __m128i b[kParallel], c[kParallel];
+  LoadKeys(key->dec, key->rounds, keys);
+  __m128i prev = Load(iv);
+  for (; blocks >= kParallel; blocks -= kParallel, in += kParallel * kBlockBytes, out += kParallel * kBlockBytes)
+  {
+    for (size_t j = 0; j < kParallel; j++)
+    {
+      b[j] = c[j] = Load(in + j * kBlockBytes);
+    }
+    DecryptParallel(keys, key->rounds, b);
+    Store(out, _mm_xor_si128(b[0], prev));
+    for (size_t j = 1; j < kParallel; j++)
+    {
+      Store(out + j * kBlockBytes, _mm_xor_si128(b[j], c[j - 1]));
+    }
+    prev = c[kParallel - 1];
+  }
+  for (; blocks > 0; blocks--, in += kBlockBytes, out += kBlockBytes)
+  {
+    __m128i block = Load(in);
+    Store(out, _mm_xor_si128(DecryptBlock(keys, key->rounds, block), prev));
+    prev = block;
+  }
+  Store(iv, prev);
+}
+
+AESNI_TARGET static void Ctr32(const Key *key, uint8_t counter[kBlockBytes], const uint8_t *in, uint8_t *out, size_t blocks)
+{
+  __m128i keys[kMaxRounds + 1];
+  __m128i b[kParallel];
+  LoadKeys(key->enc, key->rounds, keys);
+  __m128i base = Load(counter);
+  uint32_t ctr = LoadBE32(counter + 12);
+  for (; blocks >= kParallel; blocks -= kParallel, in += kParallel * kBlockBytes, out += kParallel * kBlockBytes)
+  {
+    for (size_t j = 0; j < kParallel; j++)
+    {
+      b[j] = _mm_insert_epi32(base, static_cast<int>(ByteSwap32(ctr++)), 3);
+    }
+    EncryptParallel(keys, key->rounds, b);
+    for (size_t j = 0; j < kParallel; j++)
+    {
+      Store(out + j * kBlockBytes, _mm_xor_si128(b[j], Load(in + j * kBlockBytes)));
+    }
+  }
+  for (; blocks > 0; blocks--, in += kBlockBytes, out += kBlockBytes)
+  {
+    __m128i block = _mm_insert_epi32(base, static_cast<int>(ByteSwap32(ctr++)), 3);
+    Store(out, _mm_xor_si128(EncryptBlock(keys, key->rounds, block), Load(in)));
+  }
+  StoreBE32(counter + 12, ctr);
+}
+
+// Accumulates the 256-bit carry-less product of two byte-reversed values
+AESNI_TARGET static inline void ClMul(__m128i a, __m128i b, __m128i *lo, __m128i *hi)
+{
+  __m128i t0 = _mm_clmulepi64_si128(a, b, 0x00);
+  __m128i t1 = _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10), _mm_clmulepi64_si128(a, b, 0x01));
+  __m128i t3 = _mm_clmulepi64_si128(a, b, 0x11);
+  *lo = _mm_xor_si128(*lo, _mm_xor_si128(t0, _mm_slli_si128(t1, 8)));
+  *hi = _mm_xor_si128(*hi, _mm_xor_si128(t3, _mm_srli_si128(t1, 8)));
+}
+
+// Shifts the product of bit-reflected values left by one bit and reduces it modulo
+// x^128 + x^7 + x^2 + x + 1, the reduction is linear so several products can share it
+AESNI_TARGET static inline __m128i Reduce(__m128i lo, __m128i hi)
+{
+  __m128i t7 = _mm_srli_epi32(lo, 31);
+  __m128i t8 = _mm_srli_epi32(hi, 31);
+  lo = _mm_slli_epi32(lo, 1);
+  hi = _mm_slli_epi32(hi, 1);
+  __m128i t9 = _mm_srli_si128(t7, 12);
+  t8 = _mm_slli_si128(t8, 4);
+  t7 = _mm_slli_si128(t7, 4);
+  lo = _mm_or_si128(lo, t7);
+  hi = _mm_or_si128(_mm_or_si128(hi, t8), t9);
+
+  t7 = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+  t8 = _mm_srli_si128(t7, 4);
+  t7 = _mm_slli_si128(t7, 12);
+  lo = _mm_xor_si128(lo, t7);
+  __m128i t2 = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+  t2 = _mm_xor_si128(t2, t8);
+  lo = _mm_xor_si128(lo, t2);
+  return _mm_xor_si128(hi, lo);
+}
+
+AESNI_TARGET static inline __m128i Multiply(__m128i a, __m128i b)
+{
+  __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+  ClMul(a, b, &lo, &hi);
+  return Reduce(lo, hi);
+}
+
+// Four blocks are multiplied by H^4..H and reduced once
+AESNI_TARGET static void Ghash(const uint8_t h[kBlockBytes], uint8_t s[kBlockBytes], const uint8_t *blocks, size_t count)
+{
+  const __m128i swap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  __m128i h1 = _mm_shuffle_epi8(Load(h), swap);
+  __m128i y = _mm_shuffle_epi8(Load(s), swap);
+
+  if (count >= 4)
+  {
+    __m128i h2 = Multiply(h1, h1);
+    __m128i h3 = Multiply(h2, h1);
+    __m128i h4 = Multiply(h3, h1);
+    for (; count >= 4; count -= 4, blocks += 4 * kBlockBytes)
+    {
+      __m128i lo = _mm_setzero_si128(), hi = _mm_setzero_si128();
+      ClMul(_mm_xor_si128(y, _mm_shuffle_epi8(Load(blocks), swap)), h4, &lo, &hi);
+      ClMul(_mm_shuffle_epi8(Load(blocks + kBlockBytes), swap), h3, &lo, &hi);
+      ClMul(_mm_shuffle_epi8(Load(blocks + 2 * kBlockBytes), swap), h2, &lo, &hi);
+      ClMul(_mm_shuffle_epi8(Load(blocks + 3 * kBlockBytes), swap), h1, &lo, &hi);
+      y = Reduce(lo, hi);
+    }
+  }
+  for (; count > 0; count--, blocks += kBlockBytes)
+  {
+    y = Multiply(_mm_xor_si128(y, _mm_shuffle_epi8(Load(blocks), swap)), h1);
+  }
+
+  Store(s, _mm_shuffle_epi8(y, swap));
+}
+
+const KernelFunctions kAesNiFunctions = {Encrypt, Decrypt, CbcEncrypt, CbcDecrypt, Ctr32, Ghash};
+
+} // namespace aes
+} // namespace nodecrypto
+
+#endif // CRYPTO_X86
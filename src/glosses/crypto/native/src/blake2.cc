@@ -0,0 +1,345 @@
+#include "crypto.h"
+#include "blake2/blake2.h"
+
+#include <adone_pool.h>
+#include <adone_trace.h>
+
+#include <string.h> // strcmp
+#include <string>
+#include <vector>
+
+namespace nodecrypto
+{
+
+struct Blake2b
+{
+  typedef blake2::Blake2bState State;
+  static const size_t kOutBytes = blake2::kBlake2bOutBytes;
+  static const size_t kKeyBytes = blake2::kBlake2bKeyBytes;
+
+  static const char *Name() { return "blake2b"; }
+  static const char *ClassName() { return "Blake2b"; }
+  static const char *OutlenError() { return "Illegal output length, expected 0 < length <= 64"; }
+  static const char *KeyError() { return "Illegal key, expected Uint8Array with 0 < length <= 64"; }
+
+  static bool Init(State *state, size_t outlen, const uint8_t *key, size_t keylen) { return blake2::Blake2bInit(state, outlen, key, keylen); }
+  static void Update(State *state, const uint8_t *data, size_t length) { blake2::Blake2bUpdate(state, data, length); }
+  static void Final(State *state, uint8_t *out) { blake2::Blake2bFinal(state, out); }
+};
+
+struct Blake2s
+{
+  typedef blake2::Blake2sState State;
+  static const size_t kOutBytes = blake2::kBlake2sOutBytes;
+  static const size_t kKeyBytes = blake2::kBlake2sKeyBytes;
+
+  static const char *Name() { return "blake2s"; }
+  static const char *ClassName() { return "Blake2s"; }
+  static const char *OutlenError() { return "Illegal output length, expected 0 < length <= 32"; }
+  static const char *KeyError() { return "Illegal key, expected Uint8Array with 0 < length <= 32"; }
+
+  static bool Init(State *state, size_t outlen, const uint8_t *key, size_t keylen) { return blake2::Blake2sInit(state, outlen, key, keylen); }
+  static void Update(State *state, const uint8_t *data, size_t length) { blake2::Blake2sUpdate(state, data, length); }
+  static void Final(State *state, uint8_t *out) { blake2::Blake2sFinal(state, out); }
+};
+
+struct Chunk
+{
+  const uint8_t *data;
+  size_t length;
+};
+
+template <typename Algorithm>
+struct Params
+{
+  size_t outlen;
+  const uint8_t *key;
+  size_t keylen;
+
+  // Parses (key, outlen), throws and returns false on invalid values
+  bool Parse(v8::Local<v8::Value> keyValue, v8::Local<v8::Value> outlenValue)
+  {
+    key = NULL;
+    keylen = 0;
+    if (!keyValue->IsUndefined() && !keyValue->IsNull() && (!GetBytes(keyValue, &key, &keylen) || keylen > Algorithm::kKeyBytes))
+    {
+      Nan::ThrowError(Algorithm::KeyError());
+      return false;
+    }
+
+    outlen = Algorithm::kOutBytes;
+    if (!outlenValue->IsUndefined())
+    {
+      double value = Nan::To<double>(outlenValue).FromMaybe(0);
+      if (!(value >= 1 && value <= Algorithm::kOutBytes))
+      {
+        Nan::ThrowError(Algorithm::OutlenError());
+        return false;
+      }
+      outlen = static_cast<size_t>(value);
+    }
+    return true;
+  }
+};
+
+template <typename Algorithm>
+static void HashChunks(const Params<Algorithm> &params, const Chunk *chunks, size_t count, uint8_t *out)
+{
+  typename Algorithm::State state;
+  for (size_t i = 0; i < count; i++)
+  {
+    Algorithm::Init(&state, params.outlen, params.key, params.keylen);
+    Algorithm::Update(&state, chunks[i].data, chunks[i].length);
+    Algorithm::Final(&state, out + i * params.outlen);
+  }
+}
+
+// Collects the byte sources of a batch, throws and returns false if some element is not one
+static bool GetChunks(v8::Local<v8::Array> inputs, std::vector<Chunk> *chunks)
+{
+  uint32_t count = inputs->Length();
+  chunks->resize(count);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    v8::Local<v8::Value> input = Nan::Get(inputs, i).ToLocalChecked();
+    if (!GetBytes(input, &(*chunks)[i].data, &(*chunks)[i].length))
+    {
+      Nan::ThrowTypeError("Batch inputs must be Buffers or Uint8Arrays");
+      return false;
+    }
+  }
+  return true;
+}
+
+static v8::Local<v8::Array> CopyArray(v8::Local<v8::Array> array)
+{
+  uint32_t length = array->Length();
+  v8::Local<v8::Array> copy = Nan::New<v8::Array>(length);
+  for (uint32_t i = 0; i < length; i++)
+  {
+    Nan::Set(copy, i, Nan::Get(array, i).ToLocalChecked());
+  }
+  return copy;
+}
+
+// Incremental hash, exported as the Blake2b/Blake2s classes
+template <typename Algorithm>
+class Hash : public Nan::ObjectWrap
+{
+public:
+  static void Init(v8::Local<v8::Object> target)
+  {
+    v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+    tpl->SetClassName(NanStr(Algorithm::ClassName()));
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+    Nan::SetPrototypeMethod(tpl, "update", Update);
+    Nan::SetPrototypeMethod(tpl, "final", Final);
+    Nan::Set(target, NanStr(Algorithm::ClassName()), Nan::GetFunction(tpl).ToLocalChecked());
+  }
+
+private:
+  Hash() : finalized(false) {}
+
+  // new Blake2b(outlen, key)
+  static NAN_METHOD(New)
+  {
+    if (!info.IsConstructCall())
+    {
+      return Nan::ThrowTypeError("Class constructor cannot be invoked without 'new'");
+    }
+    Params<Algorithm> params;
+    if (!params.Parse(info[1], info[0]))
+    {
+      return;
+    }
+    Hash *hash = new Hash();
+    Algorithm::Init(&hash->state, params.outlen, params.key, params.keylen);
+    hash->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  }
+
+  static NAN_METHOD(Update)
+  {
+    Hash *hash = Nan::ObjectWrap::Unwrap<Hash>(info.Holder());
+    const uint8_t *data;
+    size_t length;
+    if (hash->finalized)
+    {
+      return Nan::ThrowError("Hash is already finalized");
+    }
+    if (!GetBytes(info[0], &data, &length))
+    {
+      return Nan::ThrowTypeError("Input must be a Buffer or an Uint8Array");
+    }
+    Algorithm::Update(&hash->state, data, length);
+    info.GetReturnValue().Set(info.Holder());
+  }
+
+  static NAN_METHOD(Final)
+  {
+    Hash *hash = Nan::ObjectWrap::Unwrap<Hash>(info.Holder());
+    if (hash->finalized)
+    {
+      return Nan::ThrowError("Hash is already finalized");
+    }
+    hash->finalized = true;
+    uint8_t out[Algorithm::kOutBytes];
+    Algorithm::Final(&hash->state, out);
+    info.GetReturnValue().Set(Nan::CopyBuffer(reinterpret_cast<char *>(out), hash->state.outlen).ToLocalChecked());
+  }
+
+  typename Algorithm::State state;
+  bool finalized;
+};
+
+template <typename Algorithm>
+class BatchWorker : public adone::PoolWorker
+{
+public:
+  BatchWorker(v8::Local<v8::Array> inputs, v8::Local<v8::Value> key, const std::vector<Chunk> &chunks, const Params<Algorithm> &params, Nan::Callback *callback)
+      : adone::PoolWorker(callback, "crypto:blake2"), chunks(chunks), params(params),
+        dst(adone::GetBufferPool(), chunks.size() * params.outlen)
+  {
+    // the inputs and the key stay referenced until the worker is done, the elements are copied
+    // so that changes of the original array do not matter
+    v8::Local<v8::Array> refs = Nan::New<v8::Array>(2);
+    Nan::Set(refs, 0, CopyArray(inputs));
+    Nan::Set(refs, 1, key);
+    this->refs.Reset(refs);
+  }
+
+  ~BatchWorker()
+  {
+    refs.Reset();
+  }
+
+  void Execute()
+  {
+    ADONE_TRACE_SPAN("crypto", "blake2:queued", queued_at);
+    ADONE_TRACE_SCOPE("crypto", "blake2:batch");
+    if (dst.Data() == NULL)
+    {
+      SetErrorMessage("Out of memory");
+      return;
+    }
+    HashChunks(params, chunks.data(), chunks.size(), reinterpret_cast<uint8_t *>(dst.Data()));
+  }
+
+  void HandleOKCallback()
+  {
+    v8::Local<v8::Value> argv[] = {Nan::Null(), dst.ToBuffer()};
+    callback->Call(2, argv, async_resource);
+  }
+
+private:
+  std::vector<Chunk> chunks;
+  Params<Algorithm> params;
+  adone::PooledBuffer dst;
+  Nan::Persistent<v8::Array> refs;
+};
+
+// hash(input, key, outlen)
+template <typename Algorithm>
+static NAN_METHOD(HashOne)
+{
+  ADONE_TRACE_SCOPE("crypto", "blake2:hash");
+  Params<Algorithm> params;
+  Chunk chunk;
+  if (!GetBytes(info[0], &chunk.data, &chunk.length))
+  {
+    return Nan::ThrowTypeError("Input must be a Buffer or an Uint8Array");
+  }
+  if (!params.Parse(info[1], info[2]))
+  {
+    return;
+  }
+  uint8_t out[Algorithm::kOutBytes];
+  HashChunks(params, &chunk, 1, out);
+  info.GetReturnValue().Set(Nan::CopyBuffer(reinterpret_cast<char *>(out), params.outlen).ToLocalChecked());
+}
+
+// batchSync(inputs, key, outlen), returns the digests concatenated into a single buffer
+template <typename Algorithm>
+static NAN_METHOD(HashBatchSync)
+{
+  ADONE_TRACE_SCOPE("crypto", "blake2:batchSync");
+  Params<Algorithm> params;
+  std::vector<Chunk> chunks;
+  if (!info[0]->IsArray())
+  {
+    return Nan::ThrowTypeError("Batch inputs must be an array");
+  }
+  if (!GetChunks(info[0].As<v8::Array>(), &chunks) || !params.Parse(info[1], info[2]))
+  {
+    return;
+  }
+  adone::PooledBuffer dst(adone::GetBufferPool(), chunks.size() * params.outlen);
+  if (dst.Data() == NULL)
+  {
+    return Nan::ThrowError("Out of memory");
+  }
+  HashChunks(params, chunks.data(), chunks.size(), reinterpret_cast<uint8_t *>(dst.Data()));
+  info.GetReturnValue().Set(dst.ToBuffer());
+}
+
+// batch(inputs, key, outlen, callback), the same as batchSync() on the native pool
+template <typename Algorithm>
+static NAN_METHOD(HashBatch)
+{
+  Params<Algorithm> params;
+  std::vector<Chunk> chunks;
+  if (!info[0]->IsArray())
+  {
+    return Nan::ThrowTypeError("Batch inputs must be an array");
+  }
+  if (!GetChunks(info[0].As<v8::Array>(), &chunks) || !params.Parse(info[1], info[2]))
+  {
+    return;
+  }
+  Nan::Callback *callback = new Nan::Callback(info[3].As<v8::Function>());
+  adone::QueueWorker(new BatchWorker<Algorithm>(info[0].As<v8::Array>(), info[1], chunks, params, callback));
+}
+
+NAN_METHOD(GetKernel)
+{
+  v8::Local<v8::Object> result = Nan::New<v8::Object>();
+  Nan::Set(result, NanStr("active"), NanStr(blake2::KernelName(blake2::GetKernel())));
+  Nan::Set(result, NanStr("best"), NanStr(blake2::KernelName(blake2::GetBestKernel())));
+  info.GetReturnValue().Set(result);
+}
+
+// setKernel(name), returns false if the kernel is unknown or the CPU does not support it
+NAN_METHOD(SetKernel)
+{
+  Nan::Utf8String name(info[0]);
+  static const blake2::Kernel kernels[] = {blake2::kKernelScalar, blake2::kKernelSSE41, blake2::kKernelAVX2};
+  for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+  {
+    if (*name != NULL && strcmp(*name, blake2::KernelName(kernels[i])) == 0)
+    {
+      info.GetReturnValue().Set(blake2::SetKernel(kernels[i]));
+      return;
+    }
+  }
+  info.GetReturnValue().Set(false);
+}
+
+template <typename Algorithm>
+static void InitAlgorithm(v8::Local<v8::Object> target)
+{
+  std::string name = Algorithm::Name();
+  Hash<Algorithm>::Init(target);
+  Nan::SetMethod(target, name.c_str(), HashOne<Algorithm>);
+  Nan::SetMethod(target, (name + "Batch").c_str(), HashBatch<Algorithm>);
+  Nan::SetMethod(target, (name + "BatchSync").c_str(), HashBatchSync<Algorithm>);
+}
+
+NAN_MODULE_INIT(InitBlake2)
+{
+  InitAlgorithm<Blake2b>(target);
+  InitAlgorithm<Blake2s>(target);
+  Nan::SetMethod(target, "blake2GetKernel", GetKernel);
+  Nan::SetMethod(target, "blake2SetKernel", SetKernel);
+}
+
+} // namespace nodecrypto
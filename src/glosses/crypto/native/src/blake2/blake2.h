@@ -0,0 +1,63 @@
+#ifndef __CRYPTO_BLAKE2_H_
+#define __CRYPTO_BLAKE2_H_
+
+// BLAKE2b and BLAKE2s (RFC 7693).
+//
+// The compression function has a scalar implementation and SIMD kernels (AVX2 and SSE4.1 for
+// BLAKE2b, SSE4.1 for BLAKE2s), the best kernel supported by the CPU is selected on first use.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace nodecrypto
+{
+namespace blake2
+{
+
+enum Kernel
+{
+  kKernelScalar = 0,
+  kKernelSSE41 = 1,
+  kKernelAVX2 = 2
+};
+
+template <typename Word, size_t BlockSize>
+struct State
+{
+  Word h[8];
+  Word t[2];
+  Word f0;
+  uint8_t buf[BlockSize];
+  size_t buflen;
+  size_t outlen;
+};
+
+typedef State<uint64_t, 128> Blake2bState;
+typedef State<uint32_t, 64> Blake2sState;
+
+static const size_t kBlake2bOutBytes = 64;
+static const size_t kBlake2bKeyBytes = 64;
+static const size_t kBlake2sOutBytes = 32;
+static const size_t kBlake2sKeyBytes = 32;
+
+// Return false if outlen or keylen are out of range
+bool Blake2bInit(Blake2bState *state, size_t outlen, const uint8_t *key, size_t keylen);
+void Blake2bUpdate(Blake2bState *state, const uint8_t *data, size_t length);
+void Blake2bFinal(Blake2bState *state, uint8_t *out);
+
+bool Blake2sInit(Blake2sState *state, size_t outlen, const uint8_t *key, size_t keylen);
+void Blake2sUpdate(Blake2sState *state, const uint8_t *data, size_t length);
+void Blake2sFinal(Blake2sState *state, uint8_t *out);
+
+// The kernel in use, and the best one supported by the CPU
+Kernel GetKernel();
+Kernel GetBestKernel();
+// Forces a kernel, fails if the CPU does not support it. Hashes that are being computed keep
+// their kernel until the next block.
+bool SetKernel(Kernel kernel);
+const char *KernelName(Kernel kernel);
+
+} // namespace blake2
+} // namespace nodecrypto
+
+#endif // __CRYPTO_BLAKE2_H_
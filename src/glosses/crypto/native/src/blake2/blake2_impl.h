@@ -0,0 +1,118 @@
+#ifndef __CRYPTO_BLAKE2_IMPL_H_
+#define __CRYPTO_BLAKE2_IMPL_H_
+
+// Parts of BLAKE2b and BLAKE2s that only differ in the word size, shared by blake2b.cc and blake2s.cc
+
+#include "blake2.h"
+
+#include <string.h>
+
+namespace nodecrypto
+{
+namespace blake2
+{
+
+extern const uint8_t kSigma[12][16];
+
+template <typename Word>
+inline Word LoadWord(const uint8_t *src)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  Word w = 0;
+  for (size_t i = 0; i < sizeof(Word); i++)
+  {
+    w |= static_cast<Word>(src[i]) << (8 * i);
+  }
+  return w;
+#else
+  Word w;
+  memcpy(&w, src, sizeof(w));
+  return w;
+#endif
+}
+
+template <typename Word>
+inline Word RotateRight(Word w, unsigned bits)
+{
+  return (w >> bits) | (w << (sizeof(Word) * 8 - bits));
+}
+
+template <typename Word, size_t BlockSize>
+struct Blake2
+{
+  typedef State<Word, BlockSize> StateType;
+  typedef void (*CompressFn)(Word h[8], const uint8_t *block, const Word t[2], Word f0);
+
+  static bool Init(StateType *state, const Word iv[8], size_t outlen, size_t maxOutlen, const uint8_t *key, size_t keylen)
+  {
+    if (outlen == 0 || outlen > maxOutlen || keylen > maxOutlen)
+    {
+      return false;
+    }
+    memcpy(state->h, iv, sizeof(state->h));
+    state->h[0] ^= 0x01010000 ^ (static_cast<Word>(keylen) << 8) ^ static_cast<Word>(outlen);
+    state->t[0] = state->t[1] = 0;
+    state->f0 = 0;
+    state->buflen = 0;
+    state->outlen = outlen;
+    if (keylen > 0)
+    {
+      memset(state->buf, 0, BlockSize);
+      memcpy(state->buf, key, keylen);
+      state->buflen = BlockSize;
+    }
+    return true;
+  }
+
+  static void Increment(StateType *state, size_t length)
+  {
+    state->t[0] += static_cast<Word>(length);
+    state->t[1] += state->t[0] < static_cast<Word>(length);
+  }
+
+  // the last block is always kept in the buffer, it has to be compressed with the final flag
+  static void Update(StateType *state, const uint8_t *data, size_t length, CompressFn compress)
+  {
+    if (length == 0)
+    {
+      return;
+    }
+    size_t left = state->buflen;
+    size_t fill = BlockSize - left;
+    if (length > fill)
+    {
+      memcpy(state->buf + left, data, fill);
+      Increment(state, BlockSize);
+      compress(state->h, state->buf, state->t, 0);
+      state->buflen = 0;
+      data += fill;
+      length -= fill;
+      while (length > BlockSize)
+      {
+        Increment(state, BlockSize);
+        compress(state->h, data, state->t, 0);
+        data += BlockSize;
+        length -= BlockSize;
+      }
+    }
+    memcpy(state->buf + state->buflen, data, length);
+    state->buflen += length;
+  }
+
+  static void Final(StateType *state, uint8_t *out, CompressFn compress)
+  {
+    Increment(state, state->buflen);
+    state->f0 = static_cast<Word>(~static_cast<Word>(0));
+    memset(state->buf + state->buflen, 0, BlockSize - state->buflen);
+    compress(state->h, state->buf, state->t, state->f0);
+    for (size_t i = 0; i < state->outlen; i++)
+    {
+      out[i] = static_cast<uint8_t>(state->h[i / sizeof(Word)] >> (8 * (i % sizeof(Word))));
+    }
+  }
+};
+
+} // namespace blake2
+} // namespace nodecrypto
+
+#endif // __CRYPTO_BLAKE2_IMPL_H_
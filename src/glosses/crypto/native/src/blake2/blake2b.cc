@@ -0,0 +1,332 @@
+#include "blake2_impl.h"
+#include "cpu.h"
+
+#include <atomic>
+
+namespace nodecrypto
+{
+namespace blake2
+{
+
+const uint8_t kSigma[12][16] = {
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3},
+    {11, 8, 12, 0, 5, 2, 15, 13, 10, 14, 3, 6, 7, 1, 9, 4},
+    {7, 9, 3, 1, 13, 12, 11, 14, 2, 6, 5, 10, 4, 0, 15, 8},
+    {9, 0, 5, 7, 2, 4, 10, 15, 14, 1, 11, 12, 6, 8, 3, 13},
+    {2, 12, 6, 10, 0, 11, 8, 3, 4, 13, 7, 5, 15, 14, 1, 9},
+    {12, 5, 1, 15, 14, 13, 4, 10, 0, 7, 6, 3, 9, 2, 8, 11},
+    {13, 11, 7, 14, 12, 1, 3, 9, 5, 0, 15, 4, 8, 6, 2, 10},
+    {6, 15, 14, 9, 11, 3, 0, 8, 12, 2, 13, 7, 1, 4, 10, 5},
+    {10, 2, 8, 4, 7, 6, 1, 5, 15, 11, 9, 14, 3, 12, 13, 0},
+    {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+    {14, 10, 4, 8, 9, 15, 13, 6, 1, 12, 0, 2, 11, 7, 5, 3}};
+
+static const uint64_t kIV[8] = {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL};
+
+typedef Blake2<uint64_t, 128> Impl;
+
+#define G(r, i, a, b, c, d)                       \
+  do                                              \
+  {                                               \
+    a = a + b + m[kSigma[r][2 * i + 0]];          \
+    d = RotateRight<uint64_t>(d ^ a, 32);         \
+    c = c + d;                                    \
+    b = RotateRight<uint64_t>(b ^ c, 24);         \
+    a = a + b + m[kSigma[r][2 * i + 1]];          \
+    d = RotateRight<uint64_t>(d ^ a, 16);         \
+    c = c + d;                                    \
+    b = RotateRight<uint64_t>(b ^ c, 63);         \
+  } while (0)
+
+static void CompressScalar(uint64_t h[8], const uint8_t *block, const uint64_t t[2], uint64_t f0)
+{
+  uint64_t m[16], v[16];
+  for (int i = 0; i < 16; i++)
+  {
+    m[i] = LoadWord<uint64_t>(block + 8 * i);
+  }
+  for (int i = 0; i < 8; i++)
+  {
+    v[i] = h[i];
+    v[i + 8] = kIV[i];
+  }
+  v[12] ^= t[0];
+  v[13] ^= t[1];
+  v[14] ^= f0;
+
+  for (int r = 0; r < 12; r++)
+  {
+    G(r, 0, v[0], v[4], v[8], v[12]);
+    G(r, 1, v[1], v[5], v[9], v[13]);
+    G(r, 2, v[2], v[6], v[10], v[14]);
+    G(r, 3, v[3], v[7], v[11], v[15]);
+    G(r, 4, v[0], v[5], v[10], v[15]);
+    G(r, 5, v[1], v[6], v[11], v[12]);
+    G(r, 6, v[2], v[7], v[8], v[13]);
+    G(r, 7, v[3], v[4], v[9], v[14]);
+  }
+
+  for (int i = 0; i < 8; i++)
+  {
+    h[i] ^= v[i] ^ v[i + 8];
+  }
+}
+
+#undef G
+
+#if defined(CRYPTO_X86)
+
+// Rows of the state are kept in two 128-bit registers, the message words of a half-round are
+// gathered into registers as they are needed.
+
+#define ROTR32_128(x) _mm_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+#define ROTR24_128(x) _mm_shuffle_epi8((x), r24)
+#define ROTR16_128(x) _mm_shuffle_epi8((x), r16)
+#define ROTR63_128(x) _mm_xor_si128(_mm_srli_epi64((x), 63), _mm_add_epi64((x), (x)))
+
+#define HALF_ROUND_128(xl, xh, rotd, rotb)                             \
+  do                                                                   \
+  {                                                                    \
+    al = _mm_add_epi64(_mm_add_epi64(al, bl), xl);                     \
+    ah = _mm_add_epi64(_mm_add_epi64(ah, bh), xh);                     \
+    dl = rotd(_mm_xor_si128(dl, al));                                  \
+    dh = rotd(_mm_xor_si128(dh, ah));                                  \
+    cl = _mm_add_epi64(cl, dl);                                        \
+    ch = _mm_add_epi64(ch, dh);                                        \
+    bl = rotb(_mm_xor_si128(bl, cl));                                  \
+    bh = rotb(_mm_xor_si128(bh, ch));                                  \
+  } while (0)
+
+CRYPTO_TARGET("sse4.1")
+static void CompressSSE41(uint64_t h[8], const uint8_t *block, const uint64_t t[2], uint64_t f0)
+{
+  const __m128i r16 = _mm_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+  const __m128i r24 = _mm_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+  uint64_t m[16];
+  for (int i = 0; i < 16; i++)
+  {
+    m[i] = LoadWord<uint64_t>(block + 8 * i);
+  }
+
+  __m128i al = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&h[0]));
+  __m128i ah = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&h[2]));
+  __m128i bl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&h[4]));
+  __m128i bh = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&h[6]));
+  __m128i cl = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&kIV[0]));
+  __m128i ch = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&kIV[2]));
+  __m128i dl = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&kIV[4])),
+                             _mm_set_epi64x(static_cast<int64_t>(t[1]), static_cast<int64_t>(t[0])));
+  __m128i dh = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&kIV[6])),
+                             _mm_set_epi64x(0, static_cast<int64_t>(f0)));
+  const __m128i al0 = al, ah0 = ah, bl0 = bl, bh0 = bh;
+
+  for (int r = 0; r < 12; r++)
+  {
+    const uint8_t *s = kSigma[r];
+    __m128i t0, t1;
+
+    HALF_ROUND_128(_mm_set_epi64x(m[s[2]], m[s[0]]), _mm_set_epi64x(m[s[6]], m[s[4]]), ROTR32_128, ROTR24_128);
+    HALF_ROUND_128(_mm_set_epi64x(m[s[3]], m[s[1]]), _mm_set_epi64x(m[s[7]], m[s[5]]), ROTR16_128, ROTR63_128);
+
+    // diagonalize
+    t0 = _mm_alignr_epi8(bh, bl, 8);
+    t1 = _mm_alignr_epi8(bl, bh, 8);
+    bl = t0;
+    bh = t1;
+    t0 = cl;
+    cl = ch;
+    ch = t0;
+    t0 = _mm_alignr_epi8(dh, dl, 8);
+    t1 = _mm_alignr_epi8(dl, dh, 8);
+    dl = t1;
+    dh = t0;
+
+    HALF_ROUND_128(_mm_set_epi64x(m[s[10]], m[s[8]]), _mm_set_epi64x(m[s[14]], m[s[12]]), ROTR32_128, ROTR24_128);
+    HALF_ROUND_128(_mm_set_epi64x(m[s[11]], m[s[9]]), _mm_set_epi64x(m[s[15]], m[s[13]]), ROTR16_128, ROTR63_128);
+
+    // undiagonalize
+    t0 = _mm_alignr_epi8(bl, bh, 8);
+    t1 = _mm_alignr_epi8(bh, bl, 8);
+    bl = t0;
+    bh = t1;
+    t0 = cl;
+    cl = ch;
+    ch = t0;
+    t0 = _mm_alignr_epi8(dh, dl, 8);
+    t1 = _mm_alignr_epi8(dl, dh, 8);
+    dl = t0;
+    dh = t1;
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(&h[0]), _mm_xor_si128(al0, _mm_xor_si128(al, cl)));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(&h[2]), _mm_xor_si128(ah0, _mm_xor_si128(ah, ch)));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(&h[4]), _mm_xor_si128(bl0, _mm_xor_si128(bl, dl)));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(&h[6]), _mm_xor_si128(bh0, _mm_xor_si128(bh, dh)));
+}
+
+#undef HALF_ROUND_128
+#undef ROTR32_128
+#undef ROTR24_128
+#undef ROTR16_128
+#undef ROTR63_128
+
+// Each row of the state fits a single 256-bit register, the four G functions of a half-round
+// run in parallel.
+
+#define ROTR32_256(x) _mm256_shuffle_epi32((x), _MM_SHUFFLE(2, 3, 0, 1))
+#define ROTR24_256(x) _mm256_shuffle_epi8((x), r24)
+#define ROTR16_256(x) _mm256_shuffle_epi8((x), r16)
+#define ROTR63_256(x) _mm256_xor_si256(_mm256_srli_epi64((x), 63), _mm256_add_epi64((x), (x)))
+
+#define HALF_ROUND_256(x, rotd, rotb)                      \
+  do                                                       \
+  {                                                        \
+    a = _mm256_add_epi64(_mm256_add_epi64(a, b), x);       \
+    d = rotd(_mm256_xor_si256(d, a));                      \
+    c = _mm256_add_epi64(c, d);                            \
+    b = rotb(_mm256_xor_si256(b, c));                      \
+  } while (0)
+
+#define MESSAGE_256(i0, i1, i2, i3) _mm256_set_epi64x(m[s[i3]], m[s[i2]], m[s[i1]], m[s[i0]])
+
+CRYPTO_TARGET("avx2")
+static void CompressAVX2(uint64_t h[8], const uint8_t *block, const uint64_t t[2], uint64_t f0)
+{
+  const __m256i r16 = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+                                       2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+  const __m256i r24 = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+                                       3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+  uint64_t m[16];
+  for (int i = 0; i < 16; i++)
+  {
+    m[i] = LoadWord<uint64_t>(block + 8 * i);
+  }
+
+  __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&h[0]));
+  __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&h[4]));
+  __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&kIV[0]));
+  __m256i d = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(&kIV[4])),
+                               _mm256_set_epi64x(0, static_cast<int64_t>(f0), static_cast<int64_t>(t[1]), static_cast<int64_t>(t[0])));
+  const __m256i a0 = a, b0 = b;
+
+  for (int r = 0; r < 12; r++)
+  {
+    const uint8_t *s = kSigma[r];
+
+    HALF_ROUND_256(MESSAGE_256(0, 2, 4, 6), ROTR32_256, ROTR24_256);
+    HALF_ROUND_256(MESSAGE_256(1, 3, 5, 7), ROTR16_256, ROTR63_256);
+
+    // diagonalize
+    b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(0, 3, 2, 1));
+    c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));
+    d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(2, 1, 0, 3));
+
+    HALF_ROUND_256(MESSAGE_256(8, 10, 12, 14), ROTR32_256, ROTR24_256);
+    HALF_ROUND_256(MESSAGE_256(9, 11, 13, 15), ROTR16_256, ROTR63_256);
+
+    // undiagonalize
+    b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(2, 1, 0, 3));
+    c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));
+    d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(0, 3, 2, 1));
+  }
+
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(&h[0]), _mm256_xor_si256(a0, _mm256_xor_si256(a, c)));
+  _mm256_storeu_si256(reinterpret_cast<__m256i *>(&h[4]), _mm256_xor_si256(b0, _mm256_xor_si256(b, d)));
+}
+
+#undef MESSAGE_256
+#undef HALF_ROUND_256
+#undef ROTR32_256
+#undef ROTR24_256
+#undef ROTR16_256
+#undef ROTR63_256
+
+#endif // CRYPTO_X86
+
+Kernel GetBestKernel()
+{
+  const CpuFeatures &cpu = GetCpuFeatures();
+  if (cpu.avx2)
+  {
+    return kKernelAVX2;
+  }
+  if (cpu.sse41)
+  {
+    return kKernelSSE41;
+  }
+  return kKernelScalar;
+}
+
+static std::atomic<int> kernel(-1);
+
+Kernel GetKernel()
+{
+  int current = kernel.load(std::memory_order_relaxed);
+  if (current < 0)
+  {
+    current = GetBestKernel();
+    kernel.store(current, std::memory_order_relaxed);
+  }
+  return static_cast<Kernel>(current);
+}
+
+bool SetKernel(Kernel value)
+{
+  const CpuFeatures &cpu = GetCpuFeatures();
+  if ((value == kKernelAVX2 && !cpu.avx2) || (value == kKernelSSE41 && !cpu.sse41))
+  {
+    return false;
+  }
+  kernel.store(value, std::memory_order_relaxed);
+  return true;
+}
+
+const char *KernelName(Kernel value)
+{
+  switch (value)
+  {
+  case kKernelAVX2:
+    return "avx2";
+  case kKernelSSE41:
+    return "sse4.1";
+  default:
+    return "scalar";
+  }
+}
+
+static Impl::CompressFn GetCompress()
+{
+#if defined(CRYPTO_X86)
+  switch (GetKernel())
+  {
+  case kKernelAVX2:
+    return CompressAVX2;
+  case kKernelSSE41:
+    return CompressSSE41;
+  default:
+    break;
+  }
+#endif
+  return CompressScalar;
+}
+
+bool Blake2bInit(Blake2bState *state, size_t outlen, const uint8_t *key, size_t keylen)
+{
+  return Impl::Init(state, kIV, outlen, kBlake2bOutBytes, key, keylen);
+}
+
+void Blake2bUpdate(Blake2bState *state, const uint8_t *data, size_t length)
+{
+  Impl::Update(state, data, length, GetCompress());
+}
+
+void Blake2bFinal(Blake2bState *state, uint8_t *out)
+{
+  Impl::Final(state, out, GetCompress());
+}
+
+} // namespace blake2
+} // namespace nodecrypto
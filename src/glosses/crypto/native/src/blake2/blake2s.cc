@@ -0,0 +1,164 @@
+#include "blake2_impl.h"
+#include "cpu.h"
+
+namespace nodecrypto
+{
+namespace blake2
+{
+
+static const uint32_t kIV[8] = {
+    0x6A09E667UL, 0xBB67AE85UL, 0x3C6EF372UL, 0xA54FF53AUL,
+    0x510E527FUL, 0x9B05688CUL, 0x1F83D9ABUL, 0x5BE0CD19UL};
+
+typedef Blake2<uint32_t, 64> Impl;
+
+#define G(r, i, a, b, c, d)                       \
+  do                                              \
+  {                                               \
+    a = a + b + m[kSigma[r][2 * i + 0]];          \
+    d = RotateRight<uint32_t>(d ^ a, 16);         \
+    c = c + d;                                    \
+    b = RotateRight<uint32_t>(b ^ c, 12);         \
+    a = a + b + m[kSigma[r][2 * i + 1]];          \
+    d = RotateRight<uint32_t>(d ^ a, 8);          \
+    c = c + d;                                    \
+    b = RotateRight<uint32_t>(b ^ c, 7);          \
+  } while (0)
+
+static void CompressScalar(uint32_t h[8], const uint8_t *block, const uint32_t t[2], uint32_t f0)
+{
+  uint32_t m[16], v[16];
+  for (int i = 0; i < 16; i++)
+  {
+    m[i] = LoadWord<uint32_t>(block + 4 * i);
+  }
+  for (int i = 0; i < 8; i++)
+  {
+    v[i] = h[i];
+    v[i + 8] = kIV[i];
+  }
+  v[12] ^= t[0];
+  v[13] ^= t[1];
+  v[14] ^= f0;
+
+  for (int r = 0; r < 10; r++)
+  {
+    G(r, 0, v[0], v[4], v[8], v[12]);
+    G(r, 1, v[1], v[5], v[9], v[13]);
+    G(r, 2, v[2], v[6], v[10], v[14]);
+    G(r, 3, v[3], v[7], v[11], v[15]);
+    G(r, 4, v[0], v[5], v[10], v[15]);
+    G(r, 5, v[1], v[6], v[11], v[12]);
+    G(r, 6, v[2], v[7], v[8], v[13]);
+    G(r, 7, v[3], v[4], v[9], v[14]);
+  }
+
+  for (int i = 0; i < 8; i++)
+  {
+    h[i] ^= v[i] ^ v[i + 8];
+  }
+}
+
+#undef G
+
+#if defined(CRYPTO_X86)
+
+// A row of the state fits a 128-bit register. Wider registers only pay off when several
+// messages are hashed in parallel lanes, so there is no AVX2 kernel for BLAKE2s.
+
+#define ROTR16(x) _mm_shuffle_epi8((x), r16)
+#define ROTR12(x) _mm_xor_si128(_mm_srli_epi32((x), 12), _mm_slli_epi32((x), 20))
+#define ROTR8(x) _mm_shuffle_epi8((x), r8)
+#define ROTR7(x) _mm_xor_si128(_mm_srli_epi32((x), 7), _mm_slli_epi32((x), 25))
+
+#define HALF_ROUND(x, rotd, rotb)                    \
+  do                                                 \
+  {                                                  \
+    a = _mm_add_epi32(_mm_add_epi32(a, b), x);       \
+    d = rotd(_mm_xor_si128(d, a));                   \
+    c = _mm_add_epi32(c, d);                         \
+    b = rotb(_mm_xor_si128(b, c));                   \
+  } while (0)
+
+#define MESSAGE(i0, i1, i2, i3) _mm_set_epi32(m[s[i3]], m[s[i2]], m[s[i1]], m[s[i0]])
+
+CRYPTO_TARGET("sse4.1")
+static void CompressSSE41(uint32_t h[8], const uint8_t *block, const uint32_t t[2], uint32_t f0)
+{
+  const __m128i r16 = _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+  const __m128i r8 = _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+  uint32_t m[16];
+  for (int i = 0; i < 16; i++)
+  {
+    m[i] = LoadWord<uint32_t>(block + 4 * i);
+  }
+
+  __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&h[0]));
+  __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&h[4]));
+  __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(&kIV[0]));
+  __m128i d = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(&kIV[4])),
+                            _mm_set_epi32(0, static_cast<int>(f0), static_cast<int>(t[1]), static_cast<int>(t[0])));
+  const __m128i a0 = a, b0 = b;
+
+  for (int r = 0; r < 10; r++)
+  {
+    const uint8_t *s = kSigma[r];
+
+    HALF_ROUND(MESSAGE(0, 2, 4, 6), ROTR16, ROTR12);
+    HALF_ROUND(MESSAGE(1, 3, 5, 7), ROTR8, ROTR7);
+
+    // diagonalize
+    b = _mm_shuffle_epi32(b, _MM_SHUFFLE(0, 3, 2, 1));
+    c = _mm_shuffle_epi32(c, _MM_SHUFFLE(1, 0, 3, 2));
+    d = _mm_shuffle_epi32(d, _MM_SHUFFLE(2, 1, 0, 3));
+
+    HALF_ROUND(MESSAGE(8, 10, 12, 14), ROTR16, ROTR12);
+    HALF_ROUND(MESSAGE(9, 11, 13, 15), ROTR8, ROTR7);
+
+    // undiagonalize
+    b = _mm_shuffle_epi32(b, _MM_SHUFFLE(2, 1, 0, 3));
+    c = _mm_shuffle_epi32(c, _MM_SHUFFLE(1, 0, 3, 2));
+    d = _mm_shuffle_epi32(d, _MM_SHUFFLE(0, 3, 2, 1));
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(&h[0]), _mm_xor_si128(a0, _mm_xor_si128(a, c)));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(&h[4]), _mm_xor_si128(b0, _mm_xor_si128(b, d)));
+}
+
+#undef MESSAGE
+#undef HALF_ROUND
+#undef ROTR16
+#undef ROTR12
+#undef ROTR8
+#undef ROTR7
+
+#endif // CRYPTO_X86
+
+static Impl::CompressFn GetCompress()
+{
+#if defined(CRYPTO_X86)
+  if (GetKernel() >= kKernelSSE41)
+  {
+    return CompressSSE41;
+  }
+#endif
+  return CompressScalar;
+}
+
+bool Blake2sInit(Blake2sState *state, size_t outlen, const uint8_t *key, size_t keylen)
+{
+  return Impl::Init(state, kIV, outlen, kBlake2sOutBytes, key, keylen);
+}
+
+void Blake2sUpdate(Blake2sState *state, const uint8_t *data, size_t length)
+{
+  Impl::Update(state, data, length, GetCompress());
+}
+
+void Blake2sFinal(Blake2sState *state, uint8_t *out)
+{
+  Impl::Final(state, out, GetCompress());
+}
+
+} // namespace blake2
+} // namespace nodecrypto
@@ -0,0 +1,273 @@
+#include "crypto.h"
+#include "bn/bn.h"
+
+#include <adone_pool.h>
+#include <adone_trace.h>
+
+#include <string.h> // memset
+
+namespace nodecrypto
+{
+
+static bool GetNum(v8::Local<v8::Value> value, bn::Num *out, const char *error)
+{
+  const uint8_t *data;
+  size_t length;
+  if (!GetBytes(value, &data, &length))
+  {
+    Nan::ThrowTypeError(error);
+    return false;
+  }
+  *out = bn::FromBytes(data, length);
+  return true;
+}
+
+static v8::Local<v8::Object> NumToBuffer(const bn::Num &a)
+{
+  std::vector<uint8_t> bytes = bn::ToBytes(a);
+  v8::Local<v8::Object> buffer = Nan::CopyBuffer(reinterpret_cast<char *>(bytes.data()), bytes.size()).ToLocalChecked();
+  memset(bytes.data(), 0, bytes.size());
+  return buffer;
+}
+
+// Wipes the limbs of secret numbers
+static void Wipe(bn::Num *a)
+{
+  if (!a->empty())
+  {
+    memset(a->data(), 0, a->size() * sizeof(bn::Limb));
+  }
+}
+
+// bnModPow(base, exponent, modulus, secret), big-endian Buffers, the modulus must be odd. A secret
+// exponent is processed in constant time.
+NAN_METHOD(BnModPow)
+{
+  bn::Num base, exponent, modulus;
+  if (!GetNum(info[0], &base, "Base must be a Buffer or an Uint8Array") ||
+      !GetNum(info[1], &exponent, "Exponent must be a Buffer or an Uint8Array") ||
+      !GetNum(info[2], &modulus, "Modulus must be a Buffer or an Uint8Array"))
+  {
+    return;
+  }
+  bn::Montgomery mont;
+  if (!mont.Init(modulus))
+  {
+    return Nan::ThrowError("Modulus must be odd and greater than 1");
+  }
+  bool secret = Nan::To<bool>(info[3]).FromJust();
+  ADONE_TRACE_SCOPE("crypto", "bn:modPow");
+  info.GetReturnValue().Set(NumToBuffer(mont.Exp(base, exponent, secret)));
+  if (secret)
+  {
+    Wipe(&exponent);
+  }
+}
+
+// rsaPrivate(x, n, e, p, q, dP, dQ, qInv, blind) computes x^d mod n with the CRT, x being blinded by
+// blind^e. Returns null if the blinding value is not invertible modulo n.
+NAN_METHOD(RsaPrivate)
+{
+  bn::Num x, n, e, p, q, dP, dQ, qInv, blind;
+  if (!GetNum(info[0], &x, "Input must be a Buffer or an Uint8Array") ||
+      !GetNum(info[1], &n, "Key parameters must be Buffers or Uint8Arrays") ||
+      !GetNum(info[2], &e, "Key parameters must be Buffers or Uint8Arrays") ||
+      !GetNum(info[3], &p, "Key parameters must be Buffers or Uint8Arrays") ||
+      !GetNum(info[4], &q, "Key parameters must be Buffers or Uint8Arrays") ||
+      !GetNum(info[5], &dP, "Key parameters must be Buffers or Uint8Arrays") ||
+      !GetNum(info[6], &dQ, "Key parameters must be Buffers or Uint8Arrays") ||
+      !GetNum(info[7], &qInv, "Key parameters must be Buffers or Uint8Arrays") ||
+      !GetNum(info[8], &blind, "Blinding value must be a Buffer or an Uint8Array"))
+  {
+    return;
+  }
+  bn::Montgomery montN, montP, montQ;
+  if (!montN.Init(n) || !montP.Init(p) || !montQ.Init(q))
+  {
+    return Nan::ThrowError("Invalid RSA private key");
+  }
+  ADONE_TRACE_SCOPE("crypto", "bn:rsaPrivate");
+  bn::Num unblind;
+  if (!bn::ModInverse(&unblind, blind, n))
+  {
+    info.GetReturnValue().SetNull();
+    return;
+  }
+  bn::Num blinded = montN.MulMod(bn::Mod(x, n), montN.Exp(blind, e, false));
+  bn::Num xp = montP.Exp(blinded, dP, true);
+  bn::Num xq = montQ.Exp(blinded, dQ, true);
+  // Garner: y = xq + q (qInv (xp - xq) mod p)
+  bn::Num xqp = bn::Mod(xq, p);
+  bn::Num diff = bn::Compare(xp, xqp) >= 0 ? bn::Sub(xp, xqp) : bn::Sub(bn::Add(xp, p), xqp);
+  bn::Num h = montP.MulMod(diff, bn::Mod(qInv, p));
+  bn::Num y = montN.MulMod(bn::Add(xq, bn::Mul(h, q)), unblind);
+  info.GetReturnValue().Set(NumToBuffer(y));
+  bn::Num *secrets[] = {&p, &q, &dP, &dQ, &qInv, &blind, &unblind, &blinded, &xp, &xq, &xqp, &diff, &h};
+  for (size_t i = 0; i < sizeof(secrets) / sizeof(secrets[0]); i++)
+  {
+    Wipe(secrets[i]);
+  }
+}
+
+// A prime searched by several pool tasks at once, each from its own random numbers. The first one
+// to find a prime stops the others, the last one to complete calls back with it.
+class PrimeSearch
+{
+public:
+  PrimeSearch(size_t bits, int rounds, const uint8_t seed[32], size_t tasks, Nan::Callback *callback)
+      : bits(bits), rounds(rounds), remaining(tasks), stop(false), queued_at(uv_hrtime()),
+        callback(callback), async_resource(new Nan::AsyncResource("crypto:primeGenerate"))
+  {
+    memcpy(this->seed, seed, sizeof(this->seed));
+  }
+
+  ~PrimeSearch()
+  {
+    memset(seed, 0, sizeof(seed));
+    Wipe(&prime);
+    delete callback;
+    delete async_resource;
+  }
+
+  void Search(size_t index)
+  {
+    ADONE_TRACE_SPAN("crypto", "bn:queued", queued_at);
+    ADONE_TRACE_SCOPE("crypto", "bn:primeSearch");
+    bn::Drbg drbg(seed, index);
+    bn::Num found;
+    if (bn::FindPrime(&found, bits, rounds, &drbg, &stop))
+    {
+      prime.swap(found);
+    }
+  }
+
+  // Returns true when the search is done and can be deleted
+  bool Complete()
+  {
+    if (--remaining > 0)
+    {
+      return false;
+    }
+    Nan::HandleScope scope;
+    v8::Local<v8::Value> argv[] = {Nan::Null(), NumToBuffer(prime)};
+    callback->Call(2, argv, async_resource);
+    return true;
+  }
+
+private:
+  size_t bits;
+  int rounds;
+  uint8_t seed[32];
+  size_t remaining;
+  std::atomic<bool> stop;
+  // written by the task that set `stop`, read once all the tasks completed
+  bn::Num prime;
+  uint64_t queued_at;
+  Nan::Callback *callback;
+  Nan::AsyncResource *async_resource;
+};
+
+class PrimeSearchTask : public adone::PoolTask
+{
+public:
+  PrimeSearchTask(PrimeSearch *search, size_t index) : search(search), index(index) {}
+
+  void Execute()
+  {
+    search->Search(index);
+  }
+
+  void Complete()
+  {
+    if (search->Complete())
+    {
+      delete search;
+    }
+  }
+
+private:
+  PrimeSearch *search;
+  size_t index;
+};
+
+// Reads the (bits, rounds, seed) arguments of primeGenerate and primeGenerateSync
+static bool GetPrimeArgs(const Nan::FunctionCallbackInfo<v8::Value> &info, size_t *bits, int *rounds, const uint8_t **seed)
+{
+  double size = Nan::To<double>(info[0]).FromMaybe(0);
+  if (!(size >= 16 && size <= 16384) || size != static_cast<double>(static_cast<uint32_t>(size)))
+  {
+    Nan::ThrowError("Prime size must be an integer between 16 and 16384 bits");
+    return false;
+  }
+  *bits = static_cast<size_t>(size);
+  *rounds = Nan::To<int32_t>(info[1]).FromMaybe(0);
+  if (*rounds < 1)
+  {
+    Nan::ThrowError("Number of Miller-Rabin tests must be positive");
+    return false;
+  }
+  size_t seedLength;
+  if (!GetBytes(info[2], seed, &seedLength) || seedLength != 32)
+  {
+    Nan::ThrowTypeError("Seed must be a 32-byte Buffer or Uint8Array");
+    return false;
+  }
+  return true;
+}
+
+// primeGenerate(bits, rounds, seed, callback) finds a probable prime of `bits` bits on all the pool
+// threads, the 32-byte seed determines the random numbers of every thread
+NAN_METHOD(PrimeGenerate)
+{
+  size_t bits;
+  int rounds;
+  const uint8_t *seed;
+  if (!GetPrimeArgs(info, &bits, &rounds, &seed))
+  {
+    return;
+  }
+  if (!info[3]->IsFunction())
+  {
+    return Nan::ThrowTypeError("Callback must be a function");
+  }
+  size_t tasks = adone::GetExecutor()->Size();
+  if (tasks < 1)
+  {
+    tasks = 1;
+  }
+  PrimeSearch *search = new PrimeSearch(bits, rounds, seed, tasks, new Nan::Callback(info[3].As<v8::Function>()));
+  for (size_t i = 0; i < tasks; i++)
+  {
+    adone::QueueWorker(new PrimeSearchTask(search, i));
+  }
+}
+
+// primeGenerateSync(bits, rounds, seed) is primeGenerate on the calling thread, for the step-based
+// key generation that cannot wait for a callback
+NAN_METHOD(PrimeGenerateSync)
+{
+  size_t bits;
+  int rounds;
+  const uint8_t *seed;
+  if (!GetPrimeArgs(info, &bits, &rounds, &seed))
+  {
+    return;
+  }
+  ADONE_TRACE_SCOPE("crypto", "bn:primeSearch");
+  bn::Drbg drbg(seed, 0);
+  std::atomic<bool> stop(false);
+  bn::Num prime;
+  bn::FindPrime(&prime, bits, rounds, &drbg, &stop);
+  info.GetReturnValue().Set(NumToBuffer(prime));
+  Wipe(&prime);
+}
+
+NAN_MODULE_INIT(InitBn)
+{
+  Nan::SetMethod(target, "bnModPow", BnModPow);
+  Nan::SetMethod(target, "rsaPrivate", RsaPrivate);
+  Nan::SetMethod(target, "primeGenerate", PrimeGenerate);
+  Nan::SetMethod(target, "primeGenerateSync", PrimeGenerateSync);
+}
+
+} // namespace nodecrypto
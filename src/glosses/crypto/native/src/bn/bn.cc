@@ -0,0 +1,503 @@
+#include "bn.h"
+
+#include <string.h>
+
+namespace nodecrypto
+{
+namespace bn
+{
+
+static inline void Trim(Num *a)
+{
+  while (!a->empty() && a->back() == 0)
+  {
+    a->pop_back();
+  }
+}
+
+Num FromBytes(const uint8_t *data, size_t length)
+{
+  Num a((length + sizeof(Limb) - 1) / sizeof(Limb), 0);
+  for (size_t i = 0; i < length; i++)
+  {
+    size_t pos = length - 1 - i;
+    a[pos / sizeof(Limb)] |= static_cast<Limb>(data[i]) << (8 * (pos % sizeof(Limb)));
+  }
+  Trim(&a);
+  return a;
+}
+
+std::vector<uint8_t> ToBytes(const Num &a)
+{
+  size_t length = (BitLength(a) + 7) / 8;
+  if (length == 0)
+  {
+    return std::vector<uint8_t>(1, 0);
+  }
+  std::vector<uint8_t> out(length);
+  for (size_t pos = 0; pos < length; pos++)
+  {
+    out[length - 1 - pos] = static_cast<uint8_t>(a[pos / sizeof(Limb)] >> (8 * (pos % sizeof(Limb))));
+  }
+  return out;
+}
+
+size_t BitLength(const Num &a)
+{
+  if (a.empty())
+  {
+    return 0;
+  }
+  size_t bits = (a.size() - 1) * kLimbBits;
+  for (Limb top = a.back(); top != 0; top >>= 1)
+  {
+    bits++;
+  }
+  return bits;
+}
+
+static inline bool TestBit(const Num &a, size_t bit)
+{
+  size_t i = bit / kLimbBits;
+  return i < a.size() && ((a[i] >> (bit % kLimbBits)) & 1) != 0;
+}
+
+int Compare(const Num &a, const Num &b)
+{
+  if (a.size() != b.size())
+  {
+    return a.size() < b.size() ? -1 : 1;
+  }
+  for (size_t i = a.size(); i-- > 0;)
+  {
+    if (a[i] != b[i])
+    {
+      return a[i] < b[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+// a += b, a is grown as needed
+static void AddTo(Num *a, const Num &b)
+{
+  if (a->size() < b.size())
+  {
+    a->resize(b.size(), 0);
+  }
+  Limb carry = 0;
+  for (size_t i = 0; i < a->size(); i++)
+  {
+    if (i >= b.size() && carry == 0)
+    {
+      return;
+    }
+    DLimb sum = static_cast<DLimb>((*a)[i]) + (i < b.size() ? b[i] : 0) + carry;
+    (*a)[i] = static_cast<Limb>(sum);
+    carry = static_cast<Limb>(sum >> kLimbBits);
+  }
+  if (carry != 0)
+  {
+    a->push_back(carry);
+  }
+}
+
+// a -= b, a >= b
+static void SubFrom(Num *a, const Num &b)
+{
+  Limb borrow = 0;
+  for (size_t i = 0; i < a->size(); i++)
+  {
+    if (i >= b.size() && borrow == 0)
+    {
+      break;
+    }
+    DLimb diff = static_cast<DLimb>((*a)[i]) - (i < b.size() ? b[i] : 0) - borrow;
+    (*a)[i] = static_cast<Limb>(diff);
+    borrow = static_cast<Limb>(diff >> kLimbBits) & 1;
+  }
+  Trim(a);
+}
+
+static void ShiftRight1(Num *a)
+{
+  for (size_t i = 0; i < a->size(); i++)
+  {
+    Limb next = i + 1 < a->size() ? (*a)[i + 1] : 0;
+    (*a)[i] = ((*a)[i] >> 1) | (next << (kLimbBits - 1));
+  }
+  Trim(a);
+}
+
+Num Add(const Num &a, const Num &b)
+{
+  Num r = a;
+  AddTo(&r, b);
+  return r;
+}
+
+Num Sub(const Num &a, const Num &b)
+{
+  Num r = a;
+  SubFrom(&r, b);
+  return r;
+}
+
+Num Mul(const Num &a, const Num &b)
+{
+  if (a.empty() || b.empty())
+  {
+    return Num();
+  }
+  Num r(a.size() + b.size(), 0);
+  for (size_t i = 0; i < a.size(); i++)
+  {
+    DLimb carry = 0;
+    for (size_t j = 0; j < b.size(); j++)
+    {
+      carry += static_cast<DLimb>(a[i]) * b[j] + r[i + j];
+      r[i + j] = static_cast<Limb>(carry);
+      carry >>= kLimbBits;
+    }
+    r[i + b.size()] = static_cast<Limb>(carry);
+  }
+  Trim(&r);
+  return r;
+}
+
+// Shift and subtract, only used on key material and once per modulus
+Num Mod(const Num &a, const Num &m)
+{
+  if (Compare(a, m) < 0)
+  {
+    return a;
+  }
+  Num r;
+  r.reserve(m.size() + 1);
+  for (size_t bit = BitLength(a); bit-- > 0;)
+  {
+    Limb carry = TestBit(a, bit) ? 1 : 0;
+    for (size_t i = 0; i < r.size(); i++)
+    {
+      Limb top = r[i] >> (kLimbBits - 1);
+      r[i] = (r[i] << 1) | carry;
+      carry = top;
+    }
+    if (carry != 0)
+    {
+      r.push_back(carry);
+    }
+    if (Compare(r, m) >= 0)
+    {
+      SubFrom(&r, m);
+    }
+  }
+  return r;
+}
+
+// (a - b) mod m, a and b below m
+static void ModSubFrom(Num *a, const Num &b, const Num &m)
+{
+  if (Compare(*a, b) < 0)
+  {
+    AddTo(a, m);
+  }
+  SubFrom(a, b);
+}
+
+// Binary extended Euclid, m is odd
+bool ModInverse(Num *out, const Num &a, const Num &m)
+{
+  Num u = Mod(a, m);
+  Num v = m;
+  Num x1(1, 1);
+  Num x2;
+  const Num one(1, 1);
+  while (Compare(u, one) != 0 && Compare(v, one) != 0)
+  {
+    if (u.empty())
+    {
+      return false;
+    }
+    while ((u[0] & 1) == 0)
+    {
+      ShiftRight1(&u);
+      if (!x1.empty() && (x1[0] & 1) != 0)
+      {
+        AddTo(&x1, m);
+      }
+      ShiftRight1(&x1);
+    }
+    while ((v[0] & 1) == 0)
+    {
+      ShiftRight1(&v);
+      if (!x2.empty() && (x2[0] & 1) != 0)
+      {
+        AddTo(&x2, m);
+      }
+      ShiftRight1(&x2);
+    }
+    if (Compare(u, v) >= 0)
+    {
+      SubFrom(&u, v);
+      ModSubFrom(&x1, x2, m);
+    }
+    else
+    {
+      SubFrom(&v, u);
+      ModSubFrom(&x2, x1, m);
+    }
+  }
+  *out = Compare(u, one) == 0 ? x1 : x2;
+  return true;
+}
+
+bool Montgomery::Init(const Num &modulus)
+{
+  if (modulus.empty() || (modulus[0] & 1) == 0 || BitLength(modulus) < 2)
+  {
+    return false;
+  }
+  n = modulus;
+  k = n.size();
+  // -n^-1 mod 2^kLimbBits by Newton iterations, n * n = 1 mod 8 gives the first 3 bits
+  Limb inv = n[0];
+  for (int i = 0; i < 6; i++)
+  {
+    inv *= 2 - n[0] * inv;
+  }
+  n0 = 0 - inv;
+  Num r(2 * k + 1, 0);
+  r[2 * k] = 1;
+  r2 = Mod(r, n);
+  r2.resize(k, 0);
+  return true;
+}
+
+// CIOS Montgomery multiplication: out = a b R^-1 mod n. The final subtraction is done in any case
+// and selected with a mask, so the timing does not depend on the values.
+void Montgomery::MontMul(Limb *out, const Limb *a, const Limb *b, Limb *t) const
+{
+  memset(t, 0, (k + 2) * sizeof(Limb));
+  for (size_t i = 0; i < k; i++)
+  {
+    Limb bi = b[i];
+    DLimb c = 0;
+    for (size_t j = 0; j < k; j++)
+    {
+      c += static_cast<DLimb>(a[j]) * bi + t[j];
+      t[j] = static_cast<Limb>(c);
+      c >>= kLimbBits;
+    }
+    c += t[k];
+    t[k] = static_cast<Limb>(c);
+    t[k + 1] = static_cast<Limb>(c >> kLimbBits);
+
+    Limb m = t[0] * n0;
+    c = static_cast<DLimb>(m) * n[0] + t[0];
+    c >>= kLimbBits;
+    for (size_t j = 1; j < k; j++)
+    {
+      c += static_cast<DLimb>(m) * n[j] + t[j];
+      t[j - 1] = static_cast<Limb>(c);
+      c >>= kLimbBits;
+    }
+    c += t[k];
+    t[k - 1] = static_cast<Limb>(c);
+    t[k] = t[k + 1] + static_cast<Limb>(c >> kLimbBits);
+  }
+  // t < 2n
+  Limb borrow = 0;
+  for (size_t j = 0; j < k; j++)
+  {
+    DLimb diff = static_cast<DLimb>(t[j]) - n[j] - borrow;
+    out[j] = static_cast<Limb>(diff);
+    borrow = static_cast<Limb>(diff >> kLimbBits) & 1;
+  }
+  // t < n when the subtraction borrows past the top limb
+  Limb keep = 0 - static_cast<Limb>(t[k] < borrow);
+  for (size_t j = 0; j < k; j++)
+  {
+    out[j] = (out[j] & ~keep) | (t[j] & keep);
+  }
+}
+
+void Montgomery::ToMont(Limb *out, const Num &a, Limb *t) const
+{
+  Num reduced = Compare(a, n) >= 0 ? Mod(a, n) : a;
+  reduced.resize(k, 0);
+  MontMul(out, reduced.data(), r2.data(), t);
+}
+
+Num Montgomery::FromMont(const Limb *a, Limb *t) const
+{
+  Num one(k, 0);
+  one[0] = 1;
+  Num r(k);
+  MontMul(r.data(), a, one.data(), t);
+  Trim(&r);
+  return r;
+}
+
+Num Montgomery::MulMod(const Num &a, const Num &b) const
+{
+  std::vector<Limb> t(k + 2);
+  Num am(k), bm = b;
+  ToMont(am.data(), a, t.data());
+  bm.resize(k, 0);
+  Num r(k);
+  // a R * b * R^-1 = a b
+  MontMul(r.data(), am.data(), bm.data(), t.data());
+  Trim(&r);
+  return r;
+}
+
+// Window sizes of the sliding window by exponent length, as in OpenSSL
+static size_t WindowBits(size_t bits)
+{
+  return bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : 1;
+}
+
+static const size_t kSecretWindowBits = 5;
+
+void Montgomery::ExpMont(Limb *out, const Limb *base, const Num &exp, bool secret, Limb *t) const
+{
+  size_t bits = BitLength(exp);
+  Num acc(k);
+  ToMont(acc.data(), Num(1, 1), t);
+  if (secret)
+  {
+    // all the powers base^0 .. base^(2^w - 1), every window reads the whole table
+    const size_t w = kSecretWindowBits;
+    const size_t size = static_cast<size_t>(1) << w;
+    std::vector<Limb> table(size * k);
+    memcpy(table.data(), acc.data(), k * sizeof(Limb));
+    memcpy(table.data() + k, base, k * sizeof(Limb));
+    for (size_t i = 2; i < size; i++)
+    {
+      MontMul(table.data() + i * k, table.data() + (i - 1) * k, base, t);
+    }
+    Num selected(k);
+    size_t windows = (bits + w - 1) / w;
+    for (size_t window = windows; window-- > 0;)
+    {
+      if (window + 1 != windows)
+      {
+        for (size_t i = 0; i < w; i++)
+        {
+          MontMul(acc.data(), acc.data(), acc.data(), t);
+        }
+      }
+      size_t digit = 0;
+      for (size_t i = 0; i < w; i++)
+      {
+        digit |= static_cast<size_t>(TestBit(exp, window * w + i)) << i;
+      }
+      memset(selected.data(), 0, k * sizeof(Limb));
+      for (size_t i = 0; i < size; i++)
+      {
+        Limb mask = 0 - static_cast<Limb>(i == digit);
+        const Limb *entry = table.data() + i * k;
+        for (size_t j = 0; j < k; j++)
+        {
+          selected[j] |= entry[j] & mask;
+        }
+      }
+      MontMul(acc.data(), acc.data(), selected.data(), t);
+    }
+    memset(table.data(), 0, table.size() * sizeof(Limb));
+  }
+  else if (bits > 0)
+  {
+    // odd powers base^1, base^3 .. base^(2^w - 1)
+    const size_t w = WindowBits(bits);
+    const size_t size = static_cast<size_t>(1) << (w - 1);
+    std::vector<Limb> table(size * k);
+    Num square(k);
+    memcpy(table.data(), base, k * sizeof(Limb));
+    MontMul(square.data(), base, base, t);
+    for (size_t i = 1; i < size; i++)
+    {
+      MontMul(table.data() + i * k, table.data() + (i - 1) * k, square.data(), t);
+    }
+    size_t i = bits;
+    while (i > 0)
+    {
+      if (!TestBit(exp, i - 1))
+      {
+        MontMul(acc.data(), acc.data(), acc.data(), t);
+        i--;
+        continue;
+      }
+      // the longest window of at most w bits ending with a set bit
+      size_t low = i > w ? i - w : 0;
+      while (!TestBit(exp, low))
+      {
+        low++;
+      }
+      size_t value = 0;
+      for (size_t j = i; j-- > low;)
+      {
+        value = (value << 1) | static_cast<size_t>(TestBit(exp, j));
+        MontMul(acc.data(), acc.data(), acc.data(), t);
+      }
+      MontMul(acc.data(), acc.data(), table.data() + (value >> 1) * k, t);
+      i = low;
+    }
+  }
+  memcpy(out, acc.data(), k * sizeof(Limb));
+}
+
+Num Montgomery::Exp(const Num &base, const Num &exp, bool secret) const
+{
+  std::vector<Limb> t(k + 2);
+  Num b(k), r(k);
+  ToMont(b.data(), base, t.data());
+  ExpMont(r.data(), b.data(), exp, secret, t.data());
+  Num result = FromMont(r.data(), t.data());
+  if (secret)
+  {
+    memset(b.data(), 0, k * sizeof(Limb));
+    memset(r.data(), 0, k * sizeof(Limb));
+  }
+  return result;
+}
+
+bool Montgomery::MillerRabin(const Num &base) const
+{
+  // n - 1 = d 2^s
+  Num minusOne = Sub(n, Num(1, 1));
+  Num d = minusOne;
+  size_t s = 0;
+  while ((d[0] & 1) == 0)
+  {
+    ShiftRight1(&d);
+    s++;
+  }
+  std::vector<Limb> t(k + 2);
+  Num one(k), last(k), b(k), x(k);
+  ToMont(one.data(), Num(1, 1), t.data());
+  ToMont(last.data(), minusOne, t.data());
+  ToMont(b.data(), base, t.data());
+  ExpMont(x.data(), b.data(), d, false, t.data());
+  if (x == one || x == last)
+  {
+    return true;
+  }
+  for (size_t i = 1; i < s; i++)
+  {
+    MontMul(x.data(), x.data(), x.data(), t.data());
+    if (x == last)
+    {
+      return true;
+    }
+    if (x == one)
+    {
+      return false;
+    }
+  }
+  return false;
+}
+
+} // namespace bn
+} // namespace nodecrypto
@@ -0,0 +1,102 @@
+#ifndef __CRYPTO_BN_H_
+#define __CRYPTO_BN_H_
+
+// Unsigned big numbers for RSA: Montgomery multiplication, modular exponentiation and the
+// probable prime search of key generation.
+//
+// Numbers are vectors of limbs, least significant first, without high zero limbs (zero is empty).
+// Exponentiations with secret exponents use a fixed window and read the whole table of powers
+// for every window, the other ones use a sliding window.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <vector>
+
+namespace nodecrypto
+{
+namespace bn
+{
+
+#if defined(__SIZEOF_INT128__)
+typedef uint64_t Limb;
+typedef unsigned __int128 DLimb;
+#else
+typedef uint32_t Limb;
+typedef uint64_t DLimb;
+#endif
+
+static const size_t kLimbBits = sizeof(Limb) * 8;
+
+typedef std::vector<Limb> Num;
+
+// big-endian bytes
+Num FromBytes(const uint8_t *data, size_t length);
+// big-endian bytes without leading zeros, a single zero byte for zero
+std::vector<uint8_t> ToBytes(const Num &a);
+
+size_t BitLength(const Num &a);
+int Compare(const Num &a, const Num &b);
+Num Add(const Num &a, const Num &b);
+// a >= b
+Num Sub(const Num &a, const Num &b);
+Num Mul(const Num &a, const Num &b);
+Num Mod(const Num &a, const Num &m);
+// Returns false if a has no inverse modulo the odd m
+bool ModInverse(Num *out, const Num &a, const Num &m);
+
+// Arithmetic modulo an odd number
+class Montgomery
+{
+public:
+  // Returns false if the modulus is even or below 3
+  bool Init(const Num &modulus);
+
+  const Num &Modulus() const { return n; }
+  // a b mod n, a and b below n
+  Num MulMod(const Num &a, const Num &b) const;
+  // base^exp mod n, any base
+  Num Exp(const Num &base, const Num &exp, bool secret) const;
+  // Miller-Rabin test of n with the given base, 1 < base < n - 1
+  bool MillerRabin(const Num &base) const;
+
+private:
+  void MontMul(Limb *out, const Limb *a, const Limb *b, Limb *t) const;
+  // k limbs in the Montgomery domain
+  void ToMont(Limb *out, const Num &a, Limb *t) const;
+  Num FromMont(const Limb *a, Limb *t) const;
+  void ExpMont(Limb *out, const Limb *base, const Num &exp, bool secret, Limb *t) const;
+
+  Num n;
+  size_t k;
+  Limb n0;
+  // R^2 mod n, padded to k limbs
+  Num r2;
+};
+
+// Deterministic random bytes from a seed (SHA-512 in counter mode), each stream is independent
+class Drbg
+{
+public:
+  Drbg(const uint8_t seed[32], uint64_t stream);
+  void Fill(uint8_t *out, size_t length);
+
+private:
+  uint8_t seed[32];
+  uint64_t stream;
+  uint64_t counter;
+  uint8_t block[64];
+  size_t used;
+};
+
+// Searches a probable prime of exactly `bits` bits as crypto.prime PRIMEINC does: from a random
+// number aligned on 30k + 1, the candidates that are not multiples of 2, 3 and 5 are tested by trial
+// division and then `rounds` Miller-Rabin tests. Returns false if `stop` was set before a prime was
+// found, otherwise sets it.
+bool FindPrime(Num *out, size_t bits, int rounds, Drbg *drbg, std::atomic<bool> *stop);
+
+} // namespace bn
+} // namespace nodecrypto
+
+#endif // __CRYPTO_BN_H_
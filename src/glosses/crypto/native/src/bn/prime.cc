@@ -0,0 +1,176 @@
+#include "bn.h"
+#include "md/md.h"
+
+#include <mutex>
+#include <string.h>
+
+namespace nodecrypto
+{
+namespace bn
+{
+
+// Trial division by the odd primes below this bound except 3 and 5, the candidates are never
+// multiples of 2, 3 and 5
+static const uint32_t kSieveBound = 2048;
+
+static const std::vector<uint32_t> &SmallPrimes()
+{
+  static std::vector<uint32_t> primes;
+  static std::once_flag once;
+  std::call_once(once, [] {
+    std::vector<bool> composite(kSieveBound, false);
+    for (uint32_t i = 2; i < kSieveBound; i++)
+    {
+      if (composite[i])
+      {
+        continue;
+      }
+      if (i > 5)
+      {
+        primes.push_back(i);
+      }
+      for (uint32_t j = i * i; j < kSieveBound; j += i)
+      {
+        composite[j] = true;
+      }
+    }
+  });
+  return primes;
+}
+
+static uint32_t ModWord(const Num &a, uint32_t m)
+{
+  DLimb r = 0;
+  for (size_t i = a.size(); i-- > 0;)
+  {
+    r = ((r << kLimbBits) | a[i]) % m;
+  }
+  return static_cast<uint32_t>(r);
+}
+
+Drbg::Drbg(const uint8_t seedBytes[32], uint64_t streamIndex)
+    : stream(streamIndex), counter(0), used(sizeof(block))
+{
+  memcpy(seed, seedBytes, sizeof(seed));
+}
+
+void Drbg::Fill(uint8_t *out, size_t length)
+{
+  while (length > 0)
+  {
+    if (used == sizeof(block))
+    {
+      // SHA-512(seed || stream || counter)
+      uint8_t input[48];
+      memcpy(input, seed, 32);
+      for (int i = 0; i < 8; i++)
+      {
+        input[32 + i] = static_cast<uint8_t>(stream >> (8 * i));
+        input[40 + i] = static_cast<uint8_t>(counter >> (8 * i));
+      }
+      counter++;
+      md::Sha512State state;
+      md::Sha512Init(&state);
+      md::Sha512Update(&state, input, sizeof(input));
+      md::Sha512Final(&state, block);
+      used = 0;
+    }
+    size_t n = sizeof(block) - used < length ? sizeof(block) - used : length;
+    memcpy(out, block + used, n);
+    used += n;
+    out += n;
+    length -= n;
+  }
+}
+
+// A random number of exactly `bits` bits
+static Num RandomBits(Drbg *drbg, size_t bits)
+{
+  std::vector<uint8_t> bytes((bits + 7) / 8);
+  drbg->Fill(bytes.data(), bytes.size());
+  size_t extra = bytes.size() * 8 - bits;
+  bytes[0] &= static_cast<uint8_t>(0xFF >> extra);
+  bytes[0] |= static_cast<uint8_t>(0x80 >> extra);
+  return FromBytes(bytes.data(), bytes.size());
+}
+
+// The steps between the numbers coprime with 30, from 30k + 1
+static const uint32_t kGcd30Delta[8] = {6, 4, 2, 4, 2, 4, 6, 2};
+
+static bool IsProbablePrime(const Num &candidate, size_t bits, int rounds, Drbg *drbg)
+{
+  Montgomery mont;
+  if (!mont.Init(candidate))
+  {
+    return false;
+  }
+  // base 2 first, it rejects almost all the composites, then random bases
+  Num two(1, 2);
+  if (!mont.MillerRabin(two))
+  {
+    return false;
+  }
+  for (int i = 1; i < rounds; i++)
+  {
+    Num base = bits > 3 ? RandomBits(drbg, bits - 1) : two;
+    if (Compare(base, two) < 0)
+    {
+      base = two;
+    }
+    if (!mont.MillerRabin(base))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool FindPrime(Num *out, size_t bits, int rounds, Drbg *drbg, std::atomic<bool> *stop)
+{
+  const std::vector<uint32_t> &primes = SmallPrimes();
+  // small candidates may be the small primes themselves
+  bool sieve = bits > 11;
+  std::vector<uint32_t> residues(primes.size());
+  while (!stop->load(std::memory_order_relaxed))
+  {
+    Num candidate = RandomBits(drbg, bits);
+    // align on 30k + 1
+    candidate = Add(candidate, Num(1, 31 - ModWord(candidate, 30)));
+    for (size_t i = 0; sieve && i < primes.size(); i++)
+    {
+      residues[i] = ModWord(candidate, primes[i]);
+    }
+    for (size_t step = 0; BitLength(candidate) <= bits; step++)
+    {
+      if (stop->load(std::memory_order_relaxed))
+      {
+        return false;
+      }
+      bool divisible = false;
+      for (size_t i = 0; sieve && i < primes.size() && !divisible; i++)
+      {
+        divisible = residues[i] == 0;
+      }
+      if (!divisible && IsProbablePrime(candidate, bits, rounds, drbg))
+      {
+        if (stop->exchange(true))
+        {
+          return false;
+        }
+        *out = candidate;
+        return true;
+      }
+      uint32_t delta = kGcd30Delta[step % 8];
+      candidate = Add(candidate, Num(1, delta));
+      for (size_t i = 0; sieve && i < primes.size(); i++)
+      {
+        residues[i] = (residues[i] + delta) % primes[i];
+      }
+    }
+    // overflowed the bit length, start again from another random number
+  }
+  return false;
+}
+
+} // namespace bn
+} // namespace nodecrypto
@@ -0,0 +1,82 @@
+#include "cpu.h"
+
+#if defined(CRYPTO_X86)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace nodecrypto
+{
+
+#if defined(CRYPTO_X86)
+static void CpuId(unsigned leaf, unsigned subleaf, unsigned regs[4])
+{
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuidex(info, leaf, subleaf);
+  for (int i = 0; i < 4; i++)
+  {
+    regs[i] = static_cast<unsigned>(info[i]);
+  }
+#else
+  __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// whether the OS saves the YMM registers on context switches
+static bool OsSavesYmm()
+{
+#if defined(_MSC_VER)
+  return (_xgetbv(0) & 6) == 6;
+#else
+  unsigned eax, edx;
+  __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return (eax & 6) == 6;
+#endif
+}
+
+static CpuFeatures Detect()
+{
+  CpuFeatures features = {};
+  unsigned regs[4];
+
+  CpuId(0, 0, regs);
+  unsigned maxLeaf = regs[0];
+  if (maxLeaf < 1)
+  {
+    return features;
+  }
+
+  CpuId(1, 0, regs);
+  features.ssse3 = (regs[2] & (1u << 9)) != 0;
+  features.sse41 = (regs[2] & (1u << 19)) != 0;
+  features.pclmul = (regs[2] & (1u << 1)) != 0;
+  features.aesni = (regs[2] & (1u << 25)) != 0;
+  bool avx = (regs[2] & (1u << 28)) != 0 && (regs[2] & (1u << 27)) != 0 && OsSavesYmm();
+
+  if (maxLeaf >= 7)
+  {
+    CpuId(7, 0, regs);
+    features.avx2 = avx && (regs[1] & (1u << 5)) != 0;
+    features.sha = (regs[1] & (1u << 29)) != 0;
+  }
+  return features;
+}
+#else
+static CpuFeatures Detect()
+{
+  CpuFeatures features = {};
+  return features;
+}
+#endif
+
+const CpuFeatures &GetCpuFeatures()
+{
+  static const CpuFeatures features = Detect();
+  return features;
+}
+
+} // namespace nodecrypto
@@ -0,0 +1,37 @@
+#ifndef __CRYPTO_CPU_H_
+#define __CRYPTO_CPU_H_
+
+// Runtime detection of the instruction set extensions used by the SIMD kernels.
+//
+// Kernels are compiled with CRYPTO_TARGET("...") so that the rest of the addon does not require
+// them, and are only called after checking the corresponding flag of GetCpuFeatures().
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define CRYPTO_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define CRYPTO_TARGET(features) __attribute__((target(features)))
+#else
+#define CRYPTO_TARGET(features)
+#endif
+
+namespace nodecrypto
+{
+
+struct CpuFeatures
+{
+  bool ssse3;
+  bool sse41;
+  bool avx2;
+  bool aesni;
+  bool pclmul;
+  bool sha;
+};
+
+const CpuFeatures &GetCpuFeatures();
+
+} // namespace nodecrypto
+
+#endif // __CRYPTO_CPU_H_
@@ -0,0 +1,21 @@
+#include "crypto.h"
+#define ADONE_TRACE_IMPLEMENTATION
+#include <adone_trace.h>
+
+namespace nodecrypto
+{
+
+extern "C" NAN_MODULE_INIT(init)
+{
+  InitAes(target);
+  InitBlake2(target);
+  InitBn(target);
+  InitEd25519(target);
+  InitHash(target);
+  InitMd(target);
+  InitPbkdf2(target);
+  adone::trace::Export(target);
+}
+
+NODE_MODULE(binding, init)
+} // namespace nodecrypto
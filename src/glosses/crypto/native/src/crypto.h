@@ -0,0 +1,33 @@
+#ifndef __CRYPTO_CRYPTO_H_
+#define __CRYPTO_CRYPTO_H_
+
+#include <adone.h>
+#include <node_buffer.h>
+
+namespace nodecrypto
+{
+
+// Every algorithm exports its methods from its own init function, called by the module init in crypto.cc
+NAN_MODULE_INIT(InitAes);
+NAN_MODULE_INIT(InitBlake2);
+NAN_MODULE_INIT(InitBn);
+NAN_MODULE_INIT(InitEd25519);
+NAN_MODULE_INIT(InitHash);
+NAN_MODULE_INIT(InitMd);
+NAN_MODULE_INIT(InitPbkdf2);
+
+// Buffers and typed arrays are accepted as byte sources, returns false for anything else
+inline bool GetBytes(v8::Local<v8::Value> value, const uint8_t **data, size_t *length)
+{
+  if (!node::Buffer::HasInstance(value))
+  {
+    return false;
+  }
+  *data = reinterpret_cast<const uint8_t *>(node::Buffer::Data(value));
+  *length = node::Buffer::Length(value);
+  return true;
+}
+
+} // namespace nodecrypto
+
+#endif // __CRYPTO_CRYPTO_H_
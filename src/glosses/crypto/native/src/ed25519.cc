@@ -0,0 +1,283 @@
+#include "crypto.h"
+#include "ed25519/ed25519.h"
+
+#include <adone_pool.h>
+#include <adone_trace.h>
+
+#include <memory>
+#include <vector>
+
+namespace nodecrypto
+{
+
+// a batch is split so that every pool thread gets a part, but not below this size, under which
+// the multi-scalar multiplication stops paying off
+static const size_t kMinChunk = 64;
+
+// Collects the signatures of a batch, throws and returns false on invalid elements
+static bool GetItems(v8::Local<v8::Value> messagesValue, v8::Local<v8::Value> signaturesValue, v8::Local<v8::Value> publicKeysValue, std::vector<ed25519::BatchItem> *items)
+{
+  if (!messagesValue->IsArray() || !signaturesValue->IsArray() || !publicKeysValue->IsArray())
+  {
+    Nan::ThrowTypeError("Messages, signatures and public keys must be arrays");
+    return false;
+  }
+  v8::Local<v8::Array> messages = messagesValue.As<v8::Array>();
+  v8::Local<v8::Array> signatures = signaturesValue.As<v8::Array>();
+  v8::Local<v8::Array> publicKeys = publicKeysValue.As<v8::Array>();
+  uint32_t count = messages->Length();
+  if (signatures->Length() != count || publicKeys->Length() != count)
+  {
+    Nan::ThrowError("Messages, signatures and public keys must have the same length");
+    return false;
+  }
+  items->resize(count);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    ed25519::BatchItem &item = (*items)[i];
+    size_t length;
+    if (!GetBytes(Nan::Get(messages, i).ToLocalChecked(), &item.message, &item.length))
+    {
+      Nan::ThrowTypeError("Messages must be Buffers or Uint8Arrays");
+      return false;
+    }
+    if (!GetBytes(Nan::Get(signatures, i).ToLocalChecked(), &item.signature, &length) || length != ed25519::kSignatureBytes)
+    {
+      Nan::ThrowTypeError("Signatures must be 64-byte Buffers or Uint8Arrays");
+      return false;
+    }
+    if (!GetBytes(Nan::Get(publicKeys, i).ToLocalChecked(), &item.publicKey, &length) || length != ed25519::kPublicKeyBytes)
+    {
+      Nan::ThrowTypeError("Public keys must be 32-byte Buffers or Uint8Arrays");
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool GetSeed(v8::Local<v8::Value> value, const uint8_t **seed)
+{
+  size_t length;
+  if (!GetBytes(value, seed, &length) || length != 32)
+  {
+    Nan::ThrowTypeError("Seed must be a 32-byte Buffer or Uint8Array");
+    return false;
+  }
+  return true;
+}
+
+static v8::Local<v8::Array> ToArray(const bool *results, size_t count)
+{
+  v8::Local<v8::Array> array = Nan::New<v8::Array>(static_cast<uint32_t>(count));
+  for (size_t i = 0; i < count; i++)
+  {
+    Nan::Set(array, static_cast<uint32_t>(i), Nan::New(results[i]));
+  }
+  return array;
+}
+
+static v8::Local<v8::Array> CopyArray(v8::Local<v8::Value> value)
+{
+  v8::Local<v8::Array> array = value.As<v8::Array>();
+  uint32_t length = array->Length();
+  v8::Local<v8::Array> copy = Nan::New<v8::Array>(length);
+  for (uint32_t i = 0; i < length; i++)
+  {
+    Nan::Set(copy, i, Nan::Get(array, i).ToLocalChecked());
+  }
+  return copy;
+}
+
+// Signatures verified in parallel, one pool task per chunk. The tasks complete on the JS thread,
+// the last one calls back with the results.
+class VerifyBatch
+{
+public:
+  VerifyBatch(std::vector<ed25519::BatchItem> &items, const uint8_t *seed, size_t chunks, v8::Local<v8::Array> refs, Nan::Callback *callback)
+      : results(new bool[items.size()]), remaining(chunks), queued_at(uv_hrtime()),
+        callback(callback), async_resource(new Nan::AsyncResource("crypto:ed25519"))
+  {
+    this->items.swap(items);
+    memcpy(this->seed, seed, sizeof(this->seed));
+    this->refs.Reset(refs);
+  }
+
+  ~VerifyBatch()
+  {
+    refs.Reset();
+    delete callback;
+    delete async_resource;
+  }
+
+  void Verify(size_t begin, size_t end)
+  {
+    ADONE_TRACE_SPAN("crypto", "ed25519:queued", queued_at);
+    ADONE_TRACE_SCOPE("crypto", "ed25519:verifyBatch");
+    ed25519::VerifyBatch(items.data() + begin, end - begin, seed, results.get() + begin);
+  }
+
+  // Returns true when the batch is done and can be deleted
+  bool Complete()
+  {
+    if (--remaining > 0)
+    {
+      return false;
+    }
+    Nan::HandleScope scope;
+    v8::Local<v8::Value> argv[] = {Nan::Null(), ToArray(results.get(), items.size())};
+    callback->Call(2, argv, async_resource);
+    return true;
+  }
+
+private:
+  std::vector<ed25519::BatchItem> items;
+  uint8_t seed[32];
+  std::unique_ptr<bool[]> results;
+  size_t remaining;
+  uint64_t queued_at;
+  Nan::Persistent<v8::Array> refs;
+  Nan::Callback *callback;
+  Nan::AsyncResource *async_resource;
+};
+
+class VerifyTask : public adone::PoolTask
+{
+public:
+  VerifyTask(VerifyBatch *batch, size_t begin, size_t end) : batch(batch), begin(begin), end(end) {}
+
+  void Execute()
+  {
+    batch->Verify(begin, end);
+  }
+
+  void Complete()
+  {
+    if (batch->Complete())
+    {
+      delete batch;
+    }
+  }
+
+private:
+  VerifyBatch *batch;
+  size_t begin;
+  size_t end;
+};
+
+// publicKey(seed)
+NAN_METHOD(Ed25519PublicKey)
+{
+  const uint8_t *seed;
+  size_t length;
+  if (!GetBytes(info[0], &seed, &length) || length != ed25519::kSeedBytes)
+  {
+    return Nan::ThrowTypeError("Seed must be a 32-byte Buffer or Uint8Array");
+  }
+  uint8_t publicKey[ed25519::kPublicKeyBytes];
+  ed25519::PublicKey(seed, publicKey);
+  info.GetReturnValue().Set(Nan::CopyBuffer(reinterpret_cast<char *>(publicKey), sizeof(publicKey)).ToLocalChecked());
+}
+
+// sign(message, privateKey)
+NAN_METHOD(Ed25519Sign)
+{
+  ADONE_TRACE_SCOPE("crypto", "ed25519:sign");
+  const uint8_t *message, *privateKey;
+  size_t length, keyLength;
+  if (!GetBytes(info[0], &message, &length))
+  {
+    return Nan::ThrowTypeError("Message must be a Buffer or an Uint8Array");
+  }
+  if (!GetBytes(info[1], &privateKey, &keyLength) || keyLength != ed25519::kPrivateKeyBytes)
+  {
+    return Nan::ThrowTypeError("Private key must be a 64-byte Buffer or Uint8Array");
+  }
+  uint8_t signature[ed25519::kSignatureBytes];
+  ed25519::Sign(message, length, privateKey, signature);
+  info.GetReturnValue().Set(Nan::CopyBuffer(reinterpret_cast<char *>(signature), sizeof(signature)).ToLocalChecked());
+}
+
+// verify(message, signature, publicKey)
+NAN_METHOD(Ed25519Verify)
+{
+  ADONE_TRACE_SCOPE("crypto", "ed25519:verify");
+  const uint8_t *message, *signature, *publicKey;
+  size_t length, signatureLength, keyLength;
+  if (!GetBytes(info[0], &message, &length))
+  {
+    return Nan::ThrowTypeError("Message must be a Buffer or an Uint8Array");
+  }
+  if (!GetBytes(info[1], &signature, &signatureLength) || signatureLength != ed25519::kSignatureBytes)
+  {
+    return Nan::ThrowTypeError("Signature must be a 64-byte Buffer or Uint8Array");
+  }
+  if (!GetBytes(info[2], &publicKey, &keyLength) || keyLength != ed25519::kPublicKeyBytes)
+  {
+    return Nan::ThrowTypeError("Public key must be a 32-byte Buffer or Uint8Array");
+  }
+  info.GetReturnValue().Set(ed25519::Verify(message, length, signature, publicKey));
+}
+
+// verifyBatchSync(messages, signatures, publicKeys, seed), returns an array of booleans
+NAN_METHOD(Ed25519VerifyBatchSync)
+{
+  ADONE_TRACE_SCOPE("crypto", "ed25519:verifyBatchSync");
+  std::vector<ed25519::BatchItem> items;
+  const uint8_t *seed;
+  if (!GetItems(info[0], info[1], info[2], &items) || !GetSeed(info[3], &seed))
+  {
+    return;
+  }
+  std::unique_ptr<bool[]> results(new bool[items.size()]);
+  ed25519::VerifyBatch(items.data(), items.size(), seed, results.get());
+  info.GetReturnValue().Set(ToArray(results.get(), items.size()));
+}
+
+// verifyBatch(messages, signatures, publicKeys, seed, callback), the same as verifyBatchSync()
+// on the native pool
+NAN_METHOD(Ed25519VerifyBatch)
+{
+  std::vector<ed25519::BatchItem> items;
+  const uint8_t *seed;
+  if (!GetItems(info[0], info[1], info[2], &items) || !GetSeed(info[3], &seed))
+  {
+    return;
+  }
+  if (!info[4]->IsFunction())
+  {
+    return Nan::ThrowTypeError("Callback must be a function");
+  }
+  size_t count = items.size();
+  size_t threads = adone::GetExecutor()->Size();
+  size_t chunk = (count + threads - 1) / threads;
+  if (chunk < kMinChunk)
+  {
+    chunk = kMinChunk;
+  }
+  size_t chunks = count == 0 ? 1 : (count + chunk - 1) / chunk;
+
+  // the inputs stay referenced until the batch is done, the arrays are copied so that changes
+  // of the originals do not matter
+  v8::Local<v8::Array> refs = Nan::New<v8::Array>(3);
+  Nan::Set(refs, 0, CopyArray(info[0]));
+  Nan::Set(refs, 1, CopyArray(info[1]));
+  Nan::Set(refs, 2, CopyArray(info[2]));
+  VerifyBatch *batch = new VerifyBatch(items, seed, chunks, refs, new Nan::Callback(info[4].As<v8::Function>()));
+  for (size_t i = 0; i < chunks; i++)
+  {
+    size_t begin = i * chunk;
+    size_t end = begin + chunk < count ? begin + chunk : count;
+    adone::QueueWorker(new VerifyTask(batch, begin, end));
+  }
+}
+
+NAN_MODULE_INIT(InitEd25519)
+{
+  Nan::SetMethod(target, "ed25519PublicKey", Ed25519PublicKey);
+  Nan::SetMethod(target, "ed25519Sign", Ed25519Sign);
+  Nan::SetMethod(target, "ed25519Verify", Ed25519Verify);
+  Nan::SetMethod(target, "ed25519VerifyBatch", Ed25519VerifyBatch);
+  Nan::SetMethod(target, "ed25519VerifyBatchSync", Ed25519VerifyBatchSync);
+}
+
+} // namespace nodecrypto
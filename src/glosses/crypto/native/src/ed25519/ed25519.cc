@@ -0,0 +1,219 @@
+#include "ed25519_impl.h"
+#include "md/md.h"
+
+#include <vector>
+
+namespace nodecrypto
+{
+namespace ed25519
+{
+
+static const uint8_t kZero[32] = {0};
+
+// SHA-512 of the concatenation of up to three byte strings
+static void Hash(uint8_t out[64], const uint8_t *a, size_t aLength, const uint8_t *b, size_t bLength, const uint8_t *c, size_t cLength)
+{
+  md::Sha512State state;
+  md::Sha512Init(&state);
+  md::Sha512Update(&state, a, aLength);
+  md::Sha512Update(&state, b, bLength);
+  md::Sha512Update(&state, c, cLength);
+  md::Sha512Final(&state, out);
+}
+
+// The clamped secret scalar and the prefix of the nonces
+static void ExpandSeed(uint8_t az[64], const uint8_t seed[kSeedBytes])
+{
+  Hash(az, seed, kSeedBytes, NULL, 0, NULL, 0);
+  az[0] &= 248;
+  az[31] &= 127;
+  az[31] |= 64;
+}
+
+void PublicKey(const uint8_t seed[kSeedBytes], uint8_t publicKey[kPublicKeyBytes])
+{
+  uint8_t az[64];
+  GeP3 A;
+  ExpandSeed(az, seed);
+  GeScalarMultBase(&A, az);
+  GeP3ToBytes(publicKey, &A);
+  memset(az, 0, sizeof(az));
+}
+
+void Sign(const uint8_t *message, size_t length, const uint8_t privateKey[kPrivateKeyBytes], uint8_t signature[kSignatureBytes])
+{
+  uint8_t az[64], nonce[64], r[32], hram[64], h[32];
+  GeP3 R;
+  ExpandSeed(az, privateKey);
+
+  // r = H(prefix || M), R = r B
+  Hash(nonce, az + 32, 32, message, length, NULL, 0);
+  ScReduce(r, nonce);
+  GeScalarMultBase(&R, r);
+  GeP3ToBytes(signature, &R);
+
+  // S = r + H(R || A || M) a
+  Hash(hram, signature, 32, privateKey + kSeedBytes, kPublicKeyBytes, message, length);
+  ScReduce(h, hram);
+  ScMulAdd(signature + 32, h, az, r);
+
+  memset(az, 0, sizeof(az));
+  memset(nonce, 0, sizeof(nonce));
+  memset(r, 0, sizeof(r));
+}
+
+// The parts of a signature used by the verifications: A, R and the reduced scalars
+struct Parsed
+{
+  GeP3 A;
+  GeP3 R;
+  uint8_t h[32];
+  uint8_t s[32];
+};
+
+// Returns false if the signature can not be valid: A or R is not a point, R is not the canonical
+// encoding or S is not below L (RFC 8032 5.1.7, S + L would verify as well)
+static bool Parse(Parsed *parsed, const uint8_t *message, size_t length, const uint8_t *signature, const uint8_t *publicKey)
+{
+  if (!ScIsCanonical(signature + 32))
+  {
+    return false;
+  }
+  if (!GeFromBytes(&parsed->A, publicKey))
+  {
+    return false;
+  }
+  // R is decoded with Z = 1, so y only needs to be below p and a zero x positive
+  uint8_t encoded[32];
+  if (!GeFromBytes(&parsed->R, signature))
+  {
+    return false;
+  }
+  FeToBytes(encoded, &parsed->R.Y);
+  encoded[31] |= signature[31] & 0x80;
+  if (memcmp(encoded, signature, 32) != 0 || (FeIsZero(&parsed->R.X) && (signature[31] & 0x80)))
+  {
+    return false;
+  }
+  uint8_t hram[64];
+  Hash(hram, signature, 32, publicKey, kPublicKeyBytes, message, length);
+  ScReduce(parsed->h, hram);
+  memcpy(parsed->s, signature + 32, 32);
+  return true;
+}
+
+// p = 8 p, clears the small-order component
+static void MulByCofactor(GeP3 *p)
+{
+  GeP1P1 t;
+  for (int k = 0; k < 3; k++)
+  {
+    GeP3Dbl(&t, p);
+    GeP1P1ToP3(p, &t);
+  }
+}
+
+bool Verify(const uint8_t *message, size_t length, const uint8_t signature[kSignatureBytes], const uint8_t publicKey[kPublicKeyBytes])
+{
+  Parsed parsed;
+  if (!Parse(&parsed, message, length, signature, publicKey))
+  {
+    return false;
+  }
+  // 8 (S B - h A - R) = 0, the same equation as the batch
+  GeP3 minusA, check;
+  GeP2 sbha;
+  GeP1P1 t;
+  GeCached R;
+  GeNeg(&minusA, &parsed.A);
+  GeDoubleScalarMultVartime(&sbha, parsed.h, &minusA, parsed.s);
+  t.X = sbha.X;
+  t.Y = sbha.Y;
+  t.Z = sbha.Z;
+  t.T = sbha.Z;
+  GeP1P1ToP3(&check, &t);
+  GeP3ToCached(&R, &parsed.R);
+  GeSub(&t, &check, &R);
+  GeP1P1ToP3(&check, &t);
+  MulByCofactor(&check);
+  return GeIsIdentity(&check);
+}
+
+void VerifyBatch(const BatchItem *items, size_t count, const uint8_t seed[32], bool *results)
+{
+  if (count < 4)
+  {
+    // a multi-scalar multiplication does not pay off
+    for (size_t i = 0; i < count; i++)
+    {
+      results[i] = Verify(items[i].message, items[i].length, items[i].signature, items[i].publicKey);
+    }
+    return;
+  }
+
+  // sum z_i R_i + sum (z_i h_i) A_i - (sum z_i S_i) B = 0 with random 128-bit z_i
+  std::vector<size_t> valid;
+  std::vector<GeP3> points;
+  std::vector<Scalar> scalars;
+  valid.reserve(count);
+  points.reserve(2 * count + 1);
+  scalars.reserve(2 * count + 1);
+  uint8_t sum[32] = {0};
+  for (size_t i = 0; i < count; i++)
+  {
+    Parsed parsed;
+    results[i] = false;
+    if (!Parse(&parsed, items[i].message, items[i].length, items[i].signature, items[i].publicKey))
+    {
+      continue;
+    }
+
+    uint8_t digest[64], index[8], z[32] = {0};
+    for (int k = 0; k < 8; k++)
+    {
+      index[k] = static_cast<uint8_t>(static_cast<uint64_t>(i) >> (8 * k));
+    }
+    Hash(digest, seed, 32, index, 8, items[i].signature, kSignatureBytes);
+    memcpy(z, digest, 16);
+
+    valid.push_back(i);
+    points.push_back(parsed.R);
+    Scalar scalar;
+    memcpy(scalar.v, z, 32);
+    scalars.push_back(scalar);
+    points.push_back(parsed.A);
+    ScMulAdd(scalar.v, z, parsed.h, kZero);
+    scalars.push_back(scalar);
+    ScMulAdd(sum, z, parsed.s, sum);
+  }
+  if (valid.empty())
+  {
+    return;
+  }
+  GeP3 minusB;
+  GeNeg(&minusB, &GeBase());
+  points.push_back(minusB);
+  Scalar scalar;
+  memcpy(scalar.v, sum, 32);
+  scalars.push_back(scalar);
+
+  // the cofactor clears the small-order components of A and R
+  GeP3 check;
+  GeMultiScalarMultVartime(&check, scalars.data(), points.data(), points.size());
+  MulByCofactor(&check);
+  if (GeIsIdentity(&check))
+  {
+    for (size_t i : valid)
+    {
+      results[i] = true;
+    }
+    return;
+  }
+  for (size_t i : valid)
+  {
+    results[i] = Verify(items[i].message, items[i].length, items[i].signature, items[i].publicKey);
+  }
+}
+
+} // namespace ed25519
+} // namespace nodecrypto
@@ -0,0 +1,47 @@
+#ifndef __CRYPTO_ED25519_H_
+#define __CRYPTO_ED25519_H_
+
+// Ed25519 signatures (RFC 8032).
+//
+// Field elements are kept in five 51-bit limbs multiplied with 64x64->128-bit products. Signing
+// and key generation run in constant time, verification does not handle secrets and is variable
+// time. The results match ed25519.js: S is reduced modulo L rather than rejected, R must be a
+// canonical encoding and a signature is valid if it satisfies the cofactored equation of RFC 8032
+// section 5.1.7, [8][S]B = [8]R + [8][h]A, so single and batch verifications always agree.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace nodecrypto
+{
+namespace ed25519
+{
+
+static const size_t kSeedBytes = 32;
+static const size_t kPublicKeyBytes = 32;
+// the seed followed by the public key
+static const size_t kPrivateKeyBytes = 64;
+static const size_t kSignatureBytes = 64;
+
+void PublicKey(const uint8_t seed[kSeedBytes], uint8_t publicKey[kPublicKeyBytes]);
+void Sign(const uint8_t *message, size_t length, const uint8_t privateKey[kPrivateKeyBytes], uint8_t signature[kSignatureBytes]);
+bool Verify(const uint8_t *message, size_t length, const uint8_t signature[kSignatureBytes], const uint8_t publicKey[kPublicKeyBytes]);
+
+struct BatchItem
+{
+  const uint8_t *message;
+  size_t length;
+  const uint8_t *signature;
+  const uint8_t *publicKey;
+};
+
+// Verifies the signatures at once with a single multi-scalar multiplication, the random
+// coefficients of the linear combination are derived from the seed, which must be unpredictable.
+// When the combined check fails the signatures are verified one by one, so `results` always tells
+// which of them are valid.
+void VerifyBatch(const BatchItem *items, size_t count, const uint8_t seed[32], bool *results);
+
+} // namespace ed25519
+} // namespace nodecrypto
+
+#endif // __CRYPTO_ED25519_H_
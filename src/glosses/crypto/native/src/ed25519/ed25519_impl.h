@@ -0,0 +1,288 @@
+#ifndef __CRYPTO_ED25519_IMPL_H_
+#define __CRYPTO_ED25519_IMPL_H_
+
+// Field, group and scalar arithmetic of Ed25519, shared by ge.cc, sc.cc and ed25519.cc.
+//
+// A field element is h[0] + h[1] 2^51 + h[2] 2^102 + h[3] 2^153 + h[4] 2^204. Multiplications
+// accept limbs up to 2^54 and return limbs below 2^52, additions do not carry, so at most two
+// of them can be chained before a multiplication. Subtractions add 16p and carry, their operands
+// can be up to 2^55.
+
+#include "ed25519.h"
+
+#include <string.h>
+
+namespace nodecrypto
+{
+namespace ed25519
+{
+
+#if defined(__SIZEOF_INT128__)
+typedef unsigned __int128 uint128;
+
+static inline uint128 Mul64(uint64_t a, uint64_t b)
+{
+  return static_cast<uint128>(a) * b;
+}
+
+static inline uint64_t Lo64(uint128 x)
+{
+  return static_cast<uint64_t>(x);
+}
+
+static inline uint64_t Shr128(uint128 x, int bits)
+{
+  return static_cast<uint64_t>(x >> bits);
+}
+#else
+// portable 128-bit accumulator for compilers without __int128
+struct uint128
+{
+  uint64_t lo, hi;
+
+  uint128 &operator+=(const uint128 &other)
+  {
+    lo += other.lo;
+    hi += other.hi + (lo < other.lo);
+    return *this;
+  }
+
+  uint128 operator+(const uint128 &other) const
+  {
+    uint128 r = *this;
+    return r += other;
+  }
+};
+
+static inline uint128 Mul64(uint64_t a, uint64_t b)
+{
+  uint64_t a0 = a & 0xFFFFFFFF, a1 = a >> 32, b0 = b & 0xFFFFFFFF, b1 = b >> 32;
+  uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+  uint64_t middle = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+  uint128 r;
+  r.lo = (middle << 32) | (p00 & 0xFFFFFFFF);
+  r.hi = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+  return r;
+}
+
+static inline uint64_t Lo64(const uint128 &x)
+{
+  return x.lo;
+}
+
+static inline uint64_t Shr128(const uint128 &x, int bits)
+{
+  return (x.lo >> bits) | (x.hi << (64 - bits));
+}
+#endif
+
+static const uint64_t kMask51 = (static_cast<uint64_t>(1) << 51) - 1;
+
+struct Fe
+{
+  uint64_t v[5];
+};
+
+extern const Fe kFeD;
+extern const Fe kFeD2;
+extern const Fe kFeSqrtM1;
+
+static inline void FeZero(Fe *h)
+{
+  memset(h->v, 0, sizeof(h->v));
+}
+
+static inline void FeOne(Fe *h)
+{
+  FeZero(h);
+  h->v[0] = 1;
+}
+
+static inline void FeCarry(Fe *h)
+{
+  uint64_t c;
+  c = h->v[0] >> 51;
+  h->v[0] &= kMask51;
+  h->v[1] += c;
+  c = h->v[1] >> 51;
+  h->v[1] &= kMask51;
+  h->v[2] += c;
+  c = h->v[2] >> 51;
+  h->v[2] &= kMask51;
+  h->v[3] += c;
+  c = h->v[3] >> 51;
+  h->v[3] &= kMask51;
+  h->v[4] += c;
+  c = h->v[4] >> 51;
+  h->v[4] &= kMask51;
+  h->v[0] += 19 * c;
+}
+
+static inline void FeAdd(Fe *h, const Fe *f, const Fe *g)
+{
+  for (int i = 0; i < 5; i++)
+  {
+    h->v[i] = f->v[i] + g->v[i];
+  }
+}
+
+static inline void FeSub(Fe *h, const Fe *f, const Fe *g)
+{
+  // 16p
+  h->v[0] = f->v[0] + 0x7FFFFFFFFFFED0 - g->v[0];
+  h->v[1] = f->v[1] + 0x7FFFFFFFFFFFF0 - g->v[1];
+  h->v[2] = f->v[2] + 0x7FFFFFFFFFFFF0 - g->v[2];
+  h->v[3] = f->v[3] + 0x7FFFFFFFFFFFF0 - g->v[3];
+  h->v[4] = f->v[4] + 0x7FFFFFFFFFFFF0 - g->v[4];
+  FeCarry(h);
+}
+
+static inline void FeNeg(Fe *h, const Fe *f)
+{
+  Fe zero;
+  FeZero(&zero);
+  FeSub(h, &zero, f);
+}
+
+static inline void FeReduce128(Fe *h, uint128 r0, uint128 r1, uint128 r2, uint128 r3, uint128 r4)
+{
+  uint64_t c;
+  uint64_t h0 = Lo64(r0) & kMask51;
+  c = Shr128(r0, 51);
+  r1 = r1 + Mul64(c, 1);
+  uint64_t h1 = Lo64(r1) & kMask51;
+  c = Shr128(r1, 51);
+  r2 = r2 + Mul64(c, 1);
+  uint64_t h2 = Lo64(r2) & kMask51;
+  c = Shr128(r2, 51);
+  r3 = r3 + Mul64(c, 1);
+  uint64_t h3 = Lo64(r3) & kMask51;
+  c = Shr128(r3, 51);
+  r4 = r4 + Mul64(c, 1);
+  uint64_t h4 = Lo64(r4) & kMask51;
+  c = Shr128(r4, 51);
+  h0 += 19 * c;
+  h1 += h0 >> 51;
+  h0 &= kMask51;
+  h->v[0] = h0;
+  h->v[1] = h1;
+  h->v[2] = h2;
+  h->v[3] = h3;
+  h->v[4] = h4;
+}
+
+static inline void FeMul(Fe *h, const Fe *f, const Fe *g)
+{
+  const uint64_t *a = f->v, *b = g->v;
+  uint64_t b1 = 19 * b[1], b2 = 19 * b[2], b3 = 19 * b[3], b4 = 19 * b[4];
+  uint128 r0 = Mul64(a[0], b[0]) + Mul64(a[1], b4) + Mul64(a[2], b3) + Mul64(a[3], b2) + Mul64(a[4], b1);
+  uint128 r1 = Mul64(a[0], b[1]) + Mul64(a[1], b[0]) + Mul64(a[2], b4) + Mul64(a[3], b3) + Mul64(a[4], b2);
+  uint128 r2 = Mul64(a[0], b[2]) + Mul64(a[1], b[1]) + Mul64(a[2], b[0]) + Mul64(a[3], b4) + Mul64(a[4], b3);
+  uint128 r3 = Mul64(a[0], b[3]) + Mul64(a[1], b[2]) + Mul64(a[2], b[1]) + Mul64(a[3], b[0]) + Mul64(a[4], b4);
+  uint128 r4 = Mul64(a[0], b[4]) + Mul64(a[1], b[3]) + Mul64(a[2], b[2]) + Mul64(a[3], b[1]) + Mul64(a[4], b[0]);
+  FeReduce128(h, r0, r1, r2, r3, r4);
+}
+
+static inline void FeSq(Fe *h, const Fe *f)
+{
+  const uint64_t *a = f->v;
+  uint64_t a0_2 = 2 * a[0], a1_2 = 2 * a[1];
+  uint64_t a1_38 = 38 * a[1], a2_38 = 38 * a[2], a3_38 = 38 * a[3], a3_19 = 19 * a[3], a4_19 = 19 * a[4];
+  uint128 r0 = Mul64(a[0], a[0]) + Mul64(a1_38, a[4]) + Mul64(a2_38, a[3]);
+  uint128 r1 = Mul64(a0_2, a[1]) + Mul64(a2_38, a[4]) + Mul64(a3_19, a[3]);
+  uint128 r2 = Mul64(a0_2, a[2]) + Mul64(a[1], a[1]) + Mul64(a3_38, a[4]);
+  uint128 r3 = Mul64(a0_2, a[3]) + Mul64(a1_2, a[2]) + Mul64(a4_19, a[4]);
+  uint128 r4 = Mul64(a0_2, a[4]) + Mul64(a1_2, a[3]) + Mul64(a[2], a[2]);
+  FeReduce128(h, r0, r1, r2, r3, r4);
+}
+
+// Constant-time h = b ? g : h, b is 0 or 1
+static inline void FeCmov(Fe *h, const Fe *g, uint64_t b)
+{
+  uint64_t mask = 0 - b;
+  for (int i = 0; i < 5; i++)
+  {
+    h->v[i] ^= mask & (h->v[i] ^ g->v[i]);
+  }
+}
+
+void FeFromBytes(Fe *h, const uint8_t s[32]);
+// canonical encoding, below p
+void FeToBytes(uint8_t s[32], const Fe *h);
+void FeInvert(Fe *out, const Fe *z);
+// z^((p - 5) / 8)
+void FePow22523(Fe *out, const Fe *z);
+bool FeIsZero(const Fe *f);
+// the low bit of the canonical encoding, the "sign" of x
+int FeIsNegative(const Fe *f);
+
+// Points in extended coordinates (x = X/Z, y = Y/Z, xy = T/Z) and the other representations
+// of the ref10 formulas
+struct GeP2
+{
+  Fe X, Y, Z;
+};
+
+struct GeP3
+{
+  Fe X, Y, Z, T;
+};
+
+struct GeP1P1
+{
+  Fe X, Y, Z, T;
+};
+
+// affine, for the tables of multiples of the base point
+struct GePrecomp
+{
+  Fe yplusx, yminusx, xy2d;
+};
+
+struct GeCached
+{
+  Fe YplusX, YminusX, Z, T2d;
+};
+
+void GeP3Identity(GeP3 *h);
+void GeP3ToCached(GeCached *r, const GeP3 *p);
+void GeP3Dbl(GeP1P1 *r, const GeP3 *p);
+void GeP2Dbl(GeP1P1 *r, const GeP2 *p);
+void GeP1P1ToP2(GeP2 *r, const GeP1P1 *p);
+void GeP1P1ToP3(GeP3 *r, const GeP1P1 *p);
+void GeAdd(GeP1P1 *r, const GeP3 *p, const GeCached *q);
+void GeSub(GeP1P1 *r, const GeP3 *p, const GeCached *q);
+void GeNeg(GeP3 *r, const GeP3 *p);
+void GeToBytes(uint8_t s[32], const GeP2 *p);
+void GeP3ToBytes(uint8_t s[32], const GeP3 *p);
+// Returns false if the encoding is not a point of the curve, the y coordinate is not checked to
+// be below p as in TweetNaCl
+bool GeFromBytes(GeP3 *h, const uint8_t s[32]);
+bool GeIsIdentity(const GeP3 *p);
+
+// h = a B, constant time, a[31] <= 127
+void GeScalarMultBase(GeP3 *h, const uint8_t a[32]);
+// r = a A + b B, variable time, a and b below 2^255
+void GeDoubleScalarMultVartime(GeP2 *r, const uint8_t a[32], const GeP3 *A, const uint8_t b[32]);
+struct Scalar
+{
+  uint8_t v[32];
+};
+
+// h = sum of scalars[i] points[i], variable time, the scalars are below 2^253
+void GeMultiScalarMultVartime(GeP3 *h, const Scalar *scalars, const GeP3 *points, size_t count);
+// the base point
+const GeP3 &GeBase();
+
+// Scalars modulo L as 32 little-endian bytes
+// s = x mod L
+void ScReduce(uint8_t s[32], const uint8_t x[64]);
+// s < L, as sc_check of ref10
+bool ScIsCanonical(const uint8_t s[32]);
+// s = (a b + c) mod L
+void ScMulAdd(uint8_t s[32], const uint8_t a[32], const uint8_t b[32], const uint8_t c[32]);
+
+} // namespace ed25519
+} // namespace nodecrypto
+
+#endif // __CRYPTO_ED25519_IMPL_H_
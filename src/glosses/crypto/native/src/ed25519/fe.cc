@@ -0,0 +1,143 @@
+#include "ed25519_impl.h"
+
+namespace nodecrypto
+{
+namespace ed25519
+{
+
+const Fe kFeD = {{0x34DCA135978A3, 0x1A8283B156EBD, 0x5E7A26001C029, 0x739C663A03CBB, 0x52036CEE2B6FF}};
+const Fe kFeD2 = {{0x69B9426B2F159, 0x35050762ADD7A, 0x3CF44C0038052, 0x6738CC7407977, 0x2406D9DC56DFF}};
+const Fe kFeSqrtM1 = {{0x61B274A0EA0B0, 0x0D5A5FC8F189D, 0x7EF5E9CBD0C60, 0x78595A6804C9E, 0x2B8324804FC1D}};
+
+static inline uint64_t Load64(const uint8_t *p)
+{
+  uint64_t w = 0;
+  for (int i = 7; i >= 0; i--)
+  {
+    w = (w << 8) | p[i];
+  }
+  return w;
+}
+
+static inline void Store64(uint8_t *p, uint64_t w)
+{
+  for (int i = 0; i < 8; i++)
+  {
+    p[i] = static_cast<uint8_t>(w >> (8 * i));
+  }
+}
+
+void FeFromBytes(Fe *h, const uint8_t s[32])
+{
+  // the top bit is ignored
+  h->v[0] = Load64(s) & kMask51;
+  h->v[1] = (Load64(s + 6) >> 3) & kMask51;
+  h->v[2] = (Load64(s + 12) >> 6) & kMask51;
+  h->v[3] = (Load64(s + 19) >> 1) & kMask51;
+  h->v[4] = (Load64(s + 24) >> 12) & kMask51;
+}
+
+void FeToBytes(uint8_t s[32], const Fe *f)
+{
+  Fe h = *f;
+  FeCarry(&h);
+  FeCarry(&h);
+
+  // q is 1 if h >= p, then h - p = h + 19 - 2^255
+  uint64_t q = (h.v[0] + 19) >> 51;
+  q = (h.v[1] + q) >> 51;
+  q = (h.v[2] + q) >> 51;
+  q = (h.v[3] + q) >> 51;
+  q = (h.v[4] + q) >> 51;
+
+  h.v[0] += 19 * q;
+  h.v[1] += h.v[0] >> 51;
+  h.v[0] &= kMask51;
+  h.v[2] += h.v[1] >> 51;
+  h.v[1] &= kMask51;
+  h.v[3] += h.v[2] >> 51;
+  h.v[2] &= kMask51;
+  h.v[4] += h.v[3] >> 51;
+  h.v[3] &= kMask51;
+  h.v[4] &= kMask51;
+
+  Store64(s, h.v[0] | (h.v[1] << 51));
+  Store64(s + 8, (h.v[1] >> 13) | (h.v[2] << 38));
+  Store64(s + 16, (h.v[2] >> 26) | (h.v[3] << 25));
+  Store64(s + 24, (h.v[3] >> 39) | (h.v[4] << 12));
+}
+
+static inline void FeSqN(Fe *h, const Fe *f, int n)
+{
+  FeSq(h, f);
+  for (int i = 1; i < n; i++)
+  {
+    FeSq(h, h);
+  }
+}
+
+// Returns z^(2^250 - 1) and z^11
+static void FePow2250(Fe *z2_250_0, Fe *z11, const Fe *z)
+{
+  Fe z2, z9, t, z2_5_0, z2_10_0, z2_20_0, z2_50_0, z2_100_0;
+  FeSq(&z2, z);
+  FeSqN(&t, &z2, 2);
+  FeMul(&z9, &t, z);
+  FeMul(z11, &z9, &z2);
+  FeSq(&t, z11);
+  FeMul(&z2_5_0, &t, &z9);
+  FeSqN(&t, &z2_5_0, 5);
+  FeMul(&z2_10_0, &t, &z2_5_0);
+  FeSqN(&t, &z2_10_0, 10);
+  FeMul(&z2_20_0, &t, &z2_10_0);
+  FeSqN(&t, &z2_20_0, 20);
+  FeMul(&t, &t, &z2_20_0);
+  FeSqN(&t, &t, 10);
+  FeMul(&z2_50_0, &t, &z2_10_0);
+  FeSqN(&t, &z2_50_0, 50);
+  FeMul(&z2_100_0, &t, &z2_50_0);
+  FeSqN(&t, &z2_100_0, 100);
+  FeMul(&t, &t, &z2_100_0);
+  FeSqN(&t, &t, 50);
+  FeMul(z2_250_0, &t, &z2_50_0);
+}
+
+void FeInvert(Fe *out, const Fe *z)
+{
+  // z^(p - 2) = z^(2^255 - 21)
+  Fe t, z11;
+  FePow2250(&t, &z11, z);
+  FeSqN(&t, &t, 5);
+  FeMul(out, &t, &z11);
+}
+
+void FePow22523(Fe *out, const Fe *z)
+{
+  // z^(2^252 - 3)
+  Fe t, z11;
+  FePow2250(&t, &z11, z);
+  FeSqN(&t, &t, 2);
+  FeMul(out, &t, z);
+}
+
+bool FeIsZero(const Fe *f)
+{
+  uint8_t s[32];
+  FeToBytes(s, f);
+  uint8_t bits = 0;
+  for (int i = 0; i < 32; i++)
+  {
+    bits |= s[i];
+  }
+  return bits == 0;
+}
+
+int FeIsNegative(const Fe *f)
+{
+  uint8_t s[32];
+  FeToBytes(s, f);
+  return s[0] & 1;
+}
+
+} // namespace ed25519
+} // namespace nodecrypto
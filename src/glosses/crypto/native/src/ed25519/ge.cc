@@ -0,0 +1,561 @@
+#include "ed25519_impl.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace nodecrypto
+{
+namespace ed25519
+{
+
+void GeP3Identity(GeP3 *h)
+{
+  FeZero(&h->X);
+  FeOne(&h->Y);
+  FeOne(&h->Z);
+  FeZero(&h->T);
+}
+
+void GeP3ToCached(GeCached *r, const GeP3 *p)
+{
+  FeAdd(&r->YplusX, &p->Y, &p->X);
+  FeSub(&r->YminusX, &p->Y, &p->X);
+  r->Z = p->Z;
+  FeMul(&r->T2d, &p->T, &kFeD2);
+}
+
+void GeP1P1ToP2(GeP2 *r, const GeP1P1 *p)
+{
+  FeMul(&r->X, &p->X, &p->T);
+  FeMul(&r->Y, &p->Y, &p->Z);
+  FeMul(&r->Z, &p->Z, &p->T);
+}
+
+void GeP1P1ToP3(GeP3 *r, const GeP1P1 *p)
+{
+  FeMul(&r->X, &p->X, &p->T);
+  FeMul(&r->Y, &p->Y, &p->Z);
+  FeMul(&r->Z, &p->Z, &p->T);
+  FeMul(&r->T, &p->X, &p->Y);
+}
+
+void GeP2Dbl(GeP1P1 *r, const GeP2 *p)
+{
+  Fe t0;
+  FeSq(&r->X, &p->X);
+  FeSq(&r->Z, &p->Y);
+  FeSq(&r->T, &p->Z);
+  FeAdd(&r->T, &r->T, &r->T);
+  FeAdd(&r->Y, &p->X, &p->Y);
+  FeSq(&t0, &r->Y);
+  FeAdd(&r->Y, &r->Z, &r->X);
+  FeSub(&r->Z, &r->Z, &r->X);
+  FeSub(&r->X, &t0, &r->Y);
+  FeSub(&r->T, &r->T, &r->Z);
+}
+
+void GeP3Dbl(GeP1P1 *r, const GeP3 *p)
+{
+  GeP2 q;
+  q.X = p->X;
+  q.Y = p->Y;
+  q.Z = p->Z;
+  GeP2Dbl(r, &q);
+}
+
+void GeAdd(GeP1P1 *r, const GeP3 *p, const GeCached *q)
+{
+  Fe t0;
+  FeAdd(&r->X, &p->Y, &p->X);
+  FeSub(&r->Y, &p->Y, &p->X);
+  FeMul(&r->Z, &r->X, &q->YplusX);
+  FeMul(&r->Y, &r->Y, &q->YminusX);
+  FeMul(&r->T, &q->T2d, &p->T);
+  FeMul(&r->X, &p->Z, &q->Z);
+  FeAdd(&t0, &r->X, &r->X);
+  FeSub(&r->X, &r->Z, &r->Y);
+  FeAdd(&r->Y, &r->Z, &r->Y);
+  FeAdd(&r->Z, &t0, &r->T);
+  FeSub(&r->T, &t0, &r->T);
+}
+
+void GeSub(GeP1P1 *r, const GeP3 *p, const GeCached *q)
+{
+  Fe t0;
+  FeAdd(&r->X, &p->Y, &p->X);
+  FeSub(&r->Y, &p->Y, &p->X);
+  FeMul(&r->Z, &r->X, &q->YminusX);
+  FeMul(&r->Y, &r->Y, &q->YplusX);
+  FeMul(&r->T, &q->T2d, &p->T);
+  FeMul(&r->X, &p->Z, &q->Z);
+  FeAdd(&t0, &r->X, &r->X);
+  FeSub(&r->X, &r->Z, &r->Y);
+  FeAdd(&r->Y, &r->Z, &r->Y);
+  FeSub(&r->Z, &t0, &r->T);
+  FeAdd(&r->T, &t0, &r->T);
+}
+
+static void GeMadd(GeP1P1 *r, const GeP3 *p, const GePrecomp *q)
+{
+  Fe t0;
+  FeAdd(&r->X, &p->Y, &p->X);
+  FeSub(&r->Y, &p->Y, &p->X);
+  FeMul(&r->Z, &r->X, &q->yplusx);
+  FeMul(&r->Y, &r->Y, &q->yminusx);
+  FeMul(&r->T, &q->xy2d, &p->T);
+  FeAdd(&t0, &p->Z, &p->Z);
+  FeSub(&r->X, &r->Z, &r->Y);
+  FeAdd(&r->Y, &r->Z, &r->Y);
+  FeAdd(&r->Z, &t0, &r->T);
+  FeSub(&r->T, &t0, &r->T);
+}
+
+void GeNeg(GeP3 *r, const GeP3 *p)
+{
+  FeNeg(&r->X, &p->X);
+  r->Y = p->Y;
+  r->Z = p->Z;
+  FeNeg(&r->T, &p->T);
+}
+
+void GeToBytes(uint8_t s[32], const GeP2 *p)
+{
+  Fe recip, x, y;
+  FeInvert(&recip, &p->Z);
+  FeMul(&x, &p->X, &recip);
+  FeMul(&y, &p->Y, &recip);
+  FeToBytes(s, &y);
+  s[31] ^= static_cast<uint8_t>(FeIsNegative(&x) << 7);
+}
+
+void GeP3ToBytes(uint8_t s[32], const GeP3 *p)
+{
+  GeP2 q;
+  q.X = p->X;
+  q.Y = p->Y;
+  q.Z = p->Z;
+  GeToBytes(s, &q);
+}
+
+bool GeFromBytes(GeP3 *h, const uint8_t s[32])
+{
+  Fe u, v, v3, vxx, check;
+  FeFromBytes(&h->Y, s);
+  FeOne(&h->Z);
+  // u = y^2 - 1, v = d y^2 + 1
+  FeSq(&u, &h->Y);
+  FeMul(&v, &u, &kFeD);
+  FeSub(&u, &u, &h->Z);
+  FeAdd(&v, &v, &h->Z);
+
+  // x = u v^3 (u v^7)^((p - 5) / 8)
+  FeSq(&v3, &v);
+  FeMul(&v3, &v3, &v);
+  FeSq(&h->X, &v3);
+  FeMul(&h->X, &h->X, &v);
+  FeMul(&h->X, &h->X, &u);
+  FePow22523(&h->X, &h->X);
+  FeMul(&h->X, &h->X, &v3);
+  FeMul(&h->X, &h->X, &u);
+
+  FeSq(&vxx, &h->X);
+  FeMul(&vxx, &vxx, &v);
+  FeSub(&check, &vxx, &u);
+  if (!FeIsZero(&check))
+  {
+    FeAdd(&check, &vxx, &u);
+    if (!FeIsZero(&check))
+    {
+      return false;
+    }
+    FeMul(&h->X, &h->X, &kFeSqrtM1);
+  }
+
+  if (FeIsNegative(&h->X) != (s[31] >> 7))
+  {
+    FeNeg(&h->X, &h->X);
+  }
+  FeMul(&h->T, &h->X, &h->Y);
+  return true;
+}
+
+bool GeIsIdentity(const GeP3 *p)
+{
+  Fe t;
+  FeSub(&t, &p->Y, &p->Z);
+  return FeIsZero(&p->X) && FeIsZero(&t);
+}
+
+static void GeP3ToPrecomp(GePrecomp *r, const GeP3 *p)
+{
+  Fe recip, x, y;
+  FeInvert(&recip, &p->Z);
+  FeMul(&x, &p->X, &recip);
+  FeMul(&y, &p->Y, &recip);
+  FeAdd(&r->yplusx, &y, &x);
+  FeSub(&r->yminusx, &y, &x);
+  FeMul(&r->xy2d, &x, &y);
+  FeMul(&r->xy2d, &r->xy2d, &kFeD2);
+}
+
+// Tables computed on first use: the base point, j 256^i B for j in 1..8 used by the
+// constant-time multiplication, and the odd multiples B, 3B, ..., 15B used by the
+// variable-time one
+struct BaseTables
+{
+  GeP3 base;
+  GePrecomp multiples[32][8];
+  GeCached odd[8];
+};
+
+static BaseTables tables;
+static std::once_flag tablesOnce;
+
+static void InitTables()
+{
+  // y = 4/5 with a positive x
+  static const uint8_t kBaseBytes[32] = {
+      0x58, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66,
+      0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66, 0x66};
+  GeFromBytes(&tables.base, kBaseBytes);
+
+  GeP1P1 t;
+  GeCached cached;
+  GeP3 p = tables.base;
+  for (int i = 0; i < 32; i++)
+  {
+    GeP3 q = p;
+    GeP3ToCached(&cached, &p);
+    for (int j = 0; j < 8; j++)
+    {
+      GeP3ToPrecomp(&tables.multiples[i][j], &q);
+      GeAdd(&t, &q, &cached);
+      GeP1P1ToP3(&q, &t);
+    }
+    for (int k = 0; k < 8; k++)
+    {
+      GeP3Dbl(&t, &p);
+      GeP1P1ToP3(&p, &t);
+    }
+  }
+
+  GeP3 b2, q = tables.base;
+  GeP3Dbl(&t, &tables.base);
+  GeP1P1ToP3(&b2, &t);
+  GeP3ToCached(&cached, &b2);
+  for (int i = 0; i < 8; i++)
+  {
+    GeP3ToCached(&tables.odd[i], &q);
+    GeAdd(&t, &q, &cached);
+    GeP1P1ToP3(&q, &t);
+  }
+}
+
+static const BaseTables &Tables()
+{
+  std::call_once(tablesOnce, InitTables);
+  return tables;
+}
+
+const GeP3 &GeBase()
+{
+  return Tables().base;
+}
+
+static inline uint64_t Equal(int8_t a, int8_t b)
+{
+  uint32_t x = static_cast<uint8_t>(a ^ b);
+  return static_cast<uint64_t>((x - 1) >> 31);
+}
+
+static inline void PrecompCmov(GePrecomp *t, const GePrecomp *u, uint64_t b)
+{
+  FeCmov(&t->yplusx, &u->yplusx, b);
+  FeCmov(&t->yminusx, &u->yminusx, b);
+  FeCmov(&t->xy2d, &u->xy2d, b);
+}
+
+// t = b 256^pos B, reads the whole row to not leak b
+static void Select(GePrecomp *t, const GePrecomp row[8], int8_t b)
+{
+  uint64_t negative = static_cast<uint8_t>(b) >> 7;
+  int8_t babs = static_cast<int8_t>(b - ((-static_cast<int>(negative) & b) << 1));
+  FeOne(&t->yplusx);
+  FeOne(&t->yminusx);
+  FeZero(&t->xy2d);
+  for (int j = 0; j < 8; j++)
+  {
+    PrecompCmov(t, &row[j], Equal(babs, static_cast<int8_t>(j + 1)));
+  }
+  GePrecomp minus;
+  minus.yplusx = t->yminusx;
+  minus.yminusx = t->yplusx;
+  FeNeg(&minus.xy2d, &t->xy2d);
+  PrecompCmov(t, &minus, negative);
+}
+
+void GeScalarMultBase(GeP3 *h, const uint8_t a[32])
+{
+  const BaseTables &tbl = Tables();
+  // signed radix-16 digits in -8..8
+  int8_t e[64];
+  for (int i = 0; i < 32; i++)
+  {
+    e[2 * i] = a[i] & 15;
+    e[2 * i + 1] = (a[i] >> 4) & 15;
+  }
+  int8_t carry = 0;
+  for (int i = 0; i < 63; i++)
+  {
+    e[i] += carry;
+    carry = static_cast<int8_t>((e[i] + 8) >> 4);
+    e[i] -= static_cast<int8_t>(carry << 4);
+  }
+  e[63] += carry;
+
+  GeP1P1 r;
+  GeP2 s;
+  GePrecomp t;
+  GeP3Identity(h);
+  for (int i = 1; i < 64; i += 2)
+  {
+    Select(&t, tbl.multiples[i / 2], e[i]);
+    GeMadd(&r, h, &t);
+    GeP1P1ToP3(h, &r);
+  }
+  GeP3Dbl(&r, h);
+  GeP1P1ToP2(&s, &r);
+  GeP2Dbl(&r, &s);
+  GeP1P1ToP2(&s, &r);
+  GeP2Dbl(&r, &s);
+  GeP1P1ToP2(&s, &r);
+  GeP2Dbl(&r, &s);
+  GeP1P1ToP3(h, &r);
+  for (int i = 0; i < 64; i += 2)
+  {
+    Select(&t, tbl.multiples[i / 2], e[i]);
+    GeMadd(&r, h, &t);
+    GeP1P1ToP3(h, &r);
+  }
+}
+
+// Width-5 signed sliding window, the digits are odd in -15..15 or zero
+static void Slide(int8_t r[256], const uint8_t a[32])
+{
+  for (int i = 0; i < 256; i++)
+  {
+    r[i] = 1 & (a[i >> 3] >> (i & 7));
+  }
+  for (int i = 0; i < 256; i++)
+  {
+    if (!r[i])
+    {
+      continue;
+    }
+    for (int b = 1; b <= 6 && i + b < 256; b++)
+    {
+      if (!r[i + b])
+      {
+        continue;
+      }
+      if (r[i] + (r[i + b] << b) <= 15)
+      {
+        r[i] = static_cast<int8_t>(r[i] + (r[i + b] << b));
+        r[i + b] = 0;
+      }
+      else if (r[i] - (r[i + b] << b) >= -15)
+      {
+        r[i] = static_cast<int8_t>(r[i] - (r[i + b] << b));
+        for (int k = i + b; k < 256; k++)
+        {
+          if (!r[k])
+          {
+            r[k] = 1;
+            break;
+          }
+          r[k] = 0;
+        }
+      }
+      else
+      {
+        break;
+      }
+    }
+  }
+}
+
+void GeDoubleScalarMultVartime(GeP2 *r, const uint8_t a[32], const GeP3 *A, const uint8_t b[32])
+{
+  const BaseTables &tbl = Tables();
+  int8_t aslide[256], bslide[256];
+  GeCached Ai[8];
+  GeP1P1 t;
+  GeP3 u, A2;
+
+  Slide(aslide, a);
+  Slide(bslide, b);
+
+  GeP3ToCached(&Ai[0], A);
+  GeP3Dbl(&t, A);
+  GeP1P1ToP3(&A2, &t);
+  for (int i = 1; i < 8; i++)
+  {
+    GeAdd(&t, &A2, &Ai[i - 1]);
+    GeP1P1ToP3(&u, &t);
+    GeP3ToCached(&Ai[i], &u);
+  }
+
+  FeZero(&r->X);
+  FeOne(&r->Y);
+  FeOne(&r->Z);
+
+  int i = 255;
+  while (i >= 0 && !aslide[i] && !bslide[i])
+  {
+    i--;
+  }
+  for (; i >= 0; i--)
+  {
+    GeP2Dbl(&t, r);
+    if (aslide[i] > 0)
+    {
+      GeP1P1ToP3(&u, &t);
+      GeAdd(&t, &u, &Ai[aslide[i] / 2]);
+    }
+    else if (aslide[i] < 0)
+    {
+      GeP1P1ToP3(&u, &t);
+      GeSub(&t, &u, &Ai[(-aslide[i]) / 2]);
+    }
+    if (bslide[i] > 0)
+    {
+      GeP1P1ToP3(&u, &t);
+      GeAdd(&t, &u, &tbl.odd[bslide[i] / 2]);
+    }
+    else if (bslide[i] < 0)
+    {
+      GeP1P1ToP3(&u, &t);
+      GeSub(&t, &u, &tbl.odd[(-bslide[i]) / 2]);
+    }
+    GeP1P1ToP2(r, &t);
+  }
+}
+
+// Bits [pos, pos + width) of a little-endian scalar
+static inline uint32_t Digit(const uint8_t s[32], size_t pos, int width)
+{
+  uint32_t bits = 0;
+  size_t first = pos >> 3;
+  for (size_t k = 0; k < 4 && first + k < 32; k++)
+  {
+    bits |= static_cast<uint32_t>(s[first + k]) << (8 * k);
+  }
+  return (bits >> (pos & 7)) & ((1u << width) - 1);
+}
+
+// Window width of the bucket method, about log2 of the number of points
+static int WindowBits(size_t count)
+{
+  int bits = 2;
+  while (bits < 14 && (static_cast<size_t>(1) << (bits + 2)) <= count)
+  {
+    bits++;
+  }
+  return bits;
+}
+
+void GeMultiScalarMultVartime(GeP3 *h, const Scalar *scalars, const GeP3 *points, size_t count)
+{
+  // Pippenger's bucket method: the scalars are cut into windows of c bits, in every window the
+  // points are first added into the bucket of their digit, then the buckets are summed so that
+  // the bucket j is counted j times
+  const int c = WindowBits(count);
+  const size_t windows = (253 + c - 1) / c;
+  const size_t bucketCount = (static_cast<size_t>(1) << c) - 1;
+
+  std::vector<GeCached> cached(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    GeP3ToCached(&cached[i], &points[i]);
+  }
+  std::vector<GeP3> buckets(bucketCount);
+  std::vector<bool> used(bucketCount);
+
+  GeP1P1 t;
+  GeCached tc;
+  GeP3Identity(h);
+  for (size_t w = windows; w-- > 0;)
+  {
+    if (w + 1 < windows)
+    {
+      for (int k = 0; k < c; k++)
+      {
+        GeP3Dbl(&t, h);
+        GeP1P1ToP3(h, &t);
+      }
+    }
+
+    std::fill(used.begin(), used.end(), false);
+    for (size_t i = 0; i < count; i++)
+    {
+      uint32_t d = Digit(scalars[i].v, w * c, c);
+      if (d == 0)
+      {
+        continue;
+      }
+      if (!used[d - 1])
+      {
+        buckets[d - 1] = points[i];
+        used[d - 1] = true;
+        continue;
+      }
+      GeAdd(&t, &buckets[d - 1], &cached[i]);
+      GeP1P1ToP3(&buckets[d - 1], &t);
+    }
+
+    GeP3 running, total;
+    bool anyRunning = false, any = false;
+    for (size_t j = bucketCount; j-- > 0;)
+    {
+      if (used[j])
+      {
+        if (anyRunning)
+        {
+          GeP3ToCached(&tc, &buckets[j]);
+          GeAdd(&t, &running, &tc);
+          GeP1P1ToP3(&running, &t);
+        }
+        else
+        {
+          running = buckets[j];
+          anyRunning = true;
+        }
+      }
+      if (!anyRunning)
+      {
+        continue;
+      }
+      if (any)
+      {
+        GeP3ToCached(&tc, &running);
+        GeAdd(&t, &total, &tc);
+        GeP1P1ToP3(&total, &t);
+      }
+      else
+      {
+        total = running;
+        any = true;
+      }
+    }
+    if (any)
+    {
+      GeP3ToCached(&tc, &total);
+      GeAdd(&t, h, &tc);
+      GeP1P1ToP3(h, &t);
+    }
+  }
+}
+
+} // namespace ed25519
+} // namespace nodecrypto
@@ -0,0 +1,90 @@
+#include "ed25519_impl.h"
+
+namespace nodecrypto
+{
+namespace ed25519
+{
+
+// L = 2^252 + 27742317777372353535851937790883648493
+static const int64_t kL[32] = {
+    0xED, 0xD3, 0xF5, 0x5C, 0x1A, 0x63, 0x12, 0x58, 0xD6, 0x9C, 0xF7, 0xA2, 0xDE, 0xF9, 0xDE, 0x14,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x10};
+
+// Reduces 64 signed radix-2^8 digits modulo L, the same as modL() of TweetNaCl
+static void ModL(uint8_t r[32], int64_t x[64])
+{
+  int64_t carry;
+  for (int i = 63; i >= 32; i--)
+  {
+    carry = 0;
+    int j, k;
+    for (j = i - 32, k = i - 12; j < k; j++)
+    {
+      x[j] += carry - 16 * x[i] * kL[j - (i - 32)];
+      // floor((x[j] + 128) / 256)
+      carry = (x[j] + 128) >> 8;
+      x[j] -= carry * 256;
+    }
+    x[j] += carry;
+    x[i] = 0;
+  }
+  carry = 0;
+  for (int j = 0; j < 32; j++)
+  {
+    x[j] += carry - (x[31] >> 4) * kL[j];
+    carry = x[j] >> 8;
+    x[j] &= 255;
+  }
+  for (int j = 0; j < 32; j++)
+  {
+    x[j] -= carry * kL[j];
+  }
+  for (int i = 0; i < 32; i++)
+  {
+    x[i + 1] += x[i] >> 8;
+    r[i] = static_cast<uint8_t>(x[i] & 255);
+  }
+}
+
+void ScReduce(uint8_t s[32], const uint8_t x[64])
+{
+  int64_t t[64];
+  for (int i = 0; i < 64; i++)
+  {
+    t[i] = x[i];
+  }
+  ModL(s, t);
+}
+
+bool ScIsCanonical(const uint8_t s[32])
+{
+  // variable time, the scalars checked are public
+  for (int i = 31; i >= 0; i--)
+  {
+    if (s[i] != kL[i])
+    {
+      return s[i] < kL[i];
+    }
+  }
+  return false;
+}
+
+void ScMulAdd(uint8_t s[32], const uint8_t a[32], const uint8_t b[32], const uint8_t c[32])
+{
+  int64_t t[64] = {0};
+  for (int i = 0; i < 32; i++)
+  {
+    t[i] = c[i];
+  }
+  for (int i = 0; i < 32; i++)
+  {
+    for (int j = 0; j < 32; j++)
+    {
+      t[i + j] += static_cast<int64_t>(a[i]) * b[j];
+    }
+  }
+  ModL(s, t);
+}
+
+} // namespace ed25519
+} // namespace nodecrypto
@@ -0,0 +1,244 @@
+#include "crypto.h"
+#include "hash/hash.h"
+
+#include <adone_trace.h>
+
+#include <stdio.h> // snprintf
+
+namespace nodecrypto
+{
+
+enum Murmur3Variant
+{
+  kMurmur3X86_32 = 0,
+  kMurmur3X86_128 = 1,
+  kMurmur3X64_128 = 2
+};
+
+// 32-bit words per hash in the batch results
+static inline size_t Murmur3Words(int variant)
+{
+  return variant == kMurmur3X86_32 ? 1 : 4;
+}
+
+// The 128-bit hashes as 4 words in the order of their hex strings
+static void Murmur3(int variant, const uint8_t *data, size_t length, uint32_t seed, uint32_t *out)
+{
+  switch (variant)
+  {
+  case kMurmur3X86_32:
+    out[0] = hash::Murmur3X86_32(data, length, seed);
+    break;
+  case kMurmur3X86_128:
+    hash::Murmur3X86_128(data, length, seed, out);
+    break;
+  default:
+  {
+    uint64_t h[2];
+    hash::Murmur3X64_128(data, length, seed, h);
+    out[0] = static_cast<uint32_t>(h[0] >> 32);
+    out[1] = static_cast<uint32_t>(h[0]);
+    out[2] = static_cast<uint32_t>(h[1] >> 32);
+    out[3] = static_cast<uint32_t>(h[1]);
+    break;
+  }
+  }
+}
+
+// The keys of a batch: an array of strings (hashed as UTF-8) and byte arrays, or a single buffer
+// of packed keys split by an Uint32Array of count + 1 offsets
+class Keys
+{
+public:
+  // Throws and returns false on invalid arguments
+  bool Parse(v8::Local<v8::Value> keys, v8::Local<v8::Value> offsets)
+  {
+    if (keys->IsArray())
+    {
+      array = keys.As<v8::Array>();
+      count = array->Length();
+      return true;
+    }
+    if (!GetBytes(keys, &packed, &packedLength))
+    {
+      Nan::ThrowTypeError("Keys must be an array or a Buffer with offsets");
+      return false;
+    }
+    if (!offsets->IsUint32Array())
+    {
+      Nan::ThrowTypeError("Offsets of packed keys must be an Uint32Array");
+      return false;
+    }
+    Nan::TypedArrayContents<uint32_t> view(offsets);
+    size_t length = view.length();
+    bounds = *view;
+    if (length == 0)
+    {
+      Nan::ThrowError("Offsets must have one more entry than there are keys");
+      return false;
+    }
+    count = length - 1;
+    for (size_t i = 0; i < count; i++)
+    {
+      if (bounds[i] > bounds[i + 1] || bounds[i + 1] > packedLength)
+      {
+        Nan::ThrowError("Offsets must be ascending and within the keys");
+        return false;
+      }
+    }
+    return true;
+  }
+
+  size_t Count() const { return count; }
+
+  // Calls fn(data, length, index) for every key, throws and returns false on an invalid key
+  template <typename Fn>
+  bool Each(Fn fn) const
+  {
+    if (packed != NULL)
+    {
+      for (size_t i = 0; i < count; i++)
+      {
+        fn(packed + bounds[i], bounds[i + 1] - bounds[i], i);
+      }
+      return true;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+      v8::Local<v8::Value> key = Nan::Get(array, static_cast<uint32_t>(i)).ToLocalChecked();
+      const uint8_t *data;
+      size_t length;
+      if (key->IsString())
+      {
+        Nan::Utf8String utf8(key);
+        fn(reinterpret_cast<const uint8_t *>(*utf8), static_cast<size_t>(utf8.length()), i);
+      }
+      else if (GetBytes(key, &data, &length))
+      {
+        fn(data, length, i);
+      }
+      else
+      {
+        Nan::ThrowTypeError("Keys must be strings, Buffers or Uint8Arrays");
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  v8::Local<v8::Array> array;
+  const uint8_t *packed = NULL;
+  size_t packedLength = 0;
+  const uint32_t *bounds = NULL;
+  size_t count = 0;
+};
+
+static v8::Local<v8::Uint32Array> NewUint32Array(size_t length, uint32_t **data)
+{
+  v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), length * sizeof(uint32_t));
+  v8::Local<v8::Uint32Array> array = v8::Uint32Array::New(buffer, 0, length);
+  *data = *Nan::TypedArrayContents<uint32_t>(array);
+  return array;
+}
+
+static bool GetVariant(v8::Local<v8::Value> value, int *variant)
+{
+  *variant = Nan::To<int32_t>(value).FromMaybe(-1);
+  if (*variant < kMurmur3X86_32 || *variant > kMurmur3X64_128)
+  {
+    Nan::ThrowError("Unknown MurmurHash3 variant");
+    return false;
+  }
+  return true;
+}
+
+// murmur3(variant, input, seed) returns an unsigned 32-bit hash, or a 128-bit hash as a hex string
+NAN_METHOD(Murmur3)
+{
+  int variant;
+  const uint8_t *data;
+  size_t length;
+  if (!GetVariant(info[0], &variant))
+  {
+    return;
+  }
+  if (!GetBytes(info[1], &data, &length))
+  {
+    return Nan::ThrowTypeError("Input must be a Buffer or an Uint8Array");
+  }
+  uint32_t h[4];
+  Murmur3(variant, data, length, Nan::To<uint32_t>(info[2]).FromMaybe(0), h);
+  if (variant == kMurmur3X86_32)
+  {
+    info.GetReturnValue().Set(h[0]);
+    return;
+  }
+  char hex[33];
+  snprintf(hex, sizeof(hex), "%08x%08x%08x%08x", h[0], h[1], h[2], h[3]);
+  info.GetReturnValue().Set(NanStr(hex));
+}
+
+// murmur3Batch(variant, keys, offsets, seed) returns the hashes of all the keys in an Uint32Array,
+// 4 words per key for the 128-bit variants
+NAN_METHOD(Murmur3Batch)
+{
+  int variant;
+  Keys keys;
+  if (!GetVariant(info[0], &variant) || !keys.Parse(info[1], info[2]))
+  {
+    return;
+  }
+  uint32_t seed = Nan::To<uint32_t>(info[3]).FromMaybe(0);
+  size_t words = Murmur3Words(variant);
+  uint32_t *out;
+  v8::Local<v8::Uint32Array> result = NewUint32Array(keys.Count() * words, &out);
+  ADONE_TRACE_SCOPE("crypto", "hash:murmur3Batch");
+  if (keys.Each([&](const uint8_t *data, size_t length, size_t i) { Murmur3(variant, data, length, seed, out + i * words); }))
+  {
+    info.GetReturnValue().Set(result);
+  }
+}
+
+// fnv1a32(input)
+NAN_METHOD(Fnv1a32)
+{
+  const uint8_t *data;
+  size_t length;
+  if (!GetBytes(info[0], &data, &length))
+  {
+    return Nan::ThrowTypeError("Input must be a Buffer or an Uint8Array");
+  }
+  info.GetReturnValue().Set(hash::Fnv1a32(data, length));
+}
+
+// fnv1aBatch(keys, offsets, fold24) returns the 32-bit hashes, or their 24-bit folds, in an Uint32Array
+NAN_METHOD(Fnv1aBatch)
+{
+  Keys keys;
+  if (!keys.Parse(info[0], info[1]))
+  {
+    return;
+  }
+  bool fold24 = Nan::To<bool>(info[2]).FromJust();
+  uint32_t *out;
+  v8::Local<v8::Uint32Array> result = NewUint32Array(keys.Count(), &out);
+  ADONE_TRACE_SCOPE("crypto", "hash:fnv1aBatch");
+  if (keys.Each([&](const uint8_t *data, size_t length, size_t i) {
+        uint32_t hash = hash::Fnv1a32(data, length);
+        out[i] = fold24 ? hash::Fnv1a24(hash) : hash;
+      }))
+  {
+    info.GetReturnValue().Set(result);
+  }
+}
+
+NAN_MODULE_INIT(InitHash)
+{
+  Nan::SetMethod(target, "murmur3", Murmur3);
+  Nan::SetMethod(target, "murmur3Batch", Murmur3Batch);
+  Nan::SetMethod(target, "fnv1a32", Fnv1a32);
+  Nan::SetMethod(target, "fnv1aBatch", Fnv1aBatch);
+}
+
+} // namespace nodecrypto
@@ -0,0 +1,23 @@
+#include "hash.h"
+
+namespace nodecrypto
+{
+namespace hash
+{
+
+// See http://www.isthe.com/chongo/tech/comp/fnv/#FNV-param
+static const uint32_t kFnvPrime = 16777619;
+static const uint32_t kOffsetBasis = 2166136261u;
+
+uint32_t Fnv1a32(const uint8_t *data, size_t length)
+{
+  uint32_t hash = kOffsetBasis;
+  for (size_t i = 0; i < length; i++)
+  {
+    hash = (hash ^ data[i]) * kFnvPrime;
+  }
+  return hash;
+}
+
+} // namespace hash
+} // namespace nodecrypto
@@ -0,0 +1,33 @@
+#ifndef __CRYPTO_HASH_H_
+#define __CRYPTO_HASH_H_
+
+// Non-cryptographic hashes for partitioning and lookups: MurmurHash3 (the x86_32, x86_128 and
+// x64_128 flavors of the reference implementation) and 32-bit FNV-1a.
+//
+// The results are the same as the ones of murmur_hash3.js and data/bson/fnv1a.js.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace nodecrypto
+{
+namespace hash
+{
+
+uint32_t Murmur3X86_32(const uint8_t *data, size_t length, uint32_t seed);
+// h1, h2, h3, h4
+void Murmur3X86_128(const uint8_t *data, size_t length, uint32_t seed, uint32_t out[4]);
+// h1, h2
+void Murmur3X64_128(const uint8_t *data, size_t length, uint32_t seed, uint64_t out[2]);
+
+uint32_t Fnv1a32(const uint8_t *data, size_t length);
+// xor-folds a 32-bit FNV-1a hash into 24 bits
+inline uint32_t Fnv1a24(uint32_t hash)
+{
+  return (hash & 0xFFFFFF) ^ (hash >> 24);
+}
+
+} // namespace hash
+} // namespace nodecrypto
+
+#endif // __CRYPTO_HASH_H_
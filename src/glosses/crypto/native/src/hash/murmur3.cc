@@ -0,0 +1,272 @@
+#include "hash.h"
+
+namespace nodecrypto
+{
+namespace hash
+{
+
+static inline uint32_t Rotl32(uint32_t x, int n)
+{
+  return (x << n) | (x >> (32 - n));
+}
+
+static inline uint64_t Rotl64(uint64_t x, int n)
+{
+  return (x << n) | (x >> (64 - n));
+}
+
+// little-endian loads regardless of the host byte order and alignment
+static inline uint32_t Load32(const uint8_t *p)
+{
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static inline uint64_t Load64(const uint8_t *p)
+{
+  return static_cast<uint64_t>(Load32(p)) | (static_cast<uint64_t>(Load32(p + 4)) << 32);
+}
+
+static inline uint32_t Fmix32(uint32_t h)
+{
+  h ^= h >> 16;
+  h *= 0x85EBCA6B;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35;
+  h ^= h >> 16;
+  return h;
+}
+
+static inline uint64_t Fmix64(uint64_t k)
+{
+  k ^= k >> 33;
+  k *= 0xFF51AFD7ED558CCDull;
+  k ^= k >> 33;
+  k *= 0xC4CEB9FE1A85EC53ull;
+  k ^= k >> 33;
+  return k;
+}
+
+// bytes of the tail in a little-endian word
+static inline uint64_t Tail(const uint8_t *tail, size_t from, size_t to)
+{
+  uint64_t k = 0;
+  for (size_t i = to; i-- > from;)
+  {
+    k = (k << 8) | tail[i];
+  }
+  return k;
+}
+
+uint32_t Murmur3X86_32(const uint8_t *data, size_t length, uint32_t seed)
+{
+  const uint32_t c1 = 0xCC9E2D51;
+  const uint32_t c2 = 0x1B873593;
+  size_t blocks = length / 4;
+  uint32_t h1 = seed;
+
+  for (size_t i = 0; i < blocks; i++)
+  {
+    uint32_t k1 = Load32(data + 4 * i);
+    k1 *= c1;
+    k1 = Rotl32(k1, 15);
+    k1 *= c2;
+
+    h1 ^= k1;
+    h1 = Rotl32(h1, 13);
+    h1 = h1 * 5 + 0xE6546B64;
+  }
+
+  const uint8_t *tail = data + blocks * 4;
+  size_t rest = length & 3;
+  if (rest > 0)
+  {
+    uint32_t k1 = static_cast<uint32_t>(Tail(tail, 0, rest));
+    k1 *= c1;
+    k1 = Rotl32(k1, 15);
+    k1 *= c2;
+    h1 ^= k1;
+  }
+
+  h1 ^= static_cast<uint32_t>(length);
+  return Fmix32(h1);
+}
+
+void Murmur3X86_128(const uint8_t *data, size_t length, uint32_t seed, uint32_t out[4])
+{
+  const uint32_t c1 = 0x239B961B;
+  const uint32_t c2 = 0xAB0E9789;
+  const uint32_t c3 = 0x38B34AE5;
+  const uint32_t c4 = 0xA1E38B93;
+  size_t blocks = length / 16;
+  uint32_t h1 = seed, h2 = seed, h3 = seed, h4 = seed;
+
+  for (size_t i = 0; i < blocks; i++)
+  {
+    const uint8_t *block = data + 16 * i;
+    uint32_t k1 = Load32(block);
+    uint32_t k2 = Load32(block + 4);
+    uint32_t k3 = Load32(block + 8);
+    uint32_t k4 = Load32(block + 12);
+
+    k1 *= c1;
+    k1 = Rotl32(k1, 15);
+    k1 *= c2;
+    h1 ^= k1;
+    h1 = Rotl32(h1, 19);
+    h1 += h2;
+    h1 = h1 * 5 + 0x561CCD1B;
+
+    k2 *= c2;
+    k2 = Rotl32(k2, 16);
+    k2 *= c3;
+    h2 ^= k2;
+    h2 = Rotl32(h2, 17);
+    h2 += h3;
+    h2 = h2 * 5 + 0x0BCAA747;
+
+    k3 *= c3;
+    k3 = Rotl32(k3, 17);
+    k3 *= c4;
+    h3 ^= k3;
+    h3 = Rotl32(h3, 15);
+    h3 += h4;
+    h3 = h3 * 5 + 0x96CD1C35;
+
+    k4 *= c4;
+    k4 = Rotl32(k4, 18);
+    k4 *= c1;
+    h4 ^= k4;
+    h4 = Rotl32(h4, 13);
+    h4 += h1;
+    h4 = h4 * 5 + 0x32AC3B17;
+  }
+
+  const uint8_t *tail = data + blocks * 16;
+  size_t rest = length & 15;
+  if (rest > 12)
+  {
+    uint32_t k4 = static_cast<uint32_t>(Tail(tail, 12, rest));
+    k4 *= c4;
+    k4 = Rotl32(k4, 18);
+    k4 *= c1;
+    h4 ^= k4;
+  }
+  if (rest > 8)
+  {
+    uint32_t k3 = static_cast<uint32_t>(Tail(tail, 8, rest < 12 ? rest : 12));
+    k3 *= c3;
+    k3 = Rotl32(k3, 17);
+    k3 *= c4;
+    h3 ^= k3;
+  }
+  if (rest > 4)
+  {
+    uint32_t k2 = static_cast<uint32_t>(Tail(tail, 4, rest < 8 ? rest : 8));
+    k2 *= c2;
+    k2 = Rotl32(k2, 16);
+    k2 *= c3;
+    h2 ^= k2;
+  }
+  if (rest > 0)
+  {
+    uint32_t k1 = static_cast<uint32_t>(Tail(tail, 0, rest < 4 ? rest : 4));
+    k1 *= c1;
+    k1 = Rotl32(k1, 15);
+    k1 *= c2;
+    h1 ^= k1;
+  }
+
+  uint32_t len = static_cast<uint32_t>(length);
+  h1 ^= len;
+  h2 ^= len;
+  h3 ^= len;
+  h4 ^= len;
+
+  h1 += h2 + h3 + h4;
+  h2 += h1;
+  h3 += h1;
+  h4 += h1;
+
+  h1 = Fmix32(h1);
+  h2 = Fmix32(h2);
+  h3 = Fmix32(h3);
+  h4 = Fmix32(h4);
+
+  h1 += h2 + h3 + h4;
+  h2 += h1;
+  h3 += h1;
+  h4 += h1;
+
+  out[0] = h1;
+  out[1] = h2;
+  out[2] = h3;
+  out[3] = h4;
+}
+
+void Murmur3X64_128(const uint8_t *data, size_t length, uint32_t seed, uint64_t out[2])
+{
+  const uint64_t c1 = 0x87C37B91114253D5ull;
+  const uint64_t c2 = 0x4CF5AD432745937Full;
+  size_t blocks = length / 16;
+  uint64_t h1 = seed, h2 = seed;
+
+  for (size_t i = 0; i < blocks; i++)
+  {
+    uint64_t k1 = Load64(data + 16 * i);
+    uint64_t k2 = Load64(data + 16 * i + 8);
+
+    k1 *= c1;
+    k1 = Rotl64(k1, 31);
+    k1 *= c2;
+    h1 ^= k1;
+    h1 = Rotl64(h1, 27);
+    h1 += h2;
+    h1 = h1 * 5 + 0x52DCE729;
+
+    k2 *= c2;
+    k2 = Rotl64(k2, 33);
+    k2 *= c1;
+    h2 ^= k2;
+    h2 = Rotl64(h2, 31);
+    h2 += h1;
+    h2 = h2 * 5 + 0x38495AB5;
+  }
+
+  const uint8_t *tail = data + blocks * 16;
+  size_t rest = length & 15;
+  if (rest > 8)
+  {
+    uint64_t k2 = Tail(tail, 8, rest);
+    k2 *= c2;
+    k2 = Rotl64(k2, 33);
+    k2 *= c1;
+    h2 ^= k2;
+  }
+  if (rest > 0)
+  {
+    uint64_t k1 = Tail(tail, 0, rest < 8 ? rest : 8);
+    k1 *= c1;
+    k1 = Rotl64(k1, 31);
+    k1 *= c2;
+    h1 ^= k1;
+  }
+
+  h1 ^= length;
+  h2 ^= length;
+
+  h1 += h2;
+  h2 += h1;
+
+  h1 = Fmix64(h1);
+  h2 = Fmix64(h2);
+
+  h1 += h2;
+  h2 += h1;
+
+  out[0] = h1;
+  out[1] = h2;
+}
+
+} // namespace hash
+} // namespace nodecrypto
@@ -0,0 +1,226 @@
+#include "crypto.h"
+#include "md/md.h"
+
+#include <adone_pool.h>
+#include <adone_trace.h>
+
+#include <string.h> // strcmp
+
+namespace nodecrypto
+{
+
+struct Sha1
+{
+  typedef md::Sha1State State;
+  static const size_t kDigestBytes = md::kSha1DigestBytes;
+
+  static const char *ClassName() { return "Sha1"; }
+  static const char *TraceName() { return "sha1:update"; }
+
+  static void Init(State *state) { md::Sha1Init(state); }
+  static void Update(State *state, const uint8_t *data, size_t length) { md::Sha1Update(state, data, length); }
+  static void Final(const State *state, uint8_t *out) { md::Sha1Final(state, out); }
+};
+
+struct Md5
+{
+  typedef md::Md5State State;
+  static const size_t kDigestBytes = md::kMd5DigestBytes;
+
+  static const char *ClassName() { return "Md5"; }
+  static const char *TraceName() { return "md5:update"; }
+
+  static void Init(State *state) { md::Md5Init(state); }
+  static void Update(State *state, const uint8_t *data, size_t length) { md::Md5Update(state, data, length); }
+  static void Final(const State *state, uint8_t *out) { md::Md5Final(state, out); }
+};
+
+// Incremental message digest exported as the Sha1/Md5 classes.
+//
+// digest() does not finalize the hash. While updateAsync() is running on the pool the state is
+// owned by the worker and every other method throws.
+template <typename Algorithm>
+class Digest : public Nan::ObjectWrap
+{
+public:
+  static void Init(v8::Local<v8::Object> target)
+  {
+    v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+    tpl->SetClassName(NanStr(Algorithm::ClassName()));
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+    Nan::SetPrototypeMethod(tpl, "reset", Reset);
+    Nan::SetPrototypeMethod(tpl, "update", Update);
+    Nan::SetPrototypeMethod(tpl, "updateAsync", UpdateAsync);
+    Nan::SetPrototypeMethod(tpl, "digest", DigestValue);
+    Nan::Set(target, NanStr(Algorithm::ClassName()), Nan::GetFunction(tpl).ToLocalChecked());
+  }
+
+private:
+  class UpdateWorker : public adone::PoolWorker
+  {
+  public:
+    UpdateWorker(Digest *digest, v8::Local<v8::Object> self, v8::Local<v8::Value> input, const uint8_t *data, size_t length, Nan::Callback *callback)
+        : adone::PoolWorker(callback, "crypto:md"), digest(digest), data(data), length(length)
+    {
+      // keeps both the hash object and the input alive while the worker runs
+      v8::Local<v8::Array> refs = Nan::New<v8::Array>(2);
+      Nan::Set(refs, 0, self);
+      Nan::Set(refs, 1, input);
+      this->refs.Reset(refs);
+    }
+
+    ~UpdateWorker()
+    {
+      refs.Reset();
+    }
+
+    void Execute()
+    {
+      ADONE_TRACE_SPAN("crypto", "md:queued", queued_at);
+      ADONE_TRACE_SCOPE("crypto", Algorithm::TraceName());
+      Algorithm::Update(&digest->state, data, length);
+    }
+
+    void HandleOKCallback()
+    {
+      digest->busy = false;
+      adone::PoolWorker::HandleOKCallback();
+    }
+
+  private:
+    Digest *digest;
+    const uint8_t *data;
+    size_t length;
+    Nan::Persistent<v8::Array> refs;
+  };
+
+  Digest() : busy(false)
+  {
+    Algorithm::Init(&state);
+  }
+
+  static Digest *Unwrap(const Nan::FunctionCallbackInfo<v8::Value> &info)
+  {
+    Digest *digest = Nan::ObjectWrap::Unwrap<Digest>(info.Holder());
+    if (digest->busy)
+    {
+      Nan::ThrowError("Digest is being updated asynchronously");
+      return NULL;
+    }
+    return digest;
+  }
+
+  static NAN_METHOD(New)
+  {
+    if (!info.IsConstructCall())
+    {
+      return Nan::ThrowTypeError("Class constructor cannot be invoked without 'new'");
+    }
+    Digest *digest = new Digest();
+    digest->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  }
+
+  static NAN_METHOD(Reset)
+  {
+    Digest *digest = Unwrap(info);
+    if (digest == NULL)
+    {
+      return;
+    }
+    Algorithm::Init(&digest->state);
+    info.GetReturnValue().Set(info.Holder());
+  }
+
+  static NAN_METHOD(Update)
+  {
+    Digest *digest = Unwrap(info);
+    const uint8_t *data;
+    size_t length;
+    if (digest == NULL)
+    {
+      return;
+    }
+    if (!GetBytes(info[0], &data, &length))
+    {
+      return Nan::ThrowTypeError("Input must be a Buffer or an Uint8Array");
+    }
+    Algorithm::Update(&digest->state, data, length);
+    info.GetReturnValue().Set(info.Holder());
+  }
+
+  // updateAsync(input, callback)
+  static NAN_METHOD(UpdateAsync)
+  {
+    Digest *digest = Unwrap(info);
+    const uint8_t *data;
+    size_t length;
+    if (digest == NULL)
+    {
+      return;
+    }
+    if (!GetBytes(info[0], &data, &length))
+    {
+      return Nan::ThrowTypeError("Input must be a Buffer or an Uint8Array");
+    }
+    digest->busy = true;
+    Nan::Callback *callback = new Nan::Callback(info[1].As<v8::Function>());
+    adone::QueueWorker(new UpdateWorker(digest, info.Holder(), info[0], data, length, callback));
+  }
+
+  static NAN_METHOD(DigestValue)
+  {
+    Digest *digest = Unwrap(info);
+    if (digest == NULL)
+    {
+      return;
+    }
+    uint8_t out[Algorithm::kDigestBytes];
+    Algorithm::Final(&digest->state, out);
+    info.GetReturnValue().Set(Nan::CopyBuffer(reinterpret_cast<char *>(out), Algorithm::kDigestBytes).ToLocalChecked());
+  }
+
+  typename Algorithm::State state;
+  bool busy;
+};
+
+typedef md::Kernel (*GetKernelFn)();
+typedef bool (*SetKernelFn)(md::Kernel kernel);
+
+template <GetKernelFn Active, GetKernelFn Best>
+static NAN_METHOD(GetKernel)
+{
+  v8::Local<v8::Object> result = Nan::New<v8::Object>();
+  Nan::Set(result, NanStr("active"), NanStr(md::KernelName(Active())));
+  Nan::Set(result, NanStr("best"), NanStr(md::KernelName(Best())));
+  info.GetReturnValue().Set(result);
+}
+
+// setKernel(name), returns false if the kernel is unknown or the CPU does not support it
+template <SetKernelFn Set>
+static NAN_METHOD(SetKernel)
+{
+  Nan::Utf8String name(info[0]);
+  static const md::Kernel kernels[] = {md::kKernelScalar, md::kKernelSHANI};
+  for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+  {
+    if (*name != NULL && strcmp(*name, md::KernelName(kernels[i])) == 0)
+    {
+      info.GetReturnValue().Set(Set(kernels[i]));
+      return;
+    }
+  }
+  info.GetReturnValue().Set(false);
+}
+
+NAN_MODULE_INIT(InitMd)
+{
+  Digest<Sha1>::Init(target);
+  Digest<Md5>::Init(target);
+  Nan::SetMethod(target, "sha1GetKernel", GetKernel<md::GetSha1Kernel, md::GetBestSha1Kernel>);
+  Nan::SetMethod(target, "sha1SetKernel", SetKernel<md::SetSha1Kernel>);
+  Nan::SetMethod(target, "sha256GetKernel", GetKernel<md::GetSha256Kernel, md::GetBestSha256Kernel>);
+  Nan::SetMethod(target, "sha256SetKernel", SetKernel<md::SetSha256Kernel>);
+}
+
+} // namespace nodecrypto
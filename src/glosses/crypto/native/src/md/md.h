@@ -0,0 +1,79 @@
+#ifndef __CRYPTO_MD_H_
+#define __CRYPTO_MD_H_
+
+// SHA-1, SHA-256, SHA-512 and MD5 message digests.
+//
+// SHA-1 and SHA-256 use the SHA extensions (SHA-NI) when the CPU has them. Final() works on a copy
+// of the state, so a digest can be taken at any point and the hash can still be updated afterwards.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace nodecrypto
+{
+namespace md
+{
+
+enum Kernel
+{
+  kKernelScalar = 0,
+  kKernelSHANI = 1
+};
+
+template <typename Word, size_t Words, size_t BlockBytes = 64>
+struct State
+{
+  Word h[Words];
+  uint64_t length;
+  uint8_t buf[BlockBytes];
+  size_t buflen;
+};
+
+typedef State<uint32_t, 5> Sha1State;
+typedef State<uint32_t, 4> Md5State;
+typedef State<uint32_t, 8> Sha256State;
+typedef State<uint64_t, 8, 128> Sha512State;
+
+static const size_t kSha1DigestBytes = 20;
+static const size_t kMd5DigestBytes = 16;
+static const size_t kSha256DigestBytes = 32;
+static const size_t kSha512DigestBytes = 64;
+
+void Sha1Init(Sha1State *state);
+void Sha1Update(Sha1State *state, const uint8_t *data, size_t length);
+void Sha1Final(const Sha1State *state, uint8_t *out);
+
+void Md5Init(Md5State *state);
+void Md5Update(Md5State *state, const uint8_t *data, size_t length);
+void Md5Final(const Md5State *state, uint8_t *out);
+
+void Sha256Init(Sha256State *state);
+void Sha256Update(Sha256State *state, const uint8_t *data, size_t length);
+void Sha256Final(const Sha256State *state, uint8_t *out);
+
+void Sha512Init(Sha512State *state);
+void Sha512Update(Sha512State *state, const uint8_t *data, size_t length);
+void Sha512Final(const Sha512State *state, uint8_t *out);
+
+// Compression functions of the kernels in use, for constructions that pad the blocks themselves
+// (PBKDF2 hashes the same two blocks over and over)
+typedef void (*Compress32Fn)(uint32_t *h, const uint8_t *blocks, size_t count);
+typedef void (*Compress64Fn)(uint64_t *h, const uint8_t *blocks, size_t count);
+
+Compress32Fn GetSha1Compress();
+Compress32Fn GetSha256Compress();
+Compress64Fn GetSha512Compress();
+
+// SHA-1 and SHA-256 kernels in use, the same conventions as blake2::SetKernel()
+Kernel GetSha1Kernel();
+Kernel GetBestSha1Kernel();
+bool SetSha1Kernel(Kernel kernel);
+Kernel GetSha256Kernel();
+Kernel GetBestSha256Kernel();
+bool SetSha256Kernel(Kernel kernel);
+const char *KernelName(Kernel kernel);
+
+} // namespace md
+} // namespace nodecrypto
+
+#endif // __CRYPTO_MD_H_
@@ -0,0 +1,133 @@
+#include "md_impl.h"
+
+namespace nodecrypto
+{
+namespace md
+{
+
+static const uint32_t kIV[4] = {0x67452301UL, 0xEFCDAB89UL, 0x98BADCFEUL, 0x10325476UL};
+
+typedef MerkleDamgard<uint32_t, 4, 64, false> Impl;
+
+#define F(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define G(x, y, z) ((y) ^ ((z) & ((x) ^ (y))))
+#define H(x, y, z) ((x) ^ (y) ^ (z))
+#define I(x, y, z) ((y) ^ ((x) | ~(z)))
+
+#define STEP(f, a, b, c, d, x, k, s)              \
+  do                                              \
+  {                                               \
+    a += f(b, c, d) + (x) + (k);                  \
+    a = RotateLeft(a, s) + b;                     \
+  } while (0)
+
+// MD5 is inherently serial, there is no SIMD kernel for a single stream
+static void Compress(uint32_t *h, const uint8_t *blocks, size_t count)
+{
+  uint32_t x[16];
+  for (; count > 0; count--, blocks += 64)
+  {
+    for (int i = 0; i < 16; i++)
+    {
+      x[i] = LoadLE32(blocks + 4 * i);
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3];
+
+    STEP(F, a, b, c, d, x[0], 0xd76aa478UL, 7);
+    STEP(F, d, a, b, c, x[1], 0xe8c7b756UL, 12);
+    STEP(F, c, d, a, b, x[2], 0x242070dbUL, 17);
+    STEP(F, b, c, d, a, x[3], 0xc1bdceeeUL, 22);
+    STEP(F, a, b, c, d, x[4], 0xf57c0fafUL, 7);
+    STEP(F, d, a, b, c, x[5], 0x4787c62aUL, 12);
+    STEP(F, c, d, a, b, x[6], 0xa8304613UL, 17);
+    STEP(F, b, c, d, a, x[7], 0xfd469501UL, 22);
+    STEP(F, a, b, c, d, x[8], 0x698098d8UL, 7);
+    STEP(F, d, a, b, c, x[9], 0x8b44f7afUL, 12);
+    STEP(F, c, d, a, b, x[10], 0xffff5bb1UL, 17);
+    STEP(F, b, c, d, a, x[11], 0x895cd7beUL, 22);
+    STEP(F, a, b, c, d, x[12], 0x6b901122UL, 7);
+    STEP(F, d, a, b, c, x[13], 0xfd987193UL, 12);
+    STEP(F, c, d, a, b, x[14], 0xa679438eUL, 17);
+    STEP(F, b, c, d, a, x[15], 0x49b40821UL, 22);
+
+    STEP(G, a, b, c, d, x[1], 0xf61e2562UL, 5);
+    STEP(G, d, a, b, c, x[6], 0xc040b340UL, 9);
+    STEP(G, c, d, a, b, x[11], 0x265e5a51UL, 14);
+    STEP(G, b, c, d, a, x[0], 0xe9b6c7aaUL, 20);
+    STEP(G, a, b, c, d, x[5], 0xd62f105dUL, 5);
+    STEP(G, d, a, b, c, x[10], 0x02441453UL, 9);
+    STEP(G, c, d, a, b, x[15], 0xd8a1e681UL, 14);
+    STEP(G, b, c, d, a, x[4], 0xe7d3fbc8UL, 20);
+    STEP(G, a, b, c, d, x[9], 0x21e1cde6UL, 5);
+    STEP(G, d, a, b, c, x[14], 0xc33707d6UL, 9);
+    STEP(G, c, d, a, b, x[3], 0xf4d50d87UL, 14);
+    STEP(G, b, c, d, a, x[8], 0x455a14edUL, 20);
+    STEP(G, a, b, c, d, x[13], 0xa9e3e905UL, 5);
+    STEP(G, d, a, b, c, x[2], 0xfcefa3f8UL, 9);
+    STEP(G, c, d, a, b, x[7], 0x676f02d9UL, 14);
+    STEP(G, b, c, d, a, x[12], 0x8d2a4c8aUL, 20);
+
+    STEP(H, a, b, c, d, x[5], 0xfffa3942UL, 4);
+    STEP(H, d, a, b, c, x[8], 0x8771f681UL, 11);
+    STEP(H, c, d, a, b, x[11], 0x6d9d6122UL, 16);
+    STEP(H, b, c, d, a, x[14], 0xfde5380cUL, 23);
+    STEP(H, a, b, c, d, x[1], 0xa4beea44UL, 4);
+    STEP(H, d, a, b, c, x[4], 0x4bdecfa9UL, 11);
+    STEP(H, c, d, a, b, x[7], 0xf6bb4b60UL, 16);
+    STEP(H, b, c, d, a, x[10], 0xbebfbc70UL, 23);
+    STEP(H, a, b, c, d, x[13], 0x289b7ec6UL, 4);
+    STEP(H, d, a, b, c, x[0], 0xeaa127faUL, 11);
+    STEP(H, c, d, a, b, x[3], 0xd4ef3085UL, 16);
+    STEP(H, b, c, d, a, x[6], 0x04881d05UL, 23);
+    STEP(H, a, b, c, d, x[9], 0xd9d4d039UL, 4);
+    STEP(H, d, a, b, c, x[12], 0xe6db99e5UL, 11);
+    STEP(H, c, d, a, b, x[15], 0x1fa27cf8UL, 16);
+    STEP(H, b, c, d, a, x[2], 0xc4ac5665UL, 23);
+
+    STEP(I, a, b, c, d, x[0], 0xf4292244UL, 6);
+    STEP(I, d, a, b, c, x[7], 0x432aff97UL, 10);
+    STEP(I, c, d, a, b, x[14], 0xab9423a7UL, 15);
+    STEP(I, b, c, d, a, x[5], 0xfc93a039UL, 21);
+    STEP(I, a, b, c, d, x[12], 0x655b59c3UL, 6);
+    STEP(I, d, a, b, c, x[3], 0x8f0ccc92UL, 10);
+    STEP(I, c, d, a, b, x[10], 0xffeff47dUL, 15);
+    STEP(I, b, c, d, a, x[1], 0x85845dd1UL, 21);
+    STEP(I, a, b, c, d, x[8], 0x6fa87e4fUL, 6);
+    STEP(I, d, a, b, c, x[15], 0xfe2ce6e0UL, 10);
+    STEP(I, c, d, a, b, x[6], 0xa3014314UL, 15);
+    STEP(I, b, c, d, a, x[13], 0x4e0811a1UL, 21);
+    STEP(I, a, b, c, d, x[4], 0xf7537e82UL, 6);
+    STEP(I, d, a, b, c, x[11], 0xbd3af235UL, 10);
+    STEP(I, c, d, a, b, x[2], 0x2ad7d2bbUL, 15);
+    STEP(I, b, c, d, a, x[9], 0xeb86d391UL, 21);
+
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+  }
+}
+
+#undef STEP
+#undef F
+#undef G
+#undef H
+#undef I
+
+void Md5Init(Md5State *state)
+{
+  Impl::Init(state, kIV);
+}
+
+void Md5Update(Md5State *state, const uint8_t *data, size_t length)
+{
+  Impl::Update(state, data, length, Compress);
+}
+
+void Md5Final(const Md5State *state, uint8_t *out)
+{
+  Impl::Final(state, out, Compress);
+}
+
+} // namespace md
+} // namespace nodecrypto
@@ -0,0 +1,121 @@
+#ifndef __CRYPTO_MD_IMPL_H_
+#define __CRYPTO_MD_IMPL_H_
+
+// Merkle-Damgard construction shared by the digests, they only differ in the compression function,
+// the size of words and blocks and the byte order of words and of the length.
+
+#include "md.h"
+
+#include <string.h>
+
+namespace nodecrypto
+{
+namespace md
+{
+
+inline uint32_t RotateLeft(uint32_t w, unsigned bits)
+{
+  return (w << bits) | (w >> (32 - bits));
+}
+
+inline uint64_t RotateRight64(uint64_t w, unsigned bits)
+{
+  return (w >> bits) | (w << (64 - bits));
+}
+
+inline uint32_t LoadBE32(const uint8_t *p)
+{
+  return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+         (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+inline uint64_t LoadBE64(const uint8_t *p)
+{
+  return (static_cast<uint64_t>(LoadBE32(p)) << 32) | LoadBE32(p + 4);
+}
+
+inline uint32_t LoadLE32(const uint8_t *p)
+{
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+template <typename Word, size_t Words, size_t BlockBytes, bool BigEndian>
+struct MerkleDamgard
+{
+  typedef State<Word, Words, BlockBytes> StateType;
+  // compresses a run of whole blocks, so SIMD kernels keep the state in registers between them
+  typedef void (*CompressFn)(Word *h, const uint8_t *blocks, size_t count);
+
+  // the message length in bits ends the last block, SHA-512 reserves 16 bytes for it
+  static const size_t kLengthBytes = BlockBytes / 8;
+
+  static void Init(StateType *state, const Word iv[Words])
+  {
+    memcpy(state->h, iv, sizeof(state->h));
+    state->length = 0;
+    state->buflen = 0;
+  }
+
+  static void Update(StateType *state, const uint8_t *data, size_t length, CompressFn compress)
+  {
+    state->length += length;
+    if (state->buflen > 0)
+    {
+      size_t fill = BlockBytes - state->buflen;
+      if (length < fill)
+      {
+        memcpy(state->buf + state->buflen, data, length);
+        state->buflen += length;
+        return;
+      }
+      memcpy(state->buf + state->buflen, data, fill);
+      compress(state->h, state->buf, 1);
+      state->buflen = 0;
+      data += fill;
+      length -= fill;
+    }
+    if (length >= BlockBytes)
+    {
+      compress(state->h, data, length / BlockBytes);
+      data += length & ~(BlockBytes - 1);
+      length &= BlockBytes - 1;
+    }
+    memcpy(state->buf, data, length);
+    state->buflen = length;
+  }
+
+  static void Final(const StateType *current, uint8_t *out, CompressFn compress)
+  {
+    StateType state = *current;
+    uint64_t bits = state.length * 8;
+
+    state.buf[state.buflen++] = 0x80;
+    if (state.buflen > BlockBytes - kLengthBytes)
+    {
+      memset(state.buf + state.buflen, 0, BlockBytes - state.buflen);
+      compress(state.h, state.buf, 1);
+      state.buflen = 0;
+    }
+    memset(state.buf + state.buflen, 0, BlockBytes - state.buflen);
+    for (int i = 0; i < 8; i++)
+    {
+      state.buf[BigEndian ? BlockBytes - 1 - i : BlockBytes - kLengthBytes + i] = static_cast<uint8_t>(bits >> (8 * i));
+    }
+    compress(state.h, state.buf, 1);
+
+    for (size_t i = 0; i < Words; i++)
+    {
+      for (size_t j = 0; j < sizeof(Word); j++)
+      {
+        size_t shift = BigEndian ? 8 * (sizeof(Word) - 1 - j) : 8 * j;
+        out[sizeof(Word) * i + j] = static_cast<uint8_t>(state.h[i] >> shift);
+      }
+    }
+  }
+};
+
+} // namespace md
+} // namespace nodecrypto
+
+#endif // __CRYPTO_MD_IMPL_H_
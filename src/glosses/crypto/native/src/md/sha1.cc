@@ -0,0 +1,250 @@
+#include "md_impl.h"
+#include "cpu.h"
+
+#include <atomic>
+
+namespace nodecrypto
+{
+namespace md
+{
+
+static const uint32_t kIV[5] = {0x67452301UL, 0xEFCDAB89UL, 0x98BADCFEUL, 0x10325476UL, 0xC3D2E1F0UL};
+
+typedef MerkleDamgard<uint32_t, 5, 64, true> Impl;
+
+#define ROUND(a, b, c, d, e, f, k, w)              \
+  do                                               \
+  {                                                \
+    e += RotateLeft(a, 5) + (f) + (k) + (w);       \
+    b = RotateLeft(b, 30);                         \
+  } while (0)
+
+#define F1(b, c, d) ((d) ^ ((b) & ((c) ^ (d))))
+#define F2(b, c, d) ((b) ^ (c) ^ (d))
+#define F3(b, c, d) (((b) & (c)) | ((d) & ((b) | (c))))
+
+// the message schedule is kept in a 16-word ring
+#define W(i) (w[(i) & 15] = RotateLeft(w[((i) + 13) & 15] ^ w[((i) + 8) & 15] ^ w[((i) + 2) & 15] ^ w[(i) & 15], 1))
+
+// five rounds rotate the variables back into place
+#define ROUNDS5(i, f, k, next)                              \
+  do                                                        \
+  {                                                         \
+    ROUND(a, b, c, d, e, f(b, c, d), k, next(i));           \
+    ROUND(e, a, b, c, d, f(a, b, c), k, next(i + 1));       \
+    ROUND(d, e, a, b, c, f(e, a, b), k, next(i + 2));       \
+    ROUND(c, d, e, a, b, f(d, e, a), k, next(i + 3));       \
+    ROUND(b, c, d, e, a, f(c, d, e), k, next(i + 4));       \
+  } while (0)
+
+#define LOADED(i) w[i]
+
+static void CompressScalar(uint32_t *h, const uint8_t *blocks, size_t count)
+{
+  uint32_t w[16];
+  for (; count > 0; count--, blocks += 64)
+  {
+    for (int i = 0; i < 16; i++)
+    {
+      w[i] = LoadBE32(blocks + 4 * i);
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+
+    ROUNDS5(0, F1, 0x5A827999UL, LOADED);
+    ROUNDS5(5, F1, 0x5A827999UL, LOADED);
+    ROUNDS5(10, F1, 0x5A827999UL, LOADED);
+    ROUND(a, b, c, d, e, F1(b, c, d), 0x5A827999UL, w[15]);
+    ROUND(e, a, b, c, d, F1(a, b, c), 0x5A827999UL, W(16));
+    ROUND(d, e, a, b, c, F1(e, a, b), 0x5A827999UL, W(17));
+    ROUND(c, d, e, a, b, F1(d, e, a), 0x5A827999UL, W(18));
+    ROUND(b, c, d, e, a, F1(c, d, e), 0x5A827999UL, W(19));
+
+    ROUNDS5(20, F2, 0x6ED9EBA1UL, W);
+    ROUNDS5(25, F2, 0x6ED9EBA1UL, W);
+    ROUNDS5(30, F2, 0x6ED9EBA1UL, W);
+    ROUNDS5(35, F2, 0x6ED9EBA1UL, W);
+
+    ROUNDS5(40, F3, 0x8F1BBCDCUL, W);
+    ROUNDS5(45, F3, 0x8F1BBCDCUL, W);
+    ROUNDS5(50, F3, 0x8F1BBCDCUL, W);
+    ROUNDS5(55, F3, 0x8F1BBCDCUL, W);
+
+    ROUNDS5(60, F2, 0xCA62C1D6UL, W);
+    ROUNDS5(65, F2, 0xCA62C1D6UL, W);
+    ROUNDS5(70, F2, 0xCA62C1D6UL, W);
+    ROUNDS5(75, F2, 0xCA62C1D6UL, W);
+
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+}
+
+#undef LOADED
+#undef ROUNDS5
+#undef W
+#undef F1
+#undef F2
+#undef F3
+#undef ROUND
+
+#if defined(CRYPTO_X86)
+
+// Four rounds per sha1rnds4, the message schedule is computed four words at a time by
+// sha1msg1/sha1msg2 interleaved with the rounds.
+#define QUAD(ea, eb, cur, next, next2, prev, f)   \
+  do                                              \
+  {                                               \
+    ea = _mm_sha1nexte_epu32(ea, cur);            \
+    eb = abcd;                                    \
+    next = _mm_sha1msg2_epu32(next, cur);         \
+    abcd = _mm_sha1rnds4_epu32(abcd, ea, f);      \
+    prev = _mm_sha1msg1_epu32(prev, cur);         \
+    next2 = _mm_xor_si128(next2, cur);            \
+  } while (0)
+
+CRYPTO_TARGET("sha,sse4.1")
+static void CompressSHANI(uint32_t *h, const uint8_t *blocks, size_t count)
+{
+  const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+  __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(h)), 0x1B);
+  __m128i e0 = _mm_set_epi32(static_cast<int>(h[4]), 0, 0, 0);
+  __m128i e1, msg0, msg1, msg2, msg3;
+
+  for (; count > 0; count--, blocks += 64)
+  {
+    const __m128i abcdSaved = abcd;
+    const __m128i eSaved = e0;
+
+    // rounds 0-3
+    msg0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 0)), mask);
+    e0 = _mm_add_epi32(e0, msg0);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+
+    // rounds 4-7
+    msg1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 16)), mask);
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 0);
+    msg0 = _mm_sha1msg1_epu32(msg0, msg1);
+
+    // rounds 8-11
+    msg2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 32)), mask);
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 0);
+    msg1 = _mm_sha1msg1_epu32(msg1, msg2);
+    msg0 = _mm_xor_si128(msg0, msg2);
+
+    // rounds 12-67
+    msg3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 48)), mask);
+    QUAD(e1, e0, msg3, msg0, msg1, msg2, 0);
+    QUAD(e0, e1, msg0, msg1, msg2, msg3, 0);
+    QUAD(e1, e0, msg1, msg2, msg3, msg0, 1);
+    QUAD(e0, e1, msg2, msg3, msg0, msg1, 1);
+    QUAD(e1, e0, msg3, msg0, msg1, msg2, 1);
+    QUAD(e0, e1, msg0, msg1, msg2, msg3, 1);
+    QUAD(e1, e0, msg1, msg2, msg3, msg0, 1);
+    QUAD(e0, e1, msg2, msg3, msg0, msg1, 2);
+    QUAD(e1, e0, msg3, msg0, msg1, msg2, 2);
+    QUAD(e0, e1, msg0, msg1, msg2, msg3, 2);
+    QUAD(e1, e0, msg1, msg2, msg3, msg0, 2);
+    QUAD(e0, e1, msg2, msg3, msg0, msg1, 2);
+    QUAD(e1, e0, msg3, msg0, msg1, msg2, 3);
+    QUAD(e0, e1, msg0, msg1, msg2, msg3, 3);
+
+    // rounds 68-71
+    e1 = _mm_sha1nexte_epu32(e1, msg1);
+    e0 = abcd;
+    msg2 = _mm_sha1msg2_epu32(msg2, msg1);
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+    msg3 = _mm_xor_si128(msg3, msg1);
+
+    // rounds 72-75
+    e0 = _mm_sha1nexte_epu32(e0, msg2);
+    e1 = abcd;
+    msg3 = _mm_sha1msg2_epu32(msg3, msg2);
+    abcd = _mm_sha1rnds4_epu32(abcd, e0, 3);
+
+    // rounds 76-79
+    e1 = _mm_sha1nexte_epu32(e1, msg3);
+    e0 = abcd;
+    abcd = _mm_sha1rnds4_epu32(abcd, e1, 3);
+
+    e0 = _mm_sha1nexte_epu32(e0, eSaved);
+    abcd = _mm_add_epi32(abcd, abcdSaved);
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(h), _mm_shuffle_epi32(abcd, 0x1B));
+  h[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+#undef QUAD
+
+#endif // CRYPTO_X86
+
+Kernel GetBestSha1Kernel()
+{
+  const CpuFeatures &cpu = GetCpuFeatures();
+  return cpu.sha && cpu.sse41 ? kKernelSHANI : kKernelScalar;
+}
+
+static std::atomic<int> kernel(-1);
+
+Kernel GetSha1Kernel()
+{
+  int current = kernel.load(std::memory_order_relaxed);
+  if (current < 0)
+  {
+    current = GetBestSha1Kernel();
+    kernel.store(current, std::memory_order_relaxed);
+  }
+  return static_cast<Kernel>(current);
+}
+
+bool SetSha1Kernel(Kernel value)
+{
+  if (value == kKernelSHANI && GetBestSha1Kernel() != kKernelSHANI)
+  {
+    return false;
+  }
+  kernel.store(value, std::memory_order_relaxed);
+  return true;
+}
+
+const char *KernelName(Kernel value)
+{
+  return value == kKernelSHANI ? "sha-ni" : "scalar";
+}
+
+Compress32Fn GetSha1Compress()
+{
+#if defined(CRYPTO_X86)
+  if (GetSha1Kernel() == kKernelSHANI)
+  {
+    return CompressSHANI;
+  }
+#endif
+  return CompressScalar;
+}
+
+void Sha1Init(Sha1State *state)
+{
+  Impl::Init(state, kIV);
+}
+
+void Sha1Update(Sha1State *state, const uint8_t *data, size_t length)
+{
+  Impl::Update(state, data, length, GetSha1Compress());
+}
+
+void Sha1Final(const Sha1State *state, uint8_t *out)
+{
+  Impl::Final(state, out, GetSha1Compress());
+}
+
+} // namespace md
+} // namespace nodecrypto
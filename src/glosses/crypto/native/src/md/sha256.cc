@@ -0,0 +1,228 @@
+#include "md_impl.h"
+#include "cpu.h"
+
+#include <atomic>
+
+namespace nodecrypto
+{
+namespace md
+{
+
+static const uint32_t kIV[8] = {
+    0x6a09e667UL, 0xbb67ae85UL, 0x3c6ef372UL, 0xa54ff53aUL,
+    0x510e527fUL, 0x9b05688cUL, 0x1f83d9abUL, 0x5be0cd19UL};
+
+static const uint32_t kK[64] = {
+    0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL,
+    0x3956c25bUL, 0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL,
+    0xd807aa98UL, 0x12835b01UL, 0x243185beUL, 0x550c7dc3UL,
+    0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL, 0xc19bf174UL,
+    0xe49b69c1UL, 0xefbe4786UL, 0x0fc19dc6UL, 0x240ca1ccUL,
+    0x2de92c6fUL, 0x4a7484aaUL, 0x5cb0a9dcUL, 0x76f988daUL,
+    0x983e5152UL, 0xa831c66dUL, 0xb00327c8UL, 0xbf597fc7UL,
+    0xc6e00bf3UL, 0xd5a79147UL, 0x06ca6351UL, 0x14292967UL,
+    0x27b70a85UL, 0x2e1b2138UL, 0x4d2c6dfcUL, 0x53380d13UL,
+    0x650a7354UL, 0x766a0abbUL, 0x81c2c92eUL, 0x92722c85UL,
+    0xa2bfe8a1UL, 0xa81a664bUL, 0xc24b8b70UL, 0xc76c51a3UL,
+    0xd192e819UL, 0xd6990624UL, 0xf40e3585UL, 0x106aa070UL,
+    0x19a4c116UL, 0x1e376c08UL, 0x2748774cUL, 0x34b0bcb5UL,
+    0x391c0cb3UL, 0x4ed8aa4aUL, 0x5b9cca4fUL, 0x682e6ff3UL,
+    0x748f82eeUL, 0x78a5636fUL, 0x84c87814UL, 0x8cc70208UL,
+    0x90befffaUL, 0xa4506cebUL, 0xbef9a3f7UL, 0xc67178f2UL};
+
+typedef MerkleDamgard<uint32_t, 8, 64, true> Impl;
+
+inline uint32_t RotateRight(uint32_t w, unsigned bits)
+{
+  return (w >> bits) | (w << (32 - bits));
+}
+
+#define CH(x, y, z) ((z) ^ ((x) & ((y) ^ (z))))
+#define MAJ(x, y, z) (((x) & (y)) | ((z) & ((x) | (y))))
+#define SIGMA0(x) (RotateRight(x, 2) ^ RotateRight(x, 13) ^ RotateRight(x, 22))
+#define SIGMA1(x) (RotateRight(x, 6) ^ RotateRight(x, 11) ^ RotateRight(x, 25))
+#define GAMMA0(x) (RotateRight(x, 7) ^ RotateRight(x, 18) ^ ((x) >> 3))
+#define GAMMA1(x) (RotateRight(x, 17) ^ RotateRight(x, 19) ^ ((x) >> 10))
+
+static void CompressScalar(uint32_t *h, const uint8_t *blocks, size_t count)
+{
+  uint32_t w[64];
+  for (; count > 0; count--, blocks += 64)
+  {
+    for (int i = 0; i < 16; i++)
+    {
+      w[i] = LoadBE32(blocks + 4 * i);
+    }
+    for (int i = 16; i < 64; i++)
+    {
+      w[i] = GAMMA1(w[i - 2]) + w[i - 7] + GAMMA0(w[i - 15]) + w[i - 16];
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], hh = h[7];
+    for (int i = 0; i < 64; i++)
+    {
+      uint32_t t1 = hh + SIGMA1(e) + CH(e, f, g) + kK[i] + w[i];
+      uint32_t t2 = SIGMA0(a) + MAJ(a, b, c);
+      hh = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+    h[5] += f;
+    h[6] += g;
+    h[7] += hh;
+  }
+}
+
+#if defined(CRYPTO_X86)
+
+// Four rounds with the SHA extensions: `cur` holds the message words of these rounds, `next` gets
+// its missing terms and `prev` its first schedule step for the rounds 12 words later
+#define QUAD(i, prev, cur, next)                                                       \
+  do                                                                                   \
+  {                                                                                    \
+    msg = _mm_add_epi32(cur, _mm_loadu_si128(reinterpret_cast<const __m128i *>(kK + 4 * (i)))); \
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);                               \
+    next = _mm_add_epi32(next, _mm_alignr_epi8(cur, prev, 4));                         \
+    next = _mm_sha256msg2_epu32(next, cur);                                            \
+    state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));      \
+    prev = _mm_sha256msg1_epu32(prev, cur);                                            \
+  } while (0)
+
+#define ROUNDS4(i, cur)                                                                \
+  do                                                                                   \
+  {                                                                                    \
+    msg = _mm_add_epi32(cur, _mm_loadu_si128(reinterpret_cast<const __m128i *>(kK + 4 * (i)))); \
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);                               \
+    state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));      \
+  } while (0)
+
+CRYPTO_TARGET("sha,sse4.1")
+static void CompressSHANI(uint32_t *h, const uint8_t *blocks, size_t count)
+{
+  const __m128i mask = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  // the instructions want the state as ABEF and CDGH
+  __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(h)), 0xB1);
+  __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(h + 4)), 0x1B);
+  __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+  state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+  __m128i msg, msg0, msg1, msg2, msg3;
+
+  for (; count > 0; count--, blocks += 64)
+  {
+    const __m128i state0Saved = state0;
+    const __m128i state1Saved = state1;
+
+    msg0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 0)), mask);
+    msg1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 16)), mask);
+    msg2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 32)), mask);
+    msg3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(blocks + 48)), mask);
+
+    ROUNDS4(0, msg0);
+    ROUNDS4(1, msg1);
+    msg0 = _mm_sha256msg1_epu32(msg0, msg1);
+    ROUNDS4(2, msg2);
+    msg1 = _mm_sha256msg1_epu32(msg1, msg2);
+    QUAD(3, msg2, msg3, msg0);
+    QUAD(4, msg3, msg0, msg1);
+    QUAD(5, msg0, msg1, msg2);
+    QUAD(6, msg1, msg2, msg3);
+    QUAD(7, msg2, msg3, msg0);
+    QUAD(8, msg3, msg0, msg1);
+    QUAD(9, msg0, msg1, msg2);
+    QUAD(10, msg1, msg2, msg3);
+    QUAD(11, msg2, msg3, msg0);
+    QUAD(12, msg3, msg0, msg1);
+    // the last words need no more schedule steps
+    msg = _mm_add_epi32(msg1, _mm_loadu_si128(reinterpret_cast<const __m128i *>(kK + 52)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    msg2 = _mm_sha256msg2_epu32(_mm_add_epi32(msg2, _mm_alignr_epi8(msg1, msg0, 4)), msg1);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+    msg = _mm_add_epi32(msg2, _mm_loadu_si128(reinterpret_cast<const __m128i *>(kK + 56)));
+    state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+    msg3 = _mm_sha256msg2_epu32(_mm_add_epi32(msg3, _mm_alignr_epi8(msg2, msg1, 4)), msg2);
+    state0 = _mm_sha256rnds2_epu32(state0, state1, _mm_shuffle_epi32(msg, 0x0E));
+    ROUNDS4(15, msg3);
+
+    state0 = _mm_add_epi32(state0, state0Saved);
+    state1 = _mm_add_epi32(state1, state1Saved);
+  }
+
+  tmp = _mm_shuffle_epi32(state0, 0x1B);
+  state1 = _mm_shuffle_epi32(state1, 0xB1);
+  state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+  state1 = _mm_alignr_epi8(state1, tmp, 8);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(h), state0);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(h + 4), state1);
+}
+
+#undef QUAD
+#undef ROUNDS4
+
+#endif // CRYPTO_X86
+
+Kernel GetBestSha256Kernel()
+{
+  const CpuFeatures &cpu = GetCpuFeatures();
+  return cpu.sha && cpu.sse41 ? kKernelSHANI : kKernelScalar;
+}
+
+static std::atomic<int> kernel(-1);
+
+Kernel GetSha256Kernel()
+{
+  int current = kernel.load(std::memory_order_relaxed);
+  if (current < 0)
+  {
+    current = GetBestSha256Kernel();
+    kernel.store(current, std::memory_order_relaxed);
+  }
+  return static_cast<Kernel>(current);
+}
+
+bool SetSha256Kernel(Kernel value)
+{
+  if (value == kKernelSHANI && GetBestSha256Kernel() != kKernelSHANI)
+  {
+    return false;
+  }
+  kernel.store(value, std::memory_order_relaxed);
+  return true;
+}
+
+Compress32Fn GetSha256Compress()
+{
+#if defined(CRYPTO_X86)
+  if (GetSha256Kernel() == kKernelSHANI)
+  {
+    return CompressSHANI;
+  }
+#endif
+  return CompressScalar;
+}
+
+void Sha256Init(Sha256State *state)
+{
+  Impl::Init(state, kIV);
+}
+
+void Sha256Update(Sha256State *state, const uint8_t *data, size_t length)
+{
+  Impl::Update(state, data, length, GetSha256Compress());
+}
+
+void Sha256Final(const Sha256State *state, uint8_t *out)
+{
+  Impl::Final(state, out, GetSha256Compress());
+}
+
+} // namespace md
+} // namespace nodecrypto
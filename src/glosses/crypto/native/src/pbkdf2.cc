@@ -0,0 +1,261 @@
+#include "crypto.h"
+#include "pbkdf2/pbkdf2.h"
+
+#include <adone_pool.h>
+#include <adone_trace.h>
+
+#include <string.h> // memset
+
+#include <vector>
+
+namespace nodecrypto
+{
+
+struct Params
+{
+  uint32_t iterations;
+  size_t keyLength;
+  pbkdf2::Digest digest;
+
+  // Parses (iterations, keyLength, digest), throws and returns false on invalid values
+  bool Parse(v8::Local<v8::Value> iterationsValue, v8::Local<v8::Value> keyLengthValue, v8::Local<v8::Value> digestValue)
+  {
+    double value = Nan::To<double>(iterationsValue).FromMaybe(0);
+    if (!(value >= 1 && value <= 0xFFFFFFFF) || value != static_cast<double>(static_cast<uint32_t>(value)))
+    {
+      Nan::ThrowError("Iteration count must be a positive 32-bit integer");
+      return false;
+    }
+    iterations = static_cast<uint32_t>(value);
+
+    value = Nan::To<double>(keyLengthValue).FromMaybe(-1);
+    if (!(value >= 0 && value <= 0x3FFFFFFF) || value != static_cast<double>(static_cast<uint32_t>(value)))
+    {
+      Nan::ThrowError("Invalid key length");
+      return false;
+    }
+    keyLength = static_cast<size_t>(value);
+
+    Nan::Utf8String name(digestValue);
+    if (*name == NULL || !pbkdf2::ParseDigest(*name, &digest))
+    {
+      Nan::ThrowError("Unsupported digest, expected sha1, sha256 or sha512");
+      return false;
+    }
+    return true;
+  }
+};
+
+// A password and its salt, copied so that the caller can reuse the buffers right away
+struct Secret
+{
+  std::vector<uint8_t> password;
+  std::vector<uint8_t> salt;
+
+  ~Secret()
+  {
+    if (!password.empty())
+    {
+      memset(password.data(), 0, password.size());
+    }
+  }
+};
+
+// Keys derived in parallel, one pool task per key. The tasks complete on the JS thread, the last one
+// calls back with all the keys concatenated.
+class Batch
+{
+public:
+  Batch(std::vector<Secret> &secrets, const Params &params, Nan::Callback *callback)
+      : params(params), remaining(secrets.size()), queued_at(uv_hrtime()),
+        dst(adone::GetBufferPool(), secrets.size() * params.keyLength),
+        callback(callback), async_resource(new Nan::AsyncResource("crypto:pbkdf2"))
+  {
+    this->secrets.swap(secrets);
+  }
+
+  ~Batch()
+  {
+    delete callback;
+    delete async_resource;
+  }
+
+  bool Allocated() const
+  {
+    return dst.Data() != NULL;
+  }
+
+  void Derive(size_t index)
+  {
+    ADONE_TRACE_SPAN("crypto", "pbkdf2:queued", queued_at);
+    ADONE_TRACE_SCOPE("crypto", "pbkdf2:derive");
+    const Secret &secret = secrets[index];
+    pbkdf2::Derive(params.digest, secret.password.data(), secret.password.size(), secret.salt.data(), secret.salt.size(),
+                   params.iterations, reinterpret_cast<uint8_t *>(dst.Data()) + index * params.keyLength, params.keyLength);
+  }
+
+  // Returns true when the batch is done and can be deleted
+  bool Complete()
+  {
+    if (--remaining > 0)
+    {
+      return false;
+    }
+    Nan::HandleScope scope;
+    v8::Local<v8::Value> argv[] = {Nan::Null(), dst.ToBuffer()};
+    callback->Call(2, argv, async_resource);
+    return true;
+  }
+
+private:
+  std::vector<Secret> secrets;
+  Params params;
+  size_t remaining;
+  uint64_t queued_at;
+  adone::PooledBuffer dst;
+  Nan::Callback *callback;
+  Nan::AsyncResource *async_resource;
+};
+
+class DeriveTask : public adone::PoolTask
+{
+public:
+  DeriveTask(Batch *batch, size_t index) : batch(batch), index(index) {}
+
+  void Execute()
+  {
+    batch->Derive(index);
+  }
+
+  void Complete()
+  {
+    if (batch->Complete())
+    {
+      delete batch;
+    }
+  }
+
+private:
+  Batch *batch;
+  size_t index;
+};
+
+static bool CopyBytes(v8::Local<v8::Value> value, std::vector<uint8_t> *bytes, const char *error)
+{
+  const uint8_t *data;
+  size_t length;
+  if (!GetBytes(value, &data, &length))
+  {
+    Nan::ThrowTypeError(error);
+    return false;
+  }
+  bytes->assign(data, data + length);
+  return true;
+}
+
+static void Submit(std::vector<Secret> &secrets, const Params &params, v8::Local<v8::Value> callback)
+{
+  size_t count = secrets.size();
+  Batch *batch = new Batch(secrets, params, new Nan::Callback(callback.As<v8::Function>()));
+  if (!batch->Allocated())
+  {
+    delete batch;
+    return Nan::ThrowError("Out of memory");
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    adone::QueueWorker(new DeriveTask(batch, i));
+  }
+}
+
+// pbkdf2(password, salt, iterations, keyLength, digest, callback)
+NAN_METHOD(Pbkdf2)
+{
+  std::vector<Secret> secrets(1);
+  Params params;
+  if (!CopyBytes(info[0], &secrets[0].password, "Password must be a Buffer or an Uint8Array") ||
+      !CopyBytes(info[1], &secrets[0].salt, "Salt must be a Buffer or an Uint8Array") ||
+      !params.Parse(info[2], info[3], info[4]))
+  {
+    return;
+  }
+  if (!info[5]->IsFunction())
+  {
+    return Nan::ThrowTypeError("Callback must be a function");
+  }
+  Submit(secrets, params, info[5]);
+}
+
+// pbkdf2Sync(password, salt, iterations, keyLength, digest)
+NAN_METHOD(Pbkdf2Sync)
+{
+  ADONE_TRACE_SCOPE("crypto", "pbkdf2:deriveSync");
+  const uint8_t *password, *salt;
+  size_t passwordLength, saltLength;
+  Params params;
+  if (!GetBytes(info[0], &password, &passwordLength))
+  {
+    return Nan::ThrowTypeError("Password must be a Buffer or an Uint8Array");
+  }
+  if (!GetBytes(info[1], &salt, &saltLength))
+  {
+    return Nan::ThrowTypeError("Salt must be a Buffer or an Uint8Array");
+  }
+  if (!params.Parse(info[2], info[3], info[4]))
+  {
+    return;
+  }
+  adone::PooledBuffer dst(adone::GetBufferPool(), params.keyLength);
+  if (dst.Data() == NULL)
+  {
+    return Nan::ThrowError("Out of memory");
+  }
+  pbkdf2::Derive(params.digest, password, passwordLength, salt, saltLength, params.iterations,
+                 reinterpret_cast<uint8_t *>(dst.Data()), params.keyLength);
+  info.GetReturnValue().Set(dst.ToBuffer());
+}
+
+// pbkdf2Batch(passwords, salts, iterations, keyLength, digest, callback), the keys are derived in
+// parallel and returned concatenated into a single buffer
+NAN_METHOD(Pbkdf2Batch)
+{
+  if (!info[0]->IsArray() || !info[1]->IsArray())
+  {
+    return Nan::ThrowTypeError("Passwords and salts must be arrays");
+  }
+  v8::Local<v8::Array> passwords = info[0].As<v8::Array>();
+  v8::Local<v8::Array> salts = info[1].As<v8::Array>();
+  uint32_t count = passwords->Length();
+  if (count == 0 || salts->Length() != count)
+  {
+    return Nan::ThrowError("Passwords and salts must be non-empty arrays of the same length");
+  }
+  std::vector<Secret> secrets(count);
+  for (uint32_t i = 0; i < count; i++)
+  {
+    if (!CopyBytes(Nan::Get(passwords, i).ToLocalChecked(), &secrets[i].password, "Passwords must be Buffers or Uint8Arrays") ||
+        !CopyBytes(Nan::Get(salts, i).ToLocalChecked(), &secrets[i].salt, "Salts must be Buffers or Uint8Arrays"))
+    {
+      return;
+    }
+  }
+  Params params;
+  if (!params.Parse(info[2], info[3], info[4]))
+  {
+    return;
+  }
+  if (!info[5]->IsFunction())
+  {
+    return Nan::ThrowTypeError("Callback must be a function");
+  }
+  Submit(secrets, params, info[5]);
+}
+
+NAN_MODULE_INIT(InitPbkdf2)
+{
+  Nan::SetMethod(target, "pbkdf2", Pbkdf2);
+  Nan::SetMethod(target, "pbkdf2Sync", Pbkdf2Sync);
+  Nan::SetMethod(target, "pbkdf2Batch", Pbkdf2Batch);
+}
+
+} // namespace nodecrypto
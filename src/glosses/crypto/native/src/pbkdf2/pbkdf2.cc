@@ -0,0 +1,196 @@
+#include "pbkdf2.h"
+#include "md/md.h"
+
+#include <string.h>
+
+namespace nodecrypto
+{
+namespace pbkdf2
+{
+
+struct Sha1
+{
+  typedef uint32_t Word;
+  typedef md::Sha1State State;
+  typedef md::Compress32Fn CompressFn;
+  static const size_t kBlockBytes = 64;
+  static const size_t kDigestBytes = md::kSha1DigestBytes;
+
+  static void Init(State *state) { md::Sha1Init(state); }
+  static void Update(State *state, const uint8_t *data, size_t length) { md::Sha1Update(state, data, length); }
+  static void Final(const State *state, uint8_t *out) { md::Sha1Final(state, out); }
+  static CompressFn Compress() { return md::GetSha1Compress(); }
+};
+
+struct Sha256
+{
+  typedef uint32_t Word;
+  typedef md::Sha256State State;
+  typedef md::Compress32Fn CompressFn;
+  static const size_t kBlockBytes = 64;
+  static const size_t kDigestBytes = md::kSha256DigestBytes;
+
+  static void Init(State *state) { md::Sha256Init(state); }
+  static void Update(State *state, const uint8_t *data, size_t length) { md::Sha256Update(state, data, length); }
+  static void Final(const State *state, uint8_t *out) { md::Sha256Final(state, out); }
+  static CompressFn Compress() { return md::GetSha256Compress(); }
+};
+
+struct Sha512
+{
+  typedef uint64_t Word;
+  typedef md::Sha512State State;
+  typedef md::Compress64Fn CompressFn;
+  static const size_t kBlockBytes = 128;
+  static const size_t kDigestBytes = md::kSha512DigestBytes;
+
+  static void Init(State *state) { md::Sha512Init(state); }
+  static void Update(State *state, const uint8_t *data, size_t length) { md::Sha512Update(state, data, length); }
+  static void Final(const State *state, uint8_t *out) { md::Sha512Final(state, out); }
+  static CompressFn Compress() { return md::GetSha512Compress(); }
+};
+
+template <typename Word>
+static inline void StoreWords(uint8_t *out, const Word *words, size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+  {
+    for (size_t j = 0; j < sizeof(Word); j++)
+    {
+      out[sizeof(Word) * i + j] = static_cast<uint8_t>(words[i] >> (8 * (sizeof(Word) - 1 - j)));
+    }
+  }
+}
+
+template <typename Hash>
+static void DeriveWith(const uint8_t *password, size_t passwordLength, const uint8_t *salt, size_t saltLength,
+                       uint32_t iterations, uint8_t *out, size_t outLength)
+{
+  typedef typename Hash::Word Word;
+  static const size_t kBlockBytes = Hash::kBlockBytes;
+  static const size_t kDigestBytes = Hash::kDigestBytes;
+  static const size_t kWords = kDigestBytes / sizeof(Word);
+  typename Hash::CompressFn compress = Hash::Compress();
+  typename Hash::State inner, outer, state;
+
+  // HMAC key, hashed if it is longer than a block
+  uint8_t key[kBlockBytes] = {0};
+  if (passwordLength > kBlockBytes)
+  {
+    Hash::Init(&state);
+    Hash::Update(&state, password, passwordLength);
+    Hash::Final(&state, key);
+  }
+  else if (passwordLength > 0)
+  {
+    memcpy(key, password, passwordLength);
+  }
+  uint8_t pad[kBlockBytes];
+  for (size_t i = 0; i < kBlockBytes; i++)
+  {
+    pad[i] = key[i] ^ 0x36;
+  }
+  Hash::Init(&inner);
+  Hash::Update(&inner, pad, kBlockBytes);
+  for (size_t i = 0; i < kBlockBytes; i++)
+  {
+    pad[i] = key[i] ^ 0x5C;
+  }
+  Hash::Init(&outer);
+  Hash::Update(&outer, pad, kBlockBytes);
+
+  // the padded block of a digest-sized message that follows the key block, the digest is
+  // written in place by every iteration
+  uint8_t block[kBlockBytes] = {0};
+  block[kDigestBytes] = 0x80;
+  uint64_t bits = (kBlockBytes + kDigestBytes) * 8;
+  for (int i = 0; i < 8; i++)
+  {
+    block[kBlockBytes - 1 - i] = static_cast<uint8_t>(bits >> (8 * i));
+  }
+
+  Word h[kWords];
+  uint8_t u[kDigestBytes], t[kDigestBytes];
+  for (uint32_t index = 1; outLength > 0; index++)
+  {
+    // U_1 = PRF(P, S || INT(i))
+    uint8_t be[4] = {static_cast<uint8_t>(index >> 24), static_cast<uint8_t>(index >> 16), static_cast<uint8_t>(index >> 8), static_cast<uint8_t>(index)};
+    state = inner;
+    Hash::Update(&state, salt, saltLength);
+    Hash::Update(&state, be, 4);
+    Hash::Final(&state, u);
+    state = outer;
+    Hash::Update(&state, u, kDigestBytes);
+    Hash::Final(&state, u);
+    memcpy(t, u, kDigestBytes);
+
+    // U_j = PRF(P, U_{j-1})
+    memcpy(block, u, kDigestBytes);
+    for (uint32_t j = 2; j <= iterations; j++)
+    {
+      memcpy(h, inner.h, sizeof(h));
+      compress(h, block, 1);
+      StoreWords(block, h, kWords);
+      memcpy(h, outer.h, sizeof(h));
+      compress(h, block, 1);
+      StoreWords(block, h, kWords);
+      for (size_t k = 0; k < kDigestBytes; k++)
+      {
+        t[k] ^= block[k];
+      }
+    }
+
+    size_t n = outLength < kDigestBytes ? outLength : kDigestBytes;
+    memcpy(out, t, n);
+    out += n;
+    outLength -= n;
+  }
+
+  memset(key, 0, sizeof(key));
+  memset(pad, 0, sizeof(pad));
+  memset(block, 0, sizeof(block));
+  memset(&inner, 0, sizeof(inner));
+  memset(&outer, 0, sizeof(outer));
+  memset(&state, 0, sizeof(state));
+}
+
+bool ParseDigest(const char *name, Digest *digest)
+{
+  if (strcmp(name, "sha1") == 0)
+  {
+    *digest = kDigestSha1;
+  }
+  else if (strcmp(name, "sha256") == 0)
+  {
+    *digest = kDigestSha256;
+  }
+  else if (strcmp(name, "sha512") == 0)
+  {
+    *digest = kDigestSha512;
+  }
+  else
+  {
+    return false;
+  }
+  return true;
+}
+
+void Derive(Digest digest, const uint8_t *password, size_t passwordLength, const uint8_t *salt, size_t saltLength,
+            uint32_t iterations, uint8_t *out, size_t outLength)
+{
+  switch (digest)
+  {
+  case kDigestSha1:
+    DeriveWith<Sha1>(password, passwordLength, salt, saltLength, iterations, out, outLength);
+    break;
+  case kDigestSha256:
+    DeriveWith<Sha256>(password, passwordLength, salt, saltLength, iterations, out, outLength);
+    break;
+  case kDigestSha512:
+    DeriveWith<Sha512>(password, passwordLength, salt, saltLength, iterations, out, outLength);
+    break;
+  }
+}
+
+} // namespace pbkdf2
+} // namespace nodecrypto
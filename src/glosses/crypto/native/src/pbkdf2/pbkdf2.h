@@ -0,0 +1,33 @@
+#ifndef __CRYPTO_PBKDF2_H_
+#define __CRYPTO_PBKDF2_H_
+
+// PBKDF2 (RFC 8018) with HMAC-SHA1, HMAC-SHA256 and HMAC-SHA512.
+//
+// The HMAC keys are absorbed once, every iteration then costs two compressions of precomputed
+// blocks, using the same kernels as the digests (md.h).
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace nodecrypto
+{
+namespace pbkdf2
+{
+
+enum Digest
+{
+  kDigestSha1 = 0,
+  kDigestSha256 = 1,
+  kDigestSha512 = 2
+};
+
+// Returns false if the name is not one of "sha1", "sha256" and "sha512"
+bool ParseDigest(const char *name, Digest *digest);
+
+void Derive(Digest digest, const uint8_t *password, size_t passwordLength, const uint8_t *salt, size_t saltLength,
+            uint32_t iterations, uint8_t *out, size_t outLength);
+
+} // namespace pbkdf2
+} // namespace nodecrypto
+
+#endif // __CRYPTO_PBKDF2_H_
@@ -0,0 +1,133 @@
+const {
+    is,
+    crypto
+} = adone;
+
+const toBuffer = (bytes) => Buffer.from(bytes, "binary");
+
+// Converts an IV given in any of the forms accepted by the JavaScript modes (binary string,
+// array of bytes, byte buffer or array of 32-bit words) into a Buffer
+const ivToBuffer = function (iv) {
+    if (is.string(iv)) {
+        return toBuffer(iv.slice(0, 16));
+    }
+    if (iv instanceof Uint8Array) {
+        return Buffer.from(iv.buffer, iv.byteOffset, iv.byteLength);
+    }
+    if (crypto.util.isArray(iv)) {
+        if (iv.length > 4) {
+            return Buffer.from(iv);
+        }
+        const buf = Buffer.alloc(iv.length * 4);
+        for (let i = 0; i < iv.length; ++i) {
+            buf.writeUInt32BE(iv[i] >>> 0, i * 4);
+        }
+        return buf;
+    }
+    // consumed from the byte buffer, as the JavaScript modes do
+    return toBuffer(iv.getBytes(16));
+};
+
+/**
+ * Creates a cipher mode backed by the native AES (addon.Aes), used by crypto.aes.Algorithm
+ * in place of the modes of cipher_modes.js.
+ *
+ * It has the same API as those modes, but every call ciphers all the input that is buffered,
+ * instead of a single block.
+ *
+ * @param Aes the native cipher class.
+ * @param name the name of the mode: ECB, CBC, CFB, OFB, CTR or GCM.
+ */
+export const NativeMode = function (Aes, name) {
+    this.name = name;
+    this.blockSize = 16;
+    this._Aes = Aes;
+    this._cipher = null;
+    if (name === "ECB" || name === "CBC") {
+        // PKCS#7 padding of the JavaScript modes
+        this.pad = crypto.cipher.modes.cbc.prototype.pad;
+        this.unpad = crypto.cipher.modes.cbc.prototype.unpad;
+    } else if (name === "GCM") {
+        this.afterFinish = gcmAfterFinish;
+        this.tag = null;
+    }
+};
+
+/**
+ * Expands the key, called once by Algorithm.initialize().
+ *
+ * @param key the key as an array of 4, 6 or 8 32-bit words.
+ * @param decrypt true to decrypt, false to encrypt.
+ */
+NativeMode.prototype.setKey = function (key, decrypt) {
+    const buf = Buffer.alloc(key.length * 4);
+    for (let i = 0; i < key.length; ++i) {
+        buf.writeUInt32BE(key[i] >>> 0, i * 4);
+    }
+    this._cipher = new this._Aes(this.name, buf, Boolean(decrypt));
+    buf.fill(0);
+};
+
+NativeMode.prototype.start = function (options) {
+    switch (this.name) {
+        case "ECB":
+            this._cipher.start();
+            return;
+        case "GCM": {
+            if (!("iv" in options)) {
+                throw new Error("Invalid IV parameter.");
+            }
+            const iv = crypto.util.createBuffer(options.iv).bytes();
+            const additionalData = "additionalData" in options
+                ? crypto.util.createBuffer(options.additionalData).bytes()
+                : "";
+            this._tagLength = "tagLength" in options ? options.tagLength : 128;
+            this._tag = null;
+            if (options.decrypt) {
+                // save tag to check later
+                this._tag = crypto.util.createBuffer(options.tag).getBytes();
+                if (this._tag.length !== (this._tagLength / 8)) {
+                    throw new Error("Authentication tag does not match tag length.");
+                }
+            }
+            this.tag = null;
+            this._cipher.start(toBuffer(iv), toBuffer(additionalData));
+            return;
+        }
+        case "CBC":
+            // Note: legacy support for using IV residue (has security flaws)
+            if (is.null(options.iv)) {
+                this._cipher.start();
+                return;
+            }
+        // falls through
+        default:
+            if (!("iv" in options)) {
+                throw new Error("Invalid IV parameter.");
+            }
+            this._cipher.start(ivToBuffer(options.iv));
+    }
+};
+
+NativeMode.prototype.encrypt = function (input, output) {
+    let length = input.length();
+    if (this.name === "ECB" || this.name === "CBC") {
+        length -= length % this.blockSize;
+    }
+    if (length > 0) {
+        output.putBytes(this._cipher.update(toBuffer(input.getBytes(length))).toString("binary"));
+    }
+    // everything is ciphered, more input is needed
+    return true;
+};
+
+// the direction is fixed by setKey()
+NativeMode.prototype.decrypt = NativeMode.prototype.encrypt;
+
+const gcmAfterFinish = function (output, options) {
+    const tag = this._cipher.final().toString("binary").slice(0, this._tagLength / 8);
+    this.tag = crypto.util.createBuffer(tag);
+
+    // check authentication tag
+    return !(options.decrypt && tag !== this._tag);
+};
@@ -0,0 +1,96 @@
+const {
+    is,
+    crypto
+} = adone;
+
+const toBytes = (msg, encoding) => is.string(msg)
+    ? Buffer.from(msg, encoding === "utf8" ? "utf8" : "binary")
+    : msg;
+
+/**
+ * Creates a message digest object backed by a native digest (addon.Sha1, addon.Md5).
+ *
+ * It has the same API as the JavaScript digests, but Buffers and Uint8Arrays are hashed
+ * in place, without conversion to binary strings.
+ *
+ * @param Digest the native digest class.
+ * @param md the message digest object to complete.
+ *
+ * @return the message digest object.
+ */
+export const create = function (Digest, md) {
+    const digest = new Digest();
+
+    md.start = function () {
+        md.messageLength = 0;
+        md.fullMessageLength = md.messageLength64 = [];
+        const int32s = md.messageLengthSize / 4;
+        for (let i = 0; i < int32s; ++i) {
+            md.fullMessageLength.push(0);
+        }
+        digest.reset();
+        return md;
+    };
+    md.start();
+
+    const updateLength = function (len) {
+        md.messageLength += len;
+        len = [(len / 0x100000000) >>> 0, len >>> 0];
+        for (let i = md.fullMessageLength.length - 1; i >= 0; --i) {
+            md.fullMessageLength[i] += len[1];
+            len[1] = len[0] + ((md.fullMessageLength[i] / 0x100000000) >>> 0);
+            md.fullMessageLength[i] = md.fullMessageLength[i] >>> 0;
+            len[0] = ((len[1] / 0x100000000) >>> 0);
+        }
+    };
+
+    /**
+     * Updates the digest with the given message input, a binary string (or a string with
+     * 'utf8' encoding), a Buffer or an Uint8Array.
+     *
+     * @return this digest object.
+     */
+    md.update = function (msg, encoding) {
+        const bytes = toBytes(msg, encoding);
+        updateLength(bytes.length);
+        digest.update(bytes);
+        return md;
+    };
+
+    /**
+     * The same as update(), but the input is hashed on the native worker pool. The digest
+     * must not be used until the returned promise is resolved.
+     *
+     * @return a promise of this digest object.
+     */
+    md.updateAsync = function (msg, encoding) {
+        const bytes = toBytes(msg, encoding);
+        return new Promise((resolve, reject) => {
+            digest.updateAsync(bytes, (err) => {
+                if (err) {
+                    return reject(err);
+                }
+                updateLength(bytes.length);
+                resolve(md);
+            });
+        });
+    };
+
+    /**
+     * Produces the digest, the digest object can still be updated afterwards.
+     *
+     * @return a byte buffer containing the digest value.
+     */
+    md.digest = function () {
+        return crypto.util.createBuffer(digest.digest().toString("binary"));
+    };
+
+    return md;
+};
+
+/**
+ * Converts a Buffer or an Uint8Array passed to a JavaScript digest into a binary string.
+ */
+export const toBinaryString = (msg) => is.string(msg)
+    ? msg
+    : Buffer.from(msg.buffer, msg.byteOffset, msg.byteLength).toString("binary");
@@ -18,6 +18,14 @@ if (is.nodejs && !crypto.options.usePureJavaScript) {
     stdCrypto = require("crypto");
 }
 
+const addon = crypto.options.usePureJavaScript ? null : require("./addon");
+
+// digests of the native implementation
+const NATIVE_DIGESTS = ["sha1", "sha256", "sha512"];
+
+const toBuffer = (bytes) => is.string(bytes) ? Buffer.from(bytes, "binary") : bytes;
+const toBinary = (bytes) => is.string(bytes) ? bytes : Buffer.from(bytes).toString("binary");
+
 /**
  * Derives a key from a password.
  *
@@ -34,13 +42,22 @@ if (is.nodejs && !crypto.options.usePureJavaScript) {
  * @return the derived key, as a binary-encoded string of bytes, for the
  *           synchronous version (if no callback is specified).
  */
-export default function (
-    p, s, c, dkLen, md, callback) {
+const pbkdf2 = function (p, s, c, dkLen, md, callback) {
     if (is.function(md)) {
         callback = md;
         md = null;
     }
 
+    // the addon derives the key on the native worker pool instead of the libuv threadpool
+    if (callback && addon && (is.nil(md) || NATIVE_DIGESTS.includes(md))) {
+        return addon.pbkdf2(toBuffer(p), toBuffer(s), c, dkLen, md || "sha1", (err, key) => {
+            if (err) {
+                return callback(err);
+            }
+            callback(null, key.toString("binary"));
+        });
+    }
+
     // use native implementation if possible and not disabled, note that
     // some node versions only support SHA-1, others allow digest to be changed
     if (is.nodejs && !crypto.options.usePureJavaScript &&
@@ -214,3 +231,62 @@ export default function (
 
     outer();
 };
+
+/**
+ * Derives a key from a password without blocking the event loop.
+ *
+ * @param p the password as a Buffer or a binary-encoded string of bytes.
+ * @param s the salt as a Buffer or a binary-encoded string of bytes.
+ * @param c the iteration count, a positive integer.
+ * @param dkLen the intended length, in bytes, of the derived key.
+ * @param [md] the name of the message digest to use in the PRF, defaults to SHA-1.
+ *
+ * @return a promise of the derived key as a Buffer.
+ */
+pbkdf2.async = function (p, s, c, dkLen, md = "sha1") {
+    return new Promise((resolve, reject) => {
+        const callback = (err, key) => {
+            if (err) {
+                return reject(err);
+            }
+            resolve(is.string(key) ? Buffer.from(key, "binary") : key);
+        };
+        if (addon && NATIVE_DIGESTS.includes(md)) {
+            addon.pbkdf2(toBuffer(p), toBuffer(s), c, dkLen, md, callback);
+        } else {
+            pbkdf2(toBinary(p), toBinary(s), c, dkLen, md, callback);
+        }
+    });
+};
+
+/**
+ * Derives keys from many passwords at once, with the same parameters. The native implementation
+ * derives them in parallel on the worker pool.
+ *
+ * @param entries an array of {password, salt}, as Buffers or binary-encoded strings of bytes.
+ * @param c the iteration count, a positive integer.
+ * @param dkLen the intended length, in bytes, of the derived keys.
+ * @param [md] the name of the message digest to use in the PRF, defaults to SHA-1.
+ *
+ * @return a promise of the derived keys as an array of Buffers, in the order of the entries.
+ */
+pbkdf2.batch = function (entries, c, dkLen, md = "sha1") {
+    if (entries.length === 0) {
+        return Promise.resolve([]);
+    }
+    if (!addon || !NATIVE_DIGESTS.includes(md)) {
+        return Promise.all(entries.map((entry) => pbkdf2.async(entry.password, entry.salt, c, dkLen, md)));
+    }
+    return new Promise((resolve, reject) => {
+        const passwords = entries.map((entry) => toBuffer(entry.password));
+        const salts = entries.map((entry) => toBuffer(entry.salt));
+        addon.pbkdf2Batch(passwords, salts, c, dkLen, md, (err, keys) => {
+            if (err) {
+                return reject(err);
+            }
+            resolve(entries.map((entry, i) => keys.slice(i * dkLen, (i + 1) * dkLen)));
+        });
+    });
+};
+
+export default pbkdf2;
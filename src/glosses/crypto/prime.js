@@ -13,6 +13,7 @@ const {
 
 
 const { BigInteger } = crypto.jsbn;
+const addon = crypto.options.usePureJavaScript ? null : require("./addon");
 
 // primes are 30k+i for i = 1, 7, 11, 13, 17, 19, 23, 29
 const GCD_30_DELTA = [6, 4, 2, 4, 2, 4, 6, 2];
@@ -78,6 +79,11 @@ export const generateProbablePrime = function (bits, options, callback) {
     };
 
     if (algorithm.name === "PRIMEINC") {
+        // a custom prng asks for reproducible numbers, the native search is not. It already runs on
+        // every thread of the native pool, so it replaces the web workers.
+        if (addon && !options.prng && bits >= 16 && bits <= 16384) {
+            return primeincFindPrimeNative(bits, algorithm.options, callback);
+        }
         return primeincFindPrime(bits, rng, algorithm.options, callback);
     }
 
@@ -91,6 +97,22 @@ function primeincFindPrime(bits, rng, options, callback) {
     return primeincFindPrimeWithoutWorkers(bits, rng, options, callback);
 }
 
+// The addon runs PRIMEINC on all the threads of the native pool, with trial division before the
+// Miller-Rabin tests. Its random numbers derive from a seed taken from crypto.random.
+function primeincFindPrimeNative(bits, options, callback) {
+    let mrTests = getMillerRabinTests(bits);
+    if ("millerRabinTests" in options) {
+        mrTests = Math.max(1, options.millerRabinTests);
+    }
+    const seed = Buffer.from(crypto.random.getBytesSync(32), "binary");
+    addon.primeGenerate(bits, mrTests, seed, (err, prime) => {
+        if (err) {
+            return callback(err);
+        }
+        callback(null, new BigInteger(prime.toString("hex"), 16));
+    });
+}
+
 function primeincFindPrimeWithoutWorkers(bits, rng, options, callback) {
     // initialize random number
     const num = generateRandom(bits, rng);
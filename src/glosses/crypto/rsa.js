@@ -72,6 +72,11 @@ if (is.undefined(BigInteger)) {
 }
 
 const _crypto = is.nodejs ? require("crypto") : null;
+const addon = crypto.options.usePureJavaScript ? null : require("./addon");
+
+// big-endian magnitude of a non-negative BigInteger, as the addon takes numbers
+const bigIntegerToBuffer = (num) => Buffer.from(num.toByteArray());
+const bufferToBigInteger = (buf) => new BigInteger(buf.toString("hex"), 16);
 
 // shortcut for asn.1 API
 const { asn1, util } = crypto;
@@ -211,6 +216,9 @@ const _modPow = function (x, key, pub) {
 
     if (!key.p || !key.q) {
         // allow calculation without CRT params (slow)
+        if (addon && key.n.testBit(0)) {
+            return bufferToBigInteger(addon.bnModPow(bigIntegerToBuffer(x), bigIntegerToBuffer(key.d), bigIntegerToBuffer(key.n), true));
+        }
         return x.modPow(key.d, key.n);
     }
 
@@ -308,6 +316,20 @@ const _modPow = function (x, key, pub) {
      * inverse.
      */
 
+    if (addon) {
+        // the addon blinds, runs both exponentiations in constant time and unblinds in a single
+        // call, it returns null when r has no inverse modulo n
+        const params = [key.n, key.e, key.p, key.q, key.dP, key.dQ, key.qInv].map(bigIntegerToBuffer);
+        const input = bigIntegerToBuffer(x);
+        for (; ;) {
+            const blind = Buffer.from(crypto.random.getBytes(Math.ceil(key.n.bitLength() / 8)), "binary");
+            const y = addon.rsaPrivate(input, ...params, blind);
+            if (!is.null(y)) {
+                return bufferToBigInteger(y);
+            }
+        }
+    }
+
     // cryptographic blinding
     let r;
     do {
@@ -516,7 +538,9 @@ export const createKeyPairGenerationState = function (bits, e, options) {
             pBits: bits - (bits >> 1),
             pqState: 0,
             num: null,
-            keys: null
+            keys: null,
+            // a custom prng asks for reproducible keys, the native prime search is not
+            native: Boolean(addon) && !options.prng && bits >= 32 && bits <= 32768
         };
         rval.e.fromInt(rval.eInt);
     } else {
@@ -593,8 +617,14 @@ export const stepKeyPairGenerationState = function (state, n) {
             const bits = (is.null(state.p)) ? state.pBits : state.qBits;
             const bits1 = bits - 1;
 
-            // get a random number
-            if (state.pqState === 0) {
+            if (state.pqState === 0 && state.native) {
+                // the addon finds the whole prime in one step, with trial division before the
+                // Miller-Rabin tests
+                const seed = Buffer.from(crypto.random.getBytesSync(32), "binary");
+                state.num = bufferToBigInteger(addon.primeGenerateSync(bits, _getMillerRabinTests(bits), seed));
+                state.pqState = 2;
+            } else if (state.pqState === 0) {
+                // get a random number
                 state.num = new BigInteger(bits, state.rng);
                 // force MSB set
                 if (!state.num.testBit(bits1)) {
@@ -1406,7 +1436,8 @@ function _decodePkcs1_v1_5(em, key, pub, ml) {
  * @param [options] options for key-pair generation:
  *          workerScript the worker script URL.
  *          workers the number of web workers (if supported) to use,
- *            (default: 2, -1 to use estimated cores minus one).
+ *            (default: 2, -1 to use estimated cores minus one), unused when
+ *            the native prime search runs.
  *          workLoad the size of the work load, ie: number of possible prime
  *            numbers for each web worker to check per work assignment,
  *            (default: 100).
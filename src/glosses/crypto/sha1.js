@@ -13,6 +13,9 @@ const {
     crypto
 } = adone;
 
+const addon = crypto.options.usePureJavaScript ? null : require("./addon");
+const nativeMd = require("./native_md");
+
 // const sha1 = module.exports = forge.sha1 = forge.sha1 || {};
 // forge.md.sha1 = forge.md.algorithms.sha1 = sha1;
 
@@ -22,6 +25,17 @@ const {
  * @return a message digest object.
  */
 export const create = function () {
+    if (addon) {
+        return nativeMd.create(addon.Sha1, {
+            algorithm: "sha1",
+            blockLength: 64,
+            digestLength: 20,
+            messageLength: 0,
+            fullMessageLength: null,
+            messageLengthSize: 8
+        });
+    }
+
     // do initialization as necessary
     if (!_initialized) {
         _init();
@@ -90,6 +104,8 @@ export const create = function () {
     md.update = function (msg, encoding) {
         if (encoding === "utf8") {
             msg = crypto.util.encodeUtf8(msg);
+        } else {
+            msg = nativeMd.toBinaryString(msg);
         }
 
         // update message length
@@ -117,6 +133,15 @@ export const create = function () {
         return md;
     };
 
+    /**
+     * The same as update(), for parity with the native digest that hashes on the worker pool.
+     *
+     * @return a promise of this digest object.
+     */
+    md.updateAsync = async function (msg, encoding) {
+        return md.update(msg, encoding);
+    };
+
     /**
      * Produces the digest.
      *
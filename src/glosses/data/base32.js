@@ -1,5 +1,28 @@
+const {
+    is,
+    data
+} = adone;
+
 adone.asNamespace(exports);
 
+const addon = data.options.usePureJavaScript ? null : require("./addon");
+
+// Symbol of every ASCII character once upper-cased for the native decoder, 0x100 for padding
+const decodeTables = new WeakMap();
+
+const getDecodeTable = (charmap) => {
+    let table = decodeTables.get(charmap);
+    if (!table) {
+        table = new Uint16Array(128);
+        for (let c = 0; c < 128; c++) {
+            const char = String.fromCharCode(c).toUpperCase();
+            table[c] = char === "=" ? 0x100 : charmap[char] & 0xff;
+        }
+        decodeTables.set(charmap, table);
+    }
+    return table;
+};
+
 /**
  * Generate a character map.
  * @param {string} alphabet e.g. "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567"
@@ -69,6 +92,8 @@ export class Decoder {
         this.buf = [];
         this.shift = 8;
         this.carry = 0;
+        // bytes decoded by the native addon, followed by the ones in this.buf
+        this._chunks = [];
 
         if (options) {
 
@@ -99,6 +124,22 @@ export class Decoder {
      * @return {Decoder} this
      */
     write(str) {
+        if (addon) {
+            const state = new Int32Array([this.shift, this.carry]);
+            // undefined for non-ASCII strings
+            const bytes = addon.base32Decode(str, getDecodeTable(this.charmap), state);
+            if (bytes) {
+                if (this.buf.length > 0) {
+                    this._chunks.push(Buffer.from(this.buf));
+                    this.buf = [];
+                }
+                this._chunks.push(bytes);
+                this.shift = state[0];
+                this.carry = state[1];
+                return this;
+            }
+        }
+
         const charmap = this.charmap;
         const buf = this.buf;
         let shift = this.shift;
@@ -160,6 +201,10 @@ export class Decoder {
             this.shift = 8;
             this.carry = 0;
         }
+        if (this._chunks.length > 0) {
+            this._chunks.push(Buffer.from(this.buf));
+            return Buffer.concat(this._chunks);
+        }
         return Buffer.from(this.buf);
     }
 }
@@ -217,6 +262,18 @@ export class Encoder {
      * @return {Encoder} this
      */
     write(buf) {
+        if (addon && buf instanceof Uint8Array) {
+            const state = new Int32Array([this.shift, this.carry]);
+            // undefined for alphabets that are not 32 Latin-1 characters
+            const str = addon.base32Encode(buf, this.alphabet, state);
+            if (!is.undefined(str)) {
+                this.buf += str;
+                this.shift = state[0];
+                this.carry = state[1];
+                return this;
+            }
+        }
+
         let shift = this.shift;
         let carry = this.carry;
         let symbol;
@@ -1,8 +1,38 @@
 const {
-    data: { baseX }
+    is,
+    data: { baseX, options }
 } = adone;
 
+const addon = options.usePureJavaScript ? null : require("./addon");
+
 const ALPHABET = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
 const base58 = baseX(ALPHABET);
 
+if (addon) {
+    // the native conversion works on 32-bit limbs instead of one digit at a time
+    const codec = new addon.BaseX(ALPHABET);
+
+    base58.encode = (source) => {
+        if (!is.buffer(source)) {
+            throw new TypeError("Expected Buffer");
+        }
+        return codec.encode(source);
+    };
+
+    base58.decodeUnsafe = (source) => {
+        if (!is.string(source)) {
+            throw new TypeError("Expected String");
+        }
+        return codec.decode(source);
+    };
+
+    base58.decode = (source) => {
+        const buffer = base58.decodeUnsafe(source);
+        if (buffer) {
+            return buffer;
+        }
+        throw new Error("Non-base58 character");
+    };
+}
+
 export default adone.asNamespace(base58);
@@ -1,10 +1,13 @@
 const {
     is,
-    error
+    error,
+    data
 } = adone;
 
 adone.asNamespace(exports);
 
+const addon = data.options.usePureJavaScript ? null : require("./addon");
+
 const intToCharMap = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/".split("");
 
 export const encodeNumber = (number) => {
@@ -128,16 +131,31 @@ export const encodeVLQ = (aValue) => {
     return encoded;
 };
 
-export const encode = (str, { buffer = false } = {}) => {
+const toBytes = (input, encoding) => is.string(input) ? Buffer.from(input, encoding || "utf8") : input;
+
+// Padded base64 of the standard or the URL-safe alphabet
+const toBase64 = (bytes, url) => {
+    const str = bytes.toString("base64");
+    return url ? str.replace(/\+/g, "-").replace(/\//g, "_") : str;
+};
+
+/**
+ * Encodes a string or a Buffer in base64, with the URL-safe alphabet and without padding if options.url is set.
+ */
+export const encode = (str, { buffer = false, url = false } = {}) => {
     if (!is.buffer(str)) {
         str = Buffer.from(str);
     }
+    const b64 = url ? toBase64(str, true).replace(/=+$/, "") : str.toString("base64");
     if (!buffer) {
-        return str.toString("base64");
+        return b64;
     }
-    return Buffer.from(str.toString("base64"), "binary");
+    return Buffer.from(b64, "binary");
 };
 
+/**
+ * Decodes base64 of the standard or the URL-safe alphabet.
+ */
 export const decode = (str, { buffer = false, encoding = "binary" } = {}) => {
     const b = Buffer.from(str, "base64");
     if (buffer) {
@@ -145,3 +163,157 @@ export const decode = (str, { buffer = false, encoding = "binary" } = {}) => {
     }
     return b.toString(encoding);
 };
+
+/**
+ * Streaming base64 encoder, for inputs that come in chunks of any length.
+ *
+ * Without the native addon the chunks are encoded by Buffer#toString().
+ *
+ * @param {boolean} [options.url] use the URL-safe alphabet, without padding unless options.pad is set.
+ * @param {boolean} [options.pad] pad the last group with "=".
+ * @param {number} [options.lineLength] break the output in lines of this length, 0 (the default) to not break lines.
+ * @param {string} [options.delimiter] the line break, "\r\n" by default.
+ * @param {boolean} [options.buffer] return the characters as Buffers instead of strings.
+ */
+export class Encoder {
+    constructor({ url = false, pad = !url, lineLength = 0, delimiter = "\r\n", buffer = false } = {}) {
+        this.url = url;
+        this.pad = pad;
+        this.lineLength = lineLength || 0;
+        this.delimiter = delimiter;
+        this.buffer = buffer;
+        if (addon) {
+            this._native = new addon.Base64Encoder(url, pad, this.lineLength, delimiter);
+        } else {
+            this._pending = null;
+            this._column = 0;
+        }
+    }
+
+    /**
+     * Encodes the whole groups of 3 bytes, the rest is kept for the next call.
+     *
+     * @param input a Buffer, or a string encoded with `encoding` (utf8 by default).
+     */
+    update(input, encoding) {
+        let bytes = toBytes(input, encoding);
+        if (this._native) {
+            return this._output(this._native.update(bytes));
+        }
+        if (this._pending) {
+            bytes = Buffer.concat([this._pending, bytes]);
+            this._pending = null;
+        }
+        const whole = bytes.length - bytes.length % 3;
+        if (whole < bytes.length) {
+            this._pending = Buffer.from(bytes.slice(whole));
+        }
+        return this._output(this._wrap(toBase64(Buffer.from(bytes.buffer, bytes.byteOffset, whole), this.url)));
+    }
+
+    /**
+     * Encodes the remaining bytes, the encoder can then be used for another input.
+     */
+    final() {
+        if (this._native) {
+            return this._output(this._native.final());
+        }
+        let str = "";
+        if (this._pending) {
+            str = toBase64(this._pending, this.url);
+            if (!this.pad) {
+                str = str.replace(/=+$/, "");
+            }
+            this._pending = null;
+        }
+        str = this._wrap(str);
+        this._column = 0;
+        return this._output(str);
+    }
+
+    // Inserts the line breaks before the characters that start a line, but the first one
+    _wrap(str) {
+        if (!this.lineLength || !str) {
+            return str;
+        }
+        let result = "";
+        let pos = 0;
+        while (pos < str.length) {
+            if (this._column === this.lineLength) {
+                result += this.delimiter;
+                this._column = 0;
+            }
+            const count = Math.min(this.lineLength - this._column, str.length - pos);
+            result += str.substr(pos, count);
+            pos += count;
+            this._column += count;
+        }
+        return result;
+    }
+
+    _output(chars) {
+        if (this.buffer) {
+            return is.string(chars) ? Buffer.from(chars, "latin1") : chars;
+        }
+        return is.string(chars) ? chars : chars.toString("latin1");
+    }
+}
+
+/**
+ * Streaming base64 decoder, for inputs that come in chunks of any length.
+ *
+ * Characters out of the alphabet, like line breaks, are skipped, and padding ends a group so that
+ * concatenated encodings are decoded as a whole.
+ *
+ * @param {boolean} [options.url] use the URL-safe alphabet.
+ */
+export class Decoder {
+    constructor({ url = false } = {}) {
+        this.url = url;
+        if (addon) {
+            this._native = new addon.Base64Decoder(url);
+        } else {
+            this._rest = "";
+        }
+    }
+
+    /**
+     * Decodes the whole groups of 4 characters, the rest is kept for the next call.
+     *
+     * @param input a string or a Buffer of ASCII characters.
+     * @return {Buffer}
+     */
+    update(input) {
+        if (this._native) {
+            return this._native.update(input);
+        }
+        let str = this._rest + (is.string(input) ? input : input.toString("latin1")).replace(this.url ? /[^A-Za-z0-9\-_=]/g : /[^A-Za-z0-9+/=]/g, "");
+        if (this.url) {
+            str = str.replace(/-/g, "+").replace(/_/g, "/");
+        }
+        const chunks = [];
+        // padding flushes the group it ends
+        for (let i = str.indexOf("="); i >= 0; i = str.indexOf("=")) {
+            chunks.push(Buffer.from(str.slice(0, i), "base64"));
+            str = str.slice(i + 1);
+        }
+        const whole = str.length - str.length % 4;
+        chunks.push(Buffer.from(str.slice(0, whole), "base64"));
+        this._rest = str.slice(whole);
+        return chunks.length === 1 ? chunks[0] : Buffer.concat(chunks);
+    }
+
+    /**
+     * Decodes an unpadded last group, the decoder can then be used for another input.
+     *
+     * @return {Buffer}
+     */
+    final() {
+        if (this._native) {
+            return this._native.final();
+        }
+        const buf = Buffer.from(this._rest, "base64");
+        this._rest = "";
+        return buf;
+    }
+}
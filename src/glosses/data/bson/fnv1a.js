@@ -1,30 +1,12 @@
-const Long = require("./long");
-
-const MASK_8 = 0xff;
-const MASK_24 = 0xffffff;
-const MASK_32 = 0xffffffff;
-
-// See http://www.isthe.com/chongo/tech/comp/fnv/#FNV-param for the definition of these parameters;
-const FNV_PRIME = new Long(16777619, 0);
-const OFFSET_BASIS = new Long(2166136261, 0);
-const FNV_MASK = new Long(MASK_32, 0);
+// FNV-1a lives in adone.crypto.fnv1a, which hashes natively when the crypto addon is available.
+// See http://www.isthe.com/chongo/tech/comp/fnv/#FNV-1a
 
 /**
  * Implementation of the FNV-1a hash for a 32-bit hash value
- * Algorithm can be found here: http://www.isthe.com/chongo/tech/comp/fnv/#FNV-1a
  * @ignore
  */
 function fnv1a32(input, encoding) {
-    encoding = encoding || "utf8";
-    const octets = Buffer.from(input, encoding);
-
-    let hash = OFFSET_BASIS;
-    for (let i = 0; i < octets.length; i += 1) {
-        hash = hash.xor(new Long(octets[i], 0));
-        hash = hash.multiply(FNV_PRIME);
-        hash = hash.and(FNV_MASK);
-    }
-    return hash.getLowBitsUnsigned();
+    return adone.crypto.fnv1a.hash32(input, encoding);
 }
 
 /**
@@ -34,12 +16,23 @@ function fnv1a32(input, encoding) {
  * @ignore
  */
 function fnv1a24(input, encoding) {
-    const _32bit = fnv1a32(input, encoding);
-    const base = _32bit & MASK_24;
-    const top = (_32bit >>> 24) & MASK_8;
-    const final = (base ^ top) & MASK_24;
+    return adone.crypto.fnv1a.hash24(input, encoding);
+}
+
+/**
+ * 32-bit hashes of an array of keys, or of packed keys delimited by an Uint32Array of offsets
+ * @ignore
+ */
+function fnv1a32Batch(keys, offsets) {
+    return adone.crypto.fnv1a.hash32Batch(keys, offsets);
+}
 
-    return final;
+/**
+ * 24-bit folded hashes of an array of keys, or of packed keys delimited by an Uint32Array of offsets
+ * @ignore
+ */
+function fnv1a24Batch(keys, offsets) {
+    return adone.crypto.fnv1a.hash24Batch(keys, offsets);
 }
 
-module.exports = { fnv1a24, fnv1a32 };
+module.exports = { fnv1a24, fnv1a32, fnv1a24Batch, fnv1a32Batch };
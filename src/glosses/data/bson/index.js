@@ -1,5 +1,6 @@
 const {
-    is
+    is,
+    data: { options: dataOptions }
 } = adone;
 
 const Map = require("./map");
@@ -24,6 +25,9 @@ const internalDeserialize = require("./parser/deserializer");
 const internalSerialize = require("./parser/serializer");
 const internalCalculateObjectSize = require("./parser/calculate_size");
 const ensureBuffer = require("./ensure_buffer");
+const BSONView = require("./view");
+
+const addon = dataOptions.usePureJavaScript ? null : require("../addon");
 
 /**
  * @ignore
@@ -47,6 +51,23 @@ function setInternalBufferSize(size) {
     }
 }
 
+/**
+ * Serializes the object with the data addon, in one pass to the internal buffer and then to memory of its
+ * own if the buffer is full. It is faster for documents of numbers, arrays and binaries, the JavaScript
+ * serializer is faster for documents of many small objects.
+ *
+ * @ignore
+ * @return {Number|Buffer|undefined} the number of bytes written to the internal buffer, a Buffer with the
+ * document if it does not fit there, or undefined if the object has values only the JavaScript serializer handles
+ */
+function serializeNative(object, native, checkKeys, serializeFunctions, ignoreUndefined) {
+    if (!native || !addon) {
+        return undefined;
+    }
+    const flags = (checkKeys ? 1 : 0) | (serializeFunctions ? 2 : 0) | (ignoreUndefined ? 4 : 0);
+    return addon.bsonSerialize(object, flags, buffer);
+}
+
 /**
  * Serialize a Javascript object.
  *
@@ -54,6 +75,7 @@ function setInternalBufferSize(size) {
  * @param {Boolean} [options.checkKeys] the serializer will check if keys are valid.
  * @param {Boolean} [options.serializeFunctions=false] serialize the javascript functions **(default:false)**.
  * @param {Boolean} [options.ignoreUndefined=true] ignore undefined fields **(default:true)**.
+ * @param {Boolean} [options.native=false] serialize with the data addon when it handles the values of the object **(default:false)**.
  * @return {Buffer} returns the Buffer object containing the serialized object.
  */
 function serialize(object, options) {
@@ -72,8 +94,15 @@ function serialize(object, options) {
         buffer = Buffer.alloc(minInternalBufferSize);
     }
 
+    const native = is.boolean(options.native) ? options.native : false;
+
+    const result = serializeNative(object, native, checkKeys, serializeFunctions, ignoreUndefined);
+    if (is.buffer(result)) {
+        return result;
+    }
+
     // Attempt to serialize
-    const serializationIndex = internalSerialize(
+    const serializationIndex = is.number(result) ? result : internalSerialize(
         buffer,
         object,
         checkKeys,
@@ -102,6 +131,7 @@ function serialize(object, options) {
  * @param {Boolean} [options.checkKeys] the serializer will check if keys are valid.
  * @param {Boolean} [options.serializeFunctions=false] serialize the javascript functions **(default:false)**.
  * @param {Boolean} [options.ignoreUndefined=true] ignore undefined fields **(default:true)**.
+ * @param {Boolean} [options.native=false] serialize with the data addon when it handles the values of the object **(default:false)**.
  * @param {Number} [options.index] the index in the buffer where we wish to start serializing into.
  * @return {Number} returns the index pointing to the last written byte in the buffer.
  */
@@ -115,8 +145,16 @@ function serializeWithBufferAndIndex(object, finalBuffer, options) {
     is.boolean(options.ignoreUndefined) ? options.ignoreUndefined : true;
     const startIndex = is.number(options.index) ? options.index : 0;
 
+    const native = is.boolean(options.native) ? options.native : false;
+
+    const result = serializeNative(object, native, checkKeys, serializeFunctions, ignoreUndefined);
+    if (is.buffer(result)) {
+        result.copy(finalBuffer, startIndex);
+        return startIndex + result.length - 1;
+    }
+
     // Attempt to serialize
-    const serializationIndex = internalSerialize(
+    const serializationIndex = is.number(result) ? result : internalSerialize(
         buffer,
         object,
         checkKeys,
@@ -264,6 +302,9 @@ module.exports = {
     BSONRegExp,
     Decimal128,
 
+    // lazy deserialization
+    BSONView,
+
     // methods
     serialize,
     serializeWithBufferAndIndex,
@@ -1,3 +1,7 @@
+const {
+    data: { utf8 }
+} = adone;
+
 const FIRST_BIT = 0x80;
 const FIRST_TWO_BITS = 0xc0;
 const FIRST_THREE_BITS = 0xe0;
@@ -10,13 +14,10 @@ const FOUR_BIT_CHAR = 0xf0;
 const CONTINUING_CHAR = 0x80;
 
 /**
- * Determines if the passed in bytes are valid utf8
- * @param {Buffer|Uint8Array} bytes An array of 8-bit bytes. Must be indexable and have length property
- * @param {Number} start The index to start validating
- * @param {Number} end The index to end validating
- * @returns {boolean} True if valid utf8
+ * Checks the structure of the sequences only, overlong forms, surrogates and code points above U+10FFFF
+ * are accepted
  */
-function validateUtf8(bytes, start, end) {
+function validateStructure(bytes, start, end) {
     let continuation = 0;
 
     for (let i = start; i < end; i += 1) {
@@ -43,4 +44,17 @@ function validateUtf8(bytes, start, end) {
     return !continuation;
 }
 
+/**
+ * Determines if the passed in bytes are valid utf8
+ * @param {Buffer|Uint8Array} bytes An array of 8-bit bytes. Must be indexable and have length property
+ * @param {Number} start The index to start validating
+ * @param {Number} end The index to end validating
+ * @returns {boolean} True if valid utf8
+ */
+function validateUtf8(bytes, start, end) {
+    // utf8.validate() is strict and accepts a subset of what BSON accepts, only the strings it
+    // rejects are checked again
+    return utf8.validate(bytes, start, end) || validateStructure(bytes, start, end);
+}
+
 module.exports.validateUtf8 = validateUtf8;
@@ -0,0 +1,289 @@
+const {
+    is,
+    data: { options: dataOptions }
+} = adone;
+
+const constants = require("./constants");
+const internalDeserialize = require("./parser/deserializer");
+const ensureBuffer = require("./ensure_buffer");
+
+const addon = dataOptions.usePureJavaScript ? null : require("../addon");
+
+const readInt32 = (buffer, index) => buffer[index] | (buffer[index + 1] << 8) | (buffer[index + 2] << 16) | (buffer[index + 3] << 24);
+
+// The size of the value of an element at index, -1 if it does not end before end
+const valueSize = function (type, buffer, index, end) {
+    const available = end - index;
+    let size;
+    switch (type) {
+        case constants.BSON_DATA_UNDEFINED:
+        case constants.BSON_DATA_NULL:
+        case constants.BSON_DATA_MIN_KEY:
+        case constants.BSON_DATA_MAX_KEY:
+            return 0;
+        case constants.BSON_DATA_BOOLEAN:
+            size = 1;
+            break;
+        case constants.BSON_DATA_INT:
+            size = 4;
+            break;
+        case constants.BSON_DATA_NUMBER:
+        case constants.BSON_DATA_DATE:
+        case constants.BSON_DATA_TIMESTAMP:
+        case constants.BSON_DATA_LONG:
+            size = 8;
+            break;
+        case constants.BSON_DATA_OID:
+            size = 12;
+            break;
+        case constants.BSON_DATA_DECIMAL128:
+            size = 16;
+            break;
+        case constants.BSON_DATA_STRING:
+        case constants.BSON_DATA_CODE:
+        case constants.BSON_DATA_SYMBOL:
+        case constants.BSON_DATA_DBPOINTER: {
+            if (available < 4) {
+                return -1;
+            }
+            const length = readInt32(buffer, index);
+            if (length < 1 || length > available - 4 || buffer[index + 4 + length - 1] !== 0) {
+                return -1;
+            }
+            size = type === constants.BSON_DATA_DBPOINTER ? 4 + length + 12 : 4 + length;
+            break;
+        }
+        case constants.BSON_DATA_OBJECT:
+        case constants.BSON_DATA_ARRAY:
+            if (available < 5) {
+                return -1;
+            }
+            size = readInt32(buffer, index);
+            if (size < 5 || size > available || buffer[index + size - 1] !== 0) {
+                return -1;
+            }
+            break;
+        case constants.BSON_DATA_BINARY:
+            if (available < 5) {
+                return -1;
+            }
+            size = readInt32(buffer, index);
+            size = size < 0 ? -1 : 5 + size;
+            break;
+        case constants.BSON_DATA_REGEXP: {
+            const pattern = buffer.indexOf(0, index);
+            const flags = pattern === -1 ? -1 : buffer.indexOf(0, pattern + 1);
+            size = flags === -1 ? -1 : flags + 1 - index;
+            break;
+        }
+        case constants.BSON_DATA_CODE_W_SCOPE:
+            if (available < 4) {
+                return -1;
+            }
+            size = readInt32(buffer, index);
+            size = size < 14 ? -1 : size;
+            break;
+        default:
+            return -1;
+    }
+    return size <= available ? size : -1;
+};
+
+// Lists the elements of the document at index as the data addon does: type, name start, name end and
+// value end for every element. Returns null if the document is not valid.
+const scan = function (buffer, index) {
+    if (!(index >= 0 && buffer.length - index >= 5)) {
+        return null;
+    }
+    const size = readInt32(buffer, index);
+    if (size < 5 || size > buffer.length - index || buffer[index + size - 1] !== 0) {
+        return null;
+    }
+    const end = index + size - 1;
+    const elements = [];
+    for (let pos = index + 4; pos < end;) {
+        const type = buffer[pos++];
+        const nameEnd = buffer.indexOf(0, pos);
+        if (nameEnd === -1 || nameEnd >= end) {
+            return null;
+        }
+        const value = valueSize(type, buffer, nameEnd + 1, end);
+        if (value === -1) {
+            return null;
+        }
+        elements.push(type, pos, nameEnd, nameEnd + 1 + value);
+        pos = nameEnd + 1 + value;
+    }
+    return Uint32Array.from(elements);
+};
+
+/**
+ * A read-only view of a BSON document that decodes its fields when they are accessed.
+ *
+ * The document is only scanned for the positions of its elements when the view is created, the values
+ * are deserialized by get() with the options of deserialize(). Embedded documents and arrays are views
+ * themselves, unless the options ask for them as raw Buffers.
+ */
+class BSONView {
+    /**
+     * @param {Buffer|Uint8Array} buffer the buffer containing the document
+     * @param {Object} [options] the options of deserialize(), options.index is the offset of the document
+     */
+    constructor(buffer, options) {
+        buffer = ensureBuffer(buffer);
+        options = options || {};
+        const index = is.number(options.index) ? options.index : 0;
+        const elements = addon ? addon.bsonScan(buffer, index) : scan(buffer, index);
+        if (!elements) {
+            throw new Error("corrupt bson message");
+        }
+
+        this.buffer = buffer;
+        this.index = index;
+        this.options = options;
+        this.elements = elements;
+        this.isArray = false;
+        // the parent view and the position of the element of an embedded document
+        this.parent = null;
+        this.position = -1;
+        // the positions of the elements by name, built on the first lookup
+        this.names = null;
+    }
+
+    /**
+     * The number of elements of the document.
+     *
+     * @return {Number}
+     */
+    get length() {
+        return this.elements.length / 4;
+    }
+
+    /**
+     * The names of the elements, or their indexes for an array.
+     *
+     * @return {Array}
+     */
+    keys() {
+        const keys = [];
+        for (let i = 0; i < this.length; i++) {
+            keys.push(this.isArray ? i : this.name(i));
+        }
+        return keys;
+    }
+
+    /**
+     * @param {String|Number} name the name of the element, or its index for an array
+     * @return {Boolean}
+     */
+    has(name) {
+        return this.find(name) !== -1;
+    }
+
+    /**
+     * Deserializes the value of an element.
+     *
+     * @param {String|Number} name the name of the element, or its index for an array
+     * @return {*} the value, a BSONView for an embedded document or array, or undefined if there is no such element
+     */
+    get(name) {
+        const position = this.find(name);
+        return position === -1 ? undefined : this.value(position);
+    }
+
+    /**
+     * Deserializes the whole document, as deserialize() does.
+     *
+     * @return {Object|Array}
+     */
+    toObject() {
+        if (this.parent) {
+            return this.parent.decode(this.position);
+        }
+        return internalDeserialize(this.buffer, Object.assign({}, this.options, {
+            index: this.index,
+            allowObjectSmallerThanBufferSize: true
+        }));
+    }
+
+    /**
+     * @ignore
+     */
+    name(position) {
+        const i = position * 4;
+        return this.buffer.toString("utf8", this.elements[i + 1], this.elements[i + 2]);
+    }
+
+    /**
+     * @ignore
+     */
+    find(name) {
+        if (this.isArray) {
+            const position = is.string(name) ? Number(name) : name;
+            return is.integer(position) && position >= 0 && position < this.length ? position : -1;
+        }
+        if (!this.names) {
+            // the last element of a name is the one deserialize() keeps
+            this.names = new Map();
+            for (let i = 0; i < this.length; i++) {
+                this.names.set(this.name(i), i);
+            }
+        }
+        const position = this.names.get(name);
+        return is.undefined(position) ? -1 : position;
+    }
+
+    /**
+     * @ignore
+     */
+    value(position) {
+        const i = position * 4;
+        const type = this.elements[i];
+        const start = this.elements[i + 2] + 1;
+        const options = this.options;
+
+        if (type === constants.BSON_DATA_OBJECT || type === constants.BSON_DATA_ARRAY) {
+            const isArray = type === constants.BSON_DATA_ARRAY;
+            if (!options.raw && !(isArray && options.fieldsAsRaw && options.fieldsAsRaw[this.name(position)])) {
+                const view = new BSONView(this.buffer, Object.assign({}, options, { index: start }));
+                view.isArray = isArray;
+                view.parent = this;
+                view.position = position;
+                return view;
+            }
+        } else if (is.nil(options.promoteValues) || options.promoteValues) {
+            // the values that do not depend on the options
+            switch (type) {
+                case constants.BSON_DATA_INT:
+                    return this.buffer.readInt32LE(start);
+                case constants.BSON_DATA_NUMBER:
+                    return this.buffer.readDoubleLE(start);
+                case constants.BSON_DATA_NULL:
+                    return null;
+            }
+        }
+        return this.decode(position);
+    }
+
+    /**
+     * Deserializes an element in a document of its own.
+     *
+     * @ignore
+     */
+    decode(position) {
+        const i = position * 4;
+        const start = this.elements[i + 1] - 1;
+        const end = this.elements[i + 3];
+        const size = end - start + 5;
+        const document = Buffer.allocUnsafe(size);
+        document.writeInt32LE(size, 0);
+        this.buffer.copy(document, 4, start, end);
+        document[size - 1] = 0;
+
+        const options = Object.assign({}, this.options, { index: 0, allowObjectSmallerThanBufferSize: false });
+        const object = internalDeserialize(document, options, this.isArray);
+        return this.isArray ? object[0] : object[this.name(position)];
+    }
+}
+
+module.exports = BSONView;
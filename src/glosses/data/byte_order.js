@@ -0,0 +1,62 @@
+const {
+    data: { options }
+} = adone;
+
+adone.asNamespace(exports);
+
+const addon = options.usePureJavaScript ? null : require("./addon");
+
+// Shorter ranges are swapped by Buffer#swap16() and the like, calling the addon costs more
+const NATIVE_COPY_THRESHOLD = 64;
+
+/**
+ * Whether the typed arrays of this host store their elements little-endian.
+ */
+export const isLittleEndian = new Uint8Array(new Uint16Array([1]).buffer)[0] === 1;
+
+/**
+ * Copies bytes between Buffers or typed arrays, reversing the bytes of every element.
+ * The ranges may overlap.
+ *
+ * @param {Buffer|TypedArray} source
+ * @param {number} sourceStart byte offset in the source
+ * @param {Buffer|TypedArray} target
+ * @param {number} targetStart byte offset in the target
+ * @param {number} length number of bytes, a multiple of width
+ * @param {number} width size of the elements: 2, 4 or 8 bytes
+ */
+export const copySwapped = (source, sourceStart, target, targetStart, length, width) => {
+    if (addon && length >= NATIVE_COPY_THRESHOLD) {
+        addon.byteOrderCopySwapped(source, sourceStart, target, targetStart, length, width);
+        return;
+    }
+    if (width !== 2 && width !== 4 && width !== 8) {
+        throw new RangeError("Width must be 2, 4 or 8");
+    }
+    const from = Buffer.from(source.buffer, source.byteOffset + sourceStart, length);
+    const to = Buffer.from(target.buffer, target.byteOffset + targetStart, length);
+    from.copy(to);
+    if (width === 2) {
+        to.swap16();
+    } else if (width === 4) {
+        to.swap32();
+    } else {
+        to.swap64();
+    }
+};
+
+/**
+ * Gets the native kernel in use and the best one supported by the CPU.
+ *
+ * @return {active, best}, "avx2", "ssse3" or "scalar", "js" without the native addon.
+ */
+export const getKernel = () => addon ? addon.byteOrderGetKernel() : { active: "js", best: "js" };
+
+/**
+ * Forces a native kernel, typically only used for testing.
+ *
+ * @param name the name of the kernel.
+ *
+ * @return false if the kernel is unknown or not supported by the CPU.
+ */
+export const setKernel = (name) => addon ? addon.byteOrderSetKernel(name) : name === "js";
@@ -1,3 +1,8 @@
+// default options
+export const options = {
+    usePureJavaScript: false
+};
+
 adone.lazify({
     json: "./json",
     json5: "./json5",
@@ -11,5 +16,6 @@ adone.lazify({
     varint: "./varint",
     varintSigned: "./varint_signed",
     protobuf: "protons",
-    utf8: "./utf8"
+    utf8: "./utf8",
+    byteOrder: "./byte_order"
 }, adone.asNamespace(exports), require);
@@ -135,8 +135,84 @@ const stableEncode = function (obj, opts) {
     })({ "": obj }, "", obj, 0);
 };
 
+// The output of stableEncode() without a replacer and a comparison function. Numbers, booleans and
+// null are formatted without JSON.stringify(), and the quoted keys are cached since the objects of a
+// document mostly share their keys.
+const fastStableEncode = function (obj, space, cycles) {
+    if (is.number(space)) {
+        space = " ".repeat(space);
+    }
+    const colonSeparator = space ? ": " : ":";
+    const indents = [space ? "\n" : ""];
+    const keys = new Map();
+    const seen = [];
+
+    const quote = function (key) {
+        let quoted = keys.get(key);
+        if (is.undefined(quoted)) {
+            quoted = JSON.stringify(key) + colonSeparator;
+            keys.set(key, quoted);
+        }
+        return quoted;
+    };
+
+    const stringify = function (node, level) {
+        if (node && node.toJSON && is.function(node.toJSON)) {
+            node = node.toJSON();
+        }
+        switch (typeof node) {
+            case "undefined":
+                return;
+            case "number":
+                return isFinite(node) ? String(node) : "null";
+            case "boolean":
+                return node ? "true" : "false";
+            case "string":
+            case "symbol":
+                return JSON.stringify(node);
+        }
+        if (is.null(node)) {
+            return "null";
+        }
+        if (indents.length <= level + 1) {
+            indents.push(space ? `\n${space.repeat(level + 1)}` : "");
+        }
+        const indent = indents[level];
+        const itemIndent = indents[level + 1];
+        if (is.array(node)) {
+            const out = new Array(node.length);
+            for (let i = 0; i < node.length; i++) {
+                out[i] = itemIndent + (stringify(node[i], level + 1) || "null");
+            }
+            return `[${out.join(",")}${indent}]`;
+        }
+        if (seen.indexOf(node) !== -1) {
+            if (cycles) {
+                return JSON.stringify("__cycle__");
+            }
+            throw new TypeError("Converting circular structure to JSON");
+        }
+        seen.push(node);
+
+        const names = Object.keys(node).sort();
+        const out = [];
+        for (let i = 0; i < names.length; i++) {
+            const value = stringify(node[names[i]], level + 1);
+            if (value) {
+                out.push(itemIndent + quote(names[i]) + value);
+            }
+        }
+        seen.pop();
+        return `{${out.join(",")}${indent}}`;
+    };
+    return stringify(obj, 0);
+};
+
 const encodeStable = (obj, { space = "", replacer, cycles = false, cmp } = {}) => {
-    return Buffer.from(stableEncode(obj, { space, replacer, cycles, cmp }), "utf8");
+    const str = !replacer && !cmp
+        ? fastStableEncode(obj, space, cycles)
+        : stableEncode(obj, { space, replacer, cycles, cmp });
+    return Buffer.from(str, "utf8");
 };
 
 export default encodeStable;
@@ -13,5 +13,6 @@ export const decode = (buf) => JSON.parse(buf.toString());
 adone.lazify({
     encodeStable: "./encode_stable",
     encodeSafe: "./encode_safe",
-    decodeSafe: "./decode_safe"
+    decodeSafe: "./decode_safe",
+    Parser: "./parser"
 }, adone.asNamespace(exports), require);
@@ -0,0 +1,506 @@
+const {
+    is,
+    data: { options }
+} = adone;
+
+const addon = options.usePureJavaScript ? null : require("../addon");
+
+const QUOTE = 0x22;
+const BACKSLASH = 0x5C;
+const EMPTY = Buffer.alloc(0);
+// Deeper containers are errors
+const MAX_DEPTH = 10000;
+
+// what the scanner expects next in a container
+const VALUE = 0;
+const KEY = 1;
+const COLON = 2;
+const COMMA = 3;
+
+const isWhitespace = (c) => c === 0x20 || c === 0x0A || c === 0x0D || c === 0x09;
+
+// , : [ ] { }
+const isStructural = (c) => c === 0x2C || c === 0x3A || c === 0x5B || c === 0x5D || c === 0x7B || c === 0x7D;
+
+const newNode = () => ({ slot: -1, keys: new Map(), indexes: new Map() });
+
+// The trie of the paths: a node has the slot of the value selected at its path, -1 if there is
+// none, and its children by key and by array index. The root is the value itself. Returns the nodes
+// and the slot of every path, paths that are the same share their slot.
+const compile = (paths) => {
+    const nodes = [newNode()];
+    const slots = [];
+    let slotCount = 0;
+    for (const path of paths) {
+        const segments = is.array(path) ? path : String(path).split(".");
+        let node = 0;
+        for (const segment of segments) {
+            const key = String(segment);
+            let child = nodes[node].keys.get(key);
+            if (is.undefined(child)) {
+                child = nodes.length;
+                nodes.push(newNode());
+                nodes[node].keys.set(key, child);
+                if (/^(0|[1-9]\d{0,8})$/.test(key)) {
+                    nodes[node].indexes.set(Number(key), child);
+                }
+            }
+            node = child;
+        }
+        if (nodes[node].slot === -1) {
+            nodes[node].slot = slotCount++;
+        }
+        slots.push(nodes[node].slot);
+    }
+    return { nodes, slots, slotCount };
+};
+
+// The trie as the addon reads it: an Int32Array of the number of nodes, then for every node its
+// slot, its number of keys and of indexes, the offset, length and node of every key in the keys,
+// and the index and node of every index; and a Buffer of the keys.
+const toTable = (nodes) => {
+    const table = [nodes.length];
+    const keys = [];
+    let offset = 0;
+    for (const node of nodes) {
+        table.push(node.slot, node.keys.size, node.indexes.size);
+        for (const [key, child] of node.keys) {
+            const bytes = Buffer.from(key, "utf8");
+            table.push(offset, bytes.length, child);
+            keys.push(bytes);
+            offset += bytes.length;
+        }
+        for (const [index, child] of node.indexes) {
+            table.push(index, child);
+        }
+    }
+    return { table: Int32Array.from(table), keys: Buffer.concat(keys) };
+};
+
+// The scanner of the addon (native/src/json/scanner.h) one byte at a time
+class Scanner {
+    constructor(nodes, elements, state) {
+        this.nodes = nodes;
+        this.elements = elements;
+        this.state = state;
+        this.slotCount = 0;
+        for (const node of nodes) {
+            this.slotCount = Math.max(this.slotCount, node.slot + 1);
+        }
+        this.slots = new Array(2 * this.slotCount).fill(0);
+        this.stack = [this.frame(0, VALUE, true, 0, -1, 0, 0)];
+        this.scanned = 0;
+        this.escaped = false;
+        this.inString = false;
+        this.stringStart = 0;
+        this.stringNode = -1;
+        this.out = null;
+        this.lastEnd = 0;
+        this.trimStart = 0;
+        this.trimEnd = 0;
+        // the depth in the container being skipped, 0 if none is
+        this.skipDepth = 0;
+    }
+
+    frame(kind, expect, records, node, child, start, from) {
+        return { kind, expect, records, node, child, index: 0, start, from };
+    }
+
+    scan(data, length, final) {
+        this.out = [];
+        this.lastEnd = 0;
+        this.state[0] = 0;
+        for (let pos = this.scanned; pos < length; pos++) {
+            const c = data[pos];
+            const escaped = this.escaped;
+            this.escaped = c === BACKSLASH && !escaped;
+            if (c === QUOTE ? escaped : this.inString || !isStructural(c)) {
+                continue;
+            }
+            if (this.skipDepth !== 0) {
+                // only the brackets count until the container ends
+                if (c === QUOTE) {
+                    this.inString = !this.inString;
+                } else if (c === 0x5B || c === 0x7B) {
+                    this.skipDepth++;
+                } else if ((c === 0x5D || c === 0x7D) && --this.skipDepth === 0 && !this.close(data, pos)) {
+                    this.state[1] = pos;
+                    return;
+                }
+                continue;
+            }
+            if (!this.step(data, pos)) {
+                this.state[1] = pos;
+                return;
+            }
+        }
+        this.scanned = length;
+
+        const top = !this.inString && this.stack.length === 1;
+        if (top) {
+            this.tokens(data, length, final);
+        }
+        if (final && !top) {
+            this.state[1] = -1;
+            return;
+        }
+        this.rebase(top ? this.stack[0].from : this.lastEnd);
+        if (final) {
+            this.escaped = false;
+        }
+        return Uint32Array.from(this.out);
+    }
+
+    step(data, pos) {
+        const top = this.stack[this.stack.length - 1];
+        if (this.inString) {
+            this.inString = false;
+            if (top.expect === KEY) {
+                top.child = top.node < 0 ? -1 : this.child(top.node, data, this.stringStart + 1, pos);
+                top.expect = COLON;
+            } else {
+                this.end(top, this.stringNode, this.stringStart, pos + 1);
+            }
+            top.from = pos + 1;
+            return true;
+        }
+
+        const c = data[pos];
+        switch (c) {
+            case QUOTE:
+            case 0x7B: // {
+            case 0x5B: { // [
+                if (top.kind === 0) {
+                    this.tokens(data, pos, true);
+                } else {
+                    if (this.trim(data, top.from, pos) || (top.expect !== VALUE && (top.expect !== KEY || c !== QUOTE))) {
+                        return false;
+                    }
+                    if (top.expect === KEY) {
+                        this.inString = true;
+                        this.stringStart = pos;
+                        return true;
+                    }
+                }
+                const outer = this.elements && c === 0x5B && top.kind === 0;
+                let node = -1;
+                if (top.records && !outer) {
+                    this.begin();
+                    node = 0;
+                } else if (!top.records) {
+                    node = top.child;
+                }
+                if (c === QUOTE) {
+                    this.inString = true;
+                    this.stringStart = pos;
+                    this.stringNode = node;
+                    return true;
+                }
+                if (this.stack.length >= MAX_DEPTH) {
+                    return false;
+                }
+                const frame = this.frame(c, c === 0x7B ? KEY : VALUE, outer, node, c === 0x5B && node >= 0 ? this.index(node, 0) : -1, pos, pos + 1);
+                this.stack.push(frame);
+                if (!outer && (node < 0 || (this.nodes[node].keys.size === 0 && this.nodes[node].indexes.size === 0))) {
+                    // no value is selected in the container
+                    this.skipDepth = 1;
+                }
+                return true;
+            }
+            case 0x7D: // }
+            case 0x5D: { // ]
+                if (top.kind !== (c === 0x7D ? 0x7B : 0x5B)) {
+                    return false;
+                }
+                if (!this.scalar(data, pos)) {
+                    // only an empty container ends where a value is expected
+                    if (top.index !== 0 || top.expect !== (c === 0x7D ? KEY : VALUE) || this.trim(data, top.from, pos)) {
+                        return false;
+                    }
+                }
+                return this.close(data, pos);
+            }
+            case 0x2C: // ,
+                if (top.kind === 0 || !this.scalar(data, pos)) {
+                    return false;
+                }
+                top.index++;
+                top.from = pos + 1;
+                if (top.kind === 0x7B) {
+                    top.expect = KEY;
+                    top.child = -1;
+                } else {
+                    top.expect = VALUE;
+                    top.child = top.node < 0 ? -1 : this.index(top.node, top.index);
+                }
+                return true;
+            default: // :
+                if (top.kind !== 0x7B || top.expect !== COLON) {
+                    return false;
+                }
+                top.expect = VALUE;
+                top.from = pos + 1;
+                return true;
+        }
+    }
+
+    close(data, pos) {
+        const closed = this.stack[this.stack.length - 1];
+        if (closed.kind !== (data[pos] === 0x7D ? 0x7B : 0x5B)) {
+            return false;
+        }
+        this.stack.pop();
+        const parent = this.stack[this.stack.length - 1];
+        if (!closed.records) {
+            this.end(parent, closed.node, closed.start, pos + 1);
+        }
+        parent.from = pos + 1;
+        return true;
+    }
+
+    // Trims the whitespace around the bytes from start to end to trimStart and trimEnd, returns false
+    // if only whitespace is left
+    trim(data, start, end) {
+        while (start < end && isWhitespace(data[start])) {
+            start++;
+        }
+        while (end > start && isWhitespace(data[end - 1])) {
+            end--;
+        }
+        this.trimStart = start;
+        this.trimEnd = end;
+        return start < end;
+    }
+
+    scalar(data, pos) {
+        const top = this.stack[this.stack.length - 1];
+        const scalar = this.trim(data, top.from, pos);
+        if (top.expect !== VALUE) {
+            return top.expect === COMMA && !scalar;
+        }
+        if (!scalar) {
+            return false;
+        }
+        if (top.records) {
+            this.begin();
+        }
+        this.end(top, top.records ? 0 : top.child, this.trimStart, this.trimEnd);
+        return true;
+    }
+
+    begin() {
+        this.slots.fill(0);
+    }
+
+    end(frame, node, start, end) {
+        if (node >= 0 && this.nodes[node].slot >= 0) {
+            this.slots[2 * this.nodes[node].slot] = start;
+            this.slots[2 * this.nodes[node].slot + 1] = end;
+        }
+        frame.expect = frame.kind === 0 ? VALUE : COMMA;
+        if (frame.records) {
+            this.out.push(start, end, ...this.slots);
+            this.lastEnd = end;
+        }
+    }
+
+    tokens(data, end, final) {
+        const stream = this.stack[0];
+        let pos = stream.from;
+        while (pos < end) {
+            if (isWhitespace(data[pos])) {
+                pos++;
+                continue;
+            }
+            const start = pos;
+            while (pos < end && !isWhitespace(data[pos])) {
+                pos++;
+            }
+            if (pos === end && !final) {
+                stream.from = start;
+                return;
+            }
+            this.begin();
+            this.end(stream, 0, start, pos);
+        }
+        stream.from = end;
+    }
+
+    child(node, data, start, end) {
+        const child = this.nodes[node].keys.get(data.toString("utf8", start, end));
+        return is.undefined(child) ? -1 : child;
+    }
+
+    index(node, index) {
+        const child = this.nodes[node].indexes.get(index);
+        return is.undefined(child) ? -1 : child;
+    }
+
+    rebase(offset) {
+        this.state[0] = offset;
+        if (offset === 0) {
+            return;
+        }
+        this.scanned -= offset;
+        this.stringStart = Math.max(this.stringStart - offset, 0);
+        for (const frame of this.stack) {
+            frame.start = Math.max(frame.start - offset, 0);
+            frame.from = Math.max(frame.from - offset, 0);
+        }
+        for (let i = 0; i < this.slots.length; i += 2) {
+            if (this.slots[i + 1] !== 0) {
+                this.slots[i] -= offset;
+                this.slots[i + 1] -= offset;
+            }
+        }
+    }
+}
+
+const parse = (data, start, end) => JSON.parse(data.toString("utf8", start, end));
+
+/**
+ * Incremental parser of streams of JSON texts, concatenated or one per line (NDJSON).
+ *
+ * The chunks of the stream are scanned for the bounds of its values, natively with SIMD instructions
+ * when the addon is built, and only the values, or the selected parts of them, are parsed. The
+ * bytes of a value are kept until it ends, the ones before are released.
+ *
+ * @example
+ * const parser = new adone.data.json.Parser({ paths: ["id", "user.name", "tags.0"] });
+ * for await (const chunk of stream) {
+ *     for (const [id, name, tag] of parser.push(chunk)) {
+ *         // ...
+ *     }
+ * }
+ * parser.end();
+ */
+export default class Parser {
+    /**
+     * @param {Object} [options]
+     * @param {Array} [options.paths] the paths of the values to select from every value, as strings of
+     *  keys separated by dots or as arrays of keys; numeric keys are indexes in arrays as well.
+     *  The values are then arrays of the selected values, undefined if they are missing.
+     * @param {Boolean} [options.elements] whether the values of the stream are the elements of the
+     *  arrays at its top, to parse a large array one element at a time
+     */
+    constructor({ paths, elements = false } = {}) {
+        const trie = compile(paths || []);
+        this.paths = paths ? trie.slots : null;
+        this.width = 2 + 2 * trie.slotCount;
+        // the number of bytes consumed and the position of an error
+        this.state = new Float64Array(2);
+        if (addon) {
+            const { table, keys } = toTable(trie.nodes);
+            this.scanner = new addon.JsonScanner(table, keys, elements, this.state);
+        } else {
+            this.scanner = new Scanner(trie.nodes, elements, this.state);
+        }
+        // the bytes that are not consumed, and the position of the first one in the stream
+        this.buffer = null;
+        this.length = 0;
+        this.offset = 0;
+    }
+
+    /**
+     * Parses the values that end in the chunk.
+     * An invalid value throws a SyntaxError with the values before it in its `values`, the stream goes on after it.
+     *
+     * @param {Buffer|Uint8Array|String} chunk
+     * @return {Array} the values, or the arrays of their selected values
+     */
+    push(chunk) {
+        return this._scan(chunk, false);
+    }
+
+    /**
+     * Parses the values that end in the last chunk, throws if the last value is not complete.
+     *
+     * @param {Buffer|Uint8Array|String} [chunk]
+     * @return {Array}
+     */
+    end(chunk) {
+        return this._scan(is.nil(chunk) ? EMPTY : chunk, true);
+    }
+
+    _scan(chunk, final) {
+        if (is.string(chunk)) {
+            chunk = Buffer.from(chunk, "utf8");
+        } else if (!is.buffer(chunk)) {
+            chunk = Buffer.from(chunk.buffer, chunk.byteOffset, chunk.byteLength);
+        }
+        let data = chunk;
+        let length = chunk.length;
+        if (this.length !== 0) {
+            this._append(chunk);
+            data = this.buffer;
+            length = this.length;
+        }
+
+        const ranges = this.scanner.scan(data, length, final);
+        if (is.undefined(ranges)) {
+            const pos = this.state[1];
+            throw new SyntaxError(pos === -1
+                ? "Unexpected end of JSON input"
+                : `Unexpected token ${String.fromCharCode(data[pos])} in JSON at position ${this.offset + pos}`);
+        }
+        // the scanner has consumed the values already, the bytes are released even if one of them is invalid
+        const offset = this.offset;
+        try {
+            return this._values(data, ranges, offset);
+        } finally {
+            const consumed = this.state[0];
+            this.offset += consumed;
+            if (data === chunk) {
+                this.length = 0;
+                if (consumed < length) {
+                    this._append(chunk.subarray(consumed));
+                }
+            } else if (consumed !== 0) {
+                this.buffer.copyWithin(0, consumed, length);
+                this.length = length - consumed;
+            }
+        }
+    }
+
+    _values(data, ranges, offset) {
+        const values = [];
+        const slots = this.paths;
+        const value = (start, end) => {
+            try {
+                return parse(data, start, end);
+            } catch (err) {
+                const error = new SyntaxError(`Invalid JSON value at position ${offset + start}: ${err.message}`);
+                // the values before the invalid one
+                error.values = values;
+                throw error;
+            }
+        };
+        for (let i = 0; i < ranges.length; i += this.width) {
+            if (!slots) {
+                values.push(value(ranges[i], ranges[i + 1]));
+                continue;
+            }
+            const selected = [];
+            for (let j = 0; j < slots.length; j++) {
+                const k = i + 2 + 2 * slots[j];
+                selected.push(ranges[k + 1] === 0 ? undefined : value(ranges[k], ranges[k + 1]));
+            }
+            values.push(selected);
+        }
+        return values;
+    }
+
+    // Appends to the bytes that are not consumed, the buffer grows twice as large to copy them once
+    _append(bytes) {
+        const length = this.length + bytes.length;
+        if (!this.buffer || this.buffer.length < length) {
+            const buffer = Buffer.allocUnsafe(Math.max(length, this.buffer ? 2 * this.buffer.length : 0, 4096));
+            if (this.buffer) {
+                this.buffer.copy(buffer, 0, 0, this.length);
+            }
+            this.buffer = buffer;
+        }
+        bytes.copy(this.buffer, this.length);
+        this.length = length;
+    }
+}
@@ -1,19 +1,101 @@
 const {
     is,
-    buffer: { SmartBuffer }
+    buffer: { SmartBuffer },
+    data: { options }
 } = adone;
 
+const addon = options.usePureJavaScript ? null : require("./addon");
+
+// The addon writes the values encoded without a buffer here, they are copied to a buffer of their size
+const scratch = addon ? Buffer.allocUnsafeSlow(8192) : null;
+let scratchUsed = false;
+
 export class Encoder {
     constructor(encodingTypes) {
         this._encodingTypes = encodingTypes;
+        // The addon encodes the values without extensions, the other ones are encoded here
+        this._encodeFallback = (x) => {
+            const buf = new SmartBuffer(64, true);
+            this._encode(x, buf);
+            return buf.toBuffer();
+        };
     }
 
     encode(x, buf) {
+        if (addon) {
+            return buf ? this._encodeNative(x, buf) : this._encodeNativeNew(x);
+        }
         buf = buf || new SmartBuffer(1024, true);
         this._encode(x, buf);
         return buf;
     }
 
+    // Writes a frame of the value: the size of the rest of the frame (uint32 BE), the value, the flags
+    // (uint8) and the id (varint32). Nothing is written if the value cannot be encoded.
+    encodeFrame(x, flags, id, buf) {
+        if (addon && Object.getPrototypeOf(buf.buffer) === Buffer.prototype) {
+            this._appendNative(addon.mpakEncodeFrame(x, flags, id, this._encodeFallback, buf.buffer, buf.woffset), buf);
+            return buf;
+        }
+        const start = buf.woffset;
+        try {
+            buf.writeUInt32BE(0);
+            this.encode(x, buf);
+            buf.writeUInt8(flags);
+            buf.writeVarint32(id);
+        } catch (err) {
+            buf.woffset = start;
+            throw err;
+        }
+        buf.writeUInt32BE(buf.woffset - start - 4, start);
+        return buf;
+    }
+
+    _encodeNative(x, buf) {
+        if (Object.getPrototypeOf(buf.buffer) !== Buffer.prototype) {
+            // the addon writes to Buffers only
+            const encoded = this._encodeNativeNew(x);
+            buf.write(encoded);
+            return buf;
+        }
+        this._appendNative(addon.mpakEncode(x, this._encodeFallback, buf.buffer, buf.woffset), buf);
+        return buf;
+    }
+
+    // The addon returns the number of bytes it wrote to the buffer, or the bytes that did not fit in it
+    _appendNative(result, buf) {
+        if (is.number(result)) {
+            buf.woffset += result;
+        } else {
+            buf.ensureCapacity(buf.woffset + result.length);
+            result.copy(buf.buffer, buf.woffset);
+            buf.woffset += result.length;
+        }
+    }
+
+    _encodeNativeNew(x) {
+        if (scratchUsed) {
+            // called again from a fallback
+            return this._encodeNative(x, new SmartBuffer(256, true));
+        }
+        let result;
+        scratchUsed = true;
+        try {
+            result = addon.mpakEncode(x, this._encodeFallback, scratch, 0);
+        } finally {
+            scratchUsed = false;
+        }
+        const buf = new SmartBuffer(0, true);
+        if (is.number(result)) {
+            buf.buffer = Buffer.allocUnsafe(result);
+            scratch.copy(buf.buffer, 0, 0, result);
+        } else {
+            buf.buffer = result;
+        }
+        buf.woffset = buf.buffer.length;
+        return buf;
+    }
+
     _encode(x, buf) {
         const type = typeof (x);
         switch (type) {
@@ -216,9 +298,32 @@ const isValidDataSize = (dataLength, bufLength, headerLength) => bufLength >= he
 export class Decoder {
     constructor(decodingTypes) {
         this._decodingTypes = decodingTypes;
+        // The addon returns the number of bytes consumed here, 0 if the value is incomplete, and whether
+        // a frame is not valid
+        this._state = new Float64Array(2);
+        // The addon decodes the values without extensions, the other ones are decoded here
+        this._decodeFallback = (bytes, offset, end) => {
+            const buf = new SmartBuffer(0, true);
+            buf.buffer = bytes;
+            buf.roffset = offset;
+            buf.woffset = end;
+            return this._tryDecode(buf);
+        };
     }
 
     decode(buf) {
+        if (buf instanceof Uint8Array && !is.buffer(buf)) {
+            // the values decoded in JavaScript read strings and binary values through Buffer methods
+            buf = Buffer.from(buf.buffer, buf.byteOffset, buf.byteLength);
+        }
+        if (addon && buf instanceof Uint8Array) {
+            // decoded in place, binary values are views of the input
+            const value = addon.mpakDecode(buf, 0, buf.length, this._state, this._decodeFallback, this._undefinedExt());
+            if (this._state[0] === 0) {
+                throw new adone.error.IncompleteBufferError();
+            }
+            return value;
+        }
         if (!is.smartBuffer(buf)) {
             buf = SmartBuffer.wrap(buf, undefined, true);
         }
@@ -231,6 +336,65 @@ export class Decoder {
     }
 
     tryDecode(buf) {
+        if (!addon) {
+            return this._tryDecode(buf);
+        }
+        const value = addon.mpakDecode(buf.buffer, buf.roffset, buf.woffset, this._state, this._decodeFallback, this._undefinedExt());
+        const bytesConsumed = this._state[0];
+        if (bytesConsumed === 0) {
+            // incomplete, decoded again in JavaScript to move the read offset as it always has
+            return this._tryDecode(buf);
+        }
+        buf.roffset += bytesConsumed;
+        return buildDecodeResult(value, bytesConsumed);
+    }
+
+    // Decodes the complete frames (see Encoder#encodeFrame) from the read offset and moves it after them.
+    // Appends the flags, the id and the value of each frame to `frames`, returns false if it stopped at
+    // a frame that is not valid.
+    decodeFrames(buf, frames) {
+        if (addon) {
+            addon.mpakDecodeFrames(buf.buffer, buf.roffset, buf.woffset, this._state, this._decodeFallback, this._undefinedExt(), frames);
+            buf.roffset += this._state[0];
+            return this._state[1] === 0;
+        }
+        while (buf.length >= 4) {
+            const size = buf.buffer.readUInt32BE(buf.roffset);
+            if (buf.length - 4 < size) {
+                break;
+            }
+            const end = buf.roffset + 4 + size;
+            const frame = new SmartBuffer(0, true);
+            frame.buffer = buf.buffer;
+            frame.roffset = buf.roffset + 4;
+            frame.woffset = end;
+            const result = this._tryDecode(frame);
+            if (!result || frame.length === 0) {
+                return false;
+            }
+            const flags = frame.readUInt8();
+            const id = frame.readVarint32();
+            if (frame.roffset !== end) {
+                return false;
+            }
+            frames.push(flags, id, result.value);
+            buf.roffset = end;
+        }
+        return true;
+    }
+
+    // The addon decodes the undefined extension unless a type 0 is registered
+    _undefinedExt() {
+        const decTypes = this._decodingTypes;
+        for (let i = 0; i < decTypes.length; ++i) {
+            if (decTypes[i].type === 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    _tryDecode(buf) {
         const bufLength = buf.length;
         if (bufLength <= 0) {
             return null;
@@ -439,9 +603,9 @@ export class Decoder {
         let totalBytesConsumed = 0;
 
         for (let i = 0; i < length; ++i) {
-            const keyResult = this.tryDecode(buf);
+            const keyResult = this._tryDecode(buf);
             if (keyResult) {
-                const valueResult = this.tryDecode(buf);
+                const valueResult = this._tryDecode(buf);
                 if (valueResult) {
                     key = keyResult.value;
                     result[key] = valueResult.value;
@@ -461,7 +625,7 @@ export class Decoder {
         let totalBytesConsumed = 0;
 
         for (let i = 0; i < length; ++i) {
-            const decodeResult = this.tryDecode(buf);
+            const decodeResult = this._tryDecode(buf);
             if (decodeResult) {
                 result.push(decodeResult.value);
                 totalBytesConsumed += decodeResult.bytesConsumed;
@@ -0,0 +1,122 @@
+#include "data.h"
+#include "base32/base32.h"
+
+#include <adone_trace.h>
+
+namespace nodedata
+{
+
+// The state of a JS Encoder or Decoder as an Int32Array of [shift, carry]
+static bool GetState(v8::Local<v8::Value> value, base32::State *state, int32_t **words)
+{
+  if (!value->IsInt32Array())
+  {
+    Nan::ThrowTypeError("State must be an Int32Array");
+    return false;
+  }
+  Nan::TypedArrayContents<int32_t> view(value);
+  if (view.length() < 2)
+  {
+    Nan::ThrowError("State must have 2 entries");
+    return false;
+  }
+  *words = *view;
+  state->shift = (*words)[0];
+  state->carry = (*words)[1];
+  return true;
+}
+
+// base32Encode(bytes, alphabet, state), returns the characters as a string and updates the state.
+// Returns undefined if the alphabet is not made of 32 Latin-1 characters, the JS encoder handles it.
+NAN_METHOD(Base32Encode)
+{
+  const uint8_t *data;
+  size_t length;
+  if (!GetBytes(info[0], &data, &length))
+  {
+    return Nan::ThrowTypeError("Input must be a Buffer or an Uint8Array");
+  }
+  if (!info[1]->IsString() || !info[1].As<v8::String>()->IsOneByte() || info[1].As<v8::String>()->Length() < 32)
+  {
+    return;
+  }
+  uint8_t alphabet[32];
+  info[1].As<v8::String>()->WriteOneByte(v8::Isolate::GetCurrent(), alphabet, 0, 32,
+                                         v8::String::NO_NULL_TERMINATION);
+  base32::State state;
+  int32_t *words;
+  if (!GetState(info[2], &state, &words))
+  {
+    return;
+  }
+  std::vector<uint8_t> out(base32::EncodeBound(length));
+  size_t n;
+  {
+    ADONE_TRACE_SCOPE("data", "base32:encode");
+    n = base32::Encode(&state, alphabet, data, length, out.data());
+  }
+  words[0] = state.shift;
+  words[1] = state.carry;
+  info.GetReturnValue().Set(NewAsciiString(out.data(), n));
+}
+
+// base32Decode(string, table, state), the table is an Uint16Array with the symbol of every ASCII
+// character once upper-cased. Returns the bytes as a Buffer and updates the state, or undefined
+// without touching the state if the string is not ASCII, the JS decoder handles it.
+NAN_METHOD(Base32Decode)
+{
+  if (!info[0]->IsString())
+  {
+    return Nan::ThrowTypeError("Input must be a string");
+  }
+  if (!info[1]->IsUint16Array())
+  {
+    return Nan::ThrowTypeError("Table must be an Uint16Array");
+  }
+  Nan::TypedArrayContents<uint16_t> view(info[1]);
+  if (view.length() < 128)
+  {
+    return Nan::ThrowError("Table must have 128 entries");
+  }
+  if (!info[0].As<v8::String>()->IsOneByte())
+  {
+    return;
+  }
+  Text text;
+  text.Get(info[0]);
+  uint16_t table[256];
+  for (size_t i = 0; i < 256; i++)
+  {
+    table[i] = i < 128 ? (*view)[i] : base32::kSkip;
+  }
+  for (size_t i = 0; i < text.length; i++)
+  {
+    if (text.data[i] >= 0x80)
+    {
+      return;
+    }
+  }
+  base32::State state;
+  int32_t *words;
+  if (!GetState(info[2], &state, &words))
+  {
+    return;
+  }
+  std::vector<uint8_t> out(base32::DecodeBound(text.length));
+  size_t n;
+  {
+    ADONE_TRACE_SCOPE("data", "base32:decode");
+    n = base32::Decode(&state, table, text.data, text.length, out.data());
+  }
+  words[0] = state.shift;
+  words[1] = state.carry;
+  info.GetReturnValue().Set(Nan::CopyBuffer(reinterpret_cast<char *>(out.data()), static_cast<uint32_t>(n)).ToLocalChecked());
+}
+
+NAN_MODULE_INIT(InitBase32)
+{
+  Nan::SetMethod(target, "base32Encode", Base32Encode);
+  Nan::SetMethod(target, "base32Decode", Base32Decode);
+}
+
+} // namespace nodedata
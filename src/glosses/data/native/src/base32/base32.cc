@@ -0,0 +1,138 @@
+#include "base32.h"
+
+namespace nodedata
+{
+namespace base32
+{
+
+size_t EncodeBound(size_t length)
+{
+  // two characters for every byte at most, and the symbol left by the previous call
+  return length * 2 + 1;
+}
+
+size_t DecodeBound(size_t length)
+{
+  return length;
+}
+
+size_t Encode(State *state, const uint8_t alphabet[32], const uint8_t *in, size_t length, uint8_t *out)
+{
+  int32_t shift = state->shift;
+  int32_t carry = state->carry;
+  size_t n = 0;
+  size_t i = 0;
+  while (i < length)
+  {
+    if (shift == 8)
+    {
+      // the last symbol of a group is written with the next byte by the JS encoder
+      out[n++] = alphabet[carry & 0x1F];
+      shift = 3;
+      carry = 0;
+    }
+    if (shift == 3)
+    {
+      for (; i + 5 <= length; i += 5, n += 8)
+      {
+        uint64_t w = (static_cast<uint64_t>(in[i]) << 32) | (static_cast<uint64_t>(in[i + 1]) << 24) |
+                     (static_cast<uint64_t>(in[i + 2]) << 16) | (static_cast<uint64_t>(in[i + 3]) << 8) | in[i + 4];
+        for (int k = 0; k < 8; k++)
+        {
+          out[n + k] = alphabet[(w >> (35 - 5 * k)) & 0x1F];
+        }
+      }
+      if (i == length)
+      {
+        break;
+      }
+    }
+    int32_t byte = in[i++];
+    int32_t symbol = carry | (byte >> shift);
+    out[n++] = alphabet[symbol & 0x1F];
+    if (shift > 5)
+    {
+      shift -= 5;
+      out[n++] = alphabet[(byte >> shift) & 0x1F];
+    }
+    shift = 5 - shift;
+    carry = byte << shift;
+    shift = 8 - shift;
+  }
+  state->shift = shift;
+  state->carry = carry;
+  return n;
+}
+
+size_t Decode(State *state, const uint16_t table[256], const uint8_t *in, size_t length, uint8_t *out)
+{
+  int32_t shift = state->shift;
+  int32_t carry = state->carry;
+  size_t n = 0;
+  size_t i = 0;
+  while (i < length)
+  {
+    if (shift == 8 && carry == 0)
+    {
+      for (; i + 8 <= length; i += 8, n += 5)
+      {
+        uint64_t w = 0;
+        uint16_t all = 0;
+        for (int k = 0; k < 8; k++)
+        {
+          uint16_t symbol = table[in[i + k]];
+          all |= symbol;
+          w = (w << 5) | (symbol & 0x1F);
+        }
+        // padding or symbols above 31 go through the bit machine
+        if (all > 0x1F)
+        {
+          break;
+        }
+        out[n] = static_cast<uint8_t>(w >> 32);
+        out[n + 1] = static_cast<uint8_t>(w >> 24);
+        out[n + 2] = static_cast<uint8_t>(w >> 16);
+        out[n + 3] = static_cast<uint8_t>(w >> 8);
+        out[n + 4] = static_cast<uint8_t>(w);
+      }
+      if (i == length)
+      {
+        break;
+      }
+    }
+    // a group with other characters
+    size_t end = length - i < 8 ? length : i + 8;
+    for (; i < end; i++)
+    {
+      uint16_t entry = table[in[i]];
+      if (entry == kSkip)
+      {
+        continue;
+      }
+      int32_t symbol = entry;
+      shift -= 5;
+      if (shift > 0)
+      {
+        carry |= symbol << shift;
+      }
+      else if (shift < 0)
+      {
+        out[n++] = static_cast<uint8_t>(carry | (symbol >> -shift));
+        shift += 8;
+        carry = (symbol << shift) & 0xFF;
+      }
+      else
+      {
+        out[n++] = static_cast<uint8_t>(carry | symbol);
+        shift = 8;
+        carry = 0;
+      }
+    }
+  }
+  state->shift = shift;
+  state->carry = carry;
+  return n;
+}
+
+} // namespace base32
+} // namespace nodedata
@@ -0,0 +1,41 @@
+#ifndef __DATA_BASE32_H_
+#define __DATA_BASE32_H_
+
+// Table-driven base 32 with any alphabet, following the bit machine of data/base32.js so that the
+// native and the JS code can take turns on the same stream.
+//
+// The state is the one of the JS Encoder and Decoder: the encoder starts at shift 3 and the
+// decoder at shift 8, both with no carry. Whole groups of 5 bytes and 8 characters are converted
+// through 40-bit words when the state is at a group boundary. The encoder writes the last symbol of
+// a group right away where the JS code waits for the next byte, the output is the same.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace nodedata
+{
+namespace base32
+{
+
+struct State
+{
+  int32_t shift;
+  int32_t carry;
+};
+
+// Decoding table entry of the characters that are ignored ('=')
+static const uint16_t kSkip = 0x100;
+
+// The maximum output of Encode() and Decode()
+size_t EncodeBound(size_t length);
+size_t DecodeBound(size_t length);
+
+// Returns the number of characters written, `alphabet` has 32 characters
+size_t Encode(State *state, const uint8_t alphabet[32], const uint8_t *in, size_t length, uint8_t *out);
+// Returns the number of bytes written, `table` has the symbol of every character, or kSkip
+size_t Decode(State *state, const uint16_t table[256], const uint8_t *in, size_t length, uint8_t *out);
+
+} // namespace base32
+} // namespace nodedata
+
+#endif // __DATA_BASE32_H_
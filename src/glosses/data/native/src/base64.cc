@@ -0,0 +1,187 @@
+#include "data.h"
+#include "base64/base64.h"
+
+#include <adone_trace.h>
+
+#include <string.h> // strcmp
+
+namespace nodedata
+{
+
+static inline base64::Alphabet GetAlphabet(v8::Local<v8::Value> url)
+{
+  return Nan::To<bool>(url).FromJust() ? base64::kAlphabetUrl : base64::kAlphabetStandard;
+}
+
+// A Buffer of `bound` bytes shrunk to the `length` bytes written
+static v8::Local<v8::Object> Shrink(std::vector<uint8_t> &bytes, size_t length)
+{
+  return Nan::CopyBuffer(reinterpret_cast<char *>(bytes.data()), static_cast<uint32_t>(length)).ToLocalChecked();
+}
+
+// Streaming encoder exported as the Base64Encoder class.
+//
+// new Base64Encoder(url, pad, lineLength, delimiter), update(bytes) returns the characters of the
+// whole groups as a Buffer and final() the last ones, after which the encoder can be reused.
+class Base64Encoder : public Nan::ObjectWrap
+{
+public:
+  static void Init(v8::Local<v8::Object> target)
+  {
+    v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+    tpl->SetClassName(NanStr("Base64Encoder"));
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+    Nan::SetPrototypeMethod(tpl, "update", Update);
+    Nan::SetPrototypeMethod(tpl, "final", Final);
+    Nan::Set(target, NanStr("Base64Encoder"), Nan::GetFunction(tpl).ToLocalChecked());
+  }
+
+private:
+  static NAN_METHOD(New)
+  {
+    if (!info.IsConstructCall())
+    {
+      return Nan::ThrowTypeError("Class constructor cannot be invoked without 'new'");
+    }
+    bool pad = info[1]->IsUndefined() || Nan::To<bool>(info[1]).FromJust();
+    double lineLength = info[2]->IsNumber() ? Nan::To<double>(info[2]).FromJust() : 0;
+    if (!(lineLength >= 0) || lineLength > 0x7FFFFFFF)
+    {
+      return Nan::ThrowRangeError("Invalid line length");
+    }
+    Text delimiter;
+    if (!info[3]->IsUndefined() && !delimiter.Get(info[3]))
+    {
+      return Nan::ThrowTypeError("Delimiter must be a string or a Buffer");
+    }
+    if (delimiter.length > base64::kMaxDelimiterBytes)
+    {
+      return Nan::ThrowRangeError("Delimiter is too long");
+    }
+    Base64Encoder *encoder = new Base64Encoder();
+    base64::EncodeInit(&encoder->state, GetAlphabet(info[0]), pad, static_cast<size_t>(lineLength), delimiter.data,
+                       delimiter.length);
+    encoder->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  }
+
+  static NAN_METHOD(Update)
+  {
+    Base64Encoder *encoder = Nan::ObjectWrap::Unwrap<Base64Encoder>(info.Holder());
+    const uint8_t *data;
+    size_t length;
+    if (!GetBytes(info[0], &data, &length))
+    {
+      return Nan::ThrowTypeError("Input must be a Buffer or an Uint8Array");
+    }
+    std::vector<uint8_t> out(base64::EncodeUpdateBound(&encoder->state, length));
+    size_t n;
+    {
+      ADONE_TRACE_SCOPE("data", "base64:encode");
+      n = base64::EncodeUpdate(&encoder->state, data, length, out.data());
+    }
+    info.GetReturnValue().Set(Shrink(out, n));
+  }
+
+  static NAN_METHOD(Final)
+  {
+    Base64Encoder *encoder = Nan::ObjectWrap::Unwrap<Base64Encoder>(info.Holder());
+    std::vector<uint8_t> out(base64::EncodeFinalBound(&encoder->state));
+    size_t n = base64::EncodeFinal(&encoder->state, out.data());
+    info.GetReturnValue().Set(Shrink(out, n));
+  }
+
+  base64::EncodeState state;
+};
+
+// Streaming decoder exported as the Base64Decoder class.
+//
+// new Base64Decoder(url), update(text) returns the bytes of the whole groups, final() the bytes of
+// an unpadded last group, after which the decoder can be reused.
+class Base64Decoder : public Nan::ObjectWrap
+{
+public:
+  static void Init(v8::Local<v8::Object> target)
+  {
+    v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+    tpl->SetClassName(NanStr("Base64Decoder"));
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+    Nan::SetPrototypeMethod(tpl, "update", Update);
+    Nan::SetPrototypeMethod(tpl, "final", Final);
+    Nan::Set(target, NanStr("Base64Decoder"), Nan::GetFunction(tpl).ToLocalChecked());
+  }
+
+private:
+  static NAN_METHOD(New)
+  {
+    if (!info.IsConstructCall())
+    {
+      return Nan::ThrowTypeError("Class constructor cannot be invoked without 'new'");
+    }
+    Base64Decoder *decoder = new Base64Decoder();
+    base64::DecodeInit(&decoder->state, GetAlphabet(info[0]));
+    decoder->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  }
+
+  static NAN_METHOD(Update)
+  {
+    Base64Decoder *decoder = Nan::ObjectWrap::Unwrap<Base64Decoder>(info.Holder());
+    Text text;
+    if (!text.Get(info[0]))
+    {
+      return Nan::ThrowTypeError("Input must be a string or a Buffer");
+    }
+    std::vector<uint8_t> out(base64::DecodeBound(text.length));
+    size_t n;
+    {
+      ADONE_TRACE_SCOPE("data", "base64:decode");
+      n = base64::DecodeUpdate(&decoder->state, text.data, text.length, out.data());
+    }
+    info.GetReturnValue().Set(Shrink(out, n));
+  }
+
+  static NAN_METHOD(Final)
+  {
+    Base64Decoder *decoder = Nan::ObjectWrap::Unwrap<Base64Decoder>(info.Holder());
+    std::vector<uint8_t> out(2);
+    size_t n = base64::DecodeFinal(&decoder->state, out.data());
+    info.GetReturnValue().Set(Shrink(out, n));
+  }
+
+  base64::DecodeState state;
+};
+
+NAN_METHOD(GetBase64Kernel)
+{
+  v8::Local<v8::Object> result = Nan::New<v8::Object>();
+  Nan::Set(result, NanStr("active"), NanStr(base64::KernelName(base64::GetKernel())));
+  Nan::Set(result, NanStr("best"), NanStr(base64::KernelName(base64::GetBestKernel())));
+  info.GetReturnValue().Set(result);
+}
+
+// setKernel(name), returns false if the kernel is unknown or the CPU does not support it
+NAN_METHOD(SetBase64Kernel)
+{
+  Nan::Utf8String name(info[0]);
+  static const base64::Kernel kernels[] = {base64::kKernelScalar, base64::kKernelSSSE3, base64::kKernelAVX2};
+  for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+  {
+    if (*name != NULL && strcmp(*name, base64::KernelName(kernels[i])) == 0)
+    {
+      info.GetReturnValue().Set(base64::SetKernel(kernels[i]));
+      return;
+    }
+  }
+  info.GetReturnValue().Set(false);
+}
+
+NAN_MODULE_INIT(InitBase64)
+{
+  Base64Encoder::Init(target);
+  Base64Decoder::Init(target);
+  Nan::SetMethod(target, "base64GetKernel", GetBase64Kernel);
+  Nan::SetMethod(target, "base64SetKernel", SetBase64Kernel);
+}
+
+} // namespace nodedata
@@ -0,0 +1,379 @@
+#include "base64_impl.h"
+
+#include <atomic>
+#include <string.h>
+
+namespace nodedata
+{
+namespace base64
+{
+
+static const uint8_t kChars[2][65] = {
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"};
+
+// Values of the characters, with kPad for '=' and kSkip for the characters out of the alphabet
+static const uint8_t kPad = 0x40;
+static const uint8_t kSkip = 0x80;
+
+struct DecodeTable
+{
+  uint8_t values[256];
+
+  explicit DecodeTable(Alphabet alphabet)
+  {
+    memset(values, kSkip, sizeof(values));
+    for (int i = 0; i < 64; i++)
+    {
+      values[kChars[alphabet][i]] = static_cast<uint8_t>(i);
+    }
+    values['='] = kPad;
+  }
+};
+
+static const DecodeTable kDecodeTables[2] = {DecodeTable(kAlphabetStandard), DecodeTable(kAlphabetUrl)};
+
+// Lines are written in pieces of at most this many characters
+static const size_t kChunkChars = 4096;
+
+Kernel GetBestKernel()
+{
+  const CpuFeatures &cpu = GetCpuFeatures();
+  if (cpu.avx2)
+  {
+    return kKernelAVX2;
+  }
+  return cpu.ssse3 && cpu.sse41 ? kKernelSSSE3 : kKernelScalar;
+}
+
+static std::atomic<int> kernel(-1);
+
+Kernel GetKernel()
+{
+  int current = kernel.load(std::memory_order_relaxed);
+  if (current < 0)
+  {
+    current = GetBestKernel();
+    kernel.store(current, std::memory_order_relaxed);
+  }
+  return static_cast<Kernel>(current);
+}
+
+bool SetKernel(Kernel value)
+{
+  if (value > GetBestKernel())
+  {
+    return false;
+  }
+  kernel.store(value, std::memory_order_relaxed);
+  return true;
+}
+
+const char *KernelName(Kernel value)
+{
+  switch (value)
+  {
+  case kKernelAVX2:
+    return "avx2";
+  case kKernelSSSE3:
+    return "ssse3";
+  default:
+    return "scalar";
+  }
+}
+
+static size_t EncodeBlocksScalar(Alphabet alphabet, const uint8_t *in, size_t length, uint8_t *out)
+{
+  const uint8_t *chars = kChars[alphabet];
+  size_t groups = length / 3;
+  for (size_t i = 0; i < groups; i++, in += 3, out += 4)
+  {
+    uint32_t w = (static_cast<uint32_t>(in[0]) << 16) | (static_cast<uint32_t>(in[1]) << 8) | in[2];
+    out[0] = chars[w >> 18];
+    out[1] = chars[(w >> 12) & 0x3F];
+    out[2] = chars[(w >> 6) & 0x3F];
+    out[3] = chars[w & 0x3F];
+  }
+  return groups * 3;
+}
+
+// Encodes whole groups, the vector kernels leave the last groups to the scalar code
+static size_t EncodeGroups(Alphabet alphabet, const uint8_t *in, size_t length, uint8_t *out)
+{
+  size_t done = 0;
+#if defined(DATA_X86)
+  switch (GetKernel())
+  {
+  case kKernelAVX2:
+    done = EncodeBlocksAvx2(alphabet, in, length, out);
+    break;
+  case kKernelSSSE3:
+    done = EncodeBlocksSsse3(alphabet, in, length, out);
+    break;
+  default:
+    break;
+  }
+#endif
+  done += EncodeBlocksScalar(alphabet, in + done, length - done, out + done / 3 * 4);
+  return done / 3 * 4;
+}
+
+// The 1 or 2 remaining bytes
+static size_t EncodeTail(Alphabet alphabet, const uint8_t *in, size_t length, uint8_t *out, bool pad)
+{
+  const uint8_t *chars = kChars[alphabet];
+  if (length == 0)
+  {
+    return 0;
+  }
+  uint32_t w = static_cast<uint32_t>(in[0]) << 16;
+  if (length > 1)
+  {
+    w |= static_cast<uint32_t>(in[1]) << 8;
+  }
+  out[0] = chars[w >> 18];
+  out[1] = chars[(w >> 12) & 0x3F];
+  size_t n = 2;
+  if (length > 1)
+  {
+    out[n++] = chars[(w >> 6) & 0x3F];
+  }
+  if (pad)
+  {
+    while (n < 4)
+    {
+      out[n++] = '=';
+    }
+  }
+  return n;
+}
+
+size_t EncodedLength(size_t length, bool pad)
+{
+  size_t rest = length % 3;
+  return length / 3 * 4 + (rest == 0 ? 0 : pad ? 4 : rest + 1);
+}
+
+size_t Encode(Alphabet alphabet, const uint8_t *in, size_t length, uint8_t *out, bool pad)
+{
+  size_t n = EncodeGroups(alphabet, in, length, out);
+  size_t done = n / 4 * 3;
+  return n + EncodeTail(alphabet, in + done, length - done, out + n, pad);
+}
+
+void EncodeInit(EncodeState *state, Alphabet alphabet, bool pad, size_t lineLength, const uint8_t *delimiter,
+                size_t delimiterLength)
+{
+  state->alphabet = alphabet;
+  state->pad = pad;
+  state->pendingLength = 0;
+  state->lineLength = lineLength;
+  state->column = 0;
+  state->delimiterLength = delimiterLength < kMaxDelimiterBytes ? delimiterLength : kMaxDelimiterBytes;
+  memcpy(state->delimiter, delimiter, state->delimiterLength);
+}
+
+static size_t WithLineBreaks(const EncodeState *state, size_t chars)
+{
+  if (state->lineLength == 0 || chars == 0)
+  {
+    return chars;
+  }
+  // at most one delimiter before each started line, counting the current one
+  return chars + (chars / state->lineLength + 1) * state->delimiterLength;
+}
+
+size_t EncodeUpdateBound(const EncodeState *state, size_t length)
+{
+  return WithLineBreaks(state, (state->pendingLength + length) / 3 * 4);
+}
+
+size_t EncodeFinalBound(const EncodeState *state)
+{
+  return WithLineBreaks(state, 4);
+}
+
+// Copies encoded characters into the lines of the output
+static size_t WriteLines(EncodeState *state, const uint8_t *chars, size_t length, uint8_t *out)
+{
+  if (state->lineLength == 0)
+  {
+    if (chars != out)
+    {
+      memcpy(out, chars, length);
+    }
+    return length;
+  }
+  size_t n = 0;
+  while (length > 0)
+  {
+    if (state->column == state->lineLength)
+    {
+      memcpy(out + n, state->delimiter, state->delimiterLength);
+      n += state->delimiterLength;
+      state->column = 0;
+    }
+    size_t count = state->lineLength - state->column;
+    if (count > length)
+    {
+      count = length;
+    }
+    memcpy(out + n, chars, count);
+    n += count;
+    chars += count;
+    length -= count;
+    state->column += count;
+  }
+  return n;
+}
+
+size_t EncodeUpdate(EncodeState *state, const uint8_t *in, size_t length, uint8_t *out)
+{
+  uint8_t chunk[kChunkChars];
+  size_t n = 0;
+  if (state->pendingLength > 0)
+  {
+    while (state->pendingLength < 3 && length > 0)
+    {
+      state->pending[state->pendingLength++] = *in++;
+      length--;
+    }
+    if (state->pendingLength < 3)
+    {
+      return 0;
+    }
+    EncodeBlocksScalar(state->alphabet, state->pending, 3, chunk);
+    n += WriteLines(state, chunk, 4, out);
+    state->pendingLength = 0;
+  }
+  size_t whole = length - length % 3;
+  if (state->lineLength == 0)
+  {
+    // nothing to insert, the characters go straight to the output
+    n += EncodeGroups(state->alphabet, in, whole, out + n);
+  }
+  else
+  {
+    for (size_t done = 0; done < whole;)
+    {
+      size_t count = whole - done < kChunkChars / 4 * 3 ? whole - done : kChunkChars / 4 * 3;
+      size_t chars = EncodeGroups(state->alphabet, in + done, count, chunk);
+      n += WriteLines(state, chunk, chars, out + n);
+      done += count;
+    }
+  }
+  memcpy(state->pending, in + whole, length - whole);
+  state->pendingLength = length - whole;
+  return n;
+}
+
+size_t EncodeFinal(EncodeState *state, uint8_t *out)
+{
+  uint8_t chars[4];
+  size_t count = EncodeTail(state->alphabet, state->pending, state->pendingLength, chars, state->pad);
+  size_t n = WriteLines(state, chars, count, out);
+  state->pendingLength = 0;
+  state->column = 0;
+  return n;
+}
+
+void DecodeInit(DecodeState *state, Alphabet alphabet)
+{
+  state->alphabet = alphabet;
+  state->bits = 0;
+  state->sextets = 0;
+}
+
+size_t DecodeBound(size_t length)
+{
+  // the kernels store whole vectors of 32 bytes
+  return (length / 4 + 1) * 3 + 32;
+}
+
+// Flushes the bytes of an incomplete group, 2 or 3 sextets give 1 or 2 bytes
+static size_t FlushPartial(DecodeState *state, uint8_t *out)
+{
+  size_t n = 0;
+  if (state->sextets == 2)
+  {
+    out[n++] = static_cast<uint8_t>(state->bits >> 4);
+  }
+  else if (state->sextets == 3)
+  {
+    out[n++] = static_cast<uint8_t>(state->bits >> 10);
+    out[n++] = static_cast<uint8_t>(state->bits >> 2);
+  }
+  state->bits = 0;
+  state->sextets = 0;
+  return n;
+}
+
+size_t DecodeUpdate(DecodeState *state, const uint8_t *in, size_t length, uint8_t *out)
+{
+  const uint8_t *values = kDecodeTables[state->alphabet].values;
+  size_t n = 0;
+  size_t i = 0;
+#if defined(DATA_X86)
+  DecodeBlocksFn blocks = NULL;
+  if (state->alphabet == kAlphabetStandard)
+  {
+    switch (GetKernel())
+    {
+    case kKernelAVX2:
+      blocks = DecodeBlocksAvx2;
+      break;
+    case kKernelSSSE3:
+      blocks = DecodeBlocksSsse3;
+      break;
+    default:
+      break;
+    }
+  }
+#endif
+  while (i < length)
+  {
+#if defined(DATA_X86)
+    if (blocks != NULL && state->sextets == 0)
+    {
+      i += blocks(in + i, length - i, out + n, &n);
+      if (i == length)
+      {
+        break;
+      }
+    }
+#endif
+    // a block with other characters, one vector of characters goes through the scalar code and
+    // the kernel takes over again at the next whole group
+    size_t end = length - i < 16 ? length : i + 16;
+    while (i < end || (state->sextets != 0 && i < length))
+    {
+      uint8_t value = values[in[i++]];
+      if (value < 64)
+      {
+        state->bits = (state->bits << 6) | value;
+        if (++state->sextets == 4)
+        {
+          out[n] = static_cast<uint8_t>(state->bits >> 16);
+          out[n + 1] = static_cast<uint8_t>(state->bits >> 8);
+          out[n + 2] = static_cast<uint8_t>(state->bits);
+          n += 3;
+          state->bits = 0;
+          state->sextets = 0;
+        }
+      }
+      else if (value == kPad)
+      {
+        n += FlushPartial(state, out + n);
+      }
+    }
+  }
+  return n;
+}
+
+size_t DecodeFinal(DecodeState *state, uint8_t *out)
+{
+  return FlushPartial(state, out);
+}
+
+} // namespace base64
+} // namespace nodedata
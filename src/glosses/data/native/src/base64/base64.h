@@ -0,0 +1,91 @@
+#ifndef __DATA_BASE64_H_
+#define __DATA_BASE64_H_
+
+// Base64 (RFC 4648) with the standard and the URL-safe alphabets.
+//
+// Whole blocks are encoded and decoded with SSSE3 or AVX2 when the CPU has them: 12 or 24 bytes are
+// spread into 6-bit indices with shuffles and multiplications and translated with a lookup of range
+// offsets, decoding validates 16 or 32 characters at once with nibble lookups. The remaining bytes
+// and any block with other characters go through the scalar code.
+//
+// The streaming encoder breaks lines, the streaming decoder skips the characters out of the
+// alphabet (line breaks, spaces) and restarts after padding, as MIME decoders do.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace nodedata
+{
+namespace base64
+{
+
+enum Kernel
+{
+  kKernelScalar = 0,
+  kKernelSSSE3 = 1,
+  kKernelAVX2 = 2
+};
+
+enum Alphabet
+{
+  kAlphabetStandard = 0,
+  kAlphabetUrl = 1
+};
+
+static const size_t kMaxDelimiterBytes = 8;
+
+struct EncodeState
+{
+  Alphabet alphabet;
+  bool pad;
+  // bytes of an incomplete group
+  uint8_t pending[3];
+  size_t pendingLength;
+  // 0 to not break lines
+  size_t lineLength;
+  size_t column;
+  uint8_t delimiter[kMaxDelimiterBytes];
+  size_t delimiterLength;
+};
+
+struct DecodeState
+{
+  Alphabet alphabet;
+  // sextets of an incomplete group
+  uint32_t bits;
+  int sextets;
+};
+
+// Encoding of a whole input, returns the length of the output
+size_t EncodedLength(size_t length, bool pad);
+size_t Encode(Alphabet alphabet, const uint8_t *in, size_t length, uint8_t *out, bool pad);
+
+// The delimiter is at most kMaxDelimiterBytes long
+void EncodeInit(EncodeState *state, Alphabet alphabet, bool pad, size_t lineLength, const uint8_t *delimiter,
+                size_t delimiterLength);
+// The maximum output of EncodeUpdate() for `length` bytes of input, and of EncodeFinal()
+size_t EncodeUpdateBound(const EncodeState *state, size_t length);
+size_t EncodeFinalBound(const EncodeState *state);
+// Return the length of the output. A line break is written before the first character of every
+// line but the first, so that the output never ends with one.
+size_t EncodeUpdate(EncodeState *state, const uint8_t *in, size_t length, uint8_t *out);
+size_t EncodeFinal(EncodeState *state, uint8_t *out);
+
+void DecodeInit(DecodeState *state, Alphabet alphabet);
+// The maximum output of DecodeUpdate() for `length` characters of input, the kernels store whole
+// vectors so this is more than the decoded bytes
+size_t DecodeBound(size_t length);
+size_t DecodeUpdate(DecodeState *state, const uint8_t *in, size_t length, uint8_t *out);
+// Ends a stream without padding, returns the length of the output (at most 2 bytes)
+size_t DecodeFinal(DecodeState *state, uint8_t *out);
+
+// The kernel in use, SetKernel() returns false if the CPU does not support the kernel
+Kernel GetKernel();
+Kernel GetBestKernel();
+bool SetKernel(Kernel kernel);
+const char *KernelName(Kernel kernel);
+
+} // namespace base64
+} // namespace nodedata
+
+#endif // __DATA_BASE64_H_
@@ -0,0 +1,28 @@
+#ifndef __DATA_BASE64_IMPL_H_
+#define __DATA_BASE64_IMPL_H_
+
+#include "base64.h"
+#include "cpu.h"
+
+namespace nodedata
+{
+namespace base64
+{
+
+// Encode whole groups of 3 bytes while the vectors can be loaded, return the number of bytes consumed
+typedef size_t (*EncodeBlocksFn)(Alphabet alphabet, const uint8_t *in, size_t length, uint8_t *out);
+// Decode blocks of the standard alphabet up to the first block that has another character,
+// return the number of characters consumed and add the decoded bytes to `written`
+typedef size_t (*DecodeBlocksFn)(const uint8_t *in, size_t length, uint8_t *out, size_t *written);
+
+#if defined(DATA_X86)
+size_t EncodeBlocksSsse3(Alphabet alphabet, const uint8_t *in, size_t length, uint8_t *out);
+size_t EncodeBlocksAvx2(Alphabet alphabet, const uint8_t *in, size_t length, uint8_t *out);
+size_t DecodeBlocksSsse3(const uint8_t *in, size_t length, uint8_t *out, size_t *written);
+size_t DecodeBlocksAvx2(const uint8_t *in, size_t length, uint8_t *out, size_t *written);
+#endif
+
+} // namespace base64
+} // namespace nodedata
+
+#endif // __DATA_BASE64_IMPL_H_
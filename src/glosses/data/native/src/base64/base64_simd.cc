@@ -0,0 +1,180 @@
+#include "base64_impl.h"
+
+#if defined(DATA_X86)
+
+namespace nodedata
+{
+namespace base64
+{
+
+// the SSSE3 kernel also uses PTEST from SSE4.1
+#define SSSE3_TARGET DATA_TARGET("ssse3,sse4.1")
+#define AVX2_TARGET DATA_TARGET("avx2")
+
+// Offsets from the 6-bit values to the characters, indexed by the value saturated at 51: 0 is A-Z,
+// 1 is a-z, 2 to 11 are the digits, 12 and 13 the last two characters of the alphabet
+static const int8_t kEncodeOffsets[2][16] = {
+    {65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -19, -16, 0, 0},
+    {65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, -17, 32, 0, 0}};
+
+// Validation and translation of the standard alphabet, indexed by the low and the high nibble of
+// the characters: a character is valid if the bits of its two entries do not intersect
+static const int8_t kDecodeLo[16] = {0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                     0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A};
+static const int8_t kDecodeHi[16] = {0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                     0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10};
+static const int8_t kDecodeRoll[16] = {0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0};
+
+// 12 bytes in the low 12 bytes of every lane become 16 indices of 6 bits
+SSSE3_TARGET static inline __m128i EncodeReshuffle(__m128i in)
+{
+  in = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  // the first and the third index of every 32 bits are shifted down with a high multiplication,
+  // the second and the fourth are shifted up with a low multiplication
+  __m128i t0 = _mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00));
+  __m128i t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+  __m128i t2 = _mm_and_si128(in, _mm_set1_epi32(0x003F03F0));
+  __m128i t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(t1, t3);
+}
+
+SSSE3_TARGET static inline __m128i EncodeTranslate(__m128i in, __m128i offsets)
+{
+  __m128i indices = _mm_subs_epu8(in, _mm_set1_epi8(51));
+  // the values above 25 are one short of their index
+  indices = _mm_sub_epi8(indices, _mm_cmpgt_epi8(in, _mm_set1_epi8(25)));
+  return _mm_add_epi8(in, _mm_shuffle_epi8(offsets, indices));
+}
+
+SSSE3_TARGET size_t EncodeBlocksSsse3(Alphabet alphabet, const uint8_t *in, size_t length, uint8_t *out)
+{
+  __m128i offsets = _mm_loadu_si128(reinterpret_cast<const __m128i *>(kEncodeOffsets[alphabet]));
+  size_t done = 0;
+  // 16 bytes are loaded for 12
+  for (; done + 16 <= length; done += 12, out += 16)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + done));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), EncodeTranslate(EncodeReshuffle(v), offsets));
+  }
+  return done;
+}
+
+AVX2_TARGET static inline __m256i EncodeReshuffle256(__m256i in)
+{
+  in = _mm256_shuffle_epi8(in, _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1, 10, 11, 9, 10, 7,
+                                               8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  __m256i t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00));
+  __m256i t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+  __m256i t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0));
+  __m256i t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+  return _mm256_or_si256(t1, t3);
+}
+
+AVX2_TARGET static inline __m256i EncodeTranslate256(__m256i in, __m256i offsets)
+{
+  __m256i indices = _mm256_subs_epu8(in, _mm256_set1_epi8(51));
+  indices = _mm256_sub_epi8(indices, _mm256_cmpgt_epi8(in, _mm256_set1_epi8(25)));
+  return _mm256_add_epi8(in, _mm256_shuffle_epi8(offsets, indices));
+}
+
+AVX2_TARGET size_t EncodeBlocksAvx2(Alphabet alphabet, const uint8_t *in, size_t length, uint8_t *out)
+{
+  __m256i offsets =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(kEncodeOffsets[alphabet])));
+  size_t done = 0;
+  // every lane takes 12 bytes, the high one is loaded 12 bytes further
+  for (; done + 28 <= length; done += 24, out += 32)
+  {
+    __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + done));
+    __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + done + 12));
+    __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), EncodeTranslate256(EncodeReshuffle256(v), offsets));
+  }
+  return done + EncodeBlocksSsse3(alphabet, in + done, length - done, out);
+}
+
+// Returns false if a character is out of the alphabet, otherwise the 6-bit values
+SSSE3_TARGET static inline bool DecodeTranslate(__m128i str, __m128i *values)
+{
+  const __m128i mask2F = _mm_set1_epi8(0x2F);
+  // pshufb only looks at the low nibble and the top bit of the indices
+  __m128i hiNibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask2F);
+  __m128i loNibbles = _mm_and_si128(str, mask2F);
+  __m128i lo = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(kDecodeLo)), loNibbles);
+  __m128i hi = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(kDecodeHi)), hiNibbles);
+  if (!_mm_testz_si128(lo, hi))
+  {
+    return false;
+  }
+  // '/' shares its high nibble with '+' but not its offset
+  __m128i eq2F = _mm_cmpeq_epi8(str, mask2F);
+  __m128i roll = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(kDecodeRoll)),
+                                  _mm_add_epi8(eq2F, hiNibbles));
+  *values = _mm_add_epi8(str, roll);
+  return true;
+}
+
+// 16 values of 6 bits become 12 bytes in the low bytes of every lane
+SSSE3_TARGET static inline __m128i DecodePack(__m128i values)
+{
+  __m128i pairs = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  __m128i words = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+  return _mm_shuffle_epi8(words, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+}
+
+SSSE3_TARGET size_t DecodeBlocksSsse3(const uint8_t *in, size_t length, uint8_t *out, size_t *written)
+{
+  size_t done = 0;
+  for (; done + 16 <= length; done += 16, out += 12)
+  {
+    __m128i values;
+    if (!DecodeTranslate(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + done)), &values))
+    {
+      break;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), DecodePack(values));
+    *written += 12;
+  }
+  return done;
+}
+
+AVX2_TARGET size_t DecodeBlocksAvx2(const uint8_t *in, size_t length, uint8_t *out, size_t *written)
+{
+  const __m256i mask2F = _mm256_set1_epi8(0x2F);
+  const __m256i lut_lo =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(kDecodeLo)));
+  const __m256i lut_hi =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(kDecodeHi)));
+  const __m256i lut_roll =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(kDecodeRoll)));
+  size_t done = 0;
+  for (; done + 32 <= length; done += 32, out += 24)
+  {
+    __m256i str = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + done));
+    __m256i hiNibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask2F);
+    __m256i loNibbles = _mm256_and_si256(str, mask2F);
+    __m256i lo = _mm256_shuffle_epi8(lut_lo, loNibbles);
+    __m256i hi = _mm256_shuffle_epi8(lut_hi, hiNibbles);
+    if (!_mm256_testz_si256(lo, hi))
+    {
+      break;
+    }
+    __m256i eq2F = _mm256_cmpeq_epi8(str, mask2F);
+    __m256i values = _mm256_add_epi8(str, _mm256_shuffle_epi8(lut_roll, _mm256_add_epi8(eq2F, hiNibbles)));
+    __m256i pairs = _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    __m256i words = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+    __m256i bytes = _mm256_shuffle_epi8(words, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                                2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1,
+                                                                -1));
+    // the 12 bytes of the two lanes are joined
+    bytes = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out), bytes);
+    *written += 24;
+  }
+  return done + DecodeBlocksSsse3(in + done, length - done, out, written);
+}
+
+} // namespace base64
+} // namespace nodedata
+
+#endif // DATA_X86
@@ -0,0 +1,102 @@
+#include "data.h"
+#include "basex/basex.h"
+
+#include <adone_trace.h>
+
+namespace nodedata
+{
+
+// Base conversion exported as the BaseX class.
+//
+// new BaseX(alphabet), encode(bytes) returns the string, decode(text) returns a Buffer, or
+// undefined if the text has a character out of the alphabet (decodeUnsafe() of data/basex).
+class BaseX : public Nan::ObjectWrap
+{
+public:
+  static void Init(v8::Local<v8::Object> target)
+  {
+    v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+    tpl->SetClassName(NanStr("BaseX"));
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+    Nan::SetPrototypeMethod(tpl, "encode", Encode);
+    Nan::SetPrototypeMethod(tpl, "decode", Decode);
+    Nan::Set(target, NanStr("BaseX"), Nan::GetFunction(tpl).ToLocalChecked());
+  }
+
+private:
+  // new BaseX(alphabet), the alphabet has Latin-1 characters only
+  static NAN_METHOD(New)
+  {
+    if (!info.IsConstructCall())
+    {
+      return Nan::ThrowTypeError("Class constructor cannot be invoked without 'new'");
+    }
+    if (!info[0]->IsString() || !info[0].As<v8::String>()->IsOneByte())
+    {
+      return Nan::ThrowTypeError("Alphabet must be a string of Latin-1 characters");
+    }
+    Text alphabet;
+    alphabet.Get(info[0]);
+    BaseX *codec = new BaseX();
+    if (!codec->codec.Init(alphabet.data, alphabet.length))
+    {
+      delete codec;
+      return Nan::ThrowError("Invalid alphabet");
+    }
+    codec->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  }
+
+  static NAN_METHOD(Encode)
+  {
+    BaseX *codec = Nan::ObjectWrap::Unwrap<BaseX>(info.Holder());
+    const uint8_t *data;
+    size_t length;
+    if (!GetBytes(info[0], &data, &length))
+    {
+      return Nan::ThrowTypeError("Expected Buffer");
+    }
+    std::vector<uint8_t> out;
+    {
+      ADONE_TRACE_SCOPE("data", "basex:encode");
+      codec->codec.Encode(data, length, &out);
+    }
+    info.GetReturnValue().Set(NewAsciiString(out.data(), out.size()));
+  }
+
+  static NAN_METHOD(Decode)
+  {
+    BaseX *codec = Nan::ObjectWrap::Unwrap<BaseX>(info.Holder());
+    if (!info[0]->IsString())
+    {
+      return Nan::ThrowTypeError("Expected String");
+    }
+    // characters above Latin-1 are never in the alphabet
+    if (!info[0].As<v8::String>()->IsOneByte())
+    {
+      return;
+    }
+    Text text;
+    text.Get(info[0]);
+    std::vector<uint8_t> out;
+    bool valid;
+    {
+      ADONE_TRACE_SCOPE("data", "basex:decode");
+      valid = codec->codec.Decode(text.data, text.length, &out);
+    }
+    if (valid)
+    {
+      info.GetReturnValue().Set(
+          Nan::CopyBuffer(reinterpret_cast<char *>(out.data()), static_cast<uint32_t>(out.size())).ToLocalChecked());
+    }
+  }
+
+  basex::Codec codec;
+};
+
+NAN_MODULE_INIT(InitBaseX)
+{
+  BaseX::Init(target);
+}
+
+} // namespace nodedata
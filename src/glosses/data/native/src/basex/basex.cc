@@ -0,0 +1,167 @@
+#include "basex.h"
+
+#include <string.h>
+
+namespace nodedata
+{
+namespace basex
+{
+
+static const uint8_t kNoDigit = 255;
+
+bool Codec::Init(const uint8_t *chars, size_t length)
+{
+  if (length < 2 || length >= 255)
+  {
+    return false;
+  }
+  memset(digits, kNoDigit, sizeof(digits));
+  for (size_t i = 0; i < length; i++)
+  {
+    if (digits[chars[i]] != kNoDigit)
+    {
+      return false;
+    }
+    digits[chars[i]] = static_cast<uint8_t>(i);
+    alphabet[i] = chars[i];
+  }
+  base = static_cast<uint32_t>(length);
+  digitsPerLimb = 0;
+  limbBase = 1;
+  while (limbBase * base <= (static_cast<uint64_t>(1) << 32))
+  {
+    limbBase *= base;
+    digitsPerLimb++;
+  }
+  return true;
+}
+
+void Codec::Encode(const uint8_t *in, size_t length, std::vector<uint8_t> *out) const
+{
+  size_t zeros = 0;
+  while (zeros < length && in[zeros] == 0)
+  {
+    zeros++;
+  }
+  in += zeros;
+  length -= zeros;
+
+  // the number in limbs of base ^ digitsPerLimb, least significant first
+  std::vector<uint32_t> limbs;
+  limbs.reserve(length / 3 + 2);
+  size_t i = 0;
+  while (i < length)
+  {
+    // the first word takes the bytes that are not a multiple of 4
+    size_t count = i == 0 && length % 4 != 0 ? length % 4 : 4;
+    uint64_t carry = 0;
+    for (size_t k = 0; k < count; k++)
+    {
+      carry = (carry << 8) | in[i + k];
+    }
+    i += count;
+    int bits = static_cast<int>(count * 8);
+    for (size_t k = 0; k < limbs.size(); k++)
+    {
+      uint64_t t = (static_cast<uint64_t>(limbs[k]) << bits) + carry;
+      limbs[k] = static_cast<uint32_t>(t % limbBase);
+      carry = t / limbBase;
+    }
+    while (carry != 0)
+    {
+      limbs.push_back(static_cast<uint32_t>(carry % limbBase));
+      carry /= limbBase;
+    }
+  }
+
+  size_t digitCount = limbs.size() * digitsPerLimb;
+  out->resize(zeros + digitCount);
+  uint8_t *p = out->data() + out->size();
+  for (size_t k = 0; k < limbs.size(); k++)
+  {
+    uint32_t limb = limbs[k];
+    for (int d = 0; d < digitsPerLimb; d++)
+    {
+      *--p = alphabet[limb % base];
+      limb /= base;
+    }
+  }
+  // the most significant limb has leading zero digits
+  size_t skip = 0;
+  while (skip < digitCount && (*out)[zeros + skip] == alphabet[0])
+  {
+    skip++;
+  }
+  memmove(out->data() + zeros, out->data() + zeros + skip, digitCount - skip);
+  memset(out->data(), alphabet[0], zeros);
+  out->resize(zeros + digitCount - skip);
+}
+
+bool Codec::Decode(const uint8_t *in, size_t length, std::vector<uint8_t> *out) const
+{
+  if (length > 0 && in[0] == ' ')
+  {
+    return false;
+  }
+  size_t zeros = 0;
+  while (zeros < length && in[zeros] == alphabet[0])
+  {
+    zeros++;
+  }
+  in += zeros;
+  length -= zeros;
+
+  // the number in 32-bit limbs, least significant first
+  std::vector<uint32_t> limbs;
+  limbs.reserve(length * 8 / 32 + 2);
+  for (size_t i = 0; i < length;)
+  {
+    uint64_t multiplier = 1;
+    uint64_t carry = 0;
+    for (int d = 0; d < digitsPerLimb && i < length; d++, i++)
+    {
+      uint8_t digit = digits[in[i]];
+      if (digit == kNoDigit)
+      {
+        return false;
+      }
+      carry = carry * base + digit;
+      multiplier *= base;
+    }
+    for (size_t k = 0; k < limbs.size(); k++)
+    {
+      uint64_t t = limbs[k] * multiplier + carry;
+      limbs[k] = static_cast<uint32_t>(t);
+      carry = t >> 32;
+    }
+    if (carry != 0)
+    {
+      limbs.push_back(static_cast<uint32_t>(carry));
+    }
+  }
+
+  out->resize(zeros + limbs.size() * 4);
+  uint8_t *p = out->data() + out->size();
+  for (size_t k = 0; k < limbs.size(); k++)
+  {
+    uint32_t limb = limbs[k];
+    for (int b = 0; b < 4; b++)
+    {
+      *--p = static_cast<uint8_t>(limb);
+      limb >>= 8;
+    }
+  }
+  size_t skip = 0;
+  while (skip < limbs.size() * 4 && (*out)[zeros + skip] == 0)
+  {
+    skip++;
+  }
+  size_t byteCount = limbs.size() * 4 - skip;
+  memmove(out->data() + zeros, out->data() + zeros + skip, byteCount);
+  memset(out->data(), 0, zeros);
+  out->resize(zeros + byteCount);
+  return true;
+}
+
+} // namespace basex
+} // namespace nodedata
@@ -0,0 +1,45 @@
+#ifndef __DATA_BASEX_H_
+#define __DATA_BASEX_H_
+
+// Conversion between bytes and any base of 2 to 254 characters (base58 and the other alphabets of
+// data/basex), with the same results as the JS code: leading zero bytes map to leading first
+// characters of the alphabet and the rest is the big-endian number in the base.
+//
+// The JS code multiplies one byte or one character at a time into an array of digits. Here the
+// bytes are taken 32 bits at a time into limbs that hold as many digits as fit in 32 bits, and the
+// characters as many digits at a time into 32-bit limbs, so there are about 8 times fewer steps.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace nodedata
+{
+namespace basex
+{
+
+class Codec
+{
+public:
+  // Returns false if the alphabet is shorter than 2 or longer than 254 characters, or has duplicates
+  bool Init(const uint8_t *alphabet, size_t length);
+
+  void Encode(const uint8_t *in, size_t length, std::vector<uint8_t> *out) const;
+  // Returns false if a character is out of the alphabet, or if the text starts with a space
+  bool Decode(const uint8_t *in, size_t length, std::vector<uint8_t> *out) const;
+
+private:
+  uint8_t alphabet[256];
+  // the digit of every character, or 255
+  uint8_t digits[256];
+  uint32_t base;
+  // digits per limb, and base ^ digitsPerLimb
+  int digitsPerLimb;
+  uint64_t limbBase;
+};
+
+} // namespace basex
+} // namespace nodedata
+
+#endif // __DATA_BASEX_H_
@@ -0,0 +1,709 @@
+#include "data.h"
+#include "bson/document.h"
+#include "utf8/utf8.h"
+
+#include <adone_trace.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace nodedata
+{
+namespace bson
+{
+
+// BSON serializer of data/bson/parser/serializer.js and the element index of data/bson/view.js.
+//
+// The serializer writes the documents in one pass: the sizes of the documents and the strings are
+// written once their content is. It handles the values of plain documents: strings, numbers,
+// booleans, null and undefined, Dates, Buffers, ObjectIds, Longs, Timestamps, Doubles, arrays and
+// objects. Anything else (the other BSON types, Maps, regular expressions, toBSON(), functions to
+// serialize) and the documents the JavaScript code throws on (cyclic ones, invalid keys) make it
+// bail out, the JavaScript serializer runs then. The output is the same as the one of the
+// JavaScript code.
+
+// The property names the serializer reads, internalized once by InitBson()
+static Nan::Persistent<v8::String> toBSONKey;
+static Nan::Persistent<v8::String> typeKey;
+static Nan::Persistent<v8::String> idKey;
+static Nan::Persistent<v8::String> lowKey;
+static Nan::Persistent<v8::String> highKey;
+static Nan::Persistent<v8::String> valueKey;
+
+// Nesting deeper than this is left to the JavaScript code
+static const int kMaxDepth = 512;
+// The elements of arrays and objects are serialized under a handle scope for this many of them
+static const uint32_t kScopeChunk = 1024;
+
+enum Flags
+{
+  kFlagCheckKeys = 1,
+  kFlagSerializeFunctions = 2,
+  kFlagIgnoreUndefined = 4
+};
+
+enum Status
+{
+  kOk = 0,
+  // left to the JavaScript code
+  kBail,
+  // an exception is pending
+  kError
+};
+
+// Writes to the memory of the target Buffer, and to its own memory once the target is full
+class Writer
+{
+public:
+  Writer(uint8_t *target, size_t capacity) : data(target), length(0), capacity(capacity), owned(false) {}
+
+  ~Writer()
+  {
+    if (owned)
+    {
+      free(data);
+    }
+  }
+
+  bool Reserve(size_t n)
+  {
+    if (n <= capacity - length)
+    {
+      return true;
+    }
+    // the sizes of the documents take 31 bits
+    if (n > kMaxLength - length)
+    {
+      return false;
+    }
+    size_t grown = capacity * 2 > length + n ? capacity * 2 : length + n;
+    grown = grown > kMinCapacity ? grown : kMinCapacity;
+    uint8_t *p;
+    if (owned)
+    {
+      p = static_cast<uint8_t *>(realloc(data, grown));
+    }
+    else
+    {
+      p = static_cast<uint8_t *>(malloc(grown));
+      if (p != NULL && length > 0)
+      {
+        memcpy(p, data, length);
+      }
+    }
+    if (p == NULL)
+    {
+      return false;
+    }
+    data = p;
+    capacity = grown;
+    owned = true;
+    return true;
+  }
+
+  // Reserve() must have been called for the bytes
+  void Put8(uint8_t v)
+  {
+    data[length++] = v;
+  }
+
+  void Put32(int32_t v)
+  {
+    WriteInt32(data + length, v);
+    length += 4;
+  }
+
+  void Put64(uint64_t v)
+  {
+    Put32(static_cast<int32_t>(static_cast<uint32_t>(v)));
+    Put32(static_cast<int32_t>(static_cast<uint32_t>(v >> 32)));
+  }
+
+  // The number of bytes written if they fit in the target, otherwise a Buffer that owns them
+  v8::Local<v8::Value> Release()
+  {
+    if (!owned)
+    {
+      return Nan::New<v8::Number>(static_cast<double>(length));
+    }
+    owned = false;
+    return Nan::NewBuffer(reinterpret_cast<char *>(data), static_cast<uint32_t>(length)).ToLocalChecked();
+  }
+
+  uint8_t *data;
+  size_t length;
+  size_t capacity;
+
+private:
+  static const size_t kMinCapacity = 4096;
+  static const size_t kMaxLength = 0x7FFFFFFF;
+  bool owned;
+};
+
+class Serializer
+{
+public:
+  // The target is a Buffer, it gives the prototype of the Buffers
+  Serializer(v8::Local<v8::Object> target, int flags)
+      : out(reinterpret_cast<uint8_t *>(node::Buffer::Data(target)), node::Buffer::Length(target)), flags(flags),
+        isolate(v8::Isolate::GetCurrent()), context(Nan::GetCurrentContext()),
+        bufferPrototype(target->GetPrototype()), toBSONName(Nan::New(toBSONKey)), typeName(Nan::New(typeKey)),
+        idName(Nan::New(idKey)), lowName(Nan::New(lowKey)), highName(Nan::New(highKey)), valueName(Nan::New(valueKey))
+  {
+  }
+
+  Status Serialize(v8::Local<v8::Value> object)
+  {
+    if (!object->IsObject())
+    {
+      return kBail;
+    }
+    // the values of the documents are checked by Element()
+    if (!object->IsArray())
+    {
+      Status status = CheckToBSON(object.As<v8::Object>());
+      if (status != kOk)
+      {
+        return status;
+      }
+    }
+    return Document(object.As<v8::Object>(), 0);
+  }
+
+  Writer out;
+
+private:
+  Status Document(v8::Local<v8::Object> object, int depth)
+  {
+    if (depth >= kMaxDepth || object->IsProxy() || object->IsMap())
+    {
+      return kBail;
+    }
+    for (size_t i = 0; i < path.size(); i++)
+    {
+      if (path[i]->StrictEquals(object))
+      {
+        // cyclic dependency detected
+        return kBail;
+      }
+    }
+    if (!out.Reserve(5))
+    {
+      return OutOfMemory();
+    }
+    size_t start = out.length;
+    out.length += 4;
+    path.push_back(object);
+    Status status =
+        object->IsArray() ? ArrayElements(object.As<v8::Array>(), depth) : ObjectElements(object, depth);
+    path.pop_back();
+    if (status != kOk)
+    {
+      return status;
+    }
+    if (!out.Reserve(1))
+    {
+      return OutOfMemory();
+    }
+    out.Put8(0);
+    WriteInt32(out.data + start, static_cast<int32_t>(out.length - start));
+    return kOk;
+  }
+
+  Status ArrayElements(v8::Local<v8::Array> array, int depth)
+  {
+    uint32_t length = array->Length();
+    uint8_t key[16];
+    for (uint32_t chunk = 0; chunk < length; chunk += kScopeChunk)
+    {
+      // the handles are released by chunks, a scope for every element costs more
+      Nan::HandleScope scope;
+      uint32_t last = length - chunk > kScopeChunk ? chunk + kScopeChunk : length;
+      for (uint32_t i = chunk; i < last; i++)
+      {
+        v8::Local<v8::Value> element;
+        if (!array->Get(context, i).ToLocal(&element))
+        {
+          return kError;
+        }
+        int keyLength = IndexKey(i, key);
+        Status status = Element(key, keyLength, element, true, depth);
+        if (status != kOk)
+        {
+          return status;
+        }
+      }
+    }
+    return kOk;
+  }
+
+  // The decimal digits of an array index
+  static int IndexKey(uint32_t index, uint8_t *key)
+  {
+    uint8_t digits[10];
+    int n = 0;
+    do
+    {
+      digits[n++] = static_cast<uint8_t>('0' + index % 10);
+      index /= 10;
+    } while (index != 0);
+    for (int i = 0; i < n; i++)
+    {
+      key[i] = digits[n - 1 - i];
+    }
+    return n;
+  }
+
+  // The keys of a for-in loop
+  Status ObjectElements(v8::Local<v8::Object> object, int depth)
+  {
+    Status status;
+    v8::Local<v8::Array> keys;
+    if (!object
+             ->GetPropertyNames(context, v8::KeyCollectionMode::kIncludePrototypes,
+                                static_cast<v8::PropertyFilter>(v8::ONLY_ENUMERABLE | v8::SKIP_SYMBOLS),
+                                v8::IndexFilter::kIncludeIndices, v8::KeyConversionMode::kConvertToString)
+             .ToLocal(&keys))
+    {
+      return kError;
+    }
+    uint32_t length = keys->Length();
+    for (uint32_t chunk = 0; chunk < length; chunk += kScopeChunk)
+    {
+      Nan::HandleScope scope;
+      uint32_t last = length - chunk > kScopeChunk ? chunk + kScopeChunk : length;
+      for (uint32_t i = chunk; i < last; i++)
+      {
+        v8::Local<v8::Value> key;
+        v8::Local<v8::Value> element;
+        if (!keys->Get(context, i).ToLocal(&key) || !object->Get(context, key).ToLocal(&element))
+        {
+          return kError;
+        }
+        v8::Local<v8::String> str = key.As<v8::String>();
+        name.resize(3 * static_cast<size_t>(str->Length()));
+        int nameLength = static_cast<int>(WriteString(str, name.data()));
+        if (!CheckKey(name.data(), static_cast<size_t>(nameLength)))
+        {
+          return kBail;
+        }
+        if ((status = Element(name.data(), nameLength, element, false, depth)) != kOk)
+        {
+          return status;
+        }
+      }
+    }
+    return kOk;
+  }
+
+  // The JavaScript code throws on keys with 0 bytes, and on the keys that start with $ or have a dot
+  // if it checks them, except the ones of DBRefs
+  bool CheckKey(const uint8_t *key, size_t length)
+  {
+    if (memchr(key, 0, length) != NULL)
+    {
+      return false;
+    }
+    if (!(flags & kFlagCheckKeys) || IsIgnoredKey(key, length))
+    {
+      return true;
+    }
+    return !(length > 0 && key[0] == '$') && memchr(key, '.', length) == NULL;
+  }
+
+  static bool IsIgnoredKey(const uint8_t *key, size_t length)
+  {
+    static const char *const ignored[] = {"$db", "$ref", "$id", "$clusterTime"};
+    for (size_t i = 0; i < sizeof(ignored) / sizeof(ignored[0]); i++)
+    {
+      if (strlen(ignored[i]) == length && memcmp(ignored[i], key, length) == 0)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Objects with a toBSON() method are left to the JavaScript code
+  Status CheckToBSON(v8::Local<v8::Object> object)
+  {
+    v8::Local<v8::Value> method;
+    if (!object->Get(context, toBSONName).ToLocal(&method))
+    {
+      return kError;
+    }
+    return method->BooleanValue(isolate) ? kBail : kOk;
+  }
+
+  bool Header(uint8_t type, const uint8_t *key, int keyLength, size_t valueLength)
+  {
+    if (!out.Reserve(2 + static_cast<size_t>(keyLength) + valueLength))
+    {
+      return false;
+    }
+    out.Put8(type);
+    memcpy(out.data + out.length, key, keyLength);
+    out.length += keyLength;
+    out.Put8(0);
+    return true;
+  }
+
+  // The element of a value, in the order of the checks of serializeInto()
+  Status Element(const uint8_t *key, int keyLength, v8::Local<v8::Value> value, bool inArray, int depth)
+  {
+    if (value->IsString())
+    {
+      return StringElement(key, keyLength, value.As<v8::String>());
+    }
+    if (value->IsNumber())
+    {
+      double d = value.As<v8::Number>()->Value();
+      // integers of 32 bits are int32, everything else a double
+      if (floor(d) == d && d >= -2147483648.0 && d <= 2147483647.0)
+      {
+        if (!Header(kTypeInt32, key, keyLength, 4))
+        {
+          return OutOfMemory();
+        }
+        out.Put32(static_cast<int32_t>(d));
+        return kOk;
+      }
+      return DoubleElement(key, keyLength, d);
+    }
+    if (value->IsBoolean())
+    {
+      if (!Header(kTypeBoolean, key, keyLength, 1))
+      {
+        return OutOfMemory();
+      }
+      out.Put8(value->IsTrue() ? 1 : 0);
+      return kOk;
+    }
+    if (value->IsNullOrUndefined())
+    {
+      if (value->IsUndefined() && !inArray && (flags & kFlagIgnoreUndefined))
+      {
+        return kOk;
+      }
+      return Header(kTypeNull, key, keyLength, 0) ? kOk : OutOfMemory();
+    }
+    if (!value->IsObject())
+    {
+      // symbols and bigints are left out
+      return kOk;
+    }
+
+    v8::Local<v8::Object> object = value.As<v8::Object>();
+    if (value->IsProxy() || value->IsStringObject())
+    {
+      return kBail;
+    }
+    Status status = CheckToBSON(object);
+    if (status != kOk)
+    {
+      return status;
+    }
+    if (value->IsDate())
+    {
+      // Long.fromNumber() of the time, NaN is 0
+      double time = value.As<v8::Date>()->ValueOf();
+      if (!Header(kTypeDate, key, keyLength, 8))
+      {
+        return OutOfMemory();
+      }
+      out.Put64(isnan(time) ? 0 : static_cast<uint64_t>(static_cast<int64_t>(time)));
+      return kOk;
+    }
+    v8::Local<v8::Value> type;
+    if (!object->Get(context, typeName).ToLocal(&type))
+    {
+      return kError;
+    }
+    if (value->IsFunction())
+    {
+      // functions are left out unless they are serialized
+      return (flags & kFlagSerializeFunctions) || !type->IsUndefined() ? kBail : kOk;
+    }
+    if (type->IsString())
+    {
+      return BSONType(key, keyLength, object, type.As<v8::String>());
+    }
+    if (!type->IsNullOrUndefined())
+    {
+      return kBail;
+    }
+    if (value->IsArrayBufferView())
+    {
+      // Buffers are binaries, the other views are objects in the JavaScript code
+      if (!value->IsUint8Array() || !object->GetPrototype()->StrictEquals(bufferPrototype))
+      {
+        return kBail;
+      }
+      const uint8_t *data = reinterpret_cast<const uint8_t *>(node::Buffer::Data(object));
+      size_t length = node::Buffer::Length(object);
+      if (length > 0x7FFFFFFF || !Header(kTypeBinary, key, keyLength, 5 + length))
+      {
+        return OutOfMemory();
+      }
+      out.Put32(static_cast<int32_t>(length));
+      out.Put8(0);
+      if (length > 0)
+      {
+        memcpy(out.data + out.length, data, length);
+      }
+      out.length += length;
+      return kOk;
+    }
+    if (value->IsRegExp())
+    {
+      return kBail;
+    }
+    if (!Header(object->IsArray() ? kTypeArray : kTypeObject, key, keyLength, 0))
+    {
+      return OutOfMemory();
+    }
+    return Document(object, depth + 1);
+  }
+
+  Status StringElement(const uint8_t *key, int keyLength, v8::Local<v8::String> str)
+  {
+    // a character takes up to 3 bytes
+    size_t max = 3 * static_cast<size_t>(str->Length());
+    if (!Header(kTypeString, key, keyLength, 5 + max))
+    {
+      return OutOfMemory();
+    }
+    size_t written = WriteString(str, out.data + out.length + 4);
+    out.Put32(static_cast<int32_t>(written + 1));
+    out.length += written;
+    out.Put8(0);
+    return kOk;
+  }
+
+  // Writes the UTF-8 bytes of a string, there is room for 3 bytes per character. String::WriteUtf8()
+  // costs more than the conversions here for the short strings of keys and values.
+  size_t WriteString(v8::Local<v8::String> str, uint8_t *dest)
+  {
+    size_t length = static_cast<size_t>(str->Length());
+    if (str->IsOneByte())
+    {
+      // Latin-1 characters are read to the end of the room and expanded from there, a character
+      // is never written past the ones still to read
+      uint8_t *chars = dest + 2 * length;
+      str->WriteOneByte(isolate, chars, 0, static_cast<int>(length), v8::String::NO_NULL_TERMINATION);
+      size_t n = 0;
+      for (size_t i = 0; i < length; i++)
+      {
+        uint8_t c = chars[i];
+        if (c < 0x80)
+        {
+          dest[n++] = c;
+        }
+        else
+        {
+          dest[n++] = static_cast<uint8_t>(0xC0 | c >> 6);
+          dest[n++] = static_cast<uint8_t>(0x80 | (c & 0x3F));
+        }
+      }
+      return n;
+    }
+    units.resize(length);
+    str->Write(isolate, units.data(), 0, static_cast<int>(length), v8::String::NO_NULL_TERMINATION);
+    size_t written;
+    if (utf8::FromUtf16(units.data(), length, dest, &written))
+    {
+      return written;
+    }
+    // lone surrogates are replaced, as Buffer.write() does
+    return static_cast<size_t>(str->WriteUtf8(isolate, reinterpret_cast<char *>(dest), static_cast<int>(3 * length),
+                                              NULL,
+                                              v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8));
+  }
+
+  Status DoubleElement(const uint8_t *key, int keyLength, double d)
+  {
+    if (!Header(kTypeDouble, key, keyLength, 8))
+    {
+      return OutOfMemory();
+    }
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    out.Put64(bits);
+    return kOk;
+  }
+
+  // The instances of the BSON classes the serializer handles
+  Status BSONType(const uint8_t *key, int keyLength, v8::Local<v8::Object> object, v8::Local<v8::String> type)
+  {
+    char name[16];
+    int length = type->Length();
+    if (length >= static_cast<int>(sizeof(name)) || !type->IsOneByte())
+    {
+      return kBail;
+    }
+    type->WriteOneByte(isolate, reinterpret_cast<uint8_t *>(name), 0, length);
+    name[length] = 0;
+
+    if (strcmp(name, "ObjectId") == 0 || strcmp(name, "ObjectID") == 0)
+    {
+      v8::Local<v8::Value> bytes;
+      if (!object->Get(context, idName).ToLocal(&bytes))
+      {
+        return kError;
+      }
+      if (!Header(kTypeObjectId, key, keyLength, 12))
+      {
+        return OutOfMemory();
+      }
+      // the id is a Buffer or a string of 12 bytes
+      if (bytes->IsString() && bytes.As<v8::String>()->Length() == 12 && bytes.As<v8::String>()->IsOneByte())
+      {
+        bytes.As<v8::String>()->WriteOneByte(isolate, out.data + out.length, 0, 12,
+                                             v8::String::NO_NULL_TERMINATION);
+      }
+      else if (node::Buffer::HasInstance(bytes) && node::Buffer::Length(bytes) >= 12)
+      {
+        memcpy(out.data + out.length, node::Buffer::Data(bytes), 12);
+      }
+      else
+      {
+        return kBail;
+      }
+      out.length += 12;
+      return kOk;
+    }
+    if (strcmp(name, "Long") == 0 || strcmp(name, "Timestamp") == 0)
+    {
+      v8::Local<v8::Value> lowBits;
+      v8::Local<v8::Value> highBits;
+      if (!object->Get(context, lowName).ToLocal(&lowBits) || !object->Get(context, highName).ToLocal(&highBits))
+      {
+        return kError;
+      }
+      if (!lowBits->IsInt32() || !highBits->IsInt32())
+      {
+        return kBail;
+      }
+      if (!Header(name[0] == 'L' ? kTypeLong : kTypeTimestamp, key, keyLength, 8))
+      {
+        return OutOfMemory();
+      }
+      out.Put32(lowBits.As<v8::Int32>()->Value());
+      out.Put32(highBits.As<v8::Int32>()->Value());
+      return kOk;
+    }
+    if (strcmp(name, "Double") == 0)
+    {
+      v8::Local<v8::Value> number;
+      if (!object->Get(context, valueName).ToLocal(&number))
+      {
+        return kError;
+      }
+      return number->IsNumber() ? DoubleElement(key, keyLength, number.As<v8::Number>()->Value()) : kBail;
+    }
+    return kBail;
+  }
+
+  Status OutOfMemory()
+  {
+    Nan::ThrowRangeError("Out of memory");
+    return kError;
+  }
+
+  int flags;
+  v8::Isolate *isolate;
+  v8::Local<v8::Context> context;
+  v8::Local<v8::Value> bufferPrototype;
+  v8::Local<v8::String> toBSONName;
+  v8::Local<v8::String> typeName;
+  v8::Local<v8::String> idName;
+  v8::Local<v8::String> lowName;
+  v8::Local<v8::String> highName;
+  v8::Local<v8::String> valueName;
+  // the documents being serialized
+  std::vector<v8::Local<v8::Object> > path;
+  // the UTF-8 key being serialized, Header() copies it before the value is serialized
+  std::vector<uint8_t> name;
+  // the UTF-16 code units of the string being written
+  std::vector<uint16_t> units;
+};
+
+} // namespace bson
+
+// bsonSerialize(object, flags, target), flags are checkKeys (1), serializeFunctions (2) and
+// ignoreUndefined (4). Writes the document to the target Buffer, returns the number of bytes written, a
+// Buffer with the document if it does not fit in the target, or undefined if the JavaScript code has to
+// serialize it.
+NAN_METHOD(BsonSerialize)
+{
+  if (!info[1]->IsInt32() || !node::Buffer::HasInstance(info[2]))
+  {
+    return Nan::ThrowTypeError("Invalid arguments");
+  }
+  bson::Serializer serializer(info[2].As<v8::Object>(), info[1].As<v8::Int32>()->Value());
+  bson::Status status;
+  {
+    ADONE_TRACE_SCOPE("data", "bson:serialize");
+    status = serializer.Serialize(info[0]);
+  }
+  if (status == bson::kOk)
+  {
+    info.GetReturnValue().Set(serializer.out.Release());
+  }
+}
+
+// bsonScan(bytes, offset), lists the elements of the document at the offset. Returns an Uint32Array of
+// type, name start, name end and value end for every element, or undefined if the document is not
+// valid.
+NAN_METHOD(BsonScan)
+{
+  const uint8_t *data;
+  size_t length;
+  if (!GetBytes(info[0], &data, &length) || !info[1]->IsNumber())
+  {
+    return Nan::ThrowTypeError("Invalid arguments");
+  }
+  double offset = info[1].As<v8::Number>()->Value();
+  if (!(offset >= 0 && offset <= static_cast<double>(length)))
+  {
+    return;
+  }
+  std::vector<bson::Element> elements;
+  {
+    ADONE_TRACE_SCOPE("data", "bson:scan");
+    if (!bson::Scan(data, length, static_cast<size_t>(offset), &elements))
+    {
+      return;
+    }
+  }
+  size_t count = elements.size() * 4;
+  v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), count * sizeof(uint32_t));
+  v8::Local<v8::Uint32Array> index = v8::Uint32Array::New(buffer, 0, count);
+  if (count > 0)
+  {
+    memcpy(*Nan::TypedArrayContents<uint32_t>(index), elements.data(), count * sizeof(uint32_t));
+  }
+  info.GetReturnValue().Set(index);
+}
+
+static void Internalize(Nan::Persistent<v8::String> *key, const char *name)
+{
+  key->Reset(v8::String::NewFromUtf8(v8::Isolate::GetCurrent(), name, v8::NewStringType::kInternalized)
+                 .ToLocalChecked());
+}
+
+NAN_MODULE_INIT(InitBson)
+{
+  Internalize(&bson::toBSONKey, "toBSON");
+  Internalize(&bson::typeKey, "_bsontype");
+  Internalize(&bson::idKey, "id");
+  Internalize(&bson::lowKey, "low");
+  Internalize(&bson::highKey, "high");
+  Internalize(&bson::valueKey, "value");
+  Nan::SetMethod(target, "bsonSerialize", BsonSerialize);
+  Nan::SetMethod(target, "bsonScan", BsonScan);
+}
+
+} // namespace nodedata
@@ -0,0 +1,184 @@
+#include "document.h"
+
+#include <string.h>
+
+namespace nodedata
+{
+namespace bson
+{
+
+// The size of a string value: an int32 size that counts the 0 byte the string ends with
+static bool StringSize(const uint8_t *in, size_t available, size_t *size)
+{
+  if (available < 4)
+  {
+    return false;
+  }
+  int32_t n = ReadInt32(in);
+  if (n < 1 || static_cast<size_t>(n) > available - 4 || in[4 + n - 1] != 0)
+  {
+    return false;
+  }
+  *size = 4 + static_cast<size_t>(n);
+  return true;
+}
+
+// The size of an embedded document
+static bool DocumentSize(const uint8_t *in, size_t available, size_t *size)
+{
+  if (available < 5)
+  {
+    return false;
+  }
+  int32_t n = ReadInt32(in);
+  if (n < 5 || static_cast<size_t>(n) > available || in[n - 1] != 0)
+  {
+    return false;
+  }
+  *size = static_cast<size_t>(n);
+  return true;
+}
+
+// The size of a C string with its 0 byte
+static bool CStringSize(const uint8_t *in, size_t available, size_t *size)
+{
+  const uint8_t *end = static_cast<const uint8_t *>(memchr(in, 0, available));
+  if (end == NULL)
+  {
+    return false;
+  }
+  *size = static_cast<size_t>(end - in) + 1;
+  return true;
+}
+
+static bool ValueSize(uint8_t type, const uint8_t *in, size_t available, size_t *size)
+{
+  size_t fixed = 0;
+  switch (type)
+  {
+  case kTypeUndefined:
+  case kTypeNull:
+  case kTypeMinKey:
+  case kTypeMaxKey:
+    fixed = 0;
+    break;
+  case kTypeBoolean:
+    fixed = 1;
+    break;
+  case kTypeInt32:
+    fixed = 4;
+    break;
+  case kTypeDouble:
+  case kTypeDate:
+  case kTypeTimestamp:
+  case kTypeLong:
+    fixed = 8;
+    break;
+  case kTypeObjectId:
+    fixed = 12;
+    break;
+  case kTypeDecimal128:
+    fixed = 16;
+    break;
+  case kTypeString:
+  case kTypeCode:
+  case kTypeSymbol:
+    return StringSize(in, available, size);
+  case kTypeObject:
+  case kTypeArray:
+    return DocumentSize(in, available, size);
+  case kTypeBinary:
+  {
+    if (available < 5)
+    {
+      return false;
+    }
+    int32_t n = ReadInt32(in);
+    if (n < 0 || static_cast<size_t>(n) > available - 5)
+    {
+      return false;
+    }
+    *size = 5 + static_cast<size_t>(n);
+    return true;
+  }
+  case kTypeRegExp:
+  {
+    size_t pattern;
+    size_t options;
+    if (!CStringSize(in, available, &pattern) || !CStringSize(in + pattern, available - pattern, &options))
+    {
+      return false;
+    }
+    *size = pattern + options;
+    return true;
+  }
+  case kTypeDbPointer:
+    if (!StringSize(in, available, size) || available - *size < 12)
+    {
+      return false;
+    }
+    *size += 12;
+    return true;
+  case kTypeCodeWithScope:
+  {
+    // the size covers the code and the scope
+    if (available < 4)
+    {
+      return false;
+    }
+    int32_t n = ReadInt32(in);
+    if (n < 14 || static_cast<size_t>(n) > available)
+    {
+      return false;
+    }
+    *size = static_cast<size_t>(n);
+    return true;
+  }
+  default:
+    return false;
+  }
+  *size = fixed;
+  return fixed <= available;
+}
+
+bool Scan(const uint8_t *data, size_t length, size_t offset, std::vector<Element> *elements)
+{
+  // the offsets of the elements take 32 bits
+  if (offset > length || length - offset < 5 || length > UINT32_MAX)
+  {
+    return false;
+  }
+  int32_t size = ReadInt32(data + offset);
+  if (size < 5 || static_cast<size_t>(size) > length - offset || data[offset + size - 1] != 0)
+  {
+    return false;
+  }
+  // the elements end before the 0 byte of the document
+  size_t end = offset + static_cast<size_t>(size) - 1;
+  size_t pos = offset + 4;
+  while (pos < end)
+  {
+    Element element;
+    element.type = data[pos++];
+    element.nameStart = static_cast<uint32_t>(pos);
+    size_t name;
+    if (!CStringSize(data + pos, end - pos, &name))
+    {
+      return false;
+    }
+    pos += name;
+    element.nameEnd = static_cast<uint32_t>(pos - 1);
+    size_t value;
+    if (!ValueSize(static_cast<uint8_t>(element.type), data + pos, end - pos, &value))
+    {
+      return false;
+    }
+    pos += value;
+    element.valueEnd = static_cast<uint32_t>(pos);
+    elements->push_back(element);
+  }
+  return true;
+}
+
+} // namespace bson
+} // namespace nodedata
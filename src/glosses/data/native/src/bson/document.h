@@ -0,0 +1,76 @@
+#ifndef __DATA_BSON_DOCUMENT_H_
+#define __DATA_BSON_DOCUMENT_H_
+
+// The layout of BSON documents: an int32 size, the elements, and a 0 byte. An element is a type
+// byte, the name as a C string and the value, whose size depends on the type.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace nodedata
+{
+namespace bson
+{
+
+enum Type
+{
+  kTypeDouble = 0x01,
+  kTypeString = 0x02,
+  kTypeObject = 0x03,
+  kTypeArray = 0x04,
+  kTypeBinary = 0x05,
+  kTypeUndefined = 0x06,
+  kTypeObjectId = 0x07,
+  kTypeBoolean = 0x08,
+  kTypeDate = 0x09,
+  kTypeNull = 0x0A,
+  kTypeRegExp = 0x0B,
+  kTypeDbPointer = 0x0C,
+  kTypeCode = 0x0D,
+  kTypeSymbol = 0x0E,
+  kTypeCodeWithScope = 0x0F,
+  kTypeInt32 = 0x10,
+  kTypeTimestamp = 0x11,
+  kTypeLong = 0x12,
+  kTypeDecimal128 = 0x13,
+  kTypeMinKey = 0xFF,
+  kTypeMaxKey = 0x7F
+};
+
+// An element of a document, the offsets are the ones of the whole buffer
+struct Element
+{
+  uint32_t type;
+  uint32_t nameStart;
+  // the value starts after the 0 byte of the name
+  uint32_t nameEnd;
+  uint32_t valueEnd;
+};
+
+static_assert(sizeof(Element) == 4 * sizeof(uint32_t), "bsonScan() copies the elements to an Uint32Array");
+
+inline int32_t ReadInt32(const uint8_t *in)
+{
+  return static_cast<int32_t>(static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8 |
+                              static_cast<uint32_t>(in[2]) << 16 | static_cast<uint32_t>(in[3]) << 24);
+}
+
+inline void WriteInt32(uint8_t *out, int32_t value)
+{
+  uint32_t v = static_cast<uint32_t>(value);
+  out[0] = static_cast<uint8_t>(v);
+  out[1] = static_cast<uint8_t>(v >> 8);
+  out[2] = static_cast<uint8_t>(v >> 16);
+  out[3] = static_cast<uint8_t>(v >> 24);
+}
+
+// Lists the elements of the document at `offset` without decoding their values. Returns false if
+// the document does not fit in the buffer, or its elements do not fit in the document.
+bool Scan(const uint8_t *data, size_t length, size_t offset, std::vector<Element> *elements);
+
+} // namespace bson
+} // namespace nodedata
+
+#endif // __DATA_BSON_DOCUMENT_H_
@@ -0,0 +1,76 @@
+#include "data.h"
+#include "byteorder/byteorder.h"
+
+#include <adone_trace.h>
+
+#include <string.h> // strcmp
+
+namespace nodedata
+{
+
+// byteOrderCopySwapped(source, sourceStart, target, targetStart, length, width), copies `length` bytes
+// of the source Buffer or typed array from sourceStart to the target one at targetStart, reversing
+// the bytes of every element of `width` bytes (2, 4 or 8).
+NAN_METHOD(ByteOrderCopySwapped)
+{
+  const uint8_t *source;
+  size_t sourceLength;
+  const uint8_t *target;
+  size_t targetLength;
+  if (!GetBytes(info[0], &source, &sourceLength) || !GetBytes(info[2], &target, &targetLength))
+  {
+    return Nan::ThrowTypeError("Source and target must be Buffers or typed arrays");
+  }
+  double sourceStart = Nan::To<double>(info[1]).FromJust();
+  double targetStart = Nan::To<double>(info[3]).FromJust();
+  double length = Nan::To<double>(info[4]).FromJust();
+  uint32_t width = Nan::To<uint32_t>(info[5]).FromJust();
+  if (width != 2 && width != 4 && width != 8)
+  {
+    return Nan::ThrowRangeError("Width must be 2, 4 or 8");
+  }
+  if (!(sourceStart >= 0 && length >= 0 && sourceStart + length <= static_cast<double>(sourceLength) &&
+        targetStart >= 0 && targetStart + length <= static_cast<double>(targetLength)) ||
+      static_cast<size_t>(length) % width != 0)
+  {
+    return Nan::ThrowRangeError("Invalid range");
+  }
+  ADONE_TRACE_SCOPE("data", "byteorder:copy");
+  byteorder::CopySwapped(source + static_cast<size_t>(sourceStart),
+                         const_cast<uint8_t *>(target) + static_cast<size_t>(targetStart),
+                         static_cast<size_t>(length), width);
+}
+
+NAN_METHOD(GetByteOrderKernel)
+{
+  v8::Local<v8::Object> result = Nan::New<v8::Object>();
+  Nan::Set(result, NanStr("active"), NanStr(byteorder::KernelName(byteorder::GetKernel())));
+  Nan::Set(result, NanStr("best"), NanStr(byteorder::KernelName(byteorder::GetBestKernel())));
+  info.GetReturnValue().Set(result);
+}
+
+// setKernel(name), returns false if the kernel is unknown or the CPU does not support it
+NAN_METHOD(SetByteOrderKernel)
+{
+  Nan::Utf8String name(info[0]);
+  static const byteorder::Kernel kernels[] = {byteorder::kKernelScalar, byteorder::kKernelSSSE3,
+                                              byteorder::kKernelAVX2};
+  for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+  {
+    if (*name != NULL && strcmp(*name, byteorder::KernelName(kernels[i])) == 0)
+    {
+      info.GetReturnValue().Set(byteorder::SetKernel(kernels[i]));
+      return;
+    }
+  }
+  info.GetReturnValue().Set(false);
+}
+
+NAN_MODULE_INIT(InitByteOrder)
+{
+  Nan::SetMethod(target, "byteOrderCopySwapped", ByteOrderCopySwapped);
+  Nan::SetMethod(target, "byteOrderGetKernel", GetByteOrderKernel);
+  Nan::SetMethod(target, "byteOrderSetKernel", SetByteOrderKernel);
+}
+
+} // namespace nodedata
@@ -0,0 +1,119 @@
+#include "byteorder_impl.h"
+
+#include <atomic>
+#include <string.h>
+
+namespace nodedata
+{
+namespace byteorder
+{
+
+Kernel GetBestKernel()
+{
+  const CpuFeatures &cpu = GetCpuFeatures();
+  if (cpu.avx2)
+  {
+    return kKernelAVX2;
+  }
+  return cpu.ssse3 ? kKernelSSSE3 : kKernelScalar;
+}
+
+static std::atomic<int> kernel(-1);
+
+Kernel GetKernel()
+{
+  int current = kernel.load(std::memory_order_relaxed);
+  if (current < 0)
+  {
+    current = GetBestKernel();
+    kernel.store(current, std::memory_order_relaxed);
+  }
+  return static_cast<Kernel>(current);
+}
+
+bool SetKernel(Kernel value)
+{
+  if (value > GetBestKernel())
+  {
+    return false;
+  }
+  kernel.store(value, std::memory_order_relaxed);
+  return true;
+}
+
+const char *KernelName(Kernel value)
+{
+  switch (value)
+  {
+  case kKernelAVX2:
+    return "avx2";
+  case kKernelSSSE3:
+    return "ssse3";
+  default:
+    return "scalar";
+  }
+}
+
+// The elements are loaded and stored with memcpy(), the arrays have no alignment
+static void SwapScalar(const uint8_t *in, uint8_t *out, size_t length, size_t width)
+{
+  switch (width)
+  {
+  case 2:
+    for (size_t i = 0; i < length; i += 2)
+    {
+      uint8_t a = in[i];
+      out[i] = in[i + 1];
+      out[i + 1] = a;
+    }
+    break;
+  case 4:
+    for (size_t i = 0; i < length; i += 4)
+    {
+      uint32_t v;
+      memcpy(&v, in + i, 4);
+      v = (v >> 24) | ((v >> 8) & 0xFF00) | ((v << 8) & 0xFF0000) | (v << 24);
+      memcpy(out + i, &v, 4);
+    }
+    break;
+  default:
+    for (size_t i = 0; i < length; i += 8)
+    {
+      uint64_t v;
+      memcpy(&v, in + i, 8);
+      v = ((v >> 8) & 0x00FF00FF00FF00FFULL) | ((v & 0x00FF00FF00FF00FFULL) << 8);
+      v = ((v >> 16) & 0x0000FFFF0000FFFFULL) | ((v & 0x0000FFFF0000FFFFULL) << 16);
+      v = (v >> 32) | (v << 32);
+      memcpy(out + i, &v, 8);
+    }
+    break;
+  }
+}
+
+void CopySwapped(const uint8_t *in, uint8_t *out, size_t length, size_t width)
+{
+  if (in != out && in < out + length && out < in + length)
+  {
+    // the elements are reversed where they are copied to
+    memmove(out, in, length);
+    in = out;
+  }
+  size_t done = 0;
+#if defined(DATA_X86)
+  switch (GetKernel())
+  {
+  case kKernelAVX2:
+    done = SwapBlocksAvx2(in, out, length, width);
+    break;
+  case kKernelSSSE3:
+    done = SwapBlocksSsse3(in, out, length, width);
+    break;
+  default:
+    break;
+  }
+#endif
+  SwapScalar(in + done, out + done, length - done, width);
+}
+
+} // namespace byteorder
+} // namespace nodedata
@@ -0,0 +1,38 @@
+#ifndef __DATA_BYTEORDER_H_
+#define __DATA_BYTEORDER_H_
+
+// Copies of arrays of 16, 32 and 64-bit elements with the bytes of every element reversed, the
+// conversion between the byte order of the host and the other one.
+//
+// The vector kernels reverse 16 or 32 bytes at once with a byte shuffle (PSHUFB), the elements of
+// the last bytes are reversed one by one.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace nodedata
+{
+namespace byteorder
+{
+
+enum Kernel
+{
+  kKernelScalar = 0,
+  kKernelSSSE3 = 1,
+  kKernelAVX2 = 2
+};
+
+// Copies `length` bytes, a multiple of `width` (2, 4 or 8), reversing the bytes of every element.
+// The ranges may overlap.
+void CopySwapped(const uint8_t *in, uint8_t *out, size_t length, size_t width);
+
+// The kernel in use, the same conventions as base64::SetKernel()
+Kernel GetKernel();
+Kernel GetBestKernel();
+bool SetKernel(Kernel kernel);
+const char *KernelName(Kernel kernel);
+
+} // namespace byteorder
+} // namespace nodedata
+
+#endif // __DATA_BYTEORDER_H_
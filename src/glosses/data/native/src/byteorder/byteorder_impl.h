@@ -0,0 +1,22 @@
+#ifndef __DATA_BYTEORDER_IMPL_H_
+#define __DATA_BYTEORDER_IMPL_H_
+
+#include "byteorder.h"
+#include "cpu.h"
+
+namespace nodedata
+{
+namespace byteorder
+{
+
+// Reverse the elements of the blocks of 16 (SSSE3) or 32 (AVX2) bytes that fit in `length`, return
+// the number of bytes done. `in` and `out` are the same or do not overlap.
+#if defined(DATA_X86)
+size_t SwapBlocksSsse3(const uint8_t *in, uint8_t *out, size_t length, size_t width);
+size_t SwapBlocksAvx2(const uint8_t *in, uint8_t *out, size_t length, size_t width);
+#endif
+
+} // namespace byteorder
+} // namespace nodedata
+
+#endif // __DATA_BYTEORDER_IMPL_H_
@@ -0,0 +1,76 @@
+#include "byteorder_impl.h"
+
+#if defined(DATA_X86)
+
+namespace nodedata
+{
+namespace byteorder
+{
+
+#define SSSE3_TARGET DATA_TARGET("ssse3")
+#define AVX2_TARGET DATA_TARGET("avx2")
+
+// The shuffles that reverse the elements of 2, 4 and 8 bytes of 16 bytes, VPSHUFB shuffles the two
+// halves of 32 bytes with the same one
+alignas(16) static const uint8_t kShuffles[3][16] = {
+    {1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14},
+    {3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12},
+    {7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8}};
+
+static const uint8_t *Shuffle(size_t width)
+{
+  return kShuffles[width == 2 ? 0 : width == 4 ? 1 : 2];
+}
+
+SSSE3_TARGET size_t SwapBlocksSsse3(const uint8_t *in, uint8_t *out, size_t length, size_t width)
+{
+  const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i *>(Shuffle(width)));
+  size_t i = 0;
+  for (; i + 64 <= length; i += 64)
+  {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 16));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 32));
+    __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 48));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_shuffle_epi8(a, shuffle));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 16), _mm_shuffle_epi8(b, shuffle));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 32), _mm_shuffle_epi8(c, shuffle));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 48), _mm_shuffle_epi8(d, shuffle));
+  }
+  for (; i + 16 <= length; i += 16)
+  {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_shuffle_epi8(a, shuffle));
+  }
+  return i;
+}
+
+AVX2_TARGET size_t SwapBlocksAvx2(const uint8_t *in, uint8_t *out, size_t length, size_t width)
+{
+  const __m256i shuffle =
+      _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i *>(Shuffle(width))));
+  size_t i = 0;
+  for (; i + 128 <= length; i += 128)
+  {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i + 32));
+    __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i + 64));
+    __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i + 96));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_shuffle_epi8(a, shuffle));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 32), _mm256_shuffle_epi8(b, shuffle));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 64), _mm256_shuffle_epi8(c, shuffle));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 96), _mm256_shuffle_epi8(d, shuffle));
+  }
+  for (; i + 32 <= length; i += 32)
+  {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_shuffle_epi8(a, shuffle));
+  }
+  // the last 16 bytes with the SSSE3 kernel
+  return i + SwapBlocksSsse3(in + i, out + i, length - i, width);
+}
+
+} // namespace byteorder
+} // namespace nodedata
+
+#endif // DATA_X86
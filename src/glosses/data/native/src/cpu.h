@@ -0,0 +1,34 @@
+#ifndef __DATA_CPU_H_
+#define __DATA_CPU_H_
+
+// Runtime detection of the instruction set extensions used by the SIMD kernels.
+//
+// Kernels are compiled with DATA_TARGET("...") so that the rest of the addon does not require
+// them, and are only called after checking the corresponding flag of GetCpuFeatures().
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define DATA_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define DATA_TARGET(features) __attribute__((target(features)))
+#else
+#define DATA_TARGET(features)
+#endif
+
+namespace nodedata
+{
+
+struct CpuFeatures
+{
+  bool ssse3;
+  bool sse41;
+  bool avx2;
+};
+
+const CpuFeatures &GetCpuFeatures();
+
+} // namespace nodedata
+
+#endif // __DATA_CPU_H_
@@ -0,0 +1,25 @@
+#include "data.h"
+#define ADONE_TRACE_IMPLEMENTATION
+#include <adone_trace.h>
+
+namespace nodedata
+{
+
+extern "C" NAN_MODULE_INIT(init)
+{
+  InitBase32(target);
+  InitBase64(target);
+  InitBaseX(target);
+  InitVarint(target);
+  InitUtf8(target);
+  InitMpak(target);
+  InitProtobuf(target);
+  InitBson(target);
+  InitJson(target);
+  InitYaml(target);
+  InitByteOrder(target);
+  adone::trace::Export(target);
+}
+
+NODE_MODULE(binding, init)
+} // namespace nodedata
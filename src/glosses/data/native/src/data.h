@@ -0,0 +1,85 @@
+#ifndef __DATA_DATA_H_
+#define __DATA_DATA_H_
+
+#include <adone.h>
+#include <node_buffer.h>
+
+#include <vector>
+
+namespace nodedata
+{
+
+// Every codec exports its methods from its own init function, called by the module init in data.cc
+NAN_MODULE_INIT(InitBase32);
+NAN_MODULE_INIT(InitBase64);
+NAN_MODULE_INIT(InitBaseX);
+NAN_MODULE_INIT(InitVarint);
+NAN_MODULE_INIT(InitUtf8);
+NAN_MODULE_INIT(InitMpak);
+NAN_MODULE_INIT(InitProtobuf);
+NAN_MODULE_INIT(InitBson);
+NAN_MODULE_INIT(InitJson);
+NAN_MODULE_INIT(InitYaml);
+NAN_MODULE_INIT(InitByteOrder);
+
+// Buffers and typed arrays are accepted as byte sources, returns false for anything else
+inline bool GetBytes(v8::Local<v8::Value> value, const uint8_t **data, size_t *length)
+{
+  if (!node::Buffer::HasInstance(value))
+  {
+    return false;
+  }
+  *data = reinterpret_cast<const uint8_t *>(node::Buffer::Data(value));
+  *length = node::Buffer::Length(value);
+  return true;
+}
+
+// The text input of the decoders: the bytes of a Buffer, or the characters of a string. Strings that
+// only have Latin-1 characters are copied one byte per character, other ones as UTF-8.
+class Text
+{
+public:
+  // Returns false if the value is neither a string nor a Buffer
+  bool Get(v8::Local<v8::Value> value)
+  {
+    if (GetBytes(value, &data, &length))
+    {
+      return true;
+    }
+    if (!value->IsString())
+    {
+      return false;
+    }
+    v8::Isolate *isolate = v8::Isolate::GetCurrent();
+    v8::Local<v8::String> str = value.As<v8::String>();
+    if (str->IsOneByte())
+    {
+      copy.resize(str->Length());
+      str->WriteOneByte(isolate, copy.data(), 0, -1, v8::String::NO_NULL_TERMINATION);
+    }
+    else
+    {
+      copy.resize(str->Utf8Length(isolate));
+      str->WriteUtf8(isolate, reinterpret_cast<char *>(copy.data()), -1, NULL, v8::String::NO_NULL_TERMINATION);
+    }
+    data = copy.data();
+    length = copy.size();
+    return true;
+  }
+
+  const uint8_t *data = NULL;
+  size_t length = 0;
+
+private:
+  std::vector<uint8_t> copy;
+};
+
+// The ASCII output of the encoders as a string
+inline v8::Local<v8::String> NewAsciiString(const uint8_t *data, size_t length)
+{
+  return Nan::NewOneByteString(data, static_cast<int>(length)).ToLocalChecked();
+}
+
+} // namespace nodedata
+
+#endif // __DATA_DATA_H_
@@ -0,0 +1,191 @@
+#include "data.h"
+#include "json/scanner.h"
+
+#include <adone_trace.h>
+
+#include <string.h> // strcmp
+
+namespace nodedata
+{
+namespace json
+{
+
+class ScannerWrap : public Nan::ObjectWrap
+{
+public:
+  static void Init(v8::Local<v8::Object> target)
+  {
+    v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+    tpl->SetClassName(NanStr("JsonScanner"));
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+    Nan::SetPrototypeMethod(tpl, "scan", Scan);
+    Nan::Set(target, NanStr("JsonScanner"), Nan::GetFunction(tpl).ToLocalChecked());
+  }
+
+  ~ScannerWrap()
+  {
+    stateArray.Reset();
+  }
+
+private:
+  // Reads the trie described in data/json/parser.js: the number of nodes, then for every node its
+  // slot, its number of keys and of indexes, the offset, length and node of every key in `keys`,
+  // and the index and node of every index. Returns false if it is not valid.
+  static bool Load(const int32_t *table, size_t length, const uint8_t *keys, size_t keysLength,
+                   std::vector<Node> *nodes)
+  {
+    size_t pos = 0;
+    if (length < 1 || table[0] < 1 || static_cast<size_t>(table[0]) > length)
+    {
+      return false;
+    }
+    nodes->resize(table[pos++]);
+    int32_t count = static_cast<int32_t>(nodes->size());
+    for (size_t i = 0; i < nodes->size(); i++)
+    {
+      Node &node = (*nodes)[i];
+      if (length - pos < 3 || table[pos] < -1 || table[pos + 1] < 0 || table[pos + 2] < 0)
+      {
+        return false;
+      }
+      node.slot = table[pos];
+      size_t keyCount = table[pos + 1];
+      size_t indexCount = table[pos + 2];
+      pos += 3;
+      if (keyCount > (length - pos) / 3 || indexCount > (length - pos - 3 * keyCount) / 2)
+      {
+        return false;
+      }
+      for (size_t j = 0; j < keyCount; j++, pos += 3)
+      {
+        const int32_t *k = table + pos;
+        if (k[0] < 0 || k[1] < 0 || static_cast<size_t>(k[0]) > keysLength ||
+            static_cast<size_t>(k[1]) > keysLength - k[0] || k[2] < 1 || k[2] >= count)
+        {
+          return false;
+        }
+        node.keys.push_back(std::make_pair(std::string(reinterpret_cast<const char *>(keys) + k[0], k[1]), k[2]));
+      }
+      for (size_t j = 0; j < indexCount; j++, pos += 2)
+      {
+        if (table[pos] < 0 || table[pos + 1] < 1 || table[pos + 1] >= count)
+        {
+          return false;
+        }
+        node.indexes.push_back(std::make_pair(static_cast<uint32_t>(table[pos]), table[pos + 1]));
+      }
+    }
+    return pos == length;
+  }
+
+  // new JsonScanner(table, keys, elements, state), state is a Float64Array of 2 elements
+  static NAN_METHOD(New)
+  {
+    if (!info.IsConstructCall())
+    {
+      return Nan::ThrowTypeError("Class constructor cannot be invoked without 'new'");
+    }
+    const uint8_t *keys;
+    size_t keysLength;
+    if (!info[0]->IsInt32Array() || !GetBytes(info[1], &keys, &keysLength) || !info[3]->IsFloat64Array())
+    {
+      return Nan::ThrowTypeError("Invalid arguments");
+    }
+    Nan::TypedArrayContents<int32_t> table(info[0]);
+    Nan::TypedArrayContents<double> state(info[3]);
+    std::vector<Node> nodes;
+    if (state.length() < 2 || !Load(*table, table.length(), keys, keysLength, &nodes))
+    {
+      return Nan::ThrowTypeError("Invalid arguments");
+    }
+    ScannerWrap *wrap = new ScannerWrap(std::move(nodes), Nan::To<bool>(info[2]).FromJust());
+    // the array keeps the memory of the state
+    wrap->stateArray.Reset(info[3]);
+    wrap->state = *state;
+    wrap->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  }
+
+  // scan(bytes, length, final), scans the first `length` bytes, see Scanner::Scan(). Returns an
+  // Uint32Array of the start and end of every value and of its selected values, or undefined if the
+  // structure is not valid. The state is set to the number of bytes consumed and the position of
+  // the error.
+  static NAN_METHOD(Scan)
+  {
+    ScannerWrap *wrap = Nan::ObjectWrap::Unwrap<ScannerWrap>(info.Holder());
+    const uint8_t *data;
+    size_t length;
+    if (!GetBytes(info[0], &data, &length) || !info[1]->IsNumber())
+    {
+      return Nan::ThrowTypeError("Invalid arguments");
+    }
+    double end = info[1].As<v8::Number>()->Value();
+    if (!(end >= 0 && end <= static_cast<double>(length)) || end > static_cast<double>(UINT32_MAX))
+    {
+      return Nan::ThrowRangeError("Invalid length");
+    }
+    std::vector<uint32_t> &values = wrap->values;
+    values.clear();
+    bool ok;
+    {
+      ADONE_TRACE_SCOPE("data", "json:scan");
+      ok = wrap->scanner.Scan(data, static_cast<size_t>(end), Nan::To<bool>(info[2]).FromJust(), &values);
+    }
+    wrap->state[0] = static_cast<double>(wrap->scanner.consumed);
+    wrap->state[1] = static_cast<double>(wrap->scanner.errorPosition);
+    if (!ok)
+    {
+      return;
+    }
+    v8::Local<v8::ArrayBuffer> buffer =
+        v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), values.size() * sizeof(uint32_t));
+    v8::Local<v8::Uint32Array> result = v8::Uint32Array::New(buffer, 0, values.size());
+    if (!values.empty())
+    {
+      memcpy(*Nan::TypedArrayContents<uint32_t>(result), values.data(), values.size() * sizeof(uint32_t));
+    }
+    info.GetReturnValue().Set(result);
+  }
+
+  ScannerWrap(std::vector<Node> nodes, bool elements) : scanner(std::move(nodes), elements), state(NULL) {}
+
+  Scanner scanner;
+  std::vector<uint32_t> values;
+  Nan::Persistent<v8::Value> stateArray;
+  double *state;
+};
+
+} // namespace json
+
+NAN_METHOD(GetJsonKernel)
+{
+  v8::Local<v8::Object> result = Nan::New<v8::Object>();
+  Nan::Set(result, NanStr("active"), NanStr(json::KernelName(json::GetKernel())));
+  Nan::Set(result, NanStr("best"), NanStr(json::KernelName(json::GetBestKernel())));
+  info.GetReturnValue().Set(result);
+}
+
+// setKernel(name), returns false if the kernel is unknown or the CPU does not support it
+NAN_METHOD(SetJsonKernel)
+{
+  Nan::Utf8String name(info[0]);
+  static const json::Kernel kernels[] = {json::kKernelScalar, json::kKernelSSSE3, json::kKernelAVX2};
+  for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+  {
+    if (*name != NULL && strcmp(*name, json::KernelName(kernels[i])) == 0)
+    {
+      info.GetReturnValue().Set(json::SetKernel(kernels[i]));
+      return;
+    }
+  }
+  info.GetReturnValue().Set(false);
+}
+
+NAN_MODULE_INIT(InitJson)
+{
+  json::ScannerWrap::Init(target);
+  Nan::SetMethod(target, "jsonGetKernel", GetJsonKernel);
+  Nan::SetMethod(target, "jsonSetKernel", SetJsonKernel);
+}
+
+} // namespace nodedata
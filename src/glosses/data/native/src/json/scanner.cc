@@ -0,0 +1,561 @@
+#include "scanner_impl.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace nodedata
+{
+namespace json
+{
+
+// Deeper containers are errors, every level takes a frame
+static const size_t kMaxDepth = 10000;
+
+Kernel GetBestKernel()
+{
+  const CpuFeatures &cpu = GetCpuFeatures();
+  if (cpu.avx2)
+  {
+    return kKernelAVX2;
+  }
+  return cpu.ssse3 ? kKernelSSSE3 : kKernelScalar;
+}
+
+static std::atomic<int> kernel(-1);
+
+Kernel GetKernel()
+{
+  int current = kernel.load(std::memory_order_relaxed);
+  if (current < 0)
+  {
+    current = GetBestKernel();
+    kernel.store(current, std::memory_order_relaxed);
+  }
+  return static_cast<Kernel>(current);
+}
+
+bool SetKernel(Kernel value)
+{
+  if (value > GetBestKernel())
+  {
+    return false;
+  }
+  kernel.store(value, std::memory_order_relaxed);
+  return true;
+}
+
+const char *KernelName(Kernel value)
+{
+  switch (value)
+  {
+  case kKernelAVX2:
+    return "avx2";
+  case kKernelSSSE3:
+    return "ssse3";
+  default:
+    return "scalar";
+  }
+}
+
+static void ClassifyScalar(const uint8_t *in, Masks *masks)
+{
+  uint64_t quote = 0;
+  uint64_t backslash = 0;
+  uint64_t structural = 0;
+  uint64_t open = 0;
+  uint64_t close = 0;
+  for (int i = 0; i < 64; i++)
+  {
+    uint8_t c = in[i];
+    quote |= static_cast<uint64_t>(c == '"') << i;
+    backslash |= static_cast<uint64_t>(c == '\\') << i;
+    structural |= static_cast<uint64_t>((kStructuralLow[c & 0x0F] & kStructuralHigh[c >> 4]) != 0) << i;
+    open |= static_cast<uint64_t>((c | 0x20) == '{') << i;
+    close |= static_cast<uint64_t>((c | 0x20) == '}') << i;
+  }
+  masks->quote = quote;
+  masks->backslash = backslash;
+  masks->structural = structural;
+  masks->open = open;
+  masks->close = close;
+}
+
+void Classify(const uint8_t *in, Masks *masks)
+{
+#if defined(DATA_X86)
+  switch (GetKernel())
+  {
+  case kKernelAVX2:
+    return ClassifyAvx2(in, masks);
+  case kKernelSSSE3:
+    return ClassifySsse3(in, masks);
+  default:
+    break;
+  }
+#endif
+  ClassifyScalar(in, masks);
+}
+
+static inline unsigned CountTrailingZeros(uint64_t bits)
+{
+#if defined(_MSC_VER)
+  unsigned long index;
+  _BitScanForward64(&index, bits);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctzll(bits));
+#endif
+}
+
+// The bytes that follow an odd number of backslashes. `carry` is 1 if the first byte is escaped by
+// the previous block, and is set to whether the first byte of the next block is.
+static inline uint64_t FindEscaped(uint64_t backslash, uint64_t *carry)
+{
+  const uint64_t even = 0x5555555555555555ULL;
+  backslash &= ~*carry;
+  uint64_t follows = backslash << 1 | *carry;
+  // the sequences of backslashes that start on an odd bit, the carries of the addition clear them
+  // and leave the bit after them
+  uint64_t oddStarts = backslash & ~even & ~follows;
+  uint64_t evenSequences = oddStarts + backslash;
+  *carry = evenSequences < oddStarts;
+  uint64_t invert = evenSequences << 1;
+  return (even ^ invert) & follows;
+}
+
+// Bit i is the parity of the bits up to i, the bytes between two quotes are set
+static inline uint64_t PrefixXor(uint64_t bits)
+{
+  bits ^= bits << 1;
+  bits ^= bits << 2;
+  bits ^= bits << 4;
+  bits ^= bits << 8;
+  bits ^= bits << 16;
+  bits ^= bits << 32;
+  return bits;
+}
+
+static inline bool IsWhitespace(uint8_t c)
+{
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// Trims the whitespace around the bytes from start to end, returns false if only whitespace is left
+static inline bool Trim(const uint8_t *data, size_t *start, size_t *end)
+{
+  while (*start < *end && IsWhitespace(data[*start]))
+  {
+    ++*start;
+  }
+  while (*end > *start && IsWhitespace(data[*end - 1]))
+  {
+    --*end;
+  }
+  return *start < *end;
+}
+
+Scanner::Scanner(std::vector<Node> trie, bool elements)
+    : consumed(0), errorPosition(0), nodes(std::move(trie)), slotCount(0), elements(elements), out(NULL),
+      lastEnd(0), scanned(0), escapeCarry(0), stringCarry(0), inString(false), stringStart(0), stringNode(-1),
+      skipDepth(0)
+{
+  if (nodes.empty())
+  {
+    Node root = {-1, {}, {}};
+    nodes.push_back(root);
+  }
+  for (size_t i = 0; i < nodes.size(); i++)
+  {
+    slotCount = std::max(slotCount, static_cast<size_t>(nodes[i].slot + 1));
+  }
+  slots.assign(2 * slotCount, 0);
+  Frame stream = {0, kValue, true, 0, -1, 0, 0, 0};
+  stack.push_back(stream);
+}
+
+bool Scanner::Scan(const uint8_t *data, size_t length, bool final, std::vector<uint32_t> *values)
+{
+  out = values;
+  lastEnd = 0;
+  consumed = 0;
+  size_t pos = scanned;
+  while (pos < length)
+  {
+    size_t n = std::min<size_t>(length - pos, 64);
+    Masks masks;
+    if (n == 64)
+    {
+      Classify(data + pos, &masks);
+    }
+    else
+    {
+      // spaces change nothing
+      uint8_t block[64];
+      memset(block, ' ', sizeof(block));
+      memcpy(block, data + pos, n);
+      Classify(block, &masks);
+    }
+    uint64_t carry = escapeCarry;
+    uint64_t escaped = FindEscaped(masks.backslash, &carry);
+    uint64_t quote = masks.quote & ~escaped;
+    // the strings with their opening quote
+    uint64_t inside = PrefixXor(quote) ^ stringCarry;
+    if (n == 64)
+    {
+      escapeCarry = carry;
+      stringCarry = static_cast<uint64_t>(static_cast<int64_t>(inside) >> 63);
+    }
+    else
+    {
+      // the next scan starts after the last byte
+      escapeCarry = (escaped >> n) & 1;
+      stringCarry = (inside >> (n - 1)) & 1 ? ~0ULL : 0;
+    }
+    uint64_t bits = (masks.structural & ~inside) | quote;
+    while (bits != 0)
+    {
+      if (skipDepth != 0)
+      {
+        // only the brackets count until the container ends
+        uint64_t brackets = bits & (masks.open | masks.close);
+        bits = 0;
+        while (brackets != 0)
+        {
+          unsigned i = CountTrailingZeros(brackets);
+          brackets &= brackets - 1;
+          if ((masks.open >> i) & 1)
+          {
+            skipDepth++;
+          }
+          else if (--skipDepth == 0)
+          {
+            if (!Close(data, pos + i))
+            {
+              errorPosition = static_cast<int64_t>(pos + i);
+              return false;
+            }
+            bits = (masks.structural & ~inside) | quote;
+            bits &= ~((2ULL << i) - 1);
+            break;
+          }
+        }
+        continue;
+      }
+      size_t p = pos + CountTrailingZeros(bits);
+      bits &= bits - 1;
+      if (!Step(data, p))
+      {
+        errorPosition = static_cast<int64_t>(p);
+        return false;
+      }
+    }
+    pos += n;
+  }
+  scanned = length;
+
+  bool top = !inString && stack.size() == 1;
+  if (top)
+  {
+    Tokens(data, length, final);
+  }
+  if (final && !top)
+  {
+    errorPosition = -1;
+    return false;
+  }
+  // the bytes before the value being scanned are not needed anymore
+  Rebase(top ? stack[0].from : lastEnd);
+  if (final)
+  {
+    escapeCarry = 0;
+    stringCarry = 0;
+  }
+  return true;
+}
+
+bool Scanner::Step(const uint8_t *data, size_t pos)
+{
+  Frame *top = &stack.back();
+  if (inString)
+  {
+    // the closing quote
+    inString = false;
+    if (top->expect == kKey)
+    {
+      top->child = top->node < 0 ? -1 : Child(top->node, data + stringStart + 1, pos - stringStart - 1);
+      top->expect = kColon;
+    }
+    else
+    {
+      End(*top, stringNode, stringStart, pos + 1);
+    }
+    top->from = pos + 1;
+    return true;
+  }
+
+  uint8_t c = data[pos];
+  switch (c)
+  {
+  case '"':
+  case '{':
+  case '[':
+  {
+    if (top->kind == 0)
+    {
+      // the scalars before are values of the stream
+      Tokens(data, pos, true);
+    }
+    else
+    {
+      size_t start = top->from;
+      size_t end = pos;
+      if (Trim(data, &start, &end) || (top->expect != kValue && (top->expect != kKey || c != '"')))
+      {
+        return false;
+      }
+      if (top->expect == kKey)
+      {
+        inString = true;
+        stringStart = pos;
+        return true;
+      }
+    }
+    bool outer = elements && c == '[' && top->kind == 0;
+    int node = -1;
+    if (top->records && !outer)
+    {
+      Begin();
+      node = 0;
+    }
+    else if (!top->records)
+    {
+      node = top->child;
+    }
+    if (c == '"')
+    {
+      inString = true;
+      stringStart = pos;
+      stringNode = node;
+      return true;
+    }
+    if (stack.size() >= kMaxDepth)
+    {
+      return false;
+    }
+    Frame frame = {c, c == '{' ? kKey : kValue, outer, node, c == '[' && node >= 0 ? Index(node, 0) : -1, 0, pos,
+                   pos + 1};
+    stack.push_back(frame);
+    if (!outer && (node < 0 || (nodes[node].keys.empty() && nodes[node].indexes.empty())))
+    {
+      // no value is selected in the container
+      skipDepth = 1;
+    }
+    return true;
+  }
+  case '}':
+  case ']':
+  {
+    if (top->kind != (c == '}' ? '{' : '['))
+    {
+      return false;
+    }
+    if (!Scalar(data, pos))
+    {
+      // only an empty container ends where a value is expected
+      size_t start = top->from;
+      size_t end = pos;
+      if (top->index != 0 || top->expect != (c == '}' ? kKey : kValue) || Trim(data, &start, &end))
+      {
+        return false;
+      }
+    }
+    return Close(data, pos);
+  }
+  case ',':
+    if (top->kind == 0 || !Scalar(data, pos))
+    {
+      return false;
+    }
+    top->index++;
+    top->from = pos + 1;
+    if (top->kind == '{')
+    {
+      top->expect = kKey;
+      top->child = -1;
+    }
+    else
+    {
+      top->expect = kValue;
+      top->child = top->node < 0 ? -1 : Index(top->node, top->index);
+    }
+    return true;
+  default:
+    // ':'
+    if (top->kind != '{' || top->expect != kColon)
+    {
+      return false;
+    }
+    top->expect = kValue;
+    top->from = pos + 1;
+    return true;
+  }
+}
+
+// Ends the container at the top of the stack
+bool Scanner::Close(const uint8_t *data, size_t pos)
+{
+  Frame closed = stack.back();
+  if (closed.kind != (data[pos] == '}' ? '{' : '['))
+  {
+    return false;
+  }
+  stack.pop_back();
+  Frame &parent = stack.back();
+  if (!closed.records)
+  {
+    End(parent, closed.node, closed.start, pos + 1);
+  }
+  parent.from = pos + 1;
+  return true;
+}
+
+// Ends the scalar before a comma or the end of a container. Returns true if a value ends there, the
+// scalar or the value before.
+bool Scanner::Scalar(const uint8_t *data, size_t pos)
+{
+  Frame &top = stack.back();
+  size_t start = top.from;
+  size_t end = pos;
+  bool scalar = Trim(data, &start, &end);
+  if (top.expect != kValue)
+  {
+    return top.expect == kComma && !scalar;
+  }
+  if (!scalar)
+  {
+    return false;
+  }
+  if (top.records)
+  {
+    Begin();
+  }
+  End(top, top.records ? 0 : top.child, start, end);
+  return true;
+}
+
+// A value of the stream starts
+void Scanner::Begin()
+{
+  std::fill(slots.begin(), slots.end(), 0);
+}
+
+// A value at `node` of the frame ends
+void Scanner::End(Frame &frame, int node, size_t start, size_t end)
+{
+  if (node >= 0 && nodes[node].slot >= 0)
+  {
+    slots[2 * nodes[node].slot] = static_cast<uint32_t>(start);
+    slots[2 * nodes[node].slot + 1] = static_cast<uint32_t>(end);
+  }
+  frame.expect = frame.kind == 0 ? kValue : kComma;
+  if (frame.records)
+  {
+    Emit(start, end);
+  }
+}
+
+void Scanner::Emit(size_t start, size_t end)
+{
+  out->push_back(static_cast<uint32_t>(start));
+  out->push_back(static_cast<uint32_t>(end));
+  out->insert(out->end(), slots.begin(), slots.end());
+  lastEnd = end;
+}
+
+// The scalars of the stream are separated by whitespace, the last one before `end` is only complete
+// if `final` is true
+void Scanner::Tokens(const uint8_t *data, size_t end, bool final)
+{
+  Frame &stream = stack[0];
+  size_t pos = stream.from;
+  while (pos < end)
+  {
+    if (IsWhitespace(data[pos]))
+    {
+      pos++;
+      continue;
+    }
+    size_t start = pos;
+    while (pos < end && !IsWhitespace(data[pos]))
+    {
+      pos++;
+    }
+    if (pos == end && !final)
+    {
+      stream.from = start;
+      return;
+    }
+    Begin();
+    End(stream, 0, start, pos);
+  }
+  stream.from = end;
+}
+
+int Scanner::Child(int node, const uint8_t *key, size_t length) const
+{
+  const std::vector<std::pair<std::string, int>> &keys = nodes[node].keys;
+  for (size_t i = 0; i < keys.size(); i++)
+  {
+    if (keys[i].first.size() == length && memcmp(keys[i].first.data(), key, length) == 0)
+    {
+      return keys[i].second;
+    }
+  }
+  return -1;
+}
+
+int Scanner::Index(int node, uint32_t index) const
+{
+  const std::vector<std::pair<uint32_t, int>> &indexes = nodes[node].indexes;
+  for (size_t i = 0; i < indexes.size(); i++)
+  {
+    if (indexes[i].first == index)
+    {
+      return indexes[i].second;
+    }
+  }
+  return -1;
+}
+
+// The positions start after `offset` bytes in the next scan
+void Scanner::Rebase(size_t offset)
+{
+  consumed = offset;
+  if (offset == 0)
+  {
+    return;
+  }
+  scanned -= offset;
+  stringStart = stringStart >= offset ? stringStart - offset : 0;
+  for (size_t i = 0; i < stack.size(); i++)
+  {
+    stack[i].start = stack[i].start >= offset ? stack[i].start - offset : 0;
+    stack[i].from = stack[i].from >= offset ? stack[i].from - offset : 0;
+  }
+  for (size_t i = 0; i < slots.size(); i += 2)
+  {
+    if (slots[i + 1] != 0)
+    {
+      slots[i] -= static_cast<uint32_t>(offset);
+      slots[i + 1] -= static_cast<uint32_t>(offset);
+    }
+  }
+}
+
+} // namespace json
+} // namespace nodedata
@@ -0,0 +1,147 @@
+#ifndef __DATA_JSON_SCANNER_H_
+#define __DATA_JSON_SCANNER_H_
+
+// Scanner of streams of JSON texts, concatenated or one per line (NDJSON). It finds where the values
+// of the stream start and end, and where the values at some paths of every value are, without
+// parsing them; data/json/parser.js parses these slices.
+//
+// The bytes are classified 64 at once into masks of the quotes, the backslashes and the structural
+// characters. The quotes that are not escaped delimit the strings, the structural characters
+// outside of them and the quotes are followed one by one to track the containers (the first stage
+// of simdjson). The vector kernels classify the bytes by looking up their two nibbles.
+//
+// The containers that have no selected value are skipped by counting their brackets, the other ones
+// have their structure checked. The values are checked when they are parsed.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace nodedata
+{
+namespace json
+{
+
+enum Kernel
+{
+  kKernelScalar = 0,
+  kKernelSSSE3 = 1,
+  kKernelAVX2 = 2
+};
+
+// The masks of a block of 64 bytes, bit i is for byte i
+struct Masks
+{
+  uint64_t quote;
+  uint64_t backslash;
+  // , : [ ] { }
+  uint64_t structural;
+  // [ {
+  uint64_t open;
+  // ] }
+  uint64_t close;
+};
+
+void Classify(const uint8_t *in, Masks *masks);
+
+// The kernel in use, SetKernel() returns false if the CPU does not support the kernel
+Kernel GetKernel();
+Kernel GetBestKernel();
+bool SetKernel(Kernel kernel);
+const char *KernelName(Kernel kernel);
+
+// A node of the trie of the selected paths, the root is the value itself
+struct Node
+{
+  // the index of the value in the selected values, -1 if the value at this path is not selected
+  int slot;
+  std::vector<std::pair<std::string, int>> keys;
+  std::vector<std::pair<uint32_t, int>> indexes;
+};
+
+class Scanner
+{
+public:
+  // The values of the stream are the elements of the arrays at the top of the stream if `elements`
+  // is true, the other values of the top are values of the stream as well.
+  Scanner(std::vector<Node> nodes, bool elements);
+
+  // Scans the bytes from the end of the previous scan to `length`, the bytes before are the ones the
+  // previous scan did not consume. For every value that ends, appends its start and end and then
+  // the start and end of every selected value, 0 and 0 if it is missing. `final` is true if no more
+  // bytes follow.
+  //
+  // Returns false if the structure is not valid, errorPosition is the position of the unexpected
+  // byte or -1 for an unexpected end. consumed is the number of bytes the next scan does not need,
+  // the positions of the next scan start after them.
+  bool Scan(const uint8_t *data, size_t length, bool final, std::vector<uint32_t> *values);
+
+  size_t SlotCount() const
+  {
+    return slotCount;
+  }
+
+  size_t consumed;
+  int64_t errorPosition;
+
+private:
+  enum Expect
+  {
+    kValue,
+    kKey,
+    kColon,
+    kComma
+  };
+
+  struct Frame
+  {
+    // 0 for the stream, '{' or '['
+    uint8_t kind;
+    Expect expect;
+    // the values of the frame are values of the stream
+    bool records;
+    // the nodes of the container and of the value expected
+    int node;
+    int child;
+    uint32_t index;
+    // the start of the container, and the position after the last structural character
+    size_t start;
+    size_t from;
+  };
+
+  bool Step(const uint8_t *data, size_t pos);
+  bool Close(const uint8_t *data, size_t pos);
+  bool Scalar(const uint8_t *data, size_t pos);
+  void Begin();
+  void End(Frame &frame, int node, size_t start, size_t end);
+  void Emit(size_t start, size_t end);
+  void Tokens(const uint8_t *data, size_t end, bool final);
+  int Child(int node, const uint8_t *key, size_t length) const;
+  int Index(int node, uint32_t index) const;
+  void Rebase(size_t offset);
+
+  std::vector<Node> nodes;
+  size_t slotCount;
+  bool elements;
+  std::vector<Frame> stack;
+  // the selected values of the value of the stream being scanned
+  std::vector<uint32_t> slots;
+  std::vector<uint32_t> *out;
+  size_t lastEnd;
+  size_t scanned;
+  // the state at the end of the previous block
+  uint64_t escapeCarry;
+  uint64_t stringCarry;
+  bool inString;
+  size_t stringStart;
+  int stringNode;
+  // the depth in the container being skipped, 0 if none is
+  size_t skipDepth;
+};
+
+} // namespace json
+} // namespace nodedata
+
+#endif // __DATA_JSON_SCANNER_H_
@@ -0,0 +1,25 @@
+#ifndef __DATA_JSON_SCANNER_IMPL_H_
+#define __DATA_JSON_SCANNER_IMPL_H_
+
+#include "scanner.h"
+#include "cpu.h"
+
+namespace nodedata
+{
+namespace json
+{
+
+// The classes of the structural characters, looked up by the low and the high nibble of a byte. The
+// byte is structural if the two lookups share a bit.
+static const uint8_t kStructuralLow[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 4, 1, 4, 0, 0};
+static const uint8_t kStructuralHigh[16] = {0, 0, 1, 2, 0, 4, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0};
+
+#if defined(DATA_X86)
+void ClassifySsse3(const uint8_t *in, Masks *masks);
+void ClassifyAvx2(const uint8_t *in, Masks *masks);
+#endif
+
+} // namespace json
+} // namespace nodedata
+
+#endif // __DATA_JSON_SCANNER_IMPL_H_
@@ -0,0 +1,90 @@
+#include "scanner_impl.h"
+
+#if defined(DATA_X86)
+
+namespace nodedata
+{
+namespace json
+{
+
+#define SSSE3_TARGET DATA_TARGET("ssse3")
+#define AVX2_TARGET DATA_TARGET("avx2")
+
+// SSSE3, 4 vectors of 16 bytes
+
+SSSE3_TARGET static inline uint64_t Structural(__m128i v)
+{
+  __m128i low = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(kStructuralLow)),
+                                 _mm_and_si128(v, _mm_set1_epi8(0x0F)));
+  __m128i high = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(kStructuralHigh)),
+                                  _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F)));
+  __m128i none = _mm_cmpeq_epi8(_mm_and_si128(low, high), _mm_setzero_si128());
+  return static_cast<uint16_t>(~_mm_movemask_epi8(none));
+}
+
+SSSE3_TARGET void ClassifySsse3(const uint8_t *in, Masks *masks)
+{
+  uint64_t quote = 0;
+  uint64_t backslash = 0;
+  uint64_t structural = 0;
+  uint64_t open = 0;
+  uint64_t close = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 16 * i));
+    quote |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')))))
+             << (16 * i);
+    backslash |=
+        static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\')))))
+        << (16 * i);
+    structural |= Structural(v) << (16 * i);
+    // [ and { only differ by 0x20, as do ] and }
+    __m128i folded = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    open |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(folded, _mm_set1_epi8('{')))))
+            << (16 * i);
+    close |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(folded, _mm_set1_epi8('}')))))
+             << (16 * i);
+  }
+  masks->quote = quote;
+  masks->backslash = backslash;
+  masks->structural = structural;
+  masks->open = open;
+  masks->close = close;
+}
+
+// AVX2, 2 vectors of 32 bytes. The tables are the same in the two lanes.
+
+AVX2_TARGET static inline uint64_t Structural(__m256i v)
+{
+  __m256i low = _mm256_shuffle_epi8(
+      _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(kStructuralLow))),
+      _mm256_and_si256(v, _mm256_set1_epi8(0x0F)));
+  __m256i high = _mm256_shuffle_epi8(
+      _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(kStructuralHigh))),
+      _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F)));
+  __m256i none = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256());
+  return static_cast<uint32_t>(~_mm256_movemask_epi8(none));
+}
+
+AVX2_TARGET static inline uint64_t Equal(__m256i v, char c)
+{
+  return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))));
+}
+
+AVX2_TARGET void ClassifyAvx2(const uint8_t *in, Masks *masks)
+{
+  __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in));
+  __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + 32));
+  masks->quote = Equal(lo, '"') | Equal(hi, '"') << 32;
+  masks->backslash = Equal(lo, '\\') | Equal(hi, '\\') << 32;
+  masks->structural = Structural(lo) | Structural(hi) << 32;
+  __m256i foldedLo = _mm256_or_si256(lo, _mm256_set1_epi8(0x20));
+  __m256i foldedHi = _mm256_or_si256(hi, _mm256_set1_epi8(0x20));
+  masks->open = Equal(foldedLo, '{') | Equal(foldedHi, '{') << 32;
+  masks->close = Equal(foldedLo, '}') | Equal(foldedHi, '}') << 32;
+}
+
+} // namespace json
+} // namespace nodedata
+
+#endif // DATA_X86
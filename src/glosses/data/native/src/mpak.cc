@@ -0,0 +1,1007 @@
+#include "data.h"
+
+#include <adone_trace.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace nodedata
+{
+
+// MessagePack core of data/mpak.js.
+//
+// The encoder and the decoder handle the values that mpak.js writes without extensions: null,
+// undefined (fixext 1 of type 0), booleans, numbers, strings, Buffers, arrays and plain objects.
+// Anything else is passed to a fallback function that runs the JavaScript code for that value only:
+// the registered types, the other objects, the 64-bit signed integers that decode to Longs. The
+// output of both is the same as the one of the JavaScript code.
+//
+// The frames are the values with a size before them and flags and an id after them, netron sends its
+// packets as frames. They are written one at a time and read as many as there are in the input.
+
+// Nesting deeper than this is left to the fallback
+static const int kMaxDepth = 512;
+// The elements of arrays and maps are encoded under a handle scope for this many of them
+static const uint32_t kScopeChunk = 1024;
+
+// Writes to the memory of the target Buffer, and to its own memory once the target is full
+class Writer
+{
+public:
+  Writer(uint8_t *target, size_t capacity) : data(target), length(0), capacity(capacity), owned(false) {}
+
+  ~Writer()
+  {
+    if (owned)
+    {
+      free(data);
+    }
+  }
+
+  bool Reserve(size_t n)
+  {
+    if (length + n <= capacity)
+    {
+      return true;
+    }
+    size_t grown = capacity * 2 > length + n ? capacity * 2 : length + n;
+    grown = grown > kMinCapacity ? grown : kMinCapacity;
+    uint8_t *p;
+    if (owned)
+    {
+      p = static_cast<uint8_t *>(realloc(data, grown));
+    }
+    else
+    {
+      p = static_cast<uint8_t *>(malloc(grown));
+      if (p != NULL)
+      {
+        memcpy(p, data, length);
+      }
+    }
+    if (p == NULL)
+    {
+      return false;
+    }
+    data = p;
+    capacity = grown;
+    owned = true;
+    return true;
+  }
+
+  // Reserve() must have been called for the bytes
+  void Put8(uint8_t v)
+  {
+    data[length++] = v;
+  }
+
+  void Put16(uint16_t v)
+  {
+    data[length] = static_cast<uint8_t>(v >> 8);
+    data[length + 1] = static_cast<uint8_t>(v);
+    length += 2;
+  }
+
+  void Put32(uint32_t v)
+  {
+    Put16(static_cast<uint16_t>(v >> 16));
+    Put16(static_cast<uint16_t>(v));
+  }
+
+  void Put64(uint64_t v)
+  {
+    Put32(static_cast<uint32_t>(v >> 32));
+    Put32(static_cast<uint32_t>(v));
+  }
+
+  // The number of bytes written if they fit in the target, otherwise a Buffer that owns them
+  v8::Local<v8::Value> Release()
+  {
+    if (!owned)
+    {
+      return Nan::New<v8::Number>(static_cast<double>(length));
+    }
+    owned = false;
+    return Nan::NewBuffer(reinterpret_cast<char *>(data), static_cast<uint32_t>(length)).ToLocalChecked();
+  }
+
+  uint8_t *data;
+  size_t length;
+  size_t capacity;
+
+private:
+  static const size_t kMinCapacity = 4096;
+  bool owned;
+};
+
+class Encoder
+{
+public:
+  // The target is a Buffer, it gives the prototype of the Buffers
+  Encoder(v8::Local<v8::Object> target, size_t offset, v8::Local<v8::Function> fallback)
+      : out(reinterpret_cast<uint8_t *>(node::Buffer::Data(target)) + offset, node::Buffer::Length(target) - offset),
+        isolate(v8::Isolate::GetCurrent()), context(Nan::GetCurrentContext()), fallback(fallback),
+        objectPrototype(Nan::New<v8::Object>()->GetPrototype()), bufferPrototype(target->GetPrototype())
+  {
+  }
+
+  // Returns false if an exception is pending
+  bool Encode(v8::Local<v8::Value> value, int depth)
+  {
+    if (!out.Reserve(9))
+    {
+      return OutOfMemory();
+    }
+    if (value->IsString())
+    {
+      return EncodeString(value.As<v8::String>());
+    }
+    if (value->IsNumber())
+    {
+      EncodeNumber(value.As<v8::Number>()->Value());
+      return true;
+    }
+    if (value->IsBoolean())
+    {
+      out.Put8(value->IsTrue() ? 0xC3 : 0xC2);
+      return true;
+    }
+    if (value->IsNull())
+    {
+      out.Put8(0xC0);
+      return true;
+    }
+    if (value->IsUndefined())
+    {
+      out.Put8(0xD4);
+      out.Put16(0);
+      return true;
+    }
+    if (depth < kMaxDepth && value->IsObject() && !value->IsProxy())
+    {
+      v8::Local<v8::Object> object = value.As<v8::Object>();
+      if (value->IsArray())
+      {
+        return EncodeArray(value.As<v8::Array>(), depth);
+      }
+      v8::Local<v8::Value> prototype = object->GetPrototype();
+      if (value->IsUint8Array() && prototype->StrictEquals(bufferPrototype))
+      {
+        return EncodeBuffer(object);
+      }
+      if ((prototype->StrictEquals(objectPrototype) || prototype->IsNull()) && !value->IsArgumentsObject() &&
+          !value->IsModuleNamespaceObject())
+      {
+        // is.plainObject() also checks the tag
+        v8::Local<v8::Value> tag;
+        if (!object->Get(context, v8::Symbol::GetToStringTag(isolate)).ToLocal(&tag))
+        {
+          return false;
+        }
+        if (tag->IsUndefined())
+        {
+          return EncodeMap(object, depth);
+        }
+      }
+    }
+    return EncodeFallback(value);
+  }
+
+  // Writes a frame of the value: the size of the rest of the frame (uint32 BE), the value, the flags
+  // (uint8) and the id (varint32)
+  bool EncodeFrame(v8::Local<v8::Value> value, uint8_t flags, uint32_t id)
+  {
+    size_t start = out.length;
+    if (!out.Reserve(4))
+    {
+      return OutOfMemory();
+    }
+    out.length += 4;
+    if (!Encode(value, 0))
+    {
+      return false;
+    }
+    if (!out.Reserve(6))
+    {
+      return OutOfMemory();
+    }
+    out.Put8(flags);
+    while (id >= 0x80)
+    {
+      out.Put8(static_cast<uint8_t>(id | 0x80));
+      id >>= 7;
+    }
+    out.Put8(static_cast<uint8_t>(id));
+    size_t size = out.length - start - 4;
+    if (size > 0xFFFFFFFF)
+    {
+      Nan::ThrowRangeError("Frame too large");
+      return false;
+    }
+    size_t end = out.length;
+    out.length = start;
+    out.Put32(static_cast<uint32_t>(size));
+    out.length = end;
+    return true;
+  }
+
+  Writer out;
+
+private:
+  bool OutOfMemory()
+  {
+    Nan::ThrowRangeError("Out of memory");
+    return false;
+  }
+
+  // Integers in the range of int32 are written as integers, everything else as doubles
+  void EncodeNumber(double d)
+  {
+    if (!(d >= -2147483648.0 && d <= 2147483647.0) || d != static_cast<double>(static_cast<int32_t>(d)))
+    {
+      out.Put8(0xCB);
+      uint64_t bits;
+      memcpy(&bits, &d, sizeof(bits));
+      out.Put64(bits);
+      return;
+    }
+    int32_t x = static_cast<int32_t>(d);
+    if (x >= 0)
+    {
+      if (x < 128)
+      {
+        out.Put8(static_cast<uint8_t>(x));
+      }
+      else if (x < 256)
+      {
+        out.Put8(0xCC);
+        out.Put8(static_cast<uint8_t>(x));
+      }
+      else if (x < 65536)
+      {
+        out.Put8(0xCD);
+        out.Put16(static_cast<uint16_t>(x));
+      }
+      else
+      {
+        out.Put8(0xCE);
+        out.Put32(static_cast<uint32_t>(x));
+      }
+    }
+    else if (x >= -32)
+    {
+      out.Put8(static_cast<uint8_t>(0x100 + x));
+    }
+    else if (x >= -128)
+    {
+      out.Put8(0xD0);
+      out.Put8(static_cast<uint8_t>(x));
+    }
+    else if (x >= -32768)
+    {
+      out.Put8(0xD1);
+      out.Put16(static_cast<uint16_t>(x));
+    }
+    else if (x > -214748365)
+    {
+      out.Put8(0xD2);
+      out.Put32(static_cast<uint32_t>(x));
+    }
+    else
+    {
+      out.Put8(0xD3);
+      out.Put64(static_cast<uint64_t>(static_cast<int64_t>(x)));
+    }
+  }
+
+  static inline size_t StringHeaderBytes(size_t length)
+  {
+    return length < 32 ? 1 : length <= 0xFF ? 2 : length <= 0xFFFF ? 3 : 5;
+  }
+
+  bool EncodeString(v8::Local<v8::String> str)
+  {
+    size_t chars = str->Length();
+    // a character takes 1 to 3 bytes, the header only has to be computed first when the bounds
+    // need different headers
+    size_t max = chars * (str->IsOneByte() ? 2 : 3);
+    size_t header = StringHeaderBytes(max);
+    if (header != StringHeaderBytes(chars))
+    {
+      max = str->Utf8Length(isolate);
+      header = StringHeaderBytes(max);
+    }
+    if (!out.Reserve(header + max))
+    {
+      return OutOfMemory();
+    }
+    size_t start = out.length;
+    int written = str->WriteUtf8(isolate, reinterpret_cast<char *>(out.data + start + header), static_cast<int>(max),
+                                 NULL, v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8);
+    size_t length = static_cast<size_t>(written);
+    if (header == 1)
+    {
+      out.Put8(static_cast<uint8_t>(0xA0 | length));
+    }
+    else if (header == 2)
+    {
+      out.Put8(0xD9);
+      out.Put8(static_cast<uint8_t>(length));
+    }
+    else if (header == 3)
+    {
+      out.Put8(0xDA);
+      out.Put16(static_cast<uint16_t>(length));
+    }
+    else
+    {
+      out.Put8(0xDB);
+      out.Put32(static_cast<uint32_t>(length));
+    }
+    out.length += length;
+    return true;
+  }
+
+  bool EncodeBuffer(v8::Local<v8::Object> buffer)
+  {
+    const uint8_t *data = reinterpret_cast<const uint8_t *>(node::Buffer::Data(buffer));
+    size_t length = node::Buffer::Length(buffer);
+    if (!out.Reserve(5 + length))
+    {
+      return OutOfMemory();
+    }
+    if (length <= 0xFF)
+    {
+      out.Put8(0xC4);
+      out.Put8(static_cast<uint8_t>(length));
+    }
+    else if (length <= 0xFFFF)
+    {
+      out.Put8(0xC5);
+      out.Put16(static_cast<uint16_t>(length));
+    }
+    else
+    {
+      out.Put8(0xC6);
+      out.Put32(static_cast<uint32_t>(length));
+    }
+    memcpy(out.data + out.length, data, length);
+    out.length += length;
+    return true;
+  }
+
+  bool EncodeArray(v8::Local<v8::Array> array, int depth)
+  {
+    uint32_t length = array->Length();
+    if (length < 16)
+    {
+      out.Put8(static_cast<uint8_t>(0x90 | length));
+    }
+    else if (length < 65536)
+    {
+      out.Put8(0xDC);
+      out.Put16(static_cast<uint16_t>(length));
+    }
+    else
+    {
+      out.Put8(0xDD);
+      out.Put32(length);
+    }
+    for (uint32_t chunk = 0; chunk < length; chunk += kScopeChunk)
+    {
+      // the handles are released by chunks, a scope for every element costs more
+      Nan::HandleScope scope;
+      uint32_t last = length - chunk > kScopeChunk ? chunk + kScopeChunk : length;
+      for (uint32_t i = chunk; i < last; i++)
+      {
+        v8::Local<v8::Value> element;
+        if (!array->Get(context, i).ToLocal(&element) || !Encode(element, depth + 1))
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // Own enumerable string keys in the order of Object.keys()
+  bool EncodeMap(v8::Local<v8::Object> object, int depth)
+  {
+    v8::Local<v8::Array> keys;
+    if (!object
+             ->GetOwnPropertyNames(context,
+                                   static_cast<v8::PropertyFilter>(v8::ONLY_ENUMERABLE | v8::SKIP_SYMBOLS),
+                                   v8::KeyConversionMode::kConvertToString)
+             .ToLocal(&keys))
+    {
+      return false;
+    }
+    uint32_t length = keys->Length();
+    if (length < 16)
+    {
+      out.Put8(static_cast<uint8_t>(0x80 | length));
+    }
+    else
+    {
+      out.Put8(0xDE);
+      out.Put16(static_cast<uint16_t>(length));
+    }
+    for (uint32_t chunk = 0; chunk < length; chunk += kScopeChunk)
+    {
+      Nan::HandleScope scope;
+      uint32_t last = length - chunk > kScopeChunk ? chunk + kScopeChunk : length;
+      for (uint32_t i = chunk; i < last; i++)
+      {
+        v8::Local<v8::Value> key;
+        v8::Local<v8::Value> element;
+        if (!keys->Get(context, i).ToLocal(&key) || !EncodeString(key.As<v8::String>()) ||
+            !object->Get(context, key).ToLocal(&element) || !Encode(element, depth + 1))
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // The fallback returns the encoding of the value as a Buffer
+  bool EncodeFallback(v8::Local<v8::Value> value)
+  {
+    v8::Local<v8::Value> result;
+    if (!Nan::Call(fallback, Nan::Undefined().As<v8::Object>(), 1, &value).ToLocal(&result))
+    {
+      return false;
+    }
+    if (!node::Buffer::HasInstance(result))
+    {
+      Nan::ThrowTypeError("The mpak fallback must return a Buffer");
+      return false;
+    }
+    size_t length = node::Buffer::Length(result);
+    if (!out.Reserve(length))
+    {
+      return OutOfMemory();
+    }
+    memcpy(out.data + out.length, node::Buffer::Data(result), length);
+    out.length += length;
+    return true;
+  }
+
+  v8::Isolate *isolate;
+  v8::Local<v8::Context> context;
+  v8::Local<v8::Function> fallback;
+  v8::Local<v8::Value> objectPrototype;
+  v8::Local<v8::Value> bufferPrototype;
+};
+
+// mpakEncode(value, fallback, target, offset), writes the encoding to the target Buffer at the offset.
+// fallback(value) returns the encoding of the values the addon does not handle. Returns the number of
+// bytes written, or a Buffer with the encoding if it does not fit in the target.
+NAN_METHOD(MpakEncode)
+{
+  if (!info[1]->IsFunction() || !node::Buffer::HasInstance(info[2]))
+  {
+    return Nan::ThrowTypeError("Invalid arguments");
+  }
+  v8::Local<v8::Object> target = info[2].As<v8::Object>();
+  double offset = Nan::To<double>(info[3]).FromJust();
+  if (!(offset >= 0 && offset <= static_cast<double>(node::Buffer::Length(target))))
+  {
+    return Nan::ThrowRangeError("Invalid offset");
+  }
+  Encoder encoder(target, static_cast<size_t>(offset), info[1].As<v8::Function>());
+  {
+    ADONE_TRACE_SCOPE("data", "mpak:encode");
+    if (!encoder.Encode(info[0], 0))
+    {
+      return;
+    }
+  }
+  info.GetReturnValue().Set(encoder.out.Release());
+}
+
+// mpakEncodeFrame(value, flags, id, fallback, target, offset), writes a frame of the value to the target
+// Buffer at the offset, the value is followed by the flags and the id. Returns what mpakEncode() returns.
+NAN_METHOD(MpakEncodeFrame)
+{
+  if (!info[3]->IsFunction() || !node::Buffer::HasInstance(info[4]))
+  {
+    return Nan::ThrowTypeError("Invalid arguments");
+  }
+  v8::Local<v8::Object> target = info[4].As<v8::Object>();
+  double offset = Nan::To<double>(info[5]).FromJust();
+  if (!(offset >= 0 && offset <= static_cast<double>(node::Buffer::Length(target))))
+  {
+    return Nan::ThrowRangeError("Invalid offset");
+  }
+  uint32_t flags = Nan::To<uint32_t>(info[1]).FromJust();
+  uint32_t id = Nan::To<uint32_t>(info[2]).FromJust();
+  Encoder encoder(target, static_cast<size_t>(offset), info[3].As<v8::Function>());
+  {
+    ADONE_TRACE_SCOPE("data", "mpak:encodeFrame");
+    if (!encoder.EncodeFrame(info[0], static_cast<uint8_t>(flags), id))
+    {
+      return;
+    }
+  }
+  info.GetReturnValue().Set(encoder.out.Release());
+}
+
+class Decoder
+{
+public:
+  enum Status
+  {
+    kOk,
+    kIncomplete,
+    kError
+  };
+
+  Decoder(v8::Local<v8::Object> source, size_t start, size_t end, v8::Local<v8::Function> fallback, bool undefinedExt)
+      : pos(start), isolate(v8::Isolate::GetCurrent()), context(Nan::GetCurrentContext()), source(source),
+        fallback(fallback), data(reinterpret_cast<const uint8_t *>(node::Buffer::Data(source))), end(end),
+        undefinedExt(undefinedExt)
+  {
+  }
+
+  Status Decode(v8::Local<v8::Value> *value, int depth, bool key)
+  {
+    if (pos >= end)
+    {
+      return kIncomplete;
+    }
+    size_t start = pos;
+    uint8_t first = data[pos++];
+    if (first < 0x80)
+    {
+      *value = Nan::New<v8::Integer>(first);
+      return kOk;
+    }
+    if (first >= 0xE0)
+    {
+      *value = Nan::New<v8::Integer>(static_cast<int32_t>(first) - 0x100);
+      return kOk;
+    }
+    if (first <= 0x8F)
+    {
+      return depth < kMaxDepth ? DecodeMap(value, first & 0x0F, depth) : Fallback(value, start);
+    }
+    if (first <= 0x9F)
+    {
+      return depth < kMaxDepth ? DecodeArray(value, first & 0x0F, depth) : Fallback(value, start);
+    }
+    if (first <= 0xBF)
+    {
+      return DecodeString(value, first & 0x1F, key);
+    }
+    uint32_t length;
+    switch (first)
+    {
+    case 0xC0:
+      *value = Nan::Null();
+      return kOk;
+    case 0xC2:
+      *value = Nan::False();
+      return kOk;
+    case 0xC3:
+      *value = Nan::True();
+      return kOk;
+    case 0xC4:
+    case 0xC5:
+    case 0xC6:
+      if (!ReadLength(first - 0xC4, &length))
+      {
+        return kIncomplete;
+      }
+      return DecodeBin(value, length);
+    case 0xCA:
+      if (end - pos < 4)
+      {
+        return kIncomplete;
+      }
+      {
+        uint32_t bits = Read32();
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        *value = Nan::New<v8::Number>(f);
+      }
+      return kOk;
+    case 0xCB:
+      if (end - pos < 8)
+      {
+        return kIncomplete;
+      }
+      {
+        uint64_t bits = Read64();
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        *value = Nan::New<v8::Number>(d);
+      }
+      return kOk;
+    case 0xCC:
+    case 0xCD:
+    case 0xCE:
+      if (!ReadLength(first - 0xCC, &length))
+      {
+        return kIncomplete;
+      }
+      *value = Nan::New<v8::Number>(length);
+      return kOk;
+    case 0xCF:
+      if (end - pos < 8)
+      {
+        return kIncomplete;
+      }
+      *value = Nan::New<v8::Number>(static_cast<double>(Read64()));
+      return kOk;
+    case 0xD0:
+      if (end - pos < 1)
+      {
+        return kIncomplete;
+      }
+      *value = Nan::New<v8::Integer>(static_cast<int8_t>(data[pos++]));
+      return kOk;
+    case 0xD1:
+      if (end - pos < 2)
+      {
+        return kIncomplete;
+      }
+      *value = Nan::New<v8::Integer>(static_cast<int16_t>(Read16()));
+      return kOk;
+    case 0xD2:
+      if (end - pos < 4)
+      {
+        return kIncomplete;
+      }
+      *value = Nan::New<v8::Integer>(static_cast<int32_t>(Read32()));
+      return kOk;
+    case 0xD4:
+      // fixext 1 of type 0 with 0 is undefined, unless a type 0 is registered
+      if (undefinedExt && end - pos >= 2 && data[pos] == 0 && data[pos + 1] == 0)
+      {
+        pos += 2;
+        *value = Nan::Undefined();
+        return kOk;
+      }
+      return Fallback(value, start);
+    case 0xD9:
+    case 0xDA:
+    case 0xDB:
+      if (!ReadLength(first - 0xD9, &length))
+      {
+        return kIncomplete;
+      }
+      return DecodeString(value, length, key);
+    case 0xDC:
+    case 0xDD:
+      if (!ReadLength(first - 0xDC + 1, &length))
+      {
+        return kIncomplete;
+      }
+      return depth < kMaxDepth ? DecodeArray(value, length, depth) : Fallback(value, start);
+    case 0xDE:
+      if (!ReadLength(1, &length))
+      {
+        return kIncomplete;
+      }
+      return depth < kMaxDepth ? DecodeMap(value, length, depth) : Fallback(value, start);
+    default:
+      // 64-bit signed integers, extensions and the types mpak.js does not decode
+      return Fallback(value, start);
+    }
+  }
+
+  // Decodes the frame at pos that ends at `frameEnd` (see Encoder::EncodeFrame). kIncomplete if the
+  // value, the flags and the id do not fill the frame exactly.
+  Status DecodeFrame(size_t frameEnd, v8::Local<v8::Value> *value, uint32_t *flags, int32_t *id)
+  {
+    end = frameEnd;
+    Status status = Decode(value, 0, false);
+    if (status != kOk)
+    {
+      return status;
+    }
+    if (pos == end)
+    {
+      return kIncomplete;
+    }
+    *flags = data[pos++];
+    // as SmartBuffer.readVarint32() reads it, the bits after the 32nd are dropped
+    uint32_t v = 0;
+    for (int c = 0;; c++)
+    {
+      if (pos == end)
+      {
+        return kIncomplete;
+      }
+      uint8_t b = data[pos++];
+      if (c < 5)
+      {
+        v |= static_cast<uint32_t>(b & 0x7F) << (7 * c);
+      }
+      if ((b & 0x80) == 0)
+      {
+        break;
+      }
+    }
+    *id = static_cast<int32_t>(v);
+    return pos == end ? kOk : kIncomplete;
+  }
+
+  size_t pos;
+
+private:
+  uint16_t Read16()
+  {
+    uint16_t v = static_cast<uint16_t>((data[pos] << 8) | data[pos + 1]);
+    pos += 2;
+    return v;
+  }
+
+  uint32_t Read32()
+  {
+    uint32_t v = (static_cast<uint32_t>(data[pos]) << 24) | (static_cast<uint32_t>(data[pos + 1]) << 16) |
+                 (static_cast<uint32_t>(data[pos + 2]) << 8) | data[pos + 3];
+    pos += 4;
+    return v;
+  }
+
+  uint64_t Read64()
+  {
+    uint64_t high = Read32();
+    return (high << 32) | Read32();
+  }
+
+  // A length of 1, 2 or 4 bytes for the sizes 0, 1 and 2
+  bool ReadLength(int size, uint32_t *length)
+  {
+    size_t bytes = static_cast<size_t>(1) << size;
+    if (end - pos < bytes)
+    {
+      return false;
+    }
+    *length = size == 0 ? data[pos++] : size == 1 ? Read16() : Read32();
+    return true;
+  }
+
+  Status DecodeString(v8::Local<v8::Value> *value, uint32_t length, bool key)
+  {
+    if (end - pos < length)
+    {
+      return kIncomplete;
+    }
+    // the keys of the maps are internalized, as the property names of the code are
+    v8::Local<v8::String> str;
+    if (!v8::String::NewFromUtf8(isolate, reinterpret_cast<const char *>(data + pos),
+                                 key ? v8::NewStringType::kInternalized : v8::NewStringType::kNormal,
+                                 static_cast<int>(length))
+             .ToLocal(&str))
+    {
+      Nan::ThrowRangeError("Invalid string length");
+      return kError;
+    }
+    pos += length;
+    *value = str;
+    return kOk;
+  }
+
+  // A view of the source, the bytes are not copied
+  Status DecodeBin(v8::Local<v8::Value> *value, uint32_t length)
+  {
+    if (end - pos < length)
+    {
+      return kIncomplete;
+    }
+    v8::Local<v8::ArrayBufferView> view = source.As<v8::ArrayBufferView>();
+    *value = node::Buffer::New(isolate, view->Buffer(), view->ByteOffset() + pos, length).ToLocalChecked();
+    pos += length;
+    return kOk;
+  }
+
+  Status DecodeArray(v8::Local<v8::Value> *value, uint32_t length, int depth)
+  {
+    // every element takes a byte at least
+    if (end - pos < length)
+    {
+      return kIncomplete;
+    }
+    // the array is created from the elements, it is faster than setting them one by one
+    std::vector<v8::Local<v8::Value> > elements(length);
+    for (uint32_t i = 0; i < length; i++)
+    {
+      Status status = Decode(&elements[i], depth + 1, false);
+      if (status != kOk)
+      {
+        return status;
+      }
+    }
+    *value = v8::Array::New(isolate, elements.data(), length);
+    return kOk;
+  }
+
+  Status DecodeMap(v8::Local<v8::Value> *value, uint32_t length, int depth)
+  {
+    if ((end - pos) / 2 < length)
+    {
+      return kIncomplete;
+    }
+    v8::Local<v8::Object> object = Nan::New<v8::Object>();
+    for (uint32_t i = 0; i < length; i++)
+    {
+      v8::Local<v8::Value> key;
+      v8::Local<v8::Value> element;
+      Status status = Decode(&key, depth + 1, true);
+      if (status == kOk)
+      {
+        status = Decode(&element, depth + 1, false);
+      }
+      if (status != kOk)
+      {
+        return status;
+      }
+      // an assignment as in JavaScript, any value is converted to a property key
+      if (object->Set(context, key, element).IsNothing())
+      {
+        return kError;
+      }
+    }
+    *value = object;
+    return kOk;
+  }
+
+  // The fallback decodes the value at the offset, it returns the result of tryDecode()
+  Status Fallback(v8::Local<v8::Value> *value, size_t start)
+  {
+    v8::Local<v8::Value> argv[] = {source, Nan::New<v8::Number>(static_cast<double>(start)),
+                                   Nan::New<v8::Number>(static_cast<double>(end))};
+    v8::Local<v8::Value> result;
+    if (!Nan::Call(fallback, Nan::Undefined().As<v8::Object>(), 3, argv).ToLocal(&result))
+    {
+      return kError;
+    }
+    if (!result->IsObject())
+    {
+      return kIncomplete;
+    }
+    v8::Local<v8::Object> object = result.As<v8::Object>();
+    v8::Local<v8::Value> consumed;
+    if (!object->Get(context, NanStr("value")).ToLocal(value) ||
+        !object->Get(context, NanStr("bytesConsumed")).ToLocal(&consumed))
+    {
+      return kError;
+    }
+    pos = start + static_cast<size_t>(Nan::To<double>(consumed).FromJust());
+    return kOk;
+  }
+
+  v8::Isolate *isolate;
+  v8::Local<v8::Context> context;
+  v8::Local<v8::Object> source;
+  v8::Local<v8::Function> fallback;
+  const uint8_t *data;
+  size_t end;
+  bool undefinedExt;
+};
+
+// mpakDecode(bytes, start, end, state, fallback, undefinedExt), decodes the value at start. Sets state[0]
+// to the number of bytes consumed, 0 if the value is incomplete. fallback(bytes, offset, end) decodes the
+// values the addon does not handle. undefinedExt is false if a type 0 is registered, the undefined
+// extension is passed to the fallback then.
+NAN_METHOD(MpakDecode)
+{
+  const uint8_t *data;
+  size_t length;
+  if (!GetBytes(info[0], &data, &length))
+  {
+    return Nan::ThrowTypeError("Input must be a Buffer or an Uint8Array");
+  }
+  if (!info[3]->IsFloat64Array() || !info[4]->IsFunction())
+  {
+    return Nan::ThrowTypeError("Invalid arguments");
+  }
+  double start = Nan::To<double>(info[1]).FromJust();
+  double end = Nan::To<double>(info[2]).FromJust();
+  if (!(start >= 0 && start <= end && end <= static_cast<double>(length)))
+  {
+    return Nan::ThrowRangeError("Invalid range");
+  }
+  Nan::TypedArrayContents<double> state(info[3]);
+  if (state.length() < 1)
+  {
+    return Nan::ThrowTypeError("Invalid arguments");
+  }
+  Decoder decoder(info[0].As<v8::Object>(), static_cast<size_t>(start), static_cast<size_t>(end),
+                  info[4].As<v8::Function>(), info[5]->IsTrue());
+  v8::Local<v8::Value> value = Nan::Undefined();
+  Decoder::Status status;
+  {
+    ADONE_TRACE_SCOPE("data", "mpak:decode");
+    status = decoder.Decode(&value, 0, false);
+  }
+  if (status == Decoder::kError)
+  {
+    return;
+  }
+  // the fallbacks may have run the decoder on the same state, it is set last
+  (*state)[0] = status == Decoder::kOk ? static_cast<double>(decoder.pos - static_cast<size_t>(start)) : 0;
+  info.GetReturnValue().Set(value);
+}
+
+// mpakDecodeFrames(bytes, start, end, state, fallback, undefinedExt, frames), decodes the complete frames
+// from start and appends the flags, the id and the value of each to the frames array. Sets state[0] to the
+// number of bytes of the frames decoded, and state[1] to 1 if it stopped at a frame that is not valid.
+NAN_METHOD(MpakDecodeFrames)
+{
+  const uint8_t *data;
+  size_t length;
+  if (!GetBytes(info[0], &data, &length))
+  {
+    return Nan::ThrowTypeError("Input must be a Buffer or an Uint8Array");
+  }
+  if (!info[3]->IsFloat64Array() || !info[4]->IsFunction() || !info[6]->IsArray())
+  {
+    return Nan::ThrowTypeError("Invalid arguments");
+  }
+  double start = Nan::To<double>(info[1]).FromJust();
+  double end = Nan::To<double>(info[2]).FromJust();
+  if (!(start >= 0 && start <= end && end <= static_cast<double>(length)))
+  {
+    return Nan::ThrowRangeError("Invalid range");
+  }
+  Nan::TypedArrayContents<double> state(info[3]);
+  if (state.length() < 2)
+  {
+    return Nan::ThrowTypeError("Invalid arguments");
+  }
+  v8::Local<v8::Array> frames = info[6].As<v8::Array>();
+  uint32_t index = frames->Length();
+  size_t pos = static_cast<size_t>(start);
+  size_t last = static_cast<size_t>(end);
+  bool valid = true;
+  Decoder decoder(info[0].As<v8::Object>(), pos, last, info[4].As<v8::Function>(), info[5]->IsTrue());
+  {
+    ADONE_TRACE_SCOPE("data", "mpak:decodeFrames");
+    while (last - pos >= 4)
+    {
+      size_t size = (static_cast<uint32_t>(data[pos]) << 24) | (static_cast<uint32_t>(data[pos + 1]) << 16) |
+                    (static_cast<uint32_t>(data[pos + 2]) << 8) | data[pos + 3];
+      if (last - pos - 4 < size)
+      {
+        break;
+      }
+      Nan::HandleScope scope;
+      v8::Local<v8::Value> value = Nan::Undefined();
+      uint32_t flags;
+      int32_t id;
+      decoder.pos = pos + 4;
+      Decoder::Status status = decoder.DecodeFrame(pos + 4 + size, &value, &flags, &id);
+      if (status == Decoder::kError)
+      {
+        return;
+      }
+      if (status == Decoder::kIncomplete)
+      {
+        valid = false;
+        break;
+      }
+      Nan::Set(frames, index++, Nan::New<v8::Uint32>(flags));
+      Nan::Set(frames, index++, Nan::New<v8::Int32>(id));
+      Nan::Set(frames, index++, value);
+      pos += 4 + size;
+    }
+  }
+  // the fallbacks may have run the decoder on the same state, it is set last
+  (*state)[0] = static_cast<double>(pos - static_cast<size_t>(start));
+  (*state)[1] = valid ? 0 : 1;
+}
+
+NAN_MODULE_INIT(InitMpak)
+{
+  Nan::SetMethod(target, "mpakEncode", MpakEncode);
+  Nan::SetMethod(target, "mpakDecode", MpakDecode);
+  Nan::SetMethod(target, "mpakEncodeFrame", MpakEncodeFrame);
+  Nan::SetMethod(target, "mpakDecodeFrames", MpakDecodeFrames);
+}
+
+} // namespace nodedata
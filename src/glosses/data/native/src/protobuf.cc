@@ -0,0 +1,1572 @@
+#include "data.h"
+#include "protobuf/wire.h"
+
+#include <adone_trace.h>
+
+#include <deque>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace nodedata
+{
+namespace protobuf
+{
+
+// Table-driven codec of data/protobuf.
+//
+// compile/native.js describes the messages of a schema in a table of integers, the codec interprets
+// it. Encoding and decoding give the same results as the compiled JavaScript functions, including
+// the key order of the decoded objects and the defaults; the input these do not handle the usual way
+// (truncated or malformed messages, values of unexpected types, oneof conflicts) makes the codec bail
+// out, the JavaScript code runs then and gives its own result or error.
+
+enum Type
+{
+  kTypeBytes = 0,
+  kTypeString = 1,
+  kTypeBool = 2,
+  kTypeInt32 = 3,
+  kTypeInt64 = 4,
+  kTypeSint = 5,
+  kTypeUint = 6,
+  kTypeFixed64 = 7,
+  kTypeDouble = 8,
+  kTypeFixed32 = 9,
+  kTypeSfixed32 = 10,
+  kTypeFloat = 11,
+  kTypeEnum = 12,
+  kTypeMessage = 13
+};
+
+enum Flags
+{
+  kFlagRepeated = 1,
+  kFlagPacked = 2,
+  kFlagMap = 4,
+  kFlagRequired = 8
+};
+
+static const int kDefaultArray = -1;
+static const int kDefaultObject = -2;
+
+// Nesting deeper than this is left to the JavaScript code
+static const int kMaxDepth = 100;
+// Tags up to this one are looked up in an array
+static const uint32_t kMaxDirectTag = 1024;
+// The words of the tape of the decoder, the messages that take more are left to the JavaScript code
+static const size_t kInitialTapeLength = 4096;
+static const size_t kMaxTapeLength = 1 << 27;
+
+static const double k2Pow32 = 4294967296.0;
+static const double k2Pow63 = 9223372036854775808.0;
+static const double k2Pow64 = 18446744073709551616.0;
+
+struct Field
+{
+  uint32_t name;
+  uint32_t tag;
+  Type type;
+  int flags;
+  int message;
+  int oneof;
+  int def;
+  std::vector<double> enumValues;
+  // the key of the field, and the one of a packed field
+  uint8_t header[5];
+  uint8_t headerLength;
+  uint8_t packedHeader[5];
+  uint8_t packedHeaderLength;
+};
+
+struct Message
+{
+  std::vector<Field> fields;
+  int oneofs;
+
+  // The field of a tag, the last one if several fields have it, -1 if none
+  int Find(uint32_t tag) const
+  {
+    if (tag < direct.size())
+    {
+      return direct[tag];
+    }
+    std::unordered_map<uint32_t, int>::const_iterator it = tags.find(tag);
+    return it == tags.end() ? -1 : it->second;
+  }
+
+  std::vector<int> direct;
+  std::unordered_map<uint32_t, int> tags;
+};
+
+enum Status
+{
+  kOk,
+  // left to the JavaScript code
+  kBail,
+  // an exception is pending
+  kError
+};
+
+inline bool IsInteger(double d)
+{
+  return d == floor(d) && isfinite(d);
+}
+
+// The values that the JavaScript code writes: not null, undefined or NaN
+inline bool IsDefined(v8::Local<v8::Value> value)
+{
+  return !value->IsNullOrUndefined() && !(value->IsNumber() && isnan(value.As<v8::Number>()->Value()));
+}
+
+static uint8_t WireTypeOf(Type type)
+{
+  switch (type)
+  {
+  case kTypeBytes:
+  case kTypeString:
+  case kTypeMessage:
+    return kWireLengthDelimited;
+  case kTypeFixed64:
+  case kTypeDouble:
+    return kWireFixed64;
+  case kTypeFixed32:
+  case kTypeSfixed32:
+  case kTypeFloat:
+    return kWireFixed32;
+  default:
+    return kWireVarint;
+  }
+}
+
+// A field of the message being decoded
+struct Slot
+{
+  Slot() : present(false), defaulted(false), order(0), count(0) {}
+
+  bool present;
+  // gets the default, in place if it is present
+  bool defaulted;
+  // the keys are in the order of the fields in the message
+  uint32_t order;
+  // the number of values, and their words on the tape
+  uint32_t count;
+  std::vector<double> words;
+};
+
+class Schema : public Nan::ObjectWrap
+{
+public:
+  static void Init(v8::Local<v8::Object> target)
+  {
+    v8::Local<v8::FunctionTemplate> tpl = Nan::New<v8::FunctionTemplate>(New);
+    tpl->SetClassName(NanStr("ProtobufSchema"));
+    tpl->InstanceTemplate()->SetInternalFieldCount(1);
+    Nan::SetPrototypeMethod(tpl, "encode", Encode);
+    Nan::SetPrototypeMethod(tpl, "decode", Decode);
+    Nan::SetPrototypeMethod(tpl, "decodeMany", DecodeMany);
+    Nan::SetPrototypeMethod(tpl, "tape", Tape);
+    Nan::Set(target, NanStr("ProtobufSchema"), Nan::GetFunction(tpl).ToLocalChecked());
+  }
+
+  ~Schema()
+  {
+    for (uint32_t i = 0; i < valueCount; i++)
+    {
+      values[i].Reset();
+    }
+    bufferPrototype.Reset();
+    stateArray.Reset();
+    tapeArray.Reset();
+  }
+
+  v8::Local<v8::Value> Value(uint32_t index) const
+  {
+    return Nan::New(values[index]);
+  }
+
+  // Makes room for `count` more words on the tape, returns false if the tape would be too large
+  bool ReserveTape(size_t count)
+  {
+    if (count <= tapeCapacity - tapeLength)
+    {
+      return true;
+    }
+    if (count > kMaxTapeLength - tapeLength)
+    {
+      return false;
+    }
+    size_t capacity = tapeCapacity * 2;
+    capacity = capacity < tapeLength + count ? tapeLength + count : capacity;
+    capacity = capacity > kMaxTapeLength ? kMaxTapeLength : capacity;
+    double *previous = tape;
+    AllocateTape(capacity);
+    memcpy(tape, previous, tapeLength * sizeof(double));
+    state[4] = 1;
+    return true;
+  }
+
+  std::vector<Message> messages;
+  Nan::Persistent<v8::Value> bufferPrototype;
+  // the number of bytes read by decode() and decodeMany(), whether decodeMany() stopped before a
+  // message the JavaScript code has to decode, the offset of the record of the message or of the
+  // offsets of the records of the messages, their number, and whether the tape was replaced
+  double *state;
+  // the records of the decoded messages, described in Decoder
+  double *tape;
+  size_t tapeLength;
+  // the fields of the messages being decoded, the references stay valid when more are added
+  std::deque<Slot> slots;
+  size_t slotsUsed;
+  std::vector<size_t> keys;
+
+private:
+  // Reads the table described in compile/native.js, returns false if it is not valid
+  bool Load(const int32_t *table, size_t length, uint32_t valueCount)
+  {
+    size_t pos = 0;
+    // every message takes an integer and every field 8 at least
+    if (length < 1 || table[0] < 0 || static_cast<size_t>(table[0]) > length)
+    {
+      return false;
+    }
+    messages.resize(table[pos++]);
+    for (size_t i = 0; i < messages.size(); i++)
+    {
+      Message &message = messages[i];
+      if (pos >= length || table[pos] < 0 || static_cast<size_t>(table[pos]) > length / 8)
+      {
+        return false;
+      }
+      message.fields.resize(table[pos++]);
+      message.oneofs = 0;
+      for (size_t j = 0; j < message.fields.size(); j++)
+      {
+        Field &field = message.fields[j];
+        if (length - pos < 8)
+        {
+          return false;
+        }
+        const int32_t *f = table + pos;
+        pos += 8;
+        if (f[0] < 0 || static_cast<uint32_t>(f[0]) >= valueCount || f[1] < 0 || f[1] >= 0x10000000 || f[2] < 0 ||
+            f[2] > kTypeMessage || f[3] < 0 || f[4] < -1 || f[4] >= static_cast<int32_t>(messages.size()) ||
+            f[5] < -1 || f[6] < kDefaultObject || f[6] >= static_cast<int32_t>(valueCount) || f[7] < 0 ||
+            static_cast<size_t>(f[7]) > length - pos)
+        {
+          return false;
+        }
+        field.name = f[0];
+        field.tag = f[1];
+        field.type = static_cast<Type>(f[2]);
+        field.flags = f[3];
+        field.message = f[4];
+        field.oneof = f[5];
+        field.def = f[6];
+        field.enumValues.assign(table + pos, table + pos + f[7]);
+        pos += f[7];
+        if ((field.type == kTypeMessage) != (field.message >= 0))
+        {
+          return false;
+        }
+        if (field.oneof >= message.oneofs)
+        {
+          message.oneofs = field.oneof + 1;
+        }
+        field.headerLength = static_cast<uint8_t>(WriteVarint(field.header, field.tag << 3 | WireTypeOf(field.type)));
+        field.packedHeaderLength =
+            static_cast<uint8_t>(WriteVarint(field.packedHeader, field.tag << 3 | kWireLengthDelimited));
+        if (field.tag < kMaxDirectTag)
+        {
+          if (message.direct.size() <= field.tag)
+          {
+            message.direct.resize(field.tag + 1, -1);
+          }
+          message.direct[field.tag] = static_cast<int>(j);
+        }
+        else
+        {
+          message.tags[field.tag] = static_cast<int>(j);
+        }
+      }
+    }
+    // the entries of maps have a key and a value
+    for (size_t i = 0; i < messages.size(); i++)
+    {
+      for (size_t j = 0; j < messages[i].fields.size(); j++)
+      {
+        const Field &field = messages[i].fields[j];
+        if ((field.flags & kFlagMap) && (field.type != kTypeMessage || messages[field.message].fields.size() != 2))
+        {
+          return false;
+        }
+      }
+    }
+    return pos == length;
+  }
+
+  bool LoadValues(v8::Local<v8::Array> array)
+  {
+    v8::Local<v8::Context> context = Nan::GetCurrentContext();
+    valueCount = array->Length();
+    values.reset(new Nan::Persistent<v8::Value>[valueCount]);
+    for (uint32_t i = 0; i < valueCount; i++)
+    {
+      v8::Local<v8::Value> value;
+      if (!array->Get(context, i).ToLocal(&value))
+      {
+        return false;
+      }
+      values[i].Reset(value);
+    }
+    for (size_t i = 0; i < messages.size(); i++)
+    {
+      for (size_t j = 0; j < messages[i].fields.size(); j++)
+      {
+        if (!Value(messages[i].fields[j].name)->IsString())
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // new ProtobufSchema(table, values, bufferPrototype, state), values has the names and the defaults,
+  // state is a Float64Array of 5 elements
+  static NAN_METHOD(New)
+  {
+    if (!info.IsConstructCall())
+    {
+      return Nan::ThrowTypeError("Class constructor cannot be invoked without 'new'");
+    }
+    if (!info[0]->IsInt32Array() || !info[1]->IsArray() || !info[2]->IsObject() || !info[3]->IsFloat64Array())
+    {
+      return Nan::ThrowTypeError("Invalid arguments");
+    }
+    Nan::TypedArrayContents<int32_t> table(info[0]);
+    Nan::TypedArrayContents<double> state(info[3]);
+    v8::Local<v8::Array> values = info[1].As<v8::Array>();
+    if (state.length() < 5)
+    {
+      return Nan::ThrowTypeError("Invalid arguments");
+    }
+    Schema *schema = new Schema();
+    if (!schema->Load(*table, table.length(), values->Length()) || !schema->LoadValues(values))
+    {
+      delete schema;
+      return Nan::ThrowTypeError("Invalid schema");
+    }
+    schema->bufferPrototype.Reset(info[2]);
+    // the array keeps the memory of the state
+    schema->stateArray.Reset(info[3]);
+    schema->state = *state;
+    schema->AllocateTape(kInitialTapeLength);
+    schema->Wrap(info.This());
+    info.GetReturnValue().Set(info.This());
+  }
+
+  static NAN_METHOD(Encode);
+  static NAN_METHOD(Decode);
+  static NAN_METHOD(DecodeMany);
+
+  // tape(), the Float64Array the decoder writes the records to
+  static NAN_METHOD(Tape)
+  {
+    Schema *schema = Nan::ObjectWrap::Unwrap<Schema>(info.Holder());
+    info.GetReturnValue().Set(Nan::New(schema->tapeArray));
+  }
+
+  Schema() : state(NULL), tape(NULL), tapeLength(0), slotsUsed(0), tapeCapacity(0), valueCount(0) {}
+
+  void AllocateTape(size_t capacity)
+  {
+    v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(v8::Isolate::GetCurrent(), capacity * sizeof(double));
+    v8::Local<v8::Float64Array> array = v8::Float64Array::New(buffer, 0, capacity);
+    tapeArray.Reset(array);
+    tape = *Nan::TypedArrayContents<double>(array);
+    tapeCapacity = capacity;
+  }
+
+  Nan::Persistent<v8::Value> stateArray;
+  Nan::Persistent<v8::Value> tapeArray;
+  size_t tapeCapacity;
+  std::unique_ptr<Nan::Persistent<v8::Value>[]> values;
+  uint32_t valueCount;
+};
+
+// Parses the messages into records on the tape of the schema, compile/native.js builds the objects
+// from them. A record is the number of keys of the object, then for every key in the order the
+// JavaScript decoder sets them the index of the field and its value, or -1 - index for a default.
+//
+// A value takes one word: the number, 0 or 1 for booleans, the index of the string in the strings,
+// the offset of the record of a message. Bytes take the start and the end of their slice. Repeated
+// fields and maps take the number of values first, the entries of maps are the records of their
+// messages.
+class Decoder
+{
+public:
+  Decoder(Schema &schema, const uint8_t *data, size_t length) : data(data), length(length), schema(schema) {}
+
+  // Parses the message in [start, end), sets *record to the offset of its record
+  Status Decode(const Message &message, size_t start, size_t end, size_t *record, int depth)
+  {
+    if (depth > kMaxDepth)
+    {
+      return kBail;
+    }
+    Slots slots(schema, message.fields.size());
+    size_t pos = start;
+    Status status = Parse(message, &pos, end, slots, depth);
+    if (status != kOk || (status = Finish(message, slots)) != kOk)
+    {
+      return status;
+    }
+    return Emit(message, slots, record);
+  }
+
+  const uint8_t *data;
+  size_t length;
+  std::vector<v8::Local<v8::Value> > strings;
+
+private:
+  // The slots of a message, taken from the ones of the schema: a nested message takes the ones after
+  // its parent's, they keep the memory of their words from a message to the next
+  class Slots
+  {
+  public:
+    Slots(Schema &schema, size_t count) : schema(schema), base(schema.slotsUsed), count(count)
+    {
+      schema.slotsUsed += count;
+      while (schema.slots.size() < schema.slotsUsed)
+      {
+        schema.slots.emplace_back();
+      }
+      for (size_t i = 0; i < count; i++)
+      {
+        Slot &slot = (*this)[i];
+        slot.present = false;
+        slot.defaulted = false;
+      }
+    }
+
+    ~Slots()
+    {
+      schema.slotsUsed = base;
+    }
+
+    Slot &operator[](size_t i)
+    {
+      return schema.slots[base + i];
+    }
+
+    size_t size() const
+    {
+      return count;
+    }
+
+  private:
+    Schema &schema;
+    size_t base;
+    size_t count;
+  };
+
+  Status Parse(const Message &message, size_t *pos, size_t end, Slots &slots, int depth)
+  {
+    uint32_t order = 0;
+    while (*pos < end)
+    {
+      double prefix;
+      size_t n = ReadVarint(data + *pos, end - *pos, kMaxVarintBytes, &prefix);
+      if (n == 0 || prefix > 2147483647.0)
+      {
+        return kBail;
+      }
+      *pos += n;
+      uint32_t key = static_cast<uint32_t>(prefix);
+      int index = message.Find(key >> 3);
+      if (index < 0)
+      {
+        if (!SkipField(data + *pos, end - *pos, key & 7, &n))
+        {
+          return kBail;
+        }
+        *pos += n;
+        continue;
+      }
+      const Field &field = message.fields[index];
+      Status status;
+      if (field.flags & kFlagPacked)
+      {
+        double packedLength;
+        n = ReadVarint(data + *pos, end - *pos, kMaxVarintBytes, &packedLength);
+        if (n == 0 || !(packedLength <= static_cast<double>(end - *pos - n)))
+        {
+          return kBail;
+        }
+        *pos += n;
+        size_t packedEnd = *pos + static_cast<size_t>(packedLength);
+        while (*pos < packedEnd)
+        {
+          if ((status = ParseField(message, index, pos, packedEnd, slots, &order, depth)) != kOk)
+          {
+            return status;
+          }
+        }
+      }
+      else if ((status = ParseField(message, index, pos, end, slots, &order, depth)) != kOk)
+      {
+        return status;
+      }
+    }
+    return kOk;
+  }
+
+  Status ParseField(const Message &message, int index, size_t *pos, size_t end, Slots &slots, uint32_t *order,
+                    int depth)
+  {
+    const Field &field = message.fields[index];
+    if (field.oneof >= 0)
+    {
+      // a oneof field removes the one that was set
+      for (size_t i = 0; i < slots.size(); i++)
+      {
+        if (message.fields[i].oneof >= 0)
+        {
+          slots[i].present = false;
+        }
+      }
+    }
+    Slot &slot = slots[index];
+    if (!slot.present)
+    {
+      slot.present = true;
+      slot.order = ++*order;
+      slot.count = 0;
+      slot.words.clear();
+    }
+    else if (!(field.flags & (kFlagRepeated | kFlagMap)))
+    {
+      // the last value is kept
+      slot.count = 0;
+      slot.words.clear();
+    }
+    slot.count++;
+
+    if (field.type != kTypeMessage)
+    {
+      return ReadScalar(field, pos, end, &slot.words);
+    }
+    double messageLength;
+    size_t n = ReadVarint(data + *pos, end - *pos, kMaxVarintBytes, &messageLength);
+    if (n == 0 || !(messageLength <= static_cast<double>(end - *pos - n)))
+    {
+      return kBail;
+    }
+    *pos += n;
+    size_t start = *pos;
+    *pos += static_cast<size_t>(messageLength);
+    size_t record;
+    // the entries of maps are messages too, the builder sets their keys and values
+    Status status = Decode(schema.messages[field.message], start, *pos, &record, depth + 1);
+    if (status != kOk)
+    {
+      return status;
+    }
+    // the slot may have moved
+    slots[index].words.push_back(static_cast<double>(record));
+    return kOk;
+  }
+
+  Status ReadScalar(const Field &field, size_t *pos, size_t end, std::vector<double> *words)
+  {
+    const uint8_t *in = data + *pos;
+    size_t available = end - *pos;
+    double v;
+    size_t n = 0;
+    switch (field.type)
+    {
+    case kTypeBool:
+      if (available < 1)
+      {
+        return kBail;
+      }
+      words->push_back(in[0] > 0 ? 1 : 0);
+      *pos += 1;
+      return kOk;
+    case kTypeInt32:
+    case kTypeSint:
+    case kTypeUint:
+    case kTypeEnum:
+      if ((n = ReadVarint(in, available, kMaxVarintBytes, &v)) == 0)
+      {
+        return kBail;
+      }
+      if (field.type == kTypeInt32)
+      {
+        v = v > 2147483647.0 ? v - k2Pow32 : v;
+      }
+      else if (field.type == kTypeSint)
+      {
+        // v & 1 in JavaScript, the doubles above 2^53 are even
+        bool odd = v < 9007199254740992.0 && (static_cast<uint64_t>(v) & 1);
+        v = odd ? (v + 1) / -2 : v / 2;
+      }
+      else if (field.type == kTypeEnum)
+      {
+        bool found = false;
+        for (size_t i = 0; i < field.enumValues.size() && !found; i++)
+        {
+          found = field.enumValues[i] == v;
+        }
+        if (!found)
+        {
+          return kBail;
+        }
+      }
+      words->push_back(v);
+      *pos += n;
+      return kOk;
+    case kTypeInt64:
+      return ReadInt64(pos, end, words);
+    case kTypeFixed64:
+      if (available < 8)
+      {
+        return kBail;
+      }
+      words->push_back(static_cast<double>(*pos));
+      words->push_back(static_cast<double>(*pos + 8));
+      *pos += 8;
+      return kOk;
+    case kTypeDouble:
+      if (available < 8)
+      {
+        return kBail;
+      }
+      {
+        uint64_t bits = ReadFixed64(in);
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        words->push_back(d);
+      }
+      *pos += 8;
+      return kOk;
+    case kTypeFixed32:
+    case kTypeSfixed32:
+    case kTypeFloat:
+      if (available < 4)
+      {
+        return kBail;
+      }
+      {
+        uint32_t bits = ReadFixed32(in);
+        if (field.type == kTypeFixed32)
+        {
+          words->push_back(bits);
+        }
+        else if (field.type == kTypeSfixed32)
+        {
+          words->push_back(static_cast<int32_t>(bits));
+        }
+        else
+        {
+          float f;
+          memcpy(&f, &bits, sizeof(f));
+          words->push_back(f);
+        }
+      }
+      *pos += 4;
+      return kOk;
+    case kTypeString:
+    case kTypeBytes:
+      if ((n = ReadVarint(in, available, kMaxVarintBytes, &v)) == 0 || !(v <= static_cast<double>(available - n)))
+      {
+        return kBail;
+      }
+      *pos += n;
+      if (field.type == kTypeBytes)
+      {
+        words->push_back(static_cast<double>(*pos));
+        words->push_back(static_cast<double>(*pos) + v);
+      }
+      else
+      {
+        v8::Local<v8::String> str;
+        if (v > v8::String::kMaxLength ||
+            !Nan::New<v8::String>(reinterpret_cast<const char *>(data + *pos), static_cast<int>(v)).ToLocal(&str))
+        {
+          return kBail;
+        }
+        words->push_back(static_cast<double>(strings.size()));
+        strings.push_back(str);
+      }
+      *pos += static_cast<size_t>(v);
+      return kOk;
+    default:
+      return kBail;
+    }
+  }
+
+  // int64 values at or above 2^63 are read as negative numbers the way encodings.js does: the 0xff
+  // bytes before the tenth one are left out, and the varint always takes 10 bytes
+  Status ReadInt64(size_t *pos, size_t end, std::vector<double> *words)
+  {
+    double v;
+    size_t n = ReadVarint(data + *pos, end - *pos, kMaxVarintBytes, &v);
+    if (n == 0)
+    {
+      return kBail;
+    }
+    if (v < k2Pow63)
+    {
+      words->push_back(v);
+      *pos += n;
+      return kOk;
+    }
+    // the bytes are read from the whole buffer, not the message
+    size_t start = *pos;
+    size_t limit = 9;
+    while (limit > 0 && start + limit - 1 < length && data[start + limit - 1] == 0xff)
+    {
+      limit--;
+    }
+    if (limit == 0 && start > 0 && data[start - 1] == 0xff)
+    {
+      // a negative length
+      return kBail;
+    }
+    limit = limit == 0 ? 9 : limit;
+    if (start + limit > length || end - start < 10)
+    {
+      return kBail;
+    }
+    uint8_t subset[9];
+    memcpy(subset, data + start, limit);
+    subset[limit - 1] &= 0x7f;
+    if (ReadVarint(subset, limit, limit, &v) == 0)
+    {
+      return kBail;
+    }
+    words->push_back(-1 * v);
+    *pos += 10;
+    return kOk;
+  }
+
+  // The values that the JavaScript code writes: not undefined or NaN
+  bool IsDefined(const Field &field, const Slot &slot)
+  {
+    return slot.present && !slot.defaulted &&
+           ((field.type != kTypeDouble && field.type != kTypeFloat) || (field.flags & (kFlagRepeated | kFlagMap)) ||
+            !isnan(slot.words[0]));
+  }
+
+  // Checks the required fields and marks the ones that get their defaults
+  Status Finish(const Message &message, Slots &slots)
+  {
+    bool oneof = false;
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+      const Field &field = message.fields[i];
+      if ((field.flags & kFlagRequired) && !IsDefined(field, slots[i]))
+      {
+        return kBail;
+      }
+      oneof = oneof || (field.oneof >= 0 && slots[i].present);
+    }
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+      const Field &field = message.fields[i];
+      // a oneof field gets no default when one of them is set
+      if (IsDefined(field, slots[i]) || (field.oneof >= 0 && oneof))
+      {
+        continue;
+      }
+      slots[i].defaulted = true;
+      oneof = oneof || field.oneof >= 0;
+    }
+    return kOk;
+  }
+
+  // Writes the keys in the order they were read, then the defaults
+  Status Emit(const Message &message, Slots &slots, size_t *record)
+  {
+    std::vector<size_t> &keys = schema.keys;
+    size_t base = keys.size();
+    size_t words = 1;
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+      const Slot &slot = slots[i];
+      if (slot.present)
+      {
+        size_t j = keys.size();
+        keys.push_back(i);
+        for (; j > base && slots[keys[j - 1]].order > slot.order; j--)
+        {
+          keys[j] = keys[j - 1];
+        }
+        keys[j] = i;
+        words += 2 + slot.words.size();
+      }
+    }
+    for (size_t i = 0; i < slots.size(); i++)
+    {
+      if (slots[i].defaulted && !slots[i].present)
+      {
+        keys.push_back(i);
+        words++;
+      }
+    }
+    if (!schema.ReserveTape(words))
+    {
+      keys.resize(base);
+      return kBail;
+    }
+    double *out = schema.tape + schema.tapeLength;
+    *record = schema.tapeLength;
+    *out++ = static_cast<double>(keys.size() - base);
+    for (size_t k = base; k < keys.size(); k++)
+    {
+      const Slot &slot = slots[keys[k]];
+      if (slot.defaulted)
+      {
+        *out++ = -1 - static_cast<double>(keys[k]);
+        continue;
+      }
+      *out++ = static_cast<double>(keys[k]);
+      if (message.fields[keys[k]].flags & (kFlagRepeated | kFlagMap))
+      {
+        *out++ = slot.count;
+      }
+      if (!slot.words.empty())
+      {
+        memcpy(out, slot.words.data(), slot.words.size() * sizeof(double));
+        out += slot.words.size();
+      }
+    }
+    schema.tapeLength = out - schema.tape;
+    keys.resize(base);
+    return kOk;
+  }
+
+  Schema &schema;
+};
+
+// Writes to the memory of the target, and to its own memory once the target is full
+class Output
+{
+public:
+  Output(uint8_t *target, size_t capacity) : data(target), length(0), capacity(capacity), owned(false) {}
+
+  ~Output()
+  {
+    if (owned)
+    {
+      free(data);
+    }
+  }
+
+  bool Reserve(size_t n)
+  {
+    if (length + n <= capacity)
+    {
+      return true;
+    }
+    size_t grown = capacity * 2 > length + n ? capacity * 2 : length + n;
+    grown = grown > kMinCapacity ? grown : kMinCapacity;
+    uint8_t *p;
+    if (owned)
+    {
+      p = static_cast<uint8_t *>(realloc(data, grown));
+    }
+    else
+    {
+      p = static_cast<uint8_t *>(malloc(grown));
+      if (p != NULL && length > 0)
+      {
+        memcpy(p, data, length);
+      }
+    }
+    if (p == NULL)
+    {
+      return false;
+    }
+    data = p;
+    capacity = grown;
+    owned = true;
+    return true;
+  }
+
+  // The number of bytes written if they fit in the target, otherwise a Buffer that owns them
+  v8::Local<v8::Value> Release()
+  {
+    if (!owned)
+    {
+      if (data == NULL)
+      {
+        return Nan::NewBuffer(0).ToLocalChecked();
+      }
+      return Nan::New<v8::Number>(static_cast<double>(length));
+    }
+    owned = false;
+    return Nan::NewBuffer(reinterpret_cast<char *>(data), static_cast<uint32_t>(length)).ToLocalChecked();
+  }
+
+  uint8_t *data;
+  size_t length;
+  size_t capacity;
+
+private:
+  static const size_t kMinCapacity = 4096;
+  bool owned;
+};
+
+class Encoder
+{
+public:
+  Encoder(const Schema &schema, uint8_t *target, size_t capacity)
+      : out(target, capacity), schema(schema), isolate(v8::Isolate::GetCurrent()),
+        context(Nan::GetCurrentContext()), bufferPrototype(Nan::New(schema.bufferPrototype))
+  {
+  }
+
+  Status Encode(const Message &message, v8::Local<v8::Value> value, int depth)
+  {
+    if (depth > kMaxDepth || !value->IsObject() || value->IsProxy())
+    {
+      return kBail;
+    }
+    v8::Local<v8::Object> object = value.As<v8::Object>();
+    size_t count = message.fields.size();
+    std::vector<v8::Local<v8::Value> > fields(count);
+    for (size_t i = 0; i < count; i++)
+    {
+      if (!object->Get(context, schema.Value(message.fields[i].name)).ToLocal(&fields[i]))
+      {
+        return kError;
+      }
+    }
+    if (message.oneofs > 0)
+    {
+      // encodingLength() throws when a oneof has several values
+      std::vector<bool> set(message.oneofs);
+      for (size_t i = 0; i < count; i++)
+      {
+        int oneof = message.fields[i].oneof;
+        if (oneof >= 0 && IsDefined(fields[i]))
+        {
+          if (set[oneof])
+          {
+            return kBail;
+          }
+          set[oneof] = true;
+        }
+      }
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+      const Field &field = message.fields[i];
+      if (!IsDefined(fields[i]))
+      {
+        if (field.flags & kFlagRequired)
+        {
+          return kBail;
+        }
+        continue;
+      }
+      Status status;
+      if (field.flags & kFlagMap)
+      {
+        status = EncodeMap(field, fields[i], depth);
+      }
+      else if (field.flags & kFlagRepeated)
+      {
+        status = EncodeRepeated(field, fields[i], depth);
+      }
+      else
+      {
+        status = EncodeField(field, fields[i], depth);
+      }
+      if (status != kOk)
+      {
+        return status;
+      }
+    }
+    return kOk;
+  }
+
+  Output out;
+
+private:
+  Status OutOfMemory()
+  {
+    Nan::ThrowRangeError("Out of memory");
+    return kError;
+  }
+
+  bool IsBuffer(v8::Local<v8::Value> value)
+  {
+    return value->IsUint8Array() && value.As<v8::Object>()->GetPrototype()->StrictEquals(bufferPrototype);
+  }
+
+  Status PutBytes(const uint8_t *bytes, size_t count)
+  {
+    if (!out.Reserve(count))
+    {
+      return OutOfMemory();
+    }
+    memcpy(out.data + out.length, bytes, count);
+    out.length += count;
+    return kOk;
+  }
+
+  Status PutVarint(uint64_t v)
+  {
+    if (!out.Reserve(kMaxVarintBytes))
+    {
+      return OutOfMemory();
+    }
+    out.length += WriteVarint(out.data + out.length, v);
+    return kOk;
+  }
+
+  // Leaves a byte for the length of what follows, EndLength() writes it
+  Status BeginLength(size_t *mark)
+  {
+    if (!out.Reserve(1))
+    {
+      return OutOfMemory();
+    }
+    *mark = out.length++;
+    return kOk;
+  }
+
+  Status EndLength(size_t mark)
+  {
+    size_t count = out.length - mark - 1;
+    size_t n = VarintLength(count);
+    if (n > 1)
+    {
+      if (!out.Reserve(n - 1))
+      {
+        return OutOfMemory();
+      }
+      memmove(out.data + mark + n, out.data + mark + 1, count);
+      out.length += n - 1;
+    }
+    WriteVarint(out.data + mark, count);
+    return kOk;
+  }
+
+  Status EncodeField(const Field &field, v8::Local<v8::Value> value, int depth)
+  {
+    Status status = PutBytes(field.header, field.headerLength);
+    return status == kOk ? EncodeValue(field, value, depth) : status;
+  }
+
+  Status EncodeRepeated(const Field &field, v8::Local<v8::Value> value, int depth)
+  {
+    if (!value->IsArray())
+    {
+      return kBail;
+    }
+    v8::Local<v8::Array> array = value.As<v8::Array>();
+    uint32_t count = array->Length();
+    bool packed = (field.flags & kFlagPacked) != 0;
+    size_t start = out.length;
+    size_t mark = 0;
+    Status status;
+    if (packed && ((status = PutBytes(field.packedHeader, field.packedHeaderLength)) != kOk ||
+                   (status = BeginLength(&mark)) != kOk))
+    {
+      return status;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+      v8::Local<v8::Value> element;
+      if (!array->Get(context, i).ToLocal(&element))
+      {
+        return kError;
+      }
+      if (!IsDefined(element))
+      {
+        continue;
+      }
+      status = packed ? EncodeValue(field, element, depth) : EncodeField(field, element, depth);
+      if (status != kOk)
+      {
+        return status;
+      }
+    }
+    if (packed)
+    {
+      if (out.length == mark + 1)
+      {
+        // nothing is written for no elements
+        out.length = start;
+        return kOk;
+      }
+      return EndLength(mark);
+    }
+    return kOk;
+  }
+
+  // The entries are written as messages of the key and the value, in the order of Object.keys()
+  Status EncodeMap(const Field &field, v8::Local<v8::Value> value, int depth)
+  {
+    if (!value->IsObject() || value->IsProxy() || depth >= kMaxDepth)
+    {
+      return kBail;
+    }
+    v8::Local<v8::Object> object = value.As<v8::Object>();
+    v8::Local<v8::Array> keys;
+    if (!object
+             ->GetOwnPropertyNames(context, static_cast<v8::PropertyFilter>(v8::ONLY_ENUMERABLE | v8::SKIP_SYMBOLS),
+                                   v8::KeyConversionMode::kConvertToString)
+             .ToLocal(&keys))
+    {
+      return kError;
+    }
+    const Message &entry = schema.messages[field.message];
+    const Field &keyField = entry.fields[0];
+    const Field &valueField = entry.fields[1];
+    uint32_t count = keys->Length();
+    for (uint32_t i = 0; i < count; i++)
+    {
+      v8::Local<v8::Value> key;
+      v8::Local<v8::Value> element;
+      if (!keys->Get(context, i).ToLocal(&key) || !object->Get(context, key).ToLocal(&element))
+      {
+        return kError;
+      }
+      size_t mark;
+      Status status;
+      if ((status = PutBytes(field.header, field.headerLength)) != kOk || (status = BeginLength(&mark)) != kOk ||
+          (status = EncodeKey(keyField, key.As<v8::String>())) != kOk ||
+          (IsDefined(element) && (status = EncodeField(valueField, element, depth + 1)) != kOk) ||
+          (status = EndLength(mark)) != kOk)
+      {
+        return status;
+      }
+    }
+    return kOk;
+  }
+
+  // The keys are strings, the numeric types take the ones of non-negative integers that JavaScript
+  // converts to the same number everywhere
+  Status EncodeKey(const Field &field, v8::Local<v8::String> key)
+  {
+    switch (field.type)
+    {
+    case kTypeString:
+    case kTypeBytes:
+    case kTypeBool:
+      return EncodeField(field, key, 0);
+    case kTypeMessage:
+    case kTypeEnum:
+    case kTypeFixed64:
+      return kBail;
+    default:
+      break;
+    }
+    uint8_t digits[10];
+    int length = key->Length();
+    if (length < 1 || length > 10 || !key->ContainsOnlyOneByte())
+    {
+      return kBail;
+    }
+    key->WriteOneByte(isolate, digits, 0, length, v8::String::NO_NULL_TERMINATION);
+    double d = 0;
+    for (int i = 0; i < length; i++)
+    {
+      if (digits[i] < '0' || digits[i] > '9' || (i == 0 && digits[i] == '0' && length > 1))
+      {
+        return kBail;
+      }
+      d = d * 10 + (digits[i] - '0');
+    }
+    if (d > 2147483647.0)
+    {
+      return kBail;
+    }
+    return EncodeField(field, Nan::New<v8::Number>(d), 0);
+  }
+
+  Status EncodeString(v8::Local<v8::String> str)
+  {
+    int count = str->Length();
+    int flags = v8::String::NO_NULL_TERMINATION | v8::String::REPLACE_INVALID_UTF8;
+    // every UTF-16 unit takes 3 bytes at most, the length of short strings takes a byte
+    if (count < 43)
+    {
+      if (!out.Reserve(1 + 3 * count))
+      {
+        return OutOfMemory();
+      }
+      int written = str->WriteUtf8(isolate, reinterpret_cast<char *>(out.data + out.length + 1), 3 * count, NULL,
+                                   flags);
+      out.data[out.length] = static_cast<uint8_t>(written);
+      out.length += 1 + written;
+      return kOk;
+    }
+    size_t length = str->Utf8Length(isolate);
+    Status status = PutVarint(length);
+    if (status != kOk)
+    {
+      return status;
+    }
+    if (!out.Reserve(length))
+    {
+      return OutOfMemory();
+    }
+    str->WriteUtf8(isolate, reinterpret_cast<char *>(out.data + out.length), static_cast<int>(length), NULL, flags);
+    out.length += length;
+    return kOk;
+  }
+
+  Status EncodeValue(const Field &field, v8::Local<v8::Value> value, int depth)
+  {
+    if (field.type == kTypeMessage)
+    {
+      size_t mark;
+      Status status;
+      if ((status = BeginLength(&mark)) != kOk ||
+          (status = Encode(schema.messages[field.message], value, depth + 1)) != kOk)
+      {
+        return status;
+      }
+      return EndLength(mark);
+    }
+    if (field.type == kTypeString || field.type == kTypeBytes)
+    {
+      if (value->IsString())
+      {
+        return EncodeString(value.As<v8::String>());
+      }
+      if (field.type == kTypeString || !IsBuffer(value))
+      {
+        return kBail;
+      }
+      size_t count = node::Buffer::Length(value);
+      Status status = PutVarint(count);
+      return status == kOk ? PutBytes(reinterpret_cast<const uint8_t *>(node::Buffer::Data(value)), count) : status;
+    }
+    if (field.type == kTypeBool)
+    {
+      uint8_t b = value->BooleanValue(isolate) ? 1 : 0;
+      return PutBytes(&b, 1);
+    }
+    if (field.type == kTypeFixed64)
+    {
+      if (!IsBuffer(value) || node::Buffer::Length(value) != 8)
+      {
+        return kBail;
+      }
+      return PutBytes(reinterpret_cast<const uint8_t *>(node::Buffer::Data(value)), 8);
+    }
+    if (!value->IsNumber())
+    {
+      return kBail;
+    }
+
+    double d = value.As<v8::Number>()->Value();
+    uint8_t bytes[kMaxVarintBytes];
+    switch (field.type)
+    {
+    case kTypeDouble:
+      {
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        WriteFixed64(bytes, bits);
+      }
+      return PutBytes(bytes, 8);
+    case kTypeFloat:
+      {
+        float f = static_cast<float>(d);
+        uint32_t bits;
+        memcpy(&bits, &f, sizeof(bits));
+        WriteFixed32(bytes, bits);
+      }
+      return PutBytes(bytes, 4);
+    case kTypeFixed32:
+      if (!IsInteger(d) || d < 0 || d > 4294967295.0)
+      {
+        return kBail;
+      }
+      WriteFixed32(bytes, static_cast<uint32_t>(d));
+      return PutBytes(bytes, 4);
+    case kTypeSfixed32:
+      if (!IsInteger(d) || d < -2147483648.0 || d > 2147483647.0)
+      {
+        return kBail;
+      }
+      WriteFixed32(bytes, static_cast<uint32_t>(static_cast<int32_t>(d)));
+      return PutBytes(bytes, 4);
+    case kTypeInt32:
+      // negative values are written modulo 2^32
+      if (!IsInteger(d) || d < -k2Pow32 || d >= k2Pow64)
+      {
+        return kBail;
+      }
+      return PutVarint(static_cast<uint64_t>(d < 0 ? d + k2Pow32 : d));
+    case kTypeInt64:
+      if (!IsInteger(d) || d <= -k2Pow63 || d >= k2Pow64)
+      {
+        return kBail;
+      }
+      if (d < 0)
+      {
+        // the magnitude with the continuation bit, 0xff up to the ninth byte and 0x01
+        size_t n = WriteVarint(bytes, static_cast<uint64_t>(-d));
+        bytes[n - 1] |= 0x80;
+        for (; n < 9; n++)
+        {
+          bytes[n] = 0xff;
+        }
+        bytes[9] = 0x01;
+        return PutBytes(bytes, 10);
+      }
+      return PutVarint(static_cast<uint64_t>(d));
+    case kTypeSint:
+      d = d >= 0 ? d * 2 : d * -2 - 1;
+      if (!IsInteger(d) || d >= k2Pow64)
+      {
+        return kBail;
+      }
+      return PutVarint(static_cast<uint64_t>(d));
+    case kTypeEnum:
+      {
+        bool found = false;
+        for (size_t i = 0; i < field.enumValues.size() && !found; i++)
+        {
+          found = field.enumValues[i] == d;
+        }
+        if (!found || d < 0)
+        {
+          return kBail;
+        }
+      }
+      return PutVarint(static_cast<uint64_t>(d));
+    case kTypeUint:
+      if (!IsInteger(d) || d < 0 || d >= k2Pow64)
+      {
+        return kBail;
+      }
+      return PutVarint(static_cast<uint64_t>(d));
+    default:
+      return kBail;
+    }
+  }
+
+  const Schema &schema;
+  v8::Isolate *isolate;
+  v8::Local<v8::Context> context;
+  v8::Local<v8::Value> bufferPrototype;
+};
+
+// The message of the index argument, throws if there is none
+static const Message *GetMessage(const Schema *schema, v8::Local<v8::Value> index)
+{
+  if (!index->IsUint32() || index.As<v8::Uint32>()->Value() >= schema->messages.size())
+  {
+    Nan::ThrowRangeError("Invalid message index");
+    return NULL;
+  }
+  return &schema->messages[index.As<v8::Uint32>()->Value()];
+}
+
+// The offset argument, `fallback` if it is null or undefined. Returns false if it is not an
+// integer in [0, limit].
+static bool GetOffset(v8::Local<v8::Value> value, size_t fallback, size_t limit, size_t *offset)
+{
+  if (value->IsNullOrUndefined())
+  {
+    *offset = fallback;
+    return true;
+  }
+  if (!value->IsNumber())
+  {
+    return false;
+  }
+  double d = value.As<v8::Number>()->Value();
+  if (!IsInteger(d) || d < 0 || d > static_cast<double>(limit))
+  {
+    return false;
+  }
+  *offset = static_cast<size_t>(d);
+  return true;
+}
+
+static bool IsBuffer(const Schema *schema, v8::Local<v8::Value> value)
+{
+  return value->IsUint8Array() &&
+         value.As<v8::Object>()->GetPrototype()->StrictEquals(Nan::New(schema->bufferPrototype));
+}
+
+// encode(index, obj, target), writes the message to the target Buffer, or to a new one if the target
+// is null. Returns the number of bytes written to the target, a Buffer with the encoding if it does
+// not fit in the target, or undefined if the JavaScript code has to encode the message.
+NAN_METHOD(Schema::Encode)
+{
+  Schema *schema = Nan::ObjectWrap::Unwrap<Schema>(info.Holder());
+  const Message *message = GetMessage(schema, info[0]);
+  if (message == NULL)
+  {
+    return;
+  }
+  uint8_t *target = NULL;
+  size_t capacity = 0;
+  if (!info[2]->IsNull())
+  {
+    if (!node::Buffer::HasInstance(info[2]))
+    {
+      return Nan::ThrowTypeError("Target must be a Buffer");
+    }
+    target = reinterpret_cast<uint8_t *>(node::Buffer::Data(info[2]));
+    capacity = node::Buffer::Length(info[2]);
+  }
+  Encoder encoder(*schema, target, capacity);
+  Status status;
+  {
+    ADONE_TRACE_SCOPE("data", "protobuf:encode");
+    status = encoder.Encode(*message, info[1], 0);
+  }
+  if (status == kOk)
+  {
+    info.GetReturnValue().Set(encoder.out.Release());
+  }
+}
+
+// decode(index, buf, offset, end), decodes the message in [offset, end) of the Buffer to the tape.
+// Sets state[0] to the number of bytes read and state[2] to the offset of the record, returns the
+// strings of the message or undefined if the JavaScript code has to decode it.
+NAN_METHOD(Schema::Decode)
+{
+  Schema *schema = Nan::ObjectWrap::Unwrap<Schema>(info.Holder());
+  const Message *message = GetMessage(schema, info[0]);
+  if (message == NULL)
+  {
+    return;
+  }
+  if (!IsBuffer(schema, info[1]))
+  {
+    return;
+  }
+  size_t length = node::Buffer::Length(info[1]);
+  size_t offset;
+  size_t end;
+  if (!GetOffset(info[2], 0, length, &offset) || !GetOffset(info[3], length, length, &end))
+  {
+    return;
+  }
+  Decoder decoder(*schema, reinterpret_cast<const uint8_t *>(node::Buffer::Data(info[1])), length);
+  size_t record;
+  Status status;
+  schema->tapeLength = 0;
+  schema->state[4] = 0;
+  {
+    ADONE_TRACE_SCOPE("data", "protobuf:decode");
+    status = decoder.Decode(*message, offset, end, &record, 0);
+  }
+  if (status != kOk)
+  {
+    return;
+  }
+  schema->state[0] = end > offset ? static_cast<double>(end - offset) : 0;
+  schema->state[2] = static_cast<double>(record);
+  info.GetReturnValue().Set(v8::Array::New(v8::Isolate::GetCurrent(), decoder.strings.data(), decoder.strings.size()));
+}
+
+// decodeMany(index, buf, offset, end), decodes the length-delimited messages in [offset, end) up to the
+// first incomplete one to the tape. Sets state[0] to the number of bytes read, state[1] to 1 if it stopped
+// before a message the JavaScript code has to decode, state[2] to the offset of the offsets of the records
+// and state[3] to their number. Returns the strings of the messages.
+NAN_METHOD(Schema::DecodeMany)
+{
+  Schema *schema = Nan::ObjectWrap::Unwrap<Schema>(info.Holder());
+  const Message *message = GetMessage(schema, info[0]);
+  if (message == NULL)
+  {
+    return;
+  }
+  std::vector<size_t> records;
+  std::vector<v8::Local<v8::Value> > strings;
+  size_t offset = 0;
+  size_t pos = 0;
+  bool stopped = true;
+  schema->tapeLength = 0;
+  schema->state[4] = 0;
+  if (IsBuffer(schema, info[1]))
+  {
+    size_t length = node::Buffer::Length(info[1]);
+    size_t end;
+    if (GetOffset(info[2], 0, length, &offset) && GetOffset(info[3], length, length, &end))
+    {
+      ADONE_TRACE_SCOPE("data", "protobuf:decodeMany");
+      Decoder decoder(*schema, reinterpret_cast<const uint8_t *>(node::Buffer::Data(info[1])), length);
+      stopped = false;
+      for (pos = offset; pos < end;)
+      {
+        double messageLength;
+        // the length is read up to the end of the buffer
+        size_t n = ReadVarint(decoder.data + pos, length - pos, length - pos, &messageLength);
+        if (n == 0)
+        {
+          break;
+        }
+        if (isnan(messageLength))
+        {
+          stopped = true;
+          break;
+        }
+        if (static_cast<double>(pos + n) + messageLength > static_cast<double>(end))
+        {
+          break;
+        }
+        size_t start = pos + n;
+        size_t messageEnd = start + static_cast<size_t>(messageLength);
+        size_t record;
+        size_t tapeLength = schema->tapeLength;
+        size_t stringCount = decoder.strings.size();
+        if (decoder.Decode(*message, start, messageEnd, &record, 0) != kOk)
+        {
+          // the records of the message are dropped
+          schema->tapeLength = tapeLength;
+          decoder.strings.resize(stringCount);
+          stopped = true;
+          break;
+        }
+        records.push_back(record);
+        pos = messageEnd;
+      }
+      strings.swap(decoder.strings);
+    }
+  }
+  if (!schema->ReserveTape(records.size()))
+  {
+    records.clear();
+    pos = offset;
+    stopped = true;
+  }
+  schema->state[0] = static_cast<double>(pos - offset);
+  schema->state[1] = stopped ? 1 : 0;
+  schema->state[2] = static_cast<double>(schema->tapeLength);
+  schema->state[3] = static_cast<double>(records.size());
+  for (size_t i = 0; i < records.size(); i++)
+  {
+    schema->tape[schema->tapeLength++] = static_cast<double>(records[i]);
+  }
+  info.GetReturnValue().Set(v8::Array::New(v8::Isolate::GetCurrent(), strings.data(), strings.size()));
+}
+
+} // namespace protobuf
+
+NAN_MODULE_INIT(InitProtobuf)
+{
+  protobuf::Schema::Init(target);
+}
+
+} // namespace nodedata
@@ -0,0 +1,88 @@
+#include "wire.h"
+
+#include <math.h>
+
+namespace nodedata
+{
+namespace protobuf
+{
+
+size_t ReadVarint(const uint8_t *in, size_t length, size_t maxBytes, double *value)
+{
+  double result = 0;
+  int shift = 0;
+  for (size_t i = 0; i < length && i < maxBytes; i++)
+  {
+    uint8_t b = in[i];
+    // the same as (b & 0x7F) << shift below 28 bits and (b & 0x7F) * Math.pow(2, shift) above
+    result += shift < 28 ? static_cast<double>(static_cast<uint32_t>(b & 0x7F) << shift)
+                         : static_cast<double>(b & 0x7F) * ldexp(1.0, shift);
+    if (b < 0x80)
+    {
+      *value = result;
+      return i + 1;
+    }
+    // 2^shift is infinite past 1024 bits, larger shifts do not change the result
+    shift = shift < 2048 ? shift + 7 : shift;
+  }
+  return 0;
+}
+
+bool SkipField(const uint8_t *in, size_t length, uint32_t wireType, size_t *read)
+{
+  double value;
+  size_t n;
+  switch (wireType)
+  {
+  case kWireVarint:
+    n = ReadVarint(in, length, length, &value);
+    if (n == 0)
+    {
+      return false;
+    }
+    *read = n;
+    return true;
+  case kWireFixed64:
+    *read = 8;
+    return length >= 8;
+  case kWireLengthDelimited:
+    n = ReadVarint(in, length, length, &value);
+    if (n == 0 || !(value <= static_cast<double>(length - n)))
+    {
+      return false;
+    }
+    *read = n + static_cast<size_t>(value);
+    return true;
+  case kWireFixed32:
+    *read = 4;
+    return length >= 4;
+  default:
+    return false;
+  }
+}
+
+size_t VarintLength(uint64_t value)
+{
+  size_t n = 1;
+  while (value >= 0x80)
+  {
+    value >>= 7;
+    n++;
+  }
+  return n;
+}
+
+size_t WriteVarint(uint8_t *out, uint64_t value)
+{
+  size_t n = 0;
+  while (value >= 0x80)
+  {
+    out[n++] = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  out[n++] = static_cast<uint8_t>(value);
+  return n;
+}
+
+} // namespace protobuf
+} // namespace nodedata
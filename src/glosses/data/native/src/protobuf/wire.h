@@ -0,0 +1,68 @@
+#ifndef __DATA_PROTOBUF_WIRE_H_
+#define __DATA_PROTOBUF_WIRE_H_
+
+// The protobuf wire format as data/protobuf reads and writes it.
+//
+// Varints are read the way data/varint.js decode() does, accumulating the 7-bit groups in a double:
+// the values above 2^53 are rounded the same way and the invalid ones give the same numbers, so the
+// native codec returns what the JavaScript one does.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace nodedata
+{
+namespace protobuf
+{
+
+enum WireType
+{
+  kWireVarint = 0,
+  kWireFixed64 = 1,
+  kWireLengthDelimited = 2,
+  kWireFixed32 = 5
+};
+
+static const size_t kMaxVarintBytes = 10;
+
+// Reads the varint at `in`, returns the number of bytes read or 0 if it does not end in `length`
+// bytes or has more than `maxBytes`
+size_t ReadVarint(const uint8_t *in, size_t length, size_t maxBytes, double *value);
+
+// Skips a field of an unknown tag, returns false if it does not end in `length` bytes or has a
+// wire type the decoder does not skip
+bool SkipField(const uint8_t *in, size_t length, uint32_t wireType, size_t *read);
+
+size_t VarintLength(uint64_t value);
+// The output must have VarintLength() bytes, returns the number written
+size_t WriteVarint(uint8_t *out, uint64_t value);
+
+inline uint32_t ReadFixed32(const uint8_t *in)
+{
+  return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8 | static_cast<uint32_t>(in[2]) << 16 |
+         static_cast<uint32_t>(in[3]) << 24;
+}
+
+inline uint64_t ReadFixed64(const uint8_t *in)
+{
+  return static_cast<uint64_t>(ReadFixed32(in)) | static_cast<uint64_t>(ReadFixed32(in + 4)) << 32;
+}
+
+inline void WriteFixed32(uint8_t *out, uint32_t value)
+{
+  out[0] = static_cast<uint8_t>(value);
+  out[1] = static_cast<uint8_t>(value >> 8);
+  out[2] = static_cast<uint8_t>(value >> 16);
+  out[3] = static_cast<uint8_t>(value >> 24);
+}
+
+inline void WriteFixed64(uint8_t *out, uint64_t value)
+{
+  WriteFixed32(out, static_cast<uint32_t>(value));
+  WriteFixed32(out + 4, static_cast<uint32_t>(value >> 32));
+}
+
+} // namespace protobuf
+} // namespace nodedata
+
+#endif // __DATA_PROTOBUF_WIRE_H_
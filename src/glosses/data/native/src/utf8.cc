@@ -0,0 +1,172 @@
+#include "data.h"
+#include "utf8/utf8.h"
+
+#include <adone_trace.h>
+
+#include <string.h> // strcmp
+
+namespace nodedata
+{
+
+// An optional offset argument, clamped to the length
+static inline size_t GetOffset(v8::Local<v8::Value> value, size_t fallback, size_t length)
+{
+  if (value->IsUndefined())
+  {
+    return fallback;
+  }
+  double offset = Nan::To<double>(value).FromJust();
+  if (!(offset > 0))
+  {
+    return 0;
+  }
+  return offset < static_cast<double>(length) ? static_cast<size_t>(offset) : length;
+}
+
+// utf8Validate(bytes, start, end), returns true if the bytes from start to end are valid UTF-8
+NAN_METHOD(Utf8Validate)
+{
+  const uint8_t *data;
+  size_t length;
+  if (!GetBytes(info[0], &data, &length))
+  {
+    return Nan::ThrowTypeError("Input must be a Buffer or an Uint8Array");
+  }
+  size_t start = GetOffset(info[1], 0, length);
+  size_t end = GetOffset(info[2], length, length);
+  bool valid = true;
+  if (start < end)
+  {
+    ADONE_TRACE_SCOPE("data", "utf8:validate");
+    valid = utf8::Validate(data + start, end - start);
+  }
+  info.GetReturnValue().Set(valid);
+}
+
+NAN_METHOD(Utf8CountCodePoints)
+{
+  const uint8_t *data;
+  size_t length;
+  if (!GetBytes(info[0], &data, &length))
+  {
+    return Nan::ThrowTypeError("Input must be a Buffer or an Uint8Array");
+  }
+  info.GetReturnValue().Set(static_cast<double>(utf8::CountCodePoints(data, length)));
+}
+
+// utf8Decode(input), the input is a Buffer or a string of bytes (characters up to U+00FF). Returns
+// the decoded string, or undefined if the input is not valid UTF-8 or the string has other characters.
+NAN_METHOD(Utf8Decode)
+{
+  v8::Isolate *isolate = v8::Isolate::GetCurrent();
+  const uint8_t *data;
+  size_t length;
+  std::vector<uint8_t> bytes;
+  if (!GetBytes(info[0], &data, &length))
+  {
+    if (!info[0]->IsString())
+    {
+      return Nan::ThrowTypeError("Input must be a string or a Buffer");
+    }
+    v8::Local<v8::String> str = info[0].As<v8::String>();
+    if (!str->ContainsOnlyOneByte())
+    {
+      return;
+    }
+    bytes.resize(str->Length());
+    str->WriteOneByte(isolate, bytes.data(), 0, -1, v8::String::NO_NULL_TERMINATION);
+    data = bytes.data();
+    length = bytes.size();
+  }
+  std::vector<uint16_t> units(length);
+  size_t written;
+  {
+    ADONE_TRACE_SCOPE("data", "utf8:decode");
+    if (!utf8::ToUtf16(data, length, units.data(), &written))
+    {
+      return;
+    }
+  }
+  v8::MaybeLocal<v8::String> result;
+  if (written == length)
+  {
+    // one code unit per byte, the input is ASCII
+    result = v8::String::NewFromOneByte(isolate, data, v8::NewStringType::kNormal, static_cast<int>(length));
+  }
+  else
+  {
+    result = v8::String::NewFromTwoByte(isolate, units.data(), v8::NewStringType::kNormal, static_cast<int>(written));
+  }
+  v8::Local<v8::String> str;
+  if (!result.ToLocal(&str))
+  {
+    return Nan::ThrowRangeError("Invalid string length");
+  }
+  info.GetReturnValue().Set(str);
+}
+
+// utf8Encode(string), returns the UTF-8 encoding as a string of bytes, or undefined if the string has
+// a lone surrogate
+NAN_METHOD(Utf8Encode)
+{
+  if (!info[0]->IsString())
+  {
+    return Nan::ThrowTypeError("Input must be a string");
+  }
+  v8::Isolate *isolate = v8::Isolate::GetCurrent();
+  v8::Local<v8::String> str = info[0].As<v8::String>();
+  std::vector<uint16_t> units(str->Length());
+  str->Write(isolate, units.data(), 0, -1, v8::String::NO_NULL_TERMINATION);
+  std::vector<uint8_t> out(units.size() * 3);
+  size_t written;
+  {
+    ADONE_TRACE_SCOPE("data", "utf8:encode");
+    if (!utf8::FromUtf16(units.data(), units.size(), out.data(), &written))
+    {
+      return;
+    }
+  }
+  v8::Local<v8::String> result;
+  if (!v8::String::NewFromOneByte(isolate, out.data(), v8::NewStringType::kNormal, static_cast<int>(written))
+           .ToLocal(&result))
+  {
+    return Nan::ThrowRangeError("Invalid string length");
+  }
+  info.GetReturnValue().Set(result);
+}
+
+NAN_METHOD(GetUtf8Kernel)
+{
+  v8::Local<v8::Object> result = Nan::New<v8::Object>();
+  Nan::Set(result, NanStr("active"), NanStr(utf8::KernelName(utf8::GetKernel())));
+  Nan::Set(result, NanStr("best"), NanStr(utf8::KernelName(utf8::GetBestKernel())));
+  info.GetReturnValue().Set(result);
+}
+
+// setKernel(name), returns false if the kernel is unknown or the CPU does not support it
+NAN_METHOD(SetUtf8Kernel)
+{
+  Nan::Utf8String name(info[0]);
+  static const utf8::Kernel kernels[] = {utf8::kKernelScalar, utf8::kKernelSSSE3, utf8::kKernelAVX2};
+  for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+  {
+    if (*name != NULL && strcmp(*name, utf8::KernelName(kernels[i])) == 0)
+    {
+      info.GetReturnValue().Set(utf8::SetKernel(kernels[i]));
+      return;
+    }
+  }
+  info.GetReturnValue().Set(false);
+}
+
+NAN_MODULE_INIT(InitUtf8)
+{
+  Nan::SetMethod(target, "utf8Validate", Utf8Validate);
+  Nan::SetMethod(target, "utf8CountCodePoints", Utf8CountCodePoints);
+  Nan::SetMethod(target, "utf8Decode", Utf8Decode);
+  Nan::SetMethod(target, "utf8Encode", Utf8Encode);
+  Nan::SetMethod(target, "utf8GetKernel", GetUtf8Kernel);
+  Nan::SetMethod(target, "utf8SetKernel", SetUtf8Kernel);
+}
+
+} // namespace nodedata
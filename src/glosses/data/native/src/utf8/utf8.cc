@@ -0,0 +1,324 @@
+#include "utf8_impl.h"
+
+#include <atomic>
+#include <string.h>
+
+namespace nodedata
+{
+namespace utf8
+{
+
+// The scalar code converts this many bytes or code units after a block that is not ASCII before the
+// vector kernel is tried again
+static const size_t kScalarChunk = 32;
+
+Kernel GetBestKernel()
+{
+  const CpuFeatures &cpu = GetCpuFeatures();
+  if (cpu.avx2)
+  {
+    return kKernelAVX2;
+  }
+  return cpu.ssse3 && cpu.sse41 ? kKernelSSSE3 : kKernelScalar;
+}
+
+static std::atomic<int> kernel(-1);
+
+Kernel GetKernel()
+{
+  int current = kernel.load(std::memory_order_relaxed);
+  if (current < 0)
+  {
+    current = GetBestKernel();
+    kernel.store(current, std::memory_order_relaxed);
+  }
+  return static_cast<Kernel>(current);
+}
+
+bool SetKernel(Kernel value)
+{
+  if (value > GetBestKernel())
+  {
+    return false;
+  }
+  kernel.store(value, std::memory_order_relaxed);
+  return true;
+}
+
+const char *KernelName(Kernel value)
+{
+  switch (value)
+  {
+  case kKernelAVX2:
+    return "avx2";
+  case kKernelSSSE3:
+    return "ssse3";
+  default:
+    return "scalar";
+  }
+}
+
+static inline bool IsAscii8(const uint8_t *in)
+{
+  uint64_t w;
+  memcpy(&w, in, 8);
+  return (w & 0x8080808080808080ULL) == 0;
+}
+
+// Returns the length of the sequence that starts with a non-ASCII byte, or 0 if it is invalid (Table 3-7
+// of the Unicode Standard)
+static inline size_t SequenceLength(const uint8_t *in, size_t length)
+{
+  uint8_t lead = in[0];
+  size_t n;
+  uint8_t min = 0x80;
+  uint8_t max = 0xBF;
+  if (lead >= 0xC2 && lead <= 0xDF)
+  {
+    n = 2;
+  }
+  else if (lead >= 0xE0 && lead <= 0xEF)
+  {
+    n = 3;
+    if (lead == 0xE0)
+    {
+      min = 0xA0;
+    }
+    else if (lead == 0xED)
+    {
+      max = 0x9F;
+    }
+  }
+  else if (lead >= 0xF0 && lead <= 0xF4)
+  {
+    n = 4;
+    if (lead == 0xF0)
+    {
+      min = 0x90;
+    }
+    else if (lead == 0xF4)
+    {
+      max = 0x8F;
+    }
+  }
+  else
+  {
+    return 0;
+  }
+  if (length < n || in[1] < min || in[1] > max)
+  {
+    return 0;
+  }
+  for (size_t i = 2; i < n; i++)
+  {
+    if ((in[i] & 0xC0) != 0x80)
+    {
+      return 0;
+    }
+  }
+  return n;
+}
+
+static bool ValidateScalar(const uint8_t *in, size_t length)
+{
+  size_t i = 0;
+  while (i < length)
+  {
+    if (i + 8 <= length && IsAscii8(in + i))
+    {
+      i += 8;
+      continue;
+    }
+    if (in[i] < 0x80)
+    {
+      i++;
+      continue;
+    }
+    size_t n = SequenceLength(in + i, length - i);
+    if (n == 0)
+    {
+      return false;
+    }
+    i += n;
+  }
+  return true;
+}
+
+bool Validate(const uint8_t *in, size_t length)
+{
+#if defined(DATA_X86)
+  switch (GetKernel())
+  {
+  case kKernelAVX2:
+    return ValidateAvx2(in, length);
+  case kKernelSSSE3:
+    return ValidateSsse3(in, length);
+  default:
+    break;
+  }
+#endif
+  return ValidateScalar(in, length);
+}
+
+size_t CountCodePoints(const uint8_t *in, size_t length)
+{
+  size_t continuations = 0;
+  size_t done = 0;
+#if defined(DATA_X86)
+  switch (GetKernel())
+  {
+  case kKernelAVX2:
+    done = CountContinuationsAvx2(in, length, &continuations);
+    break;
+  case kKernelSSSE3:
+    done = CountContinuationsSsse3(in, length, &continuations);
+    break;
+  default:
+    break;
+  }
+#endif
+  for (size_t i = done; i < length; i++)
+  {
+    continuations += (in[i] & 0xC0) == 0x80;
+  }
+  return length - continuations;
+}
+
+static size_t WidenAscii(const uint8_t *in, size_t length, uint16_t *out)
+{
+#if defined(DATA_X86)
+  switch (GetKernel())
+  {
+  case kKernelAVX2:
+    return WidenAsciiAvx2(in, length, out);
+  case kKernelSSSE3:
+    return WidenAsciiSsse3(in, length, out);
+  default:
+    break;
+  }
+#endif
+  (void)in;
+  (void)length;
+  (void)out;
+  return 0;
+}
+
+static size_t NarrowAscii(const uint16_t *in, size_t length, uint8_t *out)
+{
+#if defined(DATA_X86)
+  switch (GetKernel())
+  {
+  case kKernelAVX2:
+    return NarrowAsciiAvx2(in, length, out);
+  case kKernelSSSE3:
+    return NarrowAsciiSsse3(in, length, out);
+  default:
+    break;
+  }
+#endif
+  (void)in;
+  (void)length;
+  (void)out;
+  return 0;
+}
+
+bool ToUtf16(const uint8_t *in, size_t length, uint16_t *out, size_t *written)
+{
+  if (!Validate(in, length))
+  {
+    return false;
+  }
+  // the input is valid from here, the sequences are decoded without checks
+  size_t i = 0;
+  uint16_t *start = out;
+  while (i < length)
+  {
+    size_t ascii = WidenAscii(in + i, length - i, out);
+    i += ascii;
+    out += ascii;
+    size_t end = length - i > kScalarChunk ? i + kScalarChunk : length;
+    while (i < end)
+    {
+      uint32_t lead = in[i];
+      if (lead < 0x80)
+      {
+        *out++ = static_cast<uint16_t>(lead);
+        i++;
+      }
+      else if (lead < 0xE0)
+      {
+        *out++ = static_cast<uint16_t>(((lead & 0x1F) << 6) | (in[i + 1] & 0x3F));
+        i += 2;
+      }
+      else if (lead < 0xF0)
+      {
+        *out++ = static_cast<uint16_t>(((lead & 0x0F) << 12) | ((in[i + 1] & 0x3F) << 6) | (in[i + 2] & 0x3F));
+        i += 3;
+      }
+      else
+      {
+        uint32_t cp = ((lead & 0x07) << 18) | ((in[i + 1] & 0x3F) << 12) | ((in[i + 2] & 0x3F) << 6) |
+                      (in[i + 3] & 0x3F);
+        cp -= 0x10000;
+        *out++ = static_cast<uint16_t>(0xD800 | (cp >> 10));
+        *out++ = static_cast<uint16_t>(0xDC00 | (cp & 0x3FF));
+        i += 4;
+      }
+    }
+  }
+  *written = out - start;
+  return true;
+}
+
+bool FromUtf16(const uint16_t *in, size_t length, uint8_t *out, size_t *written)
+{
+  size_t i = 0;
+  uint8_t *start = out;
+  while (i < length)
+  {
+    size_t ascii = NarrowAscii(in + i, length - i, out);
+    i += ascii;
+    out += ascii;
+    size_t end = length - i > kScalarChunk ? i + kScalarChunk : length;
+    while (i < end)
+    {
+      uint32_t c = in[i++];
+      if (c < 0x80)
+      {
+        *out++ = static_cast<uint8_t>(c);
+      }
+      else if (c < 0x800)
+      {
+        out[0] = static_cast<uint8_t>(0xC0 | (c >> 6));
+        out[1] = static_cast<uint8_t>(0x80 | (c & 0x3F));
+        out += 2;
+      }
+      else if (c < 0xD800 || c > 0xDFFF)
+      {
+        out[0] = static_cast<uint8_t>(0xE0 | (c >> 12));
+        out[1] = static_cast<uint8_t>(0x80 | ((c >> 6) & 0x3F));
+        out[2] = static_cast<uint8_t>(0x80 | (c & 0x3F));
+        out += 3;
+      }
+      else
+      {
+        // a high surrogate followed by a low surrogate, the pair may cross the end of the chunk
+        if (c > 0xDBFF || i == length || (in[i] & 0xFC00) != 0xDC00)
+        {
+          return false;
+        }
+        uint32_t cp = 0x10000 + ((c & 0x3FF) << 10) + (in[i++] & 0x3FF);
+        out[0] = static_cast<uint8_t>(0xF0 | (cp >> 18));
+        out[1] = static_cast<uint8_t>(0x80 | ((cp >> 12) & 0x3F));
+        out[2] = static_cast<uint8_t>(0x80 | ((cp >> 6) & 0x3F));
+        out[3] = static_cast<uint8_t>(0x80 | (cp & 0x3F));
+        out += 4;
+      }
+    }
+  }
+  *written = out - start;
+  return true;
+}
+
+} // namespace utf8
+} // namespace nodedata
@@ -0,0 +1,50 @@
+#ifndef __DATA_UTF8_H_
+#define __DATA_UTF8_H_
+
+// UTF-8 (RFC 3629) validation, code point counting and transcoding from and to UTF-16.
+//
+// Validation is strict: overlong forms, surrogates and code points above U+10FFFF are errors. The
+// vector kernels validate 16 or 32 bytes at once by looking up the nibbles of every byte and of
+// the byte before it in three tables, the bits of the lookups only intersect for invalid pairs
+// (the algorithm of simdjson). Transcoding converts blocks of ASCII with vectors and the other
+// blocks with the scalar code.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace nodedata
+{
+namespace utf8
+{
+
+enum Kernel
+{
+  kKernelScalar = 0,
+  kKernelSSSE3 = 1,
+  kKernelAVX2 = 2
+};
+
+bool Validate(const uint8_t *in, size_t length);
+
+// The number of code points of valid UTF-8, that is the number of bytes that are not continuation
+// bytes. The result is meaningless for invalid input.
+size_t CountCodePoints(const uint8_t *in, size_t length);
+
+// Converts to UTF-16, the output must have room for `length` code units. Returns false if the input
+// is not valid UTF-8.
+bool ToUtf16(const uint8_t *in, size_t length, uint16_t *out, size_t *written);
+
+// Converts to UTF-8, the output must have room for 3 * `length` bytes. Returns false if the input
+// has a lone surrogate.
+bool FromUtf16(const uint16_t *in, size_t length, uint8_t *out, size_t *written);
+
+// The kernel in use, SetKernel() returns false if the CPU does not support the kernel
+Kernel GetKernel();
+Kernel GetBestKernel();
+bool SetKernel(Kernel kernel);
+const char *KernelName(Kernel kernel);
+
+} // namespace utf8
+} // namespace nodedata
+
+#endif // __DATA_UTF8_H_
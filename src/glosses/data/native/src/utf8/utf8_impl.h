@@ -0,0 +1,30 @@
+#ifndef __DATA_UTF8_IMPL_H_
+#define __DATA_UTF8_IMPL_H_
+
+#include "utf8.h"
+#include "cpu.h"
+
+namespace nodedata
+{
+namespace utf8
+{
+
+#if defined(DATA_X86)
+// Validate whole blocks, the last incomplete block is padded with zeros
+bool ValidateSsse3(const uint8_t *in, size_t length);
+bool ValidateAvx2(const uint8_t *in, size_t length);
+// Count the continuation bytes of whole blocks, return the number of bytes consumed
+size_t CountContinuationsSsse3(const uint8_t *in, size_t length, size_t *count);
+size_t CountContinuationsAvx2(const uint8_t *in, size_t length, size_t *count);
+// Convert blocks up to the first block that is not ASCII, return the number of bytes or code units
+// consumed
+size_t WidenAsciiSsse3(const uint8_t *in, size_t length, uint16_t *out);
+size_t WidenAsciiAvx2(const uint8_t *in, size_t length, uint16_t *out);
+size_t NarrowAsciiSsse3(const uint16_t *in, size_t length, uint8_t *out);
+size_t NarrowAsciiAvx2(const uint16_t *in, size_t length, uint8_t *out);
+#endif
+
+} // namespace utf8
+} // namespace nodedata
+
+#endif // __DATA_UTF8_IMPL_H_
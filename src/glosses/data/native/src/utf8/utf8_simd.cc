@@ -0,0 +1,309 @@
+#include "utf8_impl.h"
+
+#include <string.h>
+
+#if defined(DATA_X86)
+
+namespace nodedata
+{
+namespace utf8
+{
+
+// the SSSE3 kernel also uses PTEST from SSE4.1
+#define SSSE3_TARGET DATA_TARGET("ssse3,sse4.1")
+#define AVX2_TARGET DATA_TARGET("avx2")
+
+// Error classes of a pair of bytes, looked up by the high nibble of the first byte, its low nibble
+// and the high nibble of the second byte. The pair is invalid if the three lookups share a bit.
+static const uint8_t kTooShort = 1 << 0;          // a lead byte followed by a lead byte or ASCII
+static const uint8_t kTooLong = 1 << 1;           // ASCII followed by a continuation byte
+static const uint8_t kOverlong3 = 1 << 2;         // E0 80..9F
+static const uint8_t kTooLarge = 1 << 3;          // F4 90..BF and F5..FF
+static const uint8_t kSurrogate = 1 << 4;         // ED A0..BF
+static const uint8_t kOverlong2 = 1 << 5;         // C0 and C1
+static const uint8_t kTooLarge1000 = 1 << 6;      // F5..FF 80..8F
+static const uint8_t kOverlong4 = 1 << 6;         // F0 80..8F
+static const uint8_t kTwoContinuations = 1 << 7;  // continuation followed by continuation
+static const uint8_t kCarry = kTooShort | kTooLong | kTwoContinuations;
+
+static const uint8_t kByte1High[16] = {
+    kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong,
+    kTwoContinuations, kTwoContinuations, kTwoContinuations, kTwoContinuations,
+    kTooShort | kOverlong2,
+    kTooShort,
+    kTooShort | kOverlong3 | kSurrogate,
+    kTooShort | kTooLarge | kTooLarge1000 | kOverlong4};
+
+static const uint8_t kByte1Low[16] = {
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+    kCarry | kOverlong2,
+    kCarry,
+    kCarry,
+    kCarry | kTooLarge,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000};
+
+static const uint8_t kByte2High[16] = {
+    kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+    kTooLong | kOverlong2 | kTwoContinuations | kOverlong3 | kTooLarge1000 | kOverlong4,
+    kTooLong | kOverlong2 | kTwoContinuations | kOverlong3 | kTooLarge,
+    kTooLong | kOverlong2 | kTwoContinuations | kSurrogate | kTooLarge,
+    kTooLong | kOverlong2 | kTwoContinuations | kSurrogate | kTooLarge,
+    kTooShort, kTooShort, kTooShort, kTooShort};
+
+// A lead byte in one of the last 3 bytes of a block that needs more bytes than are left
+static const uint8_t kIncompleteMax[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF};
+
+// SSSE3
+
+struct Ssse3Checker
+{
+  __m128i error;
+  __m128i previous;
+  __m128i incomplete;
+};
+
+SSSE3_TARGET static inline __m128i Lookup(const uint8_t table[16], __m128i nibbles)
+{
+  return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(table)), nibbles);
+}
+
+SSSE3_TARGET static inline __m128i HighNibbles(__m128i v)
+{
+  return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+}
+
+SSSE3_TARGET static inline void Check(Ssse3Checker *checker, __m128i input)
+{
+  if (_mm_movemask_epi8(input) == 0)
+  {
+    // an ASCII block only has to complete the sequence of the previous block
+    checker->error = _mm_or_si128(checker->error, checker->incomplete);
+    checker->previous = input;
+    checker->incomplete = _mm_setzero_si128();
+    return;
+  }
+  __m128i prev1 = _mm_alignr_epi8(input, checker->previous, 15);
+  __m128i special = _mm_and_si128(
+      _mm_and_si128(Lookup(kByte1High, HighNibbles(prev1)), Lookup(kByte1Low, _mm_and_si128(prev1, _mm_set1_epi8(0x0F)))),
+      Lookup(kByte2High, HighNibbles(input)));
+  // the third and fourth bytes of the 3 and 4-byte sequences must be continuation bytes, they are
+  // the only pairs of two continuation bytes that are valid
+  __m128i prev2 = _mm_alignr_epi8(input, checker->previous, 14);
+  __m128i prev3 = _mm_alignr_epi8(input, checker->previous, 13);
+  __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+  __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+  __m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+  checker->error = _mm_or_si128(checker->error, _mm_xor_si128(must23, special));
+  checker->previous = input;
+  checker->incomplete =
+      _mm_subs_epu8(input, _mm_loadu_si128(reinterpret_cast<const __m128i *>(kIncompleteMax + 16)));
+}
+
+SSSE3_TARGET bool ValidateSsse3(const uint8_t *in, size_t length)
+{
+  Ssse3Checker checker = {_mm_setzero_si128(), _mm_setzero_si128(), _mm_setzero_si128()};
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16)
+  {
+    Check(&checker, _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)));
+  }
+  // the last bytes are padded with zeros, at least one of them follows the data and ends an
+  // incomplete sequence as ASCII would
+  uint8_t last[16] = {0};
+  memcpy(last, in + i, length - i);
+  Check(&checker, _mm_loadu_si128(reinterpret_cast<const __m128i *>(last)));
+  return _mm_testz_si128(checker.error, checker.error) != 0;
+}
+
+SSSE3_TARGET size_t CountContinuationsSsse3(const uint8_t *in, size_t length, size_t *count)
+{
+  size_t i = 0;
+  size_t total = 0;
+  while (i + 16 <= length)
+  {
+    // the byte counters overflow after 255 blocks
+    size_t end = length - i > 255 * 16 ? i + 255 * 16 : length;
+    __m128i counters = _mm_setzero_si128();
+    for (; i + 16 <= end; i += 16)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+      // 0x80..0xBF are the signed bytes below -64
+      counters = _mm_sub_epi8(counters, _mm_cmpgt_epi8(_mm_set1_epi8(-64), v));
+    }
+    __m128i sums = _mm_sad_epu8(counters, _mm_setzero_si128());
+    total += static_cast<size_t>(_mm_cvtsi128_si32(sums)) + static_cast<size_t>(_mm_extract_epi16(sums, 4));
+  }
+  *count += total;
+  return i;
+}
+
+SSSE3_TARGET size_t WidenAsciiSsse3(const uint8_t *in, size_t length, uint16_t *out)
+{
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    if (_mm_movemask_epi8(v) != 0)
+    {
+      break;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_unpacklo_epi8(v, _mm_setzero_si128()));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i + 8), _mm_unpackhi_epi8(v, _mm_setzero_si128()));
+  }
+  return i;
+}
+
+SSSE3_TARGET size_t NarrowAsciiSsse3(const uint16_t *in, size_t length, uint8_t *out)
+{
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16)
+  {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i + 8));
+    if (!_mm_testz_si128(_mm_or_si128(a, b), _mm_set1_epi16(static_cast<short>(0xFF80))))
+    {
+      break;
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(a, b));
+  }
+  return i;
+}
+
+// AVX2, the same steps on 32 bytes. The previous bytes cross the two lanes.
+
+struct Avx2Checker
+{
+  __m256i error;
+  __m256i previous;
+  __m256i incomplete;
+};
+
+AVX2_TARGET static inline __m256i Lookup(const uint8_t table[16], __m256i nibbles)
+{
+  return _mm256_shuffle_epi8(
+      _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(table))), nibbles);
+}
+
+AVX2_TARGET static inline __m256i HighNibbles(__m256i v)
+{
+  return _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+}
+
+template <int N>
+AVX2_TARGET static inline __m256i Previous(__m256i input, __m256i previous)
+{
+  // the high lane of the previous block followed by the low lane of the input
+  return _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), 16 - N);
+}
+
+AVX2_TARGET static inline void Check(Avx2Checker *checker, __m256i input)
+{
+  if (_mm256_movemask_epi8(input) == 0)
+  {
+    checker->error = _mm256_or_si256(checker->error, checker->incomplete);
+    checker->previous = input;
+    checker->incomplete = _mm256_setzero_si256();
+    return;
+  }
+  __m256i prev1 = Previous<1>(input, checker->previous);
+  __m256i special = _mm256_and_si256(
+      _mm256_and_si256(Lookup(kByte1High, HighNibbles(prev1)),
+                       Lookup(kByte1Low, _mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)))),
+      Lookup(kByte2High, HighNibbles(input)));
+  __m256i prev2 = Previous<2>(input, checker->previous);
+  __m256i prev3 = Previous<3>(input, checker->previous);
+  __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+  __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+  __m256i must23 = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8(static_cast<char>(0x80)));
+  checker->error = _mm256_or_si256(checker->error, _mm256_xor_si256(must23, special));
+  checker->previous = input;
+  checker->incomplete =
+      _mm256_subs_epu8(input, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(kIncompleteMax)));
+}
+
+AVX2_TARGET bool ValidateAvx2(const uint8_t *in, size_t length)
+{
+  Avx2Checker checker = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32)
+  {
+    Check(&checker, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i)));
+  }
+  uint8_t last[32] = {0};
+  memcpy(last, in + i, length - i);
+  Check(&checker, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(last)));
+  return _mm256_testz_si256(checker.error, checker.error) != 0;
+}
+
+AVX2_TARGET size_t CountContinuationsAvx2(const uint8_t *in, size_t length, size_t *count)
+{
+  size_t i = 0;
+  size_t total = 0;
+  while (i + 32 <= length)
+  {
+    size_t end = length - i > 255 * 32 ? i + 255 * 32 : length;
+    __m256i counters = _mm256_setzero_si256();
+    for (; i + 32 <= end; i += 32)
+    {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+      counters = _mm256_sub_epi8(counters, _mm256_cmpgt_epi8(_mm256_set1_epi8(-64), v));
+    }
+    __m256i sums = _mm256_sad_epu8(counters, _mm256_setzero_si256());
+    __m128i lanes = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+    total += static_cast<size_t>(_mm_cvtsi128_si32(lanes)) + static_cast<size_t>(_mm_extract_epi16(lanes, 4));
+  }
+  *count += total;
+  return i;
+}
+
+AVX2_TARGET size_t WidenAsciiAvx2(const uint8_t *in, size_t length, uint16_t *out)
+{
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32)
+  {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    if (_mm256_movemask_epi8(v) != 0)
+    {
+      break;
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i + 16),
+                        _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+  }
+  return i;
+}
+
+AVX2_TARGET size_t NarrowAsciiAvx2(const uint16_t *in, size_t length, uint8_t *out)
+{
+  size_t i = 0;
+  for (; i + 32 <= length; i += 32)
+  {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(in + i + 16));
+    if (!_mm256_testz_si256(_mm256_or_si256(a, b), _mm256_set1_epi16(static_cast<short>(0xFF80))))
+    {
+      break;
+    }
+    // the packing interleaves the lanes of the two vectors
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), packed);
+  }
+  return i;
+}
+
+} // namespace utf8
+} // namespace nodedata
+
+#endif // DATA_X86
@@ -0,0 +1,131 @@
+#include "data.h"
+#include "varint/varint.h"
+
+#include <adone_trace.h>
+
+#include <stdio.h>  // snprintf
+#include <string.h> // strcmp
+
+namespace nodedata
+{
+
+// varintEncodeAll(values, zigzag), values is an Uint32Array or a BigUint64Array, or an Int32Array
+// or a BigInt64Array for zigzag. Returns the varints as a Buffer.
+NAN_METHOD(VarintEncodeAll)
+{
+  v8::Local<v8::Value> values = info[0];
+  bool zigzag = Nan::To<bool>(info[1]).FromJust();
+  bool wide = zigzag ? values->IsBigInt64Array() : values->IsBigUint64Array();
+  if (!wide && !(zigzag ? values->IsInt32Array() : values->IsUint32Array()))
+  {
+    return Nan::ThrowTypeError(zigzag ? "Values must be an Int32Array or a BigInt64Array"
+                                      : "Values must be an Uint32Array or a BigUint64Array");
+  }
+  v8::Local<v8::Object> output;
+  if (wide)
+  {
+    Nan::TypedArrayContents<uint64_t> view(values);
+    size_t length = varint::EncodedLength64(*view, view.length(), zigzag);
+    output = Nan::NewBuffer(static_cast<uint32_t>(length)).ToLocalChecked();
+    ADONE_TRACE_SCOPE("data", "varint:encode");
+    varint::Encode64(*view, view.length(), zigzag, reinterpret_cast<uint8_t *>(node::Buffer::Data(output)), length);
+  }
+  else
+  {
+    Nan::TypedArrayContents<uint32_t> view(values);
+    size_t length = varint::EncodedLength32(*view, view.length(), zigzag);
+    output = Nan::NewBuffer(static_cast<uint32_t>(length)).ToLocalChecked();
+    ADONE_TRACE_SCOPE("data", "varint:encode");
+    varint::Encode32(*view, view.length(), zigzag, reinterpret_cast<uint8_t *>(node::Buffer::Data(output)), length);
+  }
+  info.GetReturnValue().Set(output);
+}
+
+// varintDecodeAll(bytes, bigint, zigzag), returns an Uint32Array, or a BigUint64Array if bigint is
+// set, and their signed counterparts for zigzag. Throws a RangeError if the last varint is truncated
+// or if a varint does not fit in the elements.
+NAN_METHOD(VarintDecodeAll)
+{
+  const uint8_t *data;
+  size_t length;
+  if (!GetBytes(info[0], &data, &length))
+  {
+    return Nan::ThrowTypeError("Input must be a Buffer or an Uint8Array");
+  }
+  bool wide = Nan::To<bool>(info[1]).FromJust();
+  bool zigzag = Nan::To<bool>(info[2]).FromJust();
+  size_t count;
+  if (!varint::Count(data, length, &count))
+  {
+    return Nan::ThrowRangeError("Could not decode varint");
+  }
+  v8::Isolate *isolate = v8::Isolate::GetCurrent();
+  v8::Local<v8::ArrayBuffer> buffer = v8::ArrayBuffer::New(isolate, count * (wide ? 8 : 4));
+  v8::Local<v8::TypedArray> result;
+  if (wide)
+  {
+    result = zigzag ? v8::Local<v8::TypedArray>(v8::BigInt64Array::New(buffer, 0, count))
+                    : v8::Local<v8::TypedArray>(v8::BigUint64Array::New(buffer, 0, count));
+  }
+  else
+  {
+    result = zigzag ? v8::Local<v8::TypedArray>(v8::Int32Array::New(buffer, 0, count))
+                    : v8::Local<v8::TypedArray>(v8::Uint32Array::New(buffer, 0, count));
+  }
+  bool valid;
+  size_t errorOffset = 0;
+  {
+    ADONE_TRACE_SCOPE("data", "varint:decode");
+    if (wide)
+    {
+      Nan::TypedArrayContents<uint64_t> view(result);
+      valid = varint::Decode64(data, length, *view, count, zigzag, &errorOffset);
+    }
+    else
+    {
+      Nan::TypedArrayContents<uint32_t> view(result);
+      valid = varint::Decode32(data, length, *view, count, zigzag, &errorOffset);
+    }
+  }
+  if (!valid)
+  {
+    char message[80];
+    snprintf(message, sizeof(message), "Varint at offset %zu does not fit in %d bits", errorOffset, wide ? 64 : 32);
+    return Nan::ThrowRangeError(message);
+  }
+  info.GetReturnValue().Set(result);
+}
+
+NAN_METHOD(GetVarintKernel)
+{
+  v8::Local<v8::Object> result = Nan::New<v8::Object>();
+  Nan::Set(result, NanStr("active"), NanStr(varint::KernelName(varint::GetKernel())));
+  Nan::Set(result, NanStr("best"), NanStr(varint::KernelName(varint::GetBestKernel())));
+  info.GetReturnValue().Set(result);
+}
+
+// setKernel(name), returns false if the kernel is unknown or the CPU does not support it
+NAN_METHOD(SetVarintKernel)
+{
+  Nan::Utf8String name(info[0]);
+  static const varint::Kernel kernels[] = {varint::kKernelScalar, varint::kKernelSSSE3};
+  for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++)
+  {
+    if (*name != NULL && strcmp(*name, varint::KernelName(kernels[i])) == 0)
+    {
+      info.GetReturnValue().Set(varint::SetKernel(kernels[i]));
+      return;
+    }
+  }
+  info.GetReturnValue().Set(false);
+}
+
+NAN_MODULE_INIT(InitVarint)
+{
+  Nan::SetMethod(target, "varintEncodeAll", VarintEncodeAll);
+  Nan::SetMethod(target, "varintDecodeAll", VarintDecodeAll);
+  Nan::SetMethod(target, "varintGetKernel", GetVarintKernel);
+  Nan::SetMethod(target, "varintSetKernel", SetVarintKernel);
+}
+
+} // namespace nodedata
@@ -0,0 +1,241 @@
+#include "varint_impl.h"
+
+#include <atomic>
+#include <string.h>
+
+namespace nodedata
+{
+namespace varint
+{
+
+Kernel GetBestKernel()
+{
+  const CpuFeatures &cpu = GetCpuFeatures();
+  return cpu.ssse3 && cpu.sse41 ? kKernelSSSE3 : kKernelScalar;
+}
+
+static std::atomic<int> kernel(-1);
+
+Kernel GetKernel()
+{
+  int current = kernel.load(std::memory_order_relaxed);
+  if (current < 0)
+  {
+    current = GetBestKernel();
+    kernel.store(current, std::memory_order_relaxed);
+  }
+  return static_cast<Kernel>(current);
+}
+
+bool SetKernel(Kernel value)
+{
+  if (value > GetBestKernel())
+  {
+    return false;
+  }
+  kernel.store(value, std::memory_order_relaxed);
+  return true;
+}
+
+const char *KernelName(Kernel value)
+{
+  return value == kKernelSSSE3 ? "ssse3" : "scalar";
+}
+
+bool Count(const uint8_t *in, size_t length, size_t *count)
+{
+  if (length > 0 && in[length - 1] >= 0x80)
+  {
+    return false;
+  }
+  size_t n = 0;
+  for (size_t i = 0; i < length; i++)
+  {
+    n += in[i] < 0x80;
+  }
+  *count = n;
+  return true;
+}
+
+// A terminated varint starts at `p`, returns false if it does not fit in 32 bits
+static inline bool DecodeOne32(const uint8_t *&p, uint32_t *value)
+{
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35; shift += 7)
+  {
+    uint32_t b = *p++;
+    result |= (b & 0x7F) << shift;
+    if (b < 0x80)
+    {
+      *value = result;
+      return shift < 28 || b <= 0x0F;
+    }
+  }
+  return false;
+}
+
+static inline bool DecodeOne64(const uint8_t *&p, uint64_t *value)
+{
+  uint64_t result = 0;
+  for (int shift = 0; shift < 70; shift += 7)
+  {
+    uint64_t b = *p++;
+    result |= (b & 0x7F) << shift;
+    if (b < 0x80)
+    {
+      *value = result;
+      return shift < 63 || b <= 0x01;
+    }
+  }
+  return false;
+}
+
+bool Decode32(const uint8_t *in, size_t length, uint32_t *out, size_t count, bool zigzag, size_t *errorOffset)
+{
+  size_t i = 0;
+  size_t n = 0;
+#if defined(DATA_X86)
+  if (GetKernel() == kKernelSSSE3)
+  {
+    i = DecodeBlocks32Ssse3(in, length, out, count, zigzag, &n);
+  }
+#endif
+  const uint8_t *p = in + i;
+  for (; n < count; n++)
+  {
+    const uint8_t *start = p;
+    uint32_t value;
+    if (!DecodeOne32(p, &value))
+    {
+      *errorOffset = start - in;
+      return false;
+    }
+    out[n] = zigzag ? ZigzagDecode32(value) : value;
+  }
+  return true;
+}
+
+bool Decode64(const uint8_t *in, size_t length, uint64_t *out, size_t count, bool zigzag, size_t *errorOffset)
+{
+  size_t i = 0;
+  size_t n = 0;
+#if defined(DATA_X86)
+  if (GetKernel() == kKernelSSSE3)
+  {
+    i = DecodeBlocks64Ssse3(in, length, out, count, zigzag, &n);
+  }
+#endif
+  const uint8_t *p = in + i;
+  for (; n < count; n++)
+  {
+    const uint8_t *start = p;
+    uint64_t value;
+    if (!DecodeOne64(p, &value))
+    {
+      *errorOffset = start - in;
+      return false;
+    }
+    out[n] = zigzag ? ZigzagDecode64(value) : value;
+  }
+  return true;
+}
+
+static inline uint32_t ZigzagEncode32(uint32_t v)
+{
+  return (v << 1) ^ (0 - (v >> 31));
+}
+
+static inline uint64_t ZigzagEncode64(uint64_t v)
+{
+  return (v << 1) ^ (0 - (v >> 63));
+}
+
+// Comparisons instead of branches or bit scans, so that the sums of lengths vectorize and the
+// lengths of random values cost no mispredictions
+static inline size_t Length32(uint32_t v)
+{
+  return 1 + (v >= (1u << 7)) + (v >= (1u << 14)) + (v >= (1u << 21)) + (v >= (1u << 28));
+}
+
+static inline size_t Length64(uint64_t v)
+{
+  size_t n = 1;
+  for (int shift = 7; shift < 64; shift += 7)
+  {
+    n += v >= (static_cast<uint64_t>(1) << shift);
+  }
+  return n;
+}
+
+size_t EncodedLength32(const uint32_t *values, size_t count, bool zigzag)
+{
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    total += Length32(zigzag ? ZigzagEncode32(values[i]) : values[i]);
+  }
+  return total;
+}
+
+size_t EncodedLength64(const uint64_t *values, size_t count, bool zigzag)
+{
+  size_t total = 0;
+  for (size_t i = 0; i < count; i++)
+  {
+    total += Length64(zigzag ? ZigzagEncode64(values[i]) : values[i]);
+  }
+  return total;
+}
+
+// Writes a varint of at most 5 bytes with a single 8-byte store, the output must have room for it
+static inline uint8_t *EncodeWide32(uint32_t v, uint8_t *out)
+{
+  size_t length = Length32(v);
+  // the 7-bit groups spread to the bytes, with the continuation bits of all but the last one
+  uint64_t w = (v & 0x7F) | (static_cast<uint64_t>(v & 0x3F80) << 1) | (static_cast<uint64_t>(v & 0x1FC000) << 2) |
+               (static_cast<uint64_t>(v & 0xFE00000) << 3) | (static_cast<uint64_t>(v & 0xF0000000) << 4);
+  w |= 0x8080808080ull & ((static_cast<uint64_t>(1) << (8 * (length - 1))) - 1);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  memcpy(out, &w, 8);
+#else
+  for (int i = 0; i < 8; i++)
+  {
+    out[i] = static_cast<uint8_t>(w >> (8 * i));
+  }
+#endif
+  return out + length;
+}
+
+static inline uint8_t *EncodeOne64(uint64_t v, uint8_t *out)
+{
+  while (v >= 0x80)
+  {
+    *out++ = static_cast<uint8_t>(v) | 0x80;
+    v >>= 7;
+  }
+  *out++ = static_cast<uint8_t>(v);
+  return out;
+}
+
+void Encode32(const uint32_t *values, size_t count, bool zigzag, uint8_t *out, size_t length)
+{
+  uint8_t *end = out + length;
+  for (size_t i = 0; i < count; i++)
+  {
+    uint32_t v = zigzag ? ZigzagEncode32(values[i]) : values[i];
+    out = end - out >= 8 ? EncodeWide32(v, out) : EncodeOne64(v, out);
+  }
+}
+
+void Encode64(const uint64_t *values, size_t count, bool zigzag, uint8_t *out, size_t length)
+{
+  uint8_t *end = out + length;
+  for (size_t i = 0; i < count; i++)
+  {
+    uint64_t v = zigzag ? ZigzagEncode64(values[i]) : values[i];
+    out = v <= 0xFFFFFFFF && end - out >= 8 ? EncodeWide32(static_cast<uint32_t>(v), out) : EncodeOne64(v, out);
+  }
+}
+
+} // namespace varint
+} // namespace nodedata
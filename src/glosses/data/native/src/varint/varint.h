@@ -0,0 +1,50 @@
+#ifndef __DATA_VARINT_H_
+#define __DATA_VARINT_H_
+
+// Batches of unsigned LEB128 varints (protobuf, multiformats), with the zigzag mapping of signed
+// values as an option.
+//
+// Decoding is masked-VByte: the continuation bits of 16 bytes are gathered with PMOVMSKB, when no
+// byte has one the 16 values are widened at once, otherwise the terminators of the first 8 bytes
+// select a shuffle that spreads up to 4 varints of at most 4 bytes into 32-bit lanes, where their
+// 7-bit groups are joined with shifts. Longer varints and the last bytes go through the scalar code.
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace nodedata
+{
+namespace varint
+{
+
+enum Kernel
+{
+  kKernelScalar = 0,
+  kKernelSSSE3 = 1
+};
+
+// The number of varints, or false if the last one is truncated
+bool Count(const uint8_t *in, size_t length, size_t *count);
+
+// Decode `count` varints, counted by Count(). Return false if a varint does not fit in the type,
+// with the offset of its first byte in `errorOffset`.
+bool Decode32(const uint8_t *in, size_t length, uint32_t *out, size_t count, bool zigzag, size_t *errorOffset);
+bool Decode64(const uint8_t *in, size_t length, uint64_t *out, size_t count, bool zigzag, size_t *errorOffset);
+
+// The length of the encoding and the encoding, signed values are read from the same words when
+// `zigzag` is set
+size_t EncodedLength32(const uint32_t *values, size_t count, bool zigzag);
+size_t EncodedLength64(const uint64_t *values, size_t count, bool zigzag);
+void Encode32(const uint32_t *values, size_t count, bool zigzag, uint8_t *out, size_t length);
+void Encode64(const uint64_t *values, size_t count, bool zigzag, uint8_t *out, size_t length);
+
+// The kernel in use, the same conventions as base64::SetKernel()
+Kernel GetKernel();
+Kernel GetBestKernel();
+bool SetKernel(Kernel kernel);
+const char *KernelName(Kernel kernel);
+
+} // namespace varint
+} // namespace nodedata
+
+#endif // __DATA_VARINT_H_
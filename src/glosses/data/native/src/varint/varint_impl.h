@@ -0,0 +1,35 @@
+#ifndef __DATA_VARINT_IMPL_H_
+#define __DATA_VARINT_IMPL_H_
+
+#include "varint.h"
+#include "cpu.h"
+
+namespace nodedata
+{
+namespace varint
+{
+
+static inline uint32_t ZigzagDecode32(uint32_t v)
+{
+  return (v >> 1) ^ (0 - (v & 1));
+}
+
+static inline uint64_t ZigzagDecode64(uint64_t v)
+{
+  return (v >> 1) ^ (0 - (v & 1));
+}
+
+// Decode blocks of 16 bytes while they and the room for 16 values are available, return the number
+// of bytes consumed and add the decoded values to `written`. A varint that does not fit in 32 bits
+// stops the kernel, the scalar code reports it.
+#if defined(DATA_X86)
+size_t DecodeBlocks32Ssse3(const uint8_t *in, size_t length, uint32_t *out, size_t capacity, bool zigzag,
+                           size_t *written);
+size_t DecodeBlocks64Ssse3(const uint8_t *in, size_t length, uint64_t *out, size_t capacity, bool zigzag,
+                           size_t *written);
+#endif
+
+} // namespace varint
+} // namespace nodedata
+
+#endif // __DATA_VARINT_IMPL_H_
@@ -0,0 +1,191 @@
+#include "varint_impl.h"
+
+#if defined(DATA_X86)
+
+namespace nodedata
+{
+namespace varint
+{
+
+#define SSSE3_TARGET DATA_TARGET("ssse3,sse4.1")
+
+// What the terminators of 8 bytes (the bytes without continuation bit) give: the number of
+// varints of at most 4 bytes that end in them (up to 4), the bytes they take and the shuffle that
+// moves every one into a 32-bit lane
+struct ShuffleTable
+{
+  struct Entry
+  {
+    // aligned so that loading it never splits a cache line
+    alignas(16) uint8_t shuffle[16];
+    uint8_t count;
+    uint8_t consumed;
+  } entries[256];
+
+  ShuffleTable()
+  {
+    for (int mask = 0; mask < 256; mask++)
+    {
+      Entry &entry = entries[mask];
+      entry.count = 0;
+      entry.consumed = 0;
+      for (int i = 0; i < 16; i++)
+      {
+        entry.shuffle[i] = 0x80;
+      }
+      int start = 0;
+      for (int i = 0; i < 8 && entry.count < 4; i++)
+      {
+        if (!(mask & (1 << i)))
+        {
+          continue;
+        }
+        if (i - start + 1 > 4)
+        {
+          break;
+        }
+        for (int j = start; j <= i; j++)
+        {
+          entry.shuffle[entry.count * 4 + (j - start)] = static_cast<uint8_t>(j);
+        }
+        entry.count++;
+        start = i + 1;
+      }
+      entry.consumed = static_cast<uint8_t>(start);
+    }
+  }
+};
+
+static const ShuffleTable kShuffles;
+
+// The values of up to 4 varints of at most 4 bytes spread in the lanes
+SSSE3_TARGET static inline __m128i Join(__m128i lanes)
+{
+  __m128i t = _mm_and_si128(lanes, _mm_set1_epi8(0x7F));
+  // the high byte of every 16 bits goes 1 bit down, then the high half of every 32 bits 2 bits down
+  __m128i x = _mm_or_si128(_mm_and_si128(t, _mm_set1_epi32(0x007F007F)),
+                           _mm_srli_epi16(_mm_and_si128(t, _mm_set1_epi32(0x7F007F00)), 1));
+  return _mm_or_si128(_mm_and_si128(x, _mm_set1_epi32(0x0000FFFF)),
+                      _mm_srli_epi32(_mm_and_si128(x, _mm_set1_epi32(static_cast<int>(0xFFFF0000))), 2));
+}
+
+SSSE3_TARGET static inline __m128i Zigzag(__m128i v)
+{
+  return _mm_xor_si128(_mm_srli_epi32(v, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(v, _mm_set1_epi32(1))));
+}
+
+// Stores 4 values of 32 bits
+SSSE3_TARGET static inline void Store4(uint32_t *out, __m128i v, bool)
+{
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(out), v);
+}
+
+// Stores 4 values widened to 64 bits, zigzag values are sign extended
+SSSE3_TARGET static inline void Store4(uint64_t *out, __m128i v, bool zigzag)
+{
+  __m128i lo = zigzag ? _mm_cvtepi32_epi64(v) : _mm_cvtepu32_epi64(v);
+  __m128i hi = zigzag ? _mm_cvtepi32_epi64(_mm_srli_si128(v, 8)) : _mm_cvtepu32_epi64(_mm_srli_si128(v, 8));
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(out), lo);
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 2), hi);
+}
+
+// One varint, returns false if it does not fit
+static inline bool DecodeLong(const uint8_t *&p, uint32_t *value, bool zigzag)
+{
+  uint32_t result = 0;
+  for (int shift = 0; shift < 35; shift += 7)
+  {
+    uint32_t b = *p++;
+    result |= (b & 0x7F) << shift;
+    if (b < 0x80)
+    {
+      *value = zigzag ? ZigzagDecode32(result) : result;
+      return shift < 28 || b <= 0x0F;
+    }
+  }
+  return false;
+}
+
+static inline bool DecodeLong(const uint8_t *&p, uint64_t *value, bool zigzag)
+{
+  uint64_t result = 0;
+  for (int shift = 0; shift < 70; shift += 7)
+  {
+    uint64_t b = *p++;
+    result |= (b & 0x7F) << shift;
+    if (b < 0x80)
+    {
+      *value = zigzag ? ZigzagDecode64(result) : result;
+      return shift < 63 || b <= 0x01;
+    }
+  }
+  return false;
+}
+
+// 16 varints of one byte
+template <typename T>
+SSSE3_TARGET static inline void DecodeBytes(__m128i v, T *out, bool zigzag)
+{
+  for (int k = 0; k < 4; k++)
+  {
+    __m128i values = _mm_cvtepu8_epi32(v);
+    Store4(out + 4 * k, zigzag ? Zigzag(values) : values, zigzag);
+    v = _mm_srli_si128(v, 4);
+  }
+}
+
+template <typename T>
+SSSE3_TARGET static inline size_t DecodeBlocks(const uint8_t *in, size_t length, T *out, size_t capacity, bool zigzag,
+                                               size_t *written)
+{
+  size_t done = 0;
+  size_t n = *written;
+  while (done + 16 <= length && n + 16 <= capacity)
+  {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + done));
+    unsigned continuation = static_cast<unsigned>(_mm_movemask_epi8(v));
+    if (continuation == 0)
+    {
+      DecodeBytes(v, out + n, zigzag);
+      n += 16;
+      done += 16;
+      continue;
+    }
+    const ShuffleTable::Entry &entry = kShuffles.entries[~continuation & 0xFF];
+    if (entry.count == 0)
+    {
+      // a varint longer than 4 bytes, the last byte of the input ends a varint so it is terminated
+      const uint8_t *p = in + done;
+      if (!DecodeLong(p, out + n, zigzag))
+      {
+        break;
+      }
+      n++;
+      done = p - in;
+      continue;
+    }
+    __m128i values = Join(_mm_shuffle_epi8(v, _mm_load_si128(reinterpret_cast<const __m128i *>(entry.shuffle))));
+    Store4(out + n, zigzag ? Zigzag(values) : values, zigzag);
+    n += entry.count;
+    done += entry.consumed;
+  }
+  *written = n;
+  return done;
+}
+
+SSSE3_TARGET size_t DecodeBlocks32Ssse3(const uint8_t *in, size_t length, uint32_t *out, size_t capacity,
+                                        bool zigzag, size_t *written)
+{
+  return DecodeBlocks(in, length, out, capacity, zigzag, written);
+}
+
+SSSE3_TARGET size_t DecodeBlocks64Ssse3(const uint8_t *in, size_t length, uint64_t *out, size_t capacity,
+                                        bool zigzag, size_t *written)
+{
+  return DecodeBlocks(in, length, out, capacity, zigzag, written);
+}
+
+} // namespace varint
+} // namespace nodedata
+
+#endif // DATA_X86
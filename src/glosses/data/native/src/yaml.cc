@@ -0,0 +1,47 @@
+#include "data.h"
+#include "yaml/converter.h"
+
+#include <adone_trace.h>
+
+#include <string>
+
+namespace nodedata
+{
+
+// yamlToJson(text, duplicates), returns the JSON text of the YAML document, or undefined if the
+// converter does not read it (yaml/converter.h) and data/yaml/loader.js has to load it
+NAN_METHOD(YamlToJson)
+{
+  Text text;
+  if (!text.Get(info[0]))
+  {
+    return Nan::ThrowTypeError("Input must be a string or a Buffer");
+  }
+  // Text copies these strings one byte per character
+  bool latin1 = info[0]->IsString() && info[0].As<v8::String>()->IsOneByte();
+  std::string json;
+  bool converted;
+  {
+    ADONE_TRACE_SCOPE("data", "yaml:convert");
+    yaml::Converter converter(text.data, text.length, latin1, Nan::To<bool>(info[1]).FromJust());
+    converted = converter.Convert(&json);
+  }
+  if (!converted || json.size() > static_cast<size_t>(v8::String::kMaxLength))
+  {
+    return;
+  }
+  v8::Local<v8::String> result;
+  bool created = latin1 ? Nan::NewOneByteString(reinterpret_cast<const uint8_t *>(json.data()), static_cast<int>(json.size())).ToLocal(&result)
+                        : Nan::New<v8::String>(json.data(), static_cast<int>(json.size())).ToLocal(&result);
+  if (created)
+  {
+    info.GetReturnValue().Set(result);
+  }
+}
+
+NAN_MODULE_INIT(InitYaml)
+{
+  Nan::SetMethod(target, "yamlToJson", YamlToJson);
+}
+
+} // namespace nodedata
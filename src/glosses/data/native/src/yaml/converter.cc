@@ -0,0 +1,1448 @@
+#include "converter.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace nodedata
+{
+namespace yaml
+{
+
+// Deeper documents are left to the loader
+static const size_t kMaxDepth = 256;
+
+// The integers are exact up to 2^53, the loader rounds the larger ones the way parseInt() does
+static const uint64_t kMaxSafeInteger = 9007199254740992ULL;
+static const size_t kMaxDecimalDigits = 15;
+
+// The mappings with up to this many keys are checked for duplicates without sorting the keys
+static const size_t kMaxPairwiseKeys = 16;
+
+enum Chomping
+{
+  kChompingClip,
+  kChompingStrip,
+  kChompingKeep
+};
+
+enum Resolved
+{
+  kResolvedString,
+  kResolvedNull,
+  kResolvedTrue,
+  kResolvedFalse,
+  kResolvedInteger,
+  kResolvedFloat,
+  // a type the converter does not produce
+  kResolvedOther
+};
+
+static inline bool IsBreak(uint8_t c)
+{
+  return c == '\n' || c == 0;
+}
+
+static inline bool IsSpaceOrBreak(uint8_t c)
+{
+  return c == ' ' || IsBreak(c);
+}
+
+static inline bool IsFlowIndicator(uint8_t c)
+{
+  return c == ',' || c == '[' || c == ']' || c == '{' || c == '}';
+}
+
+static inline bool IsDigit(uint8_t c)
+{
+  return c >= '0' && c <= '9';
+}
+
+static inline int HexValue(uint8_t c)
+{
+  if (IsDigit(c))
+  {
+    return c - '0';
+  }
+  c |= 0x20;
+  return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+static inline bool Equals(const uint8_t *s, size_t n, const char *word)
+{
+  return n == strlen(word) && memcmp(s, word, n) == 0;
+}
+
+static void AppendDecimal(std::string *out, uint64_t value)
+{
+  char digits[20];
+  size_t n = 0;
+  do
+  {
+    digits[n++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  while (n > 0)
+  {
+    out->push_back(digits[--n]);
+  }
+}
+
+// The integers of type/int.js. Returns kResolvedString if the scalar is not one.
+static Resolved ResolveInteger(const uint8_t *s, size_t n, std::string *number)
+{
+  size_t i = 0;
+  bool negative = false;
+  if (s[0] == '-' || s[0] == '+')
+  {
+    negative = s[0] == '-';
+    i++;
+  }
+  if (i == n)
+  {
+    return kResolvedString;
+  }
+  uint64_t value = 0;
+  if (s[i] == '0')
+  {
+    if (i + 1 == n)
+    {
+      // -0 is 0
+      number->push_back('0');
+      return kResolvedInteger;
+    }
+    unsigned base = 8;
+    i++;
+    if (s[i] == 'b' || s[i] == 'x')
+    {
+      base = s[i] == 'b' ? 2 : 16;
+      i++;
+    }
+    bool hasDigits = false;
+    for (; i < n; i++)
+    {
+      if (s[i] == '_')
+      {
+        continue;
+      }
+      int digit = base == 16 ? HexValue(s[i]) : (IsDigit(s[i]) ? s[i] - '0' : -1);
+      if (digit < 0 || static_cast<unsigned>(digit) >= base)
+      {
+        return kResolvedString;
+      }
+      value = value * base + digit;
+      if (value > kMaxSafeInteger)
+      {
+        return kResolvedOther;
+      }
+      hasDigits = true;
+    }
+    if (!hasDigits || s[n - 1] == '_')
+    {
+      return kResolvedString;
+    }
+  }
+  else
+  {
+    if (s[i] == '_')
+    {
+      return kResolvedString;
+    }
+    size_t digits = 0;
+    for (; i < n; i++)
+    {
+      if (s[i] == '_')
+      {
+        continue;
+      }
+      if (s[i] == ':')
+      {
+        // sexagesimal
+        return kResolvedOther;
+      }
+      if (!IsDigit(s[i]))
+      {
+        return kResolvedString;
+      }
+      if (++digits > kMaxDecimalDigits)
+      {
+        return kResolvedOther;
+      }
+      value = value * 10 + (s[i] - '0');
+    }
+    if (digits == 0 || s[n - 1] == '_')
+    {
+      return kResolvedString;
+    }
+  }
+  // sign * value, so -0 for the other bases
+  if (negative)
+  {
+    number->push_back('-');
+  }
+  AppendDecimal(number, value);
+  return kResolvedInteger;
+}
+
+// The floats of type/float.js, written as JSON numbers. Returns kResolvedString if the scalar is
+// not one.
+static Resolved ResolveFloat(const uint8_t *s, size_t n, std::string *number)
+{
+  if (s[n - 1] == '_')
+  {
+    return kResolvedString;
+  }
+  size_t i = 0;
+  bool sign = s[0] == '-' || s[0] == '+';
+  if (sign)
+  {
+    if (s[0] == '-')
+    {
+      number->push_back('-');
+    }
+    if (++i == n)
+    {
+      return kResolvedString;
+    }
+  }
+  if (s[i] == '.')
+  {
+    // .inf and .nan are not JSON numbers
+    const uint8_t *rest = s + i + 1;
+    size_t restLength = n - i - 1;
+    if (Equals(rest, restLength, "inf") || Equals(rest, restLength, "Inf") || Equals(rest, restLength, "INF") ||
+        (!sign && (Equals(rest, restLength, "nan") || Equals(rest, restLength, "NaN") || Equals(rest, restLength, "NAN"))))
+    {
+      return kResolvedOther;
+    }
+    // .2e4 has no sign
+    if (sign || restLength == 0 || !(IsDigit(rest[0]) || rest[0] == '_'))
+    {
+      return kResolvedString;
+    }
+    number->push_back('0');
+  }
+  else if (s[i] == '0')
+  {
+    number->push_back('0');
+    i++;
+  }
+  else if (s[i] >= '1' && s[i] <= '9')
+  {
+    for (; i < n && (IsDigit(s[i]) || s[i] == '_'); i++)
+    {
+      if (s[i] != '_')
+      {
+        number->push_back(static_cast<char>(s[i]));
+      }
+    }
+  }
+  else
+  {
+    return kResolvedString;
+  }
+  if (i < n && s[i] == '.')
+  {
+    size_t point = number->size();
+    number->push_back('.');
+    for (i++; i < n && (IsDigit(s[i]) || s[i] == '_'); i++)
+    {
+      if (s[i] != '_')
+      {
+        number->push_back(static_cast<char>(s[i]));
+      }
+    }
+    if (number->size() == point + 1)
+    {
+      // parseFloat(".") is NaN
+      if (s[0] == '.')
+      {
+        return kResolvedOther;
+      }
+      number->resize(point);
+    }
+  }
+  if (i < n && (s[i] == 'e' || s[i] == 'E'))
+  {
+    number->push_back('e');
+    if (++i < n && (s[i] == '-' || s[i] == '+'))
+    {
+      number->push_back(static_cast<char>(s[i++]));
+    }
+    if (i == n)
+    {
+      return kResolvedString;
+    }
+    for (; i < n && IsDigit(s[i]); i++)
+    {
+      number->push_back(static_cast<char>(s[i]));
+    }
+  }
+  return i == n ? kResolvedFloat : kResolvedString;
+}
+
+// Resolves a plain scalar the way the implicit types are tried by the loader: null, bool, int and
+// float, then timestamp and merge, that the converter leaves to the loader.
+static Resolved Resolve(const uint8_t *s, size_t n, std::string *number)
+{
+  switch (s[0])
+  {
+  case '~':
+    return n == 1 ? kResolvedNull : kResolvedString;
+  case 'n':
+  case 'N':
+    return Equals(s, n, "null") || Equals(s, n, "Null") || Equals(s, n, "NULL") ? kResolvedNull : kResolvedString;
+  case 't':
+  case 'T':
+    return Equals(s, n, "true") || Equals(s, n, "True") || Equals(s, n, "TRUE") ? kResolvedTrue : kResolvedString;
+  case 'f':
+  case 'F':
+    return Equals(s, n, "false") || Equals(s, n, "False") || Equals(s, n, "FALSE") ? kResolvedFalse : kResolvedString;
+  case '<':
+    return n == 2 && s[1] == '<' ? kResolvedOther : kResolvedString;
+  case '-':
+  case '+':
+  case '.':
+  case '0':
+  case '1':
+  case '2':
+  case '3':
+  case '4':
+  case '5':
+  case '6':
+  case '7':
+  case '8':
+  case '9':
+    break;
+  default:
+    return kResolvedString;
+  }
+  number->clear();
+  Resolved resolved = ResolveInteger(s, n, number);
+  if (resolved != kResolvedString)
+  {
+    return resolved;
+  }
+  number->clear();
+  resolved = ResolveFloat(s, n, number);
+  if (resolved != kResolvedString)
+  {
+    return resolved;
+  }
+  // sexagesimal floats and timestamps
+  if (memchr(s, ':', n) != NULL ||
+      (n >= 5 && IsDigit(s[0]) && IsDigit(s[1]) && IsDigit(s[2]) && IsDigit(s[3]) && s[4] == '-'))
+  {
+    return kResolvedOther;
+  }
+  return kResolvedString;
+}
+
+static inline uint32_t Hash(const char *s, size_t n)
+{
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < n; i++)
+  {
+    hash = (hash ^ static_cast<uint8_t>(s[i])) * 16777619u;
+  }
+  return hash;
+}
+
+Converter::Converter(const uint8_t *data, size_t length, bool latin1, bool duplicates)
+    : data(data), length(length), latin1(latin1), duplicates(duplicates), out(NULL), pos(0), lineStart(0),
+      indent(-1), depth(0), documentStart(SIZE_MAX)
+{
+}
+
+bool Converter::Convert(std::string *output)
+{
+  out = output;
+  out->reserve(length + length / 4);
+  size_t start = 0;
+  // the byte order mark is skipped
+  if (!latin1 && length >= 3 && data[0] == 0xEF && data[1] == 0xBB && data[2] == 0xBF)
+  {
+    start = 3;
+  }
+  SkipLines(start);
+  if (indent == 0 && At(pos) == '%')
+  {
+    return false;
+  }
+  if (indent == 0 && At(pos) == '-' && At(pos + 1) == '-' && At(pos + 2) == '-' && IsSpaceOrBreak(At(pos + 3)))
+  {
+    documentStart = lineStart;
+    pos += 3;
+    if (!EndLine())
+    {
+      return false;
+    }
+  }
+  // the empty documents are undefined or null
+  if (indent < 0 || !Validate(start))
+  {
+    return false;
+  }
+  // the node at the top ends the document
+  return BlockNode(indent, indent) && indent < 0;
+}
+
+// Checks that the text has no character the loader rejects or reads differently, and no document
+// marker other than the "---" the document starts with
+bool Converter::Validate(size_t from)
+{
+  const uint8_t *end = data + length;
+  const uint8_t *p = data + from;
+  if (IsMarker(p, end))
+  {
+    return false;
+  }
+  while (p < end)
+  {
+    uint8_t c = *p++;
+    // printable ASCII
+    if (static_cast<uint8_t>(c - 0x20) < 0x5F)
+    {
+      continue;
+    }
+    if (c == '\n')
+    {
+      if (IsMarker(p, end))
+      {
+        return false;
+      }
+    }
+    else if (c < 0x80)
+    {
+      return false;
+    }
+    else if (latin1)
+    {
+      // C1 controls
+      if (c < 0xA0)
+      {
+        return false;
+      }
+    }
+    else if ((c == 0xC2 && p < end && p[0] < 0xA0) ||
+             // U+FFFD, the lone surrogates of strings are written as it, U+FFFE and U+FFFF
+             (c == 0xEF && end - p >= 2 && p[0] == 0xBF && p[1] >= 0xBD))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Whether the line at `p` starts with a document marker other than the "---" of the document
+bool Converter::IsMarker(const uint8_t *p, const uint8_t *end) const
+{
+  uint8_t c = p < end ? *p : 0;
+  return (c == '-' || c == '.') && end - p >= 3 && p[1] == c && p[2] == c &&
+         (end - p == 3 || p[3] == ' ' || p[3] == '\n') && static_cast<size_t>(p - data) != documentStart;
+}
+
+// Moves to the first character of the first line from `from` that is neither blank nor a comment,
+// or to the end
+void Converter::SkipLines(size_t from)
+{
+  pos = from;
+  for (;;)
+  {
+    lineStart = pos;
+    while (At(pos) == ' ')
+    {
+      pos++;
+    }
+    uint8_t c = At(pos);
+    if (c == '#')
+    {
+      const void *lineEnd = memchr(data + pos, '\n', length - pos);
+      pos = lineEnd != NULL ? static_cast<const uint8_t *>(lineEnd) - data : length;
+      c = At(pos);
+    }
+    if (c == 0)
+    {
+      pos = length;
+      indent = -1;
+      return;
+    }
+    if (c != '\n')
+    {
+      indent = static_cast<int64_t>(pos - lineStart);
+      return;
+    }
+    pos++;
+  }
+}
+
+// Skips the spaces and the comment after a node, and moves to the next line with content. Returns
+// false if something else follows the node on its line.
+bool Converter::EndLine()
+{
+  while (At(pos) == ' ')
+  {
+    pos++;
+  }
+  if (At(pos) == '#')
+  {
+    while (!IsBreak(At(pos)))
+    {
+      pos++;
+    }
+  }
+  if (pos < length && data[pos] != '\n')
+  {
+    return false;
+  }
+  SkipLines(pos < length ? pos + 1 : length);
+  return true;
+}
+
+// A node at `column` of the line where block collections may start
+bool Converter::BlockNode(int64_t column, int64_t flowIndent)
+{
+  if (At(pos) == '-' && IsSpaceOrBreak(At(pos + 1)))
+  {
+    return Sequence(column);
+  }
+  Scalar key;
+  size_t next;
+  if (ReadKey(pos, &key, &next))
+  {
+    return Mapping(column, key, next);
+  }
+  return InlineNode(flowIndent);
+}
+
+bool Converter::Mapping(int64_t column, Scalar key, size_t next)
+{
+  if (++depth > kMaxDepth)
+  {
+    return false;
+  }
+  size_t first = keys.size();
+  out->push_back('{');
+  for (;;)
+  {
+    if (!WriteKey(key))
+    {
+      return false;
+    }
+    out->push_back(':');
+    pos = next;
+    if (!Value(column))
+    {
+      return false;
+    }
+    if (indent < column)
+    {
+      break;
+    }
+    // a more indented line, or a line that is not a mapping entry, is an error
+    if (indent > column || !ReadKey(pos, &key, &next))
+    {
+      return false;
+    }
+    out->push_back(',');
+  }
+  out->push_back('}');
+  depth--;
+  return CheckKeys(first);
+}
+
+// The value of an entry of the mapping at `mappingIndent`, from after the ':'
+bool Converter::Value(int64_t mappingIndent)
+{
+  while (At(pos) == ' ')
+  {
+    pos++;
+  }
+  uint8_t c = At(pos);
+  if (c != '#' && !IsBreak(c))
+  {
+    return InlineNode(mappingIndent + 1);
+  }
+  EndLine();
+  if (indent > mappingIndent)
+  {
+    return BlockNode(indent, mappingIndent + 1);
+  }
+  // the sequences may have the indentation of the mapping
+  if (indent == mappingIndent && At(pos) == '-' && IsSpaceOrBreak(At(pos + 1)))
+  {
+    return Sequence(indent);
+  }
+  out->append("null");
+  return true;
+}
+
+bool Converter::Sequence(int64_t column)
+{
+  if (++depth > kMaxDepth)
+  {
+    return false;
+  }
+  out->push_back('[');
+  for (;;)
+  {
+    pos++;
+    while (At(pos) == ' ')
+    {
+      pos++;
+    }
+    uint8_t c = At(pos);
+    if (c != '#' && !IsBreak(c))
+    {
+      // a compact collection may start after the "- "
+      if (!BlockNode(static_cast<int64_t>(pos - lineStart), column + 1))
+      {
+        return false;
+      }
+    }
+    else
+    {
+      EndLine();
+      if (indent <= column)
+      {
+        out->append("null");
+      }
+      else if (!BlockNode(indent, column + 1))
+      {
+        return false;
+      }
+    }
+    if (indent < column)
+    {
+      break;
+    }
+    if (indent > column)
+    {
+      return false;
+    }
+    if (!(At(pos) == '-' && IsSpaceOrBreak(At(pos + 1))))
+    {
+      break;
+    }
+    out->push_back(',');
+  }
+  out->push_back(']');
+  depth--;
+  return true;
+}
+
+// A node that is not a block collection, in a block collection: a flow collection, or a scalar.
+// Moves to the next line with content.
+bool Converter::InlineNode(int64_t flowIndent)
+{
+  Scalar scalar;
+  switch (At(pos))
+  {
+  case '[':
+  case '{':
+    return Flow(flowIndent) && EndLine();
+  case '|':
+  case '>':
+    return BlockScalar(flowIndent);
+  case '\'':
+  case '"':
+    return ReadQuoted(&scalar) && WriteString(scalar) && EndLine();
+  default:
+    return ReadPlain(flowIndent, false, &scalar) && WriteValue(scalar) && EndLine();
+  }
+}
+
+// readBlockScalar() of the loader
+bool Converter::BlockScalar(int64_t nodeIndent)
+{
+  // at the top, the end of the text is not the end of the scalar for the loader
+  if (nodeIndent < 1)
+  {
+    return false;
+  }
+  bool folding = data[pos] == '>';
+  Chomping chomping = kChompingClip;
+  bool detectedIndent = false;
+  int64_t textIndent = nodeIndent;
+  for (;;)
+  {
+    uint8_t c = At(++pos);
+    if (c == '+' || c == '-')
+    {
+      if (chomping != kChompingClip)
+      {
+        return false;
+      }
+      chomping = c == '+' ? kChompingKeep : kChompingStrip;
+    }
+    else if (IsDigit(c))
+    {
+      if (c == '0' || detectedIndent)
+      {
+        return false;
+      }
+      textIndent = nodeIndent + (c - '0') - 1;
+      detectedIndent = true;
+    }
+    else
+    {
+      break;
+    }
+  }
+  if (At(pos) == ' ')
+  {
+    while (At(pos) == ' ')
+    {
+      pos++;
+    }
+    if (At(pos) == '#')
+    {
+      while (!IsBreak(At(pos)))
+      {
+        pos++;
+      }
+    }
+  }
+  if (!IsBreak(At(pos)))
+  {
+    return false;
+  }
+  out->push_back('"');
+  bool didReadContent = false;
+  bool atMoreIndented = false;
+  size_t emptyLines = 0;
+  for (;;)
+  {
+    if (pos < length)
+    {
+      pos++;
+    }
+    lineStart = pos;
+    int64_t lineIndent = 0;
+    uint8_t c = At(pos);
+    while ((!detectedIndent || lineIndent < textIndent) && c == ' ')
+    {
+      lineIndent++;
+      c = At(++pos);
+    }
+    if (!detectedIndent && lineIndent > textIndent)
+    {
+      textIndent = lineIndent;
+    }
+    // the loader adds a line break to the text that does not end with one
+    if (c == '\n' || (c == 0 && lineIndent > 0))
+    {
+      emptyLines++;
+      continue;
+    }
+    size_t breaks;
+    if (lineIndent < textIndent)
+    {
+      if (chomping == kChompingKeep)
+      {
+        breaks = didReadContent ? 1 + emptyLines : emptyLines;
+      }
+      else
+      {
+        breaks = chomping == kChompingClip && didReadContent ? 1 : 0;
+      }
+      for (; breaks > 0; breaks--)
+      {
+        out->append("\\n");
+      }
+      break;
+    }
+    if (!folding)
+    {
+      breaks = didReadContent ? 1 + emptyLines : emptyLines;
+    }
+    else if (c == ' ')
+    {
+      // the more indented lines are not folded
+      atMoreIndented = true;
+      breaks = didReadContent ? 1 + emptyLines : emptyLines;
+    }
+    else if (atMoreIndented)
+    {
+      atMoreIndented = false;
+      breaks = emptyLines + 1;
+    }
+    else if (emptyLines == 0)
+    {
+      breaks = 0;
+      if (didReadContent)
+      {
+        out->push_back(' ');
+      }
+    }
+    else
+    {
+      breaks = emptyLines;
+    }
+    for (; breaks > 0; breaks--)
+    {
+      out->append("\\n");
+    }
+    didReadContent = true;
+    detectedIndent = true;
+    emptyLines = 0;
+    size_t start = pos;
+    const void *lineEnd = memchr(data + pos, '\n', length - pos);
+    pos = lineEnd != NULL ? static_cast<const uint8_t *>(lineEnd) - data : length;
+    WriteText(start, pos);
+  }
+  out->push_back('"');
+  SkipLines(lineStart);
+  return true;
+}
+
+bool Converter::Flow(int64_t nodeIndent)
+{
+  if (++depth > kMaxDepth)
+  {
+    return false;
+  }
+  bool mapping = data[pos] == '{';
+  uint8_t terminator = mapping ? '}' : ']';
+  size_t first = keys.size();
+  out->push_back(static_cast<char>(data[pos++]));
+  bool readNext = true;
+  bool empty = true;
+  for (;;)
+  {
+    FlowSpace();
+    uint8_t c = At(pos);
+    if (c == terminator)
+    {
+      pos++;
+      break;
+    }
+    if (!readNext)
+    {
+      return false;
+    }
+    if (!empty)
+    {
+      out->push_back(',');
+    }
+    empty = false;
+    size_t line = lineStart;
+    if (mapping)
+    {
+      Scalar key;
+      if (!FlowScalar(nodeIndent, &key))
+      {
+        return false;
+      }
+      FlowSpace();
+      if (!WriteKey(key))
+      {
+        return false;
+      }
+      out->push_back(':');
+      if (At(pos) == ':')
+      {
+        // a ':' on the next lines is an error
+        if (lineStart != line)
+        {
+          return false;
+        }
+        pos++;
+        FlowSpace();
+        c = At(pos);
+        if (c == ',' || c == terminator)
+        {
+          out->append("null");
+        }
+        else if (!FlowNode(nodeIndent))
+        {
+          return false;
+        }
+      }
+      else
+      {
+        out->append("null");
+      }
+    }
+    else if (!FlowNode(nodeIndent))
+    {
+      return false;
+    }
+    FlowSpace();
+    // the pairs of sequences are single pair mappings
+    if (At(pos) == ':')
+    {
+      return false;
+    }
+    readNext = At(pos) == ',';
+    if (readNext)
+    {
+      pos++;
+    }
+  }
+  out->push_back(static_cast<char>(terminator));
+  depth--;
+  return !mapping || CheckKeys(first);
+}
+
+bool Converter::FlowNode(int64_t nodeIndent)
+{
+  uint8_t c = At(pos);
+  if (c == '[' || c == '{')
+  {
+    return Flow(nodeIndent);
+  }
+  Scalar scalar;
+  return FlowScalar(nodeIndent, &scalar) && WriteValue(scalar);
+}
+
+bool Converter::FlowScalar(int64_t nodeIndent, Scalar *scalar)
+{
+  uint8_t c = At(pos);
+  if (c == '\'' || c == '"')
+  {
+    return ReadQuoted(scalar);
+  }
+  return ReadPlain(nodeIndent, true, scalar);
+}
+
+// The spaces, comments and line breaks in flow collections
+void Converter::FlowSpace()
+{
+  for (;;)
+  {
+    uint8_t c = At(pos);
+    if (c == ' ')
+    {
+      pos++;
+    }
+    else if (c == '#')
+    {
+      while (!IsBreak(At(pos)))
+      {
+        pos++;
+      }
+    }
+    else if (c == '\n')
+    {
+      lineStart = ++pos;
+    }
+    else
+    {
+      return;
+    }
+  }
+}
+
+// Reads the key of a mapping entry at `from`, a quoted or plain scalar followed by a ':' and a space
+// on its line. Returns false if the line does not start with one, `next` is after the ':'.
+bool Converter::ReadKey(size_t from, Scalar *key, size_t *next) const
+{
+  size_t p = from;
+  uint8_t c = At(p);
+  key->start = p;
+  if (c == '\'' || c == '"')
+  {
+    key->style = c;
+    for (p++;; p++)
+    {
+      uint8_t d = At(p);
+      if (IsBreak(d))
+      {
+        return false;
+      }
+      if (d == '\\' && c == '"')
+      {
+        p++;
+        if (IsBreak(At(p)))
+        {
+          return false;
+        }
+      }
+      else if (d == c)
+      {
+        if (c == '\'' && At(p + 1) == '\'')
+        {
+          p++;
+          continue;
+        }
+        break;
+      }
+    }
+    key->end = ++p;
+    while (At(p) == ' ')
+    {
+      p++;
+    }
+    if (At(p) != ':' || !IsSpaceOrBreak(At(p + 1)))
+    {
+      return false;
+    }
+  }
+  else
+  {
+    if (IsSpaceOrBreak(c) || IsFlowIndicator(c) || strchr("#&*!|>'\"%@`", c) != NULL ||
+        ((c == '?' || c == '-') && IsSpaceOrBreak(At(p + 1))))
+    {
+      return false;
+    }
+    key->style = 0;
+    key->end = p + 1;
+    for (p++;; p++)
+    {
+      uint8_t d = At(p);
+      if (IsBreak(d) || (d == '#' && data[p - 1] == ' '))
+      {
+        return false;
+      }
+      if (d == ':' && IsSpaceOrBreak(At(p + 1)))
+      {
+        break;
+      }
+      if (d != ' ')
+      {
+        key->end = p + 1;
+      }
+    }
+  }
+  *next = p + 1;
+  return true;
+}
+
+// readPlainScalar() of the loader for the scalars that end on their line
+bool Converter::ReadPlain(int64_t nodeIndent, bool flow, Scalar *scalar)
+{
+  size_t p = pos;
+  uint8_t c = At(p);
+  if (IsSpaceOrBreak(c) || IsFlowIndicator(c) || strchr("#&*!|>'\"%@`", c) != NULL)
+  {
+    return false;
+  }
+  if ((c == '?' || c == '-') && (IsSpaceOrBreak(At(p + 1)) || (flow && IsFlowIndicator(At(p + 1)))))
+  {
+    return false;
+  }
+  scalar->start = p;
+  scalar->end = p;
+  scalar->style = 0;
+  for (;; p++)
+  {
+    c = At(p);
+    if (c == ':')
+    {
+      uint8_t next = At(p + 1);
+      if (IsSpaceOrBreak(next) || (flow && IsFlowIndicator(next)))
+      {
+        break;
+      }
+    }
+    else if (c == '#')
+    {
+      if (p > scalar->start && data[p - 1] == ' ')
+      {
+        break;
+      }
+    }
+    else if (flow && IsFlowIndicator(c))
+    {
+      break;
+    }
+    else if (IsBreak(c))
+    {
+      if (Continues(p, nodeIndent, flow))
+      {
+        return false;
+      }
+      break;
+    }
+    if (c != ' ')
+    {
+      scalar->end = p + 1;
+    }
+  }
+  pos = p;
+  return scalar->end > scalar->start;
+}
+
+// Reads a quoted scalar that ends on its line
+bool Converter::ReadQuoted(Scalar *scalar)
+{
+  uint8_t quote = data[pos];
+  scalar->start = pos;
+  scalar->style = quote;
+  for (size_t p = pos + 1;; p++)
+  {
+    uint8_t c = At(p);
+    if (IsBreak(c))
+    {
+      return false;
+    }
+    if (c == '\\' && quote == '"')
+    {
+      if (IsBreak(At(++p)))
+      {
+        return false;
+      }
+    }
+    else if (c == quote)
+    {
+      if (quote == '\'' && At(p + 1) == '\'')
+      {
+        p++;
+        continue;
+      }
+      scalar->end = pos = p + 1;
+      return true;
+    }
+  }
+}
+
+// Whether the plain scalar that ends at the line break at `from` goes on on the next lines for the
+// loader: the next line that is not blank is indented enough and does not end it
+bool Converter::Continues(size_t from, int64_t nodeIndent, bool flow) const
+{
+  size_t p = from;
+  while (p < length)
+  {
+    size_t start = ++p;
+    while (At(p) == ' ')
+    {
+      p++;
+    }
+    uint8_t c = At(p);
+    if (c == '\n')
+    {
+      continue;
+    }
+    if (c == 0 || static_cast<int64_t>(p - start) < nodeIndent)
+    {
+      return false;
+    }
+    return !(c == '#' || (flow && (c == ',' || c == ']' || c == '}')));
+  }
+  return false;
+}
+
+// Writes a key as the loader converts it to a property name
+bool Converter::WriteKey(const Scalar &key)
+{
+  size_t start = out->size();
+  if (key.style != 0)
+  {
+    if (!WriteString(key))
+    {
+      return false;
+    }
+  }
+  else
+  {
+    std::string number;
+    switch (Resolve(data + key.start, key.end - key.start, &number))
+    {
+    case kResolvedString:
+      WriteString(key);
+      break;
+    case kResolvedNull:
+      out->append("\"null\"");
+      break;
+    case kResolvedTrue:
+      out->append("\"true\"");
+      break;
+    case kResolvedFalse:
+      out->append("\"false\"");
+      break;
+    case kResolvedInteger:
+      out->push_back('"');
+      // String(-0) is "0"
+      out->append(number == "-0" ? "0" : number);
+      out->push_back('"');
+      break;
+    default:
+      return false;
+    }
+  }
+  Key written = {start + 1, out->size() - start - 2, 0};
+  // the loader sets the prototype of the mapping
+  if (written.length == 9 && out->compare(written.start, written.length, "__proto__") == 0)
+  {
+    return false;
+  }
+  if (!duplicates)
+  {
+    written.hash = Hash(out->data() + written.start, written.length);
+    keys.push_back(written);
+  }
+  return true;
+}
+
+bool Converter::WriteValue(const Scalar &scalar)
+{
+  if (scalar.style != 0)
+  {
+    return WriteString(scalar);
+  }
+  std::string number;
+  switch (Resolve(data + scalar.start, scalar.end - scalar.start, &number))
+  {
+  case kResolvedString:
+    return WriteString(scalar);
+  case kResolvedNull:
+    out->append("null");
+    return true;
+  case kResolvedTrue:
+    out->append("true");
+    return true;
+  case kResolvedFalse:
+    out->append("false");
+    return true;
+  case kResolvedInteger:
+  case kResolvedFloat:
+    out->append(number);
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool Converter::WriteString(const Scalar &scalar)
+{
+  out->push_back('"');
+  if (scalar.style == 0)
+  {
+    WriteText(scalar.start, scalar.end);
+  }
+  else
+  {
+    size_t end = scalar.end - 1;
+    size_t run = scalar.start + 1;
+    for (size_t p = run; p < end;)
+    {
+      if (scalar.style == '\'' && data[p] == '\'')
+      {
+        // '' is a quote
+        WriteText(run, p + 1);
+        run = p += 2;
+      }
+      else if (scalar.style == '"' && data[p] == '\\')
+      {
+        WriteText(run, p);
+        if (!WriteEscape(&p))
+        {
+          return false;
+        }
+        run = p;
+      }
+      else
+      {
+        p++;
+      }
+    }
+    WriteText(run, end);
+  }
+  out->push_back('"');
+  return true;
+}
+
+// Writes the escape sequence at `from` of a double quoted scalar and moves after it
+bool Converter::WriteEscape(size_t *from)
+{
+  size_t p = *from + 1;
+  uint8_t c = data[p++];
+  uint32_t code;
+  size_t hexLength = 0;
+  switch (c)
+  {
+  case '0':
+    code = 0x00;
+    break;
+  case 'a':
+    code = 0x07;
+    break;
+  case 'b':
+    code = 0x08;
+    break;
+  case 't':
+    code = 0x09;
+    break;
+  case 'n':
+    code = 0x0A;
+    break;
+  case 'v':
+    code = 0x0B;
+    break;
+  case 'f':
+    code = 0x0C;
+    break;
+  case 'r':
+    code = 0x0D;
+    break;
+  case 'e':
+    code = 0x1B;
+    break;
+  case ' ':
+  case '"':
+  case '/':
+  case '\\':
+    code = c;
+    break;
+  case 'N':
+    code = 0x85;
+    break;
+  case '_':
+    code = 0xA0;
+    break;
+  case 'L':
+    code = 0x2028;
+    break;
+  case 'P':
+    code = 0x2029;
+    break;
+  case 'x':
+    hexLength = 2;
+    break;
+  case 'u':
+    hexLength = 4;
+    break;
+  case 'U':
+    hexLength = 8;
+    break;
+  default:
+    return false;
+  }
+  if (hexLength != 0)
+  {
+    code = 0;
+    for (; hexLength > 0; hexLength--)
+    {
+      int digit = HexValue(At(p++));
+      if (digit < 0)
+      {
+        return false;
+      }
+      code = code << 4 | digit;
+    }
+  }
+  *from = p;
+  return WriteCodePoint(code);
+}
+
+// Writes a character of an escape sequence. The surrogates are left to the loader, a string may have
+// them escaped one by one or not.
+bool Converter::WriteCodePoint(uint32_t c)
+{
+  static const char kHex[] = "0123456789abcdef";
+  if ((c >= 0xD800 && c <= 0xDFFF) || c > 0x10FFFF)
+  {
+    return false;
+  }
+  if (c == '"' || c == '\\')
+  {
+    out->push_back('\\');
+    out->push_back(static_cast<char>(c));
+  }
+  else if (c < 0x20 || (latin1 && c > 0xFF))
+  {
+    // the strings of latin1 texts have no other character, so these ones are always escaped
+    uint32_t units[2] = {c, 0};
+    size_t count = 1;
+    if (c > 0xFFFF)
+    {
+      units[0] = 0xD800 + ((c - 0x10000) >> 10);
+      units[1] = 0xDC00 + ((c - 0x10000) & 0x3FF);
+      count = 2;
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+      char escape[6] = {'\\', 'u', kHex[units[i] >> 12], kHex[(units[i] >> 8) & 0xF], kHex[(units[i] >> 4) & 0xF],
+                        kHex[units[i] & 0xF]};
+      out->append(escape, 6);
+    }
+  }
+  else if (c < 0x80 || latin1)
+  {
+    out->push_back(static_cast<char>(c));
+  }
+  else if (c < 0x800)
+  {
+    out->push_back(static_cast<char>(0xC0 | c >> 6));
+    out->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+  }
+  else if (c < 0x10000)
+  {
+    out->push_back(static_cast<char>(0xE0 | c >> 12));
+    out->push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+  }
+  else
+  {
+    out->push_back(static_cast<char>(0xF0 | c >> 18));
+    out->push_back(static_cast<char>(0x80 | ((c >> 12) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | ((c >> 6) & 0x3F)));
+    out->push_back(static_cast<char>(0x80 | (c & 0x3F)));
+  }
+  return true;
+}
+
+// Writes the bytes of the text as the content of a JSON string, the text has no control character
+void Converter::WriteText(size_t start, size_t end)
+{
+  size_t run = start;
+  for (size_t p = start; p < end; p++)
+  {
+    uint8_t c = data[p];
+    if (c == '"' || c == '\\')
+    {
+      out->append(reinterpret_cast<const char *>(data) + run, p - run);
+      out->push_back('\\');
+      run = p;
+    }
+  }
+  out->append(reinterpret_cast<const char *>(data) + run, end - run);
+}
+
+bool Converter::SameKey(const Key &a, const Key &b) const
+{
+  return a.length == b.length && out->compare(a.start, a.length, *out, b.start, b.length) == 0;
+}
+
+// Checks the keys of a mapping written from `first` for duplicates, and forgets them. The keys of
+// small mappings are compared pairwise, the ones of larger mappings are sorted by their hash first
+bool Converter::CheckKeys(size_t first)
+{
+  size_t count = keys.size() - first;
+  bool unique = true;
+  if (count > 1 && count <= kMaxPairwiseKeys)
+  {
+    for (size_t i = first; unique && i < keys.size(); i++)
+    {
+      for (size_t j = i + 1; j < keys.size(); j++)
+      {
+        if (keys[i].hash == keys[j].hash && SameKey(keys[i], keys[j]))
+        {
+          unique = false;
+          break;
+        }
+      }
+    }
+  }
+  else if (count > 1)
+  {
+    std::vector<Key>::iterator begin = keys.begin() + first;
+    std::sort(begin, keys.end(), [](const Key &a, const Key &b) { return a.hash < b.hash; });
+    for (std::vector<Key>::iterator it = begin; unique && it + 1 != keys.end(); ++it)
+    {
+      for (std::vector<Key>::iterator other = it + 1; other != keys.end() && other->hash == it->hash; ++other)
+      {
+        if (SameKey(*it, *other))
+        {
+          unique = false;
+          break;
+        }
+      }
+    }
+  }
+  keys.resize(first);
+  return unique;
+}
+
+} // namespace yaml
+} // namespace nodedata
@@ -0,0 +1,104 @@
+#ifndef __DATA_YAML_CONVERTER_H_
+#define __DATA_YAML_CONVERTER_H_
+
+// Converter of YAML documents to the JSON text of the same value, that data/yaml/loader.js parses
+// with JSON.parse(). It reads the part of YAML configuration files use: block mappings and
+// sequences, flow collections, plain, quoted and block scalars, and comments. The plain scalars
+// are resolved the way the implicit types of the core schema (data/yaml/type) resolve them.
+//
+// Anything else makes the conversion fail, and the JavaScript loader loads the document: tags,
+// anchors and aliases, explicit keys, directives and streams of several documents, the plain
+// scalars that are timestamps, merge keys, infinities or NaN, multi-line plain and quoted scalars,
+// tabs, carriage returns and non-printable characters. So does any error, the loader reports it.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace nodedata
+{
+namespace yaml
+{
+
+class Converter
+{
+public:
+  // `latin1` if the text has a byte per character (a string of characters up to U+00FF), it is
+  // UTF-8 otherwise. Duplicate keys make the conversion fail unless `duplicates` is true (the json
+  // option of the loader), the last value is kept then.
+  Converter(const uint8_t *data, size_t length, bool latin1, bool duplicates);
+
+  // Returns false if the document is not one the converter reads, `out` is the JSON text otherwise
+  bool Convert(std::string *out);
+
+private:
+  // A scalar of a line, from the first to after the last character (the quotes are included)
+  struct Scalar
+  {
+    size_t start;
+    size_t end;
+    // 0 for plain scalars, or the quote
+    uint8_t style;
+  };
+
+  // A key written to the output, to find the duplicates
+  struct Key
+  {
+    size_t start;
+    size_t length;
+    uint32_t hash;
+  };
+
+  bool Validate(size_t from);
+  bool IsMarker(const uint8_t *p, const uint8_t *end) const;
+  void SkipLines(size_t from);
+  bool EndLine();
+  bool BlockNode(int64_t column, int64_t flowIndent);
+  bool Mapping(int64_t column, Scalar key, size_t next);
+  bool Value(int64_t mappingIndent);
+  bool Sequence(int64_t column);
+  bool InlineNode(int64_t flowIndent);
+  bool BlockScalar(int64_t nodeIndent);
+  bool Flow(int64_t nodeIndent);
+  bool FlowNode(int64_t nodeIndent);
+  bool FlowScalar(int64_t nodeIndent, Scalar *scalar);
+  void FlowSpace();
+  bool ReadKey(size_t from, Scalar *key, size_t *next) const;
+  bool ReadPlain(int64_t nodeIndent, bool flow, Scalar *scalar);
+  bool ReadQuoted(Scalar *scalar);
+  bool Continues(size_t from, int64_t nodeIndent, bool flow) const;
+  bool WriteKey(const Scalar &key);
+  bool WriteValue(const Scalar &scalar);
+  bool WriteString(const Scalar &scalar);
+  bool WriteEscape(size_t *from);
+  bool WriteCodePoint(uint32_t c);
+  void WriteText(size_t start, size_t end);
+  bool SameKey(const Key &a, const Key &b) const;
+  bool CheckKeys(size_t first);
+
+  uint8_t At(size_t pos) const
+  {
+    return pos < length ? data[pos] : 0;
+  }
+
+  const uint8_t *data;
+  size_t length;
+  bool latin1;
+  bool duplicates;
+  std::string *out;
+  size_t pos;
+  size_t lineStart;
+  // the indentation of the line at `pos`, -1 at the end
+  int64_t indent;
+  size_t depth;
+  // the start of the line of the "---" of the document, if it has one
+  size_t documentStart;
+  std::vector<Key> keys;
+};
+
+} // namespace yaml
+} // namespace nodedata
+
+#endif // __DATA_YAML_CONVERTER_H_
@@ -0,0 +1,60 @@
+const {
+    is,
+    data: { varint }
+} = adone;
+
+// Decodes a stream of length-delimited messages. The bytes after the last whole message are not consumed,
+// decodeMany.bytes is the number of bytes of the messages decoded.
+//
+// bulk(buf, offset, end), if given, decodes the first messages natively and returns
+// { messages, bytes, stopped }, stopped is true if the next message is left to the JavaScript decoder.
+const compileDecodeMany = function (exports, bulk) {
+    return function decodeMany(buf, offset, end) {
+        if (is.nil(offset)) {
+            offset = 0;
+        }
+
+        if (is.nil(end)) {
+            end = buf.length;
+        }
+
+        const oldOffset = offset;
+        let messages = [];
+
+        while (offset < end) {
+            if (bulk) {
+                const result = bulk(buf, offset, end);
+                if (messages.length === 0) {
+                    messages = result.messages;
+                } else {
+                    for (let i = 0; i < result.messages.length; i++) {
+                        messages.push(result.messages[i]);
+                    }
+                }
+                offset += result.bytes;
+                if (!result.stopped) {
+                    break;
+                }
+            }
+
+            let len;
+            try {
+                len = varint.decode(buf, offset);
+            } catch (err) {
+                // incomplete length
+                break;
+            }
+            const start = offset + varint.decode.bytes;
+            if (start + len > end) {
+                break;
+            }
+            messages.push(exports.decode(buf, start, start + len));
+            offset = start + len;
+        }
+
+        decodeMany.bytes = offset - oldOffset;
+        return messages;
+    };
+};
+
+module.exports = compileDecodeMany;
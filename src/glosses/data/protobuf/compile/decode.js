@@ -63,6 +63,18 @@ const defaultValue = function (f, def) {
     }
 };
 
+// The value of a field that is not in the message, values are the values of an enum field
+const fieldDefault = function (field, def, values) {
+    if (values) { // is enum
+        if (field.repeated) {
+            return [];
+        }
+        def = (def && values[def]) ? values[def].value : values[Object.keys(values)[0]].value;
+        return parseInt(def || 0, 10);
+    }
+    return defaultValue(field, def);
+};
+
 const compileDecode = function (m, resolve, enc) {
     const requiredFields = [];
     const fields = {};
@@ -189,16 +201,7 @@ const compileDecode = function (m, resolve, enc) {
                         continue;
                     }
 
-                    if (val) { // is enum
-                        if (field.repeated) {
-                            obj[name] = [];
-                        } else {
-                            def = (def && val[def]) ? val[def].value : val[Object.keys(val)[0]].value;
-                            obj[name] = parseInt(def || 0, 10);
-                        }
-                    } else {
-                        obj[name] = defaultValue(field, def);
-                    }
+                    obj[name] = fieldDefault(field, def, val);
                 }
 
                 decode.bytes = offset - oldOffset;
@@ -234,4 +237,6 @@ const compileDecode = function (m, resolve, enc) {
     };
 };
 
+compileDecode.fieldDefault = fieldDefault;
+
 module.exports = compileDecode;
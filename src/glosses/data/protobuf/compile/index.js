@@ -2,6 +2,8 @@ const encodings = require("./encodings");
 const compileDecode = require("./decode");
 const compileEncode = require("./encode");
 const compileEncodingLength = require("./encoding-length");
+const compileDecodeMany = require("./decode-many");
+const compileNative = require("./native");
 
 const {
     data: { varint }
@@ -18,10 +20,12 @@ const flatten = function (values) {
     return result;
 };
 
-export default function (schema, extraEncodings) {
+// native: encode and decode the messages with the table-driven codec of the data addon when it is built
+export default function (schema, extraEncodings, native) {
     const messages = {};
     const enums = {};
     const cache = {};
+    const compiled = [];
 
     const visit = function (schema, prefix) {
         if (schema.enums) {
@@ -176,11 +180,19 @@ export default function (schema, extraEncodings) {
         exports.encode = encode;
         exports.decode = decode;
         exports.encodingLength = encodingLength;
+        exports.decodeMany = compileDecodeMany(exports);
 
+        compiled.push({ m, exports, enc });
         return exports;
     };
 
-    return (schema.enums || []).concat((schema.messages || []).map((message) => {
+    const result = (schema.enums || []).concat((schema.messages || []).map((message) => {
         return resolve(message.id);
     }));
+
+    if (native) {
+        compileNative(compiled, resolve);
+    }
+
+    return result;
 }
@@ -0,0 +1,343 @@
+const encodings = require("./encodings");
+const compileDecode = require("./decode");
+const compileDecodeMany = require("./decode-many");
+
+const {
+    is,
+    data: { options }
+} = adone;
+
+const addon = options.usePureJavaScript ? null : require("../../addon");
+
+// Compiles the messages into a descriptor table for the native codec. The table is an Int32Array of
+//
+//   messageCount, then for every message: fieldCount, then for every field:
+//   name, tag, type, flags, message, oneof, default, enumCount, enumValues...
+//
+// name and default are indexes of the values array, default is -1 for [] and -2 for {}. message is
+// the index of the message of a message field and oneof the index of the oneof group of the field,
+// -1 otherwise. The native codec gives the same results as the JavaScript one: what it does not
+// handle, like malformed input or values of unexpected types, is left to the JavaScript code.
+
+const TYPE_BYTES = 0;
+const TYPE_STRING = 1;
+const TYPE_BOOL = 2;
+const TYPE_INT32 = 3;
+const TYPE_INT64 = 4;
+const TYPE_SINT = 5;
+const TYPE_UINT = 6;
+const TYPE_FIXED64 = 7;
+const TYPE_DOUBLE = 8;
+const TYPE_FIXED32 = 9;
+const TYPE_SFIXED32 = 10;
+const TYPE_FLOAT = 11;
+const TYPE_ENUM = 12;
+const TYPE_MESSAGE = 13;
+
+const FLAG_REPEATED = 1;
+const FLAG_PACKED = 2;
+const FLAG_MAP = 4;
+const FLAG_REQUIRED = 8;
+
+const DEFAULT_ARRAY = -1;
+const DEFAULT_OBJECT = -2;
+
+const scalarTypes = [
+    ["bytes", TYPE_BYTES],
+    ["string", TYPE_STRING],
+    ["bool", TYPE_BOOL],
+    ["int32", TYPE_INT32],
+    ["int64", TYPE_INT64],
+    ["sint32", TYPE_SINT],
+    ["uint32", TYPE_UINT],
+    ["fixed64", TYPE_FIXED64],
+    ["double", TYPE_DOUBLE],
+    ["fixed32", TYPE_FIXED32],
+    ["sfixed32", TYPE_SFIXED32],
+    ["float", TYPE_FLOAT]
+];
+
+const scalarType = function (e) {
+    for (let i = 0; i < scalarTypes.length; i++) {
+        if (encodings[scalarTypes[i][0]] === e) {
+            return scalarTypes[i][1];
+        }
+    }
+    return -1;
+};
+
+// The field as the native codec sees it, or null if it does not handle the field
+const describeField = function (m, i, enc, resolve) {
+    const field = m.fields[i];
+    const e = enc[i];
+    const def = field.options && field.options.default;
+    const resolved = resolve(field.type, m.id, false);
+    const values = resolved && resolved.values;
+    const desc = {
+        field,
+        type: -1,
+        message: e.message ? e : null,
+        enumValues: [],
+        default: undefined
+    };
+
+    if (e.message) {
+        desc.type = TYPE_MESSAGE;
+    } else if (values) {
+        desc.type = TYPE_ENUM;
+        desc.enumValues = Object.keys(values).map((k) => parseInt(values[k].value, 10));
+        if (!desc.enumValues.every((v) => v === (v | 0))) {
+            return null;
+        }
+    } else {
+        desc.type = scalarType(e);
+    }
+
+    if (desc.type === -1 || (field.packed && e.message) || (field.oneof && field.repeated)) {
+        return null;
+    }
+
+    // the decoder reads the inherited properties of the objects it creates, and the varints of the
+    // keys take 32 bits
+    if (field.name in Object.prototype || !(is.integer(field.tag) && field.tag >= 0 && field.tag < 0x10000000)) {
+        return null;
+    }
+
+    try {
+        desc.default = compileDecode.fieldDefault(field, def, values);
+    } catch (err) {
+        // the JavaScript decoder throws when it needs the default
+        return null;
+    }
+    return desc;
+};
+
+module.exports = function (compiled, resolve) {
+    const messages = compiled.map(({ m, exports, enc }) => ({
+        m,
+        exports,
+        fields: m.fields.map((f, i) => describeField(m, i, enc, resolve))
+    }));
+
+    // the messages that only have supported fields and messages
+    let natives = messages.filter((message) => message.fields.every(Boolean) &&
+        new Set(message.m.fields.map((f) => f.name)).size === message.fields.length);
+    for (let count = -1; count !== natives.length;) {
+        count = natives.length;
+        const exported = natives.map((message) => message.exports);
+        natives = natives.filter((message) => message.fields.every((f) => !f.message || exported.includes(f.message)));
+    }
+
+    if (!addon || natives.length === 0) {
+        return;
+    }
+
+    const indexes = new Map(natives.map((message, i) => [message.exports, i]));
+    const table = [natives.length];
+    const values = [];
+    for (const message of natives) {
+        const oneofs = [];
+        table.push(message.fields.length);
+        for (const desc of message.fields) {
+            const field = desc.field;
+            let flags = 0;
+            if (field.repeated) {
+                flags |= FLAG_REPEATED;
+            }
+            if (field.packed) {
+                flags |= FLAG_PACKED;
+            }
+            if (field.map) {
+                flags |= FLAG_MAP;
+            }
+            if (field.required) {
+                flags |= FLAG_REQUIRED;
+            }
+
+            let oneof = -1;
+            if (field.oneof) {
+                oneof = oneofs.indexOf(field.oneof);
+                if (oneof === -1) {
+                    oneof = oneofs.push(field.oneof) - 1;
+                }
+            }
+
+            let def;
+            if (is.array(desc.default)) {
+                def = DEFAULT_ARRAY;
+            } else if (is.plainObject(desc.default)) {
+                def = DEFAULT_OBJECT;
+            } else {
+                def = values.push(desc.default) - 1;
+            }
+
+            table.push(values.push(field.name) - 1, field.tag, desc.type, flags,
+                desc.message ? indexes.get(desc.message) : -1, oneof, def, desc.enumValues.length, ...desc.enumValues);
+        }
+    }
+
+    // decode() and decodeMany() return the number of bytes consumed here, whether decodeMany()
+    // stopped before a message it does not decode, where their records are on the tape and whether
+    // the tape was replaced by a larger one
+    const state = new Float64Array(5);
+    const schema = new addon.ProtobufSchema(Int32Array.from(table), values, Buffer.prototype, state);
+
+    // The decoder parses the messages into records on the tape, the objects are created here: setting
+    // the properties from the native code takes longer than decoding the message. A record is the
+    // number of keys, then for every key the index of the field and its value, or -1 - index if the
+    // field gets its default. Strings are indexes of the strings decode() returns, bytes the start
+    // and the end of their slice, messages the offsets of their records; repeated fields and maps
+    // start with the number of values.
+    const specs = natives.map((message) => message.fields.map((desc) => ({
+        name: desc.field.name,
+        type: desc.type,
+        repeated: desc.field.repeated,
+        map: Boolean(desc.field.map),
+        message: desc.message ? indexes.get(desc.message) : -1,
+        default: desc.default
+    })));
+    let tape = schema.tape();
+    let strings = null;
+    let source = null;
+    let pos = 0;
+
+    const readValue = (field) => {
+        switch (field.type) {
+            case TYPE_BOOL:
+                return tape[pos++] !== 0;
+            case TYPE_STRING:
+                return strings[tape[pos++]];
+            case TYPE_BYTES:
+            case TYPE_FIXED64: {
+                const start = tape[pos];
+                const end = tape[pos + 1];
+                pos += 2;
+                return source.slice(start, end);
+            }
+            case TYPE_MESSAGE:
+                // eslint-disable-next-line no-use-before-define
+                return build(field.message, tape[pos++]);
+            default:
+                return tape[pos++];
+        }
+    };
+
+    const build = (index, record) => {
+        const fields = specs[index];
+        const saved = pos;
+        const obj = {};
+        pos = record;
+        for (let keys = tape[pos++]; keys > 0; keys--) {
+            const code = tape[pos++];
+            if (code < 0) {
+                const field = fields[-1 - code];
+                const def = field.default;
+                obj[field.name] = is.array(def) ? [] : is.plainObject(def) ? {} : def;
+                continue;
+            }
+            const field = fields[code];
+            if (field.map) {
+                const map = {};
+                for (let count = tape[pos++]; count > 0; count--) {
+                    const entry = build(field.message, tape[pos++]);
+                    map[entry.key] = entry.value;
+                }
+                obj[field.name] = map;
+            } else if (field.repeated) {
+                const array = [];
+                for (let count = tape[pos++]; count > 0; count--) {
+                    array.push(readValue(field));
+                }
+                obj[field.name] = array;
+            } else {
+                obj[field.name] = readValue(field);
+            }
+        }
+        pos = saved;
+        return obj;
+    };
+
+    const materialize = (result, buf, index, record) => {
+        strings = result;
+        source = buf;
+        try {
+            return build(index, record);
+        } finally {
+            strings = source = null;
+        }
+    };
+
+    // The native encoder writes here, the messages that do not fit get their own memory
+    const scratch = Buffer.allocUnsafeSlow(8192);
+    let scratchUsed = false;
+
+    const encodeNative = (index, obj) => {
+        if (scratchUsed) {
+            // called from a getter of the value
+            return schema.encode(index, obj, null);
+        }
+        scratchUsed = true;
+        try {
+            const result = schema.encode(index, obj, scratch);
+            return is.number(result) ? scratch.slice(0, result) : result;
+        } finally {
+            scratchUsed = false;
+        }
+    };
+
+    natives.forEach(({ exports }, index) => {
+        const encodeJs = exports.encode;
+        const decodeJs = exports.decode;
+
+        exports.encode = function encode(obj, buf, offset) {
+            if (is.nil(offset)) {
+                offset = 0;
+            }
+            const encoded = encodeNative(index, obj);
+            if (encoded && (is.nil(buf) || (is.buffer(buf) && is.integer(offset) && offset >= 0 && offset + encoded.length <= buf.length))) {
+                if (is.nil(buf)) {
+                    buf = encoded.buffer === scratch.buffer ? Buffer.from(encoded) : encoded;
+                } else {
+                    encoded.copy(buf, offset);
+                }
+                encode.bytes = encoded.length;
+                return buf;
+            }
+            // unexpected values, or a buffer that is too short
+            const result = encodeJs(obj, buf, offset);
+            encode.bytes = encodeJs.bytes;
+            return result;
+        };
+
+        exports.decode = function decode(buf, offset, end) {
+            const result = schema.decode(index, buf, offset, end);
+            if (is.undefined(result)) {
+                const value = decodeJs(buf, offset, end);
+                decode.bytes = decodeJs.bytes;
+                return value;
+            }
+            decode.bytes = state[0];
+            if (state[4] === 1) {
+                tape = schema.tape();
+            }
+            return materialize(result, buf, index, state[2]);
+        };
+
+        exports.encode.bytes = exports.decode.bytes = 0;
+
+        exports.decodeMany = compileDecodeMany(exports, (buf, offset, end) => {
+            const result = schema.decodeMany(index, buf, offset, end);
+            const bytes = state[0];
+            const stopped = state[1] === 1;
+            if (state[4] === 1) {
+                tape = schema.tape();
+            }
+            const records = state[2];
+            const messages = new Array(state[3]);
+            for (let i = 0; i < messages.length; i++) {
+                messages[i] = materialize(result, buf, index, tape[records + i]);
+            }
+            return { messages, bytes, stopped };
+        });
+    });
+};
@@ -34,7 +34,7 @@ export const create = function (proto, opts) {
     const Messages = function () {
         const self = this;
 
-        compile(sch, opts.encodings || {}).forEach((m) => {
+        compile(sch, opts.encodings || {}, opts.native).forEach((m) => {
             self[m.name] = flatten(m.values) || m;
         });
     };
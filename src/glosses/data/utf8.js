@@ -1,6 +1,16 @@
 /* eslint-disable func-style */
 
+const {
+    is,
+    data: { options }
+} = adone;
+
 adone.asNamespace(exports);
+
+const addon = options.usePureJavaScript ? null : require("./addon");
+
+// Shorter ranges are validated in JavaScript, calling the addon costs more
+const NATIVE_VALIDATE_THRESHOLD = 64;
 const stringFromCharCode = String.fromCharCode;
 
 let byteArray;
@@ -89,6 +99,13 @@ function encodeCodePoint(codePoint) {
 }
 
 export function encode(string) {
+    if (addon && is.string(string)) {
+        const byteString = addon.utf8Encode(string);
+        if (!is.undefined(byteString)) {
+            return byteString;
+        }
+        // a lone surrogate, reported below
+    }
     const codePoints = ucs2decode(string);
     const length = codePoints.length;
     let index = -1;
@@ -184,6 +201,13 @@ function decodeSymbol() {
 }
 
 export function decode(byteString) {
+    if (addon && is.string(byteString)) {
+        const string = addon.utf8Decode(byteString);
+        if (!is.undefined(string)) {
+            return string;
+        }
+        // invalid input, reported below
+    }
     byteArray = ucs2decode(byteString);
     byteCount = byteArray.length;
     byteIndex = 0;
@@ -194,3 +218,90 @@ export function decode(byteString) {
     }
     return ucs2encode(codePoints);
 }
+
+/**
+ * --------------------------------------------------------------------------
+ */
+
+function validateRange(bytes, start, end) {
+    let i = start;
+    while (i < end) {
+        const byte1 = bytes[i];
+        if (byte1 < 0x80) {
+            i++;
+            continue;
+        }
+        // the ranges of the second byte exclude overlong forms, surrogates and code points above U+10FFFF
+        let continuation;
+        let min = 0x80;
+        let max = 0xBF;
+        if (byte1 >= 0xC2 && byte1 <= 0xDF) {
+            continuation = 1;
+        } else if (byte1 >= 0xE0 && byte1 <= 0xEF) {
+            continuation = 2;
+            if (byte1 === 0xE0) {
+                min = 0xA0;
+            } else if (byte1 === 0xED) {
+                max = 0x9F;
+            }
+        } else if (byte1 >= 0xF0 && byte1 <= 0xF4) {
+            continuation = 3;
+            if (byte1 === 0xF0) {
+                min = 0x90;
+            } else if (byte1 === 0xF4) {
+                max = 0x8F;
+            }
+        } else {
+            return false;
+        }
+        if (i + continuation >= end) {
+            return false;
+        }
+        const byte2 = bytes[i + 1];
+        if (byte2 < min || byte2 > max) {
+            return false;
+        }
+        for (let j = 2; j <= continuation; j++) {
+            if ((bytes[i + j] & 0xC0) !== 0x80) {
+                return false;
+            }
+        }
+        i += continuation + 1;
+    }
+    return true;
+}
+
+/**
+ * Checks that the bytes from start to end are well-formed UTF-8: overlong forms, surrogates and
+ * code points above U+10FFFF are invalid.
+ *
+ * @param {Buffer|Uint8Array} bytes
+ * @param {number} [start]
+ * @param {number} [end]
+ * @returns {boolean}
+ */
+export function validate(bytes, start = 0, end = bytes.length) {
+    if (addon && end - start >= NATIVE_VALIDATE_THRESHOLD && bytes instanceof Uint8Array) {
+        return addon.utf8Validate(bytes, start, end);
+    }
+    return validateRange(bytes, Math.max(start, 0), Math.min(end, bytes.length));
+}
+
+/**
+ * Counts the code points of valid UTF-8, that is the bytes that are not continuation bytes.
+ *
+ * @param {Buffer|Uint8Array} bytes
+ * @returns {number}
+ */
+export function countCodePoints(bytes) {
+    if (addon && bytes instanceof Uint8Array) {
+        return addon.utf8CountCodePoints(bytes);
+    }
+    let count = 0;
+    for (let i = 0; i < bytes.length; i++) {
+        if ((bytes[i] & 0xC0) !== 0x80) {
+            count++;
+        }
+    }
+    return count;
+}
@@ -1,5 +1,11 @@
+const {
+    data: { options }
+} = adone;
+
 adone.asNamespace(exports);
 
+const addon = options.usePureJavaScript ? null : require("./addon");
+
 const MSB = 0x80;
 const REST = 0x7F;
 const MSBALL = ~REST;
@@ -72,3 +78,90 @@ export const encodingLength = (value) => {
                                             : 10
     );
 };
+
+const decodeError = (offset, bits) => new RangeError(`Varint at offset ${offset} does not fit in ${bits} bits`);
+
+const countVarints = (buf) => {
+    if (buf.length > 0 && buf[buf.length - 1] & MSB) {
+        throw new RangeError("Could not decode varint");
+    }
+    let count = 0;
+    for (let i = 0; i < buf.length; ++i) {
+        if (!(buf[i] & MSB)) {
+            ++count;
+        }
+    }
+    return count;
+};
+
+/**
+ * Encodes all the values one after another.
+ *
+ * @param {Uint32Array|BigUint64Array|number[]} values
+ * @returns {Buffer}
+ */
+export const encodeAll = (values) => {
+    if (addon && (values instanceof Uint32Array || values instanceof BigUint64Array)) {
+        return addon.varintEncodeAll(values, false);
+    }
+    // a 64-bit value takes up to 10 bytes
+    const out = Buffer.allocUnsafe(values.length * 10);
+    let offset = 0;
+    if (values instanceof BigUint64Array) {
+        const rest = BigInt(REST);
+        const shift = BigInt(7);
+        for (let i = 0; i < values.length; ++i) {
+            let value = values[i];
+            while (value > rest) {
+                out[offset++] = Number(value & rest) | MSB;
+                value >>= shift;
+            }
+            out[offset++] = Number(value);
+        }
+    } else {
+        for (let i = 0; i < values.length; ++i) {
+            encode(values[i], out, offset);
+            offset += encode.bytes;
+        }
+    }
+    return out.slice(0, offset);
+};
+
+/**
+ * Decodes all the varints of the buffer.
+ *
+ * Throws a RangeError if the last varint is truncated or if a varint does not fit in the elements.
+ *
+ * @param {Buffer|Uint8Array} buf
+ * @param {object} [options]
+ * @param {boolean} [options.bigint] decode 64-bit values into a BigUint64Array
+ * @returns {Uint32Array|BigUint64Array}
+ */
+export const decodeAll = (buf, { bigint = false } = {}) => {
+    if (addon) {
+        return addon.varintDecodeAll(buf, bigint, false);
+    }
+    const result = bigint ? new BigUint64Array(countVarints(buf)) : new Uint32Array(countVarints(buf));
+    // the last byte of the longest varint holds only the remaining bits
+    const maxBytes = bigint ? 10 : 5;
+    const maxLast = bigint ? 0x01 : 0x0F;
+    let offset = 0;
+    for (let i = 0; i < result.length; ++i) {
+        const start = offset;
+        let value = bigint ? BigInt(0) : 0;
+        let shift = 0;
+        let b;
+        do {
+            b = buf[offset++];
+            if (offset - start === maxBytes && b > maxLast) {
+                throw decodeError(start, bigint ? 64 : 32);
+            }
+            value += bigint
+                ? BigInt(b & REST) << BigInt(shift)
+                : (b & REST) * Math.pow(2, shift);
+            shift += 7;
+        } while (b & MSB);
+        result[i] = value;
+    }
+    return result;
+};
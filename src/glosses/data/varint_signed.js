@@ -1,9 +1,11 @@
 const {
-    data: { varint }
+    data: { varint, options }
 } = adone;
 
 adone.asNamespace(exports);
 
+const addon = options.usePureJavaScript ? null : require("./addon");
+
 export const encode = function encode(v, b, o) {
     v = v >= 0 ? v * 2 : v * -2 - 1;
     const r = varint.encode(v, b, o);
@@ -20,3 +22,54 @@ export const decode = function decode(b, o) {
 export const encodingLength = function (v) {
     return varint.encodingLength(v >= 0 ? v * 2 : v * -2 - 1);
 };
+
+/**
+ * Encodes all the values one after another with zigzag encoding.
+ *
+ * @param {Int32Array|BigInt64Array|number[]} values
+ * @returns {Buffer}
+ */
+export const encodeAll = (values) => {
+    if (addon && (values instanceof Int32Array || values instanceof BigInt64Array)) {
+        return addon.varintEncodeAll(values, true);
+    }
+    if (values instanceof BigInt64Array) {
+        const zigzag = new BigUint64Array(values.length);
+        const one = BigInt(1);
+        const sign = BigInt(63);
+        for (let i = 0; i < values.length; ++i) {
+            // stored modulo 2^64
+            zigzag[i] = (values[i] << one) ^ (values[i] >> sign);
+        }
+        return varint.encodeAll(zigzag);
+    }
+    return varint.encodeAll(Array.from(values, (v) => v >= 0 ? v * 2 : v * -2 - 1));
+};
+
+/**
+ * Decodes all the zigzag varints of the buffer, see varint.decodeAll().
+ *
+ * @param {Buffer|Uint8Array} buf
+ * @param {object} [options]
+ * @param {boolean} [options.bigint] decode 64-bit values into a BigInt64Array
+ * @returns {Int32Array|BigInt64Array}
+ */
+export const decodeAll = (buf, { bigint = false } = {}) => {
+    if (addon) {
+        return addon.varintDecodeAll(buf, bigint, true);
+    }
+    const values = varint.decodeAll(buf, { bigint });
+    if (bigint) {
+        const result = new BigInt64Array(values.length);
+        const one = BigInt(1);
+        for (let i = 0; i < values.length; ++i) {
+            result[i] = (values[i] >> one) ^ -(values[i] & one);
+        }
+        return result;
+    }
+    const result = new Int32Array(values.length);
+    for (let i = 0; i < values.length; ++i) {
+        result[i] = (values[i] >>> 1) ^ -(values[i] & 1);
+    }
+    return result;
+};
@@ -1,4 +1,6 @@
-const { data: { yaml }, is, util } = adone;
+const { data: { yaml, options: dataOptions }, is, util } = adone;
+
+const addon = dataOptions.usePureJavaScript ? null : require("../addon");
 
 const CONTEXT_FLOW_IN = 1;
 const CONTEXT_FLOW_OUT = 2;
@@ -1553,9 +1555,32 @@ const readDocument = (state) => {
 };
 
 
+// The addon resolves the implicit types of these schemas, the other types of them need tags
+const isNativeSchema = (schema) => {
+    return schema === yaml.schema.DEFAULT_SAFE ||
+        schema === yaml.schema.DEFAULT_FULL ||
+        schema === yaml.schema.CORE ||
+        schema === yaml.schema.JSON;
+};
+
 const loadDocuments = (input, options = {}) => {
     input = String(input);
 
+    // The addon converts the documents that only use the common part of YAML to JSON, the other ones
+    // and the invalid ones are loaded here (native/src/yaml/converter.h)
+    if (
+        addon &&
+        input.length !== 0 &&
+        is.nil(options.listener) &&
+        is.nil(options.onWarning) &&
+        isNativeSchema(options.schema || yaml.schema.DEFAULT_FULL)
+    ) {
+        const json = addon.yamlToJson(input, Boolean(options.json));
+        if (!is.undefined(json)) {
+            return [JSON.parse(json)];
+        }
+    }
+
     if (input.length !== 0) {
         // Add tailing `\n` if not exists
         if (
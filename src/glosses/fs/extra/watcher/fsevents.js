@@ -6,24 +6,51 @@
 /* jshint node:true */
 'use strict';
 
-if (process.platform !== 'darwin') {
+if (process.platform !== 'darwin' && process.platform !== 'linux') {
   throw new Error(`Module 'fsevents' is not compatible with platform '${process.platform}'`);
 }
 
-const Native = adone.requireAddon(adone.path.join(__dirname, "native", "fsevents.node"));
+const Native = adone.nodejs.trace.register("fsevents", adone.requireAddon(adone.path.join(__dirname, "native", "fsevents.node")));
 const con = Native.constants;
+const handles = new WeakMap();
 
-function watch(path, handler) {
+function toGlobs(value, name) {
+  if (value === undefined || value === null) return [];
+  const globs = Array.isArray(value) ? value : [value];
+  globs.forEach((glob) => {
+    if ('string' !== typeof glob) throw new TypeError(`options.${name} must contain only strings and not a ${typeof glob}`);
+  });
+  return globs;
+}
+
+// `options.include`/`options.exclude` are glob patterns matched against absolute paths
+// by the native layer, so excluded events never reach JS. As with matchPath, wildcards
+// only match segments starting with a dot when `options.dot` is set
+function watch(path, options, handler) {
+  if ('function' === typeof options) {
+    handler = options;
+    options = {};
+  }
   if ('string' !== typeof path) throw new TypeError(`argument 1 must be a string and not a ${typeof path}`);
-  if ('function' !== typeof handler) throw new TypeError(`argument 2 must be a function and not a ${typeof handler}`);
+  if ('function' !== typeof handler) throw new TypeError(`argument 3 must be a function and not a ${typeof handler}`);
+  options = options || {};
 
-  let instance = Native.start(path, handler);
+  let instance = Native.start(path, handler, toGlobs(options.include, 'include'), toGlobs(options.exclude, 'exclude'), Boolean(options.dot));
   if (!instance) throw new Error(`could not watch: ${path}`);
-  return () => {
+  const stop = () => {
     const result = instance ? Promise.resolve(instance).then(Native.stop) : null;
     instance = null;
     return result;
   };
+  handles.set(stop, instance);
+  return stop;
+}
+
+// counters of a watcher (the function returned by watch), they remain readable after it is stopped
+function stats(watcher) {
+  const instance = handles.get(watcher);
+  if (!instance) throw new TypeError('argument 1 must be a watcher returned by watch()');
+  return Native.stats(instance);
 }
 function getInfo(path, flags) {
   return {
@@ -59,4 +86,5 @@ function getFileChanges(flags) {
 
 exports.watch = watch;
 exports.getInfo = getInfo;
+exports.stats = stats;
 exports.constants = con;
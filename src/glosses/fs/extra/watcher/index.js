@@ -11,6 +11,7 @@ const {
 
 let FSEvents;
 try {
+    // on linux the native inotify backend is used only when requested explicitly (useFsEvents: true)
     FSEvents = require("./fsevents");
 } catch (error) {
     //
@@ -47,10 +48,12 @@ const couldConsolidate = (path) => {
  *
  * @private
  * @param {string} path - path to be watched
- * @param {function} callback - called when fsevents is bound and ready
+ * @param {string[]} exclude - globs dropped by the native layer before reaching JS
+ * @param {Boolean} dot - whether wildcards of the globs match segments starting with a dot
+ * @param {function} callback - called when fsevents emits events
  * @returns {object} new fsevents instance
  */
-const createFSEventsInstance = (path, callback) => new FSEvents(path).on("fsevent", callback).start();
+const createFSEventsInstance = (path, exclude, dot, callback) => ({ stop: FSEvents.watch(path, { exclude, dot }, callback) });
 
 /**
  * Instantiates the fsevents interface or binds listeners to an existing one covering the same file tree
@@ -60,9 +63,11 @@ const createFSEventsInstance = (path, callback) => new FSEvents(path).on("fseven
  * @param {string} realPath - real path (in case of symlinks)
  * @param {function} listener - called when fsevents emits events
  * @param {function} rawEmitter - passes data to listeners of the "raw" event
+ * @param {string[]} exclude - globs of ignored paths that can be filtered out natively
+ * @param {Boolean} dot - whether wildcards of the globs match segments starting with a dot
  * @returns {function} close function
  */
-const setFSEventsListener = (path, realPath, listener, rawEmitter) => {
+const setFSEventsListener = (path, realPath, listener, rawEmitter, exclude = [], dot = false) => {
     let watchPath = aPath.extname(path) ? aPath.dirname(path) : path;
     let watchContainer;
     const parentPath = aPath.dirname(watchPath);
@@ -86,6 +91,13 @@ const setFSEventsListener = (path, realPath, listener, rawEmitter) => {
         }
     };
 
+    // native globs match real paths, they are only safe to use when no symlink is involved
+    if (hasSymlink) {
+        exclude = [];
+    }
+    // an instance filters for all of its listeners, so it can only be shared by ones that ignore the same paths
+    const excludeKey = `${Number(dot)}${exclude.join("\0")}`;
+
     // check if there is already a watcher on a parent path
     // modifies `watchPath` to the parent path when it finds a match
     const watchedParent = () => [...FSEventsWatchers.keys()].some((watchedPath) => {
@@ -97,20 +109,24 @@ const setFSEventsListener = (path, realPath, listener, rawEmitter) => {
         return false;
     });
 
-    if (FSEventsWatchers.has(watchPath) || watchedParent()) {
+    if ((FSEventsWatchers.has(watchPath) || watchedParent()) && FSEventsWatchers.get(watchPath).excludeKey === excludeKey) {
         watchContainer = FSEventsWatchers.get(watchPath);
         watchContainer.listeners.push(filteredListener);
+        watchContainer.rawEmitters.push(rawEmitter);
     } else {
         watchContainer = {
+            excludeKey,
             listeners: [filteredListener],
             rawEmitters: [rawEmitter],
-            watcher: createFSEventsInstance(watchPath, (fullPath, flags) => {
+            watcher: createFSEventsInstance(watchPath, exclude, dot, (fullPath, flags) => {
                 const info = FSEvents.getInfo(fullPath, flags);
                 watchContainer.listeners.forEach((listener) => listener(fullPath, flags, info));
                 watchContainer.rawEmitters.forEach((emitter) => emitter(info.event, fullPath, info));
             })
         };
-        FSEventsWatchers.set(watchPath, watchContainer);
+        if (!FSEventsWatchers.has(watchPath)) {
+            FSEventsWatchers.set(watchPath, watchContainer);
+        }
     }
     const listenerIndex = watchContainer.listeners.length - 1;
 
@@ -119,9 +135,11 @@ const setFSEventsListener = (path, realPath, listener, rawEmitter) => {
     return () => {
         delete watchContainer.listeners[listenerIndex];
         delete watchContainer.rawEmitters[listenerIndex];
-        if (!watchContainer.listeners.length) {
+        if (!watchContainer.listeners.some(Boolean)) {
             watchContainer.watcher.stop();
-            FSEventsWatchers.delete(watchPath);
+            if (FSEventsWatchers.get(watchPath) === watchContainer) {
+                FSEventsWatchers.delete(watchPath);
+            }
         }
     };
 };
@@ -165,6 +183,14 @@ export default (fs) => {
                 return;
             }
             const watchCallback = (fullPath, flags, info) => {
+                // the inotify backend ran out of watches for this directory, changes below it are lost
+                if (is.linux && (flags & FSEvents.constants.kFSEventStreamEventFlagUserDropped)) {
+                    const error = new Error(`could not watch: ${fullPath}`);
+                    error.code = "ENOSPC";
+                    error.path = fullPath;
+                    this._handleError(error);
+                    return;
+                }
                 if (!is.undefined(this.options.depth) && depth(fullPath, realPath) > this.options.depth) {
                     return;
                 }
@@ -261,7 +287,7 @@ export default (fs) => {
                 }
             };
 
-            const closer = setFSEventsListener(watchPath, realPath, watchCallback, (...args) => this.emit("raw", ...args));
+            const closer = setFSEventsListener(watchPath, realPath, watchCallback, (...args) => this.emit("raw", ...args), this._nativeIgnored(), this.options.dot);
             this._emitReady();
             return closer;
         },
@@ -639,6 +665,7 @@ export default (fs) => {
             followSymlinks = true,
             awaitWriteFinish = false,
             ignored = [],
+            dot = false,
             alwaysStat = false,
             depth,
             cwd
@@ -656,7 +683,7 @@ export default (fs) => {
 
             // Enable fsevents on OS X when polling isn't explicitly enabled.
             if (is.null(useFsEvents)) {
-                useFsEvents = !usePolling;
+                useFsEvents = !usePolling && is.darwin;
             }
             // If we can't use fsevents, ensure the options reflect it's disabled.
             if (!canUseFSEvents()) {
@@ -710,6 +737,7 @@ export default (fs) => {
                 followSymlinks,
                 awaitWriteFinish,
                 ignored,
+                dot,
                 alwaysStat,
                 depth,
                 cwd
@@ -1130,7 +1158,40 @@ export default (fs) => {
                 this._userIgnored = util.matchPath([...this._globIgnored, ...ignored, ...paths]);
             }
 
-            return this._userIgnored([path, stats]);
+            return this._userIgnored([path, stats], { dot: this.options.dot });
+        }
+
+        /**
+         * Returns string globs of ignored paths which the native watcher can drop before they reach JS.
+         * Relative globs are resolved against cwd, functions and regexps are left to _isIgnored.
+         * A negated pattern makes matchPath ignore everything else, so nothing is filtered natively then
+         *
+         * @private
+         * @returns {string[]}
+         */
+        _nativeIgnored() {
+            const { cwd, ignored } = this.options;
+            const globs = [];
+            if (ignored.some((path) => is.string(path) && path[0] === "!")) {
+                return globs;
+            }
+            for (let path of ignored) {
+                if (!is.string(path)) {
+                    continue;
+                }
+                if (cwd && !aPath.isAbsolute(path)) {
+                    path = aPath.join(cwd, path);
+                }
+                if (!aPath.isAbsolute(path) && !path.startsWith("**")) {
+                    continue;
+                }
+                path = adone.path.normalize(path);
+                globs.push(path);
+                if (!is.glob(path)) {
+                    globs.push(`${path}/**`);
+                }
+            }
+            return globs;
         }
 
         /**
@@ -1,7 +1,9 @@
 #ifndef __constants_h
 #define __constants_h
 
+#ifdef __APPLE__
 #include "CoreFoundation/CoreFoundation.h"
+#endif
 
 // constants from https://developer.apple.com/library/mac/documentation/Darwin/Reference/FSEvents_Ref/index.html#//apple_ref/doc/constant_group/FSEventStreamEventFlags
 #ifndef kFSEventStreamEventFlagNone
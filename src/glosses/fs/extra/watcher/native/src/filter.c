@@ -0,0 +1,207 @@
+#include "filter.h"
+#include <string.h>
+#include <limits.h>
+
+static int fse_glob_compile(fse_glob_t *glob, const char *pattern, int dot) {
+  size_t len = strlen(pattern);
+  size_t idx, out = 0;
+  char *source = malloc(len + 1);
+  if (!source) return 0;
+
+  /* collapse runs of `**` + `/` + `**` which are equivalent to a single `**` */
+  for (idx = 0; idx < len; idx++) {
+    if (pattern[idx] == '\\' && idx + 1 < len) {
+      source[out++] = pattern[idx++];
+      source[out++] = pattern[idx];
+      continue;
+    }
+    if (out >= 3 && pattern[idx] == '*' && idx + 1 < len && pattern[idx + 1] == '*'
+        && source[out - 1] == '/' && source[out - 2] == '*' && source[out - 3] == '*'
+        && (idx + 2 == len || pattern[idx + 2] == '/')) {
+      out--;
+      idx++;
+      continue;
+    }
+    source[out++] = pattern[idx];
+  }
+  source[out] = 0;
+
+  glob->source = source;
+  glob->length = out;
+  glob->dot = dot;
+  glob->wildcard = 0;
+  glob->literal = out;
+  for (idx = 0; idx < out; idx++) {
+    char c = source[idx];
+    if (c == '*' || c == '?' || c == '[' || c == '\\') {
+      glob->wildcard = 1;
+      glob->literal = idx;
+      break;
+    }
+  }
+  return 1;
+}
+
+static int fse_globset_add(fse_globset_t *set, const char *pattern, int dot) {
+  if (!fse_glob_compile(&set->globs[set->count], pattern, dot)) return 0;
+  set->count++;
+  return 1;
+}
+
+fse_filter_t fse_filter_alloc(size_t numinclude, size_t numexclude, int dot) {
+  fse_filter_t filter = calloc(1, sizeof(*filter));
+  if (!filter) return NULL;
+  filter->dot = dot;
+  filter->include.globs = calloc(numinclude ? numinclude : 1, sizeof(fse_glob_t));
+  filter->exclude.globs = calloc(numexclude ? numexclude : 1, sizeof(fse_glob_t));
+  if (!filter->include.globs || !filter->exclude.globs) {
+    fse_filter_free(filter);
+    return NULL;
+  }
+  return filter;
+}
+
+int fse_filter_add_include(fse_filter_t filter, const char *pattern) {
+  return fse_globset_add(&filter->include, pattern, filter->dot);
+}
+
+int fse_filter_add_exclude(fse_filter_t filter, const char *pattern) {
+  return fse_globset_add(&filter->exclude, pattern, filter->dot);
+}
+
+void fse_filter_free(fse_filter_t filter) {
+  size_t idx;
+  if (!filter) return;
+  for (idx = 0; idx < filter->include.count; idx++) free(filter->include.globs[idx].source);
+  for (idx = 0; idx < filter->exclude.count; idx++) free(filter->exclude.globs[idx].source);
+  free(filter->include.globs);
+  free(filter->exclude.globs);
+  free(filter);
+}
+
+/* matches a character class starting right after `[`, stores the position after `]` into *end */
+static int fse_class_match(const char *p, const char *pend, char c, const char **end) {
+  int negate = 0, matched = 0;
+  if (p < pend && (*p == '!' || *p == '^')) {
+    negate = 1;
+    p++;
+  }
+  const char *start = p;
+  while (p < pend && (*p != ']' || p == start)) {
+    char lo = *p;
+    if (lo == '\\' && p + 1 < pend) lo = *++p;
+    char hi = lo;
+    if (p + 2 < pend && p[1] == '-' && p[2] != ']') {
+      hi = p[2];
+      if (hi == '\\' && p + 3 < pend) {
+        hi = p[3];
+        p++;
+      }
+      p += 2;
+    }
+    if (c >= lo && c <= hi) matched = 1;
+    p++;
+  }
+  if (p >= pend) return -1; /* unterminated class, treat `[` literally */
+  *end = p + 1;
+  return matched != negate;
+}
+
+/* the leading dot of a segment, which wildcards only match when dot is set */
+static int fse_hidden(const char *s, const char *start, const char *send) {
+  return s < send && *s == '.' && (s == start || s[-1] == '/');
+}
+
+static int fse_match_here(const char *p, const char *pend, const char *s, const char *start, const char *send, int dot) {
+  while (p < pend) {
+    char c = *p;
+    if (c == '*') {
+      if (p + 1 < pend && p[1] == '*') {
+        p += 2;
+        if (p < pend && *p == '/') {
+          /* `**` + `/` matches zero or more whole directories */
+          p++;
+          for (;;) {
+            if (fse_match_here(p, pend, s, start, send, dot)) return 1;
+            if (!dot && fse_hidden(s, start, send)) return 0;
+            while (s < send && *s != '/') s++;
+            if (s == send) return 0;
+            s++;
+          }
+        }
+        for (;;) {
+          if (fse_match_here(p, pend, s, start, send, dot)) return 1;
+          if (s == send || (!dot && fse_hidden(s, start, send))) return 0;
+          s++;
+        }
+      }
+      p++;
+      if (!dot && fse_hidden(s, start, send)) return 0;
+      for (;;) {
+        if (fse_match_here(p, pend, s, start, send, dot)) return 1;
+        if (s == send || *s == '/') return 0;
+        s++;
+      }
+    }
+    if (s == send) return 0;
+    if (!dot && (c == '?' || c == '[') && fse_hidden(s, start, send)) return 0;
+    if (c == '?') {
+      if (*s == '/') return 0;
+    } else if (c == '[') {
+      const char *end;
+      int res = fse_class_match(p + 1, pend, *s, &end);
+      if (res >= 0) {
+        if (!res || *s == '/') return 0;
+        p = end;
+        s++;
+        continue;
+      }
+      if (*s != '[') return 0;
+    } else {
+      if (c == '\\' && p + 1 < pend) c = *++p;
+      if (c != *s) return 0;
+    }
+    p++;
+    s++;
+  }
+  return s == send;
+}
+
+int fse_glob_match(const fse_glob_t *glob, const char *path, size_t length) {
+  if (!glob->wildcard) {
+    return length == glob->length && !memcmp(glob->source, path, length);
+  }
+  if (length < glob->literal || memcmp(glob->source, path, glob->literal)) {
+    return 0;
+  }
+  return fse_match_here(glob->source + glob->literal, glob->source + glob->length, path + glob->literal, path, path + length, glob->dot);
+}
+
+static int fse_globset_match(const fse_globset_t *set, const char *path, size_t length) {
+  size_t idx;
+  for (idx = 0; idx < set->count; idx++) {
+    if (fse_glob_match(&set->globs[idx], path, length)) return 1;
+  }
+  return 0;
+}
+
+int fse_filter_match(const fse_filter_t filter, const char *path) {
+  if (!filter) return 1;
+  size_t length = strlen(path);
+  if (fse_globset_match(&filter->exclude, path, length)) return 0;
+  return !filter->include.count || fse_globset_match(&filter->include, path, length);
+}
+
+int fse_filter_prunes(const fse_filter_t filter, const char *dirpath) {
+  char path[PATH_MAX + 1];
+  size_t length;
+  if (!filter || !filter->dot || !filter->exclude.count) return 0;
+  length = strlen(dirpath);
+  if (fse_globset_match(&filter->exclude, dirpath, length)) return 1;
+  /* patterns ending with a globstar exclude the contents of the directory */
+  if (length + 1 >= sizeof(path)) return 0;
+  memcpy(path, dirpath, length);
+  path[length] = '/';
+  path[length + 1] = 0;
+  return fse_globset_match(&filter->exclude, path, length + 1);
+}
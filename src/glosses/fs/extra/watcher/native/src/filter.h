@@ -0,0 +1,54 @@
+#ifndef __filter_h
+#define __filter_h
+
+#include <stdlib.h>
+
+/*
+ * Compiled include/exclude glob sets evaluated on the watcher thread, so
+ * ignored paths never get copied into events nor cross into JS.
+ *
+ * Supported syntax: `*` (any run of characters except `/`), `**` (any run of
+ * characters including `/`, `**` followed by `/` also matches no directory at
+ * all), `?`, character classes `[abc]`, `[a-z]`, `[!a]`/`[^a]` and `\` escapes.
+ *
+ * Unless `dot` is set, wildcards do not match a segment that starts with a dot, as matchPath
+ * (micromatch with dot: false) does; a dot written in the pattern still matches.
+ */
+
+typedef struct {
+  char *source;
+  size_t length;
+  /* length of the leading part of the pattern that has no wildcards */
+  size_t literal;
+  int wildcard;
+  int dot;
+} fse_glob_t;
+
+typedef struct {
+  size_t count;
+  fse_glob_t *globs;
+} fse_globset_t;
+
+typedef struct fse_filter_s {
+  fse_globset_t include;
+  fse_globset_t exclude;
+  int dot;
+} *fse_filter_t;
+
+fse_filter_t fse_filter_alloc(size_t numinclude, size_t numexclude, int dot);
+int fse_filter_add_include(fse_filter_t filter, const char *pattern);
+int fse_filter_add_exclude(fse_filter_t filter, const char *pattern);
+void fse_filter_free(fse_filter_t filter);
+
+int fse_glob_match(const fse_glob_t *glob, const char *path, size_t length);
+
+/* returns non-zero when the path passes the filter (a NULL filter passes everything) */
+int fse_filter_match(const fse_filter_t filter, const char *path);
+
+/*
+ * returns non-zero when everything under the directory is excluded, so it need not be watched.
+ * Without `dot` nothing is pruned: hidden entries at any depth escape the wildcards.
+ */
+int fse_filter_prunes(const fse_filter_t filter, const char *dirpath);
+
+#endif
@@ -4,6 +4,7 @@
 */
 
 #include <assert.h>
+#include <string.h>
 
 #define NAPI_VERSION 4
 #include <node_api.h>
@@ -11,6 +12,9 @@
 #include "rawfsevents.h"
 #include "constants.h"
 
+#define ADONE_TRACE_IMPLEMENTATION
+#include <adone_trace.h>
+
 #ifndef CHECK
 #ifdef NDEBUG
 #define CHECK(x) do { if (!(x)) abort(); } while (0)
@@ -20,23 +24,115 @@
 #endif
 
 
+#define FSE_LATENCY_BUCKETS 21
+
+/*
+** JS side state of a watcher. It is shared by the external handle and the threadsafe function,
+** whichever of them is finalized last frees it, so stats stay readable after stop().
+*/
+typedef struct {
+  napi_threadsafe_function callback;
+  int refs;
+  uint64_t coalesced;
+  uint64_t dropped;
+  uint64_t dispatched;
+  uint64_t depth;
+  uint64_t highwatermark;
+  // native -> JS dispatch latency, bucket i counts batches delivered in less than 2^i microseconds
+  uint64_t latency[FSE_LATENCY_BUCKETS];
+  uint64_t latencycount;
+  uint64_t latencysum;
+  uint64_t latencymax;
+} fse_js_context;
+
+typedef struct {
+  fse_watcher_t watcher;
+  fse_js_context *context;
+} fse_js_handle;
+
 typedef struct {
   size_t count;
+  uint64_t queued;
   fse_event_t *events;
 } fse_js_event;
 
-void fse_propagate_event(void *callback, size_t numevents, fse_event_t *events) {
+static void fse_context_unref(fse_js_context *context) {
+  if (--context->refs == 0) {
+    free(context);
+  }
+}
+
+void fse_propagate_event(void *data, size_t numevents, fse_event_t *events) {
+  ADONE_TRACE_SCOPE("fsevents", "propagate");
+  fse_js_context *context = data;
+  size_t idx, count = 0;
+  uint64_t coalesced = 0, dropped = 0;
+
+  // adjacent events for the same path are merged the way FSEvents does it, by accumulating flags
+  for (idx = 0; idx < numevents; idx++) {
+    if (events[idx].flags & (kFSEventStreamEventFlagMustScanSubDirs | kFSEventStreamEventFlagUserDropped | kFSEventStreamEventFlagKernelDropped)) {
+      dropped++;
+    }
+    if (count && !strcmp(events[count - 1].path, events[idx].path)) {
+      events[count - 1].flags |= events[idx].flags;
+      events[count - 1].id = events[idx].id;
+      coalesced++;
+      continue;
+    }
+    if (count != idx) {
+      memcpy(&events[count], &events[idx], sizeof(*events));
+    }
+    count++;
+  }
+  FSE_STAT_ADD(context->coalesced, coalesced);
+  FSE_STAT_ADD(context->dropped, dropped);
+
   fse_js_event *event = malloc(sizeof(*event));
   CHECK(event);
-  event->count = numevents;
+  event->count = count;
   event->events = events;
-  CHECK(napi_call_threadsafe_function((napi_threadsafe_function)callback, event, napi_tsfn_blocking) == napi_ok);
+  event->queued = uv_hrtime();
+
+  uint64_t depth = FSE_STAT_ADD(context->depth, 1) + 1;
+  uint64_t highwatermark = FSE_STAT_GET(context->highwatermark);
+  while (depth > highwatermark && !__atomic_compare_exchange_n(&context->highwatermark, &highwatermark, depth, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+  CHECK(napi_call_threadsafe_function(context->callback, event, napi_tsfn_blocking) == napi_ok);
 }
 
-void fse_dispatch_events(napi_env env, napi_value callback, void* context, void* data) {
-  fse_js_event *event = data;
+static void fse_record_latency(fse_js_context *context, uint64_t queued) {
+  uint64_t latency = uv_hrtime() - queued;
+  uint64_t micros = latency / 1000;
+  size_t bucket = 0;
+  while (bucket < FSE_LATENCY_BUCKETS - 1 && micros >= (1ull << bucket)) {
+    bucket++;
+  }
+  context->latency[bucket]++;
+  context->latencycount++;
+  context->latencysum += latency;
+  if (latency > context->latencymax) {
+    context->latencymax = latency;
+  }
+}
+
+void fse_dispatch_events(napi_env env, napi_value callback, void* data, void* payload) {
+  fse_js_context *context = data;
+  fse_js_event *event = payload;
   napi_value recv, args[3];
   size_t idx;
+
+  __atomic_fetch_sub(&context->depth, 1, __ATOMIC_RELAXED);
+  // the function is being torn down, the queued events are only freed
+  if (env == NULL) {
+    free(event->events);
+    free(event);
+    return;
+  }
+  ADONE_TRACE_SPAN("fsevents", "queued", event->queued);
+  ADONE_TRACE_SCOPE("fsevents", "dispatch");
+  fse_record_latency(context, event->queued);
+  context->dispatched += event->count;
+
   CHECK(napi_get_null(env, &recv) == napi_ok);
 
   for (idx = 0; idx < event->count; idx++) {
@@ -50,67 +146,202 @@ void fse_dispatch_events(napi_env env, napi_value callback, void* context, void*
   free(event);
 }
 
-void fse_free_watcher(napi_env env, void* watcher, void* callback) {
-  fse_free(watcher);
+void fse_finalize_callback(napi_env env, void* data, void* hint) {
+  (void)env;
+  (void)hint;
+  fse_context_unref(data);
 }
 
-void fse_watcher_started(void *context) {
-  if (context == NULL) {
+void fse_free_watcher(napi_env env, void* data, void* hint) {
+  (void)env;
+  (void)hint;
+  fse_js_handle *handle = data;
+  fse_free(handle->watcher);
+  fse_context_unref(handle->context);
+  free(handle);
+}
+
+void fse_watcher_started(void *data) {
+  if (data == NULL) {
     return;
   }
-  napi_threadsafe_function callback = (napi_threadsafe_function)context;
-  CHECK(napi_acquire_threadsafe_function(callback) == napi_ok);
+  fse_js_context *context = data;
+  CHECK(napi_acquire_threadsafe_function(context->callback) == napi_ok);
 }
-void fse_watcher_ended(void *context) {
-  if (context == NULL) {
+void fse_watcher_ended(void *data) {
+  if (data == NULL) {
     return;
   }
-  napi_threadsafe_function callback = (napi_threadsafe_function)context;
-  CHECK(napi_release_threadsafe_function(callback, napi_tsfn_abort) == napi_ok);
+  fse_js_context *context = data;
+  CHECK(napi_release_threadsafe_function(context->callback, napi_tsfn_abort) == napi_ok);
+}
+
+static size_t fse_array_length(napi_env env, napi_value value) {
+  bool isarray = false;
+  uint32_t length = 0;
+  napi_valuetype type;
+  CHECK(napi_typeof(env, value, &type) == napi_ok);
+  if (type == napi_undefined || type == napi_null) return 0;
+  CHECK(napi_is_array(env, value, &isarray) == napi_ok);
+  if (!isarray) return 0;
+  CHECK(napi_get_array_length(env, value, &length) == napi_ok);
+  return length;
+}
+
+static void fse_compile_globs(napi_env env, napi_value patterns, fse_filter_t filter, int (*add)(fse_filter_t, const char *)) {
+  char pattern[PATH_MAX];
+  size_t length = fse_array_length(env, patterns), len;
+  uint32_t idx;
+  napi_value item;
+  for (idx = 0; idx < length; idx++) {
+    CHECK(napi_get_element(env, patterns, idx, &item) == napi_ok);
+    CHECK(napi_get_value_string_utf8(env, item, pattern, PATH_MAX, &len) == napi_ok);
+    CHECK(add(filter, pattern));
+  }
+}
+
+// include/exclude glob arrays are compiled once and evaluated on the watcher thread
+static fse_filter_t fse_create_filter(napi_env env, napi_value include, napi_value exclude, napi_value dot) {
+  size_t numinclude = fse_array_length(env, include);
+  size_t numexclude = fse_array_length(env, exclude);
+  bool matchdot = false;
+  if (!numinclude && !numexclude) return NULL;
+  CHECK(napi_coerce_to_bool(env, dot, &dot) == napi_ok);
+  CHECK(napi_get_value_bool(env, dot, &matchdot) == napi_ok);
+  fse_filter_t filter = fse_filter_alloc(numinclude, numexclude, matchdot);
+  CHECK(filter);
+  fse_compile_globs(env, include, filter, fse_filter_add_include);
+  fse_compile_globs(env, exclude, filter, fse_filter_add_exclude);
+  return filter;
 }
 
 static napi_value FSEStart(napi_env env, napi_callback_info info) {
-  size_t argc = 2;
+  size_t argc = 5;
   napi_value argv[argc];
   char path[PATH_MAX];
   napi_threadsafe_function callback = NULL;
   napi_value asyncResource, asyncName;
+  fse_js_context *context = calloc(1, sizeof(*context));
+  CHECK(context);
 
   CHECK(napi_get_cb_info(env, info, &argc, argv,  NULL, NULL) == napi_ok);
   CHECK(napi_get_value_string_utf8(env, argv[0], path, PATH_MAX, &argc) == napi_ok);
   CHECK(napi_create_object(env, &asyncResource) == napi_ok);
   CHECK(napi_create_string_utf8(env, "fsevents", NAPI_AUTO_LENGTH, &asyncName) == napi_ok);
-  CHECK(napi_create_threadsafe_function(env, argv[1], asyncResource, asyncName, 0, 2, NULL, NULL, NULL, fse_dispatch_events, &callback) == napi_ok);
+  CHECK(napi_create_threadsafe_function(env, argv[1], asyncResource, asyncName, 0, 2, context, fse_finalize_callback, context, fse_dispatch_events, &callback) == napi_ok);
   CHECK(napi_ref_threadsafe_function(env, callback) == napi_ok);
 
   napi_value result;
   if (!callback) {
+    free(context);
     CHECK(napi_get_undefined(env, &result) == napi_ok);
     return result;
   }
-  fse_watcher_t watcher = fse_alloc();
-  CHECK(watcher);
-  fse_watch(path, fse_propagate_event, callback, fse_watcher_started, fse_watcher_ended, watcher);
+  context->callback = callback;
+  context->refs = 2;
+
+  fse_js_handle *handle = malloc(sizeof(*handle));
+  CHECK(handle);
+  handle->context = context;
+  handle->watcher = fse_alloc();
+  CHECK(handle->watcher);
+  if (fse_watch(path, fse_create_filter(env, argv[2], argv[3], argv[4]), fse_propagate_event, context, fse_watcher_started, fse_watcher_ended, handle->watcher) != 0) {
+    // out of inotify instances or threads, the JS side throws
+    fse_free(handle->watcher);
+    free(handle);
+    fse_context_unref(context);
+    CHECK(napi_release_threadsafe_function(callback, napi_tsfn_abort) == napi_ok);
+    CHECK(napi_get_null(env, &result) == napi_ok);
+    return result;
+  }
 
-  CHECK(napi_create_external(env, watcher, fse_free_watcher, callback, &result) == napi_ok);
+  CHECK(napi_create_external(env, handle, fse_free_watcher, NULL, &result) == napi_ok);
   return result;
 }
 static napi_value FSEStop(napi_env env, napi_callback_info info) {
   size_t argc = 1;
   napi_value external;
-  fse_watcher_t watcher;
+  fse_js_handle *handle;
   CHECK(napi_get_cb_info(env, info, &argc, &external,  NULL, NULL) == napi_ok);
-  CHECK(napi_get_value_external(env, external, (void**)&watcher) == napi_ok);
-  napi_threadsafe_function callback = (napi_threadsafe_function)fse_context_of(watcher);
-  if (callback) {
-    CHECK(napi_unref_threadsafe_function(env, callback) == napi_ok);
+  CHECK(napi_get_value_external(env, external, (void**)&handle) == napi_ok);
+  fse_js_context *context = fse_context_of(handle->watcher);
+  if (context) {
+    CHECK(napi_unref_threadsafe_function(env, context->callback) == napi_ok);
   }
-  fse_unwatch(watcher);
+  fse_unwatch(handle->watcher);
   napi_value result;
   CHECK(napi_get_undefined(env, &result) == napi_ok);
   return result;
 }
 
+#define STAT(obj, name, val) do {\
+  CHECK(napi_create_double(env, (double)(val), &value) == napi_ok);\
+  CHECK(napi_set_named_property(env, obj, name, value) == napi_ok);\
+} while (0)
+
+static napi_value FSEStats(napi_env env, napi_callback_info info) {
+  size_t argc = 1, idx;
+  napi_value external, result, latency, buckets, value;
+  fse_js_handle *handle;
+  CHECK(napi_get_cb_info(env, info, &argc, &external,  NULL, NULL) == napi_ok);
+  CHECK(napi_get_value_external(env, external, (void**)&handle) == napi_ok);
+  const fse_stats_t *stats = fse_stats_of(handle->watcher);
+  fse_js_context *context = handle->context;
+
+  CHECK(napi_create_object(env, &result) == napi_ok);
+  STAT(result, "received", FSE_STAT_GET(stats->received));
+  STAT(result, "filtered", FSE_STAT_GET(stats->filtered));
+  STAT(result, "coalesced", FSE_STAT_GET(context->coalesced));
+  STAT(result, "dropped", FSE_STAT_GET(context->dropped));
+  STAT(result, "dispatched", context->dispatched);
+  STAT(result, "queueDepth", FSE_STAT_GET(context->depth));
+  STAT(result, "queueHighWaterMark", FSE_STAT_GET(context->highwatermark));
+
+  CHECK(napi_create_object(env, &latency) == napi_ok);
+  CHECK(napi_create_array_with_length(env, FSE_LATENCY_BUCKETS, &buckets) == napi_ok);
+  for (idx = 0; idx < FSE_LATENCY_BUCKETS; idx++) {
+    CHECK(napi_create_double(env, (double)context->latency[idx], &value) == napi_ok);
+    CHECK(napi_set_element(env, buckets, idx, value) == napi_ok);
+  }
+  CHECK(napi_set_named_property(env, latency, "buckets", buckets) == napi_ok);
+  STAT(latency, "count", context->latencycount);
+  STAT(latency, "sum", context->latencysum);
+  STAT(latency, "max", context->latencymax);
+  CHECK(napi_set_named_property(env, result, "latency", latency) == napi_ok);
+  return result;
+}
+
+static napi_value FSETraceEnable(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1];
+  bool enabled;
+
+  CHECK(napi_get_cb_info(env, info, &argc, argv, NULL, NULL) == napi_ok);
+  CHECK(napi_coerce_to_bool(env, argv[0], &argv[0]) == napi_ok);
+  CHECK(napi_get_value_bool(env, argv[0], &enabled) == napi_ok);
+  adone_trace_enable(enabled);
+  return NULL;
+}
+
+static napi_value FSETraceClear(napi_env env, napi_callback_info info) {
+  (void)env;
+  (void)info;
+  adone_trace_clear();
+  return NULL;
+}
+
+static napi_value FSETraceDump(napi_env env, napi_callback_info info) {
+  (void)info;
+  size_t length;
+  char *json = adone_trace_dump(&length);
+  napi_value result;
+
+  CHECK(json);
+  CHECK(napi_create_string_utf8(env, json, length, &result) == napi_ok);
+  free(json);
+  return result;
+}
+
 #define CONSTANT(name) do {\
   CHECK(napi_create_int32(env, name, &value) == napi_ok);\
   CHECK(napi_set_named_property(env, constants, #name, value) == napi_ok);\
@@ -122,11 +353,15 @@ napi_value Init(napi_env env, napi_value exports) {
 
   CHECK(napi_create_object(env, &constants) == napi_ok);
   napi_property_descriptor descriptors[] = {
-    { "start",     NULL,  FSEStart, NULL, NULL,  NULL, napi_default, NULL },
-    { "stop",      NULL,  FSEStop,  NULL, NULL,  NULL, napi_default, NULL },
-    { "constants", NULL,  NULL,     NULL, NULL,  constants, napi_default, NULL }
+    { "start",       NULL,  FSEStart,       NULL, NULL,  NULL, napi_default, NULL },
+    { "stop",        NULL,  FSEStop,        NULL, NULL,  NULL, napi_default, NULL },
+    { "stats",       NULL,  FSEStats,       NULL, NULL,  NULL, napi_default, NULL },
+    { "traceEnable", NULL,  FSETraceEnable, NULL, NULL,  NULL, napi_default, NULL },
+    { "traceClear",  NULL,  FSETraceClear,  NULL, NULL,  NULL, napi_default, NULL },
+    { "traceDump",   NULL,  FSETraceDump,   NULL, NULL,  NULL, napi_default, NULL },
+    { "constants",   NULL,  NULL,           NULL, NULL,  constants, napi_default, NULL }
   };
-  CHECK(napi_define_properties(env, exports, 3, descriptors) == napi_ok);
+  CHECK(napi_define_properties(env, exports, 7, descriptors) == napi_ok);
 
   CONSTANT(kFSEventStreamEventFlagNone);
   CONSTANT(kFSEventStreamEventFlagMustScanSubDirs);
@@ -2,7 +2,9 @@
 #include "CoreFoundation/CoreFoundation.h"
 #include "CoreServices/CoreServices.h"
 #include <pthread.h>
+#include <string.h>
 #include <assert.h>
+#include <adone_trace.h>
 
 #ifndef CHECK
 #ifdef NDEBUG
@@ -24,6 +26,8 @@ struct fse_watcher_s {
   FSEventStreamRef stream;
   fse_event_handler_t handler;
   fse_thread_hook_t hookend;
+  fse_filter_t filter;
+  fse_stats_t stats;
   void *context;
 };
 
@@ -65,20 +69,38 @@ void fse_handle_events(
 ) {
   fse_watcher_t watcher = data;
   if (!watcher->handler) return;
-  fse_event_t *events = malloc(sizeof(*events) * numEvents);
-  CHECK(events);
-  size_t idx;
+  ADONE_TRACE_SCOPE("fsevents", "read");
+  fse_event_t *events = NULL;
+  size_t idx, count = 0;
+  char buffer[PATH_MAX];
+  FSE_STAT_ADD(watcher->stats.received, numEvents);
   for (idx=0; idx < numEvents; idx++) {
-    fse_event_t *event = &events[idx];
     CFStringRef path = (CFStringRef)CFArrayGetValueAtIndex((CFArrayRef)eventPaths, idx);
-    strncpy(event->path, CFStringGetCStringPtr(path, kCFStringEncodingUTF8), sizeof(event->path));
+    const char *cpath = CFStringGetCStringPtr(path, kCFStringEncodingUTF8);
+    // the string has no UTF-8 storage of its own when it is not ASCII, it is converted into ours then
+    if (!cpath) {
+      if (!CFStringGetCString(path, buffer, sizeof(buffer), kCFStringEncodingUTF8)) continue;
+      cpath = buffer;
+    }
+    // ignored paths are dropped here and never reach the JS thread
+    if (!fse_filter_match(watcher->filter, cpath)) {
+      FSE_STAT_ADD(watcher->stats.filtered, 1);
+      continue;
+    }
+    if (!events) {
+      events = malloc(sizeof(*events) * (numEvents - idx));
+      CHECK(events);
+    }
+    fse_event_t *event = &events[count++];
+    strncpy(event->path, cpath, sizeof(event->path));
     event->id = eventIds[idx];
     event->flags = eventFlags[idx];
   }
+  if (!count) return;
   if (!watcher->handler) {
     free(events);
   } else {
-    watcher->handler(watcher->context, numEvents, events);
+    watcher->handler(watcher->context, count, events);
   }
 }
 
@@ -88,12 +110,14 @@ void fse_clear(fse_watcher_t watcher) {
   watcher->stream = NULL;
   watcher->context = NULL;
   watcher->hookend = NULL;
+  watcher->filter = NULL;
 }
 
 fse_watcher_t fse_alloc() {
   fse_watcher_t watcher = malloc(sizeof(*watcher));
   CHECK(watcher);
   fse_clear(watcher);
+  memset(&watcher->stats, 0, sizeof(watcher->stats));
   return watcher;
 }
 
@@ -102,7 +126,7 @@ void fse_free(fse_watcher_t watcher) {
   free(watcher);
 }
 
-void fse_watch(const char *path, fse_event_handler_t handler, void *context, fse_thread_hook_t hookstart, fse_thread_hook_t hookend, fse_watcher_t watcher) {
+int fse_watch(const char *path, fse_filter_t filter, fse_event_handler_t handler, void *context, fse_thread_hook_t hookstart, fse_thread_hook_t hookend, fse_watcher_t watcher) {
   pthread_mutex_lock(&fsevents.lock);
   if (!fsevents.loop) {
     pthread_create(&fsevents.thread, NULL, fse_run_loop, NULL);
@@ -113,6 +137,7 @@ void fse_watch(const char *path, fse_event_handler_t handler, void *context, fse
   strncpy(watcher->path, path, PATH_MAX);
   watcher->handler = handler;
   watcher->context = context;
+  watcher->filter = filter;
   CFRunLoopPerformBlock(fsevents.loop, kCFRunLoopDefaultMode, ^(void){
     if (hookstart) hookstart(watcher->context);
     FSEventStreamContext streamcontext = { 0, watcher, NULL, NULL, NULL };
@@ -123,16 +148,20 @@ void fse_watch(const char *path, fse_event_handler_t handler, void *context, fse
   });
   CFRunLoopWakeUp(fsevents.loop);
   pthread_mutex_unlock(&fsevents.lock);
+  return 0;
 }
 
 void fse_unwatch(fse_watcher_t watcher) {
   FSEventStreamRef stream = watcher->stream;
   fse_thread_hook_t hookend = watcher->hookend;
+  fse_filter_t filter = watcher->filter;
   void *context = watcher->context;
   fse_clear(watcher);
 
   pthread_mutex_lock(&fsevents.lock);
-  if (fsevents.loop) {
+  if (!fsevents.loop) {
+    fse_filter_free(filter);
+  } else {
     CFRunLoopPerformBlock(fsevents.loop, kCFRunLoopDefaultMode, ^(void){
       if (stream) {
         FSEventStreamStop(stream);
@@ -140,6 +169,8 @@ void fse_unwatch(fse_watcher_t watcher) {
         FSEventStreamInvalidate(stream);
         FSEventStreamRelease(stream);
       }
+      // the stream is gone, so nothing on this thread can look at the filter anymore
+      fse_filter_free(filter);
       if (hookend) hookend(context);
     });
   }
@@ -149,3 +180,7 @@ void fse_unwatch(fse_watcher_t watcher) {
 void *fse_context_of(fse_watcher_t watcher) {
   return watcher->context;
 }
+
+const fse_stats_t *fse_stats_of(fse_watcher_t watcher) {
+  return &watcher->stats;
+}
@@ -2,14 +2,26 @@
 #define __loop_h
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <limits.h>
 
+#include "filter.h"
+
 typedef struct {
   unsigned long long id;
   char path[PATH_MAX];
   unsigned int flags;
 } fse_event_t;
 
+// per-watcher counters maintained by the backend thread, read from the JS thread
+typedef struct {
+  uint64_t received;
+  uint64_t filtered;
+} fse_stats_t;
+
+#define FSE_STAT_ADD(field, n) __atomic_fetch_add(&(field), (n), __ATOMIC_RELAXED)
+#define FSE_STAT_GET(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+
 typedef void (*fse_event_handler_t)(void *context, size_t numevents, fse_event_t *events);
 typedef void (*fse_thread_hook_t)(void *context);
 typedef struct fse_watcher_s* fse_watcher_t;
@@ -17,7 +29,9 @@ typedef struct fse_watcher_s* fse_watcher_t;
 void fse_init();
 fse_watcher_t fse_alloc();
 void fse_free(fse_watcher_t watcherp);
-void fse_watch(const char *path, fse_event_handler_t handler, void *context, fse_thread_hook_t hookstart, fse_thread_hook_t hookend, fse_watcher_t watcher_p);
+// Returns 0, or -1 with errno set if the watcher could not be started, the filter is freed then
+int fse_watch(const char *path, fse_filter_t filter, fse_event_handler_t handler, void *context, fse_thread_hook_t hookstart, fse_thread_hook_t hookend, fse_watcher_t watcher_p);
 void fse_unwatch(fse_watcher_t watcher);
 void *fse_context_of(fse_watcher_t watcher);
+const fse_stats_t *fse_stats_of(fse_watcher_t watcher);
 #endif
@@ -0,0 +1,374 @@
+/*
+** Linux (inotify) implementation of the rawfsevents.h interface.
+**
+** Every watcher owns an inotify descriptor and a thread that reads it. Events are
+** translated into FSEvents flags, so the JS side does not have to care which backend
+** produced them. Directories excluded by the watcher filter are never watched at all.
+*/
+
+#define _GNU_SOURCE
+
+#include "rawfsevents.h"
+#include "constants.h"
+#include <adone_trace.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+
+#ifndef CHECK
+#ifdef NDEBUG
+#define CHECK(x) do { if (!(x)) abort(); } while (0)
+#else
+#define CHECK assert
+#endif
+#endif
+
+#define FSE_INOTIFY_MASK (IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF)
+#define FSE_INOTIFY_BUFSIZE (64 * 1024)
+
+typedef struct {
+  size_t count;
+  size_t capacity;
+  fse_event_t *events;
+} fse_batch_t;
+
+struct fse_watcher_s {
+  char path[PATH_MAX];
+  int fd;
+  int wakeup[2];
+  int running;
+  int rootwd;
+  int rootisdir;
+  pthread_t thread;
+  fse_event_handler_t handler;
+  fse_thread_hook_t hookstart;
+  fse_thread_hook_t hookend;
+  fse_filter_t filter;
+  fse_stats_t stats;
+  void *context;
+  char **wdpaths;
+  size_t wdcapacity;
+  unsigned long long nextid;
+};
+
+void fse_init() {
+}
+
+static void fse_batch_append(fse_watcher_t watcher, fse_batch_t *batch, const char *path, unsigned int flags) {
+  if (batch->count == batch->capacity) {
+    batch->capacity = batch->capacity ? batch->capacity * 2 : 16;
+    batch->events = realloc(batch->events, sizeof(*batch->events) * batch->capacity);
+    CHECK(batch->events);
+  }
+  fse_event_t *event = &batch->events[batch->count++];
+  strncpy(event->path, path, sizeof(event->path) - 1);
+  event->path[sizeof(event->path) - 1] = 0;
+  event->flags = flags;
+  event->id = ++watcher->nextid;
+}
+
+static void fse_batch_push(fse_watcher_t watcher, fse_batch_t *batch, const char *path, unsigned int flags) {
+  FSE_STAT_ADD(watcher->stats.received, 1);
+  if (!fse_filter_match(watcher->filter, path)) {
+    FSE_STAT_ADD(watcher->stats.filtered, 1);
+    return;
+  }
+  fse_batch_append(watcher, batch, path, flags);
+}
+
+static void fse_batch_flush(fse_watcher_t watcher, fse_batch_t *batch) {
+  if (!batch->count) return;
+  if (!watcher->handler) {
+    free(batch->events);
+  } else {
+    // the handler takes ownership of the events
+    watcher->handler(watcher->context, batch->count, batch->events);
+  }
+  batch->events = NULL;
+  batch->count = 0;
+  batch->capacity = 0;
+}
+
+static int fse_add_watch(fse_watcher_t watcher, const char *path, uint32_t extra) {
+  int wd = inotify_add_watch(watcher->fd, path, FSE_INOTIFY_MASK | extra);
+  if (wd < 0) return wd;
+  if ((size_t)wd >= watcher->wdcapacity) {
+    size_t capacity = watcher->wdcapacity ? watcher->wdcapacity : 64;
+    while (capacity <= (size_t)wd) capacity *= 2;
+    watcher->wdpaths = realloc(watcher->wdpaths, sizeof(char *) * capacity);
+    CHECK(watcher->wdpaths);
+    memset(watcher->wdpaths + watcher->wdcapacity, 0, sizeof(char *) * (capacity - watcher->wdcapacity));
+    watcher->wdcapacity = capacity;
+  }
+  free(watcher->wdpaths[wd]);
+  watcher->wdpaths[wd] = strdup(path);
+  CHECK(watcher->wdpaths[wd]);
+  return wd;
+}
+
+static void fse_remove_wd(fse_watcher_t watcher, int wd) {
+  if (wd < 0 || (size_t)wd >= watcher->wdcapacity) return;
+  free(watcher->wdpaths[wd]);
+  watcher->wdpaths[wd] = NULL;
+}
+
+/*
+** Stops watching a directory that was moved away and all the directories below it. Their
+** watches follow the inodes, they would keep reporting under the old paths, or under paths
+** outside of the root. A move within the root watches the tree again on IN_MOVED_TO.
+*/
+static void fse_remove_tree(fse_watcher_t watcher, const char *dirpath) {
+  size_t length = strlen(dirpath);
+  size_t wd;
+  for (wd = 0; wd < watcher->wdcapacity; wd++) {
+    const char *path = watcher->wdpaths[wd];
+    if (path && (int)wd != watcher->rootwd && !strncmp(path, dirpath, length) && (path[length] == '/' || !path[length])) {
+      inotify_rm_watch(watcher->fd, (int)wd);
+      fse_remove_wd(watcher, (int)wd);
+    }
+  }
+}
+
+/*
+** A directory that can not be watched because the inotify watch limit is reached
+** (fs.inotify.max_user_watches) is reported with MustScanSubDirs | UserDropped, whatever the
+** filter, so that the loss of its events is not silent.
+*/
+static int fse_watch_dir(fse_watcher_t watcher, const char *dirpath, uint32_t extra, fse_batch_t *batch) {
+  int wd = fse_add_watch(watcher, dirpath, extra);
+  if (wd < 0 && errno == ENOSPC) {
+    fse_batch_append(watcher, batch, dirpath, kFSEventStreamEventFlagMustScanSubDirs | kFSEventStreamEventFlagUserDropped | kFSEventStreamEventFlagItemIsDir);
+  }
+  return wd;
+}
+
+static void fse_add_tree(fse_watcher_t watcher, const char *dirpath, fse_batch_t *batch, int created);
+
+/*
+** Watches subdirectories of the directory that are not pruned by the filter.
+** When created is set, entries found during the scan are reported as created, this covers
+** files written into a new directory before its watch was established.
+*/
+static void fse_scan_dir(fse_watcher_t watcher, const char *dirpath, fse_batch_t *batch, int created) {
+  char path[PATH_MAX];
+  struct dirent *entry;
+  DIR *dir;
+
+  if (!(dir = opendir(dirpath))) return;
+
+  while ((entry = readdir(dir))) {
+    if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..")) continue;
+    if ((size_t)snprintf(path, sizeof(path), "%s/%s", dirpath, entry->d_name) >= sizeof(path)) continue;
+
+    int isdir = entry->d_type == DT_DIR;
+    if (entry->d_type == DT_UNKNOWN) {
+      struct stat st;
+      isdir = !lstat(path, &st) && S_ISDIR(st.st_mode);
+    }
+    if (created) {
+      fse_batch_push(watcher, batch, path, kFSEventStreamEventFlagItemCreated | (isdir ? kFSEventStreamEventFlagItemIsDir : kFSEventStreamEventFlagItemIsFile));
+    }
+    if (isdir) fse_add_tree(watcher, path, batch, created);
+  }
+  closedir(dir);
+}
+
+static void fse_add_tree(fse_watcher_t watcher, const char *dirpath, fse_batch_t *batch, int created) {
+  if (fse_filter_prunes(watcher->filter, dirpath)) return;
+  if (fse_watch_dir(watcher, dirpath, IN_ONLYDIR | IN_DONT_FOLLOW, batch) < 0) return;
+  fse_scan_dir(watcher, dirpath, batch, created);
+}
+
+static void fse_handle_event(fse_watcher_t watcher, const struct inotify_event *ev, fse_batch_t *batch) {
+  char path[PATH_MAX];
+  unsigned int flags = 0;
+  const char *dirpath;
+
+  if (ev->mask & IN_Q_OVERFLOW) {
+    fse_batch_push(watcher, batch, watcher->path, kFSEventStreamEventFlagMustScanSubDirs | kFSEventStreamEventFlagKernelDropped);
+    return;
+  }
+  if (ev->mask & IN_IGNORED) {
+    fse_remove_wd(watcher, ev->wd);
+    return;
+  }
+  if (ev->wd < 0 || (size_t)ev->wd >= watcher->wdcapacity || !(dirpath = watcher->wdpaths[ev->wd])) return;
+
+  if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+    // other directories are handled through the events of their parent
+    if (ev->wd == watcher->rootwd) {
+      flags = kFSEventStreamEventFlagRootChanged | ((ev->mask & IN_DELETE_SELF) ? kFSEventStreamEventFlagItemRemoved : kFSEventStreamEventFlagItemRenamed);
+      fse_batch_push(watcher, batch, watcher->path, flags | (watcher->rootisdir ? kFSEventStreamEventFlagItemIsDir : kFSEventStreamEventFlagItemIsFile));
+    }
+    return;
+  }
+
+  if (ev->len && ev->name[0]) {
+    if ((size_t)snprintf(path, sizeof(path), "%s/%s", dirpath, ev->name) >= sizeof(path)) return;
+  } else {
+    strncpy(path, dirpath, sizeof(path) - 1);
+    path[sizeof(path) - 1] = 0;
+  }
+
+  if (ev->mask & IN_CREATE) flags |= kFSEventStreamEventFlagItemCreated;
+  if (ev->mask & IN_DELETE) flags |= kFSEventStreamEventFlagItemRemoved;
+  if (ev->mask & (IN_MOVED_FROM | IN_MOVED_TO)) flags |= kFSEventStreamEventFlagItemRenamed;
+  if (ev->mask & IN_MODIFY) flags |= kFSEventStreamEventFlagItemModified;
+  if (ev->mask & IN_ATTRIB) flags |= kFSEventStreamEventFlagItemInodeMetaMod;
+  flags |= (ev->mask & IN_ISDIR) ? kFSEventStreamEventFlagItemIsDir : kFSEventStreamEventFlagItemIsFile;
+
+  fse_batch_push(watcher, batch, path, flags);
+
+  if ((ev->mask & IN_ISDIR) && (ev->mask & IN_MOVED_FROM)) {
+    fse_remove_tree(watcher, path);
+  }
+  if ((ev->mask & IN_ISDIR) && (ev->mask & (IN_CREATE | IN_MOVED_TO))) {
+    fse_add_tree(watcher, path, batch, 1);
+  }
+}
+
+static void *fse_run_loop(void *data) {
+  fse_watcher_t watcher = data;
+  char *buffer = malloc(FSE_INOTIFY_BUFSIZE);
+  struct pollfd fds[2];
+  fse_batch_t batch = { 0, 0, NULL };
+  struct stat st;
+
+  CHECK(buffer);
+  if (watcher->hookstart) watcher->hookstart(watcher->context);
+
+  watcher->rootisdir = !stat(watcher->path, &st) && S_ISDIR(st.st_mode);
+  // the root itself is watched even when the filter excludes it and may be a symlink
+  watcher->rootwd = fse_watch_dir(watcher, watcher->path, 0, &batch);
+  if (watcher->rootwd >= 0 && watcher->rootisdir) {
+    fse_scan_dir(watcher, watcher->path, &batch, 0);
+  }
+  fse_batch_flush(watcher, &batch);
+
+  fds[0].fd = watcher->fd;
+  fds[0].events = POLLIN;
+  fds[1].fd = watcher->wakeup[0];
+  fds[1].events = POLLIN;
+
+  for (;;) {
+    if (poll(fds, 2, -1) < 0) continue;
+    if (fds[1].revents) break;
+    if (!(fds[0].revents & POLLIN)) continue;
+
+    ssize_t len = read(watcher->fd, buffer, FSE_INOTIFY_BUFSIZE);
+    if (len <= 0) continue;
+
+    ADONE_TRACE_SCOPE("fsevents", "read");
+    ssize_t offset = 0;
+    while (offset < len) {
+      const struct inotify_event *ev = (const struct inotify_event *)(buffer + offset);
+      fse_handle_event(watcher, ev, &batch);
+      offset += sizeof(struct inotify_event) + ev->len;
+    }
+    fse_batch_flush(watcher, &batch);
+  }
+
+  free(batch.events);
+  free(buffer);
+  if (watcher->hookend) watcher->hookend(watcher->context);
+  return NULL;
+}
+
+void fse_clear(fse_watcher_t watcher) {
+  watcher->path[0] = 0;
+  watcher->fd = -1;
+  watcher->wakeup[0] = watcher->wakeup[1] = -1;
+  watcher->running = 0;
+  watcher->rootwd = -1;
+  watcher->rootisdir = 0;
+  watcher->handler = NULL;
+  watcher->hookstart = NULL;
+  watcher->hookend = NULL;
+  watcher->filter = NULL;
+  watcher->context = NULL;
+  watcher->wdpaths = NULL;
+  watcher->wdcapacity = 0;
+  watcher->nextid = 0;
+}
+
+fse_watcher_t fse_alloc() {
+  fse_watcher_t watcher = malloc(sizeof(*watcher));
+  CHECK(watcher);
+  fse_clear(watcher);
+  memset(&watcher->stats, 0, sizeof(watcher->stats));
+  return watcher;
+}
+
+void fse_free(fse_watcher_t watcher) {
+  fse_unwatch(watcher);
+  free(watcher);
+}
+
+// Releases what fse_watch acquired before it failed, errno is preserved
+static void fse_watch_failed(fse_watcher_t watcher) {
+  int err = errno;
+  if (watcher->fd >= 0) close(watcher->fd);
+  if (watcher->wakeup[0] >= 0) close(watcher->wakeup[0]);
+  if (watcher->wakeup[1] >= 0) close(watcher->wakeup[1]);
+  fse_filter_free(watcher->filter);
+  fse_clear(watcher);
+  errno = err;
+}
+
+int fse_watch(const char *path, fse_filter_t filter, fse_event_handler_t handler, void *context, fse_thread_hook_t hookstart, fse_thread_hook_t hookend, fse_watcher_t watcher) {
+  int err;
+
+  strncpy(watcher->path, path, PATH_MAX - 1);
+  watcher->path[PATH_MAX - 1] = 0;
+  watcher->handler = handler;
+  watcher->context = context;
+  watcher->filter = filter;
+  watcher->hookstart = hookstart;
+  watcher->hookend = hookend;
+
+  // EMFILE is easy to hit (fs.inotify.max_user_instances), the caller reports the failure
+  watcher->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (watcher->fd < 0 || pipe2(watcher->wakeup, O_CLOEXEC) != 0) {
+    fse_watch_failed(watcher);
+    return -1;
+  }
+  if ((err = pthread_create(&watcher->thread, NULL, fse_run_loop, watcher)) != 0) {
+    errno = err;
+    fse_watch_failed(watcher);
+    return -1;
+  }
+  watcher->running = 1;
+  return 0;
+}
+
+void fse_unwatch(fse_watcher_t watcher) {
+  size_t idx;
+  if (!watcher->running) return;
+
+  CHECK(write(watcher->wakeup[1], "x", 1) == 1);
+  pthread_join(watcher->thread, NULL);
+
+  close(watcher->fd);
+  close(watcher->wakeup[0]);
+  close(watcher->wakeup[1]);
+  for (idx = 0; idx < watcher->wdcapacity; idx++) free(watcher->wdpaths[idx]);
+  free(watcher->wdpaths);
+  fse_filter_free(watcher->filter);
+  fse_clear(watcher);
+}
+
+void *fse_context_of(fse_watcher_t watcher) {
+  return watcher->context;
+}
+
+const fse_stats_t *fse_stats_of(fse_watcher_t watcher) {
+  return &watcher->stats;
+}
@@ -24,6 +24,34 @@ export const encode = (packet) => {
     return buf;
 };
 
+// Appends the packet to the buffer as a frame: the size of the rest of the frame (uint32 BE), then the
+// same bytes as encode() writes. Nothing is appended if the data cannot be encoded.
+export const encodeFrame = (packet, buffer) => {
+    __.serializer.encoder.encodeFrame(packet.data, packet.flags, packet.id, buffer);
+    return buffer;
+};
+
+// Decodes the complete frames of the buffer and moves its read offset after them, the packets are
+// appended to `packets`. Throws if a frame is not valid, the packets before it are appended.
+export const decodeFrames = (buffer, packets) => {
+    const frames = [];
+    let valid = false;
+    try {
+        valid = __.serializer.decoder.decodeFrames(buffer, frames);
+    } finally {
+        for (let i = 0; i < frames.length; i += 3) {
+            const pkt = new __.Packet();
+            pkt.flags = frames[i];
+            pkt.id = frames[i + 1];
+            pkt.data = frames[i + 2];
+            packets.push(pkt);
+        }
+    }
+    if (!valid) {
+        throw new error.NotValidException("Invalid packet");
+    }
+};
+
 export const decode = (buffer) => {
     const result = __.serializer.decoder.tryDecode(buffer);
     if (result) {
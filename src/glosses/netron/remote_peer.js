@@ -3,11 +3,13 @@ const {
     collection: { TimeMap },
     netron: { ACTION, AbstractPeer, packet, uid: { FastUid }, Reference },
     stream: { iterable },
+    buffer: { SmartBuffer },
     error
 } = adone;
 
 const ON_CONNECT_TASKS = ["netronGetConfig", "netronGetContextDefs"];
-const HEADER_BUFFER = Buffer.alloc(4);
+// The initial capacity of the buffer of the packets written in a tick
+const FRAMES_CAPACITY = 1024;
 
 const normalizeError = (err) => {
     let normErr;
@@ -27,6 +29,15 @@ export default class RemotePeer extends AbstractPeer {
         super(options);
 
         this._writer = null;
+        // The frames of the packets written in the current tick, they are pushed to the writer at once
+        this._frames = null;
+        this._flushFrames = () => {
+            const frames = this._frames;
+            this._frames = null;
+            if (!is.null(frames) && frames.length > 0 && !is.null(this._writer)) {
+                this._writer.push(frames.toBuffer());
+            }
+        };
         // this.protocol = null;
         this.connectedTime = null;
 
@@ -192,9 +203,11 @@ export default class RemotePeer extends AbstractPeer {
         return new Promise((resolve, reject) => {
             // if (!is.null(this.connection)) {
             if (!is.null(this._writer)) {
-                const rawPkt = packet.encode(pkt).toBuffer();
-                HEADER_BUFFER.writeUInt32BE(rawPkt.length, 0);
-                this._writer.push(Buffer.concat([HEADER_BUFFER, rawPkt]));
+                if (is.null(this._frames)) {
+                    this._frames = new SmartBuffer(FRAMES_CAPACITY, true);
+                    process.nextTick(this._flushFrames);
+                }
+                packet.encodeFrame(pkt, this._frames);
                 resolve();
             } else {
                 resolve(); // TODO: is it correct or me be
@@ -279,6 +292,7 @@ export default class RemotePeer extends AbstractPeer {
         if (!stream) {
             const id = this.id;
 
+            this._flushFrames();
             this._writer.end();
             this._writer = null;
 
@@ -320,8 +334,7 @@ export default class RemotePeer extends AbstractPeer {
         });
 
         // receive data from remote netron
-        const permBuffer = new adone.buffer.SmartBuffer(0);
-        let lpsz = 0;
+        const permBuffer = new SmartBuffer(0);
 
         iterable.pipe(
             this._writer,
@@ -337,31 +350,22 @@ export default class RemotePeer extends AbstractPeer {
                     const buffer = permBuffer;
                     buffer.write(chunk);
 
-                    for (; ;) {
-                        if (buffer.length <= 4) {
-                            break;
-                        }
-                        let packetSize = lpsz;
-                        if (packetSize === 0) {
-                            lpsz = packetSize = buffer.readUInt32BE();
-                        }
-                        if (buffer.length < packetSize) {
-                            break;
-                        }
+                    const packets = [];
+                    try {
+                        packet.decodeFrames(buffer, packets);
+                    } catch (err) {
+                        buffer.roffset = buffer.woffset;
+                        // console.error(adone.pretty.error(err));
+                    }
 
-                        try {
-                            const roffset = buffer.roffset;
-                            const pkt = packet.decode(buffer);
-                            if (packetSize !== (buffer.roffset - roffset)) {
-                                throw new error.NotValidException("Invalid packet");
-                            }
-                            this._processPacket(pkt);
-                        } catch (err) {
-                            buffer.reset(true);
-                            // console.error(adone.pretty.error(err));
-                        } finally {
-                            lpsz = 0;
-                        }
+                    // the decoded binary values are views of the receive buffer, so the bytes of the incomplete
+                    // frame are moved to a new one instead of the start of this one
+                    if (buffer.roffset > 0) {
+                        buffer.compact(buffer.roffset, buffer.woffset);
+                    }
+
+                    for (const pkt of packets) {
+                        this._processPacket(pkt);
                     }
                 }
             }
@@ -11,7 +11,8 @@ adone.lazify({
     NodejsManager: "./manager",
     NodejsCompiler: "./compiler",
     cmake: "./cmake",
-    FsCache: "./fs_cache"
+    FsCache: "./fs_cache",
+    trace: "./trace"
 }, adone.asNamespace(exports), require);
 
 
@@ -0,0 +1,78 @@
+const {
+    is,
+    fs,
+    std
+} = adone;
+
+adone.asNamespace(exports);
+
+// Native addons record tracing spans into their own buffers (see src/native/adone/adone_trace.h)
+// and export traceEnable(), traceClear() and traceDump(). This module keeps track of the loaded
+// addons and merges their spans into a single trace in the Chrome trace-event format, that can be
+// opened in chrome://tracing or Perfetto.
+//
+// Setting the ADONE_TRACE environment variable enables tracing on startup, if its value is not "1"
+// it is used as a path the trace is written to when the process exits.
+
+const addons = new Map();
+const env = process.env.ADONE_TRACE;
+let enabled = Boolean(env) && env !== "0";
+
+export const register = (name, addon) => {
+    if (!is.function(addon.traceDump)) {
+        return addon;
+    }
+    addons.set(name, addon);
+    addon.traceEnable(enabled);
+    return addon;
+};
+
+export const unregister = (name) => {
+    addons.delete(name);
+};
+
+export const getAddonNames = () => [...addons.keys()];
+
+export const isEnabled = () => enabled;
+
+export const enable = () => {
+    enabled = true;
+    for (const addon of addons.values()) {
+        addon.traceEnable(true);
+    }
+};
+
+export const disable = () => {
+    enabled = false;
+    for (const addon of addons.values()) {
+        addon.traceEnable(false);
+    }
+};
+
+export const clear = () => {
+    for (const addon of addons.values()) {
+        addon.traceClear();
+    }
+};
+
+export const dump = () => {
+    const traceEvents = [];
+    for (const addon of addons.values()) {
+        for (const event of JSON.parse(addon.traceDump())) {
+            traceEvents.push(event);
+        }
+    }
+    traceEvents.sort((a, b) => a.ts - b.ts);
+    return {
+        traceEvents,
+        displayTimeUnit: "ms"
+    };
+};
+
+export const save = (path) => fs.writeFile(path, JSON.stringify(dump()));
+
+if (enabled && env !== "1") {
+    process.on("exit", () => {
+        std.fs.writeFileSync(env, JSON.stringify(dump()));
+    });
+}
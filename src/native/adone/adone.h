@@ -41,7 +41,10 @@
 #include <wchar.h>
 #include <cstdio>
 #include <cstdlib>
+#include <cstdint>
 #include <cstring>
+#include <mutex>
+#include <vector>
 #include <nan.h>
 
 using namespace v8;
@@ -67,6 +70,194 @@ inline T Unmaybe(Nan::Maybe<T> h) {
 
 #define THROW_BAD_ARGS Nan::ThrowTypeError("Bad argument")
 
+namespace adone {
+
+// Size-class pool for the memory behind Node buffers returned by addons.
+//
+// Blocks are handed out to Node as externally backed buffers whose finalizer puts the block
+// back to the free list of its class, so steady-state encode/decode does not hit malloc/free.
+// Each class keeps at most kMaxCachedBytes of free blocks, requests above the largest class
+// are served by malloc directly. Acquire/Release are thread-safe, output can be allocated on
+// worker threads and wrapped into a buffer on the JS thread.
+//
+// One pool is shared by all adone addons of an isolate (see GetBufferPool), only virtual
+// calls cross module boundaries. Bump the version in kBufferPoolKey when the layout changes.
+class BufferPool {
+public:
+    static const size_t kMinClassShift = 8; // 256 bytes
+    static const size_t kClassCount = 15; // up to 4MB
+    static const size_t kMaxCachedBytes = 8 << 20;
+    static const size_t kHeaderSize = 16;
+    static const size_t kExternalThreshold = 64 << 10;
+
+    BufferPool() {}
+
+    virtual char *Acquire(size_t size) {
+        size_t cls = ClassOf(size);
+        char *block = NULL;
+        if (cls < kClassCount) {
+            FreeList &list = lists[cls];
+            std::lock_guard<std::mutex> lock(list.mutex);
+            if (!list.blocks.empty()) {
+                block = list.blocks.back();
+                list.blocks.pop_back();
+            }
+        }
+        if (block == NULL) {
+            block = static_cast<char *>(malloc(kHeaderSize + (cls < kClassCount ? ClassSize(cls) : size)));
+            if (block == NULL) {
+                return NULL;
+            }
+            *reinterpret_cast<uint32_t *>(block) = static_cast<uint32_t>(cls);
+            *reinterpret_cast<uint32_t *>(block + 4) = static_cast<uint32_t>(size);
+        }
+        return block + kHeaderSize;
+    }
+
+    virtual void Release(char *data) {
+        if (data == NULL) {
+            return;
+        }
+        char *block = data - kHeaderSize;
+        size_t cls = *reinterpret_cast<uint32_t *>(block);
+        if (cls < kClassCount) {
+            FreeList &list = lists[cls];
+            std::lock_guard<std::mutex> lock(list.mutex);
+            if ((list.blocks.size() + 1) * ClassSize(cls) <= kMaxCachedBytes || list.blocks.empty()) {
+                list.blocks.push_back(block);
+                return;
+            }
+        }
+        free(block);
+    }
+
+    // drops all cached blocks
+    virtual void Trim() {
+        for (size_t cls = 0; cls < kClassCount; cls++) {
+            FreeList &list = lists[cls];
+            std::lock_guard<std::mutex> lock(list.mutex);
+            for (char *block : list.blocks) {
+                free(block);
+            }
+            list.blocks.clear();
+        }
+    }
+
+    // Turns memory obtained from Acquire into a Node buffer, the pool takes care of the memory
+    // from now on. Small blocks are copied into a regular buffer and recycled right away, since
+    // creating an externally backed buffer costs more than copying them. Large ones are handed
+    // over without copying and come back to the pool when the buffer is collected.
+    Local<Object> NewBuffer(char *data, size_t length) {
+        if (length < kExternalThreshold) {
+            Local<Object> buffer = Nan::CopyBuffer(data, static_cast<uint32_t>(length)).ToLocalChecked();
+            Release(data);
+            return buffer;
+        }
+        // V8 does not see memory behind external buffers, it is reported explicitly so that
+        // the GC runs as often as it would for regular buffers
+        Nan::AdjustExternalMemory(static_cast<int>(Capacity(data)));
+        return Nan::NewBuffer(data, length, FreeCallback, this).ToLocalChecked();
+    }
+
+    static size_t Capacity(const char *data) {
+        size_t cls = *reinterpret_cast<const uint32_t *>(data - kHeaderSize);
+        return cls < kClassCount ? ClassSize(cls) : *reinterpret_cast<const uint32_t *>(data - kHeaderSize + 4);
+    }
+
+    static size_t ClassSize(size_t cls) {
+        return static_cast<size_t>(1) << (cls + kMinClassShift);
+    }
+
+    static size_t ClassOf(size_t size) {
+        size_t cls = 0;
+        while (cls < kClassCount && ClassSize(cls) < size) {
+            cls++;
+        }
+        return cls;
+    }
+
+private:
+    struct FreeList {
+        std::mutex mutex;
+        std::vector<char *> blocks;
+    };
+
+    // called on the JS thread
+    static void FreeCallback(char *data, void *hint) {
+        Nan::AdjustExternalMemory(-static_cast<int>(Capacity(data)));
+        static_cast<BufferPool *>(hint)->Release(data);
+    }
+
+    static void Cleanup(void *arg) {
+        // buffers may still be finalized after the environment is gone, so the pool itself stays
+        static_cast<BufferPool *>(arg)->Trim();
+    }
+
+    FreeList lists[kClassCount];
+
+    friend BufferPool *GetBufferPool();
+};
+
+static const char *const kBufferPoolKey = "adone::BufferPool@1";
+
+// Returns the buffer pool of the current isolate, creating it on first use. JS thread only.
+inline BufferPool *GetBufferPool() {
+    Isolate *isolate = Isolate::GetCurrent();
+    Local<Context> context = isolate->GetCurrentContext();
+    Local<Object> global = context->Global();
+    Local<Private> key = Private::ForApi(isolate, NanStr(kBufferPoolKey));
+
+    Local<Value> value;
+    if (global->GetPrivate(context, key).ToLocal(&value) && value->IsExternal()) {
+        return static_cast<BufferPool *>(value.As<External>()->Value());
+    }
+
+    BufferPool *pool = new BufferPool();
+    node::AddEnvironmentCleanupHook(isolate, BufferPool::Cleanup, pool);
+    global->SetPrivate(context, key, External::New(isolate, pool));
+    return pool;
+}
+
+// Owns a pooled block until it is handed over to a Node buffer. Data() is NULL when the block
+// could not be allocated, callers check it before writing.
+class PooledBuffer {
+public:
+    PooledBuffer(BufferPool *pool, size_t size) : pool(pool), data(pool->Acquire(size)), length(size) {}
+
+    ~PooledBuffer() {
+        pool->Release(data);
+    }
+
+    char *Data() const {
+        return data;
+    }
+
+    size_t Length() const {
+        return length;
+    }
+
+    void SetLength(size_t size) {
+        length = size;
+    }
+
+    // JS thread only
+    Local<Object> ToBuffer() {
+        char *released = data;
+        data = NULL;
+        return pool->NewBuffer(released, length);
+    }
+
+private:
+    PooledBuffer(const PooledBuffer &);
+    PooledBuffer &operator=(const PooledBuffer &);
+
+    BufferPool *pool;
+    char *data;
+    size_t length;
+};
+
+} // namespace adone
+
 #if ADONE_OS_WINDOWS
 #pragma warning( disable : 4244 )
 #include <windows.h>
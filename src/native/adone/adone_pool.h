@@ -0,0 +1,316 @@
+#ifndef __ADONE_POOL_H_
+#define __ADONE_POOL_H_
+
+#include <adone.h>
+#include <uv.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Shared native worker pool.
+//
+// CPU-heavy native work of adone addons runs here instead of the libuv threadpool, so it
+// does not starve fs/dns/crypto requests of Node itself. The pool is created lazily by the
+// first addon that submits a task and is shared by every adone addon of the isolate through
+// a private property of the global object. Workers take tasks from their own queues and steal
+// from the others, higher priorities first. Results are delivered back on the JS thread via a
+// single uv_async handle.
+//
+// The number of threads is taken from the ADONE_NATIVE_POOL_SIZE environment variable,
+// by default it equals to the number of CPUs.
+
+namespace adone {
+
+enum TaskPriority {
+    kPriorityHigh = 0,
+    kPriorityNormal = 1,
+    kPriorityLow = 2
+};
+
+static const int kPriorityCount = 3;
+
+// Execute() runs on a pool thread, Complete() runs on the JS thread that submitted the task,
+// after which the task is deleted.
+class PoolTask {
+public:
+    explicit PoolTask(TaskPriority priority = kPriorityNormal) : priority(priority) {}
+    virtual ~PoolTask() {}
+
+    virtual void Execute() = 0;
+    virtual void Complete() = 0;
+
+    TaskPriority priority;
+};
+
+// The only thing addons see of a pool created by another addon, calls go through the vtable.
+// Bump the version in kExecutorKey whenever this interface changes.
+class Executor {
+public:
+    // must be called on the JS thread
+    virtual void Submit(PoolTask *task) = 0;
+    virtual size_t Size() const = 0;
+    virtual size_t Pending() const = 0;
+
+protected:
+    virtual ~Executor() {}
+};
+
+static const char *const kExecutorKey = "adone::Executor@1";
+
+class ThreadPool : public Executor {
+public:
+    ThreadPool(uv_loop_t *loop, size_t size) : pending(0), next(0), stopping(false), outstanding(0) {
+        async = new uv_async_t;
+        async->data = this;
+        uv_async_init(loop, async, OnComplete);
+        uv_unref(reinterpret_cast<uv_handle_t *>(async));
+
+        for (size_t i = 0; i < size; i++) {
+            queues.emplace_back(new Queue());
+        }
+        for (size_t i = 0; i < size; i++) {
+            threads.emplace_back(&ThreadPool::Work, this, i);
+        }
+    }
+
+    void Submit(PoolTask *task) {
+        Queue &queue = *queues[next++ % queues.size()];
+        // counted before it is published, a worker may take the task and decrement right away
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            pending++;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.tasks[task->priority].push_back(task);
+        }
+        wake.notify_one();
+
+        // keep the loop alive only while there is something to complete
+        if (outstanding++ == 0) {
+            uv_ref(reinterpret_cast<uv_handle_t *>(async));
+        }
+    }
+
+    size_t Size() const {
+        return threads.size();
+    }
+
+    size_t Pending() const {
+        return pending.load();
+    }
+
+    static size_t ConfiguredSize() {
+        const char *value = getenv("ADONE_NATIVE_POOL_SIZE");
+        if (value != NULL) {
+            long size = strtol(value, NULL, 10);
+            if (size > 0) {
+                return static_cast<size_t>(size);
+            }
+        }
+        unsigned cpus = std::thread::hardware_concurrency();
+        return cpus > 0 ? cpus : 4;
+    }
+
+    static void Cleanup(void *arg) {
+        ThreadPool *pool = static_cast<ThreadPool *>(arg);
+        pool->Stop();
+        uv_close(reinterpret_cast<uv_handle_t *>(pool->async), OnClose);
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<PoolTask *> tasks[kPriorityCount];
+    };
+
+    ~ThreadPool() {}
+
+    // own queue is served from the front, the others are stolen from the back
+    PoolTask *Take(size_t index) {
+        size_t count = queues.size();
+        for (int priority = 0; priority < kPriorityCount; priority++) {
+            for (size_t k = 0; k < count; k++) {
+                Queue &queue = *queues[(index + k) % count];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                std::deque<PoolTask *> &tasks = queue.tasks[priority];
+                if (tasks.empty()) {
+                    continue;
+                }
+                PoolTask *task;
+                if (k == 0) {
+                    task = tasks.front();
+                    tasks.pop_front();
+                } else {
+                    task = tasks.back();
+                    tasks.pop_back();
+                }
+                pending--;
+                return task;
+            }
+        }
+        return NULL;
+    }
+
+    void Work(size_t index) {
+        for (;;) {
+            PoolTask *task = Take(index);
+            if (task != NULL) {
+                task->Execute();
+                {
+                    std::lock_guard<std::mutex> lock(doneMutex);
+                    done.push_back(task);
+                }
+                uv_async_send(async);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wake.wait(lock, [this] { return stopping || pending.load() > 0; });
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    void Stop() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &thread : threads) {
+            thread.join();
+        }
+        // tasks that never ran or never completed are dropped without calling back into JS
+        for (std::unique_ptr<Queue> &queue : queues) {
+            for (int priority = 0; priority < kPriorityCount; priority++) {
+                for (PoolTask *task : queue->tasks[priority]) {
+                    delete task;
+                }
+            }
+        }
+        for (PoolTask *task : done) {
+            delete task;
+        }
+        done.clear();
+    }
+
+    static void OnComplete(uv_async_t *handle) {
+        ThreadPool *pool = static_cast<ThreadPool *>(handle->data);
+        std::vector<PoolTask *> tasks;
+        {
+            std::lock_guard<std::mutex> lock(pool->doneMutex);
+            tasks.swap(pool->done);
+        }
+        for (PoolTask *task : tasks) {
+            task->Complete();
+            delete task;
+            if (--pool->outstanding == 0) {
+                uv_unref(reinterpret_cast<uv_handle_t *>(pool->async));
+            }
+        }
+    }
+
+    static void OnClose(uv_handle_t *handle) {
+        ThreadPool *pool = static_cast<ThreadPool *>(handle->data);
+        delete reinterpret_cast<uv_async_t *>(handle);
+        delete pool;
+    }
+
+    std::vector<std::unique_ptr<Queue> > queues;
+    std::vector<std::thread> threads;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::atomic<size_t> pending;
+    std::atomic<size_t> next;
+    bool stopping;
+
+    std::mutex doneMutex;
+    std::vector<PoolTask *> done;
+    uv_async_t *async;
+
+    // JS thread only
+    size_t outstanding;
+};
+
+// Returns the pool of the current isolate, creating it on first use.
+inline Executor *GetExecutor() {
+    Isolate *isolate = Isolate::GetCurrent();
+    Local<Context> context = isolate->GetCurrentContext();
+    Local<Object> global = context->Global();
+    Local<Private> key = Private::ForApi(isolate, NanStr(kExecutorKey));
+
+    Local<Value> value;
+    if (global->GetPrivate(context, key).ToLocal(&value) && value->IsExternal()) {
+        return static_cast<Executor *>(value.As<External>()->Value());
+    }
+
+    ThreadPool *pool = new ThreadPool(Nan::GetCurrentEventLoop(), ThreadPool::ConfiguredSize());
+    node::AddEnvironmentCleanupHook(isolate, ThreadPool::Cleanup, pool);
+    global->SetPrivate(context, key, External::New(isolate, pool));
+    return pool;
+}
+
+// Drop-in replacement of Nan::AsyncWorker running on the shared pool.
+class PoolWorker : public PoolTask {
+public:
+    explicit PoolWorker(Nan::Callback *callback, const char *resource_name = "adone:PoolWorker", TaskPriority priority = kPriorityNormal)
+        : PoolTask(priority), callback(callback), async_resource(new Nan::AsyncResource(resource_name)), queued_at(uv_hrtime()) {}
+
+    virtual ~PoolWorker() {
+        delete callback;
+        delete async_resource;
+    }
+
+    void Complete() {
+        Nan::HandleScope scope;
+        if (errmsg.empty()) {
+            HandleOKCallback();
+        } else {
+            HandleErrorCallback();
+        }
+    }
+
+    void SetErrorMessage(const char *msg) {
+        errmsg = msg;
+    }
+
+    const char *ErrorMessage() const {
+        return errmsg.empty() ? NULL : errmsg.c_str();
+    }
+
+protected:
+    virtual void HandleOKCallback() {
+        Nan::HandleScope scope;
+        callback->Call(0, NULL, async_resource);
+    }
+
+    virtual void HandleErrorCallback() {
+        Nan::HandleScope scope;
+        Local<Value> argv[] = { Nan::Error(errmsg.c_str()) };
+        callback->Call(1, argv, async_resource);
+    }
+
+    Nan::Callback *callback;
+    Nan::AsyncResource *async_resource;
+    // when the worker was created, lets Execute() trace the time spent in the queue
+    uint64_t queued_at;
+
+private:
+    std::string errmsg;
+};
+
+inline void QueueWorker(PoolTask *task) {
+    GetExecutor()->Submit(task);
+}
+
+} // namespace adone
+
+#endif // __ADONE_POOL_H_
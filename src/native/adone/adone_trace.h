@@ -0,0 +1,334 @@
+#ifndef __ADONE_TRACE_H_
+#define __ADONE_TRACE_H_
+
+// Low-overhead tracing spans for adone addons (usable from C and C++).
+//
+// Every thread records finished spans into its own ring buffer, so recording takes no locks.
+// When a ring is full the oldest spans are overwritten. Rings of finished threads are reused by
+// new ones. Spans are exported in the Chrome trace-event format ("X" complete events) and
+// are merged over all addons by adone.nodejs.trace on the JS side.
+//
+// Disabled tracing costs a single relaxed load per scope.
+//
+// Exactly one translation unit of an addon must define ADONE_TRACE_IMPLEMENTATION before
+// including this header. Category and name must be string literals (only pointers are stored).
+//
+//     ADONE_TRACE_SCOPE("snappy", "compress");
+//     ADONE_TRACE_SPAN("snappy", "queued", queuedAt); // from queuedAt until now
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <uv.h>
+
+#ifndef ADONE_TRACE_RING_SIZE
+#define ADONE_TRACE_RING_SIZE 4096
+#endif
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#define ADONE_TRACE_TLS __declspec(thread)
+#define ADONE_TRACE_HIDDEN
+#else
+#include <pthread.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+#define ADONE_TRACE_TLS __thread
+#define ADONE_TRACE_HIDDEN __attribute__((visibility("hidden")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const char *category;
+    const char *name;
+    uint64_t start;
+    uint64_t duration;
+    uint64_t tid;
+} adone_trace_event_t;
+
+typedef struct adone_trace_ring_s {
+    struct adone_trace_ring_s *next;
+    long owned;
+    // id of the owning thread, taken once when it attaches
+    uint64_t tid;
+    // number of events ever written, only the owning thread writes
+    uint64_t head;
+    // events before it were cleared
+    uint64_t tail;
+    adone_trace_event_t events[ADONE_TRACE_RING_SIZE];
+} adone_trace_ring_t;
+
+#if defined(_MSC_VER)
+static inline long adone_trace_load_long(volatile long *p) { return *p; }
+static inline void adone_trace_store_long(volatile long *p, long value) { *p = value; }
+static inline uint64_t adone_trace_load_u64(volatile uint64_t *p) { return *p; }
+static inline void adone_trace_store_u64(volatile uint64_t *p, uint64_t value) { *p = value; }
+static inline adone_trace_ring_t *adone_trace_load_ring(adone_trace_ring_t *volatile *p) { return *p; }
+static inline int adone_trace_cas_long(volatile long *p, long expected, long desired) {
+    return InterlockedCompareExchange(p, desired, expected) == expected;
+}
+static inline int adone_trace_cas_ring(adone_trace_ring_t *volatile *p, adone_trace_ring_t *expected, adone_trace_ring_t *desired) {
+    return InterlockedCompareExchangePointer((void *volatile *)p, desired, expected) == expected;
+}
+#else
+static inline long adone_trace_load_long(long *p) { return __atomic_load_n(p, __ATOMIC_RELAXED); }
+static inline void adone_trace_store_long(long *p, long value) { __atomic_store_n(p, value, __ATOMIC_RELEASE); }
+static inline uint64_t adone_trace_load_u64(uint64_t *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static inline void adone_trace_store_u64(uint64_t *p, uint64_t value) { __atomic_store_n(p, value, __ATOMIC_RELEASE); }
+static inline adone_trace_ring_t *adone_trace_load_ring(adone_trace_ring_t **p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static inline int adone_trace_cas_long(long *p, long expected, long desired) {
+    return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+static inline int adone_trace_cas_ring(adone_trace_ring_t **p, adone_trace_ring_t *expected, adone_trace_ring_t *desired) {
+    return __atomic_compare_exchange_n(p, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+#endif
+
+// every addon has its own copy, so they are hidden to never clash between modules
+extern ADONE_TRACE_HIDDEN long adone_trace_enabled_flag;
+extern ADONE_TRACE_HIDDEN adone_trace_ring_t *adone_trace_rings;
+extern ADONE_TRACE_HIDDEN ADONE_TRACE_TLS adone_trace_ring_t *adone_trace_ring;
+
+ADONE_TRACE_HIDDEN void adone_trace_enable(int enabled);
+ADONE_TRACE_HIDDEN void adone_trace_clear(void);
+ADONE_TRACE_HIDDEN void adone_trace_record(const char *category, const char *name, uint64_t start, uint64_t end);
+// returns a malloc'ed JSON array of trace events
+ADONE_TRACE_HIDDEN char *adone_trace_dump(size_t *length);
+
+static inline int adone_trace_enabled(void) {
+    return adone_trace_load_long(&adone_trace_enabled_flag) != 0;
+}
+
+static inline uint64_t adone_trace_now(void) {
+    return adone_trace_enabled() ? uv_hrtime() : 0;
+}
+
+#define ADONE_TRACE_CONCAT_(a, b) a##b
+#define ADONE_TRACE_CONCAT(a, b) ADONE_TRACE_CONCAT_(a, b)
+
+#define ADONE_TRACE_SPAN(category, name, start) do {\
+    uint64_t __adone_trace_start = (start);\
+    if (__adone_trace_start && adone_trace_enabled()) adone_trace_record((category), (name), __adone_trace_start, uv_hrtime());\
+} while (0)
+
+#ifndef __cplusplus
+typedef struct {
+    const char *category;
+    const char *name;
+    uint64_t start;
+} adone_trace_scope_t;
+
+static inline void adone_trace_scope_end(adone_trace_scope_t *scope) {
+    if (scope->start) adone_trace_record(scope->category, scope->name, scope->start, uv_hrtime());
+}
+
+#define ADONE_TRACE_SCOPE(category, name) \
+    adone_trace_scope_t ADONE_TRACE_CONCAT(__adone_trace_scope_, __LINE__) __attribute__((cleanup(adone_trace_scope_end))) = { (category), (name), adone_trace_now() }
+#endif
+
+#ifdef ADONE_TRACE_IMPLEMENTATION
+
+ADONE_TRACE_HIDDEN long adone_trace_enabled_flag = 0;
+ADONE_TRACE_HIDDEN adone_trace_ring_t *adone_trace_rings = NULL;
+ADONE_TRACE_HIDDEN ADONE_TRACE_TLS adone_trace_ring_t *adone_trace_ring = NULL;
+
+static uint64_t adone_trace_tid(void) {
+#if defined(_MSC_VER)
+    return GetCurrentThreadId();
+#elif defined(__APPLE__)
+    uint64_t tid;
+    pthread_threadid_np(NULL, &tid);
+    return tid;
+#elif defined(__linux__)
+    return (uint64_t)syscall(SYS_gettid);
+#else
+    return (uint64_t)(uintptr_t)pthread_self();
+#endif
+}
+
+#if !defined(_MSC_VER)
+static pthread_key_t adone_trace_key;
+static pthread_once_t adone_trace_key_once = PTHREAD_ONCE_INIT;
+
+// the ring of a finished thread keeps its events and is handed to the next new thread
+static void adone_trace_release(void *data) {
+    adone_trace_store_long(&((adone_trace_ring_t *)data)->owned, 0);
+}
+
+static void adone_trace_create_key(void) {
+    pthread_key_create(&adone_trace_key, adone_trace_release);
+}
+#endif
+
+static adone_trace_ring_t *adone_trace_attach(void) {
+    adone_trace_ring_t *ring;
+    for (ring = adone_trace_load_ring(&adone_trace_rings); ring != NULL; ring = ring->next) {
+        if (!adone_trace_load_long(&ring->owned) && adone_trace_cas_long(&ring->owned, 0, 1)) {
+            break;
+        }
+    }
+    if (ring == NULL) {
+        ring = (adone_trace_ring_t *)calloc(1, sizeof(*ring));
+        if (ring == NULL) {
+            return NULL;
+        }
+        ring->owned = 1;
+        do {
+            ring->next = adone_trace_load_ring(&adone_trace_rings);
+        } while (!adone_trace_cas_ring(&adone_trace_rings, ring->next, ring));
+    }
+#if !defined(_MSC_VER)
+    pthread_once(&adone_trace_key_once, adone_trace_create_key);
+    pthread_setspecific(adone_trace_key, ring);
+#endif
+    ring->tid = adone_trace_tid();
+    adone_trace_ring = ring;
+    return ring;
+}
+
+void adone_trace_enable(int enabled) {
+    adone_trace_store_long(&adone_trace_enabled_flag, enabled ? 1 : 0);
+}
+
+void adone_trace_record(const char *category, const char *name, uint64_t start, uint64_t end) {
+    adone_trace_ring_t *ring = adone_trace_ring;
+    if (ring == NULL && (ring = adone_trace_attach()) == NULL) {
+        return;
+    }
+    uint64_t head = ring->head;
+    adone_trace_event_t *event = &ring->events[head % ADONE_TRACE_RING_SIZE];
+    event->category = category;
+    event->name = name;
+    event->start = start;
+    event->duration = end - start;
+    // events keep the id, the ring may be reused by another thread later
+    event->tid = ring->tid;
+    adone_trace_store_u64(&ring->head, head + 1);
+}
+
+// JS thread only, as well as dumping
+void adone_trace_clear(void) {
+    adone_trace_ring_t *ring;
+    for (ring = adone_trace_load_ring(&adone_trace_rings); ring != NULL; ring = ring->next) {
+        ring->tail = adone_trace_load_u64(&ring->head);
+    }
+}
+
+char *adone_trace_dump(size_t *length) {
+    size_t capacity = 4096, size = 0;
+    char *out = (char *)malloc(capacity);
+    adone_trace_ring_t *ring;
+#if defined(_MSC_VER)
+    unsigned long pid = GetCurrentProcessId();
+#else
+    unsigned long pid = (unsigned long)getpid();
+#endif
+    if (out == NULL) {
+        return NULL;
+    }
+    out[size++] = '[';
+
+    for (ring = adone_trace_load_ring(&adone_trace_rings); ring != NULL; ring = ring->next) {
+        // spans being overwritten while dumping may come out torn, tracing is best effort
+        uint64_t head = adone_trace_load_u64(&ring->head);
+        uint64_t idx = head > ADONE_TRACE_RING_SIZE ? head - ADONE_TRACE_RING_SIZE : 0;
+        if (idx < ring->tail) {
+            idx = ring->tail;
+        }
+        for (; idx < head; idx++) {
+            adone_trace_event_t event = ring->events[idx % ADONE_TRACE_RING_SIZE];
+            for (;;) {
+                int written = snprintf(out + size, capacity - size,
+                    "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%lu,\"tid\":%llu}",
+                    size > 1 ? "," : "", event.name, event.category,
+                    event.start / 1000.0, event.duration / 1000.0, pid, (unsigned long long)event.tid);
+                // keeps room for the closing bracket and terminator
+                if (written >= 0 && (size_t)written + 2 < capacity - size) {
+                    size += written;
+                    break;
+                }
+                capacity *= 2;
+                char *grown = (char *)realloc(out, capacity);
+                if (grown == NULL) {
+                    free(out);
+                    return NULL;
+                }
+                out = grown;
+            }
+        }
+    }
+    out[size++] = ']';
+    out[size] = 0;
+    *length = size;
+    return out;
+}
+
+#endif // ADONE_TRACE_IMPLEMENTATION
+
+#ifdef __cplusplus
+} // extern "C"
+
+namespace adone {
+
+class TraceScope {
+public:
+    TraceScope(const char *category, const char *name) : category(category), name(name), start(adone_trace_now()) {}
+
+    ~TraceScope() {
+        if (start) {
+            adone_trace_record(category, name, start, uv_hrtime());
+        }
+    }
+
+private:
+    const char *category;
+    const char *name;
+    uint64_t start;
+};
+
+} // namespace adone
+
+#define ADONE_TRACE_SCOPE(category, name) adone::TraceScope ADONE_TRACE_CONCAT(__adone_trace_scope_, __LINE__)((category), (name))
+
+#if defined(ADONE_TRACE_IMPLEMENTATION) && defined(NAN_H_)
+namespace adone {
+namespace trace {
+
+static NAN_METHOD(Enable) {
+    adone_trace_enable(Nan::To<bool>(info[0]).FromMaybe(false));
+}
+
+static NAN_METHOD(Clear) {
+    adone_trace_clear();
+}
+
+static NAN_METHOD(Dump) {
+    size_t length;
+    char *json = adone_trace_dump(&length);
+    if (json == NULL) {
+        return Nan::ThrowError("Out of memory");
+    }
+    info.GetReturnValue().Set(Nan::New<v8::String>(json, static_cast<int>(length)).ToLocalChecked());
+    free(json);
+}
+
+// Exposes traceEnable/traceClear/traceDump used by adone.nodejs.trace
+inline void Export(v8::Local<v8::Object> target) {
+    Nan::SetMethod(target, "traceEnable", Enable);
+    Nan::SetMethod(target, "traceClear", Clear);
+    Nan::SetMethod(target, "traceDump", Dump);
+}
+
+} // namespace trace
+} // namespace adone
+#endif
+
+#endif // __cplusplus
+
+#endif // __ADONE_TRACE_H_
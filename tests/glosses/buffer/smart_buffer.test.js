@@ -61,6 +61,14 @@ describe("collection", "SmartBuffer", () => {
             assert.strictEqual(bb.toDebug(), "<01]");
         });
 
+        it("Buffer without a copy", () => {
+            const buf = Buffer.from([1, 2, 3]);
+            const bb = SmartBuffer.wrap(buf);
+            assert.strictEqual(bb.buffer, buf);
+            buf[0] = 4;
+            assert.strictEqual(bb.readUInt8(), 4);
+        });
+
         it("ArrayBuffer", () => {
             const buf = new ArrayBuffer(1);
             const bb = SmartBuffer.wrap(buf);
@@ -80,6 +88,15 @@ describe("collection", "SmartBuffer", () => {
             assert.strictEqual(bb.toDebug(), "<01]");
         });
 
+        it("Uint8Array view", () => {
+            const arr = new Uint8Array([1, 2, 3, 4]);
+            const bb = SmartBuffer.wrap(arr.subarray(1, 3));
+            assert.strictEqual(bb.capacity, 2);
+            assert.strictEqual(bb.toDebug(), "<02 03]");
+            arr[1] = 5;
+            assert.strictEqual(bb.readUInt8(), 5);
+        });
+
         it("Array", () => {
             const arr = [1, 255, -1];
             const bb = SmartBuffer.wrap(arr);
@@ -663,6 +680,21 @@ describe("collection", "SmartBuffer", () => {
             assert.strictEqual(str2, str);
         });
 
+        it("utf8string by code points", () => {
+            assert.strictEqual(SmartBuffer.calculateUTF8Chars("a\ud800b\udc00"), 4);
+            assert.strictEqual(SmartBuffer.calculateUTF8Chars("\ud83d\ude00"), 1);
+
+            const bb = SmartBuffer.wrap("añ☺\ud83d\ude00z");
+            assert.deepEqual(bb.readString(4, 1), { string: "ñ☺\ud83d\ude00z", length: 10 });
+            assert.strictEqual(bb.readString(2), "añ");
+            assert.strictEqual(bb.roffset, 3);
+            assert.throws(() => bb.readString(4), /Truncated/);
+
+            // malformed data is decoded by code points
+            assert.strictEqual(SmartBuffer.wrap(Buffer.from([0xC0, 0x80, 0x61])).readString(2), "\u0000a");
+            assert.throws(() => SmartBuffer.wrap(Buffer.from([0x80])).readString(1), /Illegal starting byte/);
+        });
+
         it("vstring", () => {
             const bb = new SmartBuffer(2);
             bb.writeVString("ab"); // resizes to 2*2=4
@@ -689,6 +721,64 @@ describe("collection", "SmartBuffer", () => {
             assert.equal(bb.toString("debug").substr(0, 10), "<61 62 00>");
             assert.equal(bb.readCString(), "ab");
             assert.equal(bb.toString("debug").substr(0, 9), "61 62 00^");
+            assert.throws(() => SmartBuffer.wrap("ab").readCString(), /out of range/);
+            assert.throws(() => bb.writeCString("a\u0000"), /NULL/);
+        });
+
+        describe("typed arrays", () => {
+            const types = [
+                ["Int16", Int16Array, "Int16"],
+                ["Uint16", Uint16Array, "UInt16"],
+                ["Int32", Int32Array, "Int32"],
+                ["Uint32", Uint32Array, "UInt32"],
+                ["Float32", Float32Array, "Float"],
+                ["Float64", Float64Array, "Double"]
+            ];
+            const sample = (ArrayType, count) => {
+                const values = new ArrayType(count);
+                for (let i = 0; i < count; i++) {
+                    values[i] = (i * 7919 - 40000) * (ArrayType === Float32Array || ArrayType === Float64Array ? 1.5 : 1);
+                }
+                return values;
+            };
+
+            for (const [name, ArrayType, scalar] of types) {
+                for (const order of ["LE", "BE"]) {
+                    it(`${name} ${order}`, () => {
+                        // short and long arrays, at an odd offset
+                        for (const count of [0, 1, 3, 100]) {
+                            const values = sample(ArrayType, count);
+                            const bb = new SmartBuffer(1);
+                            bb.writeUInt8(0xFF);
+                            bb[`write${name}Array${order}`](values);
+                            assert.strictEqual(bb.woffset, 1 + values.byteLength);
+
+                            const expected = new SmartBuffer(1);
+                            expected.writeUInt8(0xFF);
+                            for (const value of values) {
+                                expected[`write${scalar}${order}`](value);
+                            }
+                            assert.deepEqual(bb.toBuffer(), expected.toBuffer());
+
+                            bb.readUInt8();
+                            const read = bb[`read${name}Array${order}`](count);
+                            assert.ok(read instanceof ArrayType);
+                            assert.deepEqual(Array.from(read), Array.from(values));
+                            assert.strictEqual(bb.roffset, bb.woffset);
+                            assert.deepEqual(Array.from(bb[`read${name}Array${order}`](count, 1)), Array.from(values));
+                        }
+                    });
+                }
+            }
+
+            it("plain arrays", () => {
+                const bb = new SmartBuffer(1);
+                bb.writeInt32ArrayBE([1, -2, 3]);
+                assert.equal(bb.toString("debug"), "<00 00 00 01 FF FF FF FE 00 00 00 03]");
+                assert.throws(() => bb.writeInt32ArrayBE(5), /Illegal values/);
+                assert.throws(() => bb.readInt32ArrayBE(-1, 0), /Illegal count/);
+                assert.throws(() => bb.readInt32ArrayBE(4, 0), /Illegal offset/);
+            });
         });
     });
 
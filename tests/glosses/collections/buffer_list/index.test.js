@@ -234,6 +234,35 @@ describe("collection", "buffer list", () => {
         assert.equal(bl._bufs.length, 0);
     });
 
+    it("offsets after consuming many buffers", () => {
+        const bl = new BufferList();
+        let expected = "";
+
+        for (let i = 0; i < 500; i++) {
+            const chunk = `${i % 7}:${"x".repeat(i % 5)};`;
+            bl.append(chunk);
+            expected += chunk;
+        }
+
+        for (let consumed = 0; consumed < 300; consumed++) {
+            const n = consumed % 11;
+            bl.consume(n);
+            bl.append(String(consumed));
+            expected = expected.slice(n) + String(consumed);
+
+            assert.equal(bl.length, expected.length);
+            assert.equal(bl.get(0), expected.charCodeAt(0));
+            assert.equal(bl.get(37), expected.charCodeAt(37));
+            assert.equal(bl.slice(5, 29).toString(), expected.slice(5, 29));
+            assert.equal(bl.shallowSlice(3, 18).toString(), expected.slice(3, 18));
+            assert.equal(bl.indexOf(";4:x"), expected.indexOf(";4:x"));
+        }
+
+        assert.equal(bl.toString(), expected);
+        assert.equal(bl.duplicate().toString(), expected);
+        assert.equal(new BufferList(bl).toString(), expected);
+    });
+
     it("test readUInt8 / readInt8", () => {
         const buf1 = Buffer.alloc(1);
         const buf2 = Buffer.alloc(3);
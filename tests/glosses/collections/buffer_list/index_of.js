@@ -12,6 +12,20 @@ describe("indexOf", () => {
         assert.equal(bl.indexOf("5"), 18);
     });
 
+    it("indexOf needle spanning many buffers", () => {
+        const bl = new BufferList(["ab\r", "", "\n", "\r", "\n\r\n", "x\r", "\n"]);
+
+        assert.equal(bl.indexOf("\r\n\r\n"), 2);
+        assert.equal(bl.indexOf("\r\n", 3), 4);
+        assert.equal(bl.indexOf("\r\n", 7), 9);
+        assert.equal(bl.indexOf("\n\r\nx"), 5);
+        assert.equal(bl.indexOf("\r\nx\r\n"), 6);
+        bl.consume(5);
+        assert.equal(bl.indexOf("\r\n"), 1);
+        assert.equal(bl.indexOf("x\r\n"), 3);
+        assert.equal(bl.indexOf("x\r\n\r"), -1);
+    });
+
     it("indexOf multiple byte needle", () => {
         const bl = new BufferList(["abcdefg", "abcdefg"]);
 
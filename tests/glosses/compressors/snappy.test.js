@@ -116,4 +116,12 @@ describe("compressor", "snappy", () => {
     it("decompressSync() on bad input", () => {
         assert.throws(() => decompressSync(Buffer.from("beep boop OMG OMG OMG")), "Invalid input");
     });
+
+    it("concurrent compress()/decompress() roundtrips", async () => {
+        const inputs = [...new Array(32)].map((_, i) => Buffer.from(inputString.repeat(1000 * (i + 1))));
+        const outputs = await Promise.all(inputs.map(async (input) => decompress(await compress(input))));
+        for (let i = 0; i < inputs.length; ++i) {
+            assert.deepEqual(outputs[i], inputs[i]);
+        }
+    });
 });
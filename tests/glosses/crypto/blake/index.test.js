@@ -1,5 +1,5 @@
 const {
-    crypto: { blake: { blake2bHex, blake2s, blake2sHex, blake2sInit, blake2sUpdate, blake2sFinal } },
+    crypto: { blake: { blake2b, blake2bHex, blake2bInit, blake2bUpdate, blake2bFinal, blake2bBatch, blake2bBatchSync, blake2s, blake2sHex, blake2sInit, blake2sUpdate, blake2sFinal, blake2sBatch, getKernel, setKernel } },
     fs
 } = adone;
 
@@ -181,4 +181,74 @@ describe("crypto", "blake", () => {
             testSpeed(blake2sHex, N, RUNS);
         });
     });
+
+    describe("kernels", () => {
+        const { best } = getKernel();
+        const kernels = ["scalar", "sse4.1", "avx2", "js"];
+
+        after(() => {
+            setKernel(best);
+        });
+
+        for (const kernel of kernels) {
+            it(`${kernel} should match the reference vectors`, function () {
+                if (!setKernel(kernel)) {
+                    this.skip();
+                    return;
+                }
+                const contents = fs.readFileSync(fixture("blake.txt"), "utf8");
+                contents.split("\n").forEach((line) => {
+                    if (line.length === 0) {
+                        return;
+                    }
+                    const [inputHex, keyHex, outLen, outHex] = line.split("\t");
+                    assert.equal(blake2bHex(hexToBytes(inputHex), hexToBytes(keyHex), outLen), outHex);
+                });
+                assert.equal(blake2sHex("abc"), "508c5e8c327c14e2e1a72ba34eeb452f37458b209ed63a294d999b4c86675982");
+            });
+        }
+    });
+
+    describe("incremental", () => {
+        it("should produce the same digest regardless of how input is split", () => {
+            const input = Buffer.alloc(1000);
+            for (let i = 0; i < input.length; i++) {
+                input[i] = i % 251;
+            }
+            const expected = Buffer.from(blake2b(input)).toString("hex");
+            for (const step of [1, 7, 127, 128, 129, 999]) {
+                const ctx = blake2bInit(64);
+                for (let i = 0; i < input.length; i += step) {
+                    blake2bUpdate(ctx, input.subarray(i, i + step));
+                }
+                assert.equal(Buffer.from(blake2bFinal(ctx)).toString("hex"), expected);
+            }
+        });
+    });
+
+    describe("batch", () => {
+        const inputs = [...new Array(50)].map((_, i) => Buffer.alloc(i * 13, i));
+
+        it("blake2bBatchSync() should return the digests of all inputs", () => {
+            const key = Buffer.from("secret");
+            const digests = blake2bBatchSync(inputs, key, 32);
+            assert.lengthOf(digests, inputs.length);
+            for (let i = 0; i < inputs.length; i++) {
+                assert.deepEqual(Buffer.from(digests[i]), Buffer.from(blake2b(inputs[i], key, 32)));
+            }
+        });
+
+        it("blake2sBatch() should return the digests of all inputs", async () => {
+            const digests = await blake2sBatch(inputs);
+            assert.lengthOf(digests, inputs.length);
+            for (let i = 0; i < inputs.length; i++) {
+                assert.deepEqual(Buffer.from(digests[i]), Buffer.from(blake2s(inputs[i])));
+            }
+        });
+
+        it("should support strings and empty batches", async () => {
+            assert.deepEqual(Buffer.from((await blake2bBatch(["abc"]))[0]), Buffer.from(blake2b("abc")));
+            assert.lengthOf(blake2bBatchSync([]), 0);
+        });
+    });
 });
@@ -1,5 +1,6 @@
 const {
-    crypto: { cipher: CIPHER, aes: AES, util: UTIL }
+    crypto: { cipher: CIPHER, aes: AES, util: UTIL },
+    std
 } = adone;
 
 describe("aes", () => {
@@ -1492,4 +1493,104 @@ describe("aes", () => {
             })(i);
         }
     })();
+
+    describe("kernels", () => {
+        const { best } = AES.getKernel();
+        const kernels = ["aes-ni", "bitsliced", "js"];
+        const modes = ["ECB", "CBC", "CFB", "OFB", "CTR", "GCM"];
+
+        after(() => {
+            AES.setKernel(best);
+        });
+
+        const bytes = (length, seed) => {
+            const buf = Buffer.alloc(length);
+            for (let i = 0; i < length; i++) {
+                buf[i] = (i * 31 + seed) & 0xff;
+            }
+            return buf;
+        };
+
+        for (const kernel of kernels) {
+            it(`${kernel} should match OpenSSL in every mode`, function () {
+                if (!AES.setKernel(kernel)) {
+                    this.skip();
+                    return;
+                }
+                for (const bits of [128, 192, 256]) {
+                    for (const mode of modes) {
+                        const key = bytes(bits / 8, bits);
+                        // counter blocks do not wrap their last 32 bits here, Node increments all 128 bits
+                        const iv = mode === "ECB" ? null : bytes(mode === "GCM" ? 12 : 16, 7);
+                        const aad = bytes(20, 3);
+                        // full blocks with room for the padding in ECB and CBC, a partial block otherwise
+                        const input = bytes(mode === "ECB" || mode === "CBC" ? 1024 : 1029, 11);
+
+                        const reference = std.crypto.createCipheriv(`aes-${bits}-${mode.toLowerCase()}`, key, iv);
+                        if (mode === "GCM") {
+                            reference.setAAD(aad);
+                        }
+                        const expected = Buffer.concat([reference.update(input), reference.final()]).toString("binary");
+
+                        const cipher = CIPHER.createCipher(`AES-${mode}`, key.toString("binary"));
+                        cipher.start({ iv: iv && iv.toString("binary"), additionalData: aad.toString("binary") });
+                        // uneven chunks exercise the partial blocks of the stream modes
+                        for (let i = 0; i < input.length; i += 100) {
+                            cipher.update(UTIL.createBuffer(input.slice(i, i + 100).toString("binary")));
+                        }
+                        assert.equal(cipher.finish(), true);
+                        assert.equal(cipher.output.bytes(), expected, `${bits} ${mode}`);
+
+                        const decipher = CIPHER.createDecipher(`AES-${mode}`, key.toString("binary"));
+                        const options = { iv: iv && iv.toString("binary"), additionalData: aad.toString("binary") };
+                        if (mode === "GCM") {
+                            assert.equal(cipher.mode.tag.bytes(), reference.getAuthTag().toString("binary"));
+                            options.tag = cipher.mode.tag;
+                        }
+                        decipher.start(options);
+                        decipher.update(UTIL.createBuffer(expected));
+                        assert.equal(decipher.finish(), true);
+                        assert.equal(decipher.output.bytes(), input.toString("binary"), `${bits} ${mode}`);
+                    }
+                }
+            });
+        }
+
+        it("should reject a forged GCM tag", () => {
+            const key = bytes(16, 1).toString("binary");
+            const iv = bytes(12, 2).toString("binary");
+            const cipher = CIPHER.createCipher("AES-GCM", key);
+            cipher.start({ iv });
+            cipher.update(UTIL.createBuffer("attack at dawn"));
+            cipher.finish();
+
+            const tag = cipher.mode.tag.bytes();
+            const forged = String.fromCharCode(tag.charCodeAt(0) ^ 1) + tag.slice(1);
+            const decipher = CIPHER.createDecipher("AES-GCM", key);
+            decipher.start({ iv, tag: forged });
+            decipher.update(cipher.output.copy());
+            assert.equal(decipher.finish(), false);
+        });
+
+        it("should continue a CBC chain from the IV residue", () => {
+            const key = bytes(16, 5).toString("binary");
+            const iv = bytes(16, 6).toString("binary");
+            const input = bytes(64, 9).toString("binary");
+
+            const whole = CIPHER.createCipher("AES-CBC", key);
+            whole.start({ iv });
+            whole.update(UTIL.createBuffer(input));
+            whole.finish(() => true);
+
+            const split = CIPHER.createCipher("AES-CBC", key);
+            split.start({ iv });
+            split.update(UTIL.createBuffer(input.slice(0, 32)));
+            split.finish(() => true);
+            const first = split.output.bytes();
+            split.start({ iv: null });
+            split.update(UTIL.createBuffer(input.slice(32)));
+            split.finish(() => true);
+            assert.equal(first + split.output.bytes(), whole.output.bytes());
+        });
+    });
 });
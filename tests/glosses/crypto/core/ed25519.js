@@ -335,6 +335,84 @@ describe("ed25519", () => {
         assert.equal(hex(signature), expectedSignature);
         assert.equal(verified, true);
     });
-});
 
+    it("should reject a signature whose S is not below L", async () => {
+        const kp = ED25519.generateKeyPair();
+        const message = Buffer.from("message");
+        const signature = Buffer.from(ED25519.sign({ message, privateKey: kp.privateKey }));
+        // S + L, little-endian, still fits in 32 bytes since S < L < 2^253
+        const L = Buffer.from("edd3f55c1a631258d69cf7a2def9de1400000000000000000000000000000010", "hex");
+        const malleable = Buffer.from(signature);
+        let carry = 0;
+        for (let i = 0; i < 32; i++) {
+            const sum = malleable[32 + i] + L[i] + carry;
+            malleable[32 + i] = sum & 0xff;
+            carry = sum >> 8;
+        }
+        assert.equal(ED25519.verify({ message, signature, publicKey: kp.publicKey }), true);
+        assert.equal(ED25519.verify({ message, signature: malleable, publicKey: kp.publicKey }), false);
+        assert.deepEqual(await ED25519.verifyBatch([{ message, signature: malleable, publicKey: kp.publicKey }]), [false]);
+    });
+
+    describe("verifyBatch", () => {
+        const items = [];
+        for (let i = 0; i < 20; i++) {
+            const kp = ED25519.generateKeyPair();
+            const message = Buffer.from(`message ${i}`);
+            items.push({
+                message,
+                signature: ED25519.sign({ message, privateKey: kp.privateKey }),
+                publicKey: kp.publicKey
+            });
+        }
 
+        it("should verify valid signatures", async () => {
+            const results = await ED25519.verifyBatch(items);
+            assert.deepEqual(results, items.map(() => true));
+        });
+
+        it("should tell which signatures are invalid", async () => {
+            const tampered = items.map((item) => Object.assign({}, item));
+            tampered[3].signature = Buffer.from(tampered[3].signature);
+            tampered[3].signature[40] ^= 1;
+            tampered[11].message = Buffer.from("another message");
+            tampered[17].publicKey = items[16].publicKey;
+            const results = await ED25519.verifyBatch(tampered);
+            assert.deepEqual(results, tampered.map((item, i) => i !== 3 && i !== 11 && i !== 17));
+        });
+
+        it("should accept the arguments of verify()", async () => {
+            const results = await ED25519.verifyBatch([{
+                message: "test",
+                encoding: "utf8",
+                signature: db64(b64Signature),
+                publicKey: db64(b64PublicKey)
+            }, {
+                message: "test",
+                encoding: "utf8",
+                signature: db64(b64BadSignature),
+                publicKey: db64(b64PublicKey)
+            }]);
+            assert.deepEqual(results, [true, false]);
+        });
+
+        it("should agree with verify() when the public key has a small-order component", async () => {
+            // A + T with T of order 8, the equation without the cofactor only holds when 8 divides h
+            const seed = Buffer.from([...Array(32).keys()]);
+            const publicKey = Buffer.from("b502ff3d92e31d8190b4aa4ea0414005167fad089c4de9dac8a2fc850fed4f58", "hex");
+            const privateKey = Buffer.concat([seed, publicKey]);
+            const batch = [];
+            for (let i = 0; i < 64; i++) {
+                const message = Buffer.from(`message ${i}`);
+                batch.push({ message, signature: ED25519.sign({ message, privateKey }), publicKey });
+            }
+            const results = await ED25519.verifyBatch(batch);
+            assert.deepEqual(results, batch.map((item) => ED25519.verify(item)));
+            assert.deepEqual(results, batch.map(() => true));
+        });
+
+        it("should resolve an empty batch", async () => {
+            assert.deepEqual(await ED25519.verifyBatch([]), []);
+        });
+    });
+});
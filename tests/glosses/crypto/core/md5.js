@@ -109,4 +109,20 @@ describe("md5", () => {
                 md.digest().toHex(), "b3e98306e7367f93cd7cb870af64f7b7");
         }
     });
+
+    it("should digest Buffers and Uint8Arrays", () => {
+        const md = MD5.create();
+        md.update(Buffer.from("a"));
+        md.update(new Uint8Array([98, 99]));
+        assert.equal(md.messageLength, 3);
+        assert.equal(md.digest().toHex(), "900150983cd24fb0d6963f7d28e17f72");
+    });
+
+    it("should digest a long message asynchronously", async () => {
+        const md = MD5.create();
+        await md.updateAsync(Buffer.alloc(1000000, "a"));
+        assert.equal(md.digest().toHex(), "7707d6ae4e027c70eea2a935c2296f21");
+        md.update("abc");
+        assert.equal(md.messageLength, 1000003);
+    });
 });
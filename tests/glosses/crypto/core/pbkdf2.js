@@ -1,5 +1,6 @@
 const {
-    crypto: { options, md: MD, pbkdf2: PBKDF2, util: UTIL }
+    crypto: { options, md: MD, pbkdf2: PBKDF2, util: UTIL },
+    std
 } = adone;
 
 describe("pbkdf2", () => {
@@ -175,4 +176,50 @@ describe("pbkdf2", () => {
         // restore
         options.usePureJavaScript = purejs;
     });
+
+    describe("async", () => {
+        it("should derive a password with hmac-sha-1 c=4096", async () => {
+            const dk = await PBKDF2.async("password", "salt", 4096, 20);
+            assert.equal(dk.toString("hex"), "4b007901b765489abead49d926f721d065a429c1");
+        });
+
+        it("should derive a password given as buffers", async () => {
+            const salt = Buffer.from("4bcda0d1c689fe465c5b8a817f0ddf3d");
+            const dk = await PBKDF2.async(Buffer.from("password"), salt, 1000, 48, "sha512");
+            assert.equal(dk.toString("hex"), "975725960aa736f721182962677291a9085c75421c38636098d904f5a96f11a485f767082b710a69f8a46bcf9eba29f3");
+        });
+
+        it("should match the node implementation for every digest", async () => {
+            const password = Buffer.alloc(150, 0x61);
+            const salt = Buffer.alloc(70, 0x73);
+            for (const md of ["sha1", "sha256", "sha512", "md5"]) {
+                for (const length of [1, 20, 64, 100]) {
+                    const dk = await PBKDF2.async(password, salt, 3, length, md);
+                    assert.deepEqual(dk, std.crypto.pbkdf2Sync(password, salt, 3, length, md));
+                }
+            }
+        });
+
+        it("should reject invalid iteration counts", async function () {
+            if (options.usePureJavaScript) {
+                // the JavaScript implementation does not validate them
+                this.skip();
+                return;
+            }
+            await assert.throws(async () => PBKDF2.async("password", "salt", 0, 20, "sha256"));
+        });
+
+        it("should derive many keys at once", async () => {
+            const entries = [];
+            for (let i = 0; i < 10; i++) {
+                entries.push({ password: `password${i}`, salt: Buffer.from(`salt${i}`) });
+            }
+            const keys = await PBKDF2.batch(entries, 100, 40, "sha256");
+            assert.equal(keys.length, entries.length);
+            for (let i = 0; i < entries.length; i++) {
+                assert.deepEqual(keys[i], std.crypto.pbkdf2Sync(entries[i].password, entries[i].salt, 100, 40, "sha256"));
+            }
+            assert.deepEqual(await PBKDF2.batch([], 100, 40), []);
+        });
+    });
 });
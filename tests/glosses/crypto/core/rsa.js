@@ -1,6 +1,6 @@
 const {
     is,
-    crypto: { options, md: MD, mgf: MGF, pki: PKI, pss: PSS, random: RANDOM, rsa: RSA, util: UTIL }
+    crypto: { options, md: MD, mgf: MGF, pki: PKI, prime: PRIME, pss: PSS, random: RANDOM, rsa: RSA, util: UTIL }
 } = adone;
 
 
@@ -391,6 +391,87 @@ describe("rsa", () => {
         assert.ok(publicKey.verify(md.digest().getBytes(), signature));
     });
 
+    it("should sign the same with and without the CRT parameters", () => {
+        const privateKey = PKI.privateKeyFromPem(_pem.privateKey);
+        const withoutCrt = RSA.setPrivateKey(privateKey.n, privateKey.e, privateKey.d);
+        const md = MD.sha1.create();
+        md.update("0123456789abcdef");
+        assert.equal(UTIL.bytesToHex(privateKey.sign(md)), _signature);
+        assert.equal(UTIL.bytesToHex(withoutCrt.sign(md)), _signature);
+    });
+
+    it("should generate probable primes of the requested size", (done) => {
+        let pending = 3;
+        for (const bits of [64, 256, 521]) {
+            PRIME.generateProbablePrime(bits, (err, num) => {
+                assert.ifError(err);
+                assert.equal(num.bitLength(), bits);
+                assert.ok(num.isProbablePrime(10));
+                if (--pending === 0) {
+                    done();
+                }
+            });
+        }
+    });
+
+    it("should generate probable primes with a given number of Miller-Rabin tests", (done) => {
+        PRIME.generateProbablePrime(128, { algorithm: { name: "PRIMEINC", options: { millerRabinTests: 1 } } }, (err, num) => {
+            assert.ifError(err);
+            assert.equal(num.bitLength(), 128);
+            assert.ok(num.isProbablePrime(10));
+            done();
+        });
+    });
+
+    describe("native prime search", () => {
+        const addon = require(adone.getPath("lib", "glosses", "crypto", "addon"));
+        const calls = { primeGenerate: 0, primeGenerateSync: 0 };
+        const original = {};
+
+        before(function () {
+            if (options.usePureJavaScript || is.null(addon)) {
+                this.skip();
+            }
+            for (const name of Object.keys(calls)) {
+                original[name] = addon[name];
+                addon[name] = (...args) => {
+                    calls[name]++;
+                    return original[name](...args);
+                };
+            }
+        });
+
+        after(() => {
+            Object.assign(addon, original);
+        });
+
+        beforeEach(() => {
+            calls.primeGenerate = calls.primeGenerateSync = 0;
+        });
+
+        // Node's generateKeyPair does not take 17 as public exponent, so these keys come from the
+        // PRIMEINC generation
+
+        it("should find the primes of keys generated in steps", () => {
+            _pairCheck(RSA.generateKeyPair(512, 17));
+            assert.ok(calls.primeGenerateSync >= 2);
+        });
+
+        it("should find the primes of keys generated asynchronously, even with workers", (done) => {
+            RSA.generateKeyPair({ bits: 512, e: 17, workers: 2 }, (err, pair) => {
+                assert.ifError(err);
+                _pairCheck(pair);
+                assert.ok(calls.primeGenerate >= 2);
+                done();
+            });
+        });
+
+        it("should keep the JavaScript search with a custom prng", () => {
+            _pairCheck(RSA.generateKeyPair(512, 17, { prng: RANDOM.createInstance() }));
+            assert.equal(calls.primeGenerateSync, 0);
+        });
+    });
+
     (function () {
         const tests = [{
             keySize: 1024,
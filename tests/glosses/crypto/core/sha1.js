@@ -67,4 +67,20 @@ describe("sha1", () => {
                 md.digest().toHex(), "a838edb5dec47b84b4bfb0a528ea958a5d9d2350");
         }
     });
+
+    it("should digest Buffers and Uint8Arrays", () => {
+        const md = SHA1.create();
+        md.update(Buffer.from("a"));
+        md.update(new Uint8Array([98, 99]));
+        assert.equal(md.messageLength, 3);
+        assert.equal(md.digest().toHex(), "a9993e364706816aba3e25717850c26c9cd0d89d");
+    });
+
+    it("should digest a long message asynchronously", async () => {
+        const md = SHA1.create();
+        await md.updateAsync(Buffer.alloc(1000000, "a"));
+        assert.equal(md.digest().toHex(), "34aa973cd4c4daa4f61eeb2bdbad27316534016f");
+        md.update("abc");
+        assert.equal(md.messageLength, 1000003);
+    });
 });
@@ -103,6 +103,44 @@ describe("crypto", "murmurHash3", () => {
         expect(asciiHash).to.not.equal(emojiHash, "Collision detected hashing '⭐' and 'P'!");
     });
 
+    describe("batch", () => {
+        const keys = ["", "0", "01234", "0123456789abcdef", "My hovercraft is full of eels.", "這個有效"];
+        const packed = Buffer.concat(keys.map((key) => Buffer.from(key)));
+        const offsets = new Uint32Array(keys.length + 1);
+        keys.forEach((key, i) => {
+            offsets[i + 1] = offsets[i] + Buffer.byteLength(key);
+        });
+
+        const words = (hex) => [0, 1, 2, 3].map((i) => parseInt(hex.slice(i * 8, i * 8 + 8), 16));
+
+        it("x86_32", () => {
+            const expected = keys.map((key) => hash_x86_32(key, 25));
+            expect([...murmurHash3.x86.hash32Batch(keys, 25)]).to.be.deep.equal(expected);
+            expect([...murmurHash3.x86.hash32Batch(keys.map((key) => Buffer.from(key)), 25)]).to.be.deep.equal(expected);
+            expect([...murmurHash3.x86.hash32Batch(packed, 25, offsets)]).to.be.deep.equal(expected);
+        });
+
+        it("x86_128", () => {
+            const expected = [].concat(...keys.map((key) => words(hash_x86_128(key))));
+            expect([...murmurHash3.x86.hash128Batch(keys)]).to.be.deep.equal(expected);
+            expect([...murmurHash3.x86.hash128Batch(packed, 0, offsets)]).to.be.deep.equal(expected);
+        });
+
+        it("x64_128", () => {
+            const expected = [].concat(...keys.map((key) => words(hash_x64_128(key, 128))));
+            expect([...murmurHash3.x64.hash128Batch(keys, 128)]).to.be.deep.equal(expected);
+            expect([...murmurHash3.x64.hash128Batch(packed, 128, offsets)]).to.be.deep.equal(expected);
+        });
+
+        it("should return an empty array for no keys", () => {
+            expect(murmurHash3.x86.hash32Batch([]).length).to.be.equal(0);
+        });
+
+        it("should throw on invalid keys", () => {
+            expect(() => murmurHash3.x86.hash32Batch([1, 2])).to.throw(TypeError);
+        });
+    });
+
     it("should take the inputValidation flag into consideration", () => {
         murmurHash3.inputValidation = false;
         expect(murmurHash3.x86.hash32("invalid input")).to.not.equal(undefined);
@@ -85,4 +85,42 @@ describe("data", "base32", () => {
         });
     });
 
+    describe("chunks", () => {
+        const bytes = Buffer.alloc(1000);
+        for (let i = 0; i < bytes.length; i++) {
+            bytes[i] = (i * 131 + 7) & 0xff;
+        }
+
+        it("should encode the same in chunks of any length", () => {
+            const whole = base32.encode(bytes);
+            for (const size of [1, 2, 3, 5, 7, 64]) {
+                const encoder = new base32.Encoder();
+                for (let i = 0; i < bytes.length; i += size) {
+                    encoder.write(bytes.slice(i, i + size));
+                }
+                assert.equal(encoder.finalize(), whole);
+            }
+        });
+
+        it("should decode the same in chunks of any length", () => {
+            const str = base32.encode(bytes).toLowerCase();
+            for (const size of [1, 3, 8, 13, 100]) {
+                const decoder = new base32.Decoder();
+                for (let i = 0; i < str.length; i += size) {
+                    decoder.write(str.slice(i, i + size));
+                }
+                compare(decoder.finalize(), bytes);
+            }
+        });
+
+        it("should ignore padding inside the input", () => {
+            const str = base32.encode(bytes.slice(0, 40));
+            compare(base32.decode(str.replace(/(.{3})/g, "$1=")), bytes.slice(0, 40));
+        });
+
+        it("should decode non-ASCII input like ASCII input", () => {
+            // the characters out of the character map are decoded as 0
+            compare(base32.decode("MZXW6\u00e9"), base32.decode("MZXW6\u0000"));
+        });
+    });
 });
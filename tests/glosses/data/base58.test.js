@@ -0,0 +1,41 @@
+const {
+    data: { base58, baseX }
+} = adone;
+
+describe("data", "base58", () => {
+    // the JavaScript conversion is the reference of the native one
+    const reference = baseX("123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz");
+
+    it("should encode and decode like baseX", () => {
+        for (let length = 0; length < 80; length++) {
+            const bytes = Buffer.alloc(length);
+            for (let i = 0; i < length; i++) {
+                bytes[i] = (i * 89 + length) & 0xff;
+            }
+            // leading zeros are encoded as leading "1"s
+            bytes.fill(0, 0, length % 5);
+            const str = base58.encode(bytes);
+            assert.equal(str, reference.encode(bytes));
+            assert.deepEqual(base58.decode(str), bytes);
+        }
+    });
+
+    it("should encode zeros", () => {
+        assert.equal(base58.encode(Buffer.alloc(3)), "111");
+        assert.deepEqual(base58.decode("111"), Buffer.alloc(3));
+    });
+
+    it("should encode a Bitcoin address", () => {
+        const bytes = Buffer.from("00010966776006953d5567439e5e39f86a0d273beed61967f6", "hex");
+        assert.equal(base58.encode(bytes), "16UwLL9Risc3QfPqBUvKofHmBQ7wMtjvM");
+    });
+
+    it("should not decode invalid strings", () => {
+        assert.strictEqual(base58.decodeUnsafe("0OIl"), undefined);
+        assert.strictEqual(base58.decodeUnsafe(" 2g"), undefined);
+        assert.strictEqual(base58.decodeUnsafe("2g "), undefined);
+        assert.throws(() => base58.decode("2gO"), /^Non-base58 character$/);
+        assert.throws(() => base58.decode(1), /^Expected String$/);
+        assert.throws(() => base58.encode("a"), /^Expected Buffer$/);
+    });
+});
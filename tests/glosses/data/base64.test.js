@@ -0,0 +1,106 @@
+const {
+    data: { base64 }
+} = adone;
+
+describe("data", "base64", () => {
+    const bytes = Buffer.alloc(1000);
+    for (let i = 0; i < bytes.length; i++) {
+        bytes[i] = (i * 167 + 13) & 0xff;
+    }
+
+    const encodeChunks = (encoder, input, size) => {
+        let result = "";
+        for (let i = 0; i < input.length; i += size) {
+            result += encoder.update(input.slice(i, i + size));
+        }
+        return result + encoder.final();
+    };
+
+    const decodeChunks = (decoder, input, size) => {
+        const chunks = [];
+        for (let i = 0; i < input.length; i += size) {
+            chunks.push(decoder.update(input.slice(i, i + size)));
+        }
+        chunks.push(decoder.final());
+        return Buffer.concat(chunks);
+    };
+
+    it("should encode with the URL-safe alphabet", () => {
+        const input = Buffer.from([0xfb, 0xff, 0xbf, 0x01]);
+        assert.equal(base64.encode(input), "+/+/AQ==");
+        assert.equal(base64.encode(input, { url: true }), "-_-_AQ");
+        assert.deepEqual(base64.decode("-_-_AQ", { buffer: true }), input);
+    });
+
+    describe("Encoder", () => {
+        it("should encode the same in chunks of any length", () => {
+            for (let length = 0; length < 40; length++) {
+                const input = bytes.slice(0, length);
+                for (const size of [1, 2, 3, 7]) {
+                    assert.equal(encodeChunks(new base64.Encoder(), input, size), input.toString("base64"));
+                }
+            }
+            assert.equal(encodeChunks(new base64.Encoder(), bytes, 100), bytes.toString("base64"));
+        });
+
+        it("should break lines", () => {
+            const encoder = new base64.Encoder({ lineLength: 76 });
+            const lines = encodeChunks(encoder, bytes, 50).split("\r\n");
+            assert.equal(lines.join(""), bytes.toString("base64"));
+            assert.ok(lines.slice(0, -1).every((line) => line.length === 76));
+            assert.ok(lines[lines.length - 1].length > 0 && lines[lines.length - 1].length <= 76);
+        });
+
+        it("should not end with a line break", () => {
+            const encoder = new base64.Encoder({ lineLength: 4, delimiter: "\n" });
+            assert.equal(encodeChunks(encoder, Buffer.from("abcdef"), 1), "YWJj\nZGVm");
+        });
+
+        it("should encode with the URL-safe alphabet", () => {
+            const input = bytes.slice(0, 998);
+            const expected = input.toString("base64").replace(/\+/g, "-").replace(/\//g, "_").replace(/=+$/, "");
+            assert.equal(encodeChunks(new base64.Encoder({ url: true }), input, 10), expected);
+            assert.equal(encodeChunks(new base64.Encoder({ url: true, pad: true }), Buffer.from([0xff]), 1), "_w==");
+        });
+
+        it("should return Buffers", () => {
+            const encoder = new base64.Encoder({ buffer: true });
+            assert.deepEqual(encoder.update(Buffer.from("abcd")), Buffer.from("YWJj"));
+            assert.deepEqual(encoder.final(), Buffer.from("ZA=="));
+        });
+
+        it("should be reusable after final()", () => {
+            const encoder = new base64.Encoder({ lineLength: 8 });
+            assert.equal(encodeChunks(encoder, bytes.slice(0, 10), 3), "DbRbAqlQ\r\n955F7A==");
+            assert.equal(encodeChunks(encoder, bytes.slice(0, 10), 4), "DbRbAqlQ\r\n955F7A==");
+        });
+    });
+
+    describe("Decoder", () => {
+        it("should decode the same in chunks of any length", () => {
+            const str = bytes.toString("base64");
+            for (const size of [1, 2, 3, 4, 5, 31, 64]) {
+                assert.deepEqual(decodeChunks(new base64.Decoder(), str, size), bytes);
+            }
+        });
+
+        it("should skip line breaks and other characters", () => {
+            const str = bytes.toString("base64").replace(/(.{76})/g, "$1\r\n");
+            assert.deepEqual(decodeChunks(new base64.Decoder(), str, 100), bytes);
+            assert.deepEqual(decodeChunks(new base64.Decoder(), " Y W\tJ j\nZ A = = ", 3), Buffer.from("abcd"));
+        });
+
+        it("should decode concatenated encodings", () => {
+            assert.deepEqual(decodeChunks(new base64.Decoder(), "YQ==Yg==Yw", 3), Buffer.from("abc"));
+        });
+
+        it("should decode Buffers", () => {
+            assert.deepEqual(decodeChunks(new base64.Decoder(), Buffer.from(bytes.toString("base64")), 33), bytes);
+        });
+
+        it("should decode the URL-safe alphabet", () => {
+            const str = bytes.toString("base64").replace(/\+/g, "-").replace(/\//g, "_");
+            assert.deepEqual(decodeChunks(new base64.Decoder({ url: true }), str, 17), bytes);
+        });
+    });
+});
@@ -5,6 +5,7 @@ const {
 const srcPath = (...args) => adone.getPath("src/glosses/data/bson", ...args);
 const fnv1a = require(srcPath("fnv1a"));
 const fnv1a24 = fnv1a.fnv1a24;
+const fnv1a32 = fnv1a.fnv1a32;
 
 describe("fnv1a", () => {
     require("./specs/object-id/vectors.json").vectors.forEach((testCase) => {
@@ -26,4 +27,20 @@ describe("fnv1a", () => {
             expect(buff.toString("hex")).to.equal(hash);
         });
     });
+
+    it("should hash arrays of keys and packed keys as single keys", () => {
+        const keys = ["", "a", "foobar", "這個有效", Buffer.from("00ff", "hex")];
+        const packed = Buffer.concat(keys.map((key) => Buffer.from(key)));
+        const offsets = new Uint32Array(keys.length + 1);
+        keys.forEach((key, i) => {
+            offsets[i + 1] = offsets[i] + Buffer.from(key).length;
+        });
+        const expected32 = keys.map((key) => fnv1a32(key));
+        const expected24 = keys.map((key) => fnv1a24(key));
+        expect(expected32.slice(0, 3)).to.deep.equal([0x811c9dc5, 0xe40c292c, 0xbf9cf968]);
+        expect([...fnv1a.fnv1a32Batch(keys)]).to.deep.equal(expected32);
+        expect([...fnv1a.fnv1a24Batch(keys)]).to.deep.equal(expected24);
+        expect([...fnv1a.fnv1a32Batch(packed, offsets)]).to.deep.equal(expected32);
+        expect([...fnv1a.fnv1a24Batch(packed, offsets)]).to.deep.equal(expected24);
+    });
 });
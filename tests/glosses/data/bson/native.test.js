@@ -0,0 +1,125 @@
+const {
+    data: { bson: BSON }
+} = adone;
+
+const { BSONView, Long, ObjectId, Timestamp, Double, Code } = BSON;
+
+describe("BSON native serializer", () => {
+    const objects = [
+        {},
+        { a: 1, b: -1.5, c: 2 ** 31, d: -(2 ** 31), e: NaN, f: -0, g: 1e300 },
+        { s: "héllo \u{1F600} 日本", empty: "", lone: "\ud800", n: null, u: undefined, t: true, f: false },
+        { arr: [1, "a", null, undefined, [2, [3]], { x: 1 }], o: { p: { q: {} } } },
+        { d: new Date(123456789), bad: new Date(NaN), b: Buffer.from([1, 2, 3]) },
+        { id: new ObjectId(), l: Long.fromNumber(-123456789012), ts: new Timestamp(1, 2), dbl: new Double(5) },
+        [1, 2.5, "x"],
+        { big: "x".repeat(100000), items: Array.from({ length: 1000 }, (_, i) => ({ i, s: String(i) })) }
+    ];
+
+    it("should serialize the same bytes as the JavaScript serializer", () => {
+        for (const object of objects) {
+            for (const ignoreUndefined of [false, true]) {
+                assert.deepEqual(
+                    BSON.serialize(object, { native: true, ignoreUndefined }),
+                    BSON.serialize(object, { ignoreUndefined })
+                );
+            }
+        }
+    });
+
+    it("should serialize to an index of a buffer", () => {
+        const expected = BSON.serialize(objects[3]);
+        const buffer = Buffer.alloc(expected.length + 3);
+        assert.equal(BSON.serializeWithBufferAndIndex(objects[3], buffer, { native: true, index: 3 }), expected.length + 2);
+        assert.deepEqual(buffer.slice(3), expected);
+    });
+
+    it("should leave the other values to the JavaScript serializer", () => {
+        const object = { code: new Code("x"), re: /a/g, m: new Map([["a", 1]]), fn() {} };
+        assert.deepEqual(BSON.serialize(object, { native: true }), BSON.serialize(object));
+        assert.deepEqual(
+            BSON.serialize(object, { native: true, serializeFunctions: true }),
+            BSON.serialize(object, { serializeFunctions: true })
+        );
+        assert.deepEqual(BSON.serialize({ toBSON: () => ({ a: 1 }) }, { native: true }), BSON.serialize({ a: 1 }));
+    });
+
+    it("should throw as the JavaScript serializer does", () => {
+        const cyclic = { a: 1 };
+        cyclic.self = cyclic;
+        assert.throws(() => BSON.serialize(cyclic, { native: true }), /cyclic/);
+        assert.throws(() => BSON.serialize({ $a: 1 }, { native: true, checkKeys: true }), /must not start with/);
+        assert.throws(() => BSON.serialize({ "a\u0000": 1 }, { native: true }), /null bytes/);
+    });
+});
+
+describe("BSONView", () => {
+    const id = new ObjectId();
+    const object = {
+        a: 1,
+        b: "x",
+        c: 1.5,
+        d: null,
+        e: { f: [1, { g: "h" }], i: new Date(1000) },
+        id,
+        l: Long.fromNumber(2 ** 40),
+        t: true
+    };
+    const buffer = BSON.serialize(object);
+
+    it("should list the elements of a document", () => {
+        const view = new BSONView(buffer);
+        assert.equal(view.length, 8);
+        assert.deepEqual(view.keys(), Object.keys(object));
+        assert.ok(view.has("e"));
+        assert.ok(!view.has("z"));
+        assert.strictEqual(view.get("z"), undefined);
+    });
+
+    it("should decode the fields that are accessed", () => {
+        const view = new BSONView(buffer);
+        assert.strictEqual(view.get("a"), 1);
+        assert.strictEqual(view.get("b"), "x");
+        assert.strictEqual(view.get("c"), 1.5);
+        assert.strictEqual(view.get("d"), null);
+        assert.strictEqual(view.get("t"), true);
+        assert.equal(view.get("id").toHexString(), id.toHexString());
+        assert.strictEqual(view.get("l"), 2 ** 40);
+    });
+
+    it("should return views of embedded documents and arrays", () => {
+        const e = new BSONView(buffer).get("e");
+        assert.ok(e instanceof BSONView);
+        assert.equal(e.get("i").getTime(), 1000);
+        const f = e.get("f");
+        assert.ok(f.isArray);
+        assert.deepEqual(f.keys(), [0, 1]);
+        assert.strictEqual(f.get(0), 1);
+        assert.strictEqual(f.get("1").get("g"), "h");
+        assert.strictEqual(f.get(2), undefined);
+        assert.deepEqual(f.toObject(), [1, { g: "h" }]);
+        assert.deepEqual(e.toObject(), BSON.deserialize(buffer).e);
+    });
+
+    it("should decode the whole document as deserialize() does", () => {
+        assert.deepEqual(new BSONView(buffer).toObject(), BSON.deserialize(buffer));
+    });
+
+    it("should pass the deserialize() options", () => {
+        const view = new BSONView(buffer, { promoteLongs: false, raw: true });
+        assert.ok(view.get("l") instanceof Long);
+        assert.ok(Buffer.isBuffer(view.get("e")));
+    });
+
+    it("should read a document at an offset", () => {
+        const view = new BSONView(Buffer.concat([Buffer.alloc(3), buffer]), { index: 3 });
+        assert.strictEqual(view.get("b"), "x");
+    });
+
+    it("should throw on corrupt documents", () => {
+        assert.throws(() => new BSONView(buffer.slice(0, buffer.length - 1)), /corrupt/);
+        const corrupt = Buffer.from(buffer);
+        corrupt[4] = 0x40;
+        assert.throws(() => new BSONView(corrupt), /corrupt/);
+    });
+});
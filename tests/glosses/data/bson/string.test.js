@@ -9,4 +9,24 @@ describe("string tests", () => {
         const serialized = BSON.serialize({ value: unicodeString });
         BSON.deserialize(serialized);
     });
+
+    const replaceA = (bytes) => {
+        const serialized = BSON.serialize({ value: "abc" });
+        // "a" replaced with the given bytes
+        const index = serialized.indexOf("abc");
+        const replaced = Buffer.concat([serialized.slice(0, index), Buffer.from(bytes), serialized.slice(index + 1)]);
+        replaced.writeInt32LE(replaced.length, 0);
+        replaced.writeInt32LE(3 + bytes.length, index - 4);
+        return replaced;
+    };
+
+    it("should not deserialize invalid UTF-8", () => {
+        // a continuation byte without a leading byte
+        assert.throws(() => BSON.deserialize(replaceA([0x80, 0x80])), "Invalid UTF-8 string in BSON document");
+    });
+
+    it("should deserialize overlong forms and surrogates", () => {
+        expect(BSON.deserialize(replaceA([0xC1, 0xA1])).value).to.be.equal("\ufffd\ufffdbc");
+        expect(BSON.deserialize(replaceA([0xED, 0xA0, 0x80])).value).to.be.equal("\ufffd\ufffd\ufffdbc");
+    });
 });
@@ -0,0 +1,75 @@
+const {
+    data: { byteOrder }
+} = adone;
+
+describe("data", "byteOrder", () => {
+    const { best } = byteOrder.getKernel();
+
+    after(() => {
+        byteOrder.setKernel(best);
+    });
+
+    const bytes = (length, seed) => {
+        const buf = Buffer.alloc(length);
+        for (let i = 0; i < length; i++) {
+            buf[i] = (i * 31 + seed) & 0xff;
+        }
+        return buf;
+    };
+
+    // the bytes of every element reversed one by one
+    const swapped = (buf, width) => {
+        const out = Buffer.alloc(buf.length);
+        for (let i = 0; i < buf.length; i += width) {
+            for (let j = 0; j < width; j++) {
+                out[i + j] = buf[i + width - 1 - j];
+            }
+        }
+        return out;
+    };
+
+    for (const kernel of ["avx2", "ssse3", "scalar", "js"]) {
+        it(`${kernel} should reverse the bytes of every element`, function () {
+            if (!byteOrder.setKernel(kernel)) {
+                this.skip();
+                return;
+            }
+            for (const width of [2, 4, 8]) {
+                for (const count of [0, 1, 7, 8, 9, 31, 64, 65, 300]) {
+                    const length = count * width;
+                    const source = bytes(length + 3, count);
+                    const target = Buffer.alloc(length + 5);
+                    byteOrder.copySwapped(source, 3, target, 5, length, width);
+                    assert.deepEqual(target.slice(5), swapped(source.slice(3), width));
+                    assert.deepEqual(target.slice(0, 5), Buffer.alloc(5));
+                }
+            }
+        });
+
+        it(`${kernel} should copy between overlapping ranges`, function () {
+            if (!byteOrder.setKernel(kernel)) {
+                this.skip();
+                return;
+            }
+            for (const shift of [0, 8, -8, 100, -100]) {
+                const buf = bytes(1024, shift);
+                const expected = swapped(buf.slice(200, 712), 8);
+                byteOrder.copySwapped(buf, 200, buf, 200 + shift, 512, 8);
+                assert.deepEqual(buf.slice(200 + shift, 712 + shift), expected);
+            }
+        });
+    }
+
+    it("should copy between typed arrays", () => {
+        const source = new Float64Array([1.5, -2, Infinity]);
+        const target = new Float64Array(3);
+        byteOrder.copySwapped(source, 0, target, 0, 24, 8);
+        byteOrder.copySwapped(target, 0, target, 0, 24, 8);
+        assert.deepEqual(Array.from(target), [1.5, -2, Infinity]);
+    });
+
+    it("should check the ranges", () => {
+        assert.throws(() => byteOrder.copySwapped(Buffer.alloc(8), 4, Buffer.alloc(8), 0, 8, 4), RangeError);
+        assert.throws(() => byteOrder.copySwapped(Buffer.alloc(8), 0, Buffer.alloc(8), 0, 8, 3), RangeError);
+    });
+});
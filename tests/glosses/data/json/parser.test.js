@@ -0,0 +1,123 @@
+const {
+    data: { json: { Parser } }
+} = adone;
+
+describe("data", "json", "Parser", () => {
+    const records = [
+        { id: 1, user: { name: "a", tags: ["x", "y"] }, n: -1.5e3 },
+        { id: 2, user: { name: "b\"c\\", tags: [] }, s: "{[,:]}" },
+        { id: 3, user: null, deep: [[[{ a: [1, { b: 2 }] }]]] },
+        { "kéy": "日本 😀", esc: "\\\"\\", e: {} },
+        [1, "two", true, false, null, {}, []]
+    ];
+    const ndjson = `${records.map((r) => JSON.stringify(r)).join("\n")}\n`;
+
+    // Pushes the text in chunks of `size` bytes
+    const parseChunked = (text, size, options) => {
+        const parser = new Parser(options);
+        const bytes = Buffer.from(text);
+        const values = [];
+        for (let i = 0; i < bytes.length; i += size) {
+            values.push(...parser.push(bytes.subarray(i, i + size)));
+        }
+        values.push(...parser.end());
+        return values;
+    };
+
+    it("should parse newline-delimited values", () => {
+        assert.deepEqual(new Parser().end(ndjson), records);
+    });
+
+    it("should parse values split across chunks", () => {
+        for (const size of [1, 2, 3, 7, 63, 64, 65, 1000]) {
+            assert.deepEqual(parseChunked(ndjson, size), records, `chunks of ${size} bytes`);
+        }
+    });
+
+    it("should parse concatenated values and scalars", () => {
+        const text = "{\"a\":1}[2]\"s\\\" t\" 12 -3.5e2\ntrue\r\n\tnull false{} \"\"";
+        assert.deepEqual(new Parser().end(text), [{ a: 1 }, [2], "s\" t", 12, -350, true, null, false, {}, ""]);
+        for (const size of [1, 2, 5]) {
+            assert.deepEqual(parseChunked(text, size), new Parser().end(text));
+        }
+    });
+
+    it("should keep a scalar at the end of a chunk until it ends", () => {
+        const parser = new Parser();
+        assert.deepEqual(parser.push("1 23"), [1]);
+        assert.deepEqual(parser.push("4"), []);
+        assert.deepEqual(parser.push(" "), [234]);
+        assert.deepEqual(parser.push("5"), []);
+        assert.deepEqual(parser.end(), [5]);
+    });
+
+    it("should select the values at paths", () => {
+        const paths = ["id", "user.name", "user.tags.1", "deep.0.0.0.a.1.b", "kéy", ["esc"], "missing.path", "id"];
+        const expected = records.map((r) => {
+            const get = (path) => path.reduce((v, k) => (v !== null && typeof v === "object" ? v[k] : undefined), r);
+            return paths.map((p) => get(Array.isArray(p) ? p : p.split(".")));
+        });
+        for (const size of [1, 3, 64, 1000]) {
+            assert.deepEqual(parseChunked(ndjson, size, { paths }), expected, `chunks of ${size} bytes`);
+        }
+    });
+
+    it("should select the elements of arrays and the values of keys that are numbers", () => {
+        const parser = new Parser({ paths: ["0", "1.x", "2"] });
+        assert.deepEqual(parser.end("[10, {\"x\": 20}] {\"0\": \"a\", \"2\": [3]} 5"), [
+            [10, 20, undefined],
+            ["a", undefined, [3]],
+            [undefined, undefined, undefined]
+        ]);
+    });
+
+    it("should parse the elements of arrays at the top", () => {
+        const items = Array.from({ length: 1000 }, (_, i) => ({ i, s: String(i), a: [i] }));
+        const text = `${JSON.stringify(items)}\n[1, "x" , [2]] {"o": 1}`;
+        const expected = [...items, 1, "x", [2], { o: 1 }];
+        for (const size of [1, 100, 4096]) {
+            assert.deepEqual(parseChunked(text, size, { elements: true }), expected);
+        }
+        assert.deepEqual(parseChunked(text, 100, { elements: true, paths: ["i", "a.0"] }).slice(998, 1001), [
+            [998, 998],
+            [999, 999],
+            [undefined, undefined]
+        ]);
+    });
+
+    it("should throw on an invalid structure", () => {
+        for (const text of ["{\"a\":1]", "[1,,2]", "{\"a\" 1}", "{\"a\":}", "[1,]", "{,}", "}", "[1 [2]]", "\"a\" , 1"]) {
+            assert.throws(() => new Parser().end(text), SyntaxError, text);
+        }
+        const parser = new Parser();
+        parser.push("{\"a\": [1]}\n{\"b\":");
+        assert.throws(() => parser.push(" ]"), /Unexpected token \] in JSON at position 17/);
+    });
+
+    it("should throw if the last value is not complete", () => {
+        for (const text of ["{\"a\":1", "[", "\"abc", "{\"a\":\"\\\"}"]) {
+            const parser = new Parser();
+            assert.deepEqual(parser.push(text), []);
+            assert.throws(() => parser.end(), /Unexpected end of JSON input/);
+        }
+    });
+
+    it("should throw the errors of the values it parses", () => {
+        assert.throws(() => new Parser().end("{\"a\": tru}"), SyntaxError);
+        assert.deepEqual(new Parser({ paths: ["b"] }).end("{\"a\": tru, \"b\": 1}"), [[1]]);
+    });
+
+    it("should go on after an invalid line", () => {
+        const parser = new Parser();
+        parser.push("{\"b\":0}\n");
+        const err = assert.throws(() => parser.push("{\"a\":1}\n{\"a\":2}\nx\n{\"a\":"), /Invalid JSON value at position 24/);
+        assert.deepEqual(err.values, [{ a: 1 }, { a: 2 }]);
+        assert.deepEqual(parser.push("3}\n{\"a\":4}\n"), [{ a: 3 }, { a: 4 }]);
+        assert.deepEqual(parser.end(), []);
+    });
+
+    it("should accept Uint8Arrays", () => {
+        const bytes = new Uint8Array(Buffer.from("[1] [2]"));
+        assert.deepEqual(new Parser().end(bytes), [[1], [2]]);
+    });
+});
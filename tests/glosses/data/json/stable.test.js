@@ -211,6 +211,17 @@ describe("data", "json", "stable", () => {
             const obj = [4, "", 6];
             expect(stringify(obj)).to.be.equal('[4,"",6]');
         });
+
+        specify("numbers that are not finite", () => {
+            const obj = { b: NaN, a: [Infinity, -0, 1e21], c: true };
+            expect(stringify(obj)).to.be.equal('{"a":[null,0,1e+21],"b":null,"c":true}');
+        });
+
+        specify("keys shared by several objects", () => {
+            const obj = [{ "k\"ey": 1, b: 2 }, { b: 3, "k\"ey": 4 }];
+            expect(stringify(obj)).to.be.equal('[{"b":2,"k\\"ey":1},{"b":3,"k\\"ey":4}]');
+            expect(stringify(obj, { space: 1 })).to.be.equal(JSON.stringify([{ b: 2, "k\"ey": 1 }, { b: 3, "k\"ey": 4 }], null, 1));
+        });
     });
 
     describe("toJSON", () => {
@@ -1,4 +1,5 @@
 const {
+    is,
     error: { IncompleteBufferError },
     data: { mpak: { Serializer, serializer } },
     math: { Long },
@@ -1389,4 +1390,178 @@ describe("data", "mpak", "Serializer", () => {
             assert.deepEqual([...decodedVal.entries()], [...val.entries()], "must stay the same");
         });
     });
+
+    describe("encoder and decoder core", () => {
+        // the output of the JavaScript encoder
+        const encodeJs = (x) => {
+            const buf = new SmartBuffer(64, true);
+            serializer.encoder._encode(x, buf);
+            return buf.toBuffer();
+        };
+
+        const values = [
+            undefined, null, true, false,
+            0, -0, 1, 127, 128, 255, 256, 65535, 65536, 2147483647, 2147483648, 4294967295, 4294967296,
+            -1, -32, -33, -128, -129, -32768, -32769, -214748364, -214748365, -2147483648, -2147483649,
+            0.5, -1.5, 1e300, NaN, Infinity, -Infinity, Number.MAX_SAFE_INTEGER, -Number.MAX_SAFE_INTEGER,
+            "", "a", "a".repeat(31), "a".repeat(32), "é".repeat(15), "é".repeat(16), "€".repeat(85), "€".repeat(86),
+            "a".repeat(255), "a".repeat(256), "é".repeat(32767), "é".repeat(32768), "a".repeat(65536), "\ud800", "😀",
+            Buffer.alloc(0), Buffer.alloc(255, 1), Buffer.alloc(256, 2), Buffer.alloc(65536, 3),
+            [], [1, [2, [3]]], new Array(16).fill("x"), new Array(65536).fill(1), [undefined, null],
+            {}, { a: 1, b: { c: [1, 2] } }, { 1: "one", a: "a", 0: "zero" }, Object.create(null),
+            Object.assign(Object.create(null), { x: "y" }),
+            new Array(20).fill(0).reduce((acc, _, i) => Object.assign(acc, { [`key${i}`]: i }), {}),
+            new Date(0), Long.fromString("-1152921504606912512"), new Map([[1, { a: [new Set([2])] }]]),
+            [new Date(1), { date: new Date(2) }]
+        ];
+
+        it("writes the same bytes as the JavaScript encoder", () => {
+            for (const value of values) {
+                assert.deepEqual(serializer.encode(value).toBuffer(), encodeJs(value));
+            }
+        });
+
+        it("decodes to the same values as the JavaScript decoder", () => {
+            for (const value of values) {
+                const encoded = encodeJs(value);
+                const expected = serializer.decoder._tryDecode(SmartBuffer.wrap(encoded, undefined, true));
+                const actual = serializer.decoder.tryDecode(SmartBuffer.wrap(encoded, undefined, true));
+                assert.deepEqual(actual, expected);
+            }
+        });
+
+        it("does not encode tagged objects as maps", () => {
+            // not a plain object and no extension handles it
+            assert.throws(() => serializer.encode({ [Symbol.toStringTag]: "Tagged", a: 1 }), /Not supported/);
+        });
+
+        it("decodes nested values deeper than the native limit", () => {
+            let value = "leaf";
+            for (let i = 0; i < 1000; i++) {
+                value = i % 2 ? [value] : { v: value };
+            }
+            assert.deepEqual(serializer.decode(serializer.encode(value)), value);
+        });
+
+        it("appends to a given buffer", () => {
+            const buf = new SmartBuffer(2, true);
+            buf.writeUInt8(0xFF);
+            serializer.encode({ a: "b".repeat(100) }, buf);
+            serializer.encode(1, buf);
+            assert.equal(buf.readUInt8(), 0xFF);
+            assert.deepEqual(serializer.decode(buf), { a: "b".repeat(100) });
+            assert.equal(serializer.decode(buf), 1);
+            assert.equal(buf.length, 0);
+        });
+
+        it("moves the read offset by the bytes consumed", () => {
+            const buf = serializer.encode([1, "two", { three: 3 }]);
+            buf.writeUInt8(0x2A);
+            const result = serializer.decoder.tryDecode(buf);
+            assert.deepEqual(result.value, [1, "two", { three: 3 }]);
+            assert.equal(result.bytesConsumed, buf.roffset);
+            assert.equal(buf.readUInt8(), 0x2A);
+        });
+
+        it("returns null for every truncation of a value", () => {
+            const encoded = serializer.encode({ a: [1, 2.5, "x".repeat(40)], b: Buffer.alloc(300), c: new Date(5) }).toBuffer();
+            for (let i = 0; i < encoded.length; i++) {
+                assert.isNull(serializer.decoder.tryDecode(SmartBuffer.wrap(encoded.slice(0, i), undefined, true)));
+                assert.throws(() => serializer.decode(encoded.slice(0, i)), IncompleteBufferError);
+            }
+        });
+
+        it("decodes a Uint8Array", () => {
+            const encoded = serializer.encode({ a: Buffer.from("abc") }).toBuffer();
+            const decoded = serializer.decode(new Uint8Array(encoded));
+            assert.deepEqual(decoded.a, Buffer.from("abc"));
+
+            // values decoded in JavaScript: nesting deeper than the addon goes and extensions
+            let deep = ["x", Buffer.from("y")];
+            for (let i = 0; i < 600; i++) {
+                deep = [deep];
+            }
+            let leaf = serializer.decode(new Uint8Array(serializer.encode(deep).toBuffer()));
+            for (let i = 0; i < 600; i++) {
+                leaf = leaf[0];
+            }
+            assert.equal(leaf[0], "x");
+            assert.isTrue(is.buffer(leaf[1]));
+            assert.deepEqual(leaf[1], Buffer.from("y"));
+
+            const map = serializer.decode(new Uint8Array(serializer.encode(new Map([["x", Buffer.from("y")]])).toBuffer()));
+            assert.deepEqual([...map.keys()], ["x"]);
+            assert.isTrue(is.buffer(map.get("x")));
+        });
+
+        it("decodes binary values at an offset of the input", () => {
+            const encoded = serializer.encode([Buffer.from("abc"), Buffer.from("de")]).toBuffer();
+            const input = Buffer.concat([Buffer.alloc(7), encoded]).slice(7);
+            const decoded = serializer.decode(input);
+            assert.deepEqual(decoded, [Buffer.from("abc"), Buffer.from("de")]);
+        });
+    });
+
+    describe("frames", () => {
+        const frames = [
+            [{ a: [1, "two"] }, 0x80, 1],
+            [new Date(3), 0x41, 300],
+            [Buffer.from("abc"), 0, 0x7FFFFFFF],
+            [null, 0xFF, -1]
+        ];
+
+        const encodeFrames = () => {
+            const buf = new SmartBuffer(8, true);
+            for (const [value, flags, id] of frames) {
+                serializer.encoder.encodeFrame(value, flags, id, buf);
+            }
+            return buf;
+        };
+
+        it("writes the size, the value, the flags and the id", () => {
+            const buf = serializer.encoder.encodeFrame([1, 2], 0x20, 300, new SmartBuffer(0, true));
+            assert.deepEqual(buf.toBuffer(), Buffer.from([0, 0, 0, 6, 0x92, 1, 2, 0x20, 0xAC, 0x02]));
+        });
+
+        it("decodes the frames it writes", () => {
+            const buf = encodeFrames();
+            const decoded = [];
+            assert.isTrue(serializer.decoder.decodeFrames(buf, decoded));
+            const expected = [];
+            for (const [value, flags, id] of frames) {
+                expected.push(flags, id, value);
+            }
+            assert.deepEqual(decoded, expected);
+            assert.equal(buf.length, 0);
+        });
+
+        it("stops before an incomplete frame", () => {
+            const bytes = encodeFrames().toBuffer();
+            const first = bytes.readUInt32BE(0) + 4;
+            for (const end of [0, 3, first, first + 5]) {
+                const buf = SmartBuffer.wrap(bytes.slice(0, end), undefined, true);
+                const decoded = [];
+                assert.isTrue(serializer.decoder.decodeFrames(buf, decoded));
+                assert.equal(decoded.length, end < first ? 0 : 3);
+                assert.equal(buf.roffset, end < first ? 0 : first);
+            }
+        });
+
+        it("stops at a frame that is not valid", () => {
+            const buf = encodeFrames();
+            // the id of the first frame is out of it
+            buf.buffer.writeUInt32BE(buf.buffer.readUInt32BE(0) - 1, 0);
+            const decoded = [];
+            assert.isFalse(serializer.decoder.decodeFrames(buf, decoded));
+            assert.equal(decoded.length, 0);
+            assert.equal(buf.roffset, 0);
+        });
+
+        it("leaves the buffer as it was if the value cannot be encoded", () => {
+            const buf = new SmartBuffer(8, true);
+            serializer.encoder.encodeFrame(1, 0, 1, buf);
+            assert.throws(() => serializer.encoder.encodeFrame({ f: () => {} }, 0, 2, buf));
+            assert.equal(buf.woffset, 7);
+        });
+    });
 });
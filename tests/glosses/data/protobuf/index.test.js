@@ -0,0 +1,138 @@
+import { create } from "../../../../lib/glosses/data/protobuf";
+
+const {
+    data: { varint }
+} = adone;
+
+const proto = `
+    syntax = "proto2";
+
+    enum Color {
+        RED = 0;
+        GREEN = 1;
+        BLUE = 5;
+    }
+
+    message Inner {
+        optional string s = 1;
+        repeated sint32 z = 2 [packed=true];
+    }
+
+    message Test {
+        required int32 a = 1;
+        optional int64 b = 2;
+        optional string c = 3 [default = "hi"];
+        repeated Inner inner = 4;
+        map<string, Inner> m = 5;
+        optional Color color = 6;
+        oneof choice {
+            string x = 7;
+            uint32 y = 8;
+        }
+        optional double d = 9;
+        optional float f = 10;
+        optional fixed32 fx = 11;
+        optional sfixed32 sfx = 12;
+        optional bytes by = 13;
+        optional bool bo = 14;
+        optional fixed64 f64 = 15;
+        repeated uint64 u = 16;
+    }
+`;
+
+const frames = function (buffers) {
+    return Buffer.concat(buffers.map((b) => Buffer.concat([Buffer.from(varint.encode(b.length)), b])));
+};
+
+describe("data", "protobuf", "native", () => {
+    const js = create(proto);
+    const native = create(proto, { native: true });
+
+    const obj = {
+        a: -5,
+        b: -1234567890123,
+        c: "héllo",
+        inner: [{ s: "x", z: [1, -2, 3] }, { s: "" }],
+        m: { k1: { s: "v" }, 10: {} },
+        color: 5,
+        y: 7,
+        d: 1.5,
+        f: 0.25,
+        fx: 4000000000,
+        sfx: -7,
+        by: Buffer.from([1, 2, 3]),
+        bo: true,
+        f64: Buffer.alloc(8, 7),
+        u: [0, 127, 128, 2 ** 40]
+    };
+
+    it("should encode the same bytes as the JavaScript codec", () => {
+        const encoded = native.Test.encode(obj);
+        assert.deepEqual(encoded, js.Test.encode(obj));
+        assert.equal(native.Test.encode.bytes, encoded.length);
+    });
+
+    it("should encode to an offset of a buffer", () => {
+        const expected = js.Test.encode(obj);
+        const buf = Buffer.alloc(expected.length + 3);
+        assert.strictEqual(native.Test.encode(obj, buf, 3), buf);
+        assert.deepEqual(buf.slice(3), expected);
+        assert.equal(native.Test.encode.bytes, expected.length);
+    });
+
+    it("should decode the same objects as the JavaScript codec", () => {
+        const encoded = js.Test.encode(obj);
+        const decoded = native.Test.decode(encoded);
+        const expected = js.Test.decode(encoded);
+        assert.deepEqual(decoded, expected);
+        assert.deepEqual(Object.keys(decoded), Object.keys(expected));
+        assert.equal(native.Test.decode.bytes, encoded.length);
+    });
+
+    it("should decode negative int64 values", () => {
+        for (const b of [-1, -2, -(2 ** 40), -(2 ** 53)]) {
+            const decoded = native.Test.decode(native.Test.encode({ a: 1, b }));
+            assert.equal(decoded.b, js.Test.decode(js.Test.encode({ a: 1, b })).b);
+        }
+    });
+
+    it("should set the defaults after the fields that were read", () => {
+        const decoded = native.Test.decode(js.Test.encode({ a: 1, x: "y" }));
+        const expected = js.Test.decode(js.Test.encode({ a: 1, x: "y" }));
+        assert.deepEqual(Object.keys(decoded), Object.keys(expected));
+        assert.equal(decoded.c, expected.c);
+        assert.deepEqual(decoded.inner, []);
+        assert.deepEqual(decoded.m, {});
+        assert.equal(decoded.x, "y");
+        assert.ok(!("y" in decoded));
+    });
+
+    it("should keep the last field of a oneof", () => {
+        const encoded = Buffer.concat([js.Test.encode({ a: 1, x: "y" }), js.Test.encode({ a: 1, y: 3 })]);
+        const decoded = native.Test.decode(encoded);
+        assert.equal(decoded.y, 3);
+        assert.ok(!("x" in decoded));
+    });
+
+    it("should throw on missing required fields", () => {
+        assert.throws(() => native.Test.encode({}), /required/);
+        assert.throws(() => native.Test.decode(Buffer.alloc(0)), /required/);
+    });
+
+    it("should decode length-delimited messages up to the incomplete one", () => {
+        const messages = [obj, { a: 2 }, { a: 3, m: { k: {} } }];
+        const buf = frames(messages.map((m) => js.Test.encode(m)));
+        const tail = Buffer.from([50, 8]);
+        const decoded = native.Test.decodeMany(Buffer.concat([buf, tail]));
+        assert.deepEqual(decoded, messages.map((m) => js.Test.decode(js.Test.encode(m))));
+        assert.equal(native.Test.decodeMany.bytes, buf.length);
+        assert.deepEqual(js.Test.decodeMany(Buffer.concat([buf, tail])), decoded);
+        assert.equal(js.Test.decodeMany.bytes, buf.length);
+    });
+
+    it("should leave malformed messages to the JavaScript codec", () => {
+        const buf = frames([js.Test.encode({ a: 1 }), Buffer.alloc(0)]);
+        assert.throws(() => native.Test.decodeMany(buf), /required/);
+        assert.throws(() => native.Test.decode(Buffer.from([0x08, 0x80])));
+    });
+});
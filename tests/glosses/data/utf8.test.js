@@ -177,5 +177,60 @@ describe("data", "utf8", () => {
         assert.throws(() => utf8.decode("\xC2\uFFFF"), "Invalid continuation byte");
         assert.throws(() => utf8.decode("\xF0\x9D"), "Invalid byte index");
     });
-});
 
+    it("should transcode long strings", () => {
+        const string = "ascii text, текст, 文字 and 𝌆 ".repeat(100);
+        const encoded = Buffer.from(string, "utf8").toString("latin1");
+        assert.equal(utf8.encode(string), encoded);
+        assert.equal(utf8.decode(encoded), string);
+        assert.equal(utf8.decode("a".repeat(1000)), "a".repeat(1000));
+        assert.throws(() => utf8.encode(`${"a".repeat(100)}\uD800`), /Lone surrogate/);
+        assert.throws(() => utf8.decode(`${"a".repeat(100)}\xED\xA0\x80`), /Lone surrogate/);
+    });
+
+    describe("validate", () => {
+        const invalid = {
+            "overlong 2-byte form": [0xC1, 0xBF],
+            "overlong 3-byte form": [0xE0, 0x9F, 0xBF],
+            "overlong 4-byte form": [0xF0, 0x8F, 0xBF, 0xBF],
+            surrogate: [0xED, 0xA0, 0x80],
+            "code point above U+10FFFF": [0xF4, 0x90, 0x80, 0x80],
+            "invalid lead byte": [0xF8, 0x88, 0x80, 0x80, 0x80],
+            "lone continuation byte": [0x80],
+            "truncated sequence": [0xE2, 0x82],
+            "missing continuation byte": [0xE2, 0x82, 0x41]
+        };
+
+        it("should accept valid UTF-8", () => {
+            assert.isTrue(utf8.validate(Buffer.alloc(0)));
+            assert.isTrue(utf8.validate(Buffer.from("€ 𝌆 \uFFFF \u{10FFFF}")));
+            assert.isTrue(utf8.validate(Buffer.from("abc €".repeat(100))));
+        });
+
+        for (const [name, bytes] of Object.entries(invalid)) {
+            it(`should reject ${name}`, () => {
+                assert.isFalse(utf8.validate(Buffer.from(bytes)));
+                // at every position of a long input
+                for (let offset = 0; offset < 70; offset++) {
+                    const buf = Buffer.concat([Buffer.alloc(offset, 0x41), Buffer.from(bytes), Buffer.from(" ü".repeat(30))]);
+                    assert.isFalse(utf8.validate(buf), `at ${offset}`);
+                    assert.isTrue(utf8.validate(buf, 0, offset));
+                }
+            });
+        }
+
+        it("should validate a range", () => {
+            const buf = Buffer.from([0xFF, 0xC3, 0xA9, 0xFF]);
+            assert.isTrue(utf8.validate(buf, 1, 3));
+            assert.isFalse(utf8.validate(buf, 1, 2));
+            assert.isFalse(utf8.validate(buf, 0, 3));
+        });
+    });
+
+    it("countCodePoints", () => {
+        assert.equal(utf8.countCodePoints(Buffer.alloc(0)), 0);
+        assert.equal(utf8.countCodePoints(Buffer.from("a€𝌆")), 3);
+        const string = "ascii text, текст, 文字 and 𝌆 ".repeat(1000);
+        assert.equal(utf8.countCodePoints(Buffer.from(string)), [...string].length);
+    });
+});
@@ -1,5 +1,5 @@
 const {
-    data: { varint: { decode, encode, encodingLength } }
+    data: { varint: { decode, encode, encodingLength, encodeAll, decodeAll } }
 } = adone;
 
 describe("data", "varint", () => {
@@ -120,4 +120,60 @@ describe("data", "varint", () => {
             }
         }
     });
+
+    describe("encodeAll/decodeAll", () => {
+        const values32 = () => {
+            const values = new Uint32Array(1000);
+            for (let i = 0; i < values.length; ++i) {
+                // mixed lengths, from 1 to 5 bytes
+                values[i] = Math.floor(Math.pow(2, randint(33))) - 1 >>> 0;
+            }
+            return values;
+        };
+
+        it("should encode like encode()", () => {
+            const values = values32();
+            const expected = [];
+            for (const v of values) {
+                expected.push(...encode(v));
+            }
+            assert.deepEqual([...encodeAll(values)], expected);
+            assert.deepEqual([...encodeAll(Array.from(values))], expected);
+        });
+
+        it("should round trip 32-bit values", () => {
+            const values = values32();
+            const decoded = decodeAll(encodeAll(values));
+            assert.instanceOf(decoded, Uint32Array);
+            assert.deepEqual(decoded, values);
+        });
+
+        it("should round trip 64-bit values", () => {
+            const values = new BigUint64Array(1000);
+            for (let i = 0; i < values.length; ++i) {
+                values[i] = (BigInt(1) << BigInt(randint(65))) - BigInt(1);
+            }
+            const decoded = decodeAll(encodeAll(values), { bigint: true });
+            assert.instanceOf(decoded, BigUint64Array);
+            assert.deepEqual(decoded, values);
+        });
+
+        it("should decode an empty buffer", () => {
+            assert.equal(encodeAll(new Uint32Array(0)).length, 0);
+            assert.equal(decodeAll(Buffer.alloc(0)).length, 0);
+        });
+
+        it("should throw on a truncated varint", () => {
+            const buf = encodeAll(new Uint32Array([1, 300, 70000]));
+            assert.throws(() => decodeAll(buf.slice(0, buf.length - 1)), RangeError, "Could not decode varint");
+        });
+
+        it("should throw on a varint that does not fit", () => {
+            const buf = Buffer.from(encode(Math.pow(2, 32), [1, 2], 2));
+            assert.throws(() => decodeAll(buf), RangeError, "Varint at offset 2 does not fit in 32 bits");
+            assert.deepEqual(decodeAll(buf, { bigint: true }), new BigUint64Array([BigInt(1), BigInt(2), BigInt(Math.pow(2, 32))]));
+            const long = Buffer.from([0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02]);
+            assert.throws(() => decodeAll(long, { bigint: true }), RangeError, "Varint at offset 0 does not fit in 64 bits");
+        });
+    });
 });
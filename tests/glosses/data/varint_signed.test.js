@@ -44,4 +44,27 @@ describe("data", "signedVarint", () => {
         encodeDecode(0x80000000000, 7);
         encodeDecode(-0x80000000000, 7);
     });
+
+    describe("encodeAll/decodeAll", () => {
+        it("should encode like encode()", () => {
+            const values = new Int32Array([0, 1, -1, 63, -64, 64, -65, 0x7FFFFFFF, -0x80000000]);
+            const expected = [];
+            for (const v of values) {
+                expected.push(...varintSigned.encode(v));
+            }
+            assert.deepEqual([...varintSigned.encodeAll(values)], expected);
+            const decoded = varintSigned.decodeAll(varintSigned.encodeAll(values));
+            assert.instanceOf(decoded, Int32Array);
+            assert.deepEqual(decoded, values);
+        });
+
+        it("should round trip 64-bit values", () => {
+            const values = new BigInt64Array([0, 1, -1, 0x7FFFFFFF, -0x80000000, 0x80000000000].map(BigInt));
+            values[0] = (BigInt(1) << BigInt(63)) - BigInt(1);
+            values[1] = -(BigInt(1) << BigInt(63));
+            const decoded = varintSigned.decodeAll(varintSigned.encodeAll(values), { bigint: true });
+            assert.instanceOf(decoded, BigInt64Array);
+            assert.deepEqual(decoded, values);
+        });
+    });
 });
@@ -0,0 +1,106 @@
+describe("data", "yaml", "native", () => {
+    const { data: { yaml } } = adone;
+
+    it("should load block collections", () => {
+        const text = [
+            "# service",
+            "---",
+            "name: svc",
+            "ports:",
+            "  - 80",
+            "  - 443",
+            "env:",
+            "  NODE_ENV: production  # comment",
+            "  PATH: /usr/local/bin:/usr/bin",
+            "servers:",
+            "- host: a",
+            "  weight: 2",
+            "- host: b",
+            "empty:",
+            ""
+        ].join("\n");
+        assert.deepEqual(yaml.safeLoad(text), {
+            name: "svc",
+            ports: [80, 443],
+            env: { NODE_ENV: "production", PATH: "/usr/local/bin:/usr/bin" },
+            servers: [{ host: "a", weight: 2 }, { host: "b" }],
+            empty: null
+        });
+    });
+
+    it("should load flow collections", () => {
+        assert.deepEqual(yaml.safeLoad("a: [x, 'y', \"z\", [1, {b: c}], ]\nd: {e: 1, f}\ng: []\nh: {}"), {
+            a: ["x", "y", "z", [1, { b: "c" }]],
+            d: { e: 1, f: null },
+            g: [],
+            h: {}
+        });
+        assert.deepEqual(yaml.safeLoad("a: [\n  1,\n  2\n]\n"), { a: [1, 2] });
+    });
+
+    it("should resolve plain scalars", () => {
+        const value = yaml.safeLoad([
+            "n: [~, null, Null, '']",
+            "b: [true, False, yes, no]",
+            "i: [0, -0, 012, 0x1F, 0b101, 1_000, +12, 9007199254740993]",
+            "f: [1.5, -1.25, 1e3, 0.1e-2, 685.230_15e+03]",
+            "s: [1e, 1:a, a b, é, 日本]"
+        ].join("\n"));
+        assert.deepEqual(value, {
+            n: [null, null, null, ""],
+            b: [true, false, "yes", "no"],
+            i: [0, 0, 10, 31, 5, 1000, 12, 9007199254740992],
+            f: [1.5, -1.25, 1000, 0.001, 685230.15],
+            s: ["1e", "1:a", "a b", "é", "日本"]
+        });
+        assert.isTrue(Object.is(yaml.safeLoad("-00"), -0));
+    });
+
+    it("should load quoted scalars", () => {
+        assert.deepEqual(yaml.safeLoad("- 'it''s'\n- \"a\\tb\\n\\u00e9\\x41\\U0001F600\"\n- \"\\\"\\\\\""), [
+            "it's",
+            "a\tb\néA😀",
+            "\"\\"
+        ]);
+    });
+
+    it("should load block scalars", () => {
+        const text = "a: |\n  x\n    y\n\n  z\nb: >-\n  w1\n  w2\n\n    more\n  w3\nc: |+\n  k\n\n";
+        assert.deepEqual(yaml.safeLoad(text), {
+            a: "x\n  y\n\nz\n",
+            b: "w1 w2\n\n  more\nw3",
+            c: "k\n\n"
+        });
+    });
+
+    it("should convert keys to strings", () => {
+        assert.deepEqual(Object.keys(yaml.safeLoad("1: a\n0x10: b\n~: c\ntrue: d\n-0: e")), ["0", "1", "16", "null", "true"]);
+    });
+
+    it("should throw on duplicate keys unless json is set", () => {
+        assert.throws(() => yaml.safeLoad("a: 1\nb: 2\na: 3"), yaml.Exception);
+        assert.deepEqual(yaml.safeLoad("a: 1\nb: 2\na: 3", { json: true }), { a: 3, b: 2 });
+    });
+
+    it("should load the documents it does not convert", () => {
+        const value = yaml.safeLoad([
+            "base: &base",
+            "  x: 1",
+            "derived:",
+            "  <<: *base",
+            "  y: 2",
+            "date: 2001-12-14",
+            "tagged: !!str 1",
+            "inf: .inf",
+            "text: first",
+            "  second"
+        ].join("\n"));
+        assert.deepEqual(value.derived, { x: 1, y: 2 });
+        assert.equal(value.date.getTime(), Date.UTC(2001, 11, 14));
+        assert.equal(value.tagged, "1");
+        assert.equal(value.inf, Infinity);
+        assert.equal(value.text, "first second");
+        assert.throws(() => yaml.safeLoad("a: 1\n---\nb: 2"), yaml.Exception);
+        assert.deepEqual(yaml.safeLoadAll("a: 1\n---\nb: 2"), [{ a: 1 }, { b: 2 }]);
+    });
+});
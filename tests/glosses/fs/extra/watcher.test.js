@@ -2311,4 +2311,139 @@ describe("watcher", function watcherTests() {
     }
 
     describe("fs.watchFile (polling)", runTests.bind(this, { usePolling: true, interval: 10 }));
+
+    if (os === "darwin" || os === "linux") {
+        describe("native ignored globs", () => {
+            it("should drop ignored paths before they reach js", async () => {
+                await fixtures.addDirectory("node_modules", "pkg");
+                await sleep();
+                const raw = spy();
+                const add = spy();
+                watcher = watch(fixtures.path(), {
+                    useFsEvents: true,
+                    ignoreInitial: true,
+                    ignored: ["**/node_modules/**"]
+                }).on("raw", raw).on("add", add);
+                await adone.promise.delay(300);
+                await fixtures.addFile("node_modules", "pkg", "index.js", { contents: "a" });
+                await fixtures.addFile("index.js", { contents: "b" });
+                await add.waitForCall();
+                await sleep(300);
+                expect(add).to.have.been.calledOnce();
+                expect(raw.args.some((args) => args[1].includes("node_modules"))).to.be.false();
+            });
+
+            it("should not let wildcards match dot segments like matchPath does", async () => {
+                await fixtures.addDirectory("node_modules", ".bin");
+                await fixtures.addDirectory("node_modules", "pkg");
+                await sleep();
+                const fsevents = require(adone.getPath("lib", "glosses", "fs", "extra", "watcher", "fsevents"));
+                const paths = [];
+                const stop = fsevents.watch(fixtures.path(), { exclude: ["**/node_modules/**"] }, (path) => paths.push(path));
+                await adone.promise.delay(300);
+                const hidden = await fixtures.addFile("node_modules", ".bin", "a", { contents: "a" });
+                const ignored = await fixtures.addFile("node_modules", "pkg", "b", { contents: "b" });
+                await adone.promise.delay(500);
+                await stop();
+
+                expect(paths).to.include(hidden.path());
+                expect(paths).not.to.include(ignored.path());
+            });
+
+            it("should drop the hidden entries of ignored directories natively with dot", async () => {
+                await fixtures.addDirectory(".git", "objects");
+                await sleep();
+                const raw = spy();
+                const add = spy();
+                watcher = watch(fixtures.path(), {
+                    useFsEvents: true,
+                    ignoreInitial: true,
+                    dot: true,
+                    ignored: ["**/.git/**"]
+                }).on("raw", raw).on("add", add);
+                await adone.promise.delay(300);
+                await fixtures.addFile(".git", "objects", ".lock", { contents: "a" });
+                await fixtures.addFile(".git", "HEAD", { contents: "b" });
+                const file = await fixtures.addFile("index.js", { contents: "c" });
+                await add.waitForCall();
+                await sleep(300);
+                expect(add).to.have.been.calledOnce();
+                expect(add).to.have.been.calledWith(file.path());
+                expect(raw.args.some((args) => args[1].includes(".git"))).to.be.false();
+            });
+
+            it("should keep negated patterns for matchPath", async () => {
+                await fixtures.addDirectory("src");
+                await sleep();
+                const add = spy();
+                watcher = watch(fixtures.path(), {
+                    useFsEvents: true,
+                    ignoreInitial: true,
+                    ignored: ["**/*.log", "!**/keep.log"]
+                }).on("add", add);
+                await adone.promise.delay(300);
+                const keep = await fixtures.addFile("src", "keep.log", { contents: "a" });
+                await add.waitForCall();
+                expect(add).to.have.been.calledWith(keep.path());
+            });
+
+            it("should keep watching a directory renamed within the root", async () => {
+                const dir = await fixtures.addDirectory("a");
+                await dir.addDirectory("sub");
+                await sleep();
+                const fsevents = require(adone.getPath("lib", "glosses", "fs", "extra", "watcher", "fsevents"));
+                const paths = [];
+                const stop = fsevents.watch(fixtures.path(), {}, (path) => paths.push(path));
+                await adone.promise.delay(300);
+                const renamed = adone.std.path.join(fixtures.path(), "b");
+                adone.std.fs.renameSync(dir.path(), renamed);
+                await adone.promise.delay(100);
+                adone.std.fs.writeFileSync(adone.std.path.join(renamed, "file"), "a");
+                adone.std.fs.writeFileSync(adone.std.path.join(renamed, "sub", "file2"), "b");
+                await adone.promise.delay(500);
+                await stop();
+
+                expect(paths).to.include(adone.std.path.join(renamed, "file"));
+                expect(paths).to.include(adone.std.path.join(renamed, "sub", "file2"));
+            });
+
+            it("should stop watching a directory moved out of the root", async () => {
+                const dir = await fixtures.addDirectory("a");
+                await dir.addDirectory("sub");
+                await sleep();
+                const fsevents = require(adone.getPath("lib", "glosses", "fs", "extra", "watcher", "fsevents"));
+                const paths = [];
+                const stop = fsevents.watch(fixtures.path(), {}, (path) => paths.push(path));
+                await adone.promise.delay(300);
+                const moved = adone.std.path.join(rootFixtures.path(), `${fixtures.filename()}-moved`);
+                adone.std.fs.renameSync(dir.path(), moved);
+                await adone.promise.delay(100);
+                adone.std.fs.writeFileSync(adone.std.path.join(moved, "ghost"), "a");
+                adone.std.fs.writeFileSync(adone.std.path.join(moved, "sub", "ghost"), "b");
+                await adone.promise.delay(500);
+                await stop();
+
+                expect(paths.filter((path) => path.endsWith("ghost"))).to.be.empty();
+            });
+
+            it("should count received, filtered and dispatched events", async () => {
+                const fsevents = require(adone.getPath("lib", "glosses", "fs", "extra", "watcher", "fsevents"));
+                const paths = [];
+                const stop = fsevents.watch(fixtures.path(), { exclude: ["**/*.log"] }, (path) => paths.push(path));
+                await adone.promise.delay(300);
+                await fixtures.addFile("a.log", { contents: "a" });
+                await fixtures.addFile("a.txt", { contents: "a" });
+                await adone.promise.delay(500);
+                await stop();
+
+                const stats = fsevents.stats(stop);
+                expect(stats.filtered).to.be.at.least(1);
+                expect(stats.received).to.be.at.least(stats.filtered + paths.length);
+                expect(stats.dispatched).to.be.equal(paths.length);
+                expect(stats.queueDepth).to.be.equal(0);
+                expect(stats.queueHighWaterMark).to.be.at.least(1);
+                expect(stats.latency.buckets.reduce((a, b) => a + b, 0)).to.be.equal(stats.latency.count);
+            });
+        });
+    }
 });
@@ -79,4 +79,62 @@ describe("Packet", () => {
         const decPkt = packet.decode(packet.encode(pkt));
         assert.deepEqual(pkt, decPkt);
     });
+
+    it("encode/decode packet frames", () => {
+        const pkts = [
+            packet.create(1, 1, 0x20, [1, 2, 3]),
+            packet.create(2, 0, 0x01, { some: "data" }),
+            packet.create(3, 1, 0x3F, "text")
+        ];
+        const buf = new adone.buffer.SmartBuffer(16, true);
+        for (const pkt of pkts) {
+            packet.encodeFrame(pkt, buf);
+        }
+        const raw = packet.encode(pkts[0]).toBuffer();
+        assert.equal(buf.buffer.readUInt32BE(0), raw.length);
+        assert.deepEqual(buf.buffer.slice(4, 4 + raw.length), raw);
+
+        const bytes = buf.toBuffer();
+        const input = adone.buffer.SmartBuffer.wrap(bytes.slice(0, bytes.length - 1), undefined, true);
+        const decPkts = [];
+        packet.decodeFrames(input, decPkts);
+        assert.deepEqual(decPkts, pkts.slice(0, 2));
+        input.write(bytes.slice(bytes.length - 1));
+        packet.decodeFrames(input, decPkts);
+        assert.deepEqual(decPkts, pkts);
+        assert.equal(input.length, 0);
+    });
+
+    it("decoded binary values should survive the compaction of the receive buffer", () => {
+        const buf = new adone.buffer.SmartBuffer(16, true);
+        packet.encodeFrame(packet.create(1, 1, 0x20, Buffer.from([1, 2, 3])), buf);
+        packet.encodeFrame(packet.create(2, 1, 0x20, Buffer.from([4, 5, 6])), buf);
+        const bytes = buf.toBuffer();
+
+        // the same steps as the receive loop of RemotePeer
+        const input = new adone.buffer.SmartBuffer(0);
+        input.write(bytes.slice(0, bytes.length - 2));
+        const decPkts = [];
+        packet.decodeFrames(input, decPkts);
+        input.compact(input.roffset, input.woffset);
+        input.write(bytes.slice(bytes.length - 2));
+        packet.decodeFrames(input, decPkts);
+        input.compact(input.roffset, input.woffset);
+        input.write(Buffer.alloc(bytes.length, 9));
+
+        assert.deepEqual(decPkts[0].data, Buffer.from([1, 2, 3]));
+        assert.deepEqual(decPkts[1].data, Buffer.from([4, 5, 6]));
+    });
+
+    it("decode invalid packet frame", () => {
+        const buf = new adone.buffer.SmartBuffer(16, true);
+        packet.encodeFrame(packet.create(1, 1, 0x20, [1, 2, 3]), buf);
+        packet.encodeFrame(packet.create(2, 1, 0x20, [4]), buf);
+        // the id of the second packet is out of its frame
+        const second = buf.buffer.readUInt32BE(0) + 4;
+        buf.buffer.writeUInt32BE(buf.buffer.readUInt32BE(second) - 1, second);
+        const decPkts = [];
+        assert.throws(() => packet.decodeFrames(buf, decPkts), adone.error.NotValidException);
+        assert.equal(decPkts.length, 1);
+    });
 });
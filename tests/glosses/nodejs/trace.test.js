@@ -0,0 +1,53 @@
+const {
+    nodejs: { trace },
+    compressor: { snappy }
+} = adone;
+
+describe("nodejs", "trace", () => {
+    before(() => {
+        // loads the addon
+        snappy.compressSync("");
+    });
+
+    afterEach(() => {
+        trace.disable();
+        trace.clear();
+    });
+
+    it("should register loaded addons", () => {
+        assert.include(trace.getAddonNames(), "snappy");
+    });
+
+    it("should not record spans when disabled", () => {
+        trace.disable();
+        trace.clear();
+        snappy.compressSync("hello world");
+        assert.lengthOf(trace.dump().traceEvents.filter((e) => e.cat === "snappy"), 0);
+    });
+
+    it("should record spans of sync and pooled calls", async () => {
+        trace.clear();
+        trace.enable();
+        snappy.compressSync("hello world");
+        await snappy.compress("hello world");
+
+        const { traceEvents } = trace.dump();
+        const names = traceEvents.filter((e) => e.cat === "snappy").map((e) => e.name);
+        assert.includeMembers(names, ["compressSync", "compress", "compress:queued"]);
+        for (const event of traceEvents) {
+            assert.equal(event.ph, "X");
+            assert.equal(event.pid, process.pid);
+            assert.isAtLeast(event.dur, 0);
+        }
+        for (let i = 1; i < traceEvents.length; ++i) {
+            assert.isAtLeast(traceEvents[i].ts, traceEvents[i - 1].ts);
+        }
+    });
+
+    it("clear() should drop recorded spans", () => {
+        trace.enable();
+        snappy.compressSync("hello world");
+        trace.clear();
+        assert.lengthOf(trace.dump().traceEvents, 0);
+    });
+});